@@ -0,0 +1,254 @@
+/*
+ * WGBench.c - Benchmark Harness Implementation
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * Usage: wgbench [--format=json|table] [--filter=substring]
+ *                [--min-time=seconds] [--samples=n] [--list]
+ */
+
+#include "WGBench.h"
+#include "WGLogWriter.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/utsname.h>
+#include <time.h>
+#include <unistd.h>
+
+#define WG_BENCH_MAX_SAMPLES 100
+
+typedef enum {
+    WGBenchFormatJSON = 0,
+    WGBenchFormatTable
+} WGBenchFormat;
+
+typedef struct {
+    WGBenchFormat format;
+    const char *filter;
+    double minTime;             // Seconds per sample
+    int samples;
+    bool list;
+} WGBenchOptions;
+
+typedef struct {
+    uint64_t iterations;        // Per sample
+    int samples;
+    double min;                 // ns/op
+    double median;
+    double p90;
+    double mean;
+} WGBenchResult;
+
+static const WGBenchSuite *const kWGBenchSuites[] = {
+    &WGBenchARPSuite,
+    &WGBenchScanSuite,
+    &WGBenchExportSuite,
+    &WGBenchUtilsSuite,
+};
+
+#pragma mark - Fixture Helpers
+
+int WGBenchOpenNull(void) {
+    return open("/dev/null", O_WRONLY | O_CLOEXEC);
+}
+
+int WGBenchOpenTemporary(void) {
+    const char *directory = getenv("TMPDIR");
+    char path[256];
+    snprintf(path, sizeof(path), "%s/wgbench.XXXXXX", directory && *directory ? directory : "/tmp");
+    int fd = mkstemp(path);
+    if (fd >= 0) {
+        unlink(path);
+    }
+    return fd;
+}
+
+#pragma mark - Measurement
+
+static int WGBenchCompareDouble(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static uint64_t WGBenchTime(const WGBenchCase *benchCase, WGBenchContext *context, uint64_t iterations) {
+    uint64_t start = WGLogMonotonicNs();
+    benchCase->run(context, iterations);
+    return WGLogMonotonicNs() - start;
+}
+
+// Doubles the iteration count until one sample takes minTime, then takes
+// the requested samples at that count
+static void WGBenchMeasure(const WGBenchCase *benchCase, WGBenchContext *context,
+                           const WGBenchOptions *options, WGBenchResult *result) {
+    uint64_t target = (uint64_t)(options->minTime * 1e9);
+    uint64_t iterations = 1;
+    uint64_t elapsed = WGBenchTime(benchCase, context, iterations);   // Warm-up
+    while (elapsed < target && iterations < (UINT64_C(1) << 40)) {
+        uint64_t scale = elapsed > 0 ? target / elapsed : 0;
+        iterations *= scale >= 2 ? (scale > 16 ? 16 : scale) : 2;
+        elapsed = WGBenchTime(benchCase, context, iterations);
+    }
+
+    double perOp[WG_BENCH_MAX_SAMPLES];
+    double sum = 0;
+    for (int i = 0; i < options->samples; i++) {
+        perOp[i] = (double)WGBenchTime(benchCase, context, iterations) / (double)iterations;
+        sum += perOp[i];
+    }
+    qsort(perOp, (size_t)options->samples, sizeof(double), WGBenchCompareDouble);
+
+    result->iterations = iterations;
+    result->samples = options->samples;
+    result->min = perOp[0];
+    result->median = perOp[options->samples / 2];
+    result->p90 = perOp[(options->samples * 9) / 10];
+    result->mean = sum / options->samples;
+}
+
+#pragma mark - Output
+
+static void WGBenchPrintContext(const WGBenchOptions *options) {
+    if (options->format != WGBenchFormatJSON) {
+        printf("%-10s %-34s %8s %12s %12s %12s %14s\n",
+               "group", "name", "arg", "median ns", "p90 ns", "min ns", "items/s");
+        return;
+    }
+
+    struct utsname host;
+    if (uname(&host) != 0) {
+        memset(&host, 0, sizeof(host));
+    }
+    char date[32];
+    time_t now = time(NULL);
+    struct tm tm;
+    gmtime_r(&now, &tm);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", &tm);
+
+#if defined(__clang__)
+    const char *compiler = "clang " __clang_version__;
+#elif defined(__GNUC__)
+    const char *compiler = "gcc " __VERSION__;
+#else
+    const char *compiler = "unknown";
+#endif
+    printf("{\"type\":\"context\",\"date\":\"%s\",\"host\":\"%s\",\"system\":\"%s %s\","
+           "\"machine\":\"%s\",\"cpus\":%ld,\"compiler\":\"%s\",\"min_time\":%g,\"samples\":%d}\n",
+           date, host.nodename, host.sysname, host.release, host.machine,
+           sysconf(_SC_NPROCESSORS_ONLN), compiler, options->minTime, options->samples);
+}
+
+static void WGBenchPrintResult(const WGBenchCase *benchCase, const WGBenchContext *context,
+                               const WGBenchResult *result, const WGBenchOptions *options) {
+    double opsPerSecond = result->median > 0 ? 1e9 / result->median : 0;
+    double itemsPerSecond = opsPerSecond * (double)context->itemsPerOp;
+    double bytesPerSecond = opsPerSecond * (double)context->bytesPerOp;
+
+    if (options->format == WGBenchFormatTable) {
+        printf("%-10s %-34s %8ld %12.1f %12.1f %12.1f %14.0f\n",
+               benchCase->group, benchCase->name, benchCase->arg,
+               result->median, result->p90, result->min, itemsPerSecond);
+        return;
+    }
+    printf("{\"type\":\"result\",\"group\":\"%s\",\"name\":\"%s\",\"arg\":%ld,"
+           "\"iterations\":%llu,\"samples\":%d,"
+           "\"ns_per_op\":{\"min\":%.2f,\"median\":%.2f,\"p90\":%.2f,\"mean\":%.2f},"
+           "\"items_per_op\":%llu,\"ops_per_sec\":%.1f,\"items_per_sec\":%.1f,\"bytes_per_sec\":%.1f}\n",
+           benchCase->group, benchCase->name, benchCase->arg,
+           (unsigned long long)result->iterations, result->samples,
+           result->min, result->median, result->p90, result->mean,
+           (unsigned long long)context->itemsPerOp, opsPerSecond, itemsPerSecond, bytesPerSecond);
+}
+
+static void WGBenchPrintFailure(const WGBenchCase *benchCase, const WGBenchOptions *options) {
+    if (options->format == WGBenchFormatTable) {
+        printf("%-10s %-34s %8ld %12s\n", benchCase->group, benchCase->name, benchCase->arg, "setup failed");
+        return;
+    }
+    printf("{\"type\":\"error\",\"group\":\"%s\",\"name\":\"%s\",\"arg\":%ld,\"error\":\"setup failed\"}\n",
+           benchCase->group, benchCase->name, benchCase->arg);
+}
+
+#pragma mark - Main
+
+static bool WGBenchMatches(const WGBenchCase *benchCase, const char *filter) {
+    if (!filter) {
+        return true;
+    }
+    char qualified[128];
+    snprintf(qualified, sizeof(qualified), "%s/%s/%ld", benchCase->group, benchCase->name, benchCase->arg);
+    return strstr(qualified, filter) != NULL;
+}
+
+static bool WGBenchParseOptions(int argc, char **argv, WGBenchOptions *options) {
+    *options = (WGBenchOptions){
+        .format = WGBenchFormatJSON,
+        .minTime = 0.05,
+        .samples = 10
+    };
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if (strcmp(arg, "--format=json") == 0) {
+            options->format = WGBenchFormatJSON;
+        } else if (strcmp(arg, "--format=table") == 0) {
+            options->format = WGBenchFormatTable;
+        } else if (strncmp(arg, "--filter=", 9) == 0) {
+            options->filter = arg + 9;
+        } else if (strncmp(arg, "--min-time=", 11) == 0) {
+            options->minTime = atof(arg + 11);
+        } else if (strncmp(arg, "--samples=", 10) == 0) {
+            options->samples = atoi(arg + 10);
+        } else if (strcmp(arg, "--list") == 0) {
+            options->list = true;
+        } else {
+            return false;
+        }
+    }
+    return options->minTime > 0 && options->samples > 0 && options->samples <= WG_BENCH_MAX_SAMPLES;
+}
+
+int main(int argc, char **argv) {
+    WGBenchOptions options;
+    if (!WGBenchParseOptions(argc, argv, &options)) {
+        fprintf(stderr, "usage: %s [--format=json|table] [--filter=substring] "
+                        "[--min-time=seconds] [--samples=1-%d] [--list]\n",
+                argv[0], WG_BENCH_MAX_SAMPLES);
+        return 2;
+    }
+
+    if (!options.list) {
+        WGBenchPrintContext(&options);
+    }
+
+    int failures = 0;
+    for (size_t s = 0; s < sizeof(kWGBenchSuites) / sizeof(kWGBenchSuites[0]); s++) {
+        const WGBenchSuite *suite = kWGBenchSuites[s];
+        for (size_t i = 0; i < suite->count; i++) {
+            const WGBenchCase *benchCase = &suite->cases[i];
+            if (!WGBenchMatches(benchCase, options.filter)) {
+                continue;
+            }
+            if (options.list) {
+                printf("%s/%s/%ld\n", benchCase->group, benchCase->name, benchCase->arg);
+                continue;
+            }
+
+            WGBenchContext context = { .arg = benchCase->arg, .itemsPerOp = 1 };
+            if (benchCase->setup && !benchCase->setup(&context)) {
+                WGBenchPrintFailure(benchCase, &options);
+                failures++;
+            } else {
+                WGBenchResult result;
+                WGBenchMeasure(benchCase, &context, &options, &result);
+                WGBenchPrintResult(benchCase, &context, &result, &options);
+            }
+            if (benchCase->teardown) {
+                benchCase->teardown(&context);
+            }
+            fflush(stdout);
+        }
+    }
+    return failures > 0 ? 1 : 0;
+}
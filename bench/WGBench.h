@@ -0,0 +1,83 @@
+/*
+ * WGBench.h - Benchmark Harness
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * Headless harness for the portable Core/ and Utils/ C modules, built by
+ * the Linux CMake target. Each case is calibrated to a minimum sample time,
+ * sampled several times and reported as ns/op (min, median, p90, mean)
+ * plus item and byte throughput. Results go to stdout as JSON lines by
+ * default so per-tick regressions can be tracked by a script.
+ */
+
+#ifndef WG_BENCH_H
+#define WG_BENCH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Per-case state; setup fills fixture and the per-op counters
+typedef struct {
+    void *fixture;
+    long arg;                   // Size parameter of the case
+    uint64_t itemsPerOp;        // Records, rows, events... handled by one op
+    uint64_t bytesPerOp;        // Input or output bytes of one op, 0 if n/a
+} WGBenchContext;
+
+typedef bool (*WGBenchSetupFn)(WGBenchContext *context);
+typedef void (*WGBenchRunFn)(WGBenchContext *context, uint64_t iterations);
+typedef void (*WGBenchTeardownFn)(WGBenchContext *context);
+
+typedef struct {
+    const char *group;          // "arp", "export", ...
+    const char *name;
+    long arg;
+    WGBenchSetupFn setup;       // May be NULL
+    WGBenchRunFn run;
+    WGBenchTeardownFn teardown; // May be NULL; called even if setup failed
+} WGBenchCase;
+
+typedef struct {
+    const WGBenchCase *cases;
+    size_t count;
+} WGBenchSuite;
+
+// Suites (one per bench/WGBench*.c)
+extern const WGBenchSuite WGBenchARPSuite;
+extern const WGBenchSuite WGBenchScanSuite;
+extern const WGBenchSuite WGBenchExportSuite;
+extern const WGBenchSuite WGBenchUtilsSuite;
+
+// Keeps a computed value alive without an observable side effect
+static inline void WGBenchKeep(uint64_t value) {
+#if defined(__GNUC__)
+    __asm__ volatile("" : : "r"(value) : "memory");
+#else
+    static volatile uint64_t sink;
+    sink = value;
+#endif
+}
+
+// Deterministic xorshift64* for fixtures
+static inline uint64_t WGBenchRandom(uint64_t *state) {
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+// Fixture helpers
+int WGBenchOpenNull(void);          // Write-only /dev/null
+int WGBenchOpenTemporary(void);     // Read-write file in TMPDIR, already unlinked
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WG_BENCH_H */
@@ -0,0 +1,363 @@
+/*
+ * WGBenchARP.c - ARP Parsing / Analysis Benchmarks
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * Per-tick cost of WGARPDetector: decoding the sysctl dump, the analyzer
+ * check behind analyzeARPTable (steady and churning tables) and the MAC
+ * change rate window. The shard cases run the same churning check over
+ * arg interfaces (WGARPShards), on one thread and on one per interface.
+ * Also compiling and playing back a large synthetic simulation scenario
+ * (WGScenarioScript).
+ */
+
+#include "WGBench.h"
+#include "WGARPAnalyzer.h"
+#include "WGARPShards.h"
+#include "WGARPTable.h"
+#include "WGRateWindow.h"
+#include "WGScenarioScript.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+typedef struct {
+    WGARPTable table;
+    WGARPTable current;
+    WGARPAnalyzer analyzer;
+    void *dump;
+    size_t dumpLength;
+    uint64_t random;
+} WGBenchARPFixture;
+
+// Hosts on 10.0.0.0/8 with distinct locally administered MACs
+static void WGBenchARPFill(WGARPTable *table, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        table->records[i] = (WGARPRecord){
+            .mac = 0x020000000000ULL | (uint64_t)(i + 1),
+            .ip = 0x0A000000u | (uint32_t)(i + 1),
+            .ifindex = 1,
+            .flags = WGARPRecordFlagComplete
+        };
+    }
+    table->count = count;
+}
+
+static bool WGBenchARPSetup(WGBenchContext *context) {
+    WGBenchARPFixture *fixture = calloc(1, sizeof(*fixture));
+    if (!fixture) {
+        return false;
+    }
+    context->fixture = fixture;
+    WGARPTableInit(&fixture->table);
+    WGARPTableInit(&fixture->current);
+    fixture->random = 0x9E3779B97F4A7C15ULL;
+
+    size_t count = (size_t)context->arg;
+    if (!WGARPAnalyzerInit(&fixture->analyzer) ||
+        !WGARPTableReserve(&fixture->table, count)) {
+        return false;
+    }
+    WGBenchARPFill(&fixture->table, count);
+
+    fixture->dumpLength = WGARPDumpEncode(fixture->table.records, count, NULL, 0);
+    fixture->dump = malloc(fixture->dumpLength);
+    if (!fixture->dump) {
+        return false;
+    }
+    WGARPDumpEncode(fixture->table.records, count, fixture->dump, fixture->dumpLength);
+
+    // Baseline check so the measured ones diff against a previous table
+    fixture->analyzer.alertOnMACChange = true;
+    fixture->analyzer.alertOnDuplicateMAC = true;
+    context->itemsPerOp = count;
+    context->bytesPerOp = fixture->dumpLength;
+    return WGARPTableCopy(&fixture->current, &fixture->table) &&
+           WGARPAnalyzerCheck(&fixture->analyzer, &fixture->current);
+}
+
+static void WGBenchARPTeardown(WGBenchContext *context) {
+    WGBenchARPFixture *fixture = context->fixture;
+    if (!fixture) {
+        return;
+    }
+    WGARPTableFree(&fixture->table);
+    WGARPTableFree(&fixture->current);
+    WGARPAnalyzerFree(&fixture->analyzer);
+    free(fixture->dump);
+    free(fixture);
+}
+
+static void WGBenchARPParseDump(WGBenchContext *context, uint64_t iterations) {
+    WGBenchARPFixture *fixture = context->fixture;
+    for (uint64_t i = 0; i < iterations; i++) {
+        WGBenchKeep((uint64_t)WGARPTableParseDump(&fixture->current, fixture->dump, fixture->dumpLength));
+    }
+}
+
+// A quiet network: the table is unchanged between checks
+static void WGBenchARPCheckSteady(WGBenchContext *context, uint64_t iterations) {
+    WGBenchARPFixture *fixture = context->fixture;
+    for (uint64_t i = 0; i < iterations; i++) {
+        WGARPTableCopy(&fixture->current, &fixture->table);
+        WGBenchKeep(WGARPAnalyzerCheck(&fixture->analyzer, &fixture->current));
+    }
+}
+
+// Every check re-addresses 1% of the hosts (MAC changes and duplicates)
+static void WGBenchARPCheckChurn(WGBenchContext *context, uint64_t iterations) {
+    WGBenchARPFixture *fixture = context->fixture;
+    size_t count = fixture->table.count;
+    size_t churn = count / 100 ? count / 100 : 1;
+    for (uint64_t i = 0; i < iterations; i++) {
+        WGARPTableCopy(&fixture->current, &fixture->table);
+        for (size_t k = 0; k < churn; k++) {
+            size_t victim = (size_t)(WGBenchRandom(&fixture->random) % count);
+            fixture->current.records[victim].mac ^= (uint64_t)(i & 1 ? 0x10000 : 0x20000);
+        }
+        WGBenchKeep(WGARPAnalyzerCheck(&fixture->analyzer, &fixture->current));
+    }
+}
+
+#pragma mark - Shards
+
+#define WG_BENCH_SHARD_HOSTS 4096
+
+typedef struct {
+    WGARPTable table;       // Every interface's hosts, grouped by interface
+    WGARPTable current;
+    WGARPShardSet shards;
+    unsigned threads;
+    uint64_t random;
+} WGBenchShardFixture;
+
+// arg interfaces with the same hosts behind each (a device bridged over
+// Wi-Fi and USB), so a shared analyzer would report every MAC as duplicate
+static bool WGBenchShardSetup(WGBenchContext *context, bool parallel) {
+    WGBenchShardFixture *fixture = calloc(1, sizeof(*fixture));
+    if (!fixture) {
+        return false;
+    }
+    context->fixture = fixture;
+    WGARPTableInit(&fixture->table);
+    WGARPTableInit(&fixture->current);
+    fixture->random = 0x9E3779B97F4A7C15ULL;
+
+    size_t interfaces = (size_t)context->arg;
+    size_t count = interfaces * WG_BENCH_SHARD_HOSTS;
+    if (!WGARPShardSetInit(&fixture->shards, NULL, NULL) ||
+        !WGARPTableReserve(&fixture->table, count)) {
+        return false;
+    }
+    WGBenchARPFill(&fixture->table, WG_BENCH_SHARD_HOSTS);
+    for (size_t i = WG_BENCH_SHARD_HOSTS; i < count; i++) {
+        fixture->table.records[i] = fixture->table.records[i % WG_BENCH_SHARD_HOSTS];
+        fixture->table.records[i].ifindex = (uint16_t)(i / WG_BENCH_SHARD_HOSTS + 1);
+    }
+    fixture->table.count = count;
+
+    // Gateways go through the route dump path WGARPDetector uses
+    WGARPRecord gateways[interfaces];
+    for (size_t i = 0; i < interfaces; i++) {
+        gateways[i] = (WGARPRecord){ .ip = 0x0A000001u, .ifindex = (uint16_t)(i + 1) };
+    }
+    size_t dumpLength = WGARPGatewayDumpEncode(gateways, interfaces, NULL, 0);
+    void *dump = malloc(dumpLength);
+    WGARPTable parsed;
+    WGARPTableInit(&parsed);
+    bool routed = dump &&
+                  WGARPGatewayDumpEncode(gateways, interfaces, dump, dumpLength) == dumpLength &&
+                  WGARPTableParseGateways(&parsed, dump, dumpLength) == (long)interfaces;
+    for (size_t i = 0; routed && i < parsed.count; i++) {
+        routed = WGARPShardSetGateway(&fixture->shards, parsed.records[i].ifindex, parsed.records[i].ip);
+    }
+    WGARPTableFree(&parsed);
+    free(dump);
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    fixture->threads = parallel && cpus > 1 ? (unsigned)(cpus < context->arg ? cpus : context->arg) : 1;
+    context->itemsPerOp = count;
+
+    // Baseline pass: per-interface analysis must find nothing
+    if (!routed ||
+        !WGARPShardSetPartition(&fixture->shards, &fixture->table)) {
+        return false;
+    }
+    WGARPShardSetCheckAll(&fixture->shards, fixture->threads);
+    return WGARPShardSetMerge(&fixture->shards) &&
+           fixture->shards.count == interfaces &&
+           fixture->shards.findingCount == 0 &&
+           WGARPShardSetEntryCount(&fixture->shards) == count;
+}
+
+static bool WGBenchShardSetupSerial(WGBenchContext *context) {
+    return WGBenchShardSetup(context, false);
+}
+
+// One thread per interface, up to the core count
+static bool WGBenchShardSetupParallel(WGBenchContext *context) {
+    return WGBenchShardSetup(context, true);
+}
+
+static void WGBenchShardTeardown(WGBenchContext *context) {
+    WGBenchShardFixture *fixture = context->fixture;
+    if (!fixture) {
+        return;
+    }
+    WGARPTableFree(&fixture->table);
+    WGARPTableFree(&fixture->current);
+    WGARPShardSetFree(&fixture->shards);
+    free(fixture);
+}
+
+// analyze_churn on every interface, then the merge WGARPDetector reads
+static void WGBenchShardCheck(WGBenchContext *context, uint64_t iterations) {
+    WGBenchShardFixture *fixture = context->fixture;
+    size_t count = fixture->table.count;
+    size_t churn = count / 100 ? count / 100 : 1;
+    for (uint64_t i = 0; i < iterations; i++) {
+        WGARPTableCopy(&fixture->current, &fixture->table);
+        for (size_t k = 0; k < churn; k++) {
+            size_t victim = (size_t)(WGBenchRandom(&fixture->random) % count);
+            fixture->current.records[victim].mac ^= (uint64_t)(i & 1 ? 0x10000 : 0x20000);
+        }
+        WGARPShardSetPartition(&fixture->shards, &fixture->current);
+        WGARPShardSetCheckAll(&fixture->shards, fixture->threads);
+        WGBenchKeep(WGARPShardSetMerge(&fixture->shards) + fixture->shards.findingCount);
+    }
+}
+
+#pragma mark - Rate Window
+
+typedef struct {
+    WGRateWindow window;
+    uint64_t nowUs;     // Virtual clock
+    uint64_t random;
+} WGBenchRateFixture;
+
+static uint64_t WGBenchRateClock(void *context) {
+    return ((WGBenchRateFixture *)context)->nowUs / 1000;
+}
+
+static bool WGBenchRateSetup(WGBenchContext *context) {
+    WGBenchRateFixture *fixture = calloc(1, sizeof(*fixture));
+    if (!fixture) {
+        return false;
+    }
+    context->fixture = fixture;
+    fixture->random = 0x2545F4914F6CDD1DULL;
+    return WGRateWindowInit(&fixture->window, WGBenchRateClock, fixture) &&
+           WGRateWindowConfigure(&fixture->window, 60000, 60, 10, 5, 1000);
+}
+
+static void WGBenchRateTeardown(WGBenchContext *context) {
+    WGBenchRateFixture *fixture = context->fixture;
+    if (fixture) {
+        WGRateWindowFree(&fixture->window);
+        free(fixture);
+    }
+}
+
+// arg events per virtual second over arg / 100 distinct hosts
+static void WGBenchRateRecord(WGBenchContext *context, uint64_t iterations) {
+    WGBenchRateFixture *fixture = context->fixture;
+    uint64_t stepUs = 1000000 / (uint64_t)context->arg;
+    uint64_t hosts = (uint64_t)context->arg / 100;
+    for (uint64_t i = 0; i < iterations; i++) {
+        uint64_t host = WGBenchRandom(&fixture->random) % hosts;
+        fixture->nowUs += stepUs;
+        WGRateWindowRecord(&fixture->window, 0x0A000000u | (uint32_t)host, 0x020000000000ULL | (i & 0xffff));
+        WGRateWindowClearOffenders(&fixture->window);
+    }
+}
+
+typedef struct {
+    char *text;
+    size_t length;
+    WGScenarioScript script;
+} WGBenchScenarioFixture;
+
+// arg clients, each re-leased ten times, with narration every second
+static bool WGBenchScenarioSetup(WGBenchContext *context) {
+    WGBenchScenarioFixture *fixture = calloc(1, sizeof(*fixture));
+    if (!fixture) {
+        return false;
+    }
+    context->fixture = fixture;
+
+    long events = context->arg * 10;
+    size_t capacity = 1024;
+    fixture->text = malloc(capacity);
+    if (!fixture->text) {
+        return false;
+    }
+    int length = snprintf(fixture->text, capacity,
+                          "scenario Bench\n"
+                          "host gateway gateway 10.0.0.1 02:00:00:00:00:01\n"
+                          "host attacker attacker 10.0.0.2 0e:00:00:00:00:01\n"
+                          "hosts client %ld client 10.1.0.1 02:00:00:01:00:00\n"
+                          "table victim gateway attacker client*\n"
+                          "@1s every 10ms x %ld set victim client* random\n"
+                          "@1s every 1s x %ld note CHURN Re-lease batch {n}\n"
+                          "@5s set victim gateway attacker malicious\n"
+                          "@5s expect gateway_mac_change gateway\n",
+                          context->arg, events, events / 100 + 1);
+    fixture->length = (size_t)length;
+    context->itemsPerOp = (uint64_t)events;
+    context->bytesPerOp = fixture->length;
+    return WGScenarioScriptLoad(&fixture->script, fixture->text, fixture->length) == WGScenarioErrorNone;
+}
+
+static void WGBenchScenarioTeardown(WGBenchContext *context) {
+    WGBenchScenarioFixture *fixture = context->fixture;
+    if (fixture) {
+        WGScenarioScriptFree(&fixture->script);
+        free(fixture->text);
+        free(fixture);
+    }
+}
+
+static void WGBenchScenarioCompile(WGBenchContext *context, uint64_t iterations) {
+    WGBenchScenarioFixture *fixture = context->fixture;
+    for (uint64_t i = 0; i < iterations; i++) {
+        WGScenarioScript script;
+        WGScenarioScriptLoad(&script, fixture->text, fixture->length);
+        WGBenchKeep(script.eventCount);
+        WGScenarioScriptFree(&script);
+    }
+}
+
+// Interactive playback: one advance per 1 s tick over the whole timeline
+static void WGBenchScenarioPlayback(WGBenchContext *context, uint64_t iterations) {
+    const WGScenarioScript *script = &((WGBenchScenarioFixture *)context->fixture)->script;
+    for (uint64_t i = 0; i < iterations; i++) {
+        size_t cursor = 0;
+        uint64_t malicious = 0;
+        for (uint64_t nowMs = 0; cursor < script->eventCount; nowMs += 1000) {
+            const WGScenarioEvent *batch = NULL;
+            size_t count = WGScenarioScriptAdvance(script, &cursor, nowMs, &batch);
+            for (size_t j = 0; j < count; j++) {
+                malicious += batch[j].flags & WGScenarioEventMalicious;
+            }
+        }
+        WGBenchKeep(malicious);
+    }
+}
+
+static const WGBenchCase kWGBenchARPCases[] = {
+    { "arp", "parse_dump",        256,    WGBenchARPSetup,  WGBenchARPParseDump,   WGBenchARPTeardown },
+    { "arp", "parse_dump",        4096,   WGBenchARPSetup,  WGBenchARPParseDump,   WGBenchARPTeardown },
+    { "arp", "analyze_steady",    256,    WGBenchARPSetup,  WGBenchARPCheckSteady, WGBenchARPTeardown },
+    { "arp", "analyze_steady",    4096,   WGBenchARPSetup,  WGBenchARPCheckSteady, WGBenchARPTeardown },
+    { "arp", "analyze_churn",     256,    WGBenchARPSetup,  WGBenchARPCheckChurn,  WGBenchARPTeardown },
+    { "arp", "analyze_churn",     4096,   WGBenchARPSetup,  WGBenchARPCheckChurn,  WGBenchARPTeardown },
+    { "arp", "shards_serial",     4,      WGBenchShardSetupSerial,   WGBenchShardCheck, WGBenchShardTeardown },
+    { "arp", "shards_parallel",   4,      WGBenchShardSetupParallel, WGBenchShardCheck, WGBenchShardTeardown },
+    { "arp", "rate_window_record", 100000, WGBenchRateSetup, WGBenchRateRecord,    WGBenchRateTeardown },
+    { "arp", "scenario_compile",  10000,  WGBenchScenarioSetup, WGBenchScenarioCompile,  WGBenchScenarioTeardown },
+    { "arp", "scenario_playback", 10000,  WGBenchScenarioSetup, WGBenchScenarioPlayback, WGBenchScenarioTeardown },
+};
+
+const WGBenchSuite WGBenchARPSuite = {
+    kWGBenchARPCases, sizeof(kWGBenchARPCases) / sizeof(kWGBenchARPCases[0])
+};
@@ -0,0 +1,1119 @@
+/*
+ * WGBenchExport.c - Export / Persistence Benchmarks
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * WGDataExporter network rows (CSV / JSON, plain and encrypted, per-file
+ * password versus export session) and whole Export All runs, WGEncryption's
+ * in-memory format and the chunked stream cipher, WGAuditLogger's writer
+ * and segmented store, and binary snapshots against decoding the same
+ * data from JSON.
+ */
+
+#include "WGBench.h"
+#include "WGARPTable.h"
+#include "WGAddress.h"
+#include "WGCrypto.h"
+#include "WGCryptoStream.h"
+#include "WGExportText.h"
+#include "WGLogStore.h"
+#include "WGLogWriter.h"
+#include "WGSnapshot.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static const char kWGBenchPassword[] = "correct horse battery staple";
+
+#pragma mark - Network Rows
+
+typedef enum {
+    WGBenchExportPlain = 0,
+    WGBenchExportPassword,      // PBKDF2 per file
+    WGBenchExportSession        // Master key derived once, HKDF per file
+} WGBenchExportMode;
+
+typedef struct {
+    WGExportNetwork *networks;
+    char (*ssids)[WG_SCAN_SSID_MAX + 1];
+    char (*bssids)[WG_MAC_STRLEN];
+    WGRSSISample samples[WG_SCAN_HISTORY_CAPACITY];
+    WGStreamMasterKey master;
+    int fd;
+    char directory[256];        // Export All cases only
+    uint64_t fileBytes[5];      // Export All: file sizes for the manifest
+} WGBenchExportFixture;
+
+static bool WGBenchExportSetup(WGBenchContext *context) {
+    WGBenchExportFixture *fixture = calloc(1, sizeof(*fixture));
+    if (!fixture) {
+        return false;
+    }
+    context->fixture = fixture;
+    fixture->fd = WGBenchOpenNull();
+
+    size_t count = (size_t)context->arg;
+    fixture->networks = calloc(count, sizeof(WGExportNetwork));
+    fixture->ssids = calloc(count, sizeof(*fixture->ssids));
+    fixture->bssids = calloc(count, sizeof(*fixture->bssids));
+    if (fixture->fd < 0 || !fixture->networks || !fixture->ssids || !fixture->bssids) {
+        return false;
+    }
+
+    // A full RSSI history per network, one sample per scan interval
+    for (size_t k = 0; k < WG_SCAN_HISTORY_CAPACITY; k++) {
+        fixture->samples[k] = (WGRSSISample){ .timestamp = 1700000000.0 + 5.0 * (double)k, .rssi = (int8_t)(-40 - (int)(k % 30)) };
+    }
+    for (size_t i = 0; i < count; i++) {
+        snprintf(fixture->ssids[i], sizeof(fixture->ssids[i]), i % 7 == 0 ? "Cafe, \"Guest\" %zu" : "net%zu", i);
+        WGMACFormat(0x020000000000ULL | i, fixture->bssids[i]);
+        fixture->networks[i] = (WGExportNetwork){
+            .ssid = i % 11 == 0 ? NULL : fixture->ssids[i],
+            .bssid = fixture->bssids[i],
+            .security = i % 4 ? "WPA2" : "Open",
+            .vendor = i % 5 ? "Cisco Systems, Inc" : NULL,
+            .channel = (long)(i % 3 ? 36 + 4 * (i % 8) : 1 + i % 11),
+            .rssi = -40 - (long)(i % 50),
+            .channelWidth = i % 3 ? 80 : 20,
+            .band = i % 3 ? 1 : 0,
+            .hidden = i % 11 == 0,
+            .lastSeen = 1700000500.0 + (double)i * 0.001,
+            .samples = fixture->samples,
+            .sampleCount = WG_SCAN_HISTORY_CAPACITY
+        };
+    }
+    context->itemsPerOp = count;
+    return WGStreamMasterKeyDerive(&fixture->master, kWGBenchPassword, strlen(kWGBenchPassword));
+}
+
+// Empties and removes a fixture directory (no subdirectories)
+static void WGBenchRemoveDirectory(const char *directory) {
+    DIR *dir = directory[0] ? opendir(directory) : NULL;
+    if (!dir) {
+        return;
+    }
+    char path[512];
+    for (struct dirent *entry; (entry = readdir(dir)) != NULL;) {
+        if (entry->d_name[0] != '.') {
+            snprintf(path, sizeof(path), "%s/%s", directory, entry->d_name);
+            unlink(path);
+        }
+    }
+    closedir(dir);
+    rmdir(directory);
+}
+
+static void WGBenchExportTeardown(WGBenchContext *context) {
+    WGBenchExportFixture *fixture = context->fixture;
+    if (!fixture) {
+        return;
+    }
+    if (fixture->fd >= 0) {
+        close(fixture->fd);
+    }
+    WGBenchRemoveDirectory(fixture->directory);
+    WGStreamMasterKeyWipe(&fixture->master);
+    free(fixture->networks);
+    free(fixture->ssids);
+    free(fixture->bssids);
+    free(fixture);
+}
+
+// One export file, opened and finished like WGDataExporter streamToPath:
+static void WGBenchExportFile(WGBenchContext *context, uint64_t iterations, bool csv, WGBenchExportMode mode) {
+    WGBenchExportFixture *fixture = context->fixture;
+    for (uint64_t i = 0; i < iterations; i++) {
+        WGStreamWriter stream;
+        bool ok;
+        if (mode == WGBenchExportSession) {
+            ok = WGStreamWriterOpenWithMasterKey(&stream, fixture->fd, &fixture->master);
+        } else if (mode == WGBenchExportPassword) {
+            ok = WGStreamWriterOpen(&stream, fixture->fd, kWGBenchPassword, strlen(kWGBenchPassword));
+        } else {
+            ok = WGStreamWriterOpen(&stream, fixture->fd, NULL, 0);
+        }
+
+        WGExportTimeCache cache;
+        WGExportTimeCacheInit(&cache);
+        ok = ok && WGStreamWriterWriteString(&stream, csv ? WG_EXPORT_NETWORKS_CSV_HEADER : "{\n  \"networks\" : [\n");
+        for (long k = 0; ok && k < context->arg; k++) {
+            ok = csv ? WGExportWriteNetworkCSV(&stream, &fixture->networks[k], &cache)
+                     : (k == 0 || WGStreamWriterWriteString(&stream, ",\n    ")) &&
+                       WGExportWriteNetworkJSON(&stream, &fixture->networks[k], &cache);
+        }
+        ok = ok && (csv || WGStreamWriterWriteString(&stream, "\n  ]\n}\n")) && WGStreamWriterFinish(&stream);
+        context->bytesPerOp = stream.bytesIn;
+        WGStreamWriterFree(&stream);
+        WGBenchKeep(ok);
+    }
+}
+
+static void WGBenchExportCSV(WGBenchContext *context, uint64_t iterations) {
+    WGBenchExportFile(context, iterations, true, WGBenchExportPlain);
+}
+
+static void WGBenchExportJSON(WGBenchContext *context, uint64_t iterations) {
+    WGBenchExportFile(context, iterations, false, WGBenchExportPlain);
+}
+
+static void WGBenchExportCSVPassword(WGBenchContext *context, uint64_t iterations) {
+    WGBenchExportFile(context, iterations, true, WGBenchExportPassword);
+}
+
+static void WGBenchExportCSVSession(WGBenchContext *context, uint64_t iterations) {
+    WGBenchExportFile(context, iterations, true, WGBenchExportSession);
+}
+
+#pragma mark - Export All
+
+// WGDataExporter exportAllDataToPath: five JSON files of arg rows each
+// (anomalies a tenth, audit log four times as many), then manifest.json.
+// The password baseline writes them one after another with a PBKDF2 per
+// file; the session case derives one master key per export and writes the
+// files on a worker pool, one thread per file like its dispatch_apply.
+enum { WGBenchExportAllFiles = 5 };
+
+static const char *const kWGBenchExportAllNames[WGBenchExportAllFiles] = {
+    "networks", "arp_table", "anomalies", "audit_log", "metrics"
+};
+
+typedef struct {
+    WGBenchContext *context;
+    size_t file;
+    bool session;
+    bool ok;
+    uint64_t bytes;
+} WGBenchExportJob;
+
+static bool WGBenchExportAllSetup(WGBenchContext *context) {
+    if (!WGBenchExportSetup(context)) {
+        return false;
+    }
+    WGBenchExportFixture *fixture = context->fixture;
+    const char *tmp = getenv("TMPDIR");
+    snprintf(fixture->directory, sizeof(fixture->directory), "%s/wgbench-export.XXXXXX", tmp && *tmp ? tmp : "/tmp");
+    if (!mkdtemp(fixture->directory)) {
+        fixture->directory[0] = '\0';
+        return false;
+    }
+    return true;
+}
+
+static bool WGBenchExportAllRows(WGBenchContext *context, size_t file, WGStreamWriter *stream) {
+    WGBenchExportFixture *fixture = context->fixture;
+    static const char *const kHeaders[WGBenchExportAllFiles] = {
+        "{\n  \"networks\" : [\n",
+        "{\"exportType\":\"ARPTable\",\"exportedAt\":\"2023-11-14 22:13:20 +0000\",\"entries\":[",
+        "{\"exportType\":\"ARPAnomalies\",\"exportedAt\":\"2023-11-14 22:13:20 +0000\",\"anomalies\":[",
+        "{\"sessionId\":\"6F9619FF-8B86-D011-B42D-00C04FC964FF\",\"exportedAt\":\"2023-11-14 22:13:20 +0000\",\"entries\":[",
+        "{\"exportType\":\"Metrics\",\"stages\":["
+    };
+    size_t count = (size_t)context->arg;
+    size_t rows = file == 2 ? count / 10 : file == 3 ? count * 4 : file == 4 ? 16 : count;
+
+    WGExportTimeCache cache;
+    WGExportTimeCacheInit(&cache);
+    bool ok = WGStreamWriterWriteString(stream, kHeaders[file]);
+    for (size_t k = 0; ok && k < rows; k++) {
+        char row[320];
+        char mac[WG_MAC_STRLEN];
+        WGMACFormat(0x020000100000ULL | k, mac);
+        switch (file) {
+            case 1:
+                snprintf(row, sizeof(row), "%s{\"ipAddress\":\"10.0.%zu.%zu\",\"macAddress\":\"%s\","
+                         "\"vendor\":\"Cisco Systems, Inc\",\"interface\":\"en0\",\"isComplete\":true,"
+                         "\"isPermanent\":false,\"firstSeen\":\"2023-11-14 22:13:20 +0000\","
+                         "\"lastSeen\":\"2023-11-14 22:21:40 +0000\"}",
+                         k ? "," : "", (k >> 8) & 0xFF, k & 0xFF, mac);
+                break;
+            case 2:
+                snprintf(row, sizeof(row), "%s{\"detectedAt\":\"2023-11-14 22:13:20 +0000\",\"typeName\":\"MAC Change\","
+                         "\"ipAddress\":\"10.0.0.%zu\",\"previousMAC\":\"02:00:00:00:00:01\",\"currentMAC\":\"%s\","
+                         "\"severity\":6,\"details\":\"IP address MAC changed\"}",
+                         k ? "," : "", k & 0xFF, mac);
+                break;
+            case 3:
+                snprintf(row, sizeof(row), "%s{\"timestamp\":\"2023-11-14 22:13:20 +0000\",\"eventType\":\"ARP_ANOMALY\","
+                         "\"details\":\"IP 192.168.1.1 changed MAC from 02:00:00:00:00:01 to %s\","
+                         "\"sessionId\":\"6F9619FF-8B86-D011-B42D-00C04FC964FF\"}",
+                         k ? "," : "", mac);
+                break;
+            case 4:
+                snprintf(row, sizeof(row), "%s{\"stage\":%zu,\"count\":%zu,\"p50\":1200,\"p99\":8400}",
+                         k ? "," : "", k, count);
+                break;
+            default:
+                row[0] = '\0';
+                ok = (k == 0 || WGStreamWriterWriteString(stream, ",\n    ")) &&
+                     WGExportWriteNetworkJSON(stream, &fixture->networks[k], &cache);
+                break;
+        }
+        ok = ok && WGStreamWriterWriteString(stream, row);
+    }
+    return ok && WGStreamWriterWriteString(stream, file == 0 ? "\n  ]\n}\n" : "]}\n");
+}
+
+// One file through a temporary and a rename, like WGDataExporter streamToPath:
+static bool WGBenchExportAllWrite(WGBenchContext *context, const char *name, size_t file,
+                                  const WGStreamMasterKey *master, uint64_t *bytes) {
+    WGBenchExportFixture *fixture = context->fixture;
+    char path[320], temporary[336];
+    snprintf(path, sizeof(path), "%s/%s", fixture->directory, name);
+    snprintf(temporary, sizeof(temporary), "%s.XXXXXX", path);
+    int fd = mkstemp(temporary);
+    if (fd < 0) {
+        return false;
+    }
+
+    WGStreamWriter stream;
+    bool ok;
+    if (file == WGBenchExportAllFiles) {
+        ok = WGStreamWriterOpen(&stream, fd, NULL, 0);
+    } else if (master) {
+        ok = WGStreamWriterOpenWithMasterKey(&stream, fd, master);
+    } else {
+        ok = WGStreamWriterOpen(&stream, fd, kWGBenchPassword, strlen(kWGBenchPassword));
+    }
+    if (file == WGBenchExportAllFiles) {
+        ok = ok && WGStreamWriterWriteString(&stream, "{\"formatVersion\":2,\"encrypted\":true,\"files\":[");
+        for (size_t k = 0; ok && k < WGBenchExportAllFiles; k++) {
+            char entry[96];
+            snprintf(entry, sizeof(entry), "%s{\"name\":\"%s.json.enc\",\"bytes\":%llu}",
+                     k ? "," : "", kWGBenchExportAllNames[k], (unsigned long long)fixture->fileBytes[k]);
+            ok = WGStreamWriterWriteString(&stream, entry);
+        }
+        ok = ok && WGStreamWriterWriteString(&stream, "]}\n");
+    } else {
+        ok = ok && WGBenchExportAllRows(context, file, &stream);
+    }
+    ok = ok && WGStreamWriterFinish(&stream);
+    *bytes = stream.bytesOut;
+    WGStreamWriterFree(&stream);
+
+    ok = ok && fsync(fd) == 0;
+    close(fd);
+    if (!ok || rename(temporary, path) != 0) {
+        unlink(temporary);
+        return false;
+    }
+    return true;
+}
+
+static void *WGBenchExportAllJob(void *argument) {
+    WGBenchExportJob *job = argument;
+    WGBenchExportFixture *fixture = job->context->fixture;
+    char name[32];
+    snprintf(name, sizeof(name), "%s.json.enc", kWGBenchExportAllNames[job->file]);
+    job->ok = WGBenchExportAllWrite(job->context, name, job->file, job->session ? &fixture->master : NULL,
+                                    &job->bytes);
+    return NULL;
+}
+
+static void WGBenchExportAll(WGBenchContext *context, uint64_t iterations, bool session) {
+    WGBenchExportFixture *fixture = context->fixture;
+    for (uint64_t i = 0; i < iterations; i++) {
+        WGBenchExportJob jobs[WGBenchExportAllFiles];
+        for (size_t f = 0; f < WGBenchExportAllFiles; f++) {
+            jobs[f] = (WGBenchExportJob){ context, f, session, false, 0 };
+        }
+
+        if (session) {
+            // One PBKDF2 per export, not one for the whole run
+            WGStreamMasterKeyWipe(&fixture->master);
+            bool ok = WGStreamMasterKeyDerive(&fixture->master, kWGBenchPassword, strlen(kWGBenchPassword));
+            pthread_t tids[WGBenchExportAllFiles];
+            bool started[WGBenchExportAllFiles] = { false };
+            for (size_t f = 1; ok && f < WGBenchExportAllFiles; f++) {
+                started[f] = pthread_create(&tids[f], NULL, WGBenchExportAllJob, &jobs[f]) == 0;
+            }
+            if (ok) {
+                WGBenchExportAllJob(&jobs[0]);
+            }
+            for (size_t f = 1; ok && f < WGBenchExportAllFiles; f++) {
+                if (started[f]) {
+                    pthread_join(tids[f], NULL);
+                } else {
+                    WGBenchExportAllJob(&jobs[f]);
+                }
+            }
+        } else {
+            for (size_t f = 0; f < WGBenchExportAllFiles; f++) {
+                WGBenchExportAllJob(&jobs[f]);
+            }
+        }
+
+        // The manifest goes last
+        bool ok = true;
+        uint64_t bytes = 0;
+        for (size_t f = 0; f < WGBenchExportAllFiles; f++) {
+            ok = ok && jobs[f].ok;
+            bytes += jobs[f].bytes;
+            fixture->fileBytes[f] = jobs[f].bytes;
+        }
+        uint64_t manifestBytes = 0;
+        ok = ok && WGBenchExportAllWrite(context, "manifest.json", WGBenchExportAllFiles, NULL, &manifestBytes);
+        context->bytesPerOp = bytes + manifestBytes;
+        WGBenchKeep(ok);
+    }
+}
+
+static void WGBenchExportAllPassword(WGBenchContext *context, uint64_t iterations) {
+    WGBenchExportAll(context, iterations, false);
+}
+
+static void WGBenchExportAllSession(WGBenchContext *context, uint64_t iterations) {
+    WGBenchExportAll(context, iterations, true);
+}
+
+#pragma mark - Encryption
+
+typedef struct {
+    uint8_t *plain;
+    uint8_t *sealed;
+    size_t sealedLength;
+    uint8_t *output;
+    WGStreamMasterKey master;
+    int nullFD;
+    int encryptedFD;
+} WGBenchCryptoFixture;
+
+static bool WGBenchCryptoSetup(WGBenchContext *context) {
+    WGBenchCryptoFixture *fixture = calloc(1, sizeof(*fixture));
+    if (!fixture) {
+        return false;
+    }
+    context->fixture = fixture;
+    fixture->nullFD = WGBenchOpenNull();
+    fixture->encryptedFD = WGBenchOpenTemporary();
+
+    size_t length = (size_t)context->arg;
+    fixture->plain = malloc(length);
+    fixture->sealed = malloc(WG_CRYPTO_SEALED_MAX(length));
+    fixture->output = malloc(WG_CRYPTO_SEALED_MAX(length));
+    if (fixture->nullFD < 0 || fixture->encryptedFD < 0 ||
+        !fixture->plain || !fixture->sealed || !fixture->output) {
+        return false;
+    }
+    uint64_t random = 0x9E3779B97F4A7C15ULL;
+    for (size_t i = 0; i < length; i++) {
+        fixture->plain[i] = (uint8_t)WGBenchRandom(&random);
+    }
+    context->bytesPerOp = length;
+
+    // Session-format file for the decrypt case
+    WGStreamWriter stream;
+    bool ok = WGStreamMasterKeyDerive(&fixture->master, kWGBenchPassword, strlen(kWGBenchPassword)) &&
+              WGCryptoSeal(kWGBenchPassword, strlen(kWGBenchPassword), fixture->plain, length,
+                           fixture->sealed, WG_CRYPTO_SEALED_MAX(length), &fixture->sealedLength) &&
+              WGStreamWriterOpenWithMasterKey(&stream, fixture->encryptedFD, &fixture->master);
+    if (!ok) {
+        return false;
+    }
+    ok = WGStreamWriterWrite(&stream, fixture->plain, length) && WGStreamWriterFinish(&stream);
+    WGStreamWriterFree(&stream);
+
+    // The timed loops only keep the result, so check once here that both
+    // formats decrypt back to the input
+    size_t opened = 0;
+    ok = ok && WGCryptoOpen(kWGBenchPassword, strlen(kWGBenchPassword), fixture->sealed, fixture->sealedLength,
+                            fixture->output, WG_CRYPTO_SEALED_MAX(length), &opened) &&
+         opened == length && memcmp(fixture->output, fixture->plain, length) == 0;
+    int decryptedFD = ok ? WGBenchOpenTemporary() : -1;
+    WGStreamError error;
+    ok = decryptedFD >= 0 && lseek(fixture->encryptedFD, 0, SEEK_SET) == 0 &&
+         WGStreamDecryptFD(fixture->encryptedFD, decryptedFD, kWGBenchPassword, strlen(kWGBenchPassword),
+                           &fixture->master, &error) &&
+         lseek(decryptedFD, 0, SEEK_SET) == 0 &&
+         read(decryptedFD, fixture->output, length + 1) == (ssize_t)length &&
+         memcmp(fixture->output, fixture->plain, length) == 0;
+    if (decryptedFD >= 0) {
+        close(decryptedFD);
+    }
+    return ok;
+}
+
+static void WGBenchCryptoTeardown(WGBenchContext *context) {
+    WGBenchCryptoFixture *fixture = context->fixture;
+    if (!fixture) {
+        return;
+    }
+    if (fixture->nullFD >= 0) {
+        close(fixture->nullFD);
+    }
+    if (fixture->encryptedFD >= 0) {
+        close(fixture->encryptedFD);
+    }
+    WGStreamMasterKeyWipe(&fixture->master);
+    free(fixture->plain);
+    free(fixture->sealed);
+    free(fixture->output);
+    free(fixture);
+}
+
+// WGEncryption encryptData:/decryptData: (PBKDF2 dominates small inputs)
+static void WGBenchCryptoSeal(WGBenchContext *context, uint64_t iterations) {
+    WGBenchCryptoFixture *fixture = context->fixture;
+    size_t length = (size_t)context->arg;
+    for (uint64_t i = 0; i < iterations; i++) {
+        size_t written = 0;
+        WGBenchKeep(WGCryptoSeal(kWGBenchPassword, strlen(kWGBenchPassword), fixture->plain, length,
+                                 fixture->output, WG_CRYPTO_SEALED_MAX(length), &written));
+    }
+}
+
+static void WGBenchCryptoOpen(WGBenchContext *context, uint64_t iterations) {
+    WGBenchCryptoFixture *fixture = context->fixture;
+    for (uint64_t i = 0; i < iterations; i++) {
+        size_t written = 0;
+        WGBenchKeep(WGCryptoOpen(kWGBenchPassword, strlen(kWGBenchPassword), fixture->sealed, fixture->sealedLength,
+                                 fixture->output, WG_CRYPTO_SEALED_MAX((size_t)context->arg), &written));
+    }
+}
+
+// Stream cipher throughput under a session key (no per-op PBKDF2)
+static void WGBenchCryptoStreamEncrypt(WGBenchContext *context, uint64_t iterations) {
+    WGBenchCryptoFixture *fixture = context->fixture;
+    for (uint64_t i = 0; i < iterations; i++) {
+        WGStreamWriter stream;
+        bool ok = WGStreamWriterOpenWithMasterKey(&stream, fixture->nullFD, &fixture->master) &&
+                  WGStreamWriterWrite(&stream, fixture->plain, (size_t)context->arg) &&
+                  WGStreamWriterFinish(&stream);
+        WGStreamWriterFree(&stream);
+        WGBenchKeep(ok);
+    }
+}
+
+static void WGBenchCryptoStreamDecrypt(WGBenchContext *context, uint64_t iterations) {
+    WGBenchCryptoFixture *fixture = context->fixture;
+    for (uint64_t i = 0; i < iterations; i++) {
+        WGStreamError error;
+        lseek(fixture->encryptedFD, 0, SEEK_SET);
+        WGBenchKeep(WGStreamDecryptFD(fixture->encryptedFD, fixture->nullFD, kWGBenchPassword,
+                                      strlen(kWGBenchPassword), &fixture->master, &error));
+    }
+}
+
+#pragma mark - Audit Log
+
+typedef struct {
+    WGLogWriter writer;
+    bool opened;
+    double clock;
+    uint64_t commits;
+} WGBenchLogFixture;
+
+static bool WGBenchLogSetup(WGBenchContext *context) {
+    WGBenchLogFixture *fixture = calloc(1, sizeof(*fixture));
+    if (!fixture) {
+        return false;
+    }
+    context->fixture = fixture;
+    fixture->clock = 1700000000.0;
+
+    // arg 0: append only to /dev/null; otherwise commit (write + fsync) every arg entries
+    int fd = context->arg ? WGBenchOpenTemporary() : WGBenchOpenNull();
+    if (fd < 0) {
+        return false;
+    }
+    WGLogCommitPolicy policy = WGLogCommitPolicyDefault();
+    policy.maxPendingEntries = context->arg ? (uint32_t)context->arg : UINT32_MAX;
+    policy.immediateSeverity = 11;
+    fixture->opened = WGLogWriterOpen(&fixture->writer, fd, 64 * 1024, policy);
+    if (!fixture->opened) {
+        close(fd);
+    }
+    context->itemsPerOp = context->arg ? (uint64_t)context->arg : 1;
+    return fixture->opened;
+}
+
+static void WGBenchLogTeardown(WGBenchContext *context) {
+    WGBenchLogFixture *fixture = context->fixture;
+    if (!fixture) {
+        return;
+    }
+    if (fixture->opened) {
+        WGLogWriterClose(&fixture->writer);
+    }
+    free(fixture);
+}
+
+static void WGBenchLogAppend(WGBenchContext *context, uint64_t iterations) {
+    WGBenchLogFixture *fixture = context->fixture;
+    uint64_t entries = iterations * (context->arg ? (uint64_t)context->arg : 1);
+    for (uint64_t i = 0; i < entries; i++) {
+        fixture->clock += 0.001;
+        if (WGLogWriterAppend(&fixture->writer, fixture->clock, "ARP_ANOMALY",
+                              "IP 192.168.1.1 changed MAC from 02:00:00:00:00:01 to 02:00:00:00:00:02",
+                              "6F9619FF-8B86-D011-B42D-00C04FC964FF", (int)(i % 10))) {
+            WGLogWriterCommit(&fixture->writer);
+
+            // Keep the temporary file from growing without bound
+            if (++fixture->commits % 4096 == 0) {
+                WGBenchKeep((uint64_t)ftruncate(fixture->writer.fd, 0));
+                lseek(fixture->writer.fd, 0, SEEK_SET);
+            }
+        }
+    }
+}
+
+#pragma mark - Audit Log Store
+
+typedef struct {
+    WGLogStore store;
+    bool opened;
+    char directory[256];
+    uint64_t clock;             // µs
+    uint64_t first;
+    uint64_t random;
+} WGBenchStoreFixture;
+
+static const char kWGBenchStoreDetails[] = "IP 192.168.1.1 changed MAC from 02:00:00:00:00:01 to 02:00:00:00:00:02";
+
+static bool WGBenchStoreAppendOne(WGBenchStoreFixture *fixture) {
+    fixture->clock += 1000;
+    WGLogRecord record = {
+        .time = fixture->clock,
+        .eventType = "ARP_ANOMALY",
+        .eventTypeLength = 11,
+        .details = kWGBenchStoreDetails,
+        .detailsLength = sizeof(kWGBenchStoreDetails) - 1,
+        .sessionId = "6F9619FF-8B86-D011-B42D-00C04FC964FF",
+        .sessionIdLength = 36
+    };
+    return WGLogStoreAppend(&fixture->store, &record);
+}
+
+static bool WGBenchStoreSetup(WGBenchContext *context) {
+    WGBenchStoreFixture *fixture = calloc(1, sizeof(*fixture));
+    if (!fixture) {
+        return false;
+    }
+    context->fixture = fixture;
+    fixture->clock = fixture->first = 1700000000000000ull;
+    fixture->random = 0x5EED;
+
+    const char *tmp = getenv("TMPDIR");
+    snprintf(fixture->directory, sizeof(fixture->directory), "%s/wgbench-store.XXXXXX", tmp && *tmp ? tmp : "/tmp");
+    if (!mkdtemp(fixture->directory)) {
+        fixture->directory[0] = '\0';
+        return false;
+    }
+
+    // 1 MiB segments, 8 MiB retained: appends rotate and retire segments
+    WGLogStoreConfig config = WGLogStoreConfigDefault();
+    config.maxSegmentBytes = 1024 * 1024;
+    config.retainBytes = 8 * 1024 * 1024;
+    config.retainAge = 0;
+    fixture->opened = WGLogStoreOpen(&fixture->store, fixture->directory, config, WGLogCommitPolicyDefault());
+    if (!fixture->opened) {
+        return false;
+    }
+
+    // arg > 0: a history of arg records (about 1 ms apart) to query
+    for (int64_t i = 0; i < context->arg; i++) {
+        if (WGBenchStoreAppendOne(fixture)) {
+            WGLogStoreCommit(&fixture->store);
+        }
+    }
+    WGLogStoreCommit(&fixture->store);
+    context->itemsPerOp = context->arg ? 100 : 1;
+    return true;
+}
+
+static void WGBenchStoreTeardown(WGBenchContext *context) {
+    WGBenchStoreFixture *fixture = context->fixture;
+    if (!fixture) {
+        return;
+    }
+    if (fixture->opened) {
+        WGLogStoreClose(&fixture->store);
+    }
+    WGBenchRemoveDirectory(fixture->directory);
+    free(fixture);
+}
+
+static void WGBenchStoreAppend(WGBenchContext *context, uint64_t iterations) {
+    WGBenchStoreFixture *fixture = context->fixture;
+    for (uint64_t i = 0; i < iterations; i++) {
+        if (WGBenchStoreAppendOne(fixture)) {
+            WGLogStoreCommit(&fixture->store);
+        }
+    }
+}
+
+static bool WGBenchStoreCount(void *context, const WGLogRecord *record) {
+    (*(uint64_t *)context) += record->detailsLength;
+    return true;
+}
+
+// Seek to a random time still retained and read the next 100 records
+static void WGBenchStoreSeekRead(WGBenchContext *context, uint64_t iterations) {
+    WGBenchStoreFixture *fixture = context->fixture;
+    uint64_t oldest = fixture->store.segmentCount ? fixture->store.segments[0].firstTime : fixture->first;
+    uint64_t span = fixture->clock > oldest ? fixture->clock - oldest : 1;
+    uint64_t total = 0;
+    for (uint64_t i = 0; i < iterations; i++) {
+        uint64_t since = oldest + WGBenchRandom(&fixture->random) % span;
+        WGLogStorePosition position;
+        bool finished;
+        WGLogStoreSeek(&fixture->store, since, &position);
+        WGLogStoreRead(&fixture->store, &position, since, 0, 100, WGBenchStoreCount, &total, &finished);
+    }
+    WGBenchKeep(total);
+}
+
+#pragma mark - Snapshot
+
+typedef struct {
+    WGSnapshotWriter writer;
+    double sampleTimes[WG_SCAN_HISTORY_CAPACITY];
+    int8_t sampleRSSI[WG_SCAN_HISTORY_CAPACITY];
+    char (*ssids)[WG_SCAN_SSID_MAX + 1];
+    uint8_t *file;
+    size_t fileLength;
+    char *json;                 // The same data as the JSON exports
+    size_t jsonLength;
+    int fd;
+} WGBenchSnapshotFixture;
+
+static bool WGBenchSnapshotBuild(WGBenchSnapshotFixture *fixture, size_t count) {
+    WGSnapshotWriterInit(&fixture->writer, 1700000000.0);
+    for (size_t i = 0; i < count; i++) {
+        WGSnapshotNetwork network = {
+            .bssid = 0x020000000000ULL | i,
+            .lastSeen = 1700000500.0,
+            .ssid = i % 11 == 0 ? NULL : fixture->ssids[i],
+            .channel = (uint16_t)(i % 3 ? 36 + 4 * (i % 8) : 1 + i % 11),
+            .channelWidth = i % 3 ? 80 : 20,
+            .rssi = (int8_t)(-40 - (int)(i % 50)),
+            .security = WGSnapshotSecurityWPA2
+        };
+        if (!WGSnapshotWriterAddNetwork(&fixture->writer, &network, fixture->sampleTimes,
+                                        fixture->sampleRSSI, WG_SCAN_HISTORY_CAPACITY)) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < count; i++) {
+        WGSnapshotARPEntry entry = {
+            .mac = 0x020000100000ULL | i,
+            .ip = 0x0A000000u | (uint32_t)(i + 1),
+            .flags = WGARPRecordFlagComplete,
+            .firstSeen = 1700000000.0,
+            .lastSeen = 1700000500.0,
+            .interface = "en0"
+        };
+        if (!WGSnapshotWriterAddARPEntry(&fixture->writer, &entry)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// The snapshot's networks and ARP entries as WGDataExporter writes them
+static bool WGBenchSnapshotBuildJSON(WGBenchSnapshotFixture *fixture, size_t count) {
+    int fd = WGBenchOpenTemporary();
+    WGRSSISample samples[WG_SCAN_HISTORY_CAPACITY];
+    for (size_t k = 0; k < WG_SCAN_HISTORY_CAPACITY; k++) {
+        samples[k] = (WGRSSISample){ .timestamp = fixture->sampleTimes[k], .rssi = fixture->sampleRSSI[k] };
+    }
+
+    WGStreamWriter stream;
+    WGExportTimeCache cache;
+    WGExportTimeCacheInit(&cache);
+    bool ok = fd >= 0 && WGStreamWriterOpen(&stream, fd, NULL, 0);
+    if (!ok) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        return false;
+    }
+    ok = WGStreamWriterWriteString(&stream, "{\"networks\":[");
+    for (size_t i = 0; ok && i < count; i++) {
+        char bssid[WG_MAC_STRLEN];
+        WGMACFormat(0x020000000000ULL | i, bssid);
+        WGExportNetwork network = {
+            .ssid = i % 11 == 0 ? NULL : fixture->ssids[i],
+            .bssid = bssid,
+            .security = "WPA2",
+            .channel = (long)(i % 3 ? 36 + 4 * (i % 8) : 1 + i % 11),
+            .rssi = -40 - (long)(i % 50),
+            .channelWidth = i % 3 ? 80 : 20,
+            .band = i % 3 ? 1 : 0,
+            .hidden = i % 11 == 0,
+            .lastSeen = 1700000500.0,
+            .samples = samples,
+            .sampleCount = WG_SCAN_HISTORY_CAPACITY
+        };
+        ok = (i == 0 || WGStreamWriterWriteString(&stream, ",")) &&
+             WGExportWriteNetworkJSON(&stream, &network, &cache);
+    }
+    ok = ok && WGStreamWriterWriteString(&stream, "],\"entries\":[");
+    for (size_t i = 0; ok && i < count; i++) {
+        char mac[WG_MAC_STRLEN], ip[WG_IPV4_STRLEN], row[256];
+        WGMACFormat(0x020000100000ULL | i, mac);
+        WGIPv4Format(0x0A000000u | (uint32_t)(i + 1), ip);
+        snprintf(row, sizeof(row), "%s{\"ipAddress\":\"%s\",\"macAddress\":\"%s\",\"interface\":\"en0\","
+                 "\"isComplete\":true,\"isPermanent\":false,\"firstSeen\":\"2023-11-14 22:13:20 +0000\","
+                 "\"lastSeen\":\"2023-11-14 22:21:40 +0000\"}", i ? "," : "", ip, mac);
+        ok = WGStreamWriterWriteString(&stream, row);
+    }
+    ok = ok && WGStreamWriterWriteString(&stream, "]}") && WGStreamWriterFinish(&stream);
+    WGStreamWriterFree(&stream);
+
+    off_t length = ok ? lseek(fd, 0, SEEK_END) : -1;
+    fixture->json = length > 0 ? malloc((size_t)length + 1) : NULL;
+    ok = fixture->json && pread(fd, fixture->json, (size_t)length, 0) == length;
+    if (ok) {
+        fixture->json[length] = '\0';
+        fixture->jsonLength = (size_t)length;
+    }
+    close(fd);
+    return ok;
+}
+
+static bool WGBenchSnapshotSetup(WGBenchContext *context) {
+    WGBenchSnapshotFixture *fixture = calloc(1, sizeof(*fixture));
+    if (!fixture) {
+        return false;
+    }
+    context->fixture = fixture;
+    fixture->fd = WGBenchOpenTemporary();
+
+    size_t count = (size_t)context->arg;
+    fixture->ssids = calloc(count, sizeof(*fixture->ssids));
+    if (fixture->fd < 0 || !fixture->ssids) {
+        return false;
+    }
+    for (size_t k = 0; k < WG_SCAN_HISTORY_CAPACITY; k++) {
+        fixture->sampleTimes[k] = 1700000000.0 + 5.0 * (double)k;
+        fixture->sampleRSSI[k] = (int8_t)(-40 - (int)(k % 30));
+    }
+    for (size_t i = 0; i < count; i++) {
+        snprintf(fixture->ssids[i], sizeof(fixture->ssids[i]), "net%zu", i);
+    }
+
+    // Serialized copy for the load case
+    if (!WGBenchSnapshotBuild(fixture, count) ||
+        WGSnapshotWriterWriteFD(&fixture->writer, fixture->fd) != WGSnapshotErrorNone) {
+        return false;
+    }
+    off_t length = lseek(fixture->fd, 0, SEEK_END);
+    fixture->file = length > 0 ? malloc((size_t)length) : NULL;
+    if (!fixture->file || pread(fixture->fd, fixture->file, (size_t)length, 0) != length) {
+        return false;
+    }
+    fixture->fileLength = (size_t)length;
+    context->itemsPerOp = count;
+    context->bytesPerOp = fixture->fileLength;
+    return WGBenchSnapshotBuildJSON(fixture, count);
+}
+
+static void WGBenchSnapshotTeardown(WGBenchContext *context) {
+    WGBenchSnapshotFixture *fixture = context->fixture;
+    if (!fixture) {
+        return;
+    }
+    if (fixture->fd >= 0) {
+        close(fixture->fd);
+    }
+    WGSnapshotWriterFree(&fixture->writer);
+    free(fixture->ssids);
+    free(fixture->file);
+    free(fixture->json);
+    free(fixture);
+}
+
+static void WGBenchSnapshotWrite(WGBenchContext *context, uint64_t iterations) {
+    WGBenchSnapshotFixture *fixture = context->fixture;
+    for (uint64_t i = 0; i < iterations; i++) {
+        WGSnapshotWriterFree(&fixture->writer);
+        bool ok = WGBenchSnapshotBuild(fixture, (size_t)context->arg);
+        lseek(fixture->fd, 0, SEEK_SET);
+        WGBenchKeep(ok && WGSnapshotWriterWriteFD(&fixture->writer, fixture->fd) == WGSnapshotErrorNone);
+    }
+}
+
+// Validation plus a pass over every network's columns and RSSI series
+static void WGBenchSnapshotLoad(WGBenchContext *context, uint64_t iterations) {
+    WGBenchSnapshotFixture *fixture = context->fixture;
+    for (uint64_t i = 0; i < iterations; i++) {
+        WGSnapshot snapshot;
+        if (WGSnapshotLoad(&snapshot, fixture->file, fixture->fileLength) != WGSnapshotErrorNone) {
+            continue;
+        }
+        int64_t sum = 0;
+        for (size_t k = 0; k < snapshot.networks.count; k++) {
+            const double *times;
+            const int8_t *rssi;
+            size_t samples = WGSnapshotNetworkSamples(&snapshot, k, &times, &rssi);
+            sum += snapshot.networks.rssi[k] + (samples ? rssi[samples - 1] : 0);
+            sum += (int64_t)strlen(WGSnapshotString(&snapshot, snapshot.networks.ssid[k]));
+        }
+        WGSnapshotClose(&snapshot);
+        WGBenchKeep((uint64_t)sum);
+    }
+}
+
+#pragma mark - JSON Baseline
+
+// A minimal DOM decoder standing in for NSJSONSerialization: every object,
+// array, string and number becomes its own allocation, then the networks
+// are read back by key as networkFromDictionary: does
+typedef enum {
+    WGBenchJSONNull = 0,
+    WGBenchJSONBool,
+    WGBenchJSONNumber,
+    WGBenchJSONString,
+    WGBenchJSONArray,
+    WGBenchJSONObject
+} WGBenchJSONType;
+
+typedef struct WGBenchJSONValue {
+    WGBenchJSONType type;
+    double number;
+    char *string;                       // String value
+    char **keys;                        // Object keys, parallel to items
+    struct WGBenchJSONValue **items;    // Array elements or object values
+    size_t count;
+    size_t capacity;
+} WGBenchJSONValue;
+
+typedef struct {
+    const char *p;
+    const char *end;
+} WGBenchJSONParser;
+
+static void WGBenchJSONFree(WGBenchJSONValue *value) {
+    if (!value) {
+        return;
+    }
+    for (size_t i = 0; i < value->count; i++) {
+        WGBenchJSONFree(value->items[i]);
+        if (value->keys) {
+            free(value->keys[i]);
+        }
+    }
+    free(value->items);
+    free(value->keys);
+    free(value->string);
+    free(value);
+}
+
+static void WGBenchJSONSkipSpace(WGBenchJSONParser *parser) {
+    while (parser->p < parser->end && (*parser->p == ' ' || *parser->p == '\n' ||
+                                       *parser->p == '\r' || *parser->p == '\t')) {
+        parser->p++;
+    }
+}
+
+// Escapes other than \uXXXX are decoded; \u keeps its low byte
+static char *WGBenchJSONParseString(WGBenchJSONParser *parser) {
+    if (parser->p >= parser->end || *parser->p != '"') {
+        return NULL;
+    }
+    const char *start = ++parser->p;
+    while (parser->p < parser->end && *parser->p != '"') {
+        parser->p += (*parser->p == '\\') ? 2 : 1;
+    }
+    if (parser->p >= parser->end) {
+        return NULL;
+    }
+    char *out = malloc((size_t)(parser->p - start) + 1);
+    if (!out) {
+        return NULL;
+    }
+    char *q = out;
+    for (const char *c = start; c < parser->p; c++) {
+        if (*c != '\\') {
+            *q++ = *c;
+            continue;
+        }
+        c++;
+        switch (*c) {
+            case 'n': *q++ = '\n'; break;
+            case 't': *q++ = '\t'; break;
+            case 'r': *q++ = '\r'; break;
+            case 'b': *q++ = '\b'; break;
+            case 'f': *q++ = '\f'; break;
+            case 'u':
+                *q++ = (char)strtol((char[]){ c[3], c[4], '\0' }, NULL, 16);
+                c += 4;
+                break;
+            default: *q++ = *c; break;
+        }
+    }
+    *q = '\0';
+    parser->p++;
+    return out;
+}
+
+static bool WGBenchJSONAppend(WGBenchJSONValue *container, char *key, WGBenchJSONValue *item) {
+    if (container->count == container->capacity) {
+        size_t capacity = container->capacity ? container->capacity * 2 : 8;
+        WGBenchJSONValue **items = realloc(container->items, capacity * sizeof(*items));
+        if (!items) {
+            return false;
+        }
+        container->items = items;
+        if (container->type == WGBenchJSONObject) {
+            char **keys = realloc(container->keys, capacity * sizeof(*keys));
+            if (!keys) {
+                return false;
+            }
+            container->keys = keys;
+        }
+        container->capacity = capacity;
+    }
+    if (container->keys) {
+        container->keys[container->count] = key;
+    }
+    container->items[container->count++] = item;
+    return true;
+}
+
+static WGBenchJSONValue *WGBenchJSONParseValue(WGBenchJSONParser *parser) {
+    WGBenchJSONSkipSpace(parser);
+    if (parser->p >= parser->end) {
+        return NULL;
+    }
+    WGBenchJSONValue *value = calloc(1, sizeof(*value));
+    if (!value) {
+        return NULL;
+    }
+    char c = *parser->p;
+    bool ok = true;
+    if (c == '{' || c == '[') {
+        value->type = c == '{' ? WGBenchJSONObject : WGBenchJSONArray;
+        char close = c == '{' ? '}' : ']';
+        parser->p++;
+        WGBenchJSONSkipSpace(parser);
+        if (parser->p < parser->end && *parser->p == close) {
+            parser->p++;
+            return value;
+        }
+        while (ok) {
+            char *key = NULL;
+            if (value->type == WGBenchJSONObject) {
+                WGBenchJSONSkipSpace(parser);
+                key = WGBenchJSONParseString(parser);
+                WGBenchJSONSkipSpace(parser);
+                ok = key && parser->p < parser->end && *parser->p++ == ':';
+            }
+            WGBenchJSONValue *item = ok ? WGBenchJSONParseValue(parser) : NULL;
+            if (!item || !WGBenchJSONAppend(value, key, item)) {
+                free(key);
+                WGBenchJSONFree(item);
+                ok = false;
+                break;
+            }
+            WGBenchJSONSkipSpace(parser);
+            if (parser->p < parser->end && *parser->p == ',') {
+                parser->p++;
+            } else {
+                ok = parser->p < parser->end && *parser->p++ == close;
+                break;
+            }
+        }
+    } else if (c == '"') {
+        value->type = WGBenchJSONString;
+        value->string = WGBenchJSONParseString(parser);
+        ok = value->string != NULL;
+    } else if (c == 't' || c == 'f' || c == 'n') {
+        const char *word = c == 't' ? "true" : c == 'f' ? "false" : "null";
+        size_t length = strlen(word);
+        value->type = c == 'n' ? WGBenchJSONNull : WGBenchJSONBool;
+        value->number = c == 't';
+        ok = (size_t)(parser->end - parser->p) >= length && memcmp(parser->p, word, length) == 0;
+        parser->p += length;
+    } else {
+        char *end;
+        value->type = WGBenchJSONNumber;
+        value->number = strtod(parser->p, &end);
+        ok = end != parser->p;
+        parser->p = end;
+    }
+    if (!ok) {
+        WGBenchJSONFree(value);
+        return NULL;
+    }
+    return value;
+}
+
+static const WGBenchJSONValue *WGBenchJSONGet(const WGBenchJSONValue *object, const char *key) {
+    if (!object || object->type != WGBenchJSONObject) {
+        return NULL;
+    }
+    for (size_t i = 0; i < object->count; i++) {
+        if (strcmp(object->keys[i], key) == 0) {
+            return object->items[i];
+        }
+    }
+    return NULL;
+}
+
+static bool WGBenchSnapshotJSONSetup(WGBenchContext *context) {
+    if (!WGBenchSnapshotSetup(context)) {
+        return false;
+    }
+    context->bytesPerOp = ((WGBenchSnapshotFixture *)context->fixture)->jsonLength;
+    return true;
+}
+
+// Decode plus the same pass over every network as snapshot/load
+static void WGBenchSnapshotJSONDecode(WGBenchContext *context, uint64_t iterations) {
+    WGBenchSnapshotFixture *fixture = context->fixture;
+    for (uint64_t i = 0; i < iterations; i++) {
+        WGBenchJSONParser parser = { fixture->json, fixture->json + fixture->jsonLength };
+        WGBenchJSONValue *root = WGBenchJSONParseValue(&parser);
+        const WGBenchJSONValue *networks = WGBenchJSONGet(root, "networks");
+        int64_t sum = 0;
+        for (size_t k = 0; networks && k < networks->count; k++) {
+            const WGBenchJSONValue *network = networks->items[k];
+            const WGBenchJSONValue *ssid = WGBenchJSONGet(network, "ssid");
+            const WGBenchJSONValue *bssid = WGBenchJSONGet(network, "bssid");
+            const WGBenchJSONValue *rssi = WGBenchJSONGet(network, "rssi");
+            const WGBenchJSONValue *history = WGBenchJSONGet(network, "rssiHistory");
+            const WGBenchJSONValue *hidden = WGBenchJSONGet(network, "isHidden");
+            WGMACAddress mac = 0;
+            if (bssid && bssid->type == WGBenchJSONString) {
+                WGMACParse(bssid->string, &mac);
+            }
+            sum += (int64_t)(mac & 1);
+            sum += rssi ? (int64_t)rssi->number : 0;
+            sum += history && history->count ? (int64_t)history->items[history->count - 1]->number : 0;
+            if (ssid && ssid->string && !(hidden && hidden->number != 0)) {
+                sum += (int64_t)strlen(ssid->string);       // "<Hidden>" is the snapshot's ""
+            }
+        }
+        WGBenchJSONFree(root);
+        WGBenchKeep((uint64_t)sum);
+    }
+}
+
+static const WGBenchCase kWGBenchExportCases[] = {
+    { "export",   "networks_csv",            1000,    WGBenchExportSetup,   WGBenchExportCSV,           WGBenchExportTeardown },
+    { "export",   "networks_json",           1000,    WGBenchExportSetup,   WGBenchExportJSON,          WGBenchExportTeardown },
+    { "export",   "networks_csv_password",   1000,    WGBenchExportSetup,   WGBenchExportCSVPassword,   WGBenchExportTeardown },
+    { "export",   "networks_csv_session",    1000,    WGBenchExportSetup,   WGBenchExportCSVSession,    WGBenchExportTeardown },
+    { "export",   "all_password",            1000,    WGBenchExportAllSetup, WGBenchExportAllPassword,  WGBenchExportTeardown },
+    { "export",   "all_session",             1000,    WGBenchExportAllSetup, WGBenchExportAllSession,   WGBenchExportTeardown },
+    { "crypto",   "seal",                    4096,    WGBenchCryptoSetup,   WGBenchCryptoSeal,          WGBenchCryptoTeardown },
+    { "crypto",   "open",                    4096,    WGBenchCryptoSetup,   WGBenchCryptoOpen,          WGBenchCryptoTeardown },
+    { "crypto",   "stream_encrypt",          1048576, WGBenchCryptoSetup,   WGBenchCryptoStreamEncrypt, WGBenchCryptoTeardown },
+    { "crypto",   "stream_decrypt",          1048576, WGBenchCryptoSetup,   WGBenchCryptoStreamDecrypt, WGBenchCryptoTeardown },
+    { "log",      "append",                  0,       WGBenchLogSetup,      WGBenchLogAppend,           WGBenchLogTeardown },
+    { "log",      "append_commit",           64,      WGBenchLogSetup,      WGBenchLogAppend,           WGBenchLogTeardown },
+    { "store",    "append",                  0,       WGBenchStoreSetup,    WGBenchStoreAppend,         WGBenchStoreTeardown },
+    { "store",    "seek_read",               100000,  WGBenchStoreSetup,    WGBenchStoreSeekRead,       WGBenchStoreTeardown },
+    { "snapshot", "write",                   1000,    WGBenchSnapshotSetup, WGBenchSnapshotWrite,       WGBenchSnapshotTeardown },
+    { "snapshot", "load",                    1000,    WGBenchSnapshotSetup, WGBenchSnapshotLoad,        WGBenchSnapshotTeardown },
+    { "snapshot", "json_decode",             1000,    WGBenchSnapshotJSONSetup, WGBenchSnapshotJSONDecode, WGBenchSnapshotTeardown },
+};
+
+const WGBenchSuite WGBenchExportSuite = {
+    kWGBenchExportCases, sizeof(kWGBenchExportCases) / sizeof(kWGBenchExportCases[0])
+};
@@ -0,0 +1,585 @@
+/*
+ * WGBenchScan.c - Scan Ingest / Channel Statistics Benchmarks
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * updateChannelStatistics as incremental WGChannelAggregate moves versus a
+ * full regroup, scan result ingest on the worker, the per-scan signal
+ * statistics pass (scalar reference versus vector kernel), SSID index
+ * updates with injected evil twins, and beacon parsing / capture replay
+ * for the pcap scan source.
+ */
+
+#include "WGBench.h"
+#include "WGBeacon.h"
+#include "WGChannelAggregate.h"
+#include "WGPcap.h"
+#include "WGScanIngest.h"
+#include "WGSignalStats.h"
+#include "WGSSIDIndex.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Mixed 2.4 / 5 GHz deployment: a third of the BSSIDs on 2.4 GHz at 20 MHz
+static void WGBenchNetworkAt(uint64_t i, uint16_t *channel, uint16_t *width, WGChannelBand *band) {
+    if (i % 3 == 0) {
+        *channel = (uint16_t)(1 + i % 11);
+        *width = 20;
+        *band = WGChannelBand2GHz;
+    } else {
+        *channel = (uint16_t)(36 + 4 * (i % 8));
+        *width = i % 3 == 1 ? 80 : 40;
+        *band = WGChannelBand5GHz;
+    }
+}
+
+#pragma mark - Channel Statistics
+
+typedef struct {
+    WGChannelAggregate aggregate;
+    WGChannelPlacement *placements;
+    uint64_t random;
+} WGBenchChannelFixture;
+
+static bool WGBenchChannelSetup(WGBenchContext *context) {
+    WGBenchChannelFixture *fixture = calloc(1, sizeof(*fixture));
+    if (!fixture) {
+        return false;
+    }
+    context->fixture = fixture;
+    fixture->random = 0x9E3779B97F4A7C15ULL;
+
+    size_t count = (size_t)context->arg;
+    fixture->placements = calloc(count, sizeof(WGChannelPlacement));
+    if (!fixture->placements) {
+        return false;
+    }
+    WGChannelAggregateInit(&fixture->aggregate);
+    for (size_t i = 0; i < count; i++) {
+        uint16_t channel, width;
+        WGChannelBand band;
+        WGBenchNetworkAt(i, &channel, &width, &band);
+        fixture->placements[i] = WGChannelPlacementMake(band, channel, width, -40 - (long)(i % 50));
+        WGChannelAggregateAdd(&fixture->aggregate, &fixture->placements[i]);
+    }
+    return true;
+}
+
+static bool WGBenchChannelRegroupSetup(WGBenchContext *context) {
+    context->itemsPerOp = (uint64_t)context->arg;
+    return WGBenchChannelSetup(context);
+}
+
+static void WGBenchChannelTeardown(WGBenchContext *context) {
+    WGBenchChannelFixture *fixture = context->fixture;
+    if (fixture) {
+        free(fixture->placements);
+        free(fixture);
+    }
+}
+
+// One scan result changes a network's RSSI (and every 8th its channel)
+static void WGBenchChannelMove(WGBenchContext *context, uint64_t iterations) {
+    WGBenchChannelFixture *fixture = context->fixture;
+    for (uint64_t i = 0; i < iterations; i++) {
+        uint64_t random = WGBenchRandom(&fixture->random);
+        WGChannelPlacement *placement = &fixture->placements[random % (uint64_t)context->arg];
+        WGChannelPlacement moved = *placement;
+        moved.rssi = (int16_t)(-30 - (int16_t)((random >> 20) % 60));
+        if (((random >> 32) & 7) == 0) {
+            uint16_t channel, width;
+            WGChannelBand band;
+            WGBenchNetworkAt(random >> 40, &channel, &width, &band);
+            moved = WGChannelPlacementMake(band, channel, width, moved.rssi);
+        }
+        WGChannelAggregateMove(&fixture->aggregate, placement, &moved);
+        *placement = moved;
+    }
+    WGBenchKeep((uint64_t)WGChannelAggregateMostCrowded(&fixture->aggregate));
+}
+
+// What updateChannelStatistics cost before: rebuild from every network
+static void WGBenchChannelRegroup(WGBenchContext *context, uint64_t iterations) {
+    WGBenchChannelFixture *fixture = context->fixture;
+    size_t count = (size_t)context->arg;
+    for (uint64_t i = 0; i < iterations; i++) {
+        WGChannelAggregateInit(&fixture->aggregate);
+        for (size_t k = 0; k < count; k++) {
+            WGChannelAggregateAdd(&fixture->aggregate, &fixture->placements[k]);
+        }
+        WGBenchKeep((uint64_t)WGChannelAggregateMostCrowded(&fixture->aggregate));
+    }
+}
+
+#pragma mark - Ingest
+
+#define WG_BENCH_INGEST_BATCH 256
+
+typedef struct {
+    WGScanIngest ingest;
+    bool initialized;
+    bool started;
+    WGScanRecord batch[WG_BENCH_INGEST_BATCH];
+    uint64_t next;
+    double clock;
+} WGBenchIngestFixture;
+
+static void WGBenchRecordAt(uint64_t i, double timestamp, WGScanRecord *record) {
+    uint16_t channel, width;
+    WGChannelBand band;
+    WGBenchNetworkAt(i, &channel, &width, &band);
+    memset(record, 0, sizeof(*record));
+    record->bssid = 0x020000000000ULL | i;
+    record->lastSeen = timestamp;
+    record->rssi = (int16_t)(-40 - (int)(i % 50));
+    record->channel = channel;
+    record->channelWidth = width;
+    record->band = (uint8_t)band;
+    record->ssidLength = (uint8_t)snprintf(record->ssid, sizeof(record->ssid), "net%llu", (unsigned long long)i);
+    memcpy(record->security, "WPA2", 5);
+}
+
+static bool WGBenchIngestSetup(WGBenchContext *context) {
+    WGBenchIngestFixture *fixture = calloc(1, sizeof(*fixture));
+    if (!fixture) {
+        return false;
+    }
+    context->fixture = fixture;
+    context->itemsPerOp = WG_BENCH_INGEST_BATCH;
+    fixture->clock = 1700000000.0;
+    fixture->initialized = WGScanIngestInit(&fixture->ingest, NULL, NULL);
+    fixture->started = fixture->initialized && WGScanIngestStart(&fixture->ingest);
+    return fixture->started;
+}
+
+static void WGBenchIngestTeardown(WGBenchContext *context) {
+    WGBenchIngestFixture *fixture = context->fixture;
+    if (!fixture) {
+        return;
+    }
+    if (fixture->started) {
+        WGScanIngestStop(&fixture->ingest);
+    }
+    if (fixture->initialized) {
+        WGScanIngestFree(&fixture->ingest);
+    }
+    free(fixture);
+}
+
+// Batches cycle through arg BSSIDs; the diff is taken once per run like a
+// coalesced main-thread delivery
+static void WGBenchIngestSubmit(WGBenchContext *context, uint64_t iterations) {
+    WGBenchIngestFixture *fixture = context->fixture;
+    for (uint64_t i = 0; i < iterations; i++) {
+        fixture->clock += 0.01;
+        for (size_t k = 0; k < WG_BENCH_INGEST_BATCH; k++) {
+            WGBenchRecordAt(fixture->next++ % (uint64_t)context->arg, fixture->clock, &fixture->batch[k]);
+        }
+        WGScanIngestSubmit(&fixture->ingest, fixture->batch, WG_BENCH_INGEST_BATCH);
+    }
+    WGScanIngestWaitIdle(&fixture->ingest);
+
+    WGScanDiff diff;
+    WGScanDiffInit(&diff);
+    WGScanSnapshot *snapshot = WGScanIngestTake(&fixture->ingest, &diff);
+    if (snapshot) {
+        WGBenchKeep(snapshot->count);
+        WGScanSnapshotRelease(snapshot);
+    }
+    WGScanDiffFree(&diff);
+}
+
+#pragma mark - Signal Statistics
+
+#define WG_BENCH_SIGNAL_SCANS 8
+
+typedef struct {
+    WGSignalStats stats;
+    float *scans;           // WG_BENCH_SIGNAL_SCANS rows of arg RSSI readings
+    float *observed;        // arg ones
+    uint64_t next;
+} WGBenchSignalFixture;
+
+// arg BSSIDs, each seen by every scan with a few dB of noise; roughly one
+// in a thousand readings jumps by 25 dB
+static bool WGBenchSignalSetup(WGBenchContext *context) {
+    WGBenchSignalFixture *fixture = calloc(1, sizeof(*fixture));
+    if (!fixture) {
+        return false;
+    }
+    context->fixture = fixture;
+    context->itemsPerOp = (uint64_t)context->arg;
+
+    size_t count = (size_t)context->arg;
+    fixture->scans = malloc(WG_BENCH_SIGNAL_SCANS * count * sizeof(float));
+    fixture->observed = malloc(count * sizeof(float));
+    WGSignalStatsInit(&fixture->stats, WGSignalParamsDefault());
+    if (!fixture->scans || !fixture->observed || !WGSignalStatsReserve(&fixture->stats, count)) {
+        return false;
+    }
+
+    uint64_t random = 0x9E3779B97F4A7C15ULL;
+    for (size_t i = 0; i < count; i++) {
+        float base = -40.0f - (float)(i % 50);
+        WGSignalStatsAdd(&fixture->stats, base);
+        fixture->observed[i] = 1;
+        for (size_t scan = 0; scan < WG_BENCH_SIGNAL_SCANS; scan++) {
+            uint64_t bits = WGBenchRandom(&random);
+            float reading = base + (float)(bits % 7) - 3.0f;
+            if ((bits >> 32) % 1000 == 0) {
+                reading += 25.0f;
+            }
+            fixture->scans[scan * count + i] = reading;
+        }
+    }
+    return true;
+}
+
+static void WGBenchSignalTeardown(WGBenchContext *context) {
+    WGBenchSignalFixture *fixture = context->fixture;
+    if (fixture) {
+        WGSignalStatsFree(&fixture->stats);
+        free(fixture->scans);
+        free(fixture->observed);
+        free(fixture);
+    }
+}
+
+// What a scan hands the kernel: one reading per BSSID, all observed
+static void WGBenchSignalLoadScan(WGBenchSignalFixture *fixture, size_t count) {
+    const float *scan = fixture->scans + (fixture->next++ % WG_BENCH_SIGNAL_SCANS) * count;
+    memcpy(fixture->stats.input, scan, count * sizeof(float));
+    memcpy(fixture->stats.weight, fixture->observed, count * sizeof(float));
+}
+
+static void WGBenchSignalScalar(WGBenchContext *context, uint64_t iterations) {
+    WGBenchSignalFixture *fixture = context->fixture;
+    size_t steps = 0;
+    for (uint64_t i = 0; i < iterations; i++) {
+        WGBenchSignalLoadScan(fixture, (size_t)context->arg);
+        steps += WGSignalStatsUpdateScalar(&fixture->stats);
+    }
+    WGBenchKeep(steps);
+}
+
+static void WGBenchSignalVector(WGBenchContext *context, uint64_t iterations) {
+    WGBenchSignalFixture *fixture = context->fixture;
+    size_t steps = 0;
+    for (uint64_t i = 0; i < iterations; i++) {
+        WGBenchSignalLoadScan(fixture, (size_t)context->arg);
+        steps += WGSignalStatsUpdateVector(&fixture->stats);
+    }
+    WGBenchKeep(steps);
+}
+
+#pragma mark - SSID Index
+
+typedef struct {
+    WGSSIDIndex index;
+    bool initialized;
+    WGSSIDMember *members;      // arg networks, 8 BSSIDs per SSID
+    char (*ssids)[16];
+    uint64_t random;
+    double clock;
+    uint64_t alerts;
+} WGBenchSSIDFixture;
+
+static const WGSecurityRank kWGBenchSSIDSecurity[] = {
+    WGSecurityRankWPA2, WGSecurityRankWPA3, WGSecurityRankWPA2, WGSecurityRankOpen
+};
+
+// A dense deployment after the learning period: every SSID is served by
+// two vendors on a few channels
+static bool WGBenchSSIDSetup(WGBenchContext *context) {
+    WGBenchSSIDFixture *fixture = calloc(1, sizeof(*fixture));
+    if (!fixture) {
+        return false;
+    }
+    context->fixture = fixture;
+    fixture->random = 0x9E3779B97F4A7C15ULL;
+    fixture->clock = 1700000000.0;
+
+    size_t count = (size_t)context->arg;
+    fixture->members = calloc(count, sizeof(WGSSIDMember));
+    fixture->ssids = calloc(count / 8 + 1, sizeof(*fixture->ssids));
+    fixture->initialized = fixture->members && fixture->ssids && WGSSIDIndexInit(&fixture->index);
+    if (!fixture->initialized) {
+        return false;
+    }
+    WGSSIDAlert alert;
+    for (size_t i = 0; i < count; i++) {
+        size_t group = i / 8;
+        uint16_t channel, width;
+        WGChannelBand band;
+        WGBenchNetworkAt(i, &channel, &width, &band);
+        int length = snprintf(fixture->ssids[group], sizeof(fixture->ssids[group]), "corp%zu", group);
+        fixture->members[i] = (WGSSIDMember){
+            .bssid = ((i & 1) ? 0x0C8DDB000000ULL : 0x245A4C000000ULL) | i,
+            .ssid = fixture->ssids[group],
+            .ssidLength = (size_t)length,
+            .security = kWGBenchSSIDSecurity[group % 4],
+            .band = band,
+            .channel = channel,
+            .timestamp = fixture->clock
+        };
+        WGSSIDIndexAdd(&fixture->index, &fixture->members[i], &alert);
+    }
+    fixture->clock += fixture->index.settleTime;
+    return true;
+}
+
+static void WGBenchSSIDTeardown(WGBenchContext *context) {
+    WGBenchSSIDFixture *fixture = context->fixture;
+    if (!fixture) {
+        return;
+    }
+    if (fixture->initialized) {
+        WGSSIDIndexFree(&fixture->index);
+    }
+    free(fixture->members);
+    free(fixture->ssids);
+    free(fixture);
+}
+
+// Networks hop between their SSID's learned channels; one update in 64
+// is an impostor BSSID (unknown vendor, Open) advertising the same SSID
+static void WGBenchSSIDUpdate(WGBenchContext *context, uint64_t iterations) {
+    WGBenchSSIDFixture *fixture = context->fixture;
+    WGSSIDAlert alert;
+    for (uint64_t i = 0; i < iterations; i++) {
+        uint64_t random = WGBenchRandom(&fixture->random);
+        WGSSIDMember *member = &fixture->members[random % (uint64_t)context->arg];
+        fixture->clock += 0.001;
+
+        if (((random >> 48) & 63) == 0) {
+            WGSSIDMember twin = *member;
+            twin.bssid = 0xDEAD00000000ULL | (random >> 32 & 0xFFFF);
+            twin.security = WGSecurityRankOpen;
+            twin.timestamp = fixture->clock;
+            fixture->alerts += WGSSIDIndexAdd(&fixture->index, &twin, &alert);
+            WGSSIDIndexRemove(&fixture->index, &twin);
+            continue;
+        }
+        // To the channel of its neighbour in the same SSID
+        const WGSSIDMember *neighbour = &fixture->members[(size_t)(member - fixture->members) ^ 1];
+        WGSSIDMember moved = *member;
+        moved.band = neighbour->band;
+        moved.channel = neighbour->channel;
+        moved.timestamp = fixture->clock;
+        fixture->alerts += WGSSIDIndexMove(&fixture->index, member, &moved, &alert);
+        *member = moved;
+    }
+    WGBenchKeep(fixture->alerts);
+}
+
+#pragma mark - Beacons / Capture Replay
+
+typedef struct {
+    uint8_t *data;
+    size_t length;
+    size_t capacity;
+    WGPcapReader reader;
+    WGScanIngest ingest;
+    bool initialized;
+    bool started;
+} WGBenchCaptureFixture;
+
+static bool WGBenchCapturePut(WGBenchCaptureFixture *fixture, const void *data, size_t length) {
+    if (fixture->length + length > fixture->capacity) {
+        size_t capacity = (fixture->capacity + length) * 2;
+        uint8_t *grown = realloc(fixture->data, capacity);
+        if (!grown) {
+            return false;
+        }
+        fixture->data = grown;
+        fixture->capacity = capacity;
+    }
+    memcpy(fixture->data + fixture->length, data, length);
+    fixture->length += length;
+    return true;
+}
+
+// Beacon with SSID, DS parameter set and (for secured networks) an RSN IE
+static size_t WGBenchBeaconFrame(uint8_t *frame, uint64_t bssid, const char *ssid, uint8_t channel, bool secured) {
+    size_t n = 0;
+    frame[n++] = 0x80;                  // Beacon
+    frame[n++] = 0;
+    frame[n++] = 0;                     // Duration
+    frame[n++] = 0;
+    memset(frame + n, 0xff, 6);         // Broadcast DA
+    n += 6;
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < 6; i++) {   // SA, BSSID
+            frame[n++] = (uint8_t)(bssid >> (40 - 8 * i));
+        }
+    }
+    frame[n++] = 0;                     // Sequence
+    frame[n++] = 0;
+    memset(frame + n, 0, 8);            // Timestamp
+    n += 8;
+    frame[n++] = 100;                   // Beacon interval
+    frame[n++] = 0;
+    frame[n++] = secured ? 0x11 : 0x01; // ESS (+ privacy)
+    frame[n++] = 0;
+
+    size_t ssidLength = strlen(ssid);
+    frame[n++] = 0;
+    frame[n++] = (uint8_t)ssidLength;
+    memcpy(frame + n, ssid, ssidLength);
+    n += ssidLength;
+    frame[n++] = 3;
+    frame[n++] = 1;
+    frame[n++] = channel;
+    if (secured) {
+        static const uint8_t rsn[] = {
+            48, 20, 1, 0,
+            0x00, 0x0f, 0xac, 4,                // Group: CCMP
+            1, 0, 0x00, 0x0f, 0xac, 4,          // Pairwise: CCMP
+            1, 0, 0x00, 0x0f, 0xac, 2,          // AKM: PSK
+            0, 0
+        };
+        memcpy(frame + n, rsn, sizeof(rsn));
+        n += sizeof(rsn);
+    }
+    return n;
+}
+
+// Radiotap (flags, channel, antenna signal) capture of arg frames from 500 APs
+static bool WGBenchCaptureSetup(WGBenchContext *context) {
+    WGBenchCaptureFixture *fixture = calloc(1, sizeof(*fixture));
+    if (!fixture) {
+        return false;
+    }
+    context->fixture = fixture;
+
+    const uint32_t header[] = { 0xa1b2c3d4, 0x00040002, 0, 0, 65535, WGPcapLinkRadiotap };
+    if (!WGBenchCapturePut(fixture, header, sizeof(header))) {
+        return false;
+    }
+    for (long i = 0; i < context->arg; i++) {
+        uint64_t ap = (uint64_t)i % 500;
+        uint16_t channel, width;
+        WGChannelBand band;
+        WGBenchNetworkAt(ap, &channel, &width, &band);
+
+        char ssid[16];
+        snprintf(ssid, sizeof(ssid), "net%llu", (unsigned long long)ap);
+        uint8_t frame[128];
+        size_t frameLength = WGBenchBeaconFrame(frame, 0x020000000000ULL | ap, ssid, (uint8_t)channel, ap % 4 != 0);
+
+        uint16_t frequency = (uint16_t)(band == WGChannelBand2GHz ? 2407 + 5 * channel : 5000 + 5 * channel);
+        uint8_t radiotap[] = {
+            0, 0, 18, 0,                                    // Version, length
+            0x2a, 0x00, 0x00, 0x00,                         // Flags, channel, signal
+            0x00,                                           // Flags
+            0x00,                                           // Pad to 2
+            (uint8_t)frequency, (uint8_t)(frequency >> 8),
+            0x00, 0x00,                                     // Channel flags
+            (uint8_t)(int8_t)(-30 - (int)(i % 60)),
+            0, 0, 0
+        };
+        uint32_t timestamp = 1700000000u + (uint32_t)(i / 10000);
+        uint32_t record[] = {
+            timestamp, (uint32_t)(i % 10000) * 100,
+            (uint32_t)(sizeof(radiotap) + frameLength), (uint32_t)(sizeof(radiotap) + frameLength)
+        };
+        if (!WGBenchCapturePut(fixture, record, sizeof(record)) ||
+            !WGBenchCapturePut(fixture, radiotap, sizeof(radiotap)) ||
+            !WGBenchCapturePut(fixture, frame, frameLength)) {
+            return false;
+        }
+    }
+
+    context->itemsPerOp = (uint64_t)context->arg;
+    context->bytesPerOp = fixture->length;
+    return WGPcapLoad(&fixture->reader, fixture->data, fixture->length) == WGPcapErrorNone;
+}
+
+static bool WGBenchCaptureIngestSetup(WGBenchContext *context) {
+    if (!WGBenchCaptureSetup(context)) {
+        return false;
+    }
+    WGBenchCaptureFixture *fixture = context->fixture;
+    fixture->initialized = WGScanIngestInit(&fixture->ingest, NULL, NULL);
+    fixture->started = fixture->initialized && WGScanIngestStart(&fixture->ingest);
+    return fixture->started;
+}
+
+static void WGBenchCaptureTeardown(WGBenchContext *context) {
+    WGBenchCaptureFixture *fixture = context->fixture;
+    if (!fixture) {
+        return;
+    }
+    if (fixture->started) {
+        WGScanIngestStop(&fixture->ingest);
+    }
+    if (fixture->initialized) {
+        WGScanIngestFree(&fixture->ingest);
+    }
+    free(fixture->data);
+    free(fixture);
+}
+
+static void WGBenchCaptureParse(WGBenchContext *context, uint64_t iterations) {
+    WGBenchCaptureFixture *fixture = context->fixture;
+    for (uint64_t i = 0; i < iterations; i++) {
+        WGPcapRewind(&fixture->reader);
+        WGPcapPacket packet;
+        WGBeaconInfo info;
+        uint64_t parsed = 0;
+        while (WGPcapNext(&fixture->reader, &packet)) {
+            parsed += WGBeaconParsePacket(&fixture->reader, &packet, &info);
+        }
+        WGBenchKeep(parsed);
+    }
+}
+
+static bool WGBenchCountSink(void *context, const WGScanRecord *records, size_t count) {
+    (void)records;
+    *(uint64_t *)context += count;
+    return true;
+}
+
+static void WGBenchCaptureReplay(WGBenchContext *context, uint64_t iterations) {
+    WGBenchCaptureFixture *fixture = context->fixture;
+    uint64_t delivered = 0;
+    for (uint64_t i = 0; i < iterations; i++) {
+        WGPcapRewind(&fixture->reader);
+        WGBeaconReplay(&fixture->reader, NULL, WGBenchCountSink, &delivered, NULL);
+    }
+    WGBenchKeep(delivered);
+}
+
+static void WGBenchCaptureReplayIngest(WGBenchContext *context, uint64_t iterations) {
+    WGBenchCaptureFixture *fixture = context->fixture;
+    for (uint64_t i = 0; i < iterations; i++) {
+        WGPcapRewind(&fixture->reader);
+        WGBeaconReplay(&fixture->reader, NULL, WGBeaconIngestSink, &fixture->ingest, NULL);
+    }
+    WGScanIngestWaitIdle(&fixture->ingest);
+}
+
+static const WGBenchCase kWGBenchScanCases[] = {
+    { "channel", "incremental_move",  500,    WGBenchChannelSetup, WGBenchChannelMove,    WGBenchChannelTeardown },
+    { "channel", "incremental_move",  5000,   WGBenchChannelSetup, WGBenchChannelMove,    WGBenchChannelTeardown },
+    { "channel", "full_regroup",      500,    WGBenchChannelRegroupSetup, WGBenchChannelRegroup, WGBenchChannelTeardown },
+    { "channel", "full_regroup",      5000,   WGBenchChannelRegroupSetup, WGBenchChannelRegroup, WGBenchChannelTeardown },
+    { "ingest",  "submit_batch",      1000,   WGBenchIngestSetup,  WGBenchIngestSubmit,   WGBenchIngestTeardown },
+    { "ingest",  "submit_batch",      10000,  WGBenchIngestSetup,  WGBenchIngestSubmit,   WGBenchIngestTeardown },
+    { "signal",  "update_scalar",     1000,   WGBenchSignalSetup,  WGBenchSignalScalar,   WGBenchSignalTeardown },
+    { "signal",  "update_scalar",     10000,  WGBenchSignalSetup,  WGBenchSignalScalar,   WGBenchSignalTeardown },
+    { "signal",  "update_scalar",     50000,  WGBenchSignalSetup,  WGBenchSignalScalar,   WGBenchSignalTeardown },
+    { "signal",  "update_vector",     1000,   WGBenchSignalSetup,  WGBenchSignalVector,   WGBenchSignalTeardown },
+    { "signal",  "update_vector",     10000,  WGBenchSignalSetup,  WGBenchSignalVector,   WGBenchSignalTeardown },
+    { "signal",  "update_vector",     50000,  WGBenchSignalSetup,  WGBenchSignalVector,   WGBenchSignalTeardown },
+    { "ssid",    "update",            1000,   WGBenchSSIDSetup,    WGBenchSSIDUpdate,     WGBenchSSIDTeardown },
+    { "ssid",    "update",            20000,  WGBenchSSIDSetup,    WGBenchSSIDUpdate,     WGBenchSSIDTeardown },
+    { "pcap",    "parse_beacons",     100000, WGBenchCaptureSetup, WGBenchCaptureParse,   WGBenchCaptureTeardown },
+    { "pcap",    "replay",            100000, WGBenchCaptureSetup, WGBenchCaptureReplay,  WGBenchCaptureTeardown },
+    { "pcap",    "replay_ingest",     100000, WGBenchCaptureIngestSetup, WGBenchCaptureReplayIngest, WGBenchCaptureTeardown },
+};
+
+const WGBenchSuite WGBenchScanSuite = {
+    kWGBenchScanCases, sizeof(kWGBenchScanCases) / sizeof(kWGBenchScanCases[0])
+};
@@ -0,0 +1,736 @@
+/*
+ * WGBenchUtils.c - Address / Container Benchmarks
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * The conversions behind WGNetworkUtils (MAC / IPv4 text, frequency to
+ * channel), the packed-key containers behind WGAddressMap, the bounded
+ * histories (ring against the trim-on-append arrays they replaced), the
+ * audit / anomaly history index, RSSI graph decimation, the per-stage cost
+ * of the metrics registry, the decisions of the adaptive monitoring
+ * schedule and the OUI vendor database (lookup, open and compile, over a
+ * synthetic registry the size of the IEEE one).
+ */
+
+#include "WGBench.h"
+#include "WGAddress.h"
+#include "WGBeacon.h"
+#include "WGHashMap.h"
+#include "WGMetrics.h"
+#include "WGOUI.h"
+#include "WGRecordIndex.h"
+#include "WGRing.h"
+#include "WGScanIngest.h"
+#include "WGSchedulePolicy.h"
+#include "WGSeries.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define WG_BENCH_ADDRESS_COUNT 1024
+
+#pragma mark - Addresses
+
+typedef struct {
+    WGMACAddress macs[WG_BENCH_ADDRESS_COUNT];
+    WGIPv4Address ips[WG_BENCH_ADDRESS_COUNT];
+    char macText[WG_BENCH_ADDRESS_COUNT][WG_MAC_STRLEN];
+    char ipText[WG_BENCH_ADDRESS_COUNT][WG_IPV4_STRLEN];
+} WGBenchAddressFixture;
+
+static bool WGBenchAddressSetup(WGBenchContext *context) {
+    WGBenchAddressFixture *fixture = calloc(1, sizeof(*fixture));
+    if (!fixture) {
+        return false;
+    }
+    context->fixture = fixture;
+    context->itemsPerOp = WG_BENCH_ADDRESS_COUNT;
+
+    uint64_t random = 0x9E3779B97F4A7C15ULL;
+    for (size_t i = 0; i < WG_BENCH_ADDRESS_COUNT; i++) {
+        fixture->macs[i] = WGBenchRandom(&random) & 0xFFFFFFFFFFFFULL;
+        fixture->ips[i] = (uint32_t)WGBenchRandom(&random);
+        WGMACFormat(fixture->macs[i], fixture->macText[i]);
+        WGIPv4Format(fixture->ips[i], fixture->ipText[i]);
+    }
+    return true;
+}
+
+static void WGBenchAddressTeardown(WGBenchContext *context) {
+    free(context->fixture);
+}
+
+static void WGBenchMACParse(WGBenchContext *context, uint64_t iterations) {
+    WGBenchAddressFixture *fixture = context->fixture;
+    for (uint64_t i = 0; i < iterations; i++) {
+        uint64_t sum = 0;
+        for (size_t k = 0; k < WG_BENCH_ADDRESS_COUNT; k++) {
+            WGMACAddress mac = 0;
+            WGMACParse(fixture->macText[k], &mac);
+            sum += mac;
+        }
+        WGBenchKeep(sum);
+    }
+}
+
+static void WGBenchMACFormat(WGBenchContext *context, uint64_t iterations) {
+    WGBenchAddressFixture *fixture = context->fixture;
+    for (uint64_t i = 0; i < iterations; i++) {
+        for (size_t k = 0; k < WG_BENCH_ADDRESS_COUNT; k++) {
+            WGMACFormat(fixture->macs[k], fixture->macText[k]);
+        }
+        WGBenchKeep((uint64_t)fixture->macText[0][0]);
+    }
+}
+
+static void WGBenchIPv4Parse(WGBenchContext *context, uint64_t iterations) {
+    WGBenchAddressFixture *fixture = context->fixture;
+    for (uint64_t i = 0; i < iterations; i++) {
+        uint64_t sum = 0;
+        for (size_t k = 0; k < WG_BENCH_ADDRESS_COUNT; k++) {
+            WGIPv4Address ip = 0;
+            WGIPv4Parse(fixture->ipText[k], &ip);
+            sum += ip;
+        }
+        WGBenchKeep(sum);
+    }
+}
+
+static void WGBenchIPv4Format(WGBenchContext *context, uint64_t iterations) {
+    WGBenchAddressFixture *fixture = context->fixture;
+    for (uint64_t i = 0; i < iterations; i++) {
+        for (size_t k = 0; k < WG_BENCH_ADDRESS_COUNT; k++) {
+            WGIPv4Format(fixture->ips[k], fixture->ipText[k]);
+        }
+        WGBenchKeep((uint64_t)fixture->ipText[0][0]);
+    }
+}
+
+// 2.4, 5 and 6 GHz centre frequencies in turn
+static void WGBenchFrequencyToChannel(WGBenchContext *context, uint64_t iterations) {
+    (void)context;
+    static const uint32_t frequencies[] = { 2412, 2437, 2462, 2484, 5180, 5500, 5745, 5825, 5955, 6415 };
+    for (uint64_t i = 0; i < iterations; i++) {
+        uint64_t sum = 0;
+        for (size_t k = 0; k < WG_BENCH_ADDRESS_COUNT; k++) {
+            WGChannelBand band;
+            uint16_t channel = 0;
+            WGBeaconChannelForFrequency(frequencies[k % 10], &band, &channel);
+            sum += channel + (uint64_t)band;
+        }
+        WGBenchKeep(sum);
+    }
+}
+
+#pragma mark - Hash Map
+
+typedef struct {
+    WGHashMap map;
+    uint64_t *keys;
+} WGBenchMapFixture;
+
+static bool WGBenchMapSetup(WGBenchContext *context) {
+    WGBenchMapFixture *fixture = calloc(1, sizeof(*fixture));
+    if (!fixture) {
+        return false;
+    }
+    context->fixture = fixture;
+    context->itemsPerOp = (uint64_t)context->arg;
+
+    size_t count = (size_t)context->arg;
+    fixture->keys = malloc(count * sizeof(uint64_t));
+    if (!fixture->keys || !WGHashMapInit(&fixture->map, count)) {
+        return false;
+    }
+    uint64_t random = 0x2545F4914F6CDD1DULL;
+    for (size_t i = 0; i < count; i++) {
+        fixture->keys[i] = WGBenchRandom(&random) & 0xFFFFFFFFFFFFULL;   // MAC-shaped keys
+        WGHashMapPut(&fixture->map, fixture->keys[i], i);
+    }
+    return true;
+}
+
+static void WGBenchMapTeardown(WGBenchContext *context) {
+    WGBenchMapFixture *fixture = context->fixture;
+    if (fixture) {
+        WGHashMapFree(&fixture->map);
+        free(fixture->keys);
+        free(fixture);
+    }
+}
+
+static void WGBenchMapInsert(WGBenchContext *context, uint64_t iterations) {
+    WGBenchMapFixture *fixture = context->fixture;
+    for (uint64_t i = 0; i < iterations; i++) {
+        WGHashMapClear(&fixture->map);
+        for (long k = 0; k < context->arg; k++) {
+            WGHashMapPut(&fixture->map, fixture->keys[k], (uint64_t)k);
+        }
+    }
+    WGBenchKeep(WGHashMapCount(&fixture->map));
+}
+
+static void WGBenchMapFind(WGBenchContext *context, uint64_t iterations) {
+    WGBenchMapFixture *fixture = context->fixture;
+    for (uint64_t i = 0; i < iterations; i++) {
+        uint64_t sum = 0;
+        for (long k = 0; k < context->arg; k++) {
+            uint64_t *value = WGHashMapFind(&fixture->map, fixture->keys[k]);
+            sum += value ? *value : 0;
+        }
+        WGBenchKeep(sum);
+    }
+}
+
+#pragma mark - Bounded Histories
+
+// The RSSI (100 samples), anomaly (1,000) and audit (10,000) histories,
+// against the trim-on-append arrays they replaced: append to a full
+// contiguous array, then drop index 0 by moving the rest down, as
+// removeObjectAtIndex:0 did
+typedef struct {
+    WGRing ring;
+    uint8_t *array;             // Trim-on-append baseline, oldest first
+    size_t count;
+    size_t itemSize;
+    bool samples;               // WGRSSISample items, else object references
+    double clock;
+} WGBenchRingFixture;
+
+static void WGBenchRingNext(WGBenchRingFixture *fixture, uint64_t i, uint8_t item[16]) {
+    if (fixture->samples) {
+        fixture->clock += 5.0;
+        WGRSSISample sample = { .timestamp = fixture->clock, .rssi = (int8_t)(-40 - (int)(i % 30)) };
+        memcpy(item, &sample, sizeof(sample));
+    } else {
+        uintptr_t object = (uintptr_t)(i + 1) * 64;
+        memcpy(item, &object, sizeof(object));
+    }
+}
+
+// Both containers start full, so every push evicts
+static bool WGBenchRingSetupItems(WGBenchContext *context, bool samples) {
+    WGBenchRingFixture *fixture = calloc(1, sizeof(*fixture));
+    if (!fixture) {
+        return false;
+    }
+    context->fixture = fixture;
+    fixture->samples = samples;
+    fixture->itemSize = samples ? sizeof(WGRSSISample) : sizeof(void *);
+    size_t capacity = (size_t)context->arg;
+    fixture->array = malloc((capacity + 1) * fixture->itemSize);
+    if (!fixture->array || !WGRingInit(&fixture->ring, fixture->itemSize, capacity)) {
+        return false;
+    }
+    uint8_t item[16];
+    for (size_t i = 0; i < capacity; i++) {
+        WGBenchRingNext(fixture, i, item);
+        WGRingPush(&fixture->ring, item, NULL);
+        memcpy(fixture->array + i * fixture->itemSize, item, fixture->itemSize);
+    }
+    fixture->count = capacity;
+    return true;
+}
+
+static bool WGBenchRingSetup(WGBenchContext *context) {
+    return WGBenchRingSetupItems(context, true);
+}
+
+// WGRingBuffer slots: one object reference each
+static bool WGBenchRingObjectSetup(WGBenchContext *context) {
+    return WGBenchRingSetupItems(context, false);
+}
+
+static void WGBenchRingTeardown(WGBenchContext *context) {
+    WGBenchRingFixture *fixture = context->fixture;
+    if (fixture) {
+        WGRingFree(&fixture->ring);
+        free(fixture->array);
+        free(fixture);
+    }
+}
+
+static void WGBenchRingPush(WGBenchContext *context, uint64_t iterations) {
+    WGBenchRingFixture *fixture = context->fixture;
+    uint8_t item[16];
+    for (uint64_t i = 0; i < iterations; i++) {
+        WGBenchRingNext(fixture, i, item);
+        WGRingPush(&fixture->ring, item, NULL);
+    }
+    WGBenchKeep(WGRingCount(&fixture->ring));
+}
+
+static void WGBenchRingTrimPush(WGBenchContext *context, uint64_t iterations) {
+    WGBenchRingFixture *fixture = context->fixture;
+    size_t capacity = (size_t)context->arg;
+    size_t itemSize = fixture->itemSize;
+    uint8_t item[16];
+    for (uint64_t i = 0; i < iterations; i++) {
+        WGBenchRingNext(fixture, i, item);
+        memcpy(fixture->array + fixture->count * itemSize, item, itemSize);
+        if (++fixture->count > capacity) {
+            memmove(fixture->array, fixture->array + itemSize, capacity * itemSize);
+            fixture->count = capacity;
+        }
+    }
+    WGBenchKeep(fixture->array[0]);
+}
+
+#pragma mark - RSSI Series
+
+#define WG_BENCH_SERIES_COLUMNS 390     // Graph width in points, iPhone Pro Max landscape
+
+typedef struct {
+    WGSeries series;
+    double clock;
+} WGBenchSeriesFixture;
+
+static float WGBenchSeriesRSSI(uint64_t i) {
+    return (float)(-40 - (int)(i % 30) - (int)((i / 7) % 11));
+}
+
+// A series with arg samples one second apart, window arg seconds
+static bool WGBenchSeriesSetup(WGBenchContext *context) {
+    WGBenchSeriesFixture *fixture = calloc(1, sizeof(*fixture));
+    if (!fixture) {
+        return false;
+    }
+    context->fixture = fixture;
+    fixture->clock = 1700000000.0;
+    WGSeriesInit(&fixture->series, (double)context->arg, WG_BENCH_SERIES_COLUMNS);
+    for (int64_t i = 0; i < context->arg; i++) {
+        fixture->clock += 1.0;
+        if (!WGSeriesAppend(&fixture->series, fixture->clock, WGBenchSeriesRSSI((uint64_t)i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void WGBenchSeriesTeardown(WGBenchContext *context) {
+    WGBenchSeriesFixture *fixture = context->fixture;
+    if (fixture) {
+        WGSeriesFree(&fixture->series);
+        free(fixture);
+    }
+}
+
+// Steady state of a graph update: one sample in, window slides
+static void WGBenchSeriesAppend(WGBenchContext *context, uint64_t iterations) {
+    WGBenchSeriesFixture *fixture = context->fixture;
+    size_t dropped = 0;
+    for (uint64_t i = 0; i < iterations; i++) {
+        fixture->clock += 1.0;
+        WGSeriesAppend(&fixture->series, fixture->clock, WGBenchSeriesRSSI(i));
+        dropped += WGSeriesTrim(&fixture->series, fixture->clock);
+    }
+    WGBenchKeep(dropped);
+}
+
+// Resize / window change: rebucket every sample, then walk the buckets
+// the way a path rebuild does
+static void WGBenchSeriesRebucket(WGBenchContext *context, uint64_t iterations) {
+    WGBenchSeriesFixture *fixture = context->fixture;
+    context->itemsPerOp = WGSeriesCount(&fixture->series);
+    float sum = 0;
+    for (uint64_t i = 0; i < iterations; i++) {
+        uint32_t columns = WG_BENCH_SERIES_COLUMNS - (uint32_t)(i & 1);
+        WGSeriesSetResolution(&fixture->series, fixture->series.window, columns);
+        for (size_t b = 0; b < WGSeriesBucketCount(&fixture->series); b++) {
+            float values[4];
+            size_t count = WGSeriesBucketValues(WGSeriesBucketAt(&fixture->series, b), values);
+            sum += values[count - 1];
+        }
+    }
+    WGBenchKeep((uint64_t)sum);
+}
+
+#pragma mark - Record Index
+
+#define WG_BENCH_INDEX_TYPES 40
+#define WG_BENCH_INDEX_MACS 16
+#define WG_BENCH_INDEX_PAGE 100
+
+typedef struct {
+    WGRecordIndex index;
+    uint64_t time;
+    uint64_t random;
+    uint64_t seqs[WG_BENCH_INDEX_PAGE];
+} WGBenchIndexFixture;
+
+// One audit-like record: an event type and a MAC, 10 ms apart
+static void WGBenchIndexAppendOne(WGBenchIndexFixture *fixture) {
+    uint64_t keys[2] = {
+        WGRecordKey(0, WGBenchRandom(&fixture->random) % WG_BENCH_INDEX_TYPES),
+        WGRecordKey(1, 0x020000000000ULL | (WGBenchRandom(&fixture->random) % WG_BENCH_INDEX_MACS))
+    };
+    uint64_t seq;
+    fixture->time += 10000;
+    WGRecordIndexAppend(&fixture->index, fixture->time, keys, 2, &seq);
+}
+
+// A full history of arg records
+static bool WGBenchIndexSetup(WGBenchContext *context) {
+    WGBenchIndexFixture *fixture = calloc(1, sizeof(*fixture));
+    if (!fixture) {
+        return false;
+    }
+    context->fixture = fixture;
+    fixture->random = 0x9E3779B97F4A7C15ULL;
+    if (!WGRecordIndexInit(&fixture->index, (size_t)context->arg)) {
+        return false;
+    }
+    for (long i = 0; i < context->arg; i++) {
+        WGBenchIndexAppendOne(fixture);
+    }
+    return true;
+}
+
+static void WGBenchIndexTeardown(WGBenchContext *context) {
+    WGBenchIndexFixture *fixture = context->fixture;
+    if (fixture) {
+        WGRecordIndexFree(&fixture->index);
+        free(fixture);
+    }
+}
+
+// Steady state: every append evicts the oldest record
+static void WGBenchIndexAppend(WGBenchContext *context, uint64_t iterations) {
+    WGBenchIndexFixture *fixture = context->fixture;
+    for (uint64_t i = 0; i < iterations; i++) {
+        WGBenchIndexAppendOne(fixture);
+    }
+    WGBenchKeep(fixture->index.postings.total);
+}
+
+// Newest page of one event type within the last half of the history
+static void WGBenchIndexQueryType(WGBenchContext *context, uint64_t iterations) {
+    WGBenchIndexFixture *fixture = context->fixture;
+    uint64_t key = WGRecordKey(0, 7);
+    WGRecordQuery query = {
+        .since = fixture->time - (uint64_t)context->arg * 5000,
+        .keys = &key,
+        .keyCount = 1,
+        .newestFirst = true
+    };
+    uint64_t found = 0;
+    for (uint64_t i = 0; i < iterations; i++) {
+        uint64_t next;
+        found += WGRecordIndexQuery(&fixture->index, &query, fixture->seqs, WG_BENCH_INDEX_PAGE, &next);
+    }
+    context->itemsPerOp = iterations ? found / iterations : 0;
+    WGBenchKeep(found);
+}
+
+// Type and MAC combined, paging through every match
+static void WGBenchIndexQueryCombined(WGBenchContext *context, uint64_t iterations) {
+    WGBenchIndexFixture *fixture = context->fixture;
+    uint64_t keys[2] = { WGRecordKey(0, 3), WGRecordKey(1, 0x020000000000ULL | 5) };
+    uint64_t found = 0;
+    for (uint64_t i = 0; i < iterations; i++) {
+        WGRecordQuery query = { .keys = keys, .keyCount = 2 };
+        do {
+            found += WGRecordIndexQuery(&fixture->index, &query, fixture->seqs, 4, &query.cursor);
+        } while (query.cursor);
+    }
+    context->itemsPerOp = iterations ? found / iterations : 0;
+    WGBenchKeep(found);
+}
+
+#pragma mark - OUI Vendors
+
+#define WG_BENCH_OUI_LOOKUPS 4096
+#define WG_BENCH_OUI_BLOCKS 200         // Registration-authority blocks, subdivided
+#define WG_BENCH_OUI_SLICES 6000        // MA-M and MA-S assignments each
+
+typedef struct {
+    char *text;                 // Synthetic registry, oui.txt / mam.txt / oui36.txt formats
+    size_t textLength;
+    long assignments;           // Blocks in text, every one must compile
+    uint8_t *image;
+    size_t imageLength;
+    WGOUIDatabase database;
+    char path[256];             // image written out for open
+    WGMACAddress macs[WG_BENCH_OUI_LOOKUPS];
+} WGBenchOUIFixture;
+
+static bool WGBenchOUIAppend(WGBenchOUIFixture *fixture, size_t *capacity, const char *line) {
+    size_t length = strlen(line);
+    if (fixture->textLength + length > *capacity) {
+        size_t grown = *capacity * 2;
+        while (grown < fixture->textLength + length) {
+            grown *= 2;
+        }
+        char *text = realloc(fixture->text, grown);
+        if (!text) {
+            return false;
+        }
+        fixture->text = text;
+        *capacity = grown;
+    }
+    memcpy(fixture->text + fixture->textLength, line, length);
+    fixture->textLength += length;
+    return true;
+}
+
+// arg MA-L blocks from arg / 2 vendors, address lines and all, then the
+// MA-M and MA-S slices of the registration-authority blocks
+static bool WGBenchOUIRegistry(WGBenchOUIFixture *fixture, long count, uint32_t *ouis, uint64_t *slices) {
+    size_t capacity = 1 << 20;
+    fixture->text = malloc(capacity);
+    if (!fixture->text) {
+        return false;
+    }
+    uint64_t random = 0x2545F4914F6CDD1DULL;
+    char line[256];
+    for (long i = 0; i < count; i++) {
+        // Unique OUIs with the I/G and U/L bits clear, as assigned
+        uint32_t oui = (uint32_t)(((uint64_t)i * 0x9E3779B1u) & 0xFFFFFF) & ~0x030000u;
+        ouis[i] = oui;
+        const char *name = i < WG_BENCH_OUI_BLOCKS ? "IEEE Registration Authority" : NULL;
+        char vendor[64];
+        snprintf(vendor, sizeof(vendor), "Vendor %lu Networks Co., Ltd.", (unsigned long)(WGBenchRandom(&random) % (uint64_t)(count / 2 + 1)));
+        snprintf(line, sizeof(line),
+                 "%02X-%02X-%02X   (hex)\t\t%s\n%06X     (base 16)\t\t%s\n\t\t\t\t1 Example Road\n\t\t\t\tCity  ST  00000\n\t\t\t\tUS\n\n",
+                 oui >> 16, (oui >> 8) & 0xFF, oui & 0xFF, name ? name : vendor, oui, name ? name : vendor);
+        if (!WGBenchOUIAppend(fixture, &capacity, line)) {
+            return false;
+        }
+    }
+    for (long i = 0; i < 2 * WG_BENCH_OUI_SLICES; i++) {
+        bool medium = i < WG_BENCH_OUI_SLICES;
+        uint64_t block = ouis[WGBenchRandom(&random) % WG_BENCH_OUI_BLOCKS];
+        uint64_t start = medium ? (block << 24 | (WGBenchRandom(&random) & 0xF) << 20)
+                                : (block << 24 | (WGBenchRandom(&random) & 0xFFF) << 12);
+        uint64_t low = start & 0xFFFFFF;
+        uint64_t last = low + (medium ? 0xFFFFF : 0xFFF);
+        slices[i] = start;
+
+        // As mam.txt / oui36.txt list them: the prefix on the "(hex)" line,
+        // only the range within the OUI on the "(base 16)" line
+        char prefix[24];
+        if (medium) {
+            snprintf(prefix, sizeof(prefix), "%02X-%02X-%02X-%X", (unsigned)(block >> 16),
+                     (unsigned)(block >> 8) & 0xFF, (unsigned)block & 0xFF, (unsigned)(low >> 20));
+        } else {
+            snprintf(prefix, sizeof(prefix), "%02X-%02X-%02X-%02X-%X", (unsigned)(block >> 16),
+                     (unsigned)(block >> 8) & 0xFF, (unsigned)block & 0xFF, (unsigned)(low >> 16),
+                     (unsigned)(low >> 12) & 0xF);
+        }
+        snprintf(line, sizeof(line),
+                 "%s   (hex)\t\tSlice %ld GmbH\n%06llX-%06llX     (base 16)\t\tSlice %ld GmbH\n\t\t\t\t1 Example Road\n\t\t\t\tCity    00000\n\t\t\t\tDE\n\n",
+                 prefix, i, (unsigned long long)low, (unsigned long long)last, i);
+        if (!WGBenchOUIAppend(fixture, &capacity, line)) {
+            return false;
+        }
+    }
+    fixture->assignments = count + 2 * WG_BENCH_OUI_SLICES;
+    return true;
+}
+
+static bool WGBenchOUICompile(WGBenchOUIFixture *fixture, uint8_t **image, size_t *length) {
+    WGOUIBuilder builder;
+    if (!WGOUIBuilderInit(&builder)) {
+        return false;
+    }
+    bool ok = WGOUIBuilderParse(&builder, fixture->text, fixture->textLength) == fixture->assignments &&
+              WGOUIBuilderFinish(&builder, image, length) == WGOUIErrorNone;
+    WGOUIBuilderFree(&builder);
+    return ok;
+}
+
+static bool WGBenchOUISetup(WGBenchContext *context) {
+    WGBenchOUIFixture *fixture = calloc(1, sizeof(*fixture));
+    uint32_t *ouis = malloc((size_t)context->arg * sizeof(uint32_t));
+    uint64_t *slices = malloc(2 * WG_BENCH_OUI_SLICES * sizeof(uint64_t));
+    context->fixture = fixture;
+    bool ok = fixture && ouis && slices && context->arg > WG_BENCH_OUI_BLOCKS &&
+              WGBenchOUIRegistry(fixture, context->arg, ouis, slices) &&
+              WGBenchOUICompile(fixture, &fixture->image, &fixture->imageLength) &&
+              WGOUILoad(&fixture->database, fixture->image, fixture->imageLength) == WGOUIErrorNone;
+
+    // 70% assigned MA-L, 10% inside MA-M / MA-S slices, 20% unassigned
+    uint64_t random = 0x9E3779B97F4A7C15ULL;
+    for (size_t i = 0; ok && i < WG_BENCH_OUI_LOOKUPS; i++) {
+        uint64_t roll = WGBenchRandom(&random) % 10;
+        uint64_t low = WGBenchRandom(&random);
+        if (roll < 7) {
+            fixture->macs[i] = (uint64_t)ouis[low % (uint64_t)context->arg] << 24 | (low >> 40);
+        } else if (roll < 8) {
+            fixture->macs[i] = slices[low % (2 * WG_BENCH_OUI_SLICES)] | (low >> 52);
+        } else {
+            fixture->macs[i] = low & 0xFCFFFFFFFFFFULL;
+        }
+    }
+
+    if (ok) {
+        const char *directory = getenv("TMPDIR");
+        snprintf(fixture->path, sizeof(fixture->path), "%s/wgbench-oui.XXXXXX",
+                 directory && *directory ? directory : "/tmp");
+        int fd = mkstemp(fixture->path);
+        ok = fd >= 0 && write(fd, fixture->image, fixture->imageLength) == (ssize_t)fixture->imageLength;
+        if (fd >= 0) {
+            close(fd);
+        } else {
+            fixture->path[0] = '\0';
+        }
+    }
+    free(ouis);
+    free(slices);
+    context->itemsPerOp = WG_BENCH_OUI_LOOKUPS;
+    context->bytesPerOp = 0;
+    return ok;
+}
+
+static void WGBenchOUITeardown(WGBenchContext *context) {
+    WGBenchOUIFixture *fixture = context->fixture;
+    if (fixture) {
+        if (fixture->path[0]) {
+            unlink(fixture->path);
+        }
+        free(fixture->text);
+        free(fixture->image);
+        free(fixture);
+    }
+}
+
+static void WGBenchOUILookup(WGBenchContext *context, uint64_t iterations) {
+    WGBenchOUIFixture *fixture = context->fixture;
+    for (uint64_t i = 0; i < iterations; i++) {
+        uint64_t sum = 0;
+        for (size_t k = 0; k < WG_BENCH_OUI_LOOKUPS; k++) {
+            sum += WGOUILookup(&fixture->database, fixture->macs[k]);
+        }
+        WGBenchKeep(sum);
+    }
+}
+
+// Startup: map the file, check the header, resolve one vendor
+static void WGBenchOUIOpen(WGBenchContext *context, uint64_t iterations) {
+    WGBenchOUIFixture *fixture = context->fixture;
+    context->itemsPerOp = 1;
+    context->bytesPerOp = fixture->imageLength;
+    for (uint64_t i = 0; i < iterations; i++) {
+        WGOUIDatabase database;
+        if (WGOUIOpen(&database, fixture->path) == WGOUIErrorNone) {
+            WGBenchKeep(WGOUILookup(&database, fixture->macs[i % WG_BENCH_OUI_LOOKUPS]));
+            WGOUIClose(&database);
+        }
+    }
+}
+
+// Build host: parse the registry text and lay out the image
+static void WGBenchOUICompileRegistry(WGBenchContext *context, uint64_t iterations) {
+    WGBenchOUIFixture *fixture = context->fixture;
+    context->itemsPerOp = (uint64_t)context->arg + 2 * WG_BENCH_OUI_SLICES;
+    context->bytesPerOp = fixture->textLength;
+    for (uint64_t i = 0; i < iterations; i++) {
+        uint8_t *image = NULL;
+        size_t length = 0;
+        if (WGBenchOUICompile(fixture, &image, &length)) {
+            WGBenchKeep(length);
+        }
+        free(image);
+    }
+}
+
+#pragma mark - Metrics
+
+// What instrumenting a stage adds: two clock reads and a histogram update
+static void WGBenchMetricsTimed(WGBenchContext *context, uint64_t iterations) {
+    (void)context;
+    for (uint64_t i = 0; i < iterations; i++) {
+        WGMetricsEnd(WGMetricStageScanMerge, WGMetricsNow());
+    }
+}
+
+static void WGBenchMetricsRecord(WGBenchContext *context, uint64_t iterations) {
+    (void)context;
+    for (uint64_t i = 0; i < iterations; i++) {
+        WGMetricsRecord(WGMetricStageScanMerge, 1000 + (i & 0xffff));
+    }
+}
+
+#pragma mark - Schedule
+
+#define WG_BENCH_SCHEDULE_SECONDS 3600
+
+static uint64_t WGBenchScheduleClock(void *context) {
+    return *(const uint64_t *)context;
+}
+
+// One virtual hour of ARP checks (3 s base) and scans (5 s base) with
+// default budgets and an anomaly every 10 minutes; one op is the whole hour
+static void WGBenchScheduleHour(WGBenchContext *context, uint64_t iterations) {
+    const uint64_t second = 1000000000ull;
+    uint64_t runs = 0;
+    for (uint64_t i = 0; i < iterations; i++) {
+        uint64_t now = 0;
+        WGSchedulePolicy policy;
+        WGSchedulePolicyInit(&policy, WGBenchScheduleClock, &now);
+
+        WGScheduleConfig arp = WGScheduleConfigDefault(3 * second);
+        arp.cpuBudget = 0.01;
+        arp.maxWakeupsPerMinute = 60;
+        WGScheduleConfig scan = WGScheduleConfigDefault(5 * second);
+        scan.cpuBudget = 0.01;
+        scan.maxWakeupsPerMinute = 20;
+        int arpTask = WGSchedulePolicyAddTask(&policy, &arp);
+        int scanTask = WGSchedulePolicyAddTask(&policy, &scan);
+        WGSchedulePolicyStart(&policy, arpTask);
+        WGSchedulePolicyStart(&policy, scanTask);
+
+        uint64_t nextAlert = 600 * second;
+        int task = -1;
+        uint64_t due;
+        while ((due = WGSchedulePolicyNextDue(&policy, &task)) < WG_BENCH_SCHEDULE_SECONDS * second) {
+            now = due;
+            WGSchedulePolicyBeginRun(&policy, task);
+            now += 2000000;
+            WGScheduleActivity activity = WGScheduleActivityQuiet;
+            if (task == arpTask && now >= nextAlert) {
+                activity = WGScheduleActivityAlert;
+                nextAlert += 600 * second;
+            }
+            WGSchedulePolicyRecordRun(&policy, task, 2000000, activity);
+            runs++;
+        }
+    }
+    context->itemsPerOp = iterations ? runs / iterations : 0;
+    WGBenchKeep(runs);
+}
+
+static const WGBenchCase kWGBenchUtilsCases[] = {
+    { "address", "mac_parse",            WG_BENCH_ADDRESS_COUNT, WGBenchAddressSetup, WGBenchMACParse,           WGBenchAddressTeardown },
+    { "address", "mac_format",           WG_BENCH_ADDRESS_COUNT, WGBenchAddressSetup, WGBenchMACFormat,          WGBenchAddressTeardown },
+    { "address", "ipv4_parse",           WG_BENCH_ADDRESS_COUNT, WGBenchAddressSetup, WGBenchIPv4Parse,          WGBenchAddressTeardown },
+    { "address", "ipv4_format",          WG_BENCH_ADDRESS_COUNT, WGBenchAddressSetup, WGBenchIPv4Format,         WGBenchAddressTeardown },
+    { "address", "frequency_to_channel", WG_BENCH_ADDRESS_COUNT, WGBenchAddressSetup, WGBenchFrequencyToChannel, WGBenchAddressTeardown },
+    { "hashmap", "insert",               10000,                  WGBenchMapSetup,     WGBenchMapInsert,          WGBenchMapTeardown },
+    { "hashmap", "insert",               100000,                 WGBenchMapSetup,     WGBenchMapInsert,          WGBenchMapTeardown },
+    { "hashmap", "find",                 10000,                  WGBenchMapSetup,     WGBenchMapFind,            WGBenchMapTeardown },
+    { "hashmap", "find",                 100000,                 WGBenchMapSetup,     WGBenchMapFind,            WGBenchMapTeardown },
+    { "ring",    "rssi_push",            WG_SCAN_HISTORY_CAPACITY, WGBenchRingSetup,  WGBenchRingPush,           WGBenchRingTeardown },
+    { "ring",    "rssi_push_trim",       WG_SCAN_HISTORY_CAPACITY, WGBenchRingSetup,  WGBenchRingTrimPush,       WGBenchRingTeardown },
+    { "ring",    "object_push",          1000,                   WGBenchRingObjectSetup, WGBenchRingPush,        WGBenchRingTeardown },
+    { "ring",    "object_push_trim",     1000,                   WGBenchRingObjectSetup, WGBenchRingTrimPush,    WGBenchRingTeardown },
+    { "ring",    "object_push",          10000,                  WGBenchRingObjectSetup, WGBenchRingPush,        WGBenchRingTeardown },
+    { "ring",    "object_push_trim",     10000,                  WGBenchRingObjectSetup, WGBenchRingTrimPush,    WGBenchRingTeardown },
+    { "series",  "append",               3600,                   WGBenchSeriesSetup,  WGBenchSeriesAppend,       WGBenchSeriesTeardown },
+    { "series",  "rebucket",             3600,                   WGBenchSeriesSetup,  WGBenchSeriesRebucket,     WGBenchSeriesTeardown },
+    { "series",  "rebucket",             86400,                  WGBenchSeriesSetup,  WGBenchSeriesRebucket,     WGBenchSeriesTeardown },
+    { "index",   "append",               10000,                  WGBenchIndexSetup,   WGBenchIndexAppend,        WGBenchIndexTeardown },
+    { "index",   "query_type_page",      10000,                  WGBenchIndexSetup,   WGBenchIndexQueryType,     WGBenchIndexTeardown },
+    { "index",   "query_combined",       10000,                  WGBenchIndexSetup,   WGBenchIndexQueryCombined, WGBenchIndexTeardown },
+    { "metrics", "record",               0,                      NULL,                WGBenchMetricsRecord,      NULL },
+    { "metrics", "timed_stage",          0,                      NULL,                WGBenchMetricsTimed,       NULL },
+    { "schedule", "simulate_hour",       WG_BENCH_SCHEDULE_SECONDS, NULL,             WGBenchScheduleHour,       NULL },
+    { "oui",     "lookup",               40000,                  WGBenchOUISetup,     WGBenchOUILookup,          WGBenchOUITeardown },
+    { "oui",     "open",                 40000,                  WGBenchOUISetup,     WGBenchOUIOpen,            WGBenchOUITeardown },
+    { "oui",     "compile",              40000,                  WGBenchOUISetup,     WGBenchOUICompileRegistry, WGBenchOUITeardown },
+};
+
+const WGBenchSuite WGBenchUtilsSuite = {
+    kWGBenchUtilsCases, sizeof(kWGBenchUtilsCases) / sizeof(kWGBenchUtilsCases[0])
+};
@@ -0,0 +1,148 @@
+/*
+ * WGOUITool.c - OUI Vendor Database Compiler
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * Usage: wgoui -o oui.wgo registry.txt ...
+ *        wgoui --lookup=oui.wgo MAC ...
+ *
+ * Compiles the IEEE registry text (oui.txt, mam.txt, oui36.txt - any
+ * subset, in any order) into the .wgo image WGOUIOpen maps at startup.
+ * Where files repeat a prefix, the first one given wins. --lookup prints
+ * the vendor of each MAC in an existing database, for spot checks.
+ */
+
+#include "WGOUI.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static char *WGOUIToolReadFile(const char *path, size_t *length) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return NULL;
+    }
+    size_t capacity = 1 << 20;
+    size_t used = 0;
+    char *data = malloc(capacity);
+    while (data) {
+        used += fread(data + used, 1, capacity - used, file);
+        if (used < capacity) {
+            break;
+        }
+        char *grown = realloc(data, capacity * 2);
+        if (!grown) {
+            free(data);
+            data = NULL;
+            break;
+        }
+        data = grown;
+        capacity *= 2;
+    }
+    if (data && ferror(file)) {
+        free(data);
+        data = NULL;
+    }
+    fclose(file);
+    *length = used;
+    return data;
+}
+
+static int WGOUIToolLookup(const char *path, int argc, char **argv) {
+    WGOUIDatabase database;
+    WGOUIError error = WGOUIOpen(&database, path);
+    if (error != WGOUIErrorNone) {
+        fprintf(stderr, "%s: %s\n", path, WGOUIErrorString(error));
+        return 1;
+    }
+    int status = 0;
+    for (int i = 0; i < argc; i++) {
+        WGMACAddress mac = 0;
+        if (!WGMACParse(argv[i], &mac)) {
+            fprintf(stderr, "%s: not a MAC address\n", argv[i]);
+            status = 1;
+            continue;
+        }
+        WGVendorID vendor = WGOUILookup(&database, mac);
+        printf("%s\t%u\t%s\n", argv[i], vendor, vendor ? WGOUIVendorName(&database, vendor) : "Unknown");
+    }
+    WGOUIClose(&database);
+    return status;
+}
+
+static int WGOUIToolCompile(const char *output, int argc, char **argv) {
+    WGOUIBuilder builder;
+    if (!WGOUIBuilderInit(&builder)) {
+        fprintf(stderr, "wgoui: out of memory\n");
+        return 1;
+    }
+
+    for (int i = 0; i < argc; i++) {
+        size_t length = 0;
+        char *text = WGOUIToolReadFile(argv[i], &length);
+        if (!text) {
+            fprintf(stderr, "%s: %s\n", argv[i], strerror(errno));
+            WGOUIBuilderFree(&builder);
+            return 1;
+        }
+        long added = WGOUIBuilderParse(&builder, text, length);
+        free(text);
+        if (added < 0) {
+            fprintf(stderr, "wgoui: out of memory\n");
+            WGOUIBuilderFree(&builder);
+            return 1;
+        }
+        if (added == 0) {
+            fprintf(stderr, "%s: warning: no assignments found\n", argv[i]);
+        }
+    }
+
+    uint8_t *image = NULL;
+    size_t length = 0;
+    WGOUIError error = WGOUIBuilderFinish(&builder, &image, &length);
+    uint32_t vendorCount = builder.vendorCount;
+    WGOUIBuilderFree(&builder);
+    if (error != WGOUIErrorNone) {
+        fprintf(stderr, "wgoui: %s\n", WGOUIErrorString(error));
+        return 1;
+    }
+
+    // Write beside the target and rename, so a build never ships half a file
+    char temporary[4096];
+    snprintf(temporary, sizeof(temporary), "%s.tmp", output);
+    FILE *file = fopen(temporary, "wb");
+    bool written = file && fwrite(image, 1, length, file) == length;
+    if (file && fclose(file) != 0) {
+        written = false;
+    }
+    free(image);
+    if (!written || rename(temporary, output) != 0) {
+        fprintf(stderr, "%s: %s\n", output, strerror(errno));
+        remove(temporary);
+        return 1;
+    }
+
+    WGOUIDatabase database;
+    error = WGOUIOpen(&database, output);
+    if (error != WGOUIErrorNone) {
+        fprintf(stderr, "%s: %s\n", output, WGOUIErrorString(error));
+        return 1;
+    }
+    printf("%s: %u MA-L, %u MA-M, %u MA-S, %u vendors, %zu bytes\n", output,
+           database.largeCount, database.mediumCount, database.smallCount, vendorCount - 1, length);
+    WGOUIClose(&database);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc >= 3 && strncmp(argv[1], "--lookup=", 9) == 0) {
+        return WGOUIToolLookup(argv[1] + 9, argc - 2, argv + 2);
+    }
+    if (argc >= 4 && strcmp(argv[1], "-o") == 0) {
+        return WGOUIToolCompile(argv[2], argc - 3, argv + 3);
+    }
+    fprintf(stderr, "usage: %s -o oui.wgo registry.txt ...\n"
+                    "       %s --lookup=oui.wgo MAC ...\n", argv[0], argv[0]);
+    return 2;
+}
@@ -0,0 +1,243 @@
+/*
+ * WGSim.c - Headless ARP Scenario Runner
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * SIMULATION ONLY - synthetic tables, no network access.
+ *
+ * Usage: wgsim [--format=json|table] [--filter=substring] [--hosts=n]
+ *              [--duration=seconds] [--check=ms] [--seed=n] [--list]
+ *              [--script=file.wgscn ...]
+ *
+ * Plays every built-in WGARPSimulation scenario at full speed and prints
+ * detection latency, true/false positives and throughput per scenario.
+ * With --script, plays scenario files (WGScenarioScript) instead and also
+ * reports how many of their expected detections were met. Exits 1 if an
+ * attack goes undetected or an expectation is missed, so it doubles as a
+ * detection regression check.
+ */
+
+#include "WGARPSimulation.h"
+#include "WGMetrics.h"
+#include "WGScenarioScript.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define WG_SIM_MAX_SCRIPTS 64
+
+typedef enum {
+    WGSimFormatJSON = 0,
+    WGSimFormatTable
+} WGSimFormat;
+
+typedef struct {
+    WGSimFormat format;
+    const char *filter;
+    long hosts;
+    double duration;            // Virtual seconds, 0 = preset
+    long checkMs;               // 0 = preset
+    unsigned long long seed;    // 0 = preset
+    bool list;
+    const char *scripts[WG_SIM_MAX_SCRIPTS];
+    int scriptCount;
+} WGSimOptions;
+
+static bool WGSimParseOptions(int argc, char **argv, WGSimOptions *options) {
+    *options = (WGSimOptions){ .format = WGSimFormatJSON, .hosts = 1000 };
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if (strcmp(arg, "--format=json") == 0) {
+            options->format = WGSimFormatJSON;
+        } else if (strcmp(arg, "--format=table") == 0) {
+            options->format = WGSimFormatTable;
+        } else if (strncmp(arg, "--filter=", 9) == 0) {
+            options->filter = arg + 9;
+        } else if (strncmp(arg, "--hosts=", 8) == 0) {
+            options->hosts = atol(arg + 8);
+        } else if (strncmp(arg, "--duration=", 11) == 0) {
+            options->duration = atof(arg + 11);
+        } else if (strncmp(arg, "--check=", 8) == 0) {
+            options->checkMs = atol(arg + 8);
+        } else if (strncmp(arg, "--seed=", 7) == 0) {
+            options->seed = strtoull(arg + 7, NULL, 0);
+        } else if (strcmp(arg, "--list") == 0) {
+            options->list = true;
+        } else if (strncmp(arg, "--script=", 9) == 0 && options->scriptCount < WG_SIM_MAX_SCRIPTS) {
+            options->scripts[options->scriptCount++] = arg + 9;
+        } else {
+            return false;
+        }
+    }
+    return options->hosts >= 0 && options->hosts <= UINT32_MAX - WG_ARP_SIM_CLIENTS &&
+           options->duration >= 0 && options->checkMs >= 0;
+}
+
+static void WGSimPrintResult(const WGARPSimScenario *scenario, const WGARPSimResult *result,
+                             uint64_t wallNs, const WGSimOptions *options) {
+    uint64_t latency = WGARPSimDetectionLatencyMs(result);
+    bool detected = latency != WG_ARP_SIM_NEVER;
+    double wallSeconds = wallNs / 1e9;
+    double checksPerSecond = wallSeconds > 0 ? result->checks / wallSeconds : 0;
+    double recordsPerSecond = wallSeconds > 0 ? result->records / wallSeconds : 0;
+    double speedup = wallSeconds > 0 ? scenario->durationMs / 1000.0 / wallSeconds : 0;
+
+    if (options->format == WGSimFormatTable) {
+        char latencyText[32];
+        snprintf(latencyText, sizeof(latencyText), detected ? "%.1f" : "-", latency / 1000.0);
+        printf("%-16s %8u %7llu %6llu %6llu %11s %12.0f %14.0f %10.0fx\n",
+               scenario->name, scenario->clientCount, (unsigned long long)result->checks,
+               (unsigned long long)result->truePositives, (unsigned long long)result->falsePositives,
+               latencyText, checksPerSecond, recordsPerSecond, speedup);
+        return;
+    }
+    printf("{\"type\":\"scenario\",\"name\":\"%s\",\"clients\":%u,\"virtual_s\":%.1f,"
+           "\"checks\":%llu,\"records\":%llu,\"changes\":%llu,\"findings\":%llu,"
+           "\"true_positives\":%llu,\"false_positives\":%llu,\"detected\":%s,",
+           scenario->name, scenario->clientCount, scenario->durationMs / 1000.0,
+           (unsigned long long)result->checks, (unsigned long long)result->records,
+           (unsigned long long)result->changes, (unsigned long long)result->findings,
+           (unsigned long long)result->truePositives, (unsigned long long)result->falsePositives,
+           detected ? "true" : "false");
+    if (detected) {
+        printf("\"detection_latency_ms\":%llu,", (unsigned long long)latency);
+    } else {
+        printf("\"detection_latency_ms\":null,");
+    }
+    printf("\"wall_ms\":%.3f,\"analysis_ms\":%.3f,\"checks_per_sec\":%.1f,"
+           "\"records_per_sec\":%.1f,\"speedup\":%.1f}\n",
+           wallNs / 1e6, result->wallNs / 1e6, checksPerSecond, recordsPerSecond, speedup);
+}
+
+static void WGSimPrintScriptResult(const char *path, const WGScenarioScript *script,
+                                   const WGScenarioRunResult *run, uint64_t wallNs,
+                                   const WGSimOptions *options) {
+    const WGARPSimResult *result = &run->sim;
+    const char *name = script->name ? WGScenarioString(script, script->name) : path;
+    double wallSeconds = wallNs / 1e9;
+    double checksPerSecond = wallSeconds > 0 ? result->checks / wallSeconds : 0;
+
+    if (options->format == WGSimFormatTable) {
+        char latencyText[32];
+        bool met = run->maxLatencyMs != WG_ARP_SIM_NEVER;
+        snprintf(latencyText, sizeof(latencyText), met ? "%.1f" : "-", run->maxLatencyMs / 1000.0);
+        printf("%-28s %8zu %8zu %7llu %6llu %6llu %5u/%-5u %11s %12.0f\n",
+               name, script->hostCount, script->eventCount, (unsigned long long)result->checks,
+               (unsigned long long)result->truePositives, (unsigned long long)result->falsePositives,
+               run->met, run->expectations, latencyText, checksPerSecond);
+        return;
+    }
+    printf("{\"type\":\"script\",\"name\":\"%s\",\"file\":\"%s\",\"hosts\":%zu,\"events\":%zu,"
+           "\"virtual_s\":%.1f,\"checks\":%llu,\"records\":%llu,\"findings\":%llu,"
+           "\"true_positives\":%llu,\"false_positives\":%llu,\"expectations\":%u,\"met\":%u,",
+           name, path, script->hostCount, script->eventCount, script->durationMs / 1000.0,
+           (unsigned long long)result->checks, (unsigned long long)result->records,
+           (unsigned long long)result->findings, (unsigned long long)result->truePositives,
+           (unsigned long long)result->falsePositives, run->expectations, run->met);
+    if (run->maxLatencyMs != WG_ARP_SIM_NEVER) {
+        printf("\"max_expect_latency_ms\":%llu,", (unsigned long long)run->maxLatencyMs);
+    } else {
+        printf("\"max_expect_latency_ms\":null,");
+    }
+    printf("\"wall_ms\":%.3f,\"checks_per_sec\":%.1f}\n", wallNs / 1e6, checksPerSecond);
+}
+
+static int WGSimRunScripts(const WGSimOptions *options) {
+    if (options->format == WGSimFormatTable) {
+        printf("%-28s %8s %8s %7s %6s %6s %11s %11s %12s\n",
+               "script", "hosts", "events", "checks", "TP", "FP", "expected", "max lat s", "checks/s");
+    }
+
+    int failures = 0;
+    for (int i = 0; i < options->scriptCount; i++) {
+        const char *path = options->scripts[i];
+        WGScenarioScript script;
+        uint64_t start = WGMetricsNow();
+        WGScenarioError error = WGScenarioScriptOpen(&script, path);
+        if (error != WGScenarioErrorNone) {
+            if (error == WGScenarioErrorIO) {
+                fprintf(stderr, "%s: %s: %s\n", path, WGScenarioErrorString(error), strerror(errno));
+            } else {
+                fprintf(stderr, "%s:%zu: %s: %s\n", path, script.errorLine, WGScenarioErrorString(error),
+                        script.errorDetail);
+            }
+            WGScenarioScriptFree(&script);
+            failures++;
+            continue;
+        }
+        uint64_t compileNs = WGMetricsNow() - start;
+
+        WGScenarioRunResult run;
+        start = WGMetricsNow();
+        if (!WGScenarioScriptRun(&script, &run, NULL)) {
+            fprintf(stderr, "%s: out of memory\n", path);
+            failures++;
+        } else {
+            WGSimPrintScriptResult(path, &script, &run, WGMetricsNow() - start, options);
+            if (options->format == WGSimFormatJSON) {
+                printf("{\"type\":\"compile\",\"file\":\"%s\",\"events\":%zu,\"compile_ms\":%.3f}\n",
+                       path, script.eventCount, compileNs / 1e6);
+            }
+            failures += run.met < run.expectations;
+        }
+        WGScenarioScriptFree(&script);
+        fflush(stdout);
+    }
+    return failures > 0 ? 1 : 0;
+}
+
+int main(int argc, char **argv) {
+    WGSimOptions options;
+    if (!WGSimParseOptions(argc, argv, &options)) {
+        fprintf(stderr, "usage: %s [--format=json|table] [--filter=substring] [--hosts=n] "
+                        "[--duration=seconds] [--check=ms] [--seed=n] [--list] "
+                        "[--script=file.wgscn ...]\n", argv[0]);
+        return 2;
+    }
+    if (options.scriptCount > 0) {
+        return WGSimRunScripts(&options);
+    }
+
+    if (options.format == WGSimFormatTable && !options.list) {
+        printf("%-16s %8s %7s %6s %6s %11s %12s %14s %11s\n",
+               "scenario", "clients", "checks", "TP", "FP", "latency s", "checks/s", "records/s", "speedup");
+    }
+
+    int failures = 0;
+    for (int attack = 0; attack < WGARPSimAttackCount; attack++) {
+        WGARPSimScenario scenario;
+        WGARPSimScenarioPreset(&scenario, (WGARPSimAttack)attack, (uint32_t)options.hosts);
+        if (options.filter && !strstr(scenario.name, options.filter)) {
+            continue;
+        }
+        if (options.list) {
+            printf("%s\n", scenario.name);
+            continue;
+        }
+        if (options.checkMs > 0) {
+            scenario.checkIntervalMs = (uint32_t)options.checkMs;
+        }
+        if (options.duration > 0) {
+            scenario.durationMs = (uint64_t)(options.duration * 1000.0);
+            scenario.attackStartMs = scenario.durationMs / 2 + scenario.checkIntervalMs / 3;
+        }
+        if (options.seed) {
+            scenario.seed = options.seed;
+        }
+
+        WGARPSimResult result;
+        uint64_t start = WGMetricsNow();
+        if (!WGARPSimRun(&scenario, &result)) {
+            fprintf(stderr, "%s: out of memory\n", scenario.name);
+            failures++;
+            continue;
+        }
+        WGSimPrintResult(&scenario, &result, WGMetricsNow() - start, &options);
+        if (scenario.attack != WGARPSimAttackNone && WGARPSimDetectionLatencyMs(&result) == WG_ARP_SIM_NEVER) {
+            failures++;
+        }
+        fflush(stdout);
+    }
+    return failures > 0 ? 1 : 0;
+}
@@ -88,6 +88,9 @@ static AppDelegate *_sharedInstance = nil;
     if ([[WGARPDetector sharedInstance] isMonitoring]) {
         [[WGARPDetector sharedInstance] stopMonitoring];
     }
+    
+    // Commit buffered audit entries before the app may be suspended
+    [[WGAuditLogger sharedInstance] flush];
 }
 
 - (void)applicationWillEnterForeground:(UIApplication *)application {
@@ -97,6 +100,7 @@ static AppDelegate *_sharedInstance = nil;
 - (void)applicationWillTerminate:(UIApplication *)application {
     [[WGAuditLogger sharedInstance] logEvent:@"APP_TERMINATE" details:@"Application will terminate"];
     [[WGAuditLogger sharedInstance] endSession];
+    [[WGAuditLogger sharedInstance] flush];
 }
 
 #pragma mark - Kill Switch
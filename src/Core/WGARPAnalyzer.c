@@ -0,0 +1,500 @@
+/*
+ * WGARPAnalyzer.c - Incremental ARP Anomaly Engine Implementation
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * DETECTION ONLY - NO ACTIVE ATTACKS OR COUNTERMEASURES
+ */
+
+#include "WGARPAnalyzer.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#pragma mark - Helpers
+
+static bool WGGrowArray(void **items, size_t *capacity, size_t needed, size_t elemSize) {
+    if (needed <= *capacity) {
+        return true;
+    }
+    size_t newCapacity = *capacity ? *capacity * 2 : 32;
+    while (newCapacity < needed) {
+        newCapacity *= 2;
+    }
+    void *grown = realloc(*items, newCapacity * elemSize);
+    if (!grown) {
+        return false;
+    }
+    *items = grown;
+    *capacity = newCapacity;
+    return true;
+}
+
+static inline int WGARPCompareKey(const WGARPRecord *a, const WGARPRecord *b) {
+    if (a->ip != b->ip) {
+        return a->ip < b->ip ? -1 : 1;
+    }
+    return (a->ifindex > b->ifindex) - (a->ifindex < b->ifindex);
+}
+
+static bool WGARPTableIsSortedByIP(const WGARPTable *table) {
+    for (size_t i = 1; i < table->count; i++) {
+        if (WGARPCompareKey(&table->records[i - 1], &table->records[i]) > 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool WGARPAnalyzerAddChange(WGARPAnalyzer *analyzer, const WGARPRecord *record,
+                                   uint64_t previousMAC, WGARPChangeKind kind) {
+    if (!WGGrowArray((void **)&analyzer->changes, &analyzer->changeCapacity,
+                     analyzer->changeCount + 1, sizeof(WGARPChange))) {
+        return false;
+    }
+    WGARPChange *change = &analyzer->changes[analyzer->changeCount++];
+    change->record = *record;
+    change->previousMAC = previousMAC;
+    change->kind = (uint8_t)kind;
+    return true;
+}
+
+static WGARPFinding *WGARPAnalyzerAddFinding(WGARPAnalyzer *analyzer, WGARPFindingKind kind, uint8_t severity) {
+    if (!WGGrowArray((void **)&analyzer->findings, &analyzer->findingCapacity,
+                     analyzer->findingCount + 1, sizeof(WGARPFinding))) {
+        return NULL;
+    }
+    WGARPFinding *finding = &analyzer->findings[analyzer->findingCount++];
+    memset(finding, 0, sizeof(*finding));
+    finding->kind = (uint8_t)kind;
+    finding->severity = severity;
+    return finding;
+}
+
+#pragma mark - MAC Count Index
+
+static bool WGARPAnalyzerCountMAC(WGARPAnalyzer *analyzer, uint64_t mac) {
+    uint64_t *count = WGHashMapInsert(&analyzer->macCounts, mac, NULL);
+    if (!count) {
+        return false;
+    }
+    if (++(*count) == 2 && !WGMACIsMulticast(mac)) {
+        analyzer->duplicateMACCount++;
+    }
+    return true;
+}
+
+static void WGARPAnalyzerUncountMAC(WGARPAnalyzer *analyzer, uint64_t mac) {
+    uint64_t *count = WGHashMapFind(&analyzer->macCounts, mac);
+    if (!count) {
+        return;
+    }
+    if (--(*count) == 1 && !WGMACIsMulticast(mac)) {
+        analyzer->duplicateMACCount--;
+    } else if (*count == 0) {
+        WGHashMapRemove(&analyzer->macCounts, mac);
+    }
+}
+
+#pragma mark - Lifecycle
+
+bool WGARPAnalyzerInit(WGARPAnalyzer *analyzer) {
+    memset(analyzer, 0, sizeof(*analyzer));
+    analyzer->alertOnMACChange = true;
+    analyzer->alertOnDuplicateMAC = true;
+    analyzer->alertOnGatewayChange = true;
+    analyzer->alertOnBSSIDMismatch = true;
+    WGARPTableInit(&analyzer->snapshot);
+    WGARPTableInit(&analyzer->scratch);
+
+    if (!WGHashMapInit(&analyzer->knownMACs, 256) ||
+        !WGHashMapInit(&analyzer->macCounts, 256) ||
+        !WGHashMapInit(&analyzer->trustedMACs, 8) ||
+        !WGHashMapInit(&analyzer->touchedMACs, 16)) {
+        WGARPAnalyzerFree(analyzer);
+        return false;
+    }
+    return true;
+}
+
+void WGARPAnalyzerFree(WGARPAnalyzer *analyzer) {
+    WGARPTableFree(&analyzer->snapshot);
+    WGARPTableFree(&analyzer->scratch);
+    WGHashMapFree(&analyzer->knownMACs);
+    WGHashMapFree(&analyzer->macCounts);
+    WGHashMapFree(&analyzer->trustedMACs);
+    WGHashMapFree(&analyzer->touchedMACs);
+    free(analyzer->changes);
+    free(analyzer->findings);
+    free(analyzer->duplicateIPs);
+    free(analyzer->macChanges);
+    analyzer->changes = NULL;
+    analyzer->findings = NULL;
+    analyzer->duplicateIPs = NULL;
+    analyzer->macChanges = NULL;
+    analyzer->changeCapacity = analyzer->findingCapacity = analyzer->duplicateIPCapacity = 0;
+    analyzer->macChangeCapacity = 0;
+}
+
+#pragma mark - Checks
+
+// Compares an added/modified record with the last MAC ever seen for its IP
+static bool WGARPAnalyzerObserve(WGARPAnalyzer *analyzer, const WGARPRecord *record) {
+    bool inserted = false;
+    uint64_t *known = WGHashMapInsert(&analyzer->knownMACs, record->ip, &inserted);
+    if (!known) {
+        return false;
+    }
+
+    if (!inserted && *known != record->mac) {
+        if (!WGGrowArray((void **)&analyzer->macChanges, &analyzer->macChangeCapacity,
+                         analyzer->macChangeCount + 1, sizeof(WGARPMACChange))) {
+            return false;
+        }
+        WGARPMACChange *change = &analyzer->macChanges[analyzer->macChangeCount++];
+        change->ip = record->ip;
+        change->previousMAC = *known;
+        change->currentMAC = record->mac;
+    }
+
+    if (!inserted && *known != record->mac && analyzer->alertOnMACChange) {
+        bool isGateway = analyzer->hasGateway && record->ip == analyzer->gatewayIP;
+        WGARPFinding *finding = WGARPAnalyzerAddFinding(analyzer,
+            isGateway ? WGARPFindingGatewayEntryChange : WGARPFindingMACChange,
+            isGateway ? 10 : 6);
+        if (!finding) {
+            return false;
+        }
+        finding->ip = record->ip;
+        finding->previousMAC = *known;
+        finding->currentMAC = record->mac;
+    }
+
+    *known = record->mac;
+    return true;
+}
+
+// With onlyTouched set, only MACs recorded in touchedMACs are reported
+static bool WGARPAnalyzerCheckDuplicates(WGARPAnalyzer *analyzer, bool onlyTouched) {
+    // Gather only entries whose MAC is shared, then group them by MAC
+    WGARPTable *scratch = &analyzer->scratch;
+    scratch->count = 0;
+    if (!WGARPTableReserve(scratch, analyzer->snapshot.count)) {
+        return false;
+    }
+    for (size_t i = 0; i < analyzer->snapshot.count; i++) {
+        const WGARPRecord *record = &analyzer->snapshot.records[i];
+        uint64_t *count = WGHashMapFind(&analyzer->macCounts, record->mac);
+        if (count && *count > 1 && !WGMACIsMulticast(record->mac) &&
+            (!onlyTouched || WGHashMapFind(&analyzer->touchedMACs, record->mac))) {
+            scratch->records[scratch->count++] = *record;
+        }
+    }
+    WGARPTableSortByMAC(scratch);
+
+    size_t runStart = 0;
+    for (size_t i = 1; i <= scratch->count; i++) {
+        if (i < scratch->count && scratch->records[i].mac == scratch->records[runStart].mac) {
+            continue;
+        }
+
+        size_t runLength = i - runStart;
+        if (!WGGrowArray((void **)&analyzer->duplicateIPs, &analyzer->duplicateIPCapacity,
+                         analyzer->duplicateIPCount + runLength, sizeof(uint32_t))) {
+            return false;
+        }
+
+        WGARPFinding *finding = WGARPAnalyzerAddFinding(analyzer, WGARPFindingDuplicateMAC, 7);
+        if (!finding) {
+            return false;
+        }
+        finding->currentMAC = scratch->records[runStart].mac;
+        finding->ipOffset = (uint32_t)analyzer->duplicateIPCount;
+        finding->ipCount = (uint32_t)runLength;
+        for (size_t j = runStart; j < i; j++) {
+            analyzer->duplicateIPs[analyzer->duplicateIPCount++] = scratch->records[j].ip;
+        }
+
+        runStart = i;
+    }
+    return true;
+}
+
+static bool WGARPAnalyzerCheckGateway(WGARPAnalyzer *analyzer) {
+    uint64_t *current = WGHashMapFind(&analyzer->knownMACs, analyzer->gatewayIP);
+
+    if (analyzer->hasLastGatewayMAC && current && *current != analyzer->lastGatewayMAC) {
+        uint64_t *trusted = WGHashMapFind(&analyzer->trustedMACs, analyzer->gatewayIP);
+        if (!trusted || *trusted != *current) {
+            WGARPFinding *finding = WGARPAnalyzerAddFinding(analyzer, WGARPFindingGatewayMACChange, 10);
+            if (!finding) {
+                return false;
+            }
+            finding->ip = analyzer->gatewayIP;
+            finding->previousMAC = analyzer->lastGatewayMAC;
+            finding->currentMAC = *current;
+        }
+    }
+
+    analyzer->hasLastGatewayMAC = (current != NULL);
+    analyzer->lastGatewayMAC = current ? *current : 0;
+    return true;
+}
+
+static bool WGARPAnalyzerCheckVendor(WGARPAnalyzer *analyzer) {
+    if (!analyzer->alertOnBSSIDMismatch || !analyzer->hasGateway ||
+        !analyzer->vendors || analyzer->apVendor == WG_OUI_UNKNOWN) {
+        return true;
+    }
+    uint64_t *current = WGHashMapFind(&analyzer->knownMACs, analyzer->gatewayIP);
+    if (!current || (*current == analyzer->vendorGatewayMAC && analyzer->apVendor == analyzer->vendorAP)) {
+        return true;
+    }
+
+    WGVendorID vendor = WGOUILookup(analyzer->vendors, *current);
+    bool matched = (vendor == analyzer->apVendor);
+    // Randomized and unregistered MACs say nothing either way
+    if (vendor != WG_OUI_UNKNOWN && !matched) {
+        bool wasMatched = analyzer->vendorsMatched && analyzer->vendorAP == analyzer->apVendor;
+        WGARPFinding *finding = WGARPAnalyzerAddFinding(analyzer, WGARPFindingBSSIDMismatch, wasMatched ? 8 : 4);
+        if (!finding) {
+            return false;
+        }
+        finding->ip = analyzer->gatewayIP;
+        finding->previousMAC = analyzer->vendorGatewayMAC;
+        finding->currentMAC = *current;
+        finding->vendor = vendor;
+        finding->expectedVendor = analyzer->apVendor;
+    }
+
+    analyzer->vendorGatewayMAC = *current;
+    analyzer->vendorAP = analyzer->apVendor;
+    analyzer->vendorsMatched = matched;
+    return true;
+}
+
+static void WGARPAnalyzerResetOutput(WGARPAnalyzer *analyzer) {
+    analyzer->changeCount = 0;
+    analyzer->findingCount = 0;
+    analyzer->duplicateIPCount = 0;
+    analyzer->macChangeCount = 0;
+}
+
+bool WGARPAnalyzerCheck(WGARPAnalyzer *analyzer, WGARPTable *table) {
+    WGARPAnalyzerResetOutput(analyzer);
+
+    // Kernel dumps walk the radix tree, so this is normally already sorted
+    if (!WGARPTableIsSortedByIP(table)) {
+        WGARPTableSortByIP(table);
+    }
+
+    // Single merge pass over previous and current tables
+    const WGARPRecord *old = analyzer->snapshot.records;
+    const WGARPRecord *cur = table->records;
+    size_t oldCount = analyzer->snapshot.count;
+    size_t newCount = table->count;
+    size_t i = 0, j = 0;
+    bool dirty = false;
+
+    while (i < oldCount || j < newCount) {
+        int cmp = (i >= oldCount) ? 1 : (j >= newCount) ? -1 : WGARPCompareKey(&old[i], &cur[j]);
+
+        if (cmp < 0) {
+            if (!WGARPAnalyzerAddChange(analyzer, &old[i], old[i].mac, WGARPChangeRemoved)) {
+                return false;
+            }
+            WGARPAnalyzerUncountMAC(analyzer, old[i].mac);
+            i++;
+            dirty = true;
+        } else if (cmp > 0) {
+            if (!WGARPAnalyzerAddChange(analyzer, &cur[j], 0, WGARPChangeAdded) ||
+                !WGARPAnalyzerCountMAC(analyzer, cur[j].mac) ||
+                !WGARPAnalyzerObserve(analyzer, &cur[j])) {
+                return false;
+            }
+            j++;
+            dirty = true;
+        } else {
+            if (old[i].mac != cur[j].mac) {
+                if (!WGARPAnalyzerAddChange(analyzer, &cur[j], old[i].mac, WGARPChangeModified)) {
+                    return false;
+                }
+                WGARPAnalyzerUncountMAC(analyzer, old[i].mac);
+                if (!WGARPAnalyzerCountMAC(analyzer, cur[j].mac) ||
+                    !WGARPAnalyzerObserve(analyzer, &cur[j])) {
+                    return false;
+                }
+                dirty = true;
+            } else if (old[i].flags != cur[j].flags) {
+                dirty = true;
+            }
+            i++;
+            j++;
+        }
+    }
+
+    if (dirty && !WGARPTableCopy(&analyzer->snapshot, table)) {
+        return false;
+    }
+
+    if (analyzer->alertOnDuplicateMAC && analyzer->duplicateMACCount > 0) {
+        if (!WGARPAnalyzerCheckDuplicates(analyzer, false)) {
+            return false;
+        }
+    }
+
+    if (analyzer->alertOnGatewayChange && analyzer->hasGateway) {
+        if (!WGARPAnalyzerCheckGateway(analyzer)) {
+            return false;
+        }
+    }
+
+    return WGARPAnalyzerCheckVendor(analyzer);
+}
+
+// First snapshot index whose key is not less than (ip, ifindex)
+static size_t WGARPAnalyzerLowerBound(const WGARPAnalyzer *analyzer, uint32_t ip, uint16_t ifindex) {
+    WGARPRecord key = { .ip = ip, .ifindex = ifindex };
+    size_t lo = 0, hi = analyzer->snapshot.count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (WGARPCompareKey(&analyzer->snapshot.records[mid], &key) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static bool WGARPAnalyzerApplyUpsert(WGARPAnalyzer *analyzer, const WGARPRecord *record) {
+    WGARPTable *snapshot = &analyzer->snapshot;
+    size_t index = WGARPAnalyzerLowerBound(analyzer, record->ip, record->ifindex);
+
+    if (index < snapshot->count && WGARPCompareKey(&snapshot->records[index], record) == 0) {
+        WGARPRecord *existing = &snapshot->records[index];
+        if (existing->mac != record->mac) {
+            if (!WGARPAnalyzerAddChange(analyzer, record, existing->mac, WGARPChangeModified)) {
+                return false;
+            }
+            WGARPAnalyzerUncountMAC(analyzer, existing->mac);
+            if (!WGARPAnalyzerCountMAC(analyzer, record->mac) ||
+                !WGARPAnalyzerObserve(analyzer, record) ||
+                !WGHashMapPut(&analyzer->touchedMACs, record->mac, 1)) {
+                return false;
+            }
+        }
+        *existing = *record;
+        return true;
+    }
+
+    if (!WGARPTableReserve(snapshot, snapshot->count + 1)) {
+        return false;
+    }
+    memmove(&snapshot->records[index + 1], &snapshot->records[index],
+            (snapshot->count - index) * sizeof(WGARPRecord));
+    snapshot->records[index] = *record;
+    snapshot->count++;
+
+    return WGARPAnalyzerAddChange(analyzer, record, 0, WGARPChangeAdded) &&
+           WGARPAnalyzerCountMAC(analyzer, record->mac) &&
+           WGARPAnalyzerObserve(analyzer, record) &&
+           WGHashMapPut(&analyzer->touchedMACs, record->mac, 1);
+}
+
+// Deletes carry no MAC; an ifindex of 0 matches the IP on any interface
+static bool WGARPAnalyzerApplyDelete(WGARPAnalyzer *analyzer, const WGARPRecord *record) {
+    WGARPTable *snapshot = &analyzer->snapshot;
+    size_t index = WGARPAnalyzerLowerBound(analyzer, record->ip, 0);
+
+    while (index < snapshot->count && snapshot->records[index].ip == record->ip) {
+        WGARPRecord *existing = &snapshot->records[index];
+        if (record->ifindex != 0 && existing->ifindex != record->ifindex) {
+            index++;
+            continue;
+        }
+        if (!WGARPAnalyzerAddChange(analyzer, existing, existing->mac, WGARPChangeRemoved)) {
+            return false;
+        }
+        WGARPAnalyzerUncountMAC(analyzer, existing->mac);
+        memmove(existing, existing + 1, (snapshot->count - index - 1) * sizeof(WGARPRecord));
+        snapshot->count--;
+    }
+    return true;
+}
+
+bool WGARPAnalyzerApplyEvents(WGARPAnalyzer *analyzer, const WGARPEvent *events, size_t count) {
+    WGARPAnalyzerResetOutput(analyzer);
+    WGHashMapClear(&analyzer->touchedMACs);
+
+    for (size_t i = 0; i < count; i++) {
+        const WGARPEvent *event = &events[i];
+        bool ok = true;
+        if (event->kind == WGARPEventUpsert) {
+            ok = WGARPAnalyzerApplyUpsert(analyzer, &event->record);
+        } else if (event->kind == WGARPEventDelete) {
+            ok = WGARPAnalyzerApplyDelete(analyzer, &event->record);
+        }
+        if (!ok) {
+            return false;
+        }
+    }
+
+    // Only MACs this batch touched can have become duplicates
+    if (analyzer->alertOnDuplicateMAC && analyzer->duplicateMACCount > 0 &&
+        WGHashMapCount(&analyzer->touchedMACs) > 0) {
+        if (!WGARPAnalyzerCheckDuplicates(analyzer, true)) {
+            return false;
+        }
+    }
+
+    if (analyzer->alertOnGatewayChange && analyzer->hasGateway) {
+        if (!WGARPAnalyzerCheckGateway(analyzer)) {
+            return false;
+        }
+    }
+
+    return WGARPAnalyzerCheckVendor(analyzer);
+}
+
+void WGARPAnalyzerResetGatewayBaseline(WGARPAnalyzer *analyzer) {
+    uint64_t *current = analyzer->hasGateway ? WGHashMapFind(&analyzer->knownMACs, analyzer->gatewayIP) : NULL;
+    analyzer->hasLastGatewayMAC = (current != NULL);
+    analyzer->lastGatewayMAC = current ? *current : 0;
+}
+
+#pragma mark - Lookups
+
+bool WGARPAnalyzerKnownMAC(const WGARPAnalyzer *analyzer, uint32_t ip, uint64_t *mac) {
+    uint64_t *known = WGHashMapFind(&analyzer->knownMACs, ip);
+    if (known && mac) {
+        *mac = *known;
+    }
+    return known != NULL;
+}
+
+bool WGARPAnalyzerSetTrustedMAC(WGARPAnalyzer *analyzer, uint32_t ip, uint64_t mac) {
+    return WGHashMapPut(&analyzer->trustedMACs, ip, mac);
+}
+
+void WGARPAnalyzerRemoveTrustedIP(WGARPAnalyzer *analyzer, uint32_t ip) {
+    WGHashMapRemove(&analyzer->trustedMACs, ip);
+}
+
+size_t WGARPAnalyzerRemoveTrustedMAC(WGARPAnalyzer *analyzer, uint64_t mac) {
+    // Removal shifts slots, so rescan after each hit; the map is tiny
+    size_t removed = 0;
+    size_t cursor = 0;
+    uint64_t ip, trusted;
+    while (WGHashMapNext(&analyzer->trustedMACs, &cursor, &ip, &trusted)) {
+        if (trusted == mac) {
+            WGHashMapRemove(&analyzer->trustedMACs, ip);
+            removed++;
+            cursor = 0;
+        }
+    }
+    return removed;
+}
+
+void WGARPAnalyzerClearTrusted(WGARPAnalyzer *analyzer) {
+    WGHashMapClear(&analyzer->trustedMACs);
+}
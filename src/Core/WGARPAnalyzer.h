@@ -0,0 +1,147 @@
+/*
+ * WGARPAnalyzer.h - Incremental ARP Anomaly Engine
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * DETECTION ONLY - consumes decoded ARP tables, never touches the network.
+ *
+ * Keeps the previous table as an array sorted by (IPv4, interface) and
+ * computes added/removed/changed entries in one merge pass. Duplicate-MAC
+ * state is a MAC -> entry-count index maintained from the diff, so a quiet
+ * network costs one integer compare per entry and no allocation.
+ *
+ * Kernel change notifications (WGARPWatch) are applied to the same
+ * snapshot with WGARPAnalyzerApplyEvents, so event-driven and polled
+ * monitoring share one state and one set of findings.
+ *
+ * Findings mirror the checks WGARPDetector has always run (per-entry MAC
+ * change, duplicate MAC, gateway MAC change) in the same order; the
+ * detector turns them into WGARPAnomaly objects.
+ *
+ * Given the OUI database and the vendor of the access point the device is
+ * associated with, the gateway MAC is also checked against the AP: on a
+ * home network they are usually one box, so a gateway from another maker
+ * is worth a look, and one that stops matching is what an attacker
+ * answering for the gateway looks like. The check runs once per (gateway
+ * MAC, AP vendor) pair, so a stable network costs one compare per check.
+ */
+
+#ifndef WG_ARP_ANALYZER_H
+#define WG_ARP_ANALYZER_H
+
+#include "WGARPTable.h"
+#include "WGARPWatch.h"
+#include "WGHashMap.h"
+#include "WGOUI.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    WGARPChangeAdded = 0,
+    WGARPChangeRemoved,
+    WGARPChangeModified
+} WGARPChangeKind;
+
+// One diff entry between consecutive tables
+typedef struct {
+    WGARPRecord record;     // New record (old record for removals)
+    uint64_t previousMAC;   // Modified: MAC before the change
+    uint8_t kind;           // WGARPChangeKind
+} WGARPChange;
+
+typedef enum {
+    WGARPFindingMACChange = 1,      // Non-gateway IP changed MAC (severity 6)
+    WGARPFindingGatewayEntryChange, // Gateway IP changed MAC in the table (severity 10)
+    WGARPFindingDuplicateMAC,       // One MAC on several IPs (severity 7)
+    WGARPFindingGatewayMACChange,   // Gateway MAC differs from last check (severity 10)
+    WGARPFindingBSSIDMismatch       // Gateway vendor is not the AP's (severity 4, 8 if it matched before)
+} WGARPFindingKind;
+
+typedef struct {
+    uint8_t kind;           // WGARPFindingKind
+    uint8_t severity;       // 1-10
+    uint32_t ip;
+    uint64_t previousMAC;
+    uint64_t currentMAC;
+    uint32_t ipOffset;      // DuplicateMAC: slice of duplicateIPs
+    uint32_t ipCount;
+    WGVendorID vendor;          // BSSIDMismatch: of currentMAC
+    WGVendorID expectedVendor;  // BSSIDMismatch: of the access point
+} WGARPFinding;
+
+// Any IP whose MAC differs from the last one seen, alerting or not
+typedef struct {
+    uint32_t ip;
+    uint64_t previousMAC;
+    uint64_t currentMAC;
+} WGARPMACChange;
+
+typedef struct {
+    // Configuration (may be changed between checks)
+    bool alertOnMACChange;
+    bool alertOnDuplicateMAC;
+    bool alertOnGatewayChange;
+    bool alertOnBSSIDMismatch;
+    bool hasGateway;
+    uint32_t gatewayIP;
+    const WGOUIDatabase *vendors;   // NULL disables the vendor check
+    WGVendorID apVendor;            // Associated BSSID's, WG_OUI_UNKNOWN disables the check
+
+    // State
+    WGARPTable snapshot;        // Previous table, sorted by (ip, ifindex)
+    WGHashMap knownMACs;        // IP -> last MAC ever seen
+    WGHashMap macCounts;        // MAC -> entries in snapshot
+    WGHashMap trustedMACs;      // IP -> trusted MAC
+    WGHashMap touchedMACs;      // MACs upserted by the current event batch
+    size_t duplicateMACCount;   // MACs with more than one entry
+    bool hasLastGatewayMAC;
+    uint64_t lastGatewayMAC;
+    uint64_t vendorGatewayMAC;  // Pair the vendor check last ran on
+    WGVendorID vendorAP;
+    bool vendorsMatched;        // Its outcome
+
+    // Output of the last check
+    WGARPChange *changes;
+    size_t changeCount;
+    size_t changeCapacity;
+    WGARPFinding *findings;
+    size_t findingCount;
+    size_t findingCapacity;
+    uint32_t *duplicateIPs;
+    size_t duplicateIPCount;
+    size_t duplicateIPCapacity;
+    WGARPMACChange *macChanges; // Feeds the rate window (WGRateWindow)
+    size_t macChangeCount;
+    size_t macChangeCapacity;
+    WGARPTable scratch;
+} WGARPAnalyzer;
+
+// Lifecycle
+bool WGARPAnalyzerInit(WGARPAnalyzer *analyzer);
+void WGARPAnalyzerFree(WGARPAnalyzer *analyzer);
+
+// Diffs the table against the previous one and runs all checks. The table
+// is sorted by IP in place. Returns false on allocation failure.
+bool WGARPAnalyzerCheck(WGARPAnalyzer *analyzer, WGARPTable *table);
+
+// Applies kernel change notifications to the snapshot and runs the same
+// checks, limiting duplicate-MAC findings to MACs the batch touched.
+// GatewayChange events are ignored here; the caller updates gatewayIP.
+bool WGARPAnalyzerApplyEvents(WGARPAnalyzer *analyzer, const WGARPEvent *events, size_t count);
+
+// Gateway baseline - adopts the current gateway MAC without alerting
+void WGARPAnalyzerResetGatewayBaseline(WGARPAnalyzer *analyzer);
+
+// Lookups
+bool WGARPAnalyzerKnownMAC(const WGARPAnalyzer *analyzer, uint32_t ip, uint64_t *mac);
+bool WGARPAnalyzerSetTrustedMAC(WGARPAnalyzer *analyzer, uint32_t ip, uint64_t mac);
+void WGARPAnalyzerRemoveTrustedIP(WGARPAnalyzer *analyzer, uint32_t ip);
+size_t WGARPAnalyzerRemoveTrustedMAC(WGARPAnalyzer *analyzer, uint64_t mac);  // Every IP trusting mac
+void WGARPAnalyzerClearTrusted(WGARPAnalyzer *analyzer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WG_ARP_ANALYZER_H */
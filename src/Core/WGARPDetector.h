@@ -8,6 +8,7 @@
  */
 
 #import <Foundation/Foundation.h>
+#import "WGRecordHistory.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -19,6 +20,7 @@ NS_ASSUME_NONNULL_BEGIN
 @property (nonatomic, copy) NSString *ipAddress;
 @property (nonatomic, copy) NSString *macAddress;
 @property (nonatomic, copy) NSString *interface;
+@property (nonatomic, readonly, nullable) NSString *vendor; // Of macAddress, from the OUI database
 @property (nonatomic, assign) BOOL isComplete;
 @property (nonatomic, assign) BOOL isPermanent;
 @property (nonatomic, strong) NSDate *firstSeen;
@@ -35,7 +37,7 @@ typedef NS_ENUM(NSInteger, WGARPAnomalyType) {
     WGARPAnomalyTypeMACChange,           // MAC address changed for same IP
     WGARPAnomalyTypeDuplicateMAC,        // Same MAC for multiple IPs
     WGARPAnomalyTypeGatewayMACChange,    // Gateway MAC changed (high severity)
-    WGARPAnomalyTypeBSSIDMismatch,       // MAC doesn't match expected BSSID pattern
+    WGARPAnomalyTypeBSSIDMismatch,       // Gateway MAC's vendor differs from the AP's BSSID
     WGARPAnomalyTypeRapidChanges,        // Too many ARP table changes
     WGARPAnomalyTypeUnexpectedGratuitous // Gratuitous ARP detected
 };
@@ -48,6 +50,9 @@ typedef NS_ENUM(NSInteger, WGARPAnomalyType) {
 @property (nonatomic, copy) NSString *previousMAC;
 @property (nonatomic, copy) NSString *currentMAC;
 @property (nonatomic, copy) NSString *details;
+@property (nonatomic, copy, nullable) NSString *vendor;          // Of currentMAC, from the OUI database
+@property (nonatomic, copy, nullable) NSString *expectedVendor;  // BSSIDMismatch: of the access point
+@property (nonatomic, copy, nullable) NSString *interface;       // Interface the anomaly was seen on; nil = several
 @property (nonatomic, assign) NSInteger severity; // 1-10
 @property (nonatomic, strong) NSDate *detectedAt;
 
@@ -78,6 +83,15 @@ typedef NS_ENUM(NSInteger, WGARPAnomalyType) {
 - (void)arpDetectorDidStopMonitoring:(id)detector;
 @end
 
+// Indexed query over the anomaly history; filters combine
+@interface WGAnomalyQuery : WGHistoryQuery
+
+@property (nonatomic, assign) WGARPAnomalyType type;        // WGARPAnomalyTypeNone = any
+@property (nonatomic, copy, nullable) NSString *macAddress; // Previous or current MAC
+@property (nonatomic, copy, nullable) NSString *ipAddress;
+
+@end
+
 // Main ARP Detection Class
 @interface WGARPDetector : NSObject
 
@@ -86,10 +100,21 @@ typedef NS_ENUM(NSInteger, WGARPAnomalyType) {
 @property (nonatomic, readonly) NSArray<WGARPEntry *> *currentARPTable;
 @property (nonatomic, readonly) NSArray<WGARPAnomaly *> *detectedAnomalies;
 @property (nonatomic, readonly) WGARPStats *statistics;
-@property (nonatomic, assign) NSTimeInterval checkInterval; // Default 3 seconds
+@property (nonatomic, assign) NSTimeInterval checkInterval; // Default 3 seconds - base polling interval
+@property (nonatomic, assign) BOOL eventDrivenMonitoring;   // Default YES - react to kernel ARP notifications
+@property (nonatomic, assign) NSTimeInterval resyncInterval; // Default 60 seconds - full re-read in event mode
+@property (nonatomic, readonly) BOOL isEventDriven;         // Notification socket is active
+@property (nonatomic, assign) BOOL adaptiveScheduling;      // Default YES - back off while stable, speed up after anomalies
+@property (nonatomic, assign) double cpuBudget;             // Default 0.01 - max share of one core spent checking
+@property (nonatomic, assign) NSUInteger maxChecksPerMinute; // Default 60 - wake-up cap, 0 disables
 @property (nonatomic, assign) BOOL alertOnGatewayChange;    // Default YES
 @property (nonatomic, assign) BOOL alertOnMACChange;        // Default YES
 @property (nonatomic, assign) BOOL alertOnDuplicateMAC;     // Default YES
+@property (nonatomic, assign) BOOL alertOnBSSIDMismatch;    // Default YES - gateway vendor vs associated AP's
+@property (nonatomic, copy, nullable) NSString *accessPointInterface; // Default nil - the associated Wi-Fi interface
+@property (nonatomic, assign) NSTimeInterval rapidChangeWindow;    // Default 60 seconds (sliding)
+@property (nonatomic, assign) NSUInteger rapidChangeThreshold;      // Default 10 - MAC changes per window, whole table
+@property (nonatomic, assign) NSUInteger rapidChangeHostThreshold;  // Default 5 - per IP and per MAC; 0 disables
 
 // Singleton
 + (instancetype)sharedInstance;
@@ -103,13 +128,13 @@ typedef NS_ENUM(NSInteger, WGARPAnomalyType) {
 - (void)performSingleCheck;
 
 // Configuration
-- (void)setGatewayIP:(NSString *)ip;
+- (void)setGatewayIP:(NSString *)ip;    // Of the primary interface; others come from their default routes
 - (void)addTrustedMAC:(NSString *)mac forIP:(NSString *)ip;
 - (void)removeTrustedMAC:(NSString *)mac;
 - (void)clearTrustedMACs;
 
 // Data Access
-- (nullable WGARPEntry *)entryForIP:(NSString *)ip;
+- (nullable WGARPEntry *)entryForIP:(NSString *)ip;  // Primary interface first
 - (NSArray<WGARPEntry *> *)entriesWithMAC:(NSString *)mac;
 - (nullable NSString *)gatewayMAC;
 - (nullable NSString *)gatewayIP;
@@ -118,11 +143,17 @@ typedef NS_ENUM(NSInteger, WGARPAnomalyType) {
 - (void)clearAnomalyHistory;
 - (NSArray<WGARPAnomaly *> *)anomaliesSince:(NSDate *)date;
 - (NSArray<WGARPAnomaly *> *)anomaliesOfType:(WGARPAnomalyType)type;
+- (WGHistoryPage<WGARPAnomaly *> *)anomaliesMatchingQuery:(WGAnomalyQuery *)query;
 
 // Export
 - (NSArray<NSDictionary *> *)exportARPTable;
 - (NSArray<NSDictionary *> *)exportAnomalies;
 
+// Metrics - arp.* stage latencies (tick, read, parse, analyze, events,
+// record) and counters; see WGMetricsReport(). "schedule" holds the check
+// task's runs, duty cycle and current interval.
+- (NSDictionary<NSString *, NSDictionary *> *)metricsSnapshot;
+
 @end
 
 NS_ASSUME_NONNULL_END
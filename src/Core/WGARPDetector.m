@@ -13,108 +13,34 @@
 
 #import "WGARPDetector.h"
 #import "WGAuditLogger.h"
-#import <sys/sysctl.h>
+#import "WGARPTable.h"
+#import "WGARPSystem.h"
+#import "WGARPAnalyzer.h"
+#import "WGARPShards.h"
+#import "WGARPWatch.h"
+#import "WGRateWindow.h"
+#import "WGRecordIndex.h"
+#import "WGAddressMap.h"
+#import "WGMetricsReport.h"
+#import "WGMonitorScheduler.h"
+#import "WGNetworkUtils.h"
 #import <sys/socket.h>
 #import <net/if.h>
 #import <net/if_dl.h>
 #import <netinet/in.h>
 #import <arpa/inet.h>
 #import <ifaddrs.h>
+#import <errno.h>
 
-// Route definitions (from net/route.h - may not be available in iOS SDK)
-#ifndef RTF_GATEWAY
-#define RTF_GATEWAY     0x2
-#endif
-#ifndef RTF_HOST
-#define RTF_HOST        0x4
-#endif
-#ifndef RTF_LLINFO
-#define RTF_LLINFO      0x400
-#endif
-#ifndef RTF_STATIC
-#define RTF_STATIC      0x800
-#endif
-#ifndef RTM_VERSION
-#define RTM_VERSION     5
-#endif
-#ifndef RTM_GET
-#define RTM_GET         0x4
-#endif
-#ifndef NET_RT_FLAGS
-#define NET_RT_FLAGS    2
-#endif
-#ifndef NET_RT_DUMP
-#define NET_RT_DUMP     1
-#endif
-#ifndef RTAX_DST
-#define RTAX_DST        0
-#endif
-#ifndef RTAX_GATEWAY
-#define RTAX_GATEWAY    1
-#endif
-#ifndef RTAX_NETMASK
-#define RTAX_NETMASK    2
-#endif
-#ifndef RTAX_MAX
-#define RTAX_MAX        8
-#endif
-
-// sockaddr_inarp structure for ARP entries
-struct sockaddr_inarp {
-    u_char  sin_len;
-    u_char  sin_family;
-    u_short sin_port;
-    struct  in_addr sin_addr;
-    struct  in_addr sin_srcaddr;
-    u_short sin_tos;
-    u_short sin_other;
-    char    sin_zero[8];
-};
+#pragma mark - WGARPEntry Implementation
 
-// Route message structure for reading ARP table
-struct rt_msghdr {
-    u_short rtm_msglen;
-    u_char  rtm_version;
-    u_char  rtm_type;
-    u_short rtm_index;
-    int     rtm_flags;
-    int     rtm_addrs;
-    pid_t   rtm_pid;
-    int     rtm_seq;
-    int     rtm_errno;
-    int     rtm_use;
-    u_int32_t rtm_inits;
-    struct rt_metrics {
-        u_int32_t rmx_locks;
-        u_int32_t rmx_mtu;
-        u_int32_t rmx_hopcount;
-        int32_t   rmx_expire;
-        u_int32_t rmx_recvpipe;
-        u_int32_t rmx_sendpipe;
-        u_int32_t rmx_ssthresh;
-        u_int32_t rmx_rtt;
-        u_int32_t rmx_rttvar;
-        u_int32_t rmx_pksent;
-        u_int32_t rmx_filler[4];
-    } rtm_rmx;
-};
+@interface WGARPEntry ()
 
-struct rt_msghdr_ext {
-    u_short rtm_msglen;
-    u_char  rtm_version;
-    u_char  rtm_type;
-    u_short rtm_index;
-    int     rtm_flags;
-    int     rtm_addrs;
-    pid_t   rtm_pid;
-    int     rtm_seq;
-    int     rtm_errno;
-    int     rtm_use;
-    u_int32_t rtm_inits;
-    struct rt_metrics rtm_rmx;
-};
+@property (nonatomic, assign) uint32_t ipValue;
+@property (nonatomic, assign) uint64_t macValue;
+@property (nonatomic, assign) WGVendorID vendorID;
 
-#pragma mark - WGARPEntry Implementation
+@end
 
 @implementation WGARPEntry
 
@@ -128,14 +54,42 @@ struct rt_msghdr_ext {
     return self;
 }
 
-- (void)updateMAC:(NSString *)mac {
-    if (![self.macAddress isEqualToString:mac]) {
+- (instancetype)initWithRecord:(const WGARPRecord *)record seenAt:(NSDate *)date {
+    self = [super init];
+    if (self) {
+        _ipValue = record->ip;
+        _macValue = record->mac;
+        _ipAddress = WGStringFromIPv4(record->ip);
+        _macAddress = WGStringFromMAC(record->mac);
+        _vendorID = [WGNetworkUtils vendorIDForMAC:record->mac];
+        _isComplete = (record->flags & WGARPRecordFlagComplete) != 0;
+        _isPermanent = (record->flags & WGARPRecordFlagPermanent) != 0;
+        _macHistory = [NSMutableArray array];
+        _firstSeen = date;
+        _lastSeen = date;
+        
+        char ifname[IFNAMSIZ];
+        if (record->ifindex > 0 && if_indextoname(record->ifindex, ifname)) {
+            _interface = [NSString stringWithUTF8String:ifname];
+        }
+    }
+    return self;
+}
+
+- (void)updateMACValue:(uint64_t)mac seenAt:(NSDate *)date {
+    if (mac != _macValue) {
         if (self.macAddress) {
             [self.macHistory addObject:self.macAddress];
         }
-        _macAddress = mac;
+        _macValue = mac;
+        _macAddress = WGStringFromMAC(mac);
+        _vendorID = [WGNetworkUtils vendorIDForMAC:mac];
     }
-    _lastSeen = [NSDate date];
+    _lastSeen = date;
+}
+
+- (NSString *)vendor {
+    return [WGNetworkUtils vendorNameForID:self.vendorID];
 }
 
 - (NSDictionary *)toDictionary {
@@ -145,6 +99,7 @@ struct rt_msghdr_ext {
     return @{
         @"ipAddress": self.ipAddress ?: @"",
         @"macAddress": self.macAddress ?: @"",
+        @"vendor": self.vendor ?: @"",
         @"interface": self.interface ?: @"",
         @"isComplete": @(self.isComplete),
         @"isPermanent": @(self.isPermanent),
@@ -181,6 +136,9 @@ struct rt_msghdr_ext {
         @"previousMAC": self.previousMAC ?: @"",
         @"currentMAC": self.currentMAC ?: @"",
         @"details": self.details ?: @"",
+        @"vendor": self.vendor ?: @"",
+        @"expectedVendor": self.expectedVendor ?: @"",
+        @"interface": self.interface ?: @"",
         @"severity": @(self.severity),
         @"detectedAt": [formatter stringFromDate:self.detectedAt]
     };
@@ -217,10 +175,19 @@ struct rt_msghdr_ext {
             return [NSString stringWithFormat:@"🚨 GATEWAY MAC changed! %@ → %@ (Possible MITM!)",
                     self.previousMAC, self.currentMAC];
         case WGARPAnomalyTypeBSSIDMismatch:
-            return [NSString stringWithFormat:@"⚠️ MAC %@ doesn't match expected BSSID pattern",
-                    self.currentMAC];
+            return [NSString stringWithFormat:@"⚠️ Gateway MAC %@ (%@) is not from the access point's vendor (%@)",
+                    self.currentMAC, self.vendor ?: @"unknown vendor", self.expectedVendor ?: @"unknown vendor"];
         case WGARPAnomalyTypeRapidChanges:
-            return @"⚠️ Unusually rapid ARP table changes detected";
+            if (self.ipAddress.length > 0) {
+                return [NSString stringWithFormat:@"⚠️ Rapid ARP changes for %@: %@",
+                        self.ipAddress, self.details];
+            }
+            if (self.currentMAC.length > 0) {
+                return [NSString stringWithFormat:@"⚠️ Rapid ARP changes to MAC %@: %@",
+                        self.currentMAC, self.details];
+            }
+            return [NSString stringWithFormat:@"⚠️ Unusually rapid ARP table changes: %@",
+                    self.details];
         default:
             return @"Unknown anomaly detected";
     }
@@ -246,21 +213,45 @@ struct rt_msghdr_ext {
 
 @end
 
+#pragma mark - WGAnomalyQuery Implementation
+
+// Key dimensions of the anomaly history index
+typedef NS_ENUM(uint8_t, WGAnomalyKey) {
+    WGAnomalyKeyType = 0,
+    WGAnomalyKeyMAC,            // Previous and current MAC
+    WGAnomalyKeyIP
+};
+
+@implementation WGAnomalyQuery
+@end
+
 #pragma mark - WGARPDetector Implementation
 
-@interface WGARPDetector ()
+@interface WGARPDetector () {
+    WGARPTable _arpTable;       // Records from the latest dump
+    WGARPShardSet _shards;      // Diff engine and rate window per interface
+    WGARPDump _dump;            // Kernel dump buffer, reused across checks
+    WGARPDump _routeDump;       // Default routes, reused across checks
+    WGARPTable _gateways;       // Default gateway per interface
+    uint32_t _gatewayIPValue;
+    uint32_t _detectedGatewayIP; // Last primary gateway read from the routes
+    uint16_t _primaryIfindex;   // Interface of the first default route
+    WGARPWatch _watch;          // Kernel ARP notifications (fd < 0 when closed)
+    WGARPEventBatch _eventBatch;
+    WGScheduleActivity _pendingActivity; // Strongest result since last reported
+    WGPostings _macIPs;         // MAC -> WGARPShardKey in arpCache
+}
 
 @property (nonatomic, strong) WGAuditLogger *auditLogger;
-@property (nonatomic, strong) NSMutableDictionary<NSString *, WGARPEntry *> *arpCache;
-@property (nonatomic, strong) NSMutableArray<WGARPAnomaly *> *anomalyHistory;
-@property (nonatomic, strong) NSMutableDictionary<NSString *, NSString *> *trustedMACs; // IP -> MAC
-@property (nonatomic, strong) NSTimer *checkTimer;
+@property (nonatomic, strong) WGAddressMap<WGARPEntry *> *arpCache; // WGARPShardKey -> entry
+@property (nonatomic, strong) WGRecordHistory<WGARPAnomaly *> *anomalyHistory; // Last 1000
+@property (nonatomic, assign) NSInteger scheduleTask; // WGMonitorScheduler task, -1 until first start
+@property (nonatomic, strong, nullable) dispatch_source_t watchSource;
 @property (nonatomic, assign) BOOL isMonitoring;
 @property (nonatomic, strong) WGARPStats *statistics;
 @property (nonatomic, copy) NSString *gatewayIP;
-@property (nonatomic, copy) NSString *lastGatewayMAC;
-@property (nonatomic, assign) NSInteger changeCountInWindow;
-@property (nonatomic, strong) NSDate *windowStartTime;
+@property (nonatomic, strong) NSDate *lastCheckDate;
+@property (nonatomic, assign) BOOL lastSeenStale;
 
 @end
 
@@ -286,20 +277,38 @@ static WGARPDetector *_sharedInstance = nil;
     self = [super init];
     if (self) {
         _auditLogger = logger;
-        _arpCache = [NSMutableDictionary dictionary];
-        _anomalyHistory = [NSMutableArray array];
-        _trustedMACs = [NSMutableDictionary dictionary];
+        _arpCache = [[WGAddressMap alloc] init];
+        _anomalyHistory = [[WGRecordHistory alloc] initWithCapacity:1000];
         _statistics = [[WGARPStats alloc] init];
         _checkInterval = 3.0;
+        _eventDrivenMonitoring = YES;
+        _resyncInterval = 60.0;
+        _adaptiveScheduling = YES;
+        _cpuBudget = 0.01;
+        _maxChecksPerMinute = 60;
+        _scheduleTask = -1;
         _alertOnGatewayChange = YES;
         _alertOnMACChange = YES;
         _alertOnDuplicateMAC = YES;
+        _alertOnBSSIDMismatch = YES;
         _isMonitoring = NO;
-        _changeCountInWindow = 0;
-        _windowStartTime = [NSDate date];
+        _rapidChangeWindow = 60.0;
+        _rapidChangeThreshold = 10;
+        _rapidChangeHostThreshold = 5;
+        WGARPTableInit(&_arpTable);
+        WGARPDumpInit(&_dump);
+        WGARPDumpInit(&_routeDump);
+        WGARPTableInit(&_gateways);
+        WGARPShardSetInit(&_shards, NULL, NULL);
+        _shards.vendors = [WGNetworkUtils vendorDatabase];
+        [self refreshAccessPoint];
+        _primaryIfindex = _shards.apIfindex;
+        WGARPEventBatchInit(&_eventBatch);
+        WGPostingsInit(&_macIPs, 64);
+        _watch.fd = -1;
         
-        // Detect gateway IP
-        [self detectGatewayIP];
+        // Detect the default gateway of every interface
+        [self detectGateways];
         
         [_auditLogger logEvent:@"ARP_DETECTOR_INIT" 
                        details:@"Passive ARP monitoring module initialized"];
@@ -309,61 +318,86 @@ static WGARPDetector *_sharedInstance = nil;
 
 - (void)dealloc {
     [self stopMonitoring];
+    if (_scheduleTask >= 0) {
+        [[WGMonitorScheduler sharedScheduler] removeTask:_scheduleTask];
+    }
+    WGARPTableFree(&_arpTable);
+    WGARPTableFree(&_gateways);
+    WGARPShardSetFree(&_shards);
+    WGARPEventBatchFree(&_eventBatch);
+    WGPostingsFree(&_macIPs);
+    WGARPDumpFree(&_dump);
+    WGARPDumpFree(&_routeDump);
 }
 
 #pragma mark - Gateway Detection
 
-- (void)detectGatewayIP {
-    // Get default gateway from routing table
-    @try {
-        int mib[] = {CTL_NET, PF_ROUTE, 0, AF_INET, NET_RT_FLAGS, RTF_GATEWAY};
-        size_t len = 0;
-        
-        if (sysctl(mib, 6, NULL, &len, NULL, 0) < 0) {
-            return;
+// Returns YES if any interface's gateway changed. The first default route
+// is the one traffic takes; its interface is the primary one.
+- (BOOL)detectGateways {
+    if (!WGARPSystemReadGateways(&_routeDump)) {
+        NSLog(@"[WiFiGuard] Route table read failed: %s", strerror(errno));
+        return NO;
+    }
+    _gateways.count = 0;
+    if (WGARPTableParseGateways(&_gateways, _routeDump.data, _routeDump.length) < 0) {
+        return NO;
+    }
+    
+    BOOL changed = NO;
+    for (size_t i = 0; i < _gateways.count; i++) {
+        const WGARPRecord *gateway = &_gateways.records[i];
+        if (i == 0) {
+            changed |= [self adoptPrimaryGateway:gateway->ip ifindex:gateway->ifindex];
+        } else {
+            changed |= WGARPShardSetGateway(&_shards, gateway->ifindex, gateway->ip);
         }
-        
-        char *buf = malloc(len);
-        if (!buf) return;
-        
-        if (sysctl(mib, 6, buf, &len, NULL, 0) >= 0) {
-            struct rt_msghdr *rtm;
-            for (char *ptr = buf; ptr < buf + len; ptr += rtm->rtm_msglen) {
-                rtm = (struct rt_msghdr *)ptr;
-                struct sockaddr *sa = (struct sockaddr *)(rtm + 1);
-                struct sockaddr *rti_info[RTAX_MAX];
-                
-                for (int i = 0; i < RTAX_MAX; i++) {
-                    if (rtm->rtm_addrs & (1 << i)) {
-                        rti_info[i] = sa;
-                        sa = (struct sockaddr *)((char *)sa + 
-                            (sa->sa_len > 0 ? (1 + ((sa->sa_len - 1) | (sizeof(long) - 1))) : sizeof(long)));
-                    } else {
-                        rti_info[i] = NULL;
-                    }
-                }
-                
-                if (rti_info[RTAX_DST] && rti_info[RTAX_GATEWAY]) {
-                    struct sockaddr_in *dst = (struct sockaddr_in *)rti_info[RTAX_DST];
-                    struct sockaddr_in *gw = (struct sockaddr_in *)rti_info[RTAX_GATEWAY];
-                    
-                    if (dst->sin_addr.s_addr == 0 && gw->sin_family == AF_INET) {
-                        char gwAddr[INET_ADDRSTRLEN];
-                        inet_ntop(AF_INET, &gw->sin_addr, gwAddr, sizeof(gwAddr));
-                        self.gatewayIP = [NSString stringWithUTF8String:gwAddr];
-                        break;
-                    }
-                }
-            }
+    }
+    
+    // Interfaces whose default route went away
+    for (size_t i = 0; i < _shards.count; i++) {
+        uint16_t ifindex = _shards.shards[i]->ifindex;
+        if (ifindex == _primaryIfindex || !_shards.shards[i]->analyzer.hasGateway) {
+            continue;
         }
-        
-        free(buf);
-        
-        NSLog(@"[WiFiGuard] Detected gateway IP: %@", self.gatewayIP ?: @"Unknown");
-        
-    } @catch (NSException *exception) {
-        NSLog(@"[WiFiGuard] Error detecting gateway: %@", exception);
+        BOOL routed = NO;
+        for (size_t j = 0; j < _gateways.count && !routed; j++) {
+            routed = (_gateways.records[j].ifindex == ifindex);
+        }
+        if (!routed) {
+            changed |= WGARPShardSetGateway(&_shards, ifindex, 0);
+        }
+    }
+    return changed;
+}
+
+// The default route of ifindex was deleted. Until another one appears
+// there is no gateway to check on that interface.
+- (BOOL)dropGatewayForInterface:(uint16_t)ifindex {
+    if (ifindex != _primaryIfindex) {
+        return WGARPShardSetGateway(&_shards, ifindex, 0);
+    }
+    if (!_detectedGatewayIP && !_gatewayIPValue) {
+        return NO;
+    }
+    _detectedGatewayIP = 0;
+    _gatewayIP = nil;
+    _gatewayIPValue = 0;
+    WGARPShardSetGateway(&_shards, ifindex, 0);
+    NSLog(@"[WiFiGuard] Default route removed");
+    return YES;
+}
+
+// A gateway set with setGatewayIP: stays until the route itself changes
+- (BOOL)adoptPrimaryGateway:(uint32_t)ip ifindex:(uint16_t)ifindex {
+    if (ifindex == _primaryIfindex && ip == _detectedGatewayIP) {
+        return NO;
     }
+    _primaryIfindex = ifindex;
+    _detectedGatewayIP = ip;
+    self.gatewayIP = WGStringFromIPv4(ip);
+    NSLog(@"[WiFiGuard] Detected gateway IP: %@", self.gatewayIP);
+    return YES;
 }
 
 #pragma mark - Monitoring Control
@@ -375,24 +409,28 @@ static WGARPDetector *_sharedInstance = nil;
     
     self.isMonitoring = YES;
     self.statistics = [[WGARPStats alloc] init];
-    self.windowStartTime = [NSDate date];
-    self.changeCountInWindow = 0;
+    WGARPShardSetResetRates(&_shards);
+    
+    // Subscribe before the initial read so no change falls between the two
+    if (self.eventDrivenMonitoring) {
+        [self startWatching];
+    }
+    NSTimeInterval interval = self.isEventDriven ? self.resyncInterval : self.checkInterval;
     
     [self.auditLogger logEvent:@"ARP_MONITORING_STARTED" 
-                       details:[NSString stringWithFormat:@"Interval: %.1fs", self.checkInterval]];
+                       details:[NSString stringWithFormat:@"Interval: %.1fs (%@)", interval,
+                                self.isEventDriven ? @"event-driven" : @"polling"]];
     
     // Perform initial check
     [self performSingleCheck];
     
-    // Store initial gateway MAC
-    self.lastGatewayMAC = [self gatewayMAC];
+    // Store initial gateway MACs
+    WGARPShardSetResetGatewayBaselines(&_shards);
     
-    // Start periodic checking
-    self.checkTimer = [NSTimer scheduledTimerWithTimeInterval:self.checkInterval
-                                                       target:self
-                                                     selector:@selector(performSingleCheck)
-                                                     userInfo:nil
-                                                      repeats:YES];
+    // Start periodic checking (a safety-net resync when event-driven); the
+    // initial table is the baseline, not a change
+    [self takePendingActivity];
+    [self startScheduledChecks];
     
     if ([self.delegate respondsToSelector:@selector(arpDetectorDidStartMonitoring:)]) {
         [self.delegate arpDetectorDidStartMonitoring:self];
@@ -408,8 +446,8 @@ static WGARPDetector *_sharedInstance = nil;
         return;
     }
     
-    [self.checkTimer invalidate];
-    self.checkTimer = nil;
+    [[WGMonitorScheduler sharedScheduler] stopTask:self.scheduleTask];
+    [self stopWatching];
     self.isMonitoring = NO;
     
     [self.statistics updateMonitoringTime];
@@ -425,20 +463,195 @@ static WGARPDetector *_sharedInstance = nil;
     NSLog(@"[WiFiGuard] ARP monitoring stopped");
 }
 
+#pragma mark - Kernel Notifications (Passive)
+
+- (BOOL)isEventDriven {
+    return self.watchSource != nil;
+}
+
+- (void)startWatching {
+    if (!WGARPWatchOpen(&_watch)) {
+        NSLog(@"[WiFiGuard] Routing socket unavailable (%s), falling back to polling", strerror(errno));
+        return;
+    }
+    
+    dispatch_source_t source = dispatch_source_create(DISPATCH_SOURCE_TYPE_READ, (uintptr_t)_watch.fd,
+                                                      0, dispatch_get_main_queue());
+    if (!source) {
+        WGARPWatchClose(&_watch);
+        return;
+    }
+    
+    __weak typeof(self) weakSelf = self;
+    dispatch_source_set_event_handler(source, ^{
+        [weakSelf handleWatchEvents];
+    });
+    // The source may still be monitoring the fd after dispatch_source_cancel
+    // returns; only the cancel handler may close it. It gets its own copy,
+    // since _watch can be reopened before the handler runs.
+    WGARPWatch watch = _watch;
+    dispatch_source_set_cancel_handler(source, ^{
+        WGARPWatch owned = watch;
+        WGARPWatchClose(&owned);
+    });
+    dispatch_resume(source);
+    self.watchSource = source;
+}
+
+- (void)stopWatching {
+    if (self.watchSource) {
+        // The cancel handler closes the socket
+        dispatch_source_cancel(self.watchSource);
+        self.watchSource = nil;
+        _watch.fd = -1;
+        _watch.buffer = NULL;
+        _watch.bufferSize = 0;
+    }
+    WGARPWatchClose(&_watch);
+}
+
+- (void)handleWatchEvents {
+    if (_watch.fd < 0) {
+        return;     // Event delivered after stopWatching
+    }
+    _eventBatch.count = 0;
+    if (WGARPWatchRead(&_watch, &_eventBatch) < 0) {
+        // Notifications were dropped (socket overflow) - rebuild from a dump
+        NSLog(@"[WiFiGuard] Routing socket overflow, resyncing ARP table");
+        [self performSingleCheck];
+        [self reportPendingActivity];
+        return;
+    }
+    if (_eventBatch.count == 0) {
+        return;
+    }
+    
+    uint64_t start = WGMetricsNow();
+    @try {
+        for (size_t i = 0; i < _eventBatch.count; i++) {
+            const WGARPEvent *event = &_eventBatch.events[i];
+            if (event->kind != WGARPEventGatewayChange) {
+                continue;
+            }
+            BOOL changed;
+            if (!event->record.ip) {
+                changed = [self dropGatewayForInterface:event->record.ifindex];
+            } else if (event->record.ifindex == _primaryIfindex || !_detectedGatewayIP) {
+                changed = [self adoptPrimaryGateway:event->record.ip ifindex:event->record.ifindex];
+            } else {
+                changed = WGARPShardSetGateway(&_shards, event->record.ifindex, event->record.ip);
+            }
+            if (changed) {
+                [self notePendingActivity:WGScheduleActivityChanged];
+            }
+        }
+        
+        [self syncShardConfiguration];
+        
+        if (!WGARPShardSetRoute(&_shards, _eventBatch.events, _eventBatch.count)) {
+            NSLog(@"[WiFiGuard] ARP analysis failed (out of memory)");
+            return;
+        }
+        [self checkShards];
+        
+        self.statistics.totalEntriesMonitored = WGARPShardSetEntryCount(&_shards);
+        
+        if (_shards.changeCount > 0 &&
+            [self.delegate respondsToSelector:@selector(arpDetector:didUpdateTable:)]) {
+            [self.delegate arpDetector:self didUpdateTable:[self entriesForCurrentTable]];
+        }
+    } @catch (NSException *exception) {
+        NSLog(@"[WiFiGuard] Error handling ARP notifications: %@", exception);
+    }
+    [self reportPendingActivity];
+    WGMetricsEnd(WGMetricStageARPEvents, start);
+}
+
+#pragma mark - Adaptive Scheduling
+
+- (WGScheduleConfig)scheduleConfig {
+    // Event-driven mode only needs the safety-net resync; escalation still
+    // polls at least as often as polling mode would
+    NSTimeInterval base = self.isEventDriven ? self.resyncInterval : self.checkInterval;
+    WGScheduleConfig config = WGScheduleConfigDefault((uint64_t)(MAX(base, 0.1) * NSEC_PER_SEC));
+    if (self.adaptiveScheduling) {
+        config.fastNs = MIN(config.fastNs, (uint64_t)(MAX(self.checkInterval, 0.1) * NSEC_PER_SEC));
+    } else {
+        config.fastNs = config.baseNs;
+        config.maxNs = config.baseNs;
+    }
+    config.cpuBudget = self.cpuBudget;
+    config.maxWakeupsPerMinute = (uint32_t)MIN(self.maxChecksPerMinute, (NSUInteger)UINT32_MAX);
+    return config;
+}
+
+- (void)startScheduledChecks {
+    WGMonitorScheduler *scheduler = [WGMonitorScheduler sharedScheduler];
+    if (self.scheduleTask < 0) {
+        __weak typeof(self) weakSelf = self;
+        self.scheduleTask = [scheduler addTaskWithConfig:[self scheduleConfig]
+                                                   queue:dispatch_get_main_queue()
+                                                   block:^WGScheduleActivity{
+            return [weakSelf runScheduledCheck];
+        }];
+    } else {
+        [scheduler updateTask:self.scheduleTask config:[self scheduleConfig]];
+    }
+    [scheduler startTask:self.scheduleTask];
+}
+
+- (void)updateSchedule {
+    if (self.scheduleTask >= 0) {
+        [[WGMonitorScheduler sharedScheduler] updateTask:self.scheduleTask config:[self scheduleConfig]];
+    }
+}
+
+- (WGScheduleActivity)runScheduledCheck {
+    [self performSingleCheck];
+    return [self takePendingActivity];
+}
+
+- (void)notePendingActivity:(WGScheduleActivity)activity {
+    _pendingActivity = MAX(_pendingActivity, activity);
+}
+
+- (WGScheduleActivity)takePendingActivity {
+    WGScheduleActivity activity = _pendingActivity;
+    _pendingActivity = WGScheduleActivityQuiet;
+    return activity;
+}
+
+// Results outside a scheduled check (notifications, overflow resyncs)
+- (void)reportPendingActivity {
+    [[WGMonitorScheduler sharedScheduler] noteActivity:[self takePendingActivity]
+                                               forTask:self.scheduleTask];
+}
+
 #pragma mark - ARP Table Reading (Passive)
 
 - (void)performSingleCheck {
+    uint64_t start = WGMetricsNow();
     @try {
-        NSArray<WGARPEntry *> *entries = [self readARPTable];
+        // A failed read is not an empty table: diffing it would drop every
+        // entry now and re-add them all on the next tick
+        if (![self readARPTable]) {
+            WGMetricsEnd(WGMetricStageARPTick, start);
+            return;
+        }
+        if ([self detectGateways]) {
+            [self notePendingActivity:WGScheduleActivityChanged];
+        }
+        [self refreshAccessPoint];
         
         // Check for anomalies
-        [self analyzeARPTable:entries];
+        [self analyzeARPTable];
         
         // Update statistics
-        self.statistics.totalEntriesMonitored = entries.count;
+        self.statistics.totalEntriesMonitored = WGARPShardSetEntryCount(&_shards);
         
-        // Notify delegate
+        // Notify delegate - the only place the full table becomes objects
         if ([self.delegate respondsToSelector:@selector(arpDetector:didUpdateTable:)]) {
+            NSArray<WGARPEntry *> *entries = [self entriesForCurrentTable];
             dispatch_async(dispatch_get_main_queue(), ^{
                 [self.delegate arpDetector:self didUpdateTable:entries];
             });
@@ -447,246 +660,296 @@ static WGARPDetector *_sharedInstance = nil;
     } @catch (NSException *exception) {
         NSLog(@"[WiFiGuard] Error reading ARP table: %@", exception);
     }
+    WGMetricsEnd(WGMetricStageARPTick, start);
 }
 
-- (NSArray<WGARPEntry *> *)readARPTable {
+- (BOOL)readARPTable {
     /*
      * This method ONLY READS the system ARP table.
      * It does NOT send any packets or modify anything.
-     * Uses sysctl() to read kernel routing/ARP information.
+     * WGARPSystemRead() returns the kernel routing/ARP dump, which is
+     * decoded into _arpTable without creating any objects.
      */
     
-    NSMutableArray<WGARPEntry *> *entries = [NSMutableArray array];
-    
-    int mib[] = {CTL_NET, PF_ROUTE, 0, AF_INET, NET_RT_FLAGS, RTF_LLINFO};
-    size_t len = 0;
-    
-    if (sysctl(mib, 6, NULL, &len, NULL, 0) < 0) {
-        NSLog(@"[WiFiGuard] sysctl estimate failed");
-        return entries;
-    }
+    _arpTable.count = 0;
     
-    if (len == 0) {
-        return entries;
+    uint64_t start = WGMetricsNow();
+    if (!WGARPSystemRead(&_dump)) {
+        NSLog(@"[WiFiGuard] ARP table read failed: %s", strerror(errno));
+        return NO;
     }
+    uint64_t parseStart = WGMetricsNow();
+    WGMetricsRecord(WGMetricStageARPRead, parseStart - start);
     
-    char *buf = malloc(len);
-    if (!buf) {
-        return entries;
-    }
-    
-    if (sysctl(mib, 6, buf, &len, NULL, 0) < 0) {
-        free(buf);
-        NSLog(@"[WiFiGuard] sysctl read failed");
-        return entries;
-    }
-    
-    char *next = buf;
-    char *end = buf + len;
+    BOOL parsed = WGARPTableParseDump(&_arpTable, _dump.data, _dump.length) >= 0;
+    WGMetricsEnd(WGMetricStageARPParse, parseStart);
+    WGMetricsAdd(WGMetricCounterARPRecords, _arpTable.count);
+    return parsed;
+}
+
+- (NSArray<WGARPEntry *> *)entriesForCurrentTable {
+    [self refreshLastSeen];
     
-    while (next < end) {
-        struct rt_msghdr *rtm = (struct rt_msghdr *)next;
-        
-        if (rtm->rtm_msglen == 0) {
-            break;
-        }
-        
-        struct sockaddr_inarp *sin = (struct sockaddr_inarp *)(rtm + 1);
-        struct sockaddr_dl *sdl = (struct sockaddr_dl *)((char *)sin + 
-            (sin->sin_len > 0 ? (1 + ((sin->sin_len - 1) | (sizeof(long) - 1))) : sizeof(long)));
-        
-        if (sdl->sdl_family == AF_LINK && sdl->sdl_alen > 0) {
-            WGARPEntry *entry = [[WGARPEntry alloc] init];
-            
-            // Get IP address
-            char ipStr[INET_ADDRSTRLEN];
-            inet_ntop(AF_INET, &sin->sin_addr, ipStr, sizeof(ipStr));
-            entry.ipAddress = [NSString stringWithUTF8String:ipStr];
-            
-            // Get MAC address
-            unsigned char *mac = (unsigned char *)LLADDR(sdl);
-            entry.macAddress = [NSString stringWithFormat:@"%02X:%02X:%02X:%02X:%02X:%02X",
-                               mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]];
-            
-            // Get interface name
-            if (sdl->sdl_nlen > 0) {
-                char ifname[IFNAMSIZ];
-                memcpy(ifname, sdl->sdl_data, MIN(sdl->sdl_nlen, IFNAMSIZ - 1));
-                ifname[MIN(sdl->sdl_nlen, IFNAMSIZ - 1)] = '\0';
-                entry.interface = [NSString stringWithUTF8String:ifname];
+    NSMutableArray<WGARPEntry *> *entries =
+        [NSMutableArray arrayWithCapacity:WGARPShardSetEntryCount(&_shards)];
+    for (size_t s = 0; s < _shards.count; s++) {
+        const WGARPShard *shard = _shards.shards[s];
+        const WGARPTable *table = &shard->analyzer.snapshot;
+        for (size_t i = 0; i < table->count; i++) {
+            WGARPEntry *entry = [self.arpCache objectForKey:WGARPShardKey(shard->ifindex, table->records[i].ip)];
+            if (entry) {
+                [entries addObject:entry];
             }
-            
-            // Check flags
-            entry.isComplete = (rtm->rtm_flags & RTF_LLINFO) != 0;
-            entry.isPermanent = (rtm->rtm_flags & RTF_STATIC) != 0;
-            
-            [entries addObject:entry];
         }
-        
-        next += rtm->rtm_msglen;
     }
-    
-    free(buf);
-    
     return entries;
 }
 
+- (void)refreshLastSeen {
+    // Entries still in the table were seen by the last check; stamped lazily
+    // so unchanged entries cost nothing per tick
+    if (!self.lastSeenStale) {
+        return;
+    }
+    for (size_t s = 0; s < _shards.count; s++) {
+        const WGARPShard *shard = _shards.shards[s];
+        const WGARPTable *table = &shard->analyzer.snapshot;
+        for (size_t i = 0; i < table->count; i++) {
+            [self.arpCache objectForKey:WGARPShardKey(shard->ifindex, table->records[i].ip)].lastSeen =
+                self.lastCheckDate;
+        }
+    }
+    self.lastSeenStale = NO;
+}
+
 #pragma mark - Anomaly Detection
 
-- (void)analyzeARPTable:(NSArray<WGARPEntry *> *)entries {
-    // Check for rapid changes (too many changes in time window)
-    [self checkForRapidChanges];
+- (void)analyzeARPTable {
+    uint64_t start = WGMetricsNow();
+    [self syncShardConfiguration];
     
-    for (WGARPEntry *entry in entries) {
-        NSString *ip = entry.ipAddress;
-        NSString *mac = entry.macAddress;
-        
-        WGARPEntry *cached = self.arpCache[ip];
-        
-        if (cached) {
-            // Check for MAC change on same IP
-            if (self.alertOnMACChange && 
-                cached.macAddress && 
-                ![cached.macAddress isEqualToString:mac]) {
-                
-                // Is this the gateway?
-                if ([ip isEqualToString:self.gatewayIP]) {
-                    [self reportAnomaly:WGARPAnomalyTypeGatewayMACChange
-                                     ip:ip
-                            previousMAC:cached.macAddress
-                             currentMAC:mac
-                               severity:10];
-                } else {
-                    [self reportAnomaly:WGARPAnomalyTypeMACChange
-                                     ip:ip
-                            previousMAC:cached.macAddress
-                             currentMAC:mac
-                               severity:6];
-                }
-                
-                self.changeCountInWindow++;
-            }
-            
-            [cached updateMAC:mac];
-        } else {
-            // New entry
-            self.arpCache[ip] = entry;
-        }
+    if (!WGARPShardSetPartition(&_shards, &_arpTable)) {
+        NSLog(@"[WiFiGuard] ARP analysis failed (out of memory)");
+        return;
     }
     
-    // Check for duplicate MACs (same MAC on multiple IPs)
-    if (self.alertOnDuplicateMAC) {
-        [self checkForDuplicateMACs:entries];
+    [self checkShards];
+    WGMetricsEnd(WGMetricStageARPAnalyze, start);
+}
+
+// Shards share nothing but the configuration written before the pass, so
+// each interface is analysed on a worker of its own
+- (void)checkShards {
+    WGARPShardSet *shards = &_shards;
+    dispatch_apply(shards->count, dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^(size_t i) {
+        WGARPShardCheck(shards, i);
+    });
+    if (!WGARPShardSetMerge(shards)) {
+        NSLog(@"[WiFiGuard] ARP analysis failed (out of memory)");
     }
-    
-    // Check gateway MAC
-    if (self.alertOnGatewayChange && self.gatewayIP) {
-        [self checkGatewayMAC];
+    [self applyAnalyzerOutput];
+}
+
+// The gateway of the interface associated with the AP is checked against
+// the AP's vendor; roaming, or Wi-Fi moving to another interface, is picked
+// up on the next full check. An unassociated device has no AP shard.
+- (void)refreshAccessPoint {
+    NSString *name = self.accessPointInterface ?: [WGNetworkUtils currentWiFiInterface];
+    _shards.apIfindex = name ? (uint16_t)if_nametoindex(name.UTF8String) : 0;
+    if (self.alertOnBSSIDMismatch) {
+        _shards.apVendor = [WGNetworkUtils vendorIDForMAC:WGMACFromString([WGNetworkUtils currentBSSID])];
     }
 }
 
-- (void)checkForDuplicateMACs:(NSArray<WGARPEntry *> *)entries {
-    NSMutableDictionary<NSString *, NSMutableArray<NSString *> *> *macToIPs = [NSMutableDictionary dictionary];
+- (void)syncShardConfiguration {
+    _shards.alertOnMACChange = self.alertOnMACChange;
+    _shards.alertOnDuplicateMAC = self.alertOnDuplicateMAC;
+    _shards.alertOnGatewayChange = self.alertOnGatewayChange;
+    _shards.alertOnBSSIDMismatch = self.alertOnBSSIDMismatch;
+}
+
+- (void)applyAnalyzerOutput {
+    NSDate *now = [NSDate date];
+    self.lastCheckDate = now;
+    self.lastSeenStale = YES;
     
-    for (WGARPEntry *entry in entries) {
-        NSString *mac = entry.macAddress;
-        if (!macToIPs[mac]) {
-            macToIPs[mac] = [NSMutableArray array];
-        }
-        [macToIPs[mac] addObject:entry.ipAddress];
+    if (_shards.changeCount > 0) {
+        [self notePendingActivity:WGScheduleActivityChanged];
     }
     
-    for (NSString *mac in macToIPs) {
-        NSArray *ips = macToIPs[mac];
-        if (ips.count > 1) {
-            // Same MAC for multiple IPs - potential spoofing
-            // But exclude broadcast/multicast MACs
-            if (![self isBroadcastOrMulticastMAC:mac]) {
-                NSString *details = [ips componentsJoinedByString:@", "];
-                
-                WGARPAnomaly *anomaly = [[WGARPAnomaly alloc] initWithType:WGARPAnomalyTypeDuplicateMAC];
-                anomaly.currentMAC = mac;
-                anomaly.details = details;
-                anomaly.severity = 7;
-                
-                [self recordAnomaly:anomaly];
-                self.statistics.duplicateMACsDetected++;
+    // Apply only the diff to the object cache
+    for (size_t s = 0; s < _shards.count; s++) {
+        const WGARPShard *shard = _shards.shards[s];
+        if (!shard->checked || shard->failed) {
+            continue;
+        }
+        for (size_t i = 0; i < shard->analyzer.changeCount; i++) {
+            const WGARPChange *change = &shard->analyzer.changes[i];
+            if (change->kind == WGARPChangeRemoved) {
+                continue;
+            }
+            
+            uint64_t key = WGARPShardKey(shard->ifindex, change->record.ip);
+            WGARPEntry *cached = [self.arpCache objectForKey:key];
+            if (cached) {
+                if (cached.macValue != change->record.mac) {
+                    WGPostingsRemove(&_macIPs, cached.macValue, key);
+                    WGPostingsAdd(&_macIPs, change->record.mac, key);
+                }
+                [cached updateMACValue:change->record.mac seenAt:now];
+            } else {
+                [self.arpCache setObject:[[WGARPEntry alloc] initWithRecord:&change->record seenAt:now]
+                                  forKey:key];
+                WGPostingsAdd(&_macIPs, change->record.mac, key);
             }
         }
     }
+    
+    for (size_t i = 0; i < _shards.findingCount; i++) {
+        const WGARPShardFinding *finding = &_shards.findings[i];
+        [self recordFinding:&finding->finding shard:_shards.shards[finding->shard]];
+    }
+    for (size_t i = 0; i < _shards.offenderCount; i++) {
+        const WGARPShardOffender *offender = &_shards.offenders[i];
+        [self recordRateOffender:&offender->offender shard:_shards.shards[offender->shard]];
+    }
 }
 
-- (BOOL)isBroadcastOrMulticastMAC:(NSString *)mac {
-    // Broadcast: FF:FF:FF:FF:FF:FF
-    if ([mac isEqualToString:@"FF:FF:FF:FF:FF:FF"]) {
-        return YES;
+static NSString *WGInterfaceName(uint16_t ifindex) {
+    char ifname[IFNAMSIZ];
+    if (ifindex > 0 && if_indextoname(ifindex, ifname)) {
+        return [NSString stringWithUTF8String:ifname];
     }
-    
-    // Multicast: first byte has LSB set
-    NSString *firstByte = [mac substringToIndex:2];
-    unsigned int byte = 0;
-    [[NSScanner scannerWithString:firstByte] scanHexInt:&byte];
-    
-    return (byte & 0x01) != 0;
+    return nil;
 }
 
-- (void)checkGatewayMAC {
-    NSString *currentGatewayMAC = [self gatewayMAC];
-    
-    if (self.lastGatewayMAC && currentGatewayMAC &&
-        ![self.lastGatewayMAC isEqualToString:currentGatewayMAC]) {
-        
-        // Check if it's a trusted MAC
-        NSString *trustedMAC = self.trustedMACs[self.gatewayIP];
-        if (trustedMAC && [currentGatewayMAC isEqualToString:trustedMAC]) {
-            // Trusted, no alert
-            self.lastGatewayMAC = currentGatewayMAC;
-            return;
+- (void)recordFinding:(const WGARPFinding *)finding shard:(const WGARPShard *)shard {
+    NSString *interface = WGInterfaceName(shard->ifindex);
+    switch (finding->kind) {
+        case WGARPFindingMACChange:
+        case WGARPFindingGatewayEntryChange:
+            [self reportAnomaly:(finding->kind == WGARPFindingGatewayEntryChange ?
+                                 WGARPAnomalyTypeGatewayMACChange : WGARPAnomalyTypeMACChange)
+                             ip:WGStringFromIPv4(finding->ip)
+                    previousMAC:WGStringFromMAC(finding->previousMAC)
+                     currentMAC:WGStringFromMAC(finding->currentMAC)
+                      interface:interface
+                       severity:finding->severity];
+            break;
+            
+        case WGARPFindingDuplicateMAC: {
+            // Same MAC for multiple IPs - potential spoofing
+            NSMutableArray<NSString *> *ips = [NSMutableArray arrayWithCapacity:finding->ipCount];
+            for (uint32_t j = 0; j < finding->ipCount; j++) {
+                [ips addObject:WGStringFromIPv4(shard->analyzer.duplicateIPs[finding->ipOffset + j])];
+            }
+            
+            WGARPAnomaly *anomaly = [[WGARPAnomaly alloc] initWithType:WGARPAnomalyTypeDuplicateMAC];
+            anomaly.currentMAC = WGStringFromMAC(finding->currentMAC);
+            anomaly.details = [ips componentsJoinedByString:@", "];
+            anomaly.interface = interface;
+            anomaly.severity = finding->severity;
+            
+            [self recordAnomaly:anomaly];
+            self.statistics.duplicateMACsDetected++;
+            break;
         }
-        
-        [self reportAnomaly:WGARPAnomalyTypeGatewayMACChange
-                         ip:self.gatewayIP
-                previousMAC:self.lastGatewayMAC
-                 currentMAC:currentGatewayMAC
-                   severity:10];
-        
-        self.statistics.gatewayAnomalies++;
+            
+        case WGARPFindingGatewayMACChange:
+            [self reportAnomaly:WGARPAnomalyTypeGatewayMACChange
+                             ip:WGStringFromIPv4(finding->ip)
+                    previousMAC:WGStringFromMAC(finding->previousMAC)
+                     currentMAC:WGStringFromMAC(finding->currentMAC)
+                      interface:interface
+                       severity:finding->severity];
+            
+            self.statistics.gatewayAnomalies++;
+            break;
+            
+        case WGARPFindingBSSIDMismatch: {
+            // Gateway answered from another maker's hardware than the AP
+            WGARPAnomaly *anomaly = [[WGARPAnomaly alloc] initWithType:WGARPAnomalyTypeBSSIDMismatch];
+            anomaly.ipAddress = WGStringFromIPv4(finding->ip);
+            anomaly.interface = interface;
+            anomaly.previousMAC = finding->previousMAC ? WGStringFromMAC(finding->previousMAC) : nil;
+            anomaly.currentMAC = WGStringFromMAC(finding->currentMAC);
+            anomaly.vendor = [WGNetworkUtils vendorNameForID:finding->vendor];
+            anomaly.expectedVendor = [WGNetworkUtils vendorNameForID:finding->expectedVendor];
+            anomaly.severity = finding->severity;
+            
+            [self recordAnomaly:anomaly];
+            self.statistics.gatewayAnomalies++;
+            break;
+        }
+            
+        default:
+            break;
     }
-    
-    self.lastGatewayMAC = currentGatewayMAC;
 }
 
-- (void)checkForRapidChanges {
-    NSTimeInterval windowDuration = 60.0; // 1 minute window
-    NSTimeInterval elapsed = [[NSDate date] timeIntervalSinceDate:self.windowStartTime];
+- (void)recordRateOffender:(const WGRateOffender *)offender shard:(const WGARPShard *)shard {
+    NSTimeInterval window = shard->rates.windowMs / 1000.0;
+    WGARPAnomaly *anomaly = [[WGARPAnomaly alloc] initWithType:WGARPAnomalyTypeRapidChanges];
+    anomaly.interface = WGInterfaceName(shard->ifindex);
+    anomaly.severity = 8;
     
-    if (elapsed >= windowDuration) {
-        // Check if too many changes in this window
-        if (self.changeCountInWindow > 10) {
-            WGARPAnomaly *anomaly = [[WGARPAnomaly alloc] initWithType:WGARPAnomalyTypeRapidChanges];
-            anomaly.details = [NSString stringWithFormat:@"%ld changes in %.0f seconds",
-                              (long)self.changeCountInWindow, elapsed];
-            anomaly.severity = 8;
+    switch (offender->kind) {
+        case WGRateKeyIP: {
+            // One IP flapping between MACs
+            anomaly.ipAddress = WGStringFromIPv4((uint32_t)offender->key);
+            uint64_t key = WGARPShardKey(shard->ifindex, (uint32_t)offender->key);
+            anomaly.currentMAC = [self.arpCache objectForKey:key].macAddress;
+            anomaly.details = [NSString stringWithFormat:@"%u MAC changes in %.0f seconds",
+                               offender->count, window];
+            break;
+        }
             
-            [self recordAnomaly:anomaly];
+        case WGRateKeyMAC: {
+            // One MAC taking over many IPs
+            anomaly.currentMAC = WGStringFromMAC(offender->key);
+            const uint64_t *keys;
+            size_t count = WGPostingsGet(&_macIPs, offender->key, &keys);
+            NSMutableArray<NSString *> *ips = [NSMutableArray arrayWithCapacity:count];
+            for (size_t i = 0; i < count; i++) {
+                if (keys[i] >> 32 == shard->ifindex) {
+                    [ips addObject:WGStringFromIPv4((uint32_t)keys[i])];
+                }
+            }
+            anomaly.details = [NSString stringWithFormat:@"%u IP takeovers in %.0f seconds (now on %@)",
+                               offender->count, window, [ips componentsJoinedByString:@", "]];
+            break;
+        }
+            
+        default: {
+            // Table-wide churn - name the busiest hosts
+            WGRateOffender top[3];
+            size_t topCount = WGRateWindowTopKeys(&shard->rates, WGRateKeyIP, top, 3);
+            NSMutableArray<NSString *> *hosts = [NSMutableArray arrayWithCapacity:topCount];
+            for (size_t i = 0; i < topCount; i++) {
+                [hosts addObject:[NSString stringWithFormat:@"%@ ×%u",
+                                  WGStringFromIPv4((uint32_t)top[i].key), top[i].count]];
+            }
+            anomaly.details = [NSString stringWithFormat:@"%u changes in %.0f seconds (busiest: %@)",
+                               offender->count, window, [hosts componentsJoinedByString:@", "]];
+            break;
         }
-        
-        // Reset window
-        self.windowStartTime = [NSDate date];
-        self.changeCountInWindow = 0;
     }
+    
+    [self recordAnomaly:anomaly];
 }
 
 - (void)reportAnomaly:(WGARPAnomalyType)type
                    ip:(NSString *)ip
           previousMAC:(NSString *)previousMAC
            currentMAC:(NSString *)currentMAC
+            interface:(NSString *)interface
              severity:(NSInteger)severity {
     
     WGARPAnomaly *anomaly = [[WGARPAnomaly alloc] initWithType:type];
     anomaly.ipAddress = ip;
     anomaly.previousMAC = previousMAC;
     anomaly.currentMAC = currentMAC;
+    anomaly.interface = interface;
     anomaly.severity = severity;
     
     [self recordAnomaly:anomaly];
@@ -697,17 +960,33 @@ static WGARPDetector *_sharedInstance = nil;
 }
 
 - (void)recordAnomaly:(WGARPAnomaly *)anomaly {
-    [self.anomalyHistory addObject:anomaly];
+    uint64_t start = WGMetricsNow();
+    uint64_t keys[4];
+    NSUInteger keyCount = 0;
+    keys[keyCount++] = WGRecordKey(WGAnomalyKeyType, (uint64_t)anomaly.type);
+    WGMACAddress previousMAC = WGMACFromString(anomaly.previousMAC);
+    WGMACAddress currentMAC = WGMACFromString(anomaly.currentMAC);
+    if (currentMAC && !anomaly.vendor) {
+        anomaly.vendor = [WGNetworkUtils vendorNameForID:[WGNetworkUtils vendorIDForMAC:currentMAC]];
+    }
+    if (previousMAC) {
+        keys[keyCount++] = WGRecordKey(WGAnomalyKeyMAC, previousMAC);
+    }
+    if (currentMAC) {
+        keys[keyCount++] = WGRecordKey(WGAnomalyKeyMAC, currentMAC);
+    }
+    WGIPv4Address ip = WGIPv4FromString(anomaly.ipAddress);
+    if (ip) {
+        keys[keyCount++] = WGRecordKey(WGAnomalyKeyIP, ip);
+    }
+    [self notePendingActivity:WGScheduleActivityAlert];
+    [self.anomalyHistory addObject:anomaly time:anomaly.detectedAt keys:keys count:keyCount];
     self.statistics.anomaliesDetected++;
     
     // Log to audit
     [self.auditLogger logEvent:@"ARP_ANOMALY_DETECTED" 
-                       details:[anomaly localizedDescription]];
-    
-    // Keep only last 1000 anomalies
-    if (self.anomalyHistory.count > 1000) {
-        [self.anomalyHistory removeObjectAtIndex:0];
-    }
+                       details:[anomaly localizedDescription]
+                      severity:anomaly.severity];
     
     // Notify delegate on main thread
     if ([self.delegate respondsToSelector:@selector(arpDetector:didDetectAnomaly:)]) {
@@ -716,51 +995,130 @@ static WGARPDetector *_sharedInstance = nil;
         });
     }
     
-    NSLog(@"[WiFiGuard] %@", [anomaly localizedDescription]);
+    WGVerboseLog(@"[WiFiGuard] %@", [anomaly localizedDescription]);
+    WGMetricsAdd(WGMetricCounterARPAnomalies, 1);
+    WGMetricsEnd(WGMetricStageARPRecord, start);
 }
 
 #pragma mark - Configuration
 
+- (void)setCheckInterval:(NSTimeInterval)checkInterval {
+    _checkInterval = checkInterval;
+    [self updateSchedule];
+}
+
+- (void)setResyncInterval:(NSTimeInterval)resyncInterval {
+    _resyncInterval = resyncInterval;
+    [self updateSchedule];
+}
+
+- (void)setAdaptiveScheduling:(BOOL)adaptiveScheduling {
+    _adaptiveScheduling = adaptiveScheduling;
+    [self updateSchedule];
+}
+
+- (void)setCpuBudget:(double)cpuBudget {
+    _cpuBudget = cpuBudget;
+    [self updateSchedule];
+}
+
+- (void)setMaxChecksPerMinute:(NSUInteger)maxChecksPerMinute {
+    _maxChecksPerMinute = maxChecksPerMinute;
+    [self updateSchedule];
+}
+
+- (void)setRapidChangeWindow:(NSTimeInterval)rapidChangeWindow {
+    _rapidChangeWindow = MAX(rapidChangeWindow, 1.0);
+    [self configureRateWindow];
+}
+
+- (void)setRapidChangeThreshold:(NSUInteger)rapidChangeThreshold {
+    _rapidChangeThreshold = rapidChangeThreshold;
+    [self configureRateWindow];
+}
+
+- (void)setRapidChangeHostThreshold:(NSUInteger)rapidChangeHostThreshold {
+    _rapidChangeHostThreshold = rapidChangeHostThreshold;
+    [self configureRateWindow];
+}
+
+- (void)configureRateWindow {
+    // One-second buckets up to a minute, coarser beyond so the wheel stays small
+    uint32_t windowMs = (uint32_t)MIN(self.rapidChangeWindow * 1000.0, (double)UINT32_MAX);
+    uint32_t buckets = (uint32_t)MIN(MAX(self.rapidChangeWindow, 1.0), 60.0);
+    uint32_t hostLimit = (uint32_t)MIN(self.rapidChangeHostThreshold, (NSUInteger)UINT32_MAX);
+    uint32_t totalLimit = (uint32_t)MIN(self.rapidChangeThreshold, (NSUInteger)UINT32_MAX);
+    if (!WGARPShardSetConfigureRates(&_shards, windowMs, buckets, hostLimit, hostLimit, totalLimit)) {
+        NSLog(@"[WiFiGuard] ARP rate window configuration failed (out of memory)");
+    }
+}
+
 - (void)setGatewayIP:(NSString *)ip {
     _gatewayIP = ip;
+    _gatewayIPValue = WGIPv4FromString(ip);
+    WGARPShardSetGateway(&_shards, _primaryIfindex, _gatewayIPValue);
     [self.auditLogger logEvent:@"GATEWAY_SET" details:ip];
 }
 
 - (void)addTrustedMAC:(NSString *)mac forIP:(NSString *)ip {
-    self.trustedMACs[ip] = [mac uppercaseString];
+    // The shard set's IP -> MAC map is the only copy; every interface trusts it
+    WGMACAddress macValue = 0;
+    if (WGMACParse(mac.UTF8String, &macValue)) {
+        WGARPShardSetTrustMAC(&_shards, WGIPv4FromString(ip), macValue);
+    }
     [self.auditLogger logEvent:@"TRUSTED_MAC_ADDED" 
                        details:[NSString stringWithFormat:@"%@ -> %@", ip, mac]];
 }
 
 - (void)removeTrustedMAC:(NSString *)mac {
-    NSArray *keysToRemove = [self.trustedMACs allKeysForObject:[mac uppercaseString]];
-    for (NSString *key in keysToRemove) {
-        [self.trustedMACs removeObjectForKey:key];
+    WGMACAddress macValue = 0;
+    if (WGMACParse(mac.UTF8String, &macValue)) {
+        WGARPShardSetRemoveTrustedMAC(&_shards, macValue);
     }
 }
 
 - (void)clearTrustedMACs {
-    [self.trustedMACs removeAllObjects];
+    WGARPShardSetClearTrusted(&_shards);
     [self.auditLogger logEvent:@"TRUSTED_MACS_CLEARED" details:@"All trusted MACs removed"];
 }
 
 #pragma mark - Data Access
 
 - (NSArray<WGARPEntry *> *)currentARPTable {
-    return [self.arpCache.allValues copy];
+    [self refreshLastSeen];
+    return self.arpCache.allObjects;
 }
 
 - (NSArray<WGARPAnomaly *> *)detectedAnomalies {
-    return [self.anomalyHistory copy];
+    return [self.anomalyHistory allObjects];
 }
 
 - (WGARPEntry *)entryForIP:(NSString *)ip {
-    return self.arpCache[ip];
+    [self refreshLastSeen];
+    uint32_t ipValue = WGIPv4FromString(ip);
+    WGARPEntry *entry = [self.arpCache objectForKey:WGARPShardKey(_primaryIfindex, ipValue)];
+    for (size_t i = 0; !entry && i < _shards.count; i++) {
+        entry = [self.arpCache objectForKey:WGARPShardKey(_shards.shards[i]->ifindex, ipValue)];
+    }
+    return entry;
 }
 
 - (NSArray<WGARPEntry *> *)entriesWithMAC:(NSString *)mac {
-    NSPredicate *predicate = [NSPredicate predicateWithFormat:@"macAddress ==[c] %@", mac];
-    return [self.arpCache.allValues filteredArrayUsingPredicate:predicate];
+    [self refreshLastSeen];
+    return [self entriesWithMACValue:WGMACFromString(mac)];
+}
+
+- (NSArray<WGARPEntry *> *)entriesWithMACValue:(WGMACAddress)mac {
+    const uint64_t *keys;
+    size_t count = WGPostingsGet(&_macIPs, mac, &keys);
+    NSMutableArray<WGARPEntry *> *entries = [NSMutableArray arrayWithCapacity:count];
+    for (size_t i = 0; i < count; i++) {
+        WGARPEntry *entry = [self.arpCache objectForKey:keys[i]];
+        if (entry) {
+            [entries addObject:entry];
+        }
+    }
+    return entries;
 }
 
 - (NSString *)gatewayMAC {
@@ -768,7 +1126,7 @@ static WGARPDetector *_sharedInstance = nil;
         return nil;
     }
     
-    WGARPEntry *gatewayEntry = self.arpCache[self.gatewayIP];
+    WGARPEntry *gatewayEntry = [self.arpCache objectForKey:WGARPShardKey(_primaryIfindex, _gatewayIPValue)];
     return gatewayEntry.macAddress;
 }
 
@@ -781,20 +1139,39 @@ static WGARPDetector *_sharedInstance = nil;
 }
 
 - (NSArray<WGARPAnomaly *> *)anomaliesSince:(NSDate *)date {
-    NSPredicate *predicate = [NSPredicate predicateWithFormat:@"detectedAt >= %@", date];
-    return [self.anomalyHistory filteredArrayUsingPredicate:predicate];
+    WGAnomalyQuery *query = [[WGAnomalyQuery alloc] init];
+    query.since = date;
+    return [self anomaliesMatchingQuery:query].objects;
 }
 
 - (NSArray<WGARPAnomaly *> *)anomaliesOfType:(WGARPAnomalyType)type {
-    NSPredicate *predicate = [NSPredicate predicateWithFormat:@"type == %ld", (long)type];
-    return [self.anomalyHistory filteredArrayUsingPredicate:predicate];
+    WGAnomalyQuery *query = [[WGAnomalyQuery alloc] init];
+    query.type = type;
+    return [self anomaliesMatchingQuery:query].objects;
+}
+
+- (WGHistoryPage<WGARPAnomaly *> *)anomaliesMatchingQuery:(WGAnomalyQuery *)query {
+    uint64_t keys[3];
+    NSUInteger keyCount = 0;
+    if (query.type != WGARPAnomalyTypeNone) {
+        keys[keyCount++] = WGRecordKey(WGAnomalyKeyType, (uint64_t)query.type);
+    }
+    if (query.macAddress) {
+        keys[keyCount++] = WGRecordKey(WGAnomalyKeyMAC, WGMACFromString(query.macAddress));
+    }
+    if (query.ipAddress) {
+        keys[keyCount++] = WGRecordKey(WGAnomalyKeyIP, WGIPv4FromString(query.ipAddress));
+    }
+    return [self.anomalyHistory pageForQuery:query keys:keys count:keyCount];
 }
 
 #pragma mark - Export
 
 - (NSArray<NSDictionary *> *)exportARPTable {
+    [self refreshLastSeen];
+    
     NSMutableArray *data = [NSMutableArray array];
-    for (WGARPEntry *entry in self.arpCache.allValues) {
+    for (WGARPEntry *entry in self.arpCache) {
         [data addObject:[entry toDictionary]];
     }
     return data;
@@ -802,10 +1179,18 @@ static WGARPDetector *_sharedInstance = nil;
 
 - (NSArray<NSDictionary *> *)exportAnomalies {
     NSMutableArray *data = [NSMutableArray array];
-    for (WGARPAnomaly *anomaly in self.anomalyHistory) {
+    for (WGARPAnomaly *anomaly in [self.anomalyHistory allObjects]) {
         [data addObject:[anomaly toDictionary]];
     }
     return data;
 }
 
+#pragma mark - Metrics
+
+- (NSDictionary<NSString *, NSDictionary *> *)metricsSnapshot {
+    NSMutableDictionary *snapshot = [WGMetricsReport(@"arp.") mutableCopy];
+    snapshot[@"schedule"] = [[WGMonitorScheduler sharedScheduler] reportForTask:self.scheduleTask];
+    return snapshot;
+}
+
 @end
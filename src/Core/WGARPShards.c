@@ -0,0 +1,422 @@
+/*
+ * WGARPShards.c - Per-Interface ARP Detection Shards Implementation
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * DETECTION ONLY - NO ACTIVE ATTACKS OR COUNTERMEASURES
+ */
+
+#include "WGARPShards.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#pragma mark - Helpers
+
+static bool WGShardGrow(void **items, size_t *capacity, size_t needed, size_t elemSize) {
+    if (needed <= *capacity) {
+        return true;
+    }
+    size_t newCapacity = *capacity ? *capacity * 2 : 8;
+    while (newCapacity < needed) {
+        newCapacity *= 2;
+    }
+    void *grown = realloc(*items, newCapacity * elemSize);
+    if (!grown) {
+        return false;
+    }
+    *items = grown;
+    *capacity = newCapacity;
+    return true;
+}
+
+// First shard index whose ifindex is not less than ifindex
+static size_t WGARPShardSetLowerBound(const WGARPShardSet *set, uint16_t ifindex) {
+    size_t lo = 0, hi = set->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (set->shards[mid]->ifindex < ifindex) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static void WGARPShardFree(WGARPShard *shard) {
+    WGARPAnalyzerFree(&shard->analyzer);
+    WGRateWindowFree(&shard->rates);
+    WGARPTableFree(&shard->table);
+    free(shard->events);
+    free(shard);
+}
+
+// Copies the set's configuration into one shard's analyzer
+static void WGARPShardSync(const WGARPShardSet *set, WGARPShard *shard) {
+    WGARPAnalyzer *analyzer = &shard->analyzer;
+    analyzer->alertOnMACChange = set->alertOnMACChange;
+    analyzer->alertOnDuplicateMAC = set->alertOnDuplicateMAC;
+    analyzer->alertOnGatewayChange = set->alertOnGatewayChange;
+    analyzer->alertOnBSSIDMismatch = set->alertOnBSSIDMismatch;
+    analyzer->vendors = set->vendors;
+    analyzer->apVendor = shard->ifindex == set->apIfindex ? set->apVendor : WG_OUI_UNKNOWN;
+}
+
+// Clears the previous pass and syncs configuration
+static void WGARPShardSetBeginPass(WGARPShardSet *set) {
+    for (size_t i = 0; i < set->count; i++) {
+        WGARPShard *shard = set->shards[i];
+        shard->pending = false;
+        shard->checked = false;
+        shard->failed = false;
+        shard->table.count = 0;
+        shard->eventCount = 0;
+        WGARPShardSync(set, shard);
+    }
+}
+
+static bool WGARPShardAddEvent(WGARPShard *shard, const WGARPEvent *event) {
+    if (!WGShardGrow((void **)&shard->events, &shard->eventCapacity,
+                     shard->eventCount + 1, sizeof(WGARPEvent))) {
+        return false;
+    }
+    shard->events[shard->eventCount++] = *event;
+    shard->pending = true;
+    shard->applyEvents = true;
+    return true;
+}
+
+#pragma mark - Lifecycle
+
+bool WGARPShardSetInit(WGARPShardSet *set, WGRateClockFn clock, void *clockContext) {
+    memset(set, 0, sizeof(*set));
+    set->alertOnMACChange = true;
+    set->alertOnDuplicateMAC = true;
+    set->alertOnGatewayChange = true;
+    set->alertOnBSSIDMismatch = true;
+    set->clock = clock;
+    set->clockContext = clockContext;
+
+    // WGRateWindowInit defaults
+    set->windowMs = 60000;
+    set->bucketCount = 60;
+    set->ipLimit = 5;
+    set->macLimit = 5;
+    set->totalLimit = 10;
+
+    return WGHashMapInit(&set->trustedMACs, 8);
+}
+
+void WGARPShardSetFree(WGARPShardSet *set) {
+    for (size_t i = 0; i < set->count; i++) {
+        WGARPShardFree(set->shards[i]);
+    }
+    free(set->shards);
+    free(set->findings);
+    free(set->offenders);
+    WGHashMapFree(&set->trustedMACs);
+    memset(set, 0, sizeof(*set));
+}
+
+#pragma mark - Shards
+
+WGARPShard *WGARPShardSetFind(const WGARPShardSet *set, uint16_t ifindex) {
+    size_t index = WGARPShardSetLowerBound(set, ifindex);
+    return index < set->count && set->shards[index]->ifindex == ifindex ? set->shards[index] : NULL;
+}
+
+WGARPShard *WGARPShardSetShard(WGARPShardSet *set, uint16_t ifindex) {
+    size_t index = WGARPShardSetLowerBound(set, ifindex);
+    if (index < set->count && set->shards[index]->ifindex == ifindex) {
+        return set->shards[index];
+    }
+    if (!WGShardGrow((void **)&set->shards, &set->capacity, set->count + 1, sizeof(WGARPShard *))) {
+        return NULL;
+    }
+
+    WGARPShard *shard = calloc(1, sizeof(*shard));
+    if (!shard) {
+        return NULL;
+    }
+    shard->ifindex = ifindex;
+    WGARPTableInit(&shard->table);
+    bool ok = WGARPAnalyzerInit(&shard->analyzer) &&
+              WGRateWindowInit(&shard->rates, set->clock, set->clockContext) &&
+              WGRateWindowConfigure(&shard->rates, set->windowMs, set->bucketCount,
+                                    set->ipLimit, set->macLimit, set->totalLimit);
+
+    size_t cursor = 0;
+    uint64_t ip, mac;
+    while (ok && WGHashMapNext(&set->trustedMACs, &cursor, &ip, &mac)) {
+        ok = WGARPAnalyzerSetTrustedMAC(&shard->analyzer, (uint32_t)ip, mac);
+    }
+    if (!ok) {
+        WGARPShardFree(shard);
+        return NULL;
+    }
+    WGARPShardSync(set, shard);
+
+    memmove(&set->shards[index + 1], &set->shards[index], (set->count - index) * sizeof(WGARPShard *));
+    set->shards[index] = shard;
+    set->count++;
+    return shard;
+}
+
+size_t WGARPShardSetEntryCount(const WGARPShardSet *set) {
+    size_t count = 0;
+    for (size_t i = 0; i < set->count; i++) {
+        count += set->shards[i]->analyzer.snapshot.count;
+    }
+    return count;
+}
+
+#pragma mark - Gateways
+
+bool WGARPShardSetGateway(WGARPShardSet *set, uint16_t ifindex, uint32_t gatewayIP) {
+    WGARPShard *shard = gatewayIP ? WGARPShardSetShard(set, ifindex) : WGARPShardSetFind(set, ifindex);
+    if (!shard) {
+        return false;
+    }
+    WGARPAnalyzer *analyzer = &shard->analyzer;
+    if (analyzer->hasGateway == (gatewayIP != 0) && analyzer->gatewayIP == gatewayIP) {
+        return false;
+    }
+    analyzer->hasGateway = (gatewayIP != 0);
+    analyzer->gatewayIP = gatewayIP;
+    WGARPAnalyzerResetGatewayBaseline(analyzer);
+    return true;
+}
+
+void WGARPShardSetResetGatewayBaselines(WGARPShardSet *set) {
+    for (size_t i = 0; i < set->count; i++) {
+        WGARPAnalyzerResetGatewayBaseline(&set->shards[i]->analyzer);
+    }
+}
+
+#pragma mark - Rate Windows
+
+bool WGARPShardSetConfigureRates(WGARPShardSet *set, uint32_t windowMs, uint32_t bucketCount,
+                                 uint32_t ipLimit, uint32_t macLimit, uint32_t totalLimit) {
+    set->windowMs = windowMs;
+    set->bucketCount = bucketCount;
+    set->ipLimit = ipLimit;
+    set->macLimit = macLimit;
+    set->totalLimit = totalLimit;
+
+    bool ok = true;
+    for (size_t i = 0; i < set->count; i++) {
+        ok &= WGRateWindowConfigure(&set->shards[i]->rates, windowMs, bucketCount,
+                                    ipLimit, macLimit, totalLimit);
+    }
+    return ok;
+}
+
+void WGARPShardSetResetRates(WGARPShardSet *set) {
+    for (size_t i = 0; i < set->count; i++) {
+        WGRateWindowReset(&set->shards[i]->rates);
+    }
+}
+
+#pragma mark - Trusted MACs
+
+bool WGARPShardSetTrustMAC(WGARPShardSet *set, uint32_t ip, uint64_t mac) {
+    bool ok = WGHashMapPut(&set->trustedMACs, ip, mac);
+    for (size_t i = 0; ok && i < set->count; i++) {
+        ok = WGARPAnalyzerSetTrustedMAC(&set->shards[i]->analyzer, ip, mac);
+    }
+    return ok;
+}
+
+size_t WGARPShardSetRemoveTrustedMAC(WGARPShardSet *set, uint64_t mac) {
+    // Removal shifts slots, so rescan after each hit; the map is tiny
+    size_t removed = 0;
+    size_t cursor = 0;
+    uint64_t ip, trusted;
+    while (WGHashMapNext(&set->trustedMACs, &cursor, &ip, &trusted)) {
+        if (trusted == mac) {
+            WGHashMapRemove(&set->trustedMACs, ip);
+            removed++;
+            cursor = 0;
+        }
+    }
+    for (size_t i = 0; i < set->count; i++) {
+        WGARPAnalyzerRemoveTrustedMAC(&set->shards[i]->analyzer, mac);
+    }
+    return removed;
+}
+
+void WGARPShardSetClearTrusted(WGARPShardSet *set) {
+    WGHashMapClear(&set->trustedMACs);
+    for (size_t i = 0; i < set->count; i++) {
+        WGARPAnalyzerClearTrusted(&set->shards[i]->analyzer);
+    }
+}
+
+#pragma mark - Passes
+
+bool WGARPShardSetPartition(WGARPShardSet *set, const WGARPTable *table) {
+    WGARPShardSetBeginPass(set);
+
+    // Dumps are sorted by IP, so interfaces interleave and any ifindex change
+    // looks its shard up again; keeping the last one only saves that on runs.
+    // Each shard takes a subsequence, so its table stays sorted by IP.
+    WGARPShard *shard = NULL;
+    for (size_t i = 0; i < table->count; i++) {
+        const WGARPRecord *record = &table->records[i];
+        if (!shard || shard->ifindex != record->ifindex) {
+            shard = WGARPShardSetShard(set, record->ifindex);
+            if (!shard) {
+                return false;
+            }
+        }
+        if (!WGARPTableReserve(&shard->table, shard->table.count + 1)) {
+            return false;
+        }
+        shard->table.records[shard->table.count++] = *record;
+    }
+
+    // Every shard diffs, so interfaces gone from the dump drop their entries
+    for (size_t i = 0; i < set->count; i++) {
+        set->shards[i]->pending = true;
+        set->shards[i]->applyEvents = false;
+    }
+    return true;
+}
+
+bool WGARPShardSetRoute(WGARPShardSet *set, const WGARPEvent *events, size_t count) {
+    WGARPShardSetBeginPass(set);
+
+    for (size_t i = 0; i < count; i++) {
+        const WGARPEvent *event = &events[i];
+        if (event->kind == WGARPEventDelete && event->record.ifindex == 0) {
+            for (size_t j = 0; j < set->count; j++) {
+                if (!WGARPShardAddEvent(set->shards[j], event)) {
+                    return false;
+                }
+            }
+        } else if (event->kind == WGARPEventDelete) {
+            // Nothing to delete on an interface never seen
+            WGARPShard *shard = WGARPShardSetFind(set, event->record.ifindex);
+            if (shard && !WGARPShardAddEvent(shard, event)) {
+                return false;
+            }
+        } else if (event->kind == WGARPEventUpsert) {
+            WGARPShard *shard = WGARPShardSetShard(set, event->record.ifindex);
+            if (!shard || !WGARPShardAddEvent(shard, event)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void WGARPShardCheck(WGARPShardSet *set, size_t index) {
+    WGARPShard *shard = set->shards[index];
+    if (!shard->pending) {
+        return;
+    }
+    shard->pending = false;
+
+    WGARPAnalyzer *analyzer = &shard->analyzer;
+    bool ok = shard->applyEvents ? WGARPAnalyzerApplyEvents(analyzer, shard->events, shard->eventCount)
+                                 : WGARPAnalyzerCheck(analyzer, &shard->table);
+
+    // Every MAC change is counted as it happens, so a burst is caught as
+    // soon as it crosses a limit rather than when a fixed window closes
+    for (size_t i = 0; ok && i < analyzer->macChangeCount; i++) {
+        const WGARPMACChange *change = &analyzer->macChanges[i];
+        ok = WGRateWindowRecord(&shard->rates, change->ip, change->currentMAC);
+    }
+
+    shard->failed = !ok;
+    shard->checked = true;
+}
+
+typedef struct {
+    WGARPShardSet *set;
+    size_t first;
+    size_t stride;
+} WGARPShardWorker;
+
+static void *WGARPShardWork(void *context) {
+    WGARPShardWorker *worker = context;
+    for (size_t i = worker->first; i < worker->set->count; i += worker->stride) {
+        WGARPShardCheck(worker->set, i);
+    }
+    return NULL;
+}
+
+void WGARPShardSetCheckAll(WGARPShardSet *set, unsigned threads) {
+    size_t pending = 0;
+    for (size_t i = 0; i < set->count; i++) {
+        pending += set->shards[i]->pending;
+    }
+    size_t workers = threads < pending ? threads : pending;
+    if (workers <= 1) {
+        WGARPShardWorker worker = { set, 0, 1 };
+        WGARPShardWork(&worker);
+        return;
+    }
+
+    // Strided over all shards; idle ones cost one flag test
+    pthread_t tids[workers];
+    WGARPShardWorker jobs[workers];
+    bool started[workers];
+    for (size_t t = 1; t < workers; t++) {
+        jobs[t] = (WGARPShardWorker){ set, t, workers };
+        started[t] = pthread_create(&tids[t], NULL, WGARPShardWork, &jobs[t]) == 0;
+    }
+    jobs[0] = (WGARPShardWorker){ set, 0, workers };
+    WGARPShardWork(&jobs[0]);
+    for (size_t t = 1; t < workers; t++) {
+        if (started[t]) {
+            pthread_join(tids[t], NULL);
+        } else {
+            WGARPShardWork(&jobs[t]);
+        }
+    }
+}
+
+bool WGARPShardSetMerge(WGARPShardSet *set) {
+    set->findingCount = 0;
+    set->offenderCount = 0;
+    set->changeCount = 0;
+    bool ok = true;
+
+    for (size_t i = 0; i < set->count; i++) {
+        WGARPShard *shard = set->shards[i];
+        if (!shard->checked) {
+            continue;
+        }
+        if (shard->failed) {
+            ok = false;
+            continue;
+        }
+        const WGARPAnalyzer *analyzer = &shard->analyzer;
+        set->changeCount += analyzer->changeCount;
+        if (!WGShardGrow((void **)&set->findings, &set->findingCapacity,
+                         set->findingCount + analyzer->findingCount, sizeof(WGARPShardFinding))) {
+            return false;
+        }
+        for (size_t j = 0; j < analyzer->findingCount; j++) {
+            set->findings[set->findingCount++] = (WGARPShardFinding){ (uint32_t)i, analyzer->findings[j] };
+        }
+    }
+
+    for (size_t i = 0; i < set->count; i++) {
+        WGARPShard *shard = set->shards[i];
+        if (!shard->checked || shard->failed) {
+            continue;
+        }
+        if (!WGShardGrow((void **)&set->offenders, &set->offenderCapacity,
+                         set->offenderCount + shard->rates.offenderCount, sizeof(WGARPShardOffender))) {
+            return false;
+        }
+        for (size_t j = 0; j < shard->rates.offenderCount; j++) {
+            set->offenders[set->offenderCount++] = (WGARPShardOffender){ (uint32_t)i, shard->rates.offenders[j] };
+        }
+        WGRateWindowClearOffenders(&shard->rates);
+    }
+    return ok;
+}
@@ -0,0 +1,153 @@
+/*
+ * WGARPShards.h - Per-Interface ARP Detection Shards
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * DETECTION ONLY - consumes decoded ARP tables, never touches the network.
+ *
+ * With Wi-Fi, a VPN tunnel and USB tethering up at once, one kernel dump
+ * holds several unrelated neighbour tables. Each interface (ifindex) gets a
+ * shard of its own: a WGARPAnalyzer (snapshot, known MACs, duplicate-MAC
+ * counts, gateway and gateway baseline) and a WGRateWindow. A phone seen
+ * over both Wi-Fi and USB is then not a duplicate MAC, and every interface's
+ * default route is checked against its own gateway.
+ *
+ * A pass starts by routing work to the shards: WGARPShardSetPartition
+ * splits a full dump by ifindex (an interface missing from the dump gets an
+ * empty table, so its entries are removed), WGARPShardSetRoute splits a
+ * notification batch (a delete without ifindex goes to every shard). Shards
+ * share only configuration written before the pass, so the pending ones can
+ * be checked concurrently - WGARPShardCheck from a concurrent queue, or
+ * WGARPShardSetCheckAll on worker threads. WGARPShardSetMerge then folds
+ * their findings and rate offenders into one stream ordered by ifindex.
+ *
+ * Gateways are set per interface by the caller, from the default routes
+ * (WGARPSystemReadGateways) and from GatewayChange notifications.
+ *
+ * Not thread-safe apart from WGARPShardCheck on distinct shards.
+ */
+
+#ifndef WG_ARP_SHARDS_H
+#define WG_ARP_SHARDS_H
+
+#include "WGARPAnalyzer.h"
+#include "WGARPTable.h"
+#include "WGARPWatch.h"
+#include "WGHashMap.h"
+#include "WGOUI.h"
+#include "WGRateWindow.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint16_t ifindex;
+    bool pending;               // Has a table or events to check this pass
+    bool applyEvents;           // Pending work is events, not a table
+    bool checked;               // Analyzer output belongs to the current pass
+    bool failed;                // Its check ran out of memory
+    WGARPAnalyzer analyzer;
+    WGRateWindow rates;
+    WGARPTable table;           // This interface's records from the dump
+    WGARPEvent *events;         // This interface's notifications
+    size_t eventCount;
+    size_t eventCapacity;
+} WGARPShard;
+
+// One entry of the merged finding / offender stream
+typedef struct {
+    uint32_t shard;             // Index into WGARPShardSet.shards
+    WGARPFinding finding;
+} WGARPShardFinding;
+
+typedef struct {
+    uint32_t shard;
+    WGRateOffender offender;
+} WGARPShardOffender;
+
+typedef struct {
+    // Configuration, copied into the shards when a pass starts
+    bool alertOnMACChange;
+    bool alertOnDuplicateMAC;
+    bool alertOnGatewayChange;
+    bool alertOnBSSIDMismatch;
+    const WGOUIDatabase *vendors;
+    WGVendorID apVendor;        // Applied to the apIfindex shard only
+    uint16_t apIfindex;         // Interface associated with the AP (Wi-Fi)
+
+    // Rate window settings for every shard (WGRateWindowConfigure)
+    WGRateClockFn clock;
+    void *clockContext;
+    uint32_t windowMs;
+    uint32_t bucketCount;
+    uint32_t ipLimit;
+    uint32_t macLimit;
+    uint32_t totalLimit;
+
+    // State
+    WGARPShard **shards;        // Sorted by ifindex, never removed
+    size_t count;
+    size_t capacity;
+    WGHashMap trustedMACs;      // IP -> trusted MAC, given to every shard
+
+    // Output of the last pass
+    WGARPShardFinding *findings;
+    size_t findingCount;
+    size_t findingCapacity;
+    WGARPShardOffender *offenders;
+    size_t offenderCount;
+    size_t offenderCapacity;
+    size_t changeCount;         // Table changes over all checked shards
+} WGARPShardSet;
+
+// Packs an interface-scoped address, e.g. for caches keyed per shard
+static inline uint64_t WGARPShardKey(uint16_t ifindex, uint32_t ip) {
+    return (uint64_t)ifindex << 32 | ip;
+}
+
+// Lifecycle - clock may be NULL for WGRateClockMonotonicMs
+bool WGARPShardSetInit(WGARPShardSet *set, WGRateClockFn clock, void *clockContext);
+void WGARPShardSetFree(WGARPShardSet *set);
+
+// Shards - Shard creates one on first use (NULL on allocation failure)
+WGARPShard *WGARPShardSetShard(WGARPShardSet *set, uint16_t ifindex);
+WGARPShard *WGARPShardSetFind(const WGARPShardSet *set, uint16_t ifindex);
+size_t WGARPShardSetEntryCount(const WGARPShardSet *set);
+
+// Gateways - 0 clears. Returns true if the interface's gateway changed (the
+// new one is baselined without alerting), false if unchanged or out of memory.
+bool WGARPShardSetGateway(WGARPShardSet *set, uint16_t ifindex, uint32_t gatewayIP);
+void WGARPShardSetResetGatewayBaselines(WGARPShardSet *set);
+
+// Rate windows - applies to every shard; clears all counters
+bool WGARPShardSetConfigureRates(WGARPShardSet *set, uint32_t windowMs, uint32_t bucketCount,
+                                 uint32_t ipLimit, uint32_t macLimit, uint32_t totalLimit);
+void WGARPShardSetResetRates(WGARPShardSet *set);
+
+// Trusted MACs - applies to every shard, current and future
+bool WGARPShardSetTrustMAC(WGARPShardSet *set, uint32_t ip, uint64_t mac);
+size_t WGARPShardSetRemoveTrustedMAC(WGARPShardSet *set, uint64_t mac);
+void WGARPShardSetClearTrusted(WGARPShardSet *set);
+
+// Starting a pass - false on allocation failure. The table is not kept.
+// GatewayChange events are ignored; the caller updates gateways first.
+bool WGARPShardSetPartition(WGARPShardSet *set, const WGARPTable *table);
+bool WGARPShardSetRoute(WGARPShardSet *set, const WGARPEvent *events, size_t count);
+
+// Checks one shard if it is pending: analysis, then its rate window.
+// Distinct shards may be checked concurrently.
+void WGARPShardCheck(WGARPShardSet *set, size_t index);
+
+// Checks every pending shard on up to threads threads (the caller's included)
+void WGARPShardSetCheckAll(WGARPShardSet *set, unsigned threads);
+
+// Collects the checked shards' findings, then their rate offenders, in
+// ifindex order. Returns false if a shard failed or on allocation failure;
+// the output of the others is still merged.
+bool WGARPShardSetMerge(WGARPShardSet *set);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WG_ARP_SHARDS_H */
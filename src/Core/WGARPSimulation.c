@@ -0,0 +1,440 @@
+/*
+ * WGARPSimulation.c - Headless ARP Scenario Runner Implementation
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * SIMULATION ONLY - synthetic tables, no network access.
+ */
+
+#include "WGARPSimulation.h"
+#include "WGMetrics.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define WG_ARP_SIM_BENIGN_MAC   0x020000000001ULL
+#define WG_ARP_SIM_ATTACKER_MAC 0x0E0000000001ULL
+#define WG_ARP_SIM_PICK_TRIES   4
+
+static inline bool WGARPSimIsAttackerMAC(const WGARPSimulation *sim, uint64_t mac) {
+    return (mac >> 40) == 0x0E ||
+           (WGHashMapCount(&sim->attackerMACs) > 0 && WGHashMapFind(&sim->attackerMACs, mac));
+}
+
+static uint64_t WGARPSimClock(void *context) {
+    return ((const WGARPSimulation *)context)->nowMs;
+}
+
+// xorshift64*, so runs are reproducible from the scenario seed
+static uint64_t WGARPSimRandom(WGARPSimulation *sim) {
+    uint64_t x = sim->random;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    sim->random = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+#pragma mark - Scenarios
+
+static const char * const kWGARPSimAttackNames[WGARPSimAttackCount] = {
+    [WGARPSimAttackNone]          = "churn",
+    [WGARPSimAttackGatewaySpoof]  = "gateway_spoof",
+    [WGARPSimAttackMITM]          = "mitm",
+    [WGARPSimAttackDuplicateMAC]  = "duplicate_mac",
+    [WGARPSimAttackRapidChanges]  = "rapid_changes",
+    [WGARPSimAttackGratuitousARP] = "gratuitous_arp",
+};
+
+const char *WGARPSimAttackName(WGARPSimAttack attack) {
+    return (unsigned)attack < WGARPSimAttackCount ? kWGARPSimAttackNames[attack] : "unknown";
+}
+
+void WGARPSimScenarioPreset(WGARPSimScenario *scenario, WGARPSimAttack attack, uint32_t clientCount) {
+    // 3% of clients join and leave per minute, 0.2% are re-leased
+    *scenario = (WGARPSimScenario){
+        .name = WGARPSimAttackName(attack),
+        .clientCount = clientCount,
+        .initialPresence = 0.9,
+        .durationMs = 600000,
+        .checkIntervalMs = 3000,
+        .joinsPerSecond = clientCount * 0.03 / 60.0,
+        .leavesPerSecond = clientCount * 0.03 / 60.0,
+        .releasesPerSecond = clientCount * 0.002 / 60.0,
+        .attack = attack,
+        .attackStartMs = 301000,   // Between two checks, as a real attack would be
+        .seed = 0x9E3779B97F4A7C15ULL
+    };
+
+    switch (attack) {
+        case WGARPSimAttackMITM:
+            scenario->attackSteps = 2;
+            scenario->attackPeriodMs = 1000;
+            break;
+        case WGARPSimAttackDuplicateMAC:
+            scenario->attackSteps = 2;
+            scenario->attackPeriodMs = 3000;
+            break;
+        case WGARPSimAttackRapidChanges:
+            scenario->attackSteps = 20;
+            scenario->attackPeriodMs = 2000;
+            break;
+        case WGARPSimAttackGratuitousARP:
+            scenario->attackSteps = 6;
+            scenario->attackPeriodMs = 10000;
+            break;
+        default:
+            scenario->attackSteps = 1;
+            break;
+    }
+}
+
+#pragma mark - Lifecycle
+
+static bool WGARPSimCheck(WGARPSimulation *sim);
+
+bool WGARPSimInit(WGARPSimulation *sim, const WGARPSimScenario *scenario) {
+    memset(sim, 0, sizeof(*sim));
+    sim->scenario = *scenario;
+    sim->scenario.checkIntervalMs = scenario->checkIntervalMs ? scenario->checkIntervalMs : 1;
+    sim->random = scenario->seed ? scenario->seed : 0x9E3779B97F4A7C15ULL;
+    sim->nextBenignMAC = WG_ARP_SIM_BENIGN_MAC;
+    sim->nextAttackerMAC = WG_ARP_SIM_ATTACKER_MAC;
+    sim->lastAttackMs = WG_ARP_SIM_NEVER;
+    sim->nextCheckMs = sim->scenario.checkIntervalMs;
+    sim->nextAttackMs = scenario->attack != WGARPSimAttackNone ? scenario->attackStartMs : WG_ARP_SIM_NEVER;
+    sim->result.attackStartMs = WG_ARP_SIM_NEVER;
+    sim->result.detectedMs = WG_ARP_SIM_NEVER;
+
+    WGARPTableInit(&sim->table);
+    sim->hostCount = scenario->clientCount + WG_ARP_SIM_CLIENTS;
+    bool ok = WGARPAnalyzerInit(&sim->analyzer) &&
+              WGRateWindowInit(&sim->rateWindow, WGARPSimClock, sim) &&
+              WGHashMapInit(&sim->ipHosts, scenario->hostIPs ? sim->hostCount : 0) &&
+              WGHashMapInit(&sim->attackerMACs, 0);
+
+    sim->ips = calloc(sim->hostCount, sizeof(*sim->ips));
+    sim->macs = calloc(sim->hostCount, sizeof(*sim->macs));
+    sim->present = calloc(sim->hostCount, 1);
+    sim->attacked = calloc(sim->hostCount, 1);
+    if (!ok || !sim->ips || !sim->macs || !sim->present || !sim->attacked ||
+        !WGARPTableReserve(&sim->table, sim->hostCount)) {
+        return false;
+    }
+
+    for (uint32_t host = 0; host < sim->hostCount; host++) {
+        sim->ips[host] = scenario->hostIPs ? scenario->hostIPs[host] : WGARPSimHostIP(host);
+        if (scenario->hostIPs && sim->ips[host] != 0 && !WGHashMapPut(&sim->ipHosts, sim->ips[host], host)) {
+            return false;
+        }
+    }
+
+    if (scenario->hostMACs) {
+        for (uint32_t host = 0; host < sim->hostCount; host++) {
+            sim->macs[host] = scenario->hostMACs[host];
+            sim->present[host] = scenario->hostPresent && scenario->hostPresent[host] && sim->ips[host] != 0;
+        }
+        sim->gatewayMAC = sim->macs[WG_ARP_SIM_GATEWAY];
+    } else {
+        sim->gatewayMAC = sim->nextBenignMAC++;
+        sim->macs[WG_ARP_SIM_GATEWAY] = sim->gatewayMAC;
+        sim->present[WG_ARP_SIM_GATEWAY] = 1;
+        sim->macs[WG_ARP_SIM_ATTACKER] = sim->nextAttackerMAC++;
+        sim->present[WG_ARP_SIM_ATTACKER] = 1;
+        uint64_t threshold = (uint64_t)(scenario->initialPresence * (double)UINT32_MAX);
+        for (uint32_t host = WG_ARP_SIM_CLIENTS; host < sim->hostCount; host++) {
+            sim->macs[host] = sim->nextBenignMAC++;
+            sim->present[host] = (WGARPSimRandom(sim) >> 32) < threshold;
+        }
+    }
+
+    // Configured as WGARPDetector configures them by default
+    sim->analyzer.alertOnMACChange = true;
+    sim->analyzer.alertOnDuplicateMAC = true;
+    sim->analyzer.alertOnGatewayChange = true;
+    sim->analyzer.hasGateway = true;
+    sim->analyzer.gatewayIP = sim->ips[WG_ARP_SIM_GATEWAY];
+    if (!WGRateWindowConfigure(&sim->rateWindow, 60000, 60, 5, 5, 10)) {
+        return false;
+    }
+
+    // startMonitoring: first check, then adopt the gateway MAC
+    if (!WGARPSimCheck(sim)) {
+        return false;
+    }
+    WGARPAnalyzerResetGatewayBaseline(&sim->analyzer);
+    return true;
+}
+
+void WGARPSimFree(WGARPSimulation *sim) {
+    WGARPTableFree(&sim->table);
+    WGARPAnalyzerFree(&sim->analyzer);
+    WGRateWindowFree(&sim->rateWindow);
+    WGHashMapFree(&sim->ipHosts);
+    WGHashMapFree(&sim->attackerMACs);
+    free(sim->dump);
+    free(sim->ips);
+    free(sim->macs);
+    free(sim->present);
+    free(sim->attacked);
+    memset(sim, 0, sizeof(*sim));
+}
+
+#pragma mark - Mutations
+
+void WGARPSimSetMAC(WGARPSimulation *sim, uint32_t host, uint64_t mac, bool malicious) {
+    if (host >= sim->hostCount) {
+        return;
+    }
+    sim->macs[host] = mac;
+    sim->present[host] = 1;
+    if (malicious) {
+        sim->attacked[host] = 1;
+        sim->lastAttackMs = sim->nowMs;
+        if (sim->result.attackStartMs == WG_ARP_SIM_NEVER) {
+            sim->result.attackStartMs = sim->nowMs;
+        }
+    }
+}
+
+void WGARPSimRemove(WGARPSimulation *sim, uint32_t host) {
+    if (host < sim->hostCount) {
+        sim->present[host] = 0;
+    }
+}
+
+bool WGARPSimMarkAttackerMAC(WGARPSimulation *sim, uint64_t mac) {
+    return WGHashMapPut(&sim->attackerMACs, mac, 1);
+}
+
+// A random client whose presence matches, or UINT32_MAX after a few misses
+static uint32_t WGARPSimPickClient(WGARPSimulation *sim, int present) {
+    uint32_t clients = sim->scenario.clientCount;
+    for (int i = 0; clients > 0 && i < WG_ARP_SIM_PICK_TRIES; i++) {
+        uint32_t host = WG_ARP_SIM_CLIENTS + (uint32_t)(WGARPSimRandom(sim) % clients);
+        if (present < 0 || sim->present[host] == present) {
+            return host;
+        }
+    }
+    return UINT32_MAX;
+}
+
+static void WGARPSimChurn(WGARPSimulation *sim, double seconds) {
+    sim->joinCarry += sim->scenario.joinsPerSecond * seconds;
+    for (; sim->joinCarry >= 1.0; sim->joinCarry -= 1.0) {
+        uint32_t host = WGARPSimPickClient(sim, 0);
+        if (host != UINT32_MAX) {
+            sim->present[host] = 1;
+        }
+    }
+
+    sim->leaveCarry += sim->scenario.leavesPerSecond * seconds;
+    for (; sim->leaveCarry >= 1.0; sim->leaveCarry -= 1.0) {
+        uint32_t host = WGARPSimPickClient(sim, 1);
+        if (host != UINT32_MAX) {
+            sim->present[host] = 0;
+        }
+    }
+
+    // A new device on a recycled address: a legitimate MAC change
+    sim->releaseCarry += sim->scenario.releasesPerSecond * seconds;
+    for (; sim->releaseCarry >= 1.0; sim->releaseCarry -= 1.0) {
+        uint32_t host = WGARPSimPickClient(sim, -1);
+        if (host != UINT32_MAX && !sim->attacked[host]) {
+            WGARPSimSetMAC(sim, host, sim->nextBenignMAC++, false);
+        }
+    }
+}
+
+// Applies step sim->attackStep at sim->nowMs; returns the steps in total
+static uint32_t WGARPSimAttackStep(WGARPSimulation *sim) {
+    const WGARPSimScenario *scenario = &sim->scenario;
+    uint32_t step = sim->attackStep;
+    uint64_t attackerMAC = sim->macs[WG_ARP_SIM_ATTACKER];
+
+    switch (scenario->attack) {
+        case WGARPSimAttackGatewaySpoof:
+            WGARPSimSetMAC(sim, WG_ARP_SIM_GATEWAY, attackerMAC, true);
+            return 1;
+
+        case WGARPSimAttackMITM:
+            if (step == 0) {
+                WGARPSimSetMAC(sim, WG_ARP_SIM_GATEWAY, attackerMAC, true);
+            } else {
+                uint32_t host = WGARPSimPickClient(sim, 1);
+                if (host != UINT32_MAX) {
+                    WGARPSimSetMAC(sim, host, attackerMAC, true);
+                }
+            }
+            return 1 + scenario->attackSteps;
+
+        case WGARPSimAttackDuplicateMAC: {
+            uint32_t host = WGARPSimPickClient(sim, 1);
+            if (host != UINT32_MAX) {
+                WGARPSimSetMAC(sim, host, attackerMAC, true);
+            }
+            return scenario->attackSteps;
+        }
+
+        case WGARPSimAttackRapidChanges:
+            WGARPSimSetMAC(sim, WG_ARP_SIM_GATEWAY, sim->nextAttackerMAC++, true);
+            return scenario->attackSteps;
+
+        case WGARPSimAttackGratuitousARP:
+            WGARPSimSetMAC(sim, WG_ARP_SIM_GATEWAY, step % 2 == 0 ? attackerMAC : sim->gatewayMAC, true);
+            return scenario->attackSteps;
+
+        default:
+            return 0;
+    }
+}
+
+#pragma mark - Detection
+
+static bool WGARPSimIsAttackedIP(const WGARPSimulation *sim, uint32_t ip) {
+    uint32_t host = ip - WGARPSimHostIP(0);
+    if (sim->scenario.hostIPs) {
+        uint64_t *slot = WGHashMapFind(&sim->ipHosts, ip);
+        host = slot ? (uint32_t)*slot : UINT32_MAX;
+    }
+    return host < sim->hostCount && sim->attacked[host];
+}
+
+static bool WGARPSimFindingIsTrue(const WGARPSimulation *sim, const WGARPFinding *finding) {
+    if (WGARPSimIsAttackerMAC(sim, finding->currentMAC) || WGARPSimIsAttackerMAC(sim, finding->previousMAC)) {
+        return true;
+    }
+    if (finding->kind == WGARPFindingDuplicateMAC) {
+        for (uint32_t i = 0; i < finding->ipCount; i++) {
+            if (WGARPSimIsAttackedIP(sim, sim->analyzer.duplicateIPs[finding->ipOffset + i])) {
+                return true;
+            }
+        }
+        return false;
+    }
+    return WGARPSimIsAttackedIP(sim, finding->ip);
+}
+
+static bool WGARPSimOffenderIsTrue(const WGARPSimulation *sim, const WGRateOffender *offender) {
+    switch (offender->kind) {
+        case WGRateKeyIP:
+            return WGARPSimIsAttackedIP(sim, (uint32_t)offender->key);
+        case WGRateKeyMAC:
+            return WGARPSimIsAttackerMAC(sim, offender->key);
+        default:
+            // The whole-table rate is the attack's only while it is in the window
+            return sim->lastAttackMs != WG_ARP_SIM_NEVER &&
+                   sim->nowMs - sim->lastAttackMs <= sim->rateWindow.windowMs;
+    }
+}
+
+static void WGARPSimScore(WGARPSimulation *sim, bool isTrue) {
+    sim->result.findings++;
+    if (!isTrue) {
+        sim->result.falsePositives++;
+        return;
+    }
+    sim->result.truePositives++;
+    if (sim->result.detectedMs == WG_ARP_SIM_NEVER) {
+        sim->result.detectedMs = sim->nowMs;
+    }
+}
+
+// One performSingleCheck: dump, parse, analyze, rate window
+static bool WGARPSimCheck(WGARPSimulation *sim) {
+    WGARPTable *table = &sim->table;
+    table->count = 0;
+    for (uint32_t host = 0; host < sim->hostCount; host++) {
+        if (sim->present[host]) {
+            table->records[table->count++] = (WGARPRecord){
+                .mac = sim->macs[host],
+                .ip = sim->ips[host],
+                .ifindex = 1,
+                .flags = WGARPRecordFlagComplete
+            };
+        }
+    }
+
+    size_t length = WGARPDumpEncode(table->records, table->count, NULL, 0);
+    if (length > sim->dumpCapacity) {
+        uint8_t *dump = realloc(sim->dump, length);
+        if (!dump) {
+            return false;
+        }
+        sim->dump = dump;
+        sim->dumpCapacity = length;
+    }
+    WGARPDumpEncode(table->records, table->count, sim->dump, sim->dumpCapacity);
+
+    uint64_t start = WGMetricsNow();
+    if (WGARPTableParseDump(table, sim->dump, length) < 0 ||
+        !WGARPAnalyzerCheck(&sim->analyzer, table)) {
+        return false;
+    }
+    for (size_t i = 0; i < sim->analyzer.macChangeCount; i++) {
+        const WGARPMACChange *change = &sim->analyzer.macChanges[i];
+        if (!WGRateWindowRecord(&sim->rateWindow, change->ip, change->currentMAC)) {
+            return false;
+        }
+    }
+    sim->result.wallNs += WGMetricsNow() - start;
+
+    sim->result.checks++;
+    sim->result.records += table->count;
+    sim->result.changes += sim->analyzer.changeCount;
+    WGARPSimFindingFn onFinding = sim->scenario.onFinding;
+    for (size_t i = 0; i < sim->analyzer.findingCount; i++) {
+        const WGARPFinding *finding = &sim->analyzer.findings[i];
+        bool isTrue = WGARPSimFindingIsTrue(sim, finding);
+        WGARPSimScore(sim, isTrue);
+        if (onFinding) {
+            onFinding(sim->scenario.findingContext, sim, finding, NULL, isTrue);
+        }
+    }
+    for (size_t i = 0; i < sim->rateWindow.offenderCount; i++) {
+        const WGRateOffender *offender = &sim->rateWindow.offenders[i];
+        bool isTrue = WGARPSimOffenderIsTrue(sim, offender);
+        WGARPSimScore(sim, isTrue);
+        if (onFinding) {
+            onFinding(sim->scenario.findingContext, sim, NULL, offender, isTrue);
+        }
+    }
+    WGRateWindowClearOffenders(&sim->rateWindow);
+    return true;
+}
+
+#pragma mark - Playback
+
+bool WGARPSimStep(WGARPSimulation *sim, bool *done) {
+    *done = sim->nextCheckMs > sim->scenario.durationMs;
+    if (*done) {
+        return false;
+    }
+
+    uint64_t checkMs = sim->nextCheckMs;
+    sim->nextCheckMs += sim->scenario.checkIntervalMs;
+    WGARPSimChurn(sim, sim->scenario.checkIntervalMs / 1000.0);
+
+    // Attack steps land at their own times so latency includes the wait
+    // for the next check
+    while (sim->nextAttackMs <= checkMs) {
+        sim->nowMs = sim->nextAttackMs;
+        uint32_t total = WGARPSimAttackStep(sim);
+        sim->attackStep++;
+        sim->nextAttackMs = sim->attackStep < total ? sim->nextAttackMs + sim->scenario.attackPeriodMs
+                                                    : WG_ARP_SIM_NEVER;
+    }
+    sim->nowMs = checkMs;
+    return WGARPSimCheck(sim);
+}
+
+bool WGARPSimRun(const WGARPSimScenario *scenario, WGARPSimResult *result) {
+    WGARPSimulation sim;
+    bool ok = WGARPSimInit(&sim, scenario);
+    bool done = false;
+    while (ok && WGARPSimStep(&sim, &done)) {
+    }
+    ok = ok && done;
+    *result = sim.result;
+    WGARPSimFree(&sim);
+    return ok;
+}
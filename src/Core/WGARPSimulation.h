@@ -0,0 +1,186 @@
+/*
+ * WGARPSimulation.h - Headless ARP Scenario Runner
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * SIMULATION ONLY - every host and table here is synthetic; nothing is
+ * sent or read from a network.
+ *
+ * Plays an ARP scenario against the real detection path on a virtual
+ * clock, as fast as the CPU allows. The victim's ARP cache is one slot per
+ * host; benign churn (devices joining, leaving, re-leasing an address to a
+ * new MAC) and attack steps mutate it. Every check interval the cache is
+ * encoded as a kernel dump and goes through WGARPTableParseDump,
+ * WGARPAnalyzerCheck and the MAC-change WGRateWindow, configured as
+ * WGARPDetector configures them.
+ *
+ * Findings are scored against the ground truth: a finding about a host an
+ * attack touched, or naming an attacker MAC, is a true positive; anything
+ * else is a false positive. The result gives detection latency (first
+ * true positive after the first malicious step), false-positive counts
+ * and throughput.
+ *
+ * Scripted scenarios (WGScenarioScript) supply their own addresses and
+ * initial cache, leave attack at None and mutate the cache themselves
+ * between steps.
+ */
+
+#ifndef WG_ARP_SIMULATION_H
+#define WG_ARP_SIMULATION_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "WGARPAnalyzer.h"
+#include "WGARPTable.h"
+#include "WGRateWindow.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WG_ARP_SIM_NEVER UINT64_MAX
+
+// Host slots: 0 is the gateway, 1 the attacker, clients follow. By default
+// host i has IPv4 10.0.0.(i + 1) onwards; benign MACs are 02:..., attacker
+// MACs 0e:...
+#define WG_ARP_SIM_GATEWAY  0u
+#define WG_ARP_SIM_ATTACKER 1u
+#define WG_ARP_SIM_CLIENTS  2u
+
+typedef enum {
+    WGARPSimAttackNone = 0,         // Churn only: every finding is a false positive
+    WGARPSimAttackGatewaySpoof,     // Gateway IP -> attacker MAC
+    WGARPSimAttackMITM,             // Gateway plus attackCount peers -> attacker MAC
+    WGARPSimAttackDuplicateMAC,     // attackCount clients claimed one per period
+    WGARPSimAttackRapidChanges,     // Gateway flips to a fresh MAC every period
+    WGARPSimAttackGratuitousARP,    // Gateway alternates attacker / real MAC
+    WGARPSimAttackCount
+} WGARPSimAttack;
+
+struct WGARPSimulation;
+
+// Called for every scored finding (offender is NULL) or rate-window
+// offender (finding is NULL) during a check
+typedef void (*WGARPSimFindingFn)(void *context, const struct WGARPSimulation *sim,
+                                  const WGARPFinding *finding, const WGRateOffender *offender,
+                                  bool isTrue);
+
+typedef struct {
+    const char *name;
+    uint32_t clientCount;           // Hosts besides gateway and attacker
+    double initialPresence;         // Fraction of clients in the cache at start
+    uint64_t durationMs;            // Virtual run length
+    uint32_t checkIntervalMs;       // One table read per interval
+    double joinsPerSecond;          // Absent client reappears, same MAC
+    double leavesPerSecond;         // Present client ages out
+    double releasesPerSecond;       // Client's address re-leased to a new MAC
+    WGARPSimAttack attack;
+    uint64_t attackStartMs;
+    uint32_t attackSteps;           // Peers, claimed IPs or flips
+    uint32_t attackPeriodMs;        // Between attack steps
+    uint64_t seed;
+
+    // Optional, clientCount + WG_ARP_SIM_CLIENTS entries each
+    const uint32_t *hostIPs;        // Instead of 10.0.0.x (0 = unused slot)
+    const uint64_t *hostMACs;       // Instead of generated MACs
+    const uint8_t *hostPresent;     // With hostMACs: cached at start
+
+    WGARPSimFindingFn onFinding;    // Optional
+    void *findingContext;
+} WGARPSimScenario;
+
+typedef struct {
+    uint64_t checks;
+    uint64_t records;               // Entries decoded and analyzed
+    uint64_t changes;               // Analyzer diff entries
+    uint64_t findings;              // Analyzer findings + rate offenders
+    uint64_t truePositives;
+    uint64_t falsePositives;
+    uint64_t attackStartMs;         // First malicious step, WG_ARP_SIM_NEVER if none
+    uint64_t detectedMs;            // First true positive, WG_ARP_SIM_NEVER if missed
+    uint64_t wallNs;                // Real time spent in parse + analysis
+} WGARPSimResult;
+
+typedef struct WGARPSimulation {
+    WGARPSimScenario scenario;
+    uint64_t nowMs;                 // Virtual clock
+    uint64_t nextCheckMs;
+
+    // Victim cache, one slot per host
+    uint32_t hostCount;
+    uint32_t *ips;
+    uint64_t *macs;                 // Current MAC (kept while absent)
+    uint8_t *present;
+    uint8_t *attacked;              // Touched by an attack step
+    uint64_t gatewayMAC;            // Genuine gateway MAC
+    uint64_t nextBenignMAC;
+    uint64_t nextAttackerMAC;
+    uint64_t lastAttackMs;
+    WGHashMap ipHosts;              // IP -> host, for scenario addresses
+    WGHashMap attackerMACs;         // Marked beyond the 0e:... range
+
+    // Generators
+    uint64_t random;
+    double joinCarry;
+    double leaveCarry;
+    double releaseCarry;
+    uint32_t attackStep;
+    uint64_t nextAttackMs;
+
+    // Detection path
+    WGARPTable table;
+    uint8_t *dump;
+    size_t dumpCapacity;
+    WGARPAnalyzer analyzer;
+    WGRateWindow rateWindow;
+
+    WGARPSimResult result;
+} WGARPSimulation;
+
+// Fills a scenario for attack with the built-in defaults: 10 virtual
+// minutes checked every 3 s, a few percent of clients churning per
+// minute, the attack starting one second after the 5-minute check.
+void WGARPSimScenarioPreset(WGARPSimScenario *scenario, WGARPSimAttack attack, uint32_t clientCount);
+const char *WGARPSimAttackName(WGARPSimAttack attack);
+
+// Lifecycle - Init builds the initial cache and runs the baseline check.
+// Returns false on allocation failure (Free is still required).
+bool WGARPSimInit(WGARPSimulation *sim, const WGARPSimScenario *scenario);
+void WGARPSimFree(WGARPSimulation *sim);
+
+// Advances to nextCheckMs: churn and attack steps up to that time, then one
+// detector check. Returns false when the run is over or on allocation
+// failure (done tells which).
+bool WGARPSimStep(WGARPSimulation *sim, bool *done);
+
+// Cache mutations for scenario drivers, which may move nowMs forward up to
+// nextCheckMs first. malicious marks the host as attacked ground truth;
+// the first malicious mutation starts the clock for detection latency.
+void WGARPSimSetMAC(WGARPSimulation *sim, uint32_t host, uint64_t mac, bool malicious);
+void WGARPSimRemove(WGARPSimulation *sim, uint32_t host);
+
+// Findings naming mac count as true positives from the next check on
+bool WGARPSimMarkAttackerMAC(WGARPSimulation *sim, uint64_t mac);
+
+// Default addressing, when the scenario has no hostIPs
+static inline uint32_t WGARPSimHostIP(uint32_t host) {
+    return 0x0A000001u + host;
+}
+
+// Runs a whole scenario; false only on allocation failure
+bool WGARPSimRun(const WGARPSimScenario *scenario, WGARPSimResult *result);
+
+// WG_ARP_SIM_NEVER when nothing was detected or there was no attack
+static inline uint64_t WGARPSimDetectionLatencyMs(const WGARPSimResult *result) {
+    if (result->detectedMs == WG_ARP_SIM_NEVER || result->attackStartMs == WG_ARP_SIM_NEVER) {
+        return WG_ARP_SIM_NEVER;
+    }
+    return result->detectedMs - result->attackStartMs;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WG_ARP_SIMULATION_H */
@@ -0,0 +1,198 @@
+/*
+ * WGARPSystem.c - System ARP Table Source Implementation
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * READ-ONLY - queries the kernel table, sends nothing.
+ */
+
+#include "WGARPSystem.h"
+#include "WGARPTable.h"
+#include "WGRouteMessage.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__)
+#include <arpa/inet.h>
+#include <net/if.h>
+#else
+#include <sys/socket.h>
+#include <sys/sysctl.h>
+#endif
+
+#pragma mark - Buffer
+
+void WGARPDumpInit(WGARPDump *dump) {
+    dump->data = NULL;
+    dump->length = 0;
+    dump->capacity = 0;
+}
+
+void WGARPDumpFree(WGARPDump *dump) {
+    free(dump->data);
+    WGARPDumpInit(dump);
+}
+
+// Grows with headroom for entries added between calls
+static bool WGARPDumpReserve(WGARPDump *dump, size_t length) {
+    if (length <= dump->capacity) {
+        return true;
+    }
+    size_t capacity = length + length / 4;
+    void *data = realloc(dump->data, capacity);
+    if (!data) {
+        errno = ENOMEM;
+        return false;
+    }
+    dump->data = data;
+    dump->capacity = capacity;
+    return true;
+}
+
+#pragma mark - Read
+
+#if defined(__linux__)
+
+// "IP address  HW type  Flags  HW address  Mask  Device"; flags are
+// ATF_COM (0x2) for resolved entries and ATF_PERM (0x4) for static ones.
+// Unresolved entries have no MAC yet and are skipped, as on Darwin.
+bool WGARPSystemReadFile(WGARPDump *dump, const char *path) {
+    FILE *file = fopen(path, "re");
+    if (!file) {
+        return false;
+    }
+
+    WGARPTable table;
+    WGARPTableInit(&table);
+    char line[256];
+    bool ok = fgets(line, sizeof(line), file) != NULL || !ferror(file);   // Header
+    while (ok && fgets(line, sizeof(line), file)) {
+        char ip[64], mac[64], device[IF_NAMESIZE + 1];
+        unsigned int type, flags;
+        if (sscanf(line, "%63s 0x%x 0x%x %63s %*s %16s", ip, &type, &flags, mac, device) != 5) {
+            continue;
+        }
+
+        WGARPRecord record = { 0 };
+        if (!(flags & 0x2) || !WGIPv4Parse(ip, &record.ip) || !WGMACParse(mac, &record.mac)) {
+            continue;
+        }
+        record.ifindex = (uint16_t)if_nametoindex(device);
+        record.flags = (uint16_t)(WGARPRecordFlagComplete | ((flags & 0x4) ? WGARPRecordFlagPermanent : 0));
+
+        if (!WGARPTableReserve(&table, table.count + 1)) {
+            errno = ENOMEM;
+            ok = false;
+            break;
+        }
+        table.records[table.count++] = record;
+    }
+    if (ferror(file)) {
+        ok = false;
+    }
+    fclose(file);
+
+    if (ok) {
+        dump->length = WGARPDumpEncode(table.records, table.count, NULL, 0);
+        ok = WGARPDumpReserve(dump, dump->length);
+        if (ok) {
+            WGARPDumpEncode(table.records, table.count, dump->data, dump->capacity);
+        }
+    }
+    WGARPTableFree(&table);
+    return ok;
+}
+
+bool WGARPSystemRead(WGARPDump *dump) {
+    return WGARPSystemReadFile(dump, "/proc/net/arp");
+}
+
+// "Iface  Destination  Gateway  Flags ..."; addresses are the in-memory
+// (network order) words printed in hex, RTF_GATEWAY is 0x2
+bool WGARPSystemReadGateways(WGARPDump *dump) {
+    FILE *file = fopen("/proc/net/route", "re");
+    if (!file) {
+        return false;
+    }
+
+    WGARPTable gateways;
+    WGARPTableInit(&gateways);
+    char line[256];
+    bool ok = fgets(line, sizeof(line), file) != NULL || !ferror(file);   // Header
+    while (ok && fgets(line, sizeof(line), file)) {
+        char device[IF_NAMESIZE + 1];
+        unsigned int destination, gateway, flags;
+        if (sscanf(line, "%16s %x %x %x", device, &destination, &gateway, &flags) != 4 ||
+            destination != 0 || !(flags & 0x2) || gateway == 0) {
+            continue;
+        }
+
+        if (!WGARPTableReserve(&gateways, gateways.count + 1)) {
+            errno = ENOMEM;
+            ok = false;
+            break;
+        }
+        gateways.records[gateways.count++] = (WGARPRecord){
+            .ip = ntohl(gateway),
+            .ifindex = (uint16_t)if_nametoindex(device)
+        };
+    }
+    if (ferror(file)) {
+        ok = false;
+    }
+    fclose(file);
+
+    if (ok) {
+        dump->length = WGARPGatewayDumpEncode(gateways.records, gateways.count, NULL, 0);
+        ok = WGARPDumpReserve(dump, dump->length);
+        if (ok) {
+            WGARPGatewayDumpEncode(gateways.records, gateways.count, dump->data, dump->capacity);
+        }
+    }
+    WGARPTableFree(&gateways);
+    return ok;
+}
+
+#else
+
+static bool WGARPSystemReadRoutes(WGARPDump *dump, int flags) {
+    int mib[] = { CTL_NET, PF_ROUTE, 0, WG_AF_INET, 2 /* NET_RT_FLAGS */, flags };
+    dump->length = 0;
+
+    // The table can grow between the estimate and the read; retry on ENOMEM
+    for (int attempt = 0; attempt < 3; attempt++) {
+        size_t length = 0;
+        if (sysctl(mib, 6, NULL, &length, NULL, 0) < 0) {
+            return false;
+        }
+        if (length == 0) {
+            return true;
+        }
+        if (!WGARPDumpReserve(dump, length)) {
+            return false;
+        }
+
+        length = dump->capacity;
+        if (sysctl(mib, 6, dump->data, &length, NULL, 0) == 0) {
+            dump->length = length;
+            return true;
+        }
+        if (errno != ENOMEM) {
+            return false;
+        }
+        dump->capacity = 0;    // Force a larger reserve next round
+    }
+    return false;
+}
+
+bool WGARPSystemRead(WGARPDump *dump) {
+    return WGARPSystemReadRoutes(dump, WG_RTF_LLINFO);
+}
+
+bool WGARPSystemReadGateways(WGARPDump *dump) {
+    return WGARPSystemReadRoutes(dump, WG_RTF_GATEWAY);
+}
+
+#endif
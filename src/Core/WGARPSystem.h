@@ -0,0 +1,50 @@
+/*
+ * WGARPSystem.h - System ARP Table Source
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * READ-ONLY shim around the platform call that returns the kernel ARP
+ * table. On Darwin this is sysctl(NET_RT_FLAGS, RTF_LLINFO); on Linux the
+ * /proc/net/arp text is re-encoded into the same dump format, so callers
+ * always decode with WGARPTableParseDump.
+ *
+ * Default routes come the same way: sysctl(NET_RT_FLAGS, RTF_GATEWAY) on
+ * Darwin, /proc/net/route re-encoded on Linux, decoded with
+ * WGARPTableParseGateways into one gateway per interface.
+ */
+
+#ifndef WG_ARP_SYSTEM_H
+#define WG_ARP_SYSTEM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Reusable dump buffer; grows with headroom and is kept across reads
+typedef struct {
+    void *data;
+    size_t length;      // Bytes of the latest dump
+    size_t capacity;
+} WGARPDump;
+
+void WGARPDumpInit(WGARPDump *dump);
+void WGARPDumpFree(WGARPDump *dump);
+
+// Replaces dump->data with the current table. Returns false with errno set.
+bool WGARPSystemRead(WGARPDump *dump);
+
+#if defined(__linux__)
+// Same, from a file in /proc/net/arp format (recorded tables, tests)
+bool WGARPSystemReadFile(WGARPDump *dump, const char *path);
+#endif
+
+// Replaces dump->data with the default routes. Returns false with errno set.
+bool WGARPSystemReadGateways(WGARPDump *dump);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WG_ARP_SYSTEM_H */
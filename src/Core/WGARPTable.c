@@ -0,0 +1,325 @@
+/*
+ * WGARPTable.c - Binary ARP Table Parser Implementation
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * READ-ONLY - decodes data the kernel already returned, sends nothing.
+ */
+
+#include "WGARPTable.h"
+#include "WGRouteMessage.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#pragma mark - Lifecycle
+
+void WGARPTableInit(WGARPTable *table) {
+    table->records = NULL;
+    table->count = 0;
+    table->capacity = 0;
+}
+
+void WGARPTableFree(WGARPTable *table) {
+    free(table->records);
+    WGARPTableInit(table);
+}
+
+bool WGARPTableReserve(WGARPTable *table, size_t capacity) {
+    if (capacity <= table->capacity) {
+        return true;
+    }
+
+    size_t newCapacity = table->capacity ? table->capacity : 64;
+    while (newCapacity < capacity) {
+        newCapacity *= 2;
+    }
+
+    WGARPRecord *records = realloc(table->records, newCapacity * sizeof(WGARPRecord));
+    if (!records) {
+        return false;
+    }
+
+    table->records = records;
+    table->capacity = newCapacity;
+    return true;
+}
+
+bool WGARPTableCopy(WGARPTable *dst, const WGARPTable *src) {
+    if (!WGARPTableReserve(dst, src->count)) {
+        return false;
+    }
+    if (src->count > 0) {
+        memcpy(dst->records, src->records, src->count * sizeof(WGARPRecord));
+    }
+    dst->count = src->count;
+    return true;
+}
+
+#pragma mark - Decoding
+
+long WGARPTableParseDump(WGARPTable *table, const void *buf, size_t len) {
+    table->count = 0;
+
+    // Kernel messages carry a full inarp and dl, so this sizes the table
+    // once; shorter (rounded-down sin_len) messages grow it below
+    size_t estimate = len / (sizeof(wg_rt_msghdr) + sizeof(wg_sockaddr_inarp) + WG_SDL_DATA_OFFSET);
+    if (!WGARPTableReserve(table, estimate)) {
+        return -1;
+    }
+
+    const uint8_t *next = buf;
+    const uint8_t *end = next + len;
+
+    while ((size_t)(end - next) >= sizeof(wg_rt_msghdr)) {
+        wg_rt_msghdr rtm;
+        memcpy(&rtm, next, sizeof(rtm));
+
+        if (rtm.rtm_msglen < sizeof(wg_rt_msghdr) || rtm.rtm_msglen > (size_t)(end - next)) {
+            break;
+        }
+
+        const uint8_t *msgEnd = next + rtm.rtm_msglen;
+        const uint8_t *sa = next + sizeof(wg_rt_msghdr);
+
+        if ((size_t)(msgEnd - sa) < sizeof(wg_sockaddr_inarp)) {
+            next = msgEnd;
+            continue;
+        }
+
+        wg_sockaddr_inarp sin;
+        memcpy(&sin, sa, sizeof(sin));
+        sa += WG_RT_ROUNDUP(sin.sin_len);
+
+        if (sa > msgEnd || (size_t)(msgEnd - sa) < WG_SDL_DATA_OFFSET) {
+            next = msgEnd;
+            continue;
+        }
+
+        wg_sockaddr_dl sdl;
+        memcpy(&sdl, sa, WG_SDL_DATA_OFFSET);
+
+        size_t macOffset = WG_SDL_DATA_OFFSET + sdl.sdl_nlen;
+        if (sdl.sdl_family == WG_AF_LINK && sdl.sdl_alen >= 6 &&
+            macOffset + 6 <= (size_t)(msgEnd - sa)) {
+            if (!WGARPTableReserve(table, table->count + 1)) {
+                return -1;
+            }
+            const uint8_t *mac = sa + macOffset;
+            WGARPRecord *record = &table->records[table->count++];
+
+            record->mac = WGRouteReadMAC(mac);
+            record->ip = WGRouteReadIPv4(sin.sin_addr);
+            record->ifindex = sdl.sdl_index ? sdl.sdl_index : rtm.rtm_index;
+            record->flags = 0;
+            if (rtm.rtm_flags & WG_RTF_LLINFO) {
+                record->flags |= WGARPRecordFlagComplete;
+            }
+            if (rtm.rtm_flags & WG_RTF_STATIC) {
+                record->flags |= WGARPRecordFlagPermanent;
+            }
+        }
+
+        next = msgEnd;
+    }
+
+    return (long)table->count;
+}
+
+long WGARPTableParseGateways(WGARPTable *gateways, const void *buf, size_t len) {
+    gateways->count = 0;
+
+    const uint8_t *next = buf;
+    const uint8_t *end = next + len;
+
+    while ((size_t)(end - next) >= sizeof(wg_rt_msghdr)) {
+        wg_rt_msghdr rtm;
+        memcpy(&rtm, next, sizeof(rtm));
+
+        if (rtm.rtm_msglen < sizeof(wg_rt_msghdr) || rtm.rtm_msglen > (size_t)(end - next)) {
+            break;
+        }
+
+        const uint8_t *msgEnd = next + rtm.rtm_msglen;
+        const uint8_t *dst = next + sizeof(wg_rt_msghdr);
+        next = msgEnd;
+        if (!(rtm.rtm_flags & WG_RTF_GATEWAY) ||
+            (rtm.rtm_addrs & (WG_RTA_DST | WG_RTA_GATEWAY)) != (WG_RTA_DST | WG_RTA_GATEWAY)) {
+            continue;
+        }
+
+        // Destination then gateway; a zero-length sockaddr is 0.0.0.0
+        if (dst >= msgEnd || dst[0] > (size_t)(msgEnd - dst)) {
+            continue;
+        }
+        const uint8_t *gw = dst + WG_RT_ROUNDUP(dst[0]);
+        if (gw + 8 > msgEnd || gw[0] < 8 || gw[1] != WG_AF_INET) {
+            continue;
+        }
+        bool dstIsDefault = dst[0] < 8 || WGRouteReadIPv4(dst + 4) == 0;
+        if (!dstIsDefault || (dst[0] >= 2 && dst[1] != WG_AF_INET)) {
+            continue;
+        }
+
+        uint32_t gateway = WGRouteReadIPv4(gw + 4);
+        bool known = false;
+        for (size_t i = 0; i < gateways->count && !known; i++) {
+            known = gateways->records[i].ifindex == rtm.rtm_index;
+        }
+        if (gateway == 0 || known) {
+            continue;
+        }
+        if (!WGARPTableReserve(gateways, gateways->count + 1)) {
+            return -1;
+        }
+        gateways->records[gateways->count++] = (WGARPRecord){ .ip = gateway, .ifindex = rtm.rtm_index };
+    }
+
+    return (long)gateways->count;
+}
+
+#pragma mark - Ordering
+
+static int WGARPCompareIP(const void *a, const void *b) {
+    const WGARPRecord *ra = a;
+    const WGARPRecord *rb = b;
+    if (ra->ip != rb->ip) {
+        return ra->ip < rb->ip ? -1 : 1;
+    }
+    return (ra->ifindex > rb->ifindex) - (ra->ifindex < rb->ifindex);
+}
+
+static int WGARPCompareMAC(const void *a, const void *b) {
+    const WGARPRecord *ra = a;
+    const WGARPRecord *rb = b;
+    if (ra->mac != rb->mac) {
+        return ra->mac < rb->mac ? -1 : 1;
+    }
+    return (ra->ip > rb->ip) - (ra->ip < rb->ip);
+}
+
+void WGARPTableSortByIP(WGARPTable *table) {
+    if (table->count > 1) {
+        qsort(table->records, table->count, sizeof(WGARPRecord), WGARPCompareIP);
+    }
+}
+
+void WGARPTableSortByMAC(WGARPTable *table) {
+    if (table->count > 1) {
+        qsort(table->records, table->count, sizeof(WGARPRecord), WGARPCompareMAC);
+    }
+}
+
+#pragma mark - Encoding
+
+size_t WGARPDumpMessageSize(void) {
+    return sizeof(wg_rt_msghdr) + sizeof(wg_sockaddr_inarp) + sizeof(wg_sockaddr_dl);
+}
+
+size_t WGARPDumpEncode(const WGARPRecord *records, size_t count, void *buf, size_t cap) {
+    size_t msgSize = WGARPDumpMessageSize();
+    size_t required = msgSize * count;
+    if (!buf || cap < required) {
+        return required;
+    }
+
+    uint8_t *out = buf;
+    for (size_t i = 0; i < count; i++) {
+        out += WGRouteEncodeARPMessage(&records[i], WG_RTM_ADD, out);
+    }
+
+    return required;
+}
+
+size_t WGARPGatewayDumpEncode(const WGARPRecord *gateways, size_t count, void *buf, size_t cap) {
+    size_t required = WGRouteGatewayMessageSize() * count;
+    if (!buf || cap < required) {
+        return required;
+    }
+
+    uint8_t *out = buf;
+    for (size_t i = 0; i < count; i++) {
+        out += WGRouteEncodeGatewayMessage(&gateways[i], WG_RTM_GET, out);
+    }
+
+    return required;
+}
+
+size_t WGRouteEncodeARPMessage(const WGARPRecord *record, uint8_t type, void *buf) {
+    size_t msgSize = WGARPDumpMessageSize();
+
+    wg_rt_msghdr rtm;
+    memset(&rtm, 0, sizeof(rtm));
+    rtm.rtm_msglen = (uint16_t)msgSize;
+    rtm.rtm_version = WG_RTM_VERSION;
+    rtm.rtm_type = type;
+    rtm.rtm_index = record->ifindex;
+    rtm.rtm_flags = WG_RTF_UP | WG_RTF_HOST;
+    if (record->flags & WGARPRecordFlagComplete) {
+        rtm.rtm_flags |= WG_RTF_LLINFO;
+    }
+    if (record->flags & WGARPRecordFlagPermanent) {
+        rtm.rtm_flags |= WG_RTF_STATIC;
+    }
+    rtm.rtm_addrs = WG_RTA_DST | WG_RTA_GATEWAY;
+
+    wg_sockaddr_inarp sin;
+    memset(&sin, 0, sizeof(sin));
+    sin.sin_len = sizeof(sin);
+    sin.sin_family = WG_AF_INET;
+    sin.sin_addr[0] = (uint8_t)(record->ip >> 24);
+    sin.sin_addr[1] = (uint8_t)(record->ip >> 16);
+    sin.sin_addr[2] = (uint8_t)(record->ip >> 8);
+    sin.sin_addr[3] = (uint8_t)record->ip;
+
+    wg_sockaddr_dl sdl;
+    memset(&sdl, 0, sizeof(sdl));
+    sdl.sdl_len = sizeof(sdl);
+    sdl.sdl_family = WG_AF_LINK;
+    sdl.sdl_index = record->ifindex;
+    sdl.sdl_type = WG_IFT_ETHER;
+    sdl.sdl_alen = 6;
+    for (int b = 0; b < 6; b++) {
+        sdl.sdl_data[b] = (uint8_t)(record->mac >> (40 - 8 * b));
+    }
+
+    uint8_t *out = buf;
+    memcpy(out, &rtm, sizeof(rtm));
+    memcpy(out + sizeof(rtm), &sin, sizeof(sin));
+    memcpy(out + sizeof(rtm) + sizeof(sin), &sdl, sizeof(sdl));
+    return msgSize;
+}
+
+size_t WGRouteGatewayMessageSize(void) {
+    return sizeof(wg_rt_msghdr) + 2 * sizeof(wg_sockaddr_inarp);
+}
+
+size_t WGRouteEncodeGatewayMessage(const WGARPRecord *gateway, uint8_t type, void *buf) {
+    size_t msgSize = WGRouteGatewayMessageSize();
+
+    wg_rt_msghdr rtm;
+    memset(&rtm, 0, sizeof(rtm));
+    rtm.rtm_msglen = (uint16_t)msgSize;
+    rtm.rtm_version = WG_RTM_VERSION;
+    rtm.rtm_type = type;
+    rtm.rtm_index = gateway->ifindex;
+    rtm.rtm_flags = WG_RTF_UP | WG_RTF_GATEWAY;
+    rtm.rtm_addrs = WG_RTA_DST | WG_RTA_GATEWAY;
+
+    // sockaddr_in shares its first 8 bytes with sockaddr_inarp
+    wg_sockaddr_inarp dst;
+    memset(&dst, 0, sizeof(dst));
+    dst.sin_len = sizeof(dst);
+    dst.sin_family = WG_AF_INET;
+
+    wg_sockaddr_inarp gw = dst;
+    gw.sin_addr[0] = (uint8_t)(gateway->ip >> 24);
+    gw.sin_addr[1] = (uint8_t)(gateway->ip >> 16);
+    gw.sin_addr[2] = (uint8_t)(gateway->ip >> 8);
+    gw.sin_addr[3] = (uint8_t)gateway->ip;
+
+    uint8_t *out = buf;
+    memcpy(out, &rtm, sizeof(rtm));
+    memcpy(out + sizeof(rtm), &dst, sizeof(dst));
+    memcpy(out + sizeof(rtm) + sizeof(dst), &gw, sizeof(gw));
+    return msgSize;
+}
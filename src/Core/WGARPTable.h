@@ -0,0 +1,80 @@
+/*
+ * WGARPTable.h - Binary ARP Table Parser
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * Portable C decoder for the routing dump returned by
+ * sysctl(CTL_NET, PF_ROUTE, 0, AF_INET, NET_RT_FLAGS, RTF_LLINFO).
+ * Each rt_msghdr + sockaddr_inarp + sockaddr_dl message is decoded into a
+ * flat POD record; no per-entry allocation or string formatting happens here.
+ * Objective-C objects are only created by callers at the delegate/export
+ * boundary.
+ *
+ * The wire layout is declared locally (Darwin's net/route.h is not part of
+ * the iOS SDK) so this file also builds and runs on Linux.
+ */
+
+#ifndef WG_ARP_TABLE_H
+#define WG_ARP_TABLE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "WGAddress.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Record flags
+enum {
+    WGARPRecordFlagComplete  = 1 << 0,  // RTF_LLINFO set
+    WGARPRecordFlagPermanent = 1 << 1   // RTF_STATIC set
+};
+
+// Decoded ARP entry (16 bytes)
+typedef struct {
+    WGMACAddress mac;
+    WGIPv4Address ip;
+    uint16_t ifindex;   // Interface index (sdl_index)
+    uint16_t flags;     // WGARPRecordFlag*
+} WGARPRecord;
+
+// Growable record array, reused across checks
+typedef struct {
+    WGARPRecord *records;
+    size_t count;
+    size_t capacity;
+} WGARPTable;
+
+// Lifecycle
+void WGARPTableInit(WGARPTable *table);
+void WGARPTableFree(WGARPTable *table);
+bool WGARPTableReserve(WGARPTable *table, size_t capacity);
+bool WGARPTableCopy(WGARPTable *dst, const WGARPTable *src);
+
+// Decoding - replaces the table contents. Malformed trailing messages stop
+// the walk; returns the number of records or -1 on allocation failure.
+long WGARPTableParseDump(WGARPTable *table, const void *buf, size_t len);
+
+// Default routes - decodes a NET_RT_FLAGS / RTF_GATEWAY dump into records
+// holding each interface's gateway (ip, ifindex; mac and flags are 0). The
+// first default route of an interface wins. Returns the number of routes
+// or -1 on allocation failure.
+long WGARPTableParseGateways(WGARPTable *gateways, const void *buf, size_t len);
+
+// Ordering
+void WGARPTableSortByIP(WGARPTable *table);
+void WGARPTableSortByMAC(WGARPTable *table);
+
+// Encoding - writes records in sysctl dump format (synthetic buffers for
+// replay/simulation). Returns bytes required; writes only if cap suffices.
+size_t WGARPDumpMessageSize(void);
+size_t WGARPDumpEncode(const WGARPRecord *records, size_t count, void *buf, size_t cap);
+size_t WGARPGatewayDumpEncode(const WGARPRecord *gateways, size_t count, void *buf, size_t cap);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WG_ARP_TABLE_H */
@@ -0,0 +1,351 @@
+/*
+ * WGARPWatch.c - Kernel ARP Change Notifications Implementation
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * PASSIVE - the socket is only ever read from.
+ */
+
+#include "WGARPWatch.h"
+#include "WGRouteMessage.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <linux/netlink.h>
+#endif
+
+#define WG_WATCH_BUFFER_SIZE (64 * 1024)
+
+#pragma mark - Event Batches
+
+void WGARPEventBatchInit(WGARPEventBatch *batch) {
+    batch->events = NULL;
+    batch->count = 0;
+    batch->capacity = 0;
+}
+
+void WGARPEventBatchFree(WGARPEventBatch *batch) {
+    free(batch->events);
+    WGARPEventBatchInit(batch);
+}
+
+static WGARPEvent *WGARPEventBatchAppend(WGARPEventBatch *batch, WGARPEventKind kind) {
+    if (batch->count == batch->capacity) {
+        size_t capacity = batch->capacity ? batch->capacity * 2 : 64;
+        WGARPEvent *events = realloc(batch->events, capacity * sizeof(WGARPEvent));
+        if (!events) {
+            return NULL;
+        }
+        batch->events = events;
+        batch->capacity = capacity;
+    }
+    WGARPEvent *event = &batch->events[batch->count++];
+    memset(event, 0, sizeof(*event));
+    event->kind = (uint8_t)kind;
+    return event;
+}
+
+#pragma mark - Darwin Route Socket
+
+long WGARPDecodeRouteMessages(const void *buf, size_t len, WGARPEventBatch *batch) {
+    size_t startCount = batch->count;
+    const uint8_t *next = buf;
+    const uint8_t *end = next + len;
+
+    while ((size_t)(end - next) >= sizeof(wg_rt_msghdr)) {
+        wg_rt_msghdr rtm;
+        memcpy(&rtm, next, sizeof(rtm));
+
+        if (rtm.rtm_msglen < sizeof(wg_rt_msghdr) || rtm.rtm_msglen > (size_t)(end - next)) {
+            break;
+        }
+
+        const uint8_t *msgEnd = next + rtm.rtm_msglen;
+        bool relevant = rtm.rtm_version == WG_RTM_VERSION &&
+                        (rtm.rtm_type == WG_RTM_ADD || rtm.rtm_type == WG_RTM_CHANGE ||
+                         rtm.rtm_type == WG_RTM_DELETE);
+        if (!relevant) {
+            next = msgEnd;
+            continue;
+        }
+
+        // Collect the sockaddrs present in rtm_addrs, in RTAX order
+        const uint8_t *addrs[WG_RTAX_MAX] = {0};
+        uint8_t addrLens[WG_RTAX_MAX] = {0};
+        const uint8_t *sa = next + sizeof(wg_rt_msghdr);
+        for (int i = 0; i < WG_RTAX_MAX; i++) {
+            if (!(rtm.rtm_addrs & (1 << i))) {
+                continue;
+            }
+            if (sa >= msgEnd) {
+                break;
+            }
+            addrs[i] = sa;
+            addrLens[i] = sa[0];
+            if (sa[0] > (size_t)(msgEnd - sa)) {
+                addrs[i] = NULL;
+                break;
+            }
+            sa += WG_RT_ROUNDUP(sa[0]);
+        }
+
+        const uint8_t *dst = addrs[0];
+        const uint8_t *gw = addrs[1];
+
+        // A zero-length sockaddr stands for the all-zero address
+        uint32_t dstIP = (dst && addrLens[0] >= 8) ? WGRouteReadIPv4(dst + 4) : 0;
+        bool dstIsInet = dst && (addrLens[0] < 2 || dst[1] == WG_AF_INET);
+
+        if ((rtm.rtm_flags & WG_RTF_LLINFO) && dstIsInet && dstIP != 0) {
+            uint16_t ifindex = rtm.rtm_index;
+            uint64_t mac = 0;
+            bool hasMAC = false;
+
+            if (gw && addrLens[1] >= WG_SDL_DATA_OFFSET && gw[1] == WG_AF_LINK) {
+                wg_sockaddr_dl sdl;
+                memcpy(&sdl, gw, WG_SDL_DATA_OFFSET);
+                if (sdl.sdl_index) {
+                    ifindex = sdl.sdl_index;
+                }
+                size_t macOffset = WG_SDL_DATA_OFFSET + sdl.sdl_nlen;
+                if (sdl.sdl_alen >= 6 && macOffset + 6 <= addrLens[1]) {
+                    mac = WGRouteReadMAC(gw + macOffset);
+                    hasMAC = true;
+                }
+            }
+
+            if (rtm.rtm_type == WG_RTM_DELETE || hasMAC) {
+                WGARPEvent *event = WGARPEventBatchAppend(batch,
+                    rtm.rtm_type == WG_RTM_DELETE ? WGARPEventDelete : WGARPEventUpsert);
+                if (!event) {
+                    return -1;
+                }
+                event->record.ip = dstIP;
+                event->record.mac = mac;
+                event->record.ifindex = ifindex;
+                event->record.flags = WGARPRecordFlagComplete;
+                if (rtm.rtm_flags & WG_RTF_STATIC) {
+                    event->record.flags |= WGARPRecordFlagPermanent;
+                }
+            }
+            // Unresolved (no link-layer address yet) entries are ignored
+        } else if ((rtm.rtm_flags & WG_RTF_GATEWAY) && dstIsInet && dstIP == 0 &&
+                   (rtm.rtm_type == WG_RTM_DELETE ||
+                    (gw && addrLens[1] >= 8 && gw[1] == WG_AF_INET))) {
+            // A deleted default route is reported as gateway 0
+            WGARPEvent *event = WGARPEventBatchAppend(batch, WGARPEventGatewayChange);
+            if (!event) {
+                return -1;
+            }
+            event->record.ip = (rtm.rtm_type == WG_RTM_DELETE) ? 0 : WGRouteReadIPv4(gw + 4);
+            event->record.ifindex = rtm.rtm_index;
+        }
+
+        next = msgEnd;
+    }
+
+    return (long)(batch->count - startCount);
+}
+
+#pragma mark - Linux rtnetlink
+
+long WGARPDecodeNetlinkMessages(const void *buf, size_t len, WGARPEventBatch *batch) {
+    size_t startCount = batch->count;
+    const uint8_t *next = buf;
+    const uint8_t *end = next + len;
+
+    while ((size_t)(end - next) >= sizeof(wg_nlmsghdr)) {
+        wg_nlmsghdr nlh;
+        memcpy(&nlh, next, sizeof(nlh));
+
+        if (nlh.nlmsg_len < sizeof(wg_nlmsghdr) || nlh.nlmsg_len > (size_t)(end - next)) {
+            break;
+        }
+        if (nlh.nlmsg_type == WG_NLMSG_DONE || nlh.nlmsg_type == WG_NLMSG_ERROR) {
+            break;
+        }
+
+        const uint8_t *payload = next + sizeof(wg_nlmsghdr);
+        const uint8_t *msgEnd = next + nlh.nlmsg_len;
+
+        if ((nlh.nlmsg_type == WG_RTM_NEWNEIGH || nlh.nlmsg_type == WG_RTM_DELNEIGH) &&
+            (size_t)(msgEnd - payload) >= sizeof(wg_ndmsg)) {
+            wg_ndmsg ndm;
+            memcpy(&ndm, payload, sizeof(ndm));
+
+            uint32_t ip = 0;
+            uint64_t mac = 0;
+            bool hasIP = false, hasMAC = false;
+
+            const uint8_t *attr = payload + WG_NL_ALIGN(sizeof(wg_ndmsg));
+            while (attr + sizeof(wg_rtattr) <= msgEnd) {
+                wg_rtattr rta;
+                memcpy(&rta, attr, sizeof(rta));
+                if (rta.rta_len < sizeof(wg_rtattr) || rta.rta_len > (size_t)(msgEnd - attr)) {
+                    break;
+                }
+                const uint8_t *data = attr + sizeof(wg_rtattr);
+                size_t dataLen = rta.rta_len - sizeof(wg_rtattr);
+                if (rta.rta_type == WG_NDA_DST && dataLen == 4) {
+                    ip = WGRouteReadIPv4(data);
+                    hasIP = true;
+                } else if (rta.rta_type == WG_NDA_LLADDR && dataLen == 6) {
+                    mac = WGRouteReadMAC(data);
+                    hasMAC = true;
+                }
+                attr += WG_NL_ALIGN(rta.rta_len);
+            }
+
+            if (ndm.ndm_family == WG_AF_INET && hasIP) {
+                // FAILED neighbours are gone for detection purposes; INCOMPLETE
+                // ones have no MAC yet
+                bool gone = nlh.nlmsg_type == WG_RTM_DELNEIGH || (ndm.ndm_state & WG_NUD_FAILED);
+                bool resolved = hasMAC && !(ndm.ndm_state & WG_NUD_INCOMPLETE);
+
+                if (gone || resolved) {
+                    WGARPEvent *event = WGARPEventBatchAppend(batch, gone ? WGARPEventDelete : WGARPEventUpsert);
+                    if (!event) {
+                        return -1;
+                    }
+                    event->record.ip = ip;
+                    event->record.mac = mac;
+                    event->record.ifindex = (uint16_t)ndm.ndm_ifindex;
+                    event->record.flags = WGARPRecordFlagComplete;
+                    if (ndm.ndm_state & WG_NUD_PERMANENT) {
+                        event->record.flags |= WGARPRecordFlagPermanent;
+                    }
+                }
+            }
+        } else if ((nlh.nlmsg_type == WG_RTM_NEWROUTE || nlh.nlmsg_type == WG_RTM_DELROUTE) &&
+                   (size_t)(msgEnd - payload) >= sizeof(wg_rtmsg)) {
+            wg_rtmsg rtm;
+            memcpy(&rtm, payload, sizeof(rtm));
+
+            if (rtm.rtm_family == WG_AF_INET && rtm.rtm_dst_len == 0 && rtm.rtm_table == WG_RT_TABLE_MAIN) {
+                uint32_t gateway = 0;
+                uint32_t oif = 0;
+                const uint8_t *attr = payload + WG_NL_ALIGN(sizeof(wg_rtmsg));
+                while (attr + sizeof(wg_rtattr) <= msgEnd) {
+                    wg_rtattr rta;
+                    memcpy(&rta, attr, sizeof(rta));
+                    if (rta.rta_len < sizeof(wg_rtattr) || rta.rta_len > (size_t)(msgEnd - attr)) {
+                        break;
+                    }
+                    const uint8_t *data = attr + sizeof(wg_rtattr);
+                    if (rta.rta_type == WG_RTA_GATEWAY_NL && rta.rta_len == sizeof(wg_rtattr) + 4) {
+                        gateway = WGRouteReadIPv4(data);
+                    } else if (rta.rta_type == WG_RTA_OIF && rta.rta_len == sizeof(wg_rtattr) + 4) {
+                        memcpy(&oif, data, sizeof(oif));
+                    }
+                    attr += WG_NL_ALIGN(rta.rta_len);
+                }
+
+                // A deleted default route is reported as gateway 0
+                bool deleted = nlh.nlmsg_type == WG_RTM_DELROUTE;
+                if (gateway != 0 || deleted) {
+                    WGARPEvent *event = WGARPEventBatchAppend(batch, WGARPEventGatewayChange);
+                    if (!event) {
+                        return -1;
+                    }
+                    event->record.ip = deleted ? 0 : gateway;
+                    event->record.ifindex = (uint16_t)oif;
+                }
+            }
+        }
+
+        next += WG_NL_ALIGN(nlh.nlmsg_len);
+    }
+
+    return (long)(batch->count - startCount);
+}
+
+#pragma mark - Live Socket
+
+bool WGARPWatchOpen(WGARPWatch *watch) {
+    watch->fd = -1;
+    watch->buffer = NULL;
+    watch->bufferSize = 0;
+
+#if defined(__linux__)
+    int fd = socket(AF_NETLINK, SOCK_RAW, NETLINK_ROUTE);
+    if (fd < 0) {
+        return false;
+    }
+    struct sockaddr_nl addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = WG_RTMGRP_NEIGH | WG_RTMGRP_IPV4_ROUTE;
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        int saved = errno;
+        close(fd);
+        errno = saved;
+        return false;
+    }
+    watch->format = WGARPWatchFormatNetlink;
+#else
+    int fd = socket(PF_ROUTE, SOCK_RAW, AF_INET);
+    if (fd < 0) {
+        return false;
+    }
+    watch->format = WGARPWatchFormatRouteSocket;
+#endif
+
+    int flags = fcntl(fd, F_GETFL, 0);
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+    watch->buffer = malloc(WG_WATCH_BUFFER_SIZE);
+    if (!watch->buffer) {
+        close(fd);
+        errno = ENOMEM;
+        return false;
+    }
+    watch->bufferSize = WG_WATCH_BUFFER_SIZE;
+    watch->fd = fd;
+    return true;
+}
+
+void WGARPWatchClose(WGARPWatch *watch) {
+    if (watch->fd >= 0) {
+        close(watch->fd);
+    }
+    free(watch->buffer);
+    watch->fd = -1;
+    watch->buffer = NULL;
+    watch->bufferSize = 0;
+}
+
+long WGARPWatchRead(WGARPWatch *watch, WGARPEventBatch *batch) {
+    long total = 0;
+
+    for (;;) {
+        ssize_t n = recv(watch->fd, watch->buffer, watch->bufferSize, 0);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return total;
+            }
+            // ENOBUFS: the kernel dropped notifications; caller must resync
+            return -1;
+        }
+        if (n == 0) {
+            return total;
+        }
+
+        long decoded = (watch->format == WGARPWatchFormatNetlink)
+            ? WGARPDecodeNetlinkMessages(watch->buffer, (size_t)n, batch)
+            : WGARPDecodeRouteMessages(watch->buffer, (size_t)n, batch);
+        if (decoded < 0) {
+            errno = ENOMEM;
+            return -1;
+        }
+        total += decoded;
+    }
+}
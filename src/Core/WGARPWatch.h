@@ -0,0 +1,73 @@
+/*
+ * WGARPWatch.h - Kernel ARP Change Notifications
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * PASSIVE - subscribes to routing notifications, never writes to the
+ * socket and never modifies the neighbour table.
+ *
+ * On Darwin this listens on a PF_ROUTE socket for RTM_ADD/RTM_CHANGE/
+ * RTM_DELETE of RTF_LLINFO routes; on Linux it joins the rtnetlink
+ * RTMGRP_NEIGH group. Both decoders are plain byte parsers, so scripted
+ * event sources can feed either format on any platform.
+ */
+
+#ifndef WG_ARP_WATCH_H
+#define WG_ARP_WATCH_H
+
+#include "WGARPTable.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    WGARPEventUpsert = 0,   // Entry added or its MAC/flags changed
+    WGARPEventDelete,       // Entry removed (only ip/ifindex are meaningful)
+    WGARPEventGatewayChange // Default route changed (record.ip = new gateway, 0 if deleted)
+} WGARPEventKind;
+
+typedef struct {
+    WGARPRecord record;
+    uint8_t kind;           // WGARPEventKind
+} WGARPEvent;
+
+typedef struct {
+    WGARPEvent *events;
+    size_t count;
+    size_t capacity;
+} WGARPEventBatch;
+
+typedef enum {
+    WGARPWatchFormatRouteSocket = 0,    // Darwin rt_msghdr stream
+    WGARPWatchFormatNetlink             // Linux nlmsghdr stream
+} WGARPWatchFormat;
+
+typedef struct {
+    int fd;
+    WGARPWatchFormat format;
+    uint8_t *buffer;
+    size_t bufferSize;
+} WGARPWatch;
+
+// Event batches
+void WGARPEventBatchInit(WGARPEventBatch *batch);
+void WGARPEventBatchFree(WGARPEventBatch *batch);
+
+// Decoders - append events to the batch, return the number appended or -1
+// on allocation failure
+long WGARPDecodeRouteMessages(const void *buf, size_t len, WGARPEventBatch *batch);
+long WGARPDecodeNetlinkMessages(const void *buf, size_t len, WGARPEventBatch *batch);
+
+// Live socket (non-blocking). Open returns false and sets errno on failure.
+bool WGARPWatchOpen(WGARPWatch *watch);
+void WGARPWatchClose(WGARPWatch *watch);
+
+// Drains everything queued on the socket into the batch. Returns the number
+// of events appended, or -1 on a socket error other than EAGAIN.
+long WGARPWatchRead(WGARPWatch *watch, WGARPEventBatch *batch);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WG_ARP_WATCH_H */
@@ -6,6 +6,7 @@
  */
 
 #import <Foundation/Foundation.h>
+#import "WGRecordHistory.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -21,11 +22,47 @@ NS_ASSUME_NONNULL_BEGIN
 
 @end
 
+// Write-path statistics (group commit cost)
+@interface WGAuditLogStats : NSObject
+
+@property (nonatomic, assign) uint64_t eventsWritten;
+@property (nonatomic, assign) uint64_t bytesWritten;
+@property (nonatomic, assign) uint64_t fsyncs;
+@property (nonatomic, assign) uint64_t writeErrors;
+@property (nonatomic, assign) double eventsPerSecond;
+@property (nonatomic, assign) double fsyncsPerSecond;
+@property (nonatomic, assign) uint64_t storedBytes;        // On disk, across segments
+@property (nonatomic, assign) NSUInteger storedSegments;
+
+@end
+
+// Indexed query over the in-memory entries; filters combine. The stored
+// (on-disk) variants honour since, until, limit, cursor and eventType but
+// always run oldest first.
+@interface WGAuditQuery : WGHistoryQuery
+
+@property (nonatomic, copy, nullable) NSString *eventType;
+
+@end
+
 @interface WGAuditLogger : NSObject
 
 @property (nonatomic, readonly) NSString *sessionId;
 @property (nonatomic, readonly) NSArray<WGAuditLogEntry *> *allEntries;
-@property (nonatomic, readonly) NSString *logFilePath;
+@property (nonatomic, readonly) NSString *logDirectoryPath;    // Segmented store (WGLogStore)
+@property (nonatomic, readonly) WGAuditLogStats *writeStatistics;
+
+// Group commit policy - the file is fsynced after flushEntryThreshold
+// entries, flushInterval after the first unsynced entry, or at once for
+// events with severity >= immediateFlushSeverity
+@property (nonatomic, assign) NSUInteger flushEntryThreshold;   // Default 64
+@property (nonatomic, assign) NSTimeInterval flushInterval;     // Default 0.5 seconds
+@property (nonatomic, assign) NSInteger immediateFlushSeverity; // Default 9
+
+// Disk retention - whole segments are dropped, oldest first, once the
+// store outgrows maxStoredBytes or its entries pass retentionPeriod
+@property (nonatomic, assign) uint64_t maxStoredBytes;          // Default 64 MiB, 0 = no limit
+@property (nonatomic, assign) NSTimeInterval retentionPeriod;   // Default 90 days, 0 = no limit
 
 // Singleton
 + (instancetype)sharedInstance;
@@ -39,22 +76,33 @@ NS_ASSUME_NONNULL_BEGIN
 
 // Logging
 - (void)logEvent:(NSString *)eventType details:(nullable NSString *)details;
+- (void)logEvent:(NSString *)eventType details:(nullable NSString *)details severity:(NSInteger)severity;
+- (void)flush; // Commits buffered entries to disk before returning
 - (void)logMonitoringStart;
 - (void)logMonitoringStop;
 - (void)logOwnerConfirmation;
 - (void)logExport:(NSString *)filename;
 - (void)logError:(NSString *)errorDescription;
 
-// Query
+// Query - pages copy only the matching entries. entriesSince: reads the
+// store when date is older than the in-memory window.
 - (NSArray<WGAuditLogEntry *> *)entriesSince:(NSDate *)date;
 - (NSArray<WGAuditLogEntry *> *)entriesOfType:(NSString *)eventType;
+- (WGHistoryPage<WGAuditLogEntry *> *)entriesMatchingQuery:(WGAuditQuery *)query;
+- (NSEnumerator<WGAuditLogEntry *> *)entryEnumeratorForQuery:(WGAuditQuery *)query; // Page by page (limit, default 256)
+
+// Stored history - every retained entry, read segment by segment from disk.
+// Type-filtered pages may hold fewer than limit entries.
+- (WGHistoryPage<WGAuditLogEntry *> *)storedEntriesMatchingQuery:(WGAuditQuery *)query;
+- (NSEnumerator<WGAuditLogEntry *> *)storedEntryEnumeratorForQuery:(WGAuditQuery *)query;
 
 // Export
 - (BOOL)exportToFile:(NSString *)path error:(NSError **)error;
 - (NSString *)generateCSVExport;
 - (NSDictionary *)generateJSONExport;
 
-// Cleanup
+// Cleanup - clearLogs empties the in-memory window only; pruning also
+// drops stored segments whose entries are all older than age
 - (void)clearLogs;
 - (void)pruneLogsOlderThan:(NSTimeInterval)age;
 
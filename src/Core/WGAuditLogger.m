@@ -4,15 +4,55 @@
  */
 
 #import "WGAuditLogger.h"
+#import "WGLogStore.h"
+#import "WGMetrics.h"
+#import "WGRecordIndex.h"
+
+static NSDateFormatter *WGAuditTimestampFormatter(void) {
+    static NSDateFormatter *formatter;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        formatter = [[NSDateFormatter alloc] init];
+        formatter.dateFormat = @"yyyy-MM-dd HH:mm:ss.SSS";
+    });
+    return formatter;
+}
+
+// Store times are microseconds since 1970
+static uint64_t WGAuditStoreTime(NSDate *date) {
+    NSTimeInterval seconds = date.timeIntervalSince1970;
+    return seconds > 0 ? (uint64_t)(seconds * 1e6) : 0;
+}
+
+// Stored-query cursors pack a WGLogStorePosition: segment id above a 40-bit
+// offset (segments are a few MiB, ids grow by one per rotation)
+static uint64_t WGAuditCursorFromPosition(WGLogStorePosition position) {
+    return position.segment << 40 | (position.offset & ((1ull << 40) - 1));
+}
+
+static WGLogStorePosition WGAuditPositionFromCursor(uint64_t cursor) {
+    return (WGLogStorePosition){ cursor >> 40, cursor & ((1ull << 40) - 1) };
+}
+
+static NSString *WGAuditString(const char *bytes, size_t length) {
+    return [[NSString alloc] initWithBytes:bytes length:length encoding:NSUTF8StringEncoding] ?: @"";
+}
 
 #pragma mark - WGAuditLogEntry Implementation
 
 @implementation WGAuditLogEntry
 
 - (instancetype)initWithEvent:(NSString *)eventType details:(NSString *)details sessionId:(NSString *)sessionId {
+    return [self initWithTimestamp:[NSDate date] event:eventType details:details sessionId:sessionId];
+}
+
+- (instancetype)initWithTimestamp:(NSDate *)timestamp
+                            event:(NSString *)eventType
+                          details:(NSString *)details
+                        sessionId:(NSString *)sessionId {
     self = [super init];
     if (self) {
-        _timestamp = [NSDate date];
+        _timestamp = timestamp;
         _eventType = eventType;
         _details = details ?: @"";
         _sessionId = sessionId;
@@ -21,11 +61,8 @@
 }
 
 - (NSDictionary *)toDictionary {
-    NSDateFormatter *formatter = [[NSDateFormatter alloc] init];
-    formatter.dateFormat = @"yyyy-MM-dd HH:mm:ss.SSS";
-    
     return @{
-        @"timestamp": [formatter stringFromDate:self.timestamp],
+        @"timestamp": [WGAuditTimestampFormatter() stringFromDate:self.timestamp],
         @"eventType": self.eventType ?: @"",
         @"details": self.details ?: @"",
         @"sessionId": self.sessionId ?: @""
@@ -33,14 +70,11 @@
 }
 
 - (NSString *)toCSVLine {
-    NSDateFormatter *formatter = [[NSDateFormatter alloc] init];
-    formatter.dateFormat = @"yyyy-MM-dd HH:mm:ss.SSS";
-    
     // Escape CSV fields
     NSString *escapedDetails = [self.details stringByReplacingOccurrencesOfString:@"\"" withString:@"\"\""];
     
     return [NSString stringWithFormat:@"\"%@\",\"%@\",\"%@\",\"%@\"",
-            [formatter stringFromDate:self.timestamp],
+            [WGAuditTimestampFormatter() stringFromDate:self.timestamp],
             self.eventType,
             escapedDetails,
             self.sessionId];
@@ -48,14 +82,49 @@
 
 @end
 
+#pragma mark - WGAuditLogStats Implementation
+
+@implementation WGAuditLogStats
+@end
+
+#pragma mark - WGAuditQuery Implementation
+
+@implementation WGAuditQuery
+@end
+
 #pragma mark - WGAuditLogger Implementation
 
-@interface WGAuditLogger ()
+// Collects one page of stored records as entries
+typedef struct {
+    __unsafe_unretained NSMutableArray<WGAuditLogEntry *> *entries;
+    const char *eventType;      // NULL = any
+    size_t eventTypeLength;
+} WGAuditStoreReadContext;
+
+static bool WGAuditCollectRecord(void *context, const WGLogRecord *record) {
+    WGAuditStoreReadContext *read = context;
+    if (read->eventType && (record->eventTypeLength != read->eventTypeLength ||
+                            memcmp(record->eventType, read->eventType, read->eventTypeLength) != 0)) {
+        return true;
+    }
+    NSDate *timestamp = [NSDate dateWithTimeIntervalSince1970:record->time / 1e6];
+    [read->entries addObject:[[WGAuditLogEntry alloc] initWithTimestamp:timestamp
+                                                                  event:WGAuditString(record->eventType, record->eventTypeLength)
+                                                                details:WGAuditString(record->details, record->detailsLength)
+                                                              sessionId:WGAuditString(record->sessionId, record->sessionIdLength)]];
+    return true;
+}
+
+@interface WGAuditLogger () {
+    WGLogStore _store;          // Owned by logQueue
+    BOOL _storeOpen;
+    BOOL _commitScheduled;
+}
 
-@property (nonatomic, strong) NSMutableArray<WGAuditLogEntry *> *entries;
+@property (nonatomic, strong) WGRecordHistory<WGAuditLogEntry *> *entries; // Last 10000, owned by logQueue
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSNumber *> *eventTypeKeys; // Interned, owned by logQueue
 @property (nonatomic, copy) NSString *sessionId;
-@property (nonatomic, copy) NSString *logFilePath;
-@property (nonatomic, strong) NSFileHandle *fileHandle;
+@property (nonatomic, copy) NSString *logDirectoryPath;
 @property (nonatomic, strong) dispatch_queue_t logQueue;
 
 @end
@@ -75,11 +144,17 @@ static WGAuditLogger *_sharedInstance = nil;
 - (instancetype)init {
     self = [super init];
     if (self) {
-        _entries = [NSMutableArray array];
+        _entries = [[WGRecordHistory alloc] initWithCapacity:10000];
+        _eventTypeKeys = [NSMutableDictionary dictionary];
         _sessionId = [[NSUUID UUID] UUIDString];
         _logQueue = dispatch_queue_create("com.wifiguard.auditlog", DISPATCH_QUEUE_SERIAL);
+        _flushEntryThreshold = 64;
+        _flushInterval = 0.5;
+        _immediateFlushSeverity = 9;
+        _maxStoredBytes = 64 * 1024 * 1024;
+        _retentionPeriod = 90 * 24 * 3600;
         
-        [self setupLogFile];
+        [self setupLogStore];
     }
     return self;
 }
@@ -94,75 +169,185 @@ static WGAuditLogger *_sharedInstance = nil;
 }
 
 - (void)dealloc {
-    [self logEvent:@"SESSION_ENDED" details:nil];
-    [self.fileHandle closeFile];
+    // Runs synchronously - blocks queued on logQueue can no longer use self
+    if (_storeOpen) {
+        WGAuditLogEntry *entry = [[WGAuditLogEntry alloc] initWithEvent:@"SESSION_ENDED" details:nil sessionId:_sessionId];
+        [self appendEntry:entry severity:0];
+        WGLogStoreClose(&_store);
+        _storeOpen = NO;
+    }
 }
 
-- (void)setupLogFile {
-    // Create log directory in app's Documents folder
+- (void)setupLogStore {
+    // Segments live under the app's Documents folder
     NSArray *paths = NSSearchPathForDirectoriesInDomains(NSDocumentDirectory, NSUserDomainMask, YES);
     NSString *documentsDir = paths.firstObject;
-    NSString *logDir = [documentsDir stringByAppendingPathComponent:@"WiFiGuard/Logs"];
+    self.logDirectoryPath = [documentsDir stringByAppendingPathComponent:@"WiFiGuard/Logs/Audit"];
     
-    NSFileManager *fm = [NSFileManager defaultManager];
     NSError *error = nil;
-    
-    if (![fm fileExistsAtPath:logDir]) {
-        [fm createDirectoryAtPath:logDir withIntermediateDirectories:YES attributes:nil error:&error];
-        if (error) {
-            NSLog(@"[WiFiGuard] Error creating log directory: %@", error);
-        }
+    if (![[NSFileManager defaultManager] createDirectoryAtPath:self.logDirectoryPath
+                                   withIntermediateDirectories:YES
+                                                    attributes:nil
+                                                         error:&error]) {
+        NSLog(@"[WiFiGuard] Error creating log directory: %@", error);
+        return;
     }
     
-    // Create log file with timestamp
-    NSDateFormatter *formatter = [[NSDateFormatter alloc] init];
-    formatter.dateFormat = @"yyyy-MM-dd";
-    NSString *dateStr = [formatter stringFromDate:[NSDate date]];
-    
-    self.logFilePath = [logDir stringByAppendingPathComponent:
-                        [NSString stringWithFormat:@"audit_%@.log", dateStr]];
-    
-    // Create file if needed
-    if (![fm fileExistsAtPath:self.logFilePath]) {
-        [fm createFileAtPath:self.logFilePath contents:nil attributes:nil];
-        
-        // Write CSV header
-        NSString *header = @"\"Timestamp\",\"Event Type\",\"Details\",\"Session ID\"\n";
-        [header writeToFile:self.logFilePath atomically:YES encoding:NSUTF8StringEncoding error:nil];
+    _storeOpen = WGLogStoreOpen(&_store, self.logDirectoryPath.fileSystemRepresentation,
+                                [self storeConfig], [self commitPolicy]);
+    if (!_storeOpen) {
+        NSLog(@"[WiFiGuard] Error opening log store: %s", strerror(errno));
     }
-    
-    // Open file handle for appending
-    self.fileHandle = [NSFileHandle fileHandleForWritingAtPath:self.logFilePath];
-    [self.fileHandle seekToEndOfFile];
+}
+
+- (WGLogStoreConfig)storeConfig {
+    WGLogStoreConfig config = WGLogStoreConfigDefault();
+    config.retainBytes = self.maxStoredBytes;
+    config.retainAge = (uint64_t)MAX(self.retentionPeriod * 1e6, 0);
+    return config;
+}
+
+- (WGLogCommitPolicy)commitPolicy {
+    WGLogCommitPolicy policy = WGLogCommitPolicyDefault();
+    policy.maxPendingEntries = (uint32_t)MAX(self.flushEntryThreshold, 1);
+    policy.maxDelayMs = (uint32_t)MAX(self.flushInterval * 1000.0, 0);
+    policy.immediateSeverity = (int)self.immediateFlushSeverity;
+    return policy;
 }
 
 #pragma mark - Logging
 
 - (void)logEvent:(NSString *)eventType details:(NSString *)details {
+    [self logEvent:eventType details:details severity:0];
+}
+
+- (void)logEvent:(NSString *)eventType details:(NSString *)details severity:(NSInteger)severity {
     dispatch_async(self.logQueue, ^{
+        uint64_t start = WGMetricsNow();
         WGAuditLogEntry *entry = [[WGAuditLogEntry alloc] initWithEvent:eventType
                                                                  details:details
                                                                sessionId:self.sessionId];
-        [self.entries addObject:entry];
+        uint64_t typeKey = [self keyForEventType:eventType];
+        [self.entries addObject:entry time:entry.timestamp keys:&typeKey count:1];
         
-        // Write to file
-        NSString *csvLine = [[entry toCSVLine] stringByAppendingString:@"\n"];
-        NSData *data = [csvLine dataUsingEncoding:NSUTF8StringEncoding];
-        
-        @try {
-            [self.fileHandle writeData:data];
-            [self.fileHandle synchronizeFile];
-        } @catch (NSException *exception) {
-            NSLog(@"[WiFiGuard] Error writing to log: %@", exception);
+        // Buffer the record; the disk write and fsync are group-committed
+        if (self->_storeOpen) {
+            BOOL commitNow = [self appendEntry:entry severity:severity];
+            WGMetricsEnd(WGMetricStageAuditAppend, start);
+            if (commitNow) {
+                [self commitPendingEntries];
+            } else {
+                [self scheduleCommit];
+            }
         }
-        
-        // Keep only last 10000 entries in memory
-        if (self.entries.count > 10000) {
-            [self.entries removeObjectAtIndex:0];
+        WGMetricsAdd(WGMetricCounterAuditEntries, 1);
+    });
+}
+
+// Must run on logQueue (or from dealloc). Returns whether to commit now.
+- (BOOL)appendEntry:(WGAuditLogEntry *)entry severity:(NSInteger)severity {
+    _store.policy = [self commitPolicy];
+    WGLogStoreConfig config = [self storeConfig];
+    _store.config.retainBytes = config.retainBytes;
+    _store.config.retainAge = config.retainAge;
+    
+    const char *eventType = entry.eventType.UTF8String ?: "";
+    const char *details = entry.details.UTF8String ?: "";
+    const char *sessionId = entry.sessionId.UTF8String ?: "";
+    WGLogRecord record = {
+        .time = WGAuditStoreTime(entry.timestamp),
+        .severity = (int)severity,
+        .eventType = eventType,
+        .eventTypeLength = strlen(eventType),
+        .details = details,
+        .detailsLength = strlen(details),
+        .sessionId = sessionId,
+        .sessionIdLength = strlen(sessionId)
+    };
+    return WGLogStoreAppend(&_store, &record);
+}
+
+// Must run on logQueue. Event types are a small fixed vocabulary, so each
+// gets a dense number for the type posting list.
+- (uint64_t)keyForEventType:(NSString *)eventType {
+    NSNumber *key = self.eventTypeKeys[eventType ?: @""];
+    if (!key) {
+        key = @(self.eventTypeKeys.count);
+        self.eventTypeKeys[eventType ?: @""] = key;
+    }
+    return WGRecordKey(0, key.unsignedLongLongValue);
+}
+
+// Must run on logQueue
+- (void)commitPendingEntries {
+    // Only commits with something to write count as flushes
+    BOOL pending = WGLogStoreHasPending(&_store);
+    uint64_t start = WGMetricsNow();
+    if (!WGLogStoreCommit(&_store)) {
+        NSLog(@"[WiFiGuard] Error writing to log: %s", strerror(errno));
+    }
+    if (pending) {
+        WGMetricsEnd(WGMetricStageAuditFlush, start);
+    }
+}
+
+// Must run on logQueue
+- (void)scheduleCommit {
+    if (_commitScheduled || !WGLogStoreHasPending(&_store)) {
+        return;
+    }
+    _commitScheduled = YES;
+    
+    __weak typeof(self) weakSelf = self;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)_store.policy.maxDelayMs * NSEC_PER_MSEC),
+                   self.logQueue, ^{
+        WGAuditLogger *strongSelf = weakSelf;
+        if (!strongSelf) {
+            return;
+        }
+        strongSelf->_commitScheduled = NO;
+        if (strongSelf->_storeOpen && WGLogStoreHasPending(&strongSelf->_store)) {
+            [strongSelf commitPendingEntries];
         }
     });
 }
 
+- (void)flush {
+    dispatch_sync(self.logQueue, ^{
+        if (self->_storeOpen) {
+            [self commitPendingEntries];
+        }
+    });
+}
+
+- (WGAuditLogStats *)writeStatistics {
+    __block WGLogWriterStats stats = {0};
+    __block uint64_t storedBytes = 0;
+    __block NSUInteger storedSegments = 0;
+    dispatch_sync(self.logQueue, ^{
+        if (self->_storeOpen) {
+            stats = WGLogStoreStats(&self->_store);
+            storedBytes = self->_store.totalBytes;
+            storedSegments = self->_store.segmentCount;
+        }
+    });
+    
+    WGAuditLogStats *result = [[WGAuditLogStats alloc] init];
+    result.storedBytes = storedBytes;
+    result.storedSegments = storedSegments;
+    result.eventsWritten = stats.events;
+    result.bytesWritten = stats.bytes;
+    result.fsyncs = stats.fsyncs;
+    result.writeErrors = stats.errors;
+    
+    double elapsed = stats.startNs ? (WGLogMonotonicNs() - stats.startNs) / 1e9 : 0;
+    if (elapsed > 0) {
+        result.eventsPerSecond = stats.events / elapsed;
+        result.fsyncsPerSecond = stats.fsyncs / elapsed;
+    }
+    return result;
+}
+
 - (void)logMonitoringStart {
     [self logEvent:@"MONITORING_STARTED" details:@"User initiated monitoring"];
 }
@@ -190,19 +375,104 @@ static WGAuditLogger *_sharedInstance = nil;
 - (NSArray<WGAuditLogEntry *> *)allEntries {
     __block NSArray *result;
     dispatch_sync(self.logQueue, ^{
-        result = [self.entries copy];
+        result = [self.entries allObjects];
     });
     return result;
 }
 
 - (NSArray<WGAuditLogEntry *> *)entriesSince:(NSDate *)date {
-    NSPredicate *predicate = [NSPredicate predicateWithFormat:@"timestamp >= %@", date];
-    return [self.allEntries filteredArrayUsingPredicate:predicate];
+    WGAuditQuery *query = [[WGAuditQuery alloc] init];
+    query.since = date;
+    if (![self memoryCoversDate:date]) {
+        return [self storedEntriesMatchingQuery:query].objects;
+    }
+    return [self entriesMatchingQuery:query].objects;
+}
+
+// Whether the in-memory window reaches back to date, so nothing newer has
+// been evicted to disk only
+- (BOOL)memoryCoversDate:(NSDate *)date {
+    WGHistoryQuery *oldest = [[WGHistoryQuery alloc] init];
+    oldest.limit = 1;
+    __block WGAuditLogEntry *entry;
+    dispatch_sync(self.logQueue, ^{
+        entry = [self.entries pageForQuery:oldest keys:NULL count:0].objects.firstObject;
+    });
+    return entry && [entry.timestamp compare:date] != NSOrderedDescending;
 }
 
 - (NSArray<WGAuditLogEntry *> *)entriesOfType:(NSString *)eventType {
-    NSPredicate *predicate = [NSPredicate predicateWithFormat:@"eventType == %@", eventType];
-    return [self.allEntries filteredArrayUsingPredicate:predicate];
+    WGAuditQuery *query = [[WGAuditQuery alloc] init];
+    query.eventType = eventType;
+    return [self entriesMatchingQuery:query].objects;
+}
+
+- (WGHistoryPage<WGAuditLogEntry *> *)entriesMatchingQuery:(WGAuditQuery *)query {
+    __block WGHistoryPage *page;
+    dispatch_sync(self.logQueue, ^{
+        if (query.eventType) {
+            NSNumber *key = self.eventTypeKeys[query.eventType];
+            if (!key) {
+                page = [[WGHistoryPage alloc] initWithObjects:@[] nextCursor:0];
+                return;
+            }
+            uint64_t typeKey = WGRecordKey(0, key.unsignedLongLongValue);
+            page = [self.entries pageForQuery:query keys:&typeKey count:1];
+        } else {
+            page = [self.entries pageForQuery:query keys:NULL count:0];
+        }
+    });
+    return page;
+}
+
+- (NSEnumerator<WGAuditLogEntry *> *)entryEnumeratorForQuery:(WGAuditQuery *)query {
+    if (query.limit == 0) {
+        query.limit = 256;
+    }
+    return [[WGHistoryPageEnumerator alloc] initWithQuery:query fetch:^WGHistoryPage *(WGHistoryQuery *next) {
+        return [self entriesMatchingQuery:(WGAuditQuery *)next];
+    }];
+}
+
+- (WGHistoryPage<WGAuditLogEntry *> *)storedEntriesMatchingQuery:(WGAuditQuery *)query {
+    __block WGHistoryPage *page;
+    dispatch_sync(self.logQueue, ^{
+        if (!self->_storeOpen) {
+            page = [[WGHistoryPage alloc] initWithObjects:@[] nextCursor:0];
+            return;
+        }
+        uint64_t since = query.since ? WGAuditStoreTime(query.since) : 0;
+        uint64_t until = query.until ? MAX(WGAuditStoreTime(query.until), 1) : 0;
+        WGLogStorePosition position;
+        if (query.cursor) {
+            position = WGAuditPositionFromCursor(query.cursor);
+        } else {
+            WGLogStoreSeek(&self->_store, since, &position);
+        }
+        
+        NSMutableArray *entries = [NSMutableArray array];
+        const char *eventType = query.eventType.UTF8String;
+        WGAuditStoreReadContext context = {
+            .entries = entries,
+            .eventType = eventType,
+            .eventTypeLength = eventType ? strlen(eventType) : 0
+        };
+        bool finished;
+        WGLogStoreRead(&self->_store, &position, since, until, query.limit ?: SIZE_MAX,
+                       WGAuditCollectRecord, &context, &finished);
+        page = [[WGHistoryPage alloc] initWithObjects:entries
+                                           nextCursor:finished ? 0 : WGAuditCursorFromPosition(position)];
+    });
+    return page;
+}
+
+- (NSEnumerator<WGAuditLogEntry *> *)storedEntryEnumeratorForQuery:(WGAuditQuery *)query {
+    if (query.limit == 0) {
+        query.limit = 256;
+    }
+    return [[WGHistoryPageEnumerator alloc] initWithQuery:query fetch:^WGHistoryPage *(WGHistoryQuery *next) {
+        return [self storedEntriesMatchingQuery:(WGAuditQuery *)next];
+    }];
 }
 
 #pragma mark - Export
@@ -212,11 +482,18 @@ static WGAuditLogger *_sharedInstance = nil;
     return [csv writeToFile:path atomically:YES encoding:NSUTF8StringEncoding error:error];
 }
 
+// Exports cover the whole stored history, streamed a page at a time
+- (NSEnumerator<WGAuditLogEntry *> *)exportEnumerator {
+    WGAuditQuery *query = [[WGAuditQuery alloc] init];
+    query.until = [NSDate date];
+    return [self storedEntryEnumeratorForQuery:query];
+}
+
 - (NSString *)generateCSVExport {
     NSMutableString *csv = [NSMutableString string];
     [csv appendString:@"\"Timestamp\",\"Event Type\",\"Details\",\"Session ID\"\n"];
     
-    for (WGAuditLogEntry *entry in self.allEntries) {
+    for (WGAuditLogEntry *entry in [self exportEnumerator]) {
         [csv appendString:[entry toCSVLine]];
         [csv appendString:@"\n"];
     }
@@ -226,7 +503,7 @@ static WGAuditLogger *_sharedInstance = nil;
 
 - (NSDictionary *)generateJSONExport {
     NSMutableArray *entriesArray = [NSMutableArray array];
-    for (WGAuditLogEntry *entry in self.allEntries) {
+    for (WGAuditLogEntry *entry in [self exportEnumerator]) {
         [entriesArray addObject:[entry toDictionary]];
     }
     
@@ -242,19 +519,23 @@ static WGAuditLogger *_sharedInstance = nil;
 - (void)clearLogs {
     dispatch_async(self.logQueue, ^{
         [self.entries removeAllObjects];
-        [self logEvent:@"LOGS_CLEARED" details:@"Audit logs cleared by user"];
+        // Exports and history queries read the store, so it goes too
+        size_t segments = self->_storeOpen ? WGLogStoreDropAll(&self->_store) : 0;
+        
+        [self logEvent:@"LOGS_CLEARED"
+               details:[NSString stringWithFormat:@"Audit logs cleared by user (%zu stored segments)", segments]];
     });
 }
 
 - (void)pruneLogsOlderThan:(NSTimeInterval)age {
     dispatch_async(self.logQueue, ^{
-        NSDate *cutoffDate = [NSDate dateWithTimeIntervalSinceNow:-age];
-        NSPredicate *predicate = [NSPredicate predicateWithFormat:@"timestamp >= %@", cutoffDate];
-        NSArray *filtered = [self.entries filteredArrayUsingPredicate:predicate];
-        [self.entries setArray:[NSMutableArray arrayWithArray:filtered]];
+        NSDate *cutoff = [NSDate dateWithTimeIntervalSinceNow:-age];
+        [self.entries removeObjectsBefore:cutoff];
+        size_t segments = self->_storeOpen ? WGLogStoreDropBefore(&self->_store, WGAuditStoreTime(cutoff)) : 0;
         
         [self logEvent:@"LOGS_PRUNED" 
-               details:[NSString stringWithFormat:@"Removed entries older than %.0f seconds", age]];
+               details:[NSString stringWithFormat:@"Removed entries older than %.0f seconds (%zu stored segments)",
+                        age, segments]];
     });
 }
 
@@ -0,0 +1,462 @@
+/*
+ * WGBeacon.c - 802.11 Beacon / Probe Response Parser Implementation
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * PASSIVE ANALYSIS ONLY - Decodes frames from existing captures
+ */
+
+#include "WGBeacon.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Radiotap present bits read here; later fields are never needed
+enum {
+    WGRadiotapTSFT = 0,
+    WGRadiotapFlags = 1,
+    WGRadiotapRate = 2,
+    WGRadiotapChannel = 3,
+    WGRadiotapFHSS = 4,
+    WGRadiotapSignal = 5,
+    WGRadiotapExtended = 31
+};
+
+#define WG_RADIOTAP_FLAG_FCS     0x10
+#define WG_RADIOTAP_FLAG_BAD_FCS 0x40
+
+// Management frame layout
+#define WG_DOT11_HEADER_SIZE  24
+#define WG_DOT11_FIXED_SIZE   12   // Timestamp, beacon interval, capability
+#define WG_DOT11_SUBTYPE_PROBE_RESPONSE 5
+#define WG_DOT11_SUBTYPE_BEACON         8
+#define WG_DOT11_CAPABILITY_PRIVACY     0x0010
+
+// Element IDs
+#define WG_IE_SSID          0
+#define WG_IE_DS_PARAMS     3
+#define WG_IE_HT_OPERATION  61
+#define WG_IE_RSN           48
+#define WG_IE_VHT_OPERATION 192
+#define WG_IE_VENDOR        221
+#define WG_IE_EXTENSION     255
+#define WG_IE_EXT_HE_OPERATION 36
+
+static inline uint16_t WGBeaconRead16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t WGBeaconRead32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline WGMACAddress WGBeaconReadMAC(const uint8_t *mac) {
+    return ((uint64_t)mac[0] << 40) | ((uint64_t)mac[1] << 32) |
+           ((uint64_t)mac[2] << 24) | ((uint64_t)mac[3] << 16) |
+           ((uint64_t)mac[4] << 8)  |  (uint64_t)mac[5];
+}
+
+#pragma mark - Radiotap
+
+bool WGRadiotapParse(const uint8_t *data, size_t length, WGRadiotapInfo *info) {
+    memset(info, 0, sizeof(*info));
+    if (length < 8 || data[0] != 0) {
+        return false;
+    }
+    size_t headerLength = WGBeaconRead16(data + 2);
+    if (headerLength < 8 || headerLength > length) {
+        return false;
+    }
+
+    // Fields start after the last present word. Only the first word's
+    // standard fields are decoded; they precede any extended namespaces.
+    uint32_t present = WGBeaconRead32(data + 4);
+    size_t offset = 8;
+    for (uint32_t word = present; word & (1u << WGRadiotapExtended); offset += 4) {
+        if (offset + 4 > headerLength) {
+            return false;
+        }
+        word = WGBeaconRead32(data + offset);
+    }
+
+    // Each field is aligned to its natural size from the header start
+    static const uint8_t sizes[] = { 8, 1, 1, 4, 2, 1 };
+    static const uint8_t aligns[] = { 8, 1, 1, 2, 1, 1 };
+    uint8_t flags = 0;
+    for (int bit = WGRadiotapTSFT; bit <= WGRadiotapSignal; bit++) {
+        if (!(present & (1u << bit))) {
+            continue;
+        }
+        offset = (offset + aligns[bit] - 1) & ~(size_t)(aligns[bit] - 1);
+        if (offset + sizes[bit] > headerLength) {
+            return false;
+        }
+        const uint8_t *field = data + offset;
+        switch (bit) {
+            case WGRadiotapFlags:
+                flags = field[0];
+                break;
+            case WGRadiotapChannel:
+                info->frequency = WGBeaconRead16(field);
+                break;
+            case WGRadiotapSignal:
+                info->signal = (int8_t)field[0];
+                info->hasSignal = true;
+                break;
+        }
+        offset += sizes[bit];
+    }
+
+    size_t frameLength = length - headerLength;
+    if (flags & WG_RADIOTAP_FLAG_FCS) {
+        if (frameLength < 4) {
+            return false;
+        }
+        frameLength -= 4;
+    }
+    info->frame = data + headerLength;
+    info->length = (uint32_t)frameLength;
+    info->badFCS = (flags & WG_RADIOTAP_FLAG_BAD_FCS) != 0;
+    return true;
+}
+
+#pragma mark - Information Elements
+
+// Counts an RSN AKM suite list; WPA3 if any SAE / Suite B suite is offered
+static WGBeaconSecurity WGBeaconParseRSN(const uint8_t *ie, size_t length) {
+    // Version (2), group cipher (4), pairwise count + suites, AKM count + suites
+    if (length < 8) {
+        return WGBeaconSecurityWPA2;
+    }
+    size_t offset = 6;
+    size_t pairwise = WGBeaconRead16(ie + offset);
+    offset += 2 + 4 * pairwise;
+    if (offset + 2 > length) {
+        return WGBeaconSecurityWPA2;
+    }
+    size_t akms = WGBeaconRead16(ie + offset);
+    offset += 2;
+    for (size_t i = 0; i < akms && offset + 4 <= length; i++, offset += 4) {
+        const uint8_t *suite = ie + offset;
+        if (suite[0] != 0x00 || suite[1] != 0x0f || suite[2] != 0xac) {
+            continue;
+        }
+        switch (suite[3]) {
+            case 8:     // SAE
+            case 9:     // FT-SAE
+            case 12:    // Suite B
+            case 13:    // Suite B 192-bit
+            case 24:    // SAE-EXT-KEY
+            case 25:    // FT-SAE-EXT-KEY
+                return WGBeaconSecurityWPA3;
+        }
+    }
+    return WGBeaconSecurityWPA2;
+}
+
+// HE operation: 6 GHz operation information overrides channel and width
+static void WGBeaconParseHEOperation(const uint8_t *ie, size_t length, WGBeaconInfo *info) {
+    // Parameters (3), BSS color (1), basic HE-MCS (2), then optional fields
+    if (length < 6) {
+        return;
+    }
+    uint32_t parameters = (uint32_t)ie[0] | ((uint32_t)ie[1] << 8) | ((uint32_t)ie[2] << 16);
+    size_t offset = 6;
+    if (parameters & (1u << 14)) {
+        offset += 3;    // VHT operation information
+    }
+    if (parameters & (1u << 15)) {
+        offset += 1;    // Max co-hosted BSSID indicator
+    }
+    if (!(parameters & (1u << 17)) || offset + 5 > length) {
+        return;
+    }
+
+    // Primary channel, control, CCFS0, CCFS1, minimum rate
+    static const uint16_t widths[] = { 20, 40, 80, 160 };
+    info->channel = ie[offset];
+    info->channelWidth = widths[ie[offset + 1] & 0x03];
+    info->band = WGChannelBand6GHz;
+}
+
+bool WGBeaconParseFrame(const uint8_t *frame, size_t length, WGBeaconInfo *info) {
+    memset(info, 0, sizeof(*info));
+    if (length < WG_DOT11_HEADER_SIZE + WG_DOT11_FIXED_SIZE) {
+        return false;
+    }
+
+    // Frame control: protocol version 0, type 0 (management)
+    uint8_t control = frame[0];
+    uint8_t subtype = control >> 4;
+    if ((control & 0x0f) != 0 ||
+        (subtype != WG_DOT11_SUBTYPE_BEACON && subtype != WG_DOT11_SUBTYPE_PROBE_RESPONSE)) {
+        return false;
+    }
+    info->probeResponse = subtype == WG_DOT11_SUBTYPE_PROBE_RESPONSE;
+    info->bssid = WGBeaconReadMAC(frame + 16);
+    info->channelWidth = 20;
+
+    uint16_t capability = WGBeaconRead16(frame + WG_DOT11_HEADER_SIZE + 10);
+    bool privacy = (capability & WG_DOT11_CAPABILITY_PRIVACY) != 0;
+    bool rsn = false, wpa = false;
+    WGBeaconSecurity rsnSecurity = WGBeaconSecurityWPA2;
+    uint16_t dsChannel = 0, htChannel = 0;
+    bool ht40 = false;
+    uint16_t vhtWidth = 0;
+    bool sixGHz = false;
+
+    // Elements are walked in place; a truncated trailing element ends the walk
+    const uint8_t *ie = frame + WG_DOT11_HEADER_SIZE + WG_DOT11_FIXED_SIZE;
+    const uint8_t *end = frame + length;
+    while (end - ie >= 2) {
+        uint8_t id = ie[0];
+        uint8_t ieLength = ie[1];
+        const uint8_t *body = ie + 2;
+        if (ieLength > end - body) {
+            break;
+        }
+
+        switch (id) {
+            case WG_IE_SSID:
+                if (!info->ssid && ieLength <= WG_SCAN_SSID_MAX) {
+                    info->ssid = body;
+                    info->ssidLength = ieLength;
+                }
+                break;
+            case WG_IE_DS_PARAMS:
+                if (ieLength >= 1) {
+                    dsChannel = body[0];
+                }
+                break;
+            case WG_IE_RSN:
+                rsn = true;
+                rsnSecurity = WGBeaconParseRSN(body, ieLength);
+                break;
+            case WG_IE_VENDOR:
+                // Microsoft OUI, type 1: pre-RSN WPA
+                if (ieLength >= 4 && body[0] == 0x00 && body[1] == 0x50 && body[2] == 0xf2 && body[3] == 1) {
+                    wpa = true;
+                }
+                break;
+            case WG_IE_HT_OPERATION:
+                // Primary channel; secondary offset (1 above, 3 below) + STA width bit
+                if (ieLength >= 2) {
+                    htChannel = body[0];
+                    ht40 = (body[1] & 0x03) != 0 && (body[1] & 0x04) != 0;
+                }
+                break;
+            case WG_IE_VHT_OPERATION:
+                // Width 1 is 80 MHz, or 160 / 80+80 when CCFS1 is set
+                if (ieLength >= 3) {
+                    uint8_t width = body[0];
+                    if (width == 1) {
+                        vhtWidth = body[2] != 0 ? 160 : 80;
+                    } else if (width == 2 || width == 3) {
+                        vhtWidth = 160;     // Deprecated 160 / 80+80 encodings
+                    }
+                }
+                break;
+            case WG_IE_EXTENSION:
+                if (ieLength >= 1 && body[0] == WG_IE_EXT_HE_OPERATION) {
+                    WGBeaconParseHEOperation(body + 1, ieLength - 1, info);
+                    sixGHz = info->band == WGChannelBand6GHz;
+                }
+                break;
+        }
+        ie = body + ieLength;
+    }
+
+    // Hidden networks advertise an empty or all-NUL SSID
+    bool hidden = true;
+    for (uint8_t i = 0; i < info->ssidLength; i++) {
+        if (info->ssid[i] != 0) {
+            hidden = false;
+            break;
+        }
+    }
+    if (hidden) {
+        info->ssid = NULL;
+        info->ssidLength = 0;
+    }
+
+    if (rsn) {
+        info->security = rsnSecurity;
+    } else if (wpa) {
+        info->security = WGBeaconSecurityWPA;
+    } else {
+        info->security = privacy ? WGBeaconSecurityWEP : WGBeaconSecurityOpen;
+    }
+
+    if (!sixGHz) {
+        info->channel = dsChannel ? dsChannel : htChannel;
+        info->band = WGChannelBandForChannel(info->channel);
+        if (vhtWidth && ht40) {
+            info->channelWidth = vhtWidth;
+        } else if (ht40) {
+            info->channelWidth = 40;
+        }
+    }
+    return info->bssid != 0;
+}
+
+#pragma mark - Packets
+
+bool WGBeaconChannelForFrequency(uint32_t frequency, WGChannelBand *band, uint16_t *channel) {
+    if (frequency == 2484) {
+        *band = WGChannelBand2GHz;
+        *channel = 14;
+    } else if (frequency >= 2412 && frequency <= 2472) {
+        *band = WGChannelBand2GHz;
+        *channel = (uint16_t)((frequency - 2407) / 5);
+    } else if (frequency == 5935) {
+        *band = WGChannelBand6GHz;
+        *channel = 2;
+    } else if (frequency >= 5955 && frequency <= 7115) {
+        *band = WGChannelBand6GHz;
+        *channel = (uint16_t)((frequency - 5950) / 5);
+    } else if (frequency >= 5005 && frequency <= 5900) {
+        *band = WGChannelBand5GHz;
+        *channel = (uint16_t)((frequency - 5000) / 5);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool WGBeaconParsePacket(const WGPcapReader *reader, const WGPcapPacket *packet, WGBeaconInfo *info) {
+    WGRadiotapInfo radiotap = {0};
+    const uint8_t *frame = packet->data;
+    size_t length = packet->length;
+
+    if (reader->linkType == WGPcapLinkRadiotap) {
+        if (!WGRadiotapParse(packet->data, packet->length, &radiotap) || radiotap.badFCS) {
+            return false;
+        }
+        frame = radiotap.frame;
+        length = radiotap.length;
+    } else if (reader->fcsLength) {
+        if (length < reader->fcsLength) {
+            return false;
+        }
+        length -= reader->fcsLength;
+    }
+
+    if (!WGBeaconParseFrame(frame, length, info)) {
+        return false;
+    }
+
+    // The tuned frequency settles the band (6 GHz reuses 2.4 GHz channel
+    // numbers) and stands in for a missing DS / HT channel
+    WGChannelBand band;
+    uint16_t channel;
+    if (radiotap.frequency && WGBeaconChannelForFrequency(radiotap.frequency, &band, &channel)) {
+        if (info->channel == 0) {
+            info->channel = channel;
+        }
+        info->band = (uint8_t)band;
+    }
+    info->hasSignal = radiotap.hasSignal;
+    info->signal = radiotap.signal;
+    return true;
+}
+
+const char *WGBeaconSecurityName(WGBeaconSecurity security) {
+    switch (security) {
+        case WGBeaconSecurityOpen:
+            return "Open";
+        case WGBeaconSecurityWEP:
+            return "WEP";
+        case WGBeaconSecurityWPA:
+            return "WPA";
+        case WGBeaconSecurityWPA2:
+            return "WPA2";
+        case WGBeaconSecurityWPA3:
+            return "WPA3";
+    }
+    return "Unknown";
+}
+
+void WGBeaconToScanRecord(const WGBeaconInfo *info, double timestamp, WGScanRecord *record) {
+    memset(record, 0, sizeof(*record));
+    record->bssid = info->bssid;
+    record->lastSeen = timestamp;
+    record->rssi = info->hasSignal ? info->signal : -100;
+    record->channel = info->channel;
+    record->channelWidth = info->channelWidth;
+    record->band = info->band;
+    if (info->ssidLength == 0) {
+        record->flags |= WGScanRecordFlagHidden;
+    }
+    if (info->ssidLength) {
+        record->ssidLength = info->ssidLength;
+        memcpy(record->ssid, info->ssid, info->ssidLength);
+    }
+    const char *security = WGBeaconSecurityName((WGBeaconSecurity)info->security);
+    memcpy(record->security, security, strlen(security) + 1);     // Longest is "Unknown"
+}
+
+#pragma mark - Replay
+
+bool WGBeaconReplay(WGPcapReader *reader, const WGBeaconReplayOptions *options,
+                    WGBeaconSinkFn sink, void *context, WGBeaconReplayStats *stats) {
+    WGBeaconReplayOptions defaults = {0};
+    if (!options) {
+        options = &defaults;
+    }
+    size_t batchSize = options->batchSize ? options->batchSize : WG_BEACON_REPLAY_BATCH;
+
+    WGBeaconReplayStats local;
+    if (!stats) {
+        stats = &local;
+    }
+    memset(stats, 0, sizeof(*stats));
+
+    WGScanRecord *batch = malloc(batchSize * sizeof(WGScanRecord));
+    if (!batch) {
+        return false;
+    }
+
+    bool completed = true;
+    size_t pending = 0;
+    WGPcapPacket packet;
+    WGBeaconInfo info;
+    while (WGPcapNext(reader, &packet)) {
+        if (stats->packets == 0) {
+            stats->firstTimestamp = packet.timestamp;
+        }
+        stats->packets++;
+        stats->bytes += packet.length;
+        stats->lastTimestamp = packet.timestamp;
+
+        if (!WGBeaconParsePacket(reader, &packet, &info)) {
+            stats->skipped++;
+            continue;
+        }
+        WGBeaconToScanRecord(&info, packet.timestamp + options->timeShift, &batch[pending++]);
+        stats->beacons++;
+
+        if (pending == batchSize) {
+            stats->batches++;
+            if (!sink(context, batch, pending)) {
+                completed = false;
+                pending = 0;
+                break;
+            }
+            pending = 0;
+            if (options->cancel && __atomic_load_n(options->cancel, __ATOMIC_RELAXED)) {
+                completed = false;
+                break;
+            }
+        }
+    }
+
+    if (pending > 0) {
+        stats->batches++;
+        completed = sink(context, batch, pending) && completed;
+    }
+    free(batch);
+    return completed;
+}
+
+bool WGBeaconIngestSink(void *context, const WGScanRecord *records, size_t count) {
+    return WGScanIngestSubmit((WGScanIngest *)context, records, count);
+}
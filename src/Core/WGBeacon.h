@@ -0,0 +1,114 @@
+/*
+ * WGBeacon.h - 802.11 Beacon / Probe Response Parser
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * Decodes the radiotap header and management-frame body of captured
+ * beacons and probe responses into scan results:
+ *
+ *   radiotap   flags (FCS present / bad FCS), channel frequency, dBm signal
+ *   fixed      BSSID (addr3), capability privacy bit
+ *   IEs        SSID (0), DS parameter set (3), RSN (48), WPA vendor (221),
+ *              HT operation (61), VHT operation (192), HE operation (255/36)
+ *
+ * Parsing is zero-copy: WGBeaconInfo points into the packet (and so into
+ * the mapped capture); only WGBeaconToScanRecord copies the SSID out.
+ * WGBeaconReplay streams a whole capture into a scan-record sink in
+ * batches - WGScanIngestSubmit, for replay through the scanner's table.
+ */
+
+#ifndef WG_BEACON_H
+#define WG_BEACON_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "WGAddress.h"
+#include "WGChannelAggregate.h"
+#include "WGPcap.h"
+#include "WGScanIngest.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WG_BEACON_REPLAY_BATCH 256
+
+typedef enum {
+    WGBeaconSecurityOpen = 0,
+    WGBeaconSecurityWEP,
+    WGBeaconSecurityWPA,
+    WGBeaconSecurityWPA2,
+    WGBeaconSecurityWPA3
+} WGBeaconSecurity;
+
+typedef struct {
+    const uint8_t *frame;   // 802.11 header, into the packet
+    uint32_t length;        // Frame length without FCS
+    uint16_t frequency;     // MHz, 0 if not reported
+    int8_t signal;          // dBm antenna signal
+    bool hasSignal;
+    bool badFCS;            // Receiver flagged a failed checksum
+} WGRadiotapInfo;
+
+typedef struct {
+    WGMACAddress bssid;
+    const uint8_t *ssid;    // Into the frame, not NUL-terminated
+    uint8_t ssidLength;     // 0 for hidden (absent, empty or all-NUL)
+    bool probeResponse;     // Otherwise a beacon
+    uint16_t channel;
+    uint16_t channelWidth;  // MHz
+    uint8_t band;           // WGChannelBand
+    uint8_t security;       // WGBeaconSecurity
+    bool hasSignal;
+    int8_t signal;          // dBm
+} WGBeaconInfo;
+
+// Radiotap header (linktype 127); false if truncated or malformed
+bool WGRadiotapParse(const uint8_t *data, size_t length, WGRadiotapInfo *info);
+
+// 802.11 management frame; false unless a well-formed beacon/probe response.
+// Channel, band and signal come from the frame alone (see ParsePacket).
+bool WGBeaconParseFrame(const uint8_t *frame, size_t length, WGBeaconInfo *info);
+
+// One captured packet of reader's link type, radiotap fields merged in
+bool WGBeaconParsePacket(const WGPcapReader *reader, const WGPcapPacket *packet, WGBeaconInfo *info);
+
+// Channel for a centre frequency in MHz; false outside 2.4/5/6 GHz
+bool WGBeaconChannelForFrequency(uint32_t frequency, WGChannelBand *band, uint16_t *channel);
+
+const char *WGBeaconSecurityName(WGBeaconSecurity security);   // "WPA2", "Open", ...
+void WGBeaconToScanRecord(const WGBeaconInfo *info, double timestamp, WGScanRecord *record);
+
+// Receives each batch; returning false stops the replay
+typedef bool (*WGBeaconSinkFn)(void *context, const WGScanRecord *records, size_t count);
+
+typedef struct {
+    size_t batchSize;       // Records per sink call, 0 for WG_BEACON_REPLAY_BATCH
+    double timeShift;       // Added to capture timestamps (0 keeps capture time)
+    const bool *cancel;     // Polled between batches, may be NULL
+} WGBeaconReplayOptions;
+
+typedef struct {
+    uint64_t packets;
+    uint64_t beacons;       // Beacons and probe responses delivered
+    uint64_t skipped;       // Other frames, bad FCS, malformed
+    uint64_t batches;
+    uint64_t bytes;         // Captured bytes read
+    double firstTimestamp;  // Capture time of the first packet
+    double lastTimestamp;
+} WGBeaconReplayStats;
+
+// Streams the rest of reader's capture into sink. Returns false if the
+// sink refused a batch, allocation failed or cancel was raised.
+bool WGBeaconReplay(WGPcapReader *reader, const WGBeaconReplayOptions *options,
+                    WGBeaconSinkFn sink, void *context, WGBeaconReplayStats *stats);
+
+// Sink adaptor for WGBeaconReplay: context is a started WGScanIngest
+bool WGBeaconIngestSink(void *context, const WGScanRecord *records, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WG_BEACON_H */
@@ -0,0 +1,302 @@
+/*
+ * WGChannelAggregate.c - Incremental Channel Statistics Implementation
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * PASSIVE ANALYSIS ONLY - No active attacks implemented
+ */
+
+#include "WGChannelAggregate.h"
+
+#include <string.h>
+
+enum {
+    WGChannelHeapQuiet = 0,
+    WGChannelHeapBusy
+};
+
+#define WG_CHANNEL_SPAN_MAX 16
+
+#pragma mark - Slots
+
+int WGChannelSlotIndex(WGChannelBand band, long channel) {
+    switch (band) {
+        case WGChannelBand2GHz:
+            return (channel >= 1 && channel <= WG_CHANNEL_SLOTS_2GHZ) ? (int)(channel - 1) : -1;
+        case WGChannelBand5GHz:
+            return (channel >= 1 && channel <= WG_CHANNEL_SLOTS_5GHZ) ?
+                (int)(WG_CHANNEL_SLOTS_2GHZ + channel - 1) : -1;
+        case WGChannelBand6GHz:
+            return (channel >= 1 && channel <= WG_CHANNEL_SLOTS_6GHZ) ?
+                (int)(WG_CHANNEL_SLOTS_2GHZ + WG_CHANNEL_SLOTS_5GHZ + channel - 1) : -1;
+    }
+    return -1;
+}
+
+void WGChannelSlotChannel(int slot, WGChannelBand *band, uint16_t *channel) {
+    if (slot < WG_CHANNEL_SLOTS_2GHZ) {
+        *band = WGChannelBand2GHz;
+        *channel = (uint16_t)(slot + 1);
+    } else if (slot < WG_CHANNEL_SLOTS_2GHZ + WG_CHANNEL_SLOTS_5GHZ) {
+        *band = WGChannelBand5GHz;
+        *channel = (uint16_t)(slot - WG_CHANNEL_SLOTS_2GHZ + 1);
+    } else {
+        *band = WGChannelBand6GHz;
+        *channel = (uint16_t)(slot - WG_CHANNEL_SLOTS_2GHZ - WG_CHANNEL_SLOTS_5GHZ + 1);
+    }
+}
+
+WGChannelBand WGChannelBandForChannel(long channel) {
+    return (channel >= 1 && channel <= WG_CHANNEL_SLOTS_2GHZ) ? WGChannelBand2GHz : WGChannelBand5GHz;
+}
+
+WGChannelPlacement WGChannelPlacementMake(WGChannelBand band, long channel, long width, long rssi) {
+    WGChannelPlacement placement;
+    memset(&placement, 0, sizeof(placement));
+
+    // Unknown widths fall back to 20 MHz; 2.4 GHz tops out at 40 MHz
+    long maxWidth = band == WGChannelBand2GHz ? 40 : (band == WGChannelBand5GHz ? 160 : 320);
+    uint16_t normalised = 20;
+    while (normalised * 2 <= width && normalised * 2 <= maxWidth) {
+        normalised *= 2;
+    }
+
+    placement.band = (uint8_t)band;
+    placement.channel = (uint16_t)(channel > 0 && channel <= UINT16_MAX ? channel : 0);
+    placement.width = normalised;
+    placement.rssi = (int16_t)(rssi < INT16_MIN ? INT16_MIN : (rssi > INT16_MAX ? INT16_MAX : rssi));
+    placement.valid = WGChannelSlotIndex(band, channel) >= 0;
+    return placement;
+}
+
+size_t WGChannelSpan(const WGChannelPlacement *placement, uint16_t *channels, size_t max) {
+    if (!placement->valid || max == 0) {
+        return 0;
+    }
+    long c = placement->channel;
+    size_t count = 0;
+
+    if (placement->band == WGChannelBand2GHz) {
+        // 5 MHz spacing: any 20 MHz channel whose span intersects the signal
+        long reach = (placement->width / 2 + 10 - 1) / 5;
+        for (long k = c - reach; k <= c + reach && count < max; k++) {
+            if (k >= 1 && k <= 13) {
+                channels[count++] = (uint16_t)k;
+            } else if (k == c) {
+                channels[count++] = (uint16_t)k;    // Channel 14
+            }
+        }
+        return count;
+    }
+
+    // 5/6 GHz bonding uses aligned blocks of 20 MHz channels, 4 numbers apart
+    long base = placement->band == WGChannelBand6GHz ? 1 : (c >= 149 ? 149 : 36);
+    long limit = placement->band == WGChannelBand6GHz ? WG_CHANNEL_SLOTS_6GHZ : WG_CHANNEL_SLOTS_5GHZ;
+    long n = placement->width / 20;
+    if (c < base || (c - base) % 4 != 0) {
+        channels[count++] = (uint16_t)c;
+        return count;
+    }
+    long start = base + ((c - base) / (4 * n)) * 4 * n;
+    for (long i = 0; i < n && count < max; i++) {
+        long k = start + i * 4;
+        if (k <= limit) {
+            channels[count++] = (uint16_t)k;
+        }
+    }
+    return count;
+}
+
+double WGChannelSlotAverageRSSI(const WGChannelSlot *slot) {
+    return slot->networkCount ? (double)slot->rssiSum / slot->networkCount : -100.0;
+}
+
+uint8_t WGChannelSlotCongestion(const WGChannelSlot *slot) {
+    // Primary networks weigh 15, overlapping neighbours about half that;
+    // strong signals indicate close/overlapping networks
+    uint64_t congestion = (uint64_t)slot->networkCount * 15 + (uint64_t)slot->overlapCount * 7;
+    if (slot->networkCount && slot->rssiSum > -50 * (int64_t)slot->networkCount) {
+        congestion += 20;
+    }
+    return (uint8_t)(congestion > 100 ? 100 : congestion);
+}
+
+#pragma mark - Heaps
+
+static bool WGChannelHeapBefore(const WGChannelAggregate *aggregate, int heap, uint16_t a, uint16_t b) {
+    const WGChannelSlot *sa = &aggregate->slots[a];
+    const WGChannelSlot *sb = &aggregate->slots[b];
+    if (heap == WGChannelHeapQuiet) {
+        uint8_t ca = WGChannelSlotCongestion(sa);
+        uint8_t cb = WGChannelSlotCongestion(sb);
+        if (ca != cb) {
+            return ca < cb;
+        }
+    } else if (sa->networkCount != sb->networkCount) {
+        return sa->networkCount > sb->networkCount;
+    }
+    return a < b;
+}
+
+static WGChannelHeap *WGChannelHeapAt(WGChannelAggregate *aggregate, int heap) {
+    return heap == WGChannelHeapQuiet ? &aggregate->quiet : &aggregate->busy;
+}
+
+static void WGChannelHeapPlace(WGChannelAggregate *aggregate, int heap, int pos, uint16_t slot) {
+    WGChannelHeapAt(aggregate, heap)->items[pos] = slot;
+    aggregate->slots[slot].heapPos[heap] = (int16_t)pos;
+}
+
+static void WGChannelHeapSift(WGChannelAggregate *aggregate, int heap, int pos) {
+    WGChannelHeap *h = WGChannelHeapAt(aggregate, heap);
+    uint16_t slot = h->items[pos];
+
+    while (pos > 0) {
+        int parent = (pos - 1) / 2;
+        if (!WGChannelHeapBefore(aggregate, heap, slot, h->items[parent])) {
+            break;
+        }
+        WGChannelHeapPlace(aggregate, heap, pos, h->items[parent]);
+        pos = parent;
+    }
+    for (;;) {
+        int child = pos * 2 + 1;
+        if (child >= h->count) {
+            break;
+        }
+        if (child + 1 < h->count && WGChannelHeapBefore(aggregate, heap, h->items[child + 1], h->items[child])) {
+            child++;
+        }
+        if (!WGChannelHeapBefore(aggregate, heap, h->items[child], slot)) {
+            break;
+        }
+        WGChannelHeapPlace(aggregate, heap, pos, h->items[child]);
+        pos = child;
+    }
+    WGChannelHeapPlace(aggregate, heap, pos, slot);
+}
+
+static void WGChannelHeapUpdate(WGChannelAggregate *aggregate, int heap, uint16_t slot) {
+    WGChannelHeap *h = WGChannelHeapAt(aggregate, heap);
+    WGChannelSlot *s = &aggregate->slots[slot];
+    bool occupied = WGChannelSlotOccupied(s);
+
+    if (s->heapPos[heap] < 0) {
+        if (occupied) {
+            WGChannelHeapPlace(aggregate, heap, h->count++, slot);
+            WGChannelHeapSift(aggregate, heap, h->count - 1);
+        }
+    } else if (!occupied) {
+        int pos = s->heapPos[heap];
+        s->heapPos[heap] = -1;
+        if (pos != --h->count) {
+            WGChannelHeapPlace(aggregate, heap, pos, h->items[h->count]);
+            WGChannelHeapSift(aggregate, heap, pos);
+        }
+    } else {
+        WGChannelHeapSift(aggregate, heap, s->heapPos[heap]);
+    }
+}
+
+static void WGChannelAggregateRefresh(WGChannelAggregate *aggregate, int slot) {
+    WGChannelHeapUpdate(aggregate, WGChannelHeapQuiet, (uint16_t)slot);
+    WGChannelHeapUpdate(aggregate, WGChannelHeapBusy, (uint16_t)slot);
+}
+
+#pragma mark - Updates
+
+void WGChannelAggregateInit(WGChannelAggregate *aggregate) {
+    memset(aggregate, 0, sizeof(*aggregate));
+    for (int i = 0; i < WG_CHANNEL_SLOT_COUNT; i++) {
+        aggregate->slots[i].heapPos[0] = -1;
+        aggregate->slots[i].heapPos[1] = -1;
+    }
+}
+
+static void WGChannelAggregateApply(WGChannelAggregate *aggregate, const WGChannelPlacement *placement, int sign) {
+    if (!placement->valid) {
+        return;
+    }
+    WGChannelBand band = (WGChannelBand)placement->band;
+    int primary = WGChannelSlotIndex(band, placement->channel);
+    WGChannelSlot *slot = &aggregate->slots[primary];
+    slot->networkCount += (uint32_t)sign;
+    slot->rssiSum += sign * placement->rssi;
+    aggregate->networkCount += (uint32_t)sign;
+    WGChannelAggregateRefresh(aggregate, primary);
+
+    uint16_t span[WG_CHANNEL_SPAN_MAX];
+    size_t spanCount = WGChannelSpan(placement, span, WG_CHANNEL_SPAN_MAX);
+    for (size_t i = 0; i < spanCount; i++) {
+        if (span[i] == placement->channel) {
+            continue;
+        }
+        int index = WGChannelSlotIndex(band, span[i]);
+        aggregate->slots[index].overlapCount += (uint32_t)sign;
+        WGChannelAggregateRefresh(aggregate, index);
+    }
+}
+
+void WGChannelAggregateAdd(WGChannelAggregate *aggregate, const WGChannelPlacement *placement) {
+    WGChannelAggregateApply(aggregate, placement, 1);
+}
+
+void WGChannelAggregateRemove(WGChannelAggregate *aggregate, const WGChannelPlacement *placement) {
+    WGChannelAggregateApply(aggregate, placement, -1);
+}
+
+void WGChannelAggregateMove(WGChannelAggregate *aggregate, const WGChannelPlacement *from,
+                            const WGChannelPlacement *to) {
+    // Common case: only the RSSI moved, so only the primary slot changes
+    if (from->valid && to->valid && from->band == to->band &&
+        from->channel == to->channel && from->width == to->width) {
+        if (from->rssi != to->rssi) {
+            int primary = WGChannelSlotIndex((WGChannelBand)to->band, to->channel);
+            aggregate->slots[primary].rssiSum += to->rssi - from->rssi;
+            WGChannelAggregateRefresh(aggregate, primary);
+        }
+        return;
+    }
+    WGChannelAggregateRemove(aggregate, from);
+    WGChannelAggregateAdd(aggregate, to);
+}
+
+#pragma mark - Queries
+
+size_t WGChannelAggregateLeastCongested(const WGChannelAggregate *aggregate, uint16_t *slots, size_t max) {
+    const WGChannelHeap *h = &aggregate->quiet;
+
+    // Best-first walk of the heap: the next best is always a child of one
+    // already taken, so only about 2 * max entries are compared
+    int frontier[64];
+    size_t frontierCount = 0;
+    size_t found = 0;
+    if (h->count > 0) {
+        frontier[frontierCount++] = 0;
+    }
+    while (found < max && frontierCount > 0) {
+        size_t best = 0;
+        for (size_t i = 1; i < frontierCount; i++) {
+            if (WGChannelHeapBefore(aggregate, WGChannelHeapQuiet,
+                                    h->items[frontier[i]], h->items[frontier[best]])) {
+                best = i;
+            }
+        }
+        int pos = frontier[best];
+        frontier[best] = frontier[--frontierCount];
+        slots[found++] = h->items[pos];
+
+        for (int child = pos * 2 + 1; child <= pos * 2 + 2; child++) {
+            if (child < h->count && frontierCount < sizeof(frontier) / sizeof(frontier[0])) {
+                frontier[frontierCount++] = child;
+            }
+        }
+    }
+    return found;
+}
+
+int WGChannelAggregateMostCrowded(const WGChannelAggregate *aggregate) {
+    if (aggregate->busy.count == 0 || aggregate->slots[aggregate->busy.items[0]].networkCount == 0) {
+        return -1;
+    }
+    return aggregate->busy.items[0];
+}
@@ -0,0 +1,99 @@
+/*
+ * WGChannelAggregate.h - Incremental Channel Statistics
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * Running per-channel sums kept in a fixed array indexed by (band, channel)
+ * for 2.4, 5 and 6 GHz. The scanner adds, moves and removes each network's
+ * placement as scan results arrive, so statistics never need a full
+ * regroup. A network also counts as overlap on every other channel its
+ * channelWidth covers (adjacent 2.4 GHz channels, bonded 5/6 GHz blocks).
+ *
+ * Two indexed heaps over the occupied channels answer "least congested"
+ * and "most crowded" without sorting.
+ */
+
+#ifndef WG_CHANNEL_AGGREGATE_H
+#define WG_CHANNEL_AGGREGATE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    WGChannelBand2GHz = 0,
+    WGChannelBand5GHz,
+    WGChannelBand6GHz
+} WGChannelBand;
+
+// Slot layout: 2.4 GHz 1-14, 5 GHz 1-200, 6 GHz 1-233
+#define WG_CHANNEL_SLOTS_2GHZ 14
+#define WG_CHANNEL_SLOTS_5GHZ 200
+#define WG_CHANNEL_SLOTS_6GHZ 233
+#define WG_CHANNEL_SLOT_COUNT (WG_CHANNEL_SLOTS_2GHZ + WG_CHANNEL_SLOTS_5GHZ + WG_CHANNEL_SLOTS_6GHZ)
+
+// Where one network is counted (copied by the caller, compared on update)
+typedef struct {
+    uint16_t channel;
+    uint16_t width;     // MHz, normalised to 20/40/80/160/320
+    int16_t rssi;       // dBm
+    uint8_t band;       // WGChannelBand
+    bool valid;         // Channel maps to a slot
+} WGChannelPlacement;
+
+typedef struct {
+    uint32_t networkCount;  // Networks whose primary channel this is
+    uint32_t overlapCount;  // Other networks whose width covers it
+    int64_t rssiSum;        // Over primary networks
+    int16_t heapPos[2];     // Position in each heap, -1 if absent
+} WGChannelSlot;
+
+typedef struct {
+    uint16_t items[WG_CHANNEL_SLOT_COUNT];
+    uint16_t count;
+} WGChannelHeap;
+
+typedef struct {
+    WGChannelSlot slots[WG_CHANNEL_SLOT_COUNT];
+    WGChannelHeap quiet;    // Least congested first
+    WGChannelHeap busy;     // Most primary networks first
+    uint32_t networkCount;
+} WGChannelAggregate;
+
+void WGChannelAggregateInit(WGChannelAggregate *aggregate);
+
+// Placement helpers. Band inference treats 1-14 as 2.4 GHz and anything
+// else as 5 GHz; 6 GHz must come from the scan record.
+WGChannelBand WGChannelBandForChannel(long channel);
+WGChannelPlacement WGChannelPlacementMake(WGChannelBand band, long channel, long width, long rssi);
+int WGChannelSlotIndex(WGChannelBand band, long channel);   // -1 if out of range
+void WGChannelSlotChannel(int slot, WGChannelBand *band, uint16_t *channel);
+
+// Channels covered by a placement, primary included; returns the count
+size_t WGChannelSpan(const WGChannelPlacement *placement, uint16_t *channels, size_t max);
+
+// Updates - invalid placements are ignored
+void WGChannelAggregateAdd(WGChannelAggregate *aggregate, const WGChannelPlacement *placement);
+void WGChannelAggregateRemove(WGChannelAggregate *aggregate, const WGChannelPlacement *placement);
+void WGChannelAggregateMove(WGChannelAggregate *aggregate, const WGChannelPlacement *from,
+                            const WGChannelPlacement *to);
+
+// Per-slot figures
+static inline bool WGChannelSlotOccupied(const WGChannelSlot *slot) {
+    return slot->networkCount > 0 || slot->overlapCount > 0;
+}
+double WGChannelSlotAverageRSSI(const WGChannelSlot *slot);   // -100 with no primary networks
+uint8_t WGChannelSlotCongestion(const WGChannelSlot *slot);   // 0-100
+
+// Queries - slot indices, best first
+size_t WGChannelAggregateLeastCongested(const WGChannelAggregate *aggregate, uint16_t *slots, size_t max);
+int WGChannelAggregateMostCrowded(const WGChannelAggregate *aggregate);  // -1 if empty
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WG_CHANNEL_AGGREGATE_H */
@@ -52,10 +52,26 @@ typedef NS_ENUM(NSInteger, WGExportFormat) {
                     password:(nullable NSString *)password
                        error:(NSError **)error;
 
+// Stage latency summaries and counters (see WGMetrics.h)
+- (BOOL)exportMetricsToPath:(NSString *)path
+                     format:(WGExportFormat)format
+                   password:(nullable NSString *)password
+                      error:(NSError **)error;
+
 - (BOOL)exportAllDataToPath:(NSString *)path
                    password:(nullable NSString *)password
                       error:(NSError **)error;
 
+// Binary snapshots (see WGSnapshot.h) - compact, mmap-loadable capture of
+// networks, ARP entries and anomalies, convertible to the CSV/JSON exports
+- (BOOL)exportSnapshotToPath:(NSString *)path error:(NSError **)error;
+
+- (BOOL)convertSnapshotAtPath:(NSString *)snapshotPath
+                  toDirectory:(NSString *)directory
+                       format:(WGExportFormat)format
+                     password:(nullable NSString *)password
+                        error:(NSError **)error;
+
 // Utility
 - (NSString *)defaultExportDirectory;
 - (NSString *)generateFilename:(NSString *)prefix extension:(NSString *)ext;
@@ -8,6 +8,105 @@
 #import "WGARPDetector.h"
 #import "WGAuditLogger.h"
 #import "WGEncryption.h"
+#import "WGExportSession.h"
+#import "WGSnapshot.h"
+#import "WGARPTable.h"
+#import "WGExportText.h"
+#import "WGMetricsReport.h"
+#import "WGNetworkUtils.h"
+
+// Serializers write rows into a WGStreamWriter; nothing holds the whole export
+typedef BOOL (^WGExportBody)(WGStreamWriter *stream);
+
+static BOOL WGStreamWriteNSString(WGStreamWriter *stream, NSString *string) {
+    char buffer[4096];
+    NSRange remaining = NSMakeRange(0, string.length);
+    
+    while (remaining.length > 0) {
+        NSUInteger used = 0;
+        [string getBytes:buffer
+               maxLength:sizeof(buffer)
+              usedLength:&used
+                encoding:NSUTF8StringEncoding
+                 options:0
+                   range:remaining
+          remainingRange:&remaining];
+        if (used == 0 || !WGStreamWriterWrite(stream, buffer, used)) {
+            return NO;
+        }
+    }
+    return YES;
+}
+
+static BOOL WGStreamWriteJSONValue(WGStreamWriter *stream, id value) {
+    NSData *data = [NSJSONSerialization dataWithJSONObject:value
+                                                   options:NSJSONWritingFragmentsAllowed
+                                                     error:nil];
+    return data && WGStreamWriterWrite(stream, data.bytes, data.length);
+}
+
+// Strings borrow from the network's properties; keep it alive while in use
+static void WGExportNetworkFromInfo(WGExportNetwork *network, WGNetworkInfo *info, WGRSSISample *samples) {
+    *network = (WGExportNetwork){
+        .ssid = info.ssid.UTF8String,
+        .bssid = info.bssid.UTF8String,
+        .security = info.securityType.UTF8String,
+        .vendor = WGOUIVendorName([WGNetworkUtils vendorDatabase], info.vendorID),
+        .channel = (long)info.channel,
+        .rssi = (long)info.rssi,
+        .channelWidth = (long)info.channelWidth,
+        .band = info.band,
+        .hidden = info.isHidden,
+        .lastSeen = info.lastSeen.timeIntervalSince1970,
+        .samples = samples,
+        .sampleCount = [info getRSSISamples:samples maxCount:WG_RSSI_HISTORY_CAPACITY]
+    };
+}
+
+#pragma mark - Snapshot Conversion
+
+static NSString * const kWGSecurityNames[] = {
+    [WGSnapshotSecurityUnknown] = @"Unknown",
+    [WGSnapshotSecurityOpen]    = @"Open",
+    [WGSnapshotSecurityWEP]     = @"WEP",
+    [WGSnapshotSecurityWPA]     = @"WPA",
+    [WGSnapshotSecurityWPA2]    = @"WPA2",
+    [WGSnapshotSecurityWPA3]    = @"WPA3",
+};
+
+static uint8_t WGSnapshotSecurityFromString(NSString *name) {
+    for (uint8_t i = 0; i < sizeof(kWGSecurityNames) / sizeof(kWGSecurityNames[0]); i++) {
+        if ([kWGSecurityNames[i] isEqualToString:name]) {
+            return i;
+        }
+    }
+    return WGSnapshotSecurityUnknown;
+}
+
+// Anomalies leave MACs empty when they do not apply; those round-trip as 0
+static NSString *WGSnapshotStringFromMAC(WGMACAddress mac) {
+    if (mac == 0) {
+        return @"";
+    }
+    return WGStringFromMAC(mac);
+}
+
+static NSString *WGSnapshotNSString(const WGSnapshot *snapshot, uint32_t offset) {
+    return [NSString stringWithUTF8String:WGSnapshotString(snapshot, offset)] ?: @"";
+}
+
+static NSError *WGSnapshotNSError(WGSnapshotError snapshotError) {
+    if (snapshotError == WGSnapshotErrorIO) {
+        return [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:nil];
+    }
+    
+    NSString *description = snapshotError == WGSnapshotErrorVersion
+        ? @"Snapshot was written by a newer version"
+        : snapshotError == WGSnapshotErrorMemory ? @"Out of memory" : @"Invalid snapshot file";
+    return [NSError errorWithDomain:@"WGSnapshotError"
+                               code:snapshotError
+                           userInfo:@{NSLocalizedDescriptionKey: description}];
+}
 
 @implementation WGDataExporter
 
@@ -32,61 +131,46 @@
                     password:(NSString *)password
                        error:(NSError **)error {
     
-    NSArray *networks = [self.wifiScanner exportData];
-    
-    NSString *content;
-    if (format == WGExportFormatCSV || format == WGExportFormatEncryptedCSV) {
-        content = [self networksToCSV:networks];
-    } else {
-        content = [self networksToJSON:networks];
-    }
-    
-    return [self writeContent:content 
-                       toPath:path 
-                    encrypted:(format == WGExportFormatEncryptedCSV || format == WGExportFormatEncryptedJSON)
-                     password:password 
-                        error:error];
+    return [self streamToPath:path format:format password:password session:nil error:error
+                         body:[self networksBodyForFormat:format]];
 }
 
-- (NSString *)networksToCSV:(NSArray<NSDictionary *> *)networks {
-    NSMutableString *csv = [NSMutableString string];
-    
-    // Header
-    [csv appendString:@"SSID,BSSID,Channel,RSSI,Channel Width,Security Type,Hidden,Last Seen\n"];
+// Bodies snapshot their data on the calling thread and may run on any other
+- (WGExportBody)networksBodyForFormat:(WGExportFormat)format {
+    NSArray<WGNetworkInfo *> *networks = [self.wifiScanner exportNetworks];
     
-    for (NSDictionary *network in networks) {
-        NSString *ssid = [self escapeCSV:network[@"ssid"]];
-        [csv appendFormat:@"%@,%@,%@,%@,%@,%@,%@,%@\n",
-         ssid,
-         network[@"bssid"],
-         network[@"channel"],
-         network[@"rssi"],
-         network[@"channelWidth"],
-         network[@"securityType"],
-         [network[@"isHidden"] boolValue] ? @"Yes" : @"No",
-         network[@"lastSeen"]];
-    }
-    
-    return csv;
+    return ^BOOL(WGStreamWriter *stream) {
+        if (format == WGExportFormatCSV || format == WGExportFormatEncryptedCSV) {
+            return [self writeNetworksCSV:networks toStream:stream];
+        }
+        return [self writeJSONHeader:@[@[@"exportType", @"WiFiNetworks"],
+                                       @[@"exportedAt", [[NSDate date] description]],
+                                       @[@"networkCount", @(networks.count)]]
+                            itemsKey:@"networks"
+                               items:networks
+                            toStream:stream];
+    };
 }
 
-- (NSString *)networksToJSON:(NSArray<NSDictionary *> *)networks {
-    NSDictionary *export = @{
-        @"exportType": @"WiFiNetworks",
-        @"exportedAt": [[NSDate date] description],
-        @"networkCount": @(networks.count),
-        @"networks": networks
-    };
+- (BOOL)writeNetworksCSV:(NSArray<WGNetworkInfo *> *)networks toStream:(WGStreamWriter *)stream {
+    if (!WGStreamWriterWriteString(stream, WG_EXPORT_NETWORKS_CSV_HEADER)) {
+        return NO;
+    }
     
-    NSError *error;
-    NSData *jsonData = [NSJSONSerialization dataWithJSONObject:export 
-                                                       options:NSJSONWritingPrettyPrinted 
-                                                         error:&error];
-    if (error) {
-        return @"{}";
+    WGExportTimeCache cache;
+    WGExportTimeCacheInit(&cache);
+    WGRSSISample samples[WG_RSSI_HISTORY_CAPACITY];
+    for (WGNetworkInfo *info in networks) {
+        @autoreleasepool {
+            WGExportNetwork network;
+            WGExportNetworkFromInfo(&network, info, samples);
+            if (!WGExportWriteNetworkCSV(stream, &network, &cache)) {
+                return NO;
+            }
+        }
     }
     
-    return [[NSString alloc] initWithData:jsonData encoding:NSUTF8StringEncoding];
+    return YES;
 }
 
 #pragma mark - Export ARP Table
@@ -96,58 +180,49 @@
                     password:(NSString *)password
                        error:(NSError **)error {
     
-    NSArray *entries = [self.arpDetector exportARPTable];
-    
-    NSString *content;
-    if (format == WGExportFormatCSV || format == WGExportFormatEncryptedCSV) {
-        content = [self arpTableToCSV:entries];
-    } else {
-        content = [self arpTableToJSON:entries];
-    }
-    
-    return [self writeContent:content 
-                       toPath:path 
-                    encrypted:(format == WGExportFormatEncryptedCSV || format == WGExportFormatEncryptedJSON)
-                     password:password 
-                        error:error];
+    return [self streamToPath:path format:format password:password session:nil error:error
+                         body:[self arpTableBodyForFormat:format]];
 }
 
-- (NSString *)arpTableToCSV:(NSArray<NSDictionary *> *)entries {
-    NSMutableString *csv = [NSMutableString string];
-    
-    [csv appendString:@"IP Address,MAC Address,Interface,Complete,Permanent,First Seen,Last Seen\n"];
-    
-    for (NSDictionary *entry in entries) {
-        [csv appendFormat:@"%@,%@,%@,%@,%@,%@,%@\n",
-         entry[@"ipAddress"],
-         entry[@"macAddress"],
-         entry[@"interface"],
-         [entry[@"isComplete"] boolValue] ? @"Yes" : @"No",
-         [entry[@"isPermanent"] boolValue] ? @"Yes" : @"No",
-         entry[@"firstSeen"],
-         entry[@"lastSeen"]];
-    }
+- (WGExportBody)arpTableBodyForFormat:(WGExportFormat)format {
+    NSArray *entries = [self.arpDetector exportARPTable];
     
-    return csv;
+    return ^BOOL(WGStreamWriter *stream) {
+        if (format == WGExportFormatCSV || format == WGExportFormatEncryptedCSV) {
+            return [self writeARPTableCSV:entries toStream:stream];
+        }
+        return [self writeJSONHeader:@[@[@"exportType", @"ARPTable"],
+                                       @[@"exportedAt", [[NSDate date] description]],
+                                       @[@"entryCount", @(entries.count)]]
+                            itemsKey:@"entries"
+                               items:entries
+                            toStream:stream];
+    };
 }
 
-- (NSString *)arpTableToJSON:(NSArray<NSDictionary *> *)entries {
-    NSDictionary *export = @{
-        @"exportType": @"ARPTable",
-        @"exportedAt": [[NSDate date] description],
-        @"entryCount": @(entries.count),
-        @"entries": entries
-    };
+- (BOOL)writeARPTableCSV:(NSArray<NSDictionary *> *)entries toStream:(WGStreamWriter *)stream {
+    if (!WGStreamWriterWriteString(stream, "IP Address,MAC Address,Vendor,Interface,Complete,Permanent,First Seen,Last Seen\n")) {
+        return NO;
+    }
     
-    NSError *error;
-    NSData *jsonData = [NSJSONSerialization dataWithJSONObject:export 
-                                                       options:NSJSONWritingPrettyPrinted 
-                                                         error:&error];
-    if (error) {
-        return @"{}";
+    for (NSDictionary *entry in entries) {
+        @autoreleasepool {
+            NSString *row = [NSString stringWithFormat:@"%@,%@,%@,%@,%@,%@,%@,%@\n",
+                             entry[@"ipAddress"],
+                             entry[@"macAddress"],
+                             [self escapeCSV:entry[@"vendor"]],
+                             entry[@"interface"],
+                             [entry[@"isComplete"] boolValue] ? @"Yes" : @"No",
+                             [entry[@"isPermanent"] boolValue] ? @"Yes" : @"No",
+                             entry[@"firstSeen"],
+                             entry[@"lastSeen"]];
+            if (!WGStreamWriteNSString(stream, row)) {
+                return NO;
+            }
+        }
     }
     
-    return [[NSString alloc] initWithData:jsonData encoding:NSUTF8StringEncoding];
+    return YES;
 }
 
 #pragma mark - Export Anomalies
@@ -157,59 +232,50 @@
                      password:(NSString *)password
                         error:(NSError **)error {
     
+    return [self streamToPath:path format:format password:password session:nil error:error
+                         body:[self anomaliesBodyForFormat:format]];
+}
+
+- (WGExportBody)anomaliesBodyForFormat:(WGExportFormat)format {
     NSArray *anomalies = [self.arpDetector exportAnomalies];
     
-    NSString *content;
-    if (format == WGExportFormatCSV || format == WGExportFormatEncryptedCSV) {
-        content = [self anomaliesToCSV:anomalies];
-    } else {
-        content = [self anomaliesToJSON:anomalies];
-    }
-    
-    return [self writeContent:content 
-                       toPath:path 
-                    encrypted:(format == WGExportFormatEncryptedCSV || format == WGExportFormatEncryptedJSON)
-                     password:password 
-                        error:error];
+    return ^BOOL(WGStreamWriter *stream) {
+        if (format == WGExportFormatCSV || format == WGExportFormatEncryptedCSV) {
+            return [self writeAnomaliesCSV:anomalies toStream:stream];
+        }
+        return [self writeJSONHeader:@[@[@"exportType", @"ARPAnomalies"],
+                                       @[@"exportedAt", [[NSDate date] description]],
+                                       @[@"anomalyCount", @(anomalies.count)]]
+                            itemsKey:@"anomalies"
+                               items:anomalies
+                            toStream:stream];
+    };
 }
 
-- (NSString *)anomaliesToCSV:(NSArray<NSDictionary *> *)anomalies {
-    NSMutableString *csv = [NSMutableString string];
-    
-    [csv appendString:@"Detected At,Type,IP Address,Previous MAC,Current MAC,Severity,Details\n"];
+- (BOOL)writeAnomaliesCSV:(NSArray<NSDictionary *> *)anomalies toStream:(WGStreamWriter *)stream {
+    if (!WGStreamWriterWriteString(stream, "Detected At,Type,IP Address,Previous MAC,Current MAC,Vendor,Severity,Details\n")) {
+        return NO;
+    }
     
     for (NSDictionary *anomaly in anomalies) {
-        NSString *details = [self escapeCSV:anomaly[@"details"]];
-        [csv appendFormat:@"%@,%@,%@,%@,%@,%@,%@\n",
-         anomaly[@"detectedAt"],
-         anomaly[@"typeName"],
-         anomaly[@"ipAddress"],
-         anomaly[@"previousMAC"],
-         anomaly[@"currentMAC"],
-         anomaly[@"severity"],
-         details];
-    }
-    
-    return csv;
-}
-
-- (NSString *)anomaliesToJSON:(NSArray<NSDictionary *> *)anomalies {
-    NSDictionary *export = @{
-        @"exportType": @"ARPAnomalies",
-        @"exportedAt": [[NSDate date] description],
-        @"anomalyCount": @(anomalies.count),
-        @"anomalies": anomalies
-    };
-    
-    NSError *error;
-    NSData *jsonData = [NSJSONSerialization dataWithJSONObject:export 
-                                                       options:NSJSONWritingPrettyPrinted 
-                                                         error:&error];
-    if (error) {
-        return @"{}";
+        @autoreleasepool {
+            NSString *details = [self escapeCSV:anomaly[@"details"]];
+            NSString *row = [NSString stringWithFormat:@"%@,%@,%@,%@,%@,%@,%@,%@\n",
+                             anomaly[@"detectedAt"],
+                             anomaly[@"typeName"],
+                             anomaly[@"ipAddress"],
+                             anomaly[@"previousMAC"],
+                             anomaly[@"currentMAC"],
+                             [self escapeCSV:anomaly[@"vendor"]],
+                             anomaly[@"severity"],
+                             details];
+            if (!WGStreamWriteNSString(stream, row)) {
+                return NO;
+            }
+        }
     }
     
-    return [[NSString alloc] initWithData:jsonData encoding:NSUTF8StringEncoding];
+    return YES;
 }
 
 #pragma mark - Export Audit Log
@@ -219,25 +285,159 @@
                     password:(NSString *)password
                        error:(NSError **)error {
     
-    NSString *content;
-    if (format == WGExportFormatCSV || format == WGExportFormatEncryptedCSV) {
-        content = [self.auditLogger generateCSVExport];
-    } else {
-        NSDictionary *jsonDict = [self.auditLogger generateJSONExport];
-        NSData *jsonData = [NSJSONSerialization dataWithJSONObject:jsonDict 
-                                                           options:NSJSONWritingPrettyPrinted 
-                                                             error:error];
-        if (*error) {
+    return [self streamToPath:path format:format password:password session:nil error:error
+                         body:[self auditLogBodyForFormat:format]];
+}
+
+- (WGExportBody)auditLogBodyForFormat:(WGExportFormat)format {
+    // The whole stored history, paged segment by segment from disk as the
+    // stream drains, up to the entries logged before the export began
+    WGAuditQuery *query = [[WGAuditQuery alloc] init];
+    query.until = [NSDate date];
+    query.limit = 512;
+    NSEnumerator<WGAuditLogEntry *> *entries = [self.auditLogger storedEntryEnumeratorForQuery:query];
+    NSString *sessionId = self.auditLogger.sessionId ?: @"";
+    
+    return ^BOOL(WGStreamWriter *stream) {
+        if (format == WGExportFormatCSV || format == WGExportFormatEncryptedCSV) {
+            if (!WGStreamWriterWriteString(stream, "\"Timestamp\",\"Event Type\",\"Details\",\"Session ID\"\n")) {
+                return NO;
+            }
+            for (WGAuditLogEntry *entry in entries) {
+                @autoreleasepool {
+                    if (!WGStreamWriteNSString(stream, [entry toCSVLine]) ||
+                        !WGStreamWriterWriteString(stream, "\n")) {
+                        return NO;
+                    }
+                }
+            }
+            return YES;
+        }
+        
+        return [self writeJSONHeader:@[@[@"sessionId", sessionId],
+                                       @[@"exportedAt", [[NSDate date] description]]]
+                            itemsKey:@"entries"
+                               items:entries
+                            toStream:stream];
+    };
+}
+
+#pragma mark - Export Metrics
+
+- (BOOL)exportMetricsToPath:(NSString *)path
+                     format:(WGExportFormat)format
+                   password:(NSString *)password
+                      error:(NSError **)error {
+    
+    return [self streamToPath:path format:format password:password session:nil error:error
+                         body:[self metricsBodyForFormat:format]];
+}
+
+- (WGExportBody)metricsBodyForFormat:(WGExportFormat)format {
+    NSMutableArray<NSDictionary *> *stages = [NSMutableArray arrayWithCapacity:WGMetricStageCount];
+    for (int stage = 0; stage < WGMetricStageCount; stage++) {
+        NSMutableDictionary *row = [WGMetricsStageReport((WGMetricStage)stage) mutableCopy];
+        row[@"stage"] = @(WGMetricStageName((WGMetricStage)stage));
+        [stages addObject:row];
+    }
+    NSDictionary *counters = WGMetricsReport(nil)[@"counters"];
+    
+    return ^BOOL(WGStreamWriter *stream) {
+        if (format == WGExportFormatCSV || format == WGExportFormatEncryptedCSV) {
+            return [self writeMetricsCSV:stages counters:counters toStream:stream];
+        }
+        return [self writeJSONHeader:@[@[@"exportType", @"Metrics"],
+                                       @[@"exportedAt", [[NSDate date] description]],
+                                       @[@"counters", counters]]
+                            itemsKey:@"stages"
+                               items:stages
+                            toStream:stream];
+    };
+}
+
+// Stage rows, then counter rows with only the count filled in
+- (BOOL)writeMetricsCSV:(NSArray<NSDictionary *> *)stages
+               counters:(NSDictionary<NSString *, NSNumber *> *)counters
+               toStream:(WGStreamWriter *)stream {
+    if (!WGStreamWriterWriteString(stream, "Metric,Count,Mean (us),P50 (us),P90 (us),P99 (us),Max (us)\n")) {
+        return NO;
+    }
+    
+    for (NSDictionary *stage in stages) {
+        NSString *row = [NSString stringWithFormat:@"%@,%@,%.1f,%.1f,%.1f,%.1f,%.1f\n",
+                         stage[@"stage"], stage[@"count"],
+                         [stage[@"meanUs"] doubleValue], [stage[@"p50Us"] doubleValue],
+                         [stage[@"p90Us"] doubleValue], [stage[@"p99Us"] doubleValue],
+                         [stage[@"maxUs"] doubleValue]];
+        if (!WGStreamWriteNSString(stream, row)) {
+            return NO;
+        }
+    }
+    for (NSString *name in [counters.allKeys sortedArrayUsingSelector:@selector(compare:)]) {
+        if (!WGStreamWriteNSString(stream, [NSString stringWithFormat:@"%@,%@,,,,,\n", name, counters[name]])) {
+            return NO;
+        }
+    }
+    
+    return YES;
+}
+
+#pragma mark - JSON Streaming
+
+// Writes {"k": v, ..., "itemsKey": [item, ...]} one item at a time. Items
+// may be dictionaries or objects responding to -toDictionary; networks are
+// serialized directly by WGExportText.
+- (BOOL)writeJSONHeader:(NSArray<NSArray *> *)fields
+               itemsKey:(NSString *)itemsKey
+                  items:(id<NSFastEnumeration>)items
+               toStream:(WGStreamWriter *)stream {
+    
+    if (!WGStreamWriterWriteString(stream, "{\n")) {
+        return NO;
+    }
+    
+    for (NSArray *field in fields) {
+        if (!WGStreamWriterWriteString(stream, "  ") ||
+            !WGStreamWriteJSONValue(stream, field[0]) ||
+            !WGStreamWriterWriteString(stream, " : ") ||
+            !WGStreamWriteJSONValue(stream, field[1]) ||
+            !WGStreamWriterWriteString(stream, ",\n")) {
+            return NO;
+        }
+    }
+    
+    if (!WGStreamWriterWriteString(stream, "  ") ||
+        !WGStreamWriteJSONValue(stream, itemsKey) ||
+        !WGStreamWriterWriteString(stream, " : [\n")) {
+        return NO;
+    }
+    
+    WGExportTimeCache cache;
+    WGExportTimeCacheInit(&cache);
+    WGRSSISample samples[WG_RSSI_HISTORY_CAPACITY];
+    NSUInteger index = 0;
+    for (id item in items) {
+        if ((index++ > 0 && !WGStreamWriterWriteString(stream, ",\n")) ||
+            !WGStreamWriterWriteString(stream, "    ")) {
             return NO;
         }
-        content = [[NSString alloc] initWithData:jsonData encoding:NSUTF8StringEncoding];
+        @autoreleasepool {
+            if ([item isKindOfClass:[WGNetworkInfo class]]) {
+                WGExportNetwork network;
+                WGExportNetworkFromInfo(&network, item, samples);
+                if (!WGExportWriteNetworkJSON(stream, &network, &cache)) {
+                    return NO;
+                }
+                continue;
+            }
+            id object = [item isKindOfClass:[NSDictionary class]] ? item : [item toDictionary];
+            if (!WGStreamWriteJSONValue(stream, object)) {
+                return NO;
+            }
+        }
     }
     
-    return [self writeContent:content 
-                       toPath:path 
-                    encrypted:(format == WGExportFormatEncryptedCSV || format == WGExportFormatEncryptedJSON)
-                     password:password 
-                        error:error];
+    return WGStreamWriterWriteString(stream, "\n  ]\n}\n");
 }
 
 #pragma mark - Export All
@@ -252,62 +452,350 @@
         return NO;
     }
     
-    BOOL encrypted = (password != nil && password.length > 0);
-    WGExportFormat format = encrypted ? WGExportFormatEncryptedJSON : WGExportFormatJSON;
-    NSString *ext = encrypted ? @"json.enc" : @"json";
+    // One PBKDF2 for the whole export; each file gets an HKDF subkey
+    WGExportSession *session = [[WGExportSession alloc] initWithPassword:password error:error];
+    if (!session) {
+        return NO;
+    }
+    
+    WGExportFormat format = session.encrypted ? WGExportFormatEncryptedJSON : WGExportFormatJSON;
+    NSString *ext = session.encrypted ? @"json.enc" : @"json";
+    
+    // Snapshot everything here; the jobs only serialize and encrypt
+    NSArray<NSString *> *names = @[@"networks", @"arp_table", @"anomalies", @"audit_log", @"metrics"];
+    NSArray<WGExportBody> *bodies = @[[self networksBodyForFormat:format],
+                                      [self arpTableBodyForFormat:format],
+                                      [self anomaliesBodyForFormat:format],
+                                      [self auditLogBodyForFormat:format],
+                                      [self metricsBodyForFormat:format]];
+    NSMutableArray<NSString *> *filenames = [NSMutableArray arrayWithCapacity:names.count];
+    for (NSString *name in names) {
+        [filenames addObject:[NSString stringWithFormat:@"%@.%@", name, ext]];
+    }
+    
+    NSMutableArray *errors = [NSMutableArray arrayWithCapacity:names.count];
+    dispatch_apply(names.count, dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^(size_t index) {
+        NSError *jobError = nil;
+        NSString *filePath = [path stringByAppendingPathComponent:filenames[index]];
+        if (![self streamToPath:filePath format:format password:password session:session
+                          error:&jobError body:bodies[index]]) {
+            @synchronized (errors) {
+                [errors addObject:jobError ?: [WGEncryption errorForStreamError:WGStreamErrorIO sysError:0]];
+            }
+        }
+    });
+    
+    // The manifest goes last: an export directory without one is incomplete
+    if (errors.count == 0 && ![self writeManifestForFiles:filenames inDirectory:path
+                                                encrypted:session.encrypted error:error]) {
+        [errors addObject:[NSNull null]];
+    }
     
-    // Export networks
-    NSString *networksPath = [path stringByAppendingPathComponent:
-                              [NSString stringWithFormat:@"networks.%@", ext]];
-    if (![self exportNetworksToPath:networksPath format:format password:password error:error]) {
+    if (errors.count > 0) {
+        for (NSString *filename in filenames) {
+            [fm removeItemAtPath:[path stringByAppendingPathComponent:filename] error:nil];
+        }
+        if (error && [errors.firstObject isKindOfClass:[NSError class]]) {
+            *error = errors.firstObject;
+        }
         return NO;
     }
     
-    // Export ARP table
-    NSString *arpPath = [path stringByAppendingPathComponent:
-                         [NSString stringWithFormat:@"arp_table.%@", ext]];
-    if (![self exportARPTableToPath:arpPath format:format password:password error:error]) {
+    // Log export
+    [self.auditLogger logExport:path];
+    
+    return YES;
+}
+
+- (BOOL)writeManifestForFiles:(NSArray<NSString *> *)filenames
+                  inDirectory:(NSString *)path
+                    encrypted:(BOOL)encrypted
+                        error:(NSError **)error {
+    
+    NSMutableArray *files = [NSMutableArray arrayWithCapacity:filenames.count];
+    for (NSString *filename in filenames) {
+        NSDictionary *attributes = [[NSFileManager defaultManager]
+                                    attributesOfItemAtPath:[path stringByAppendingPathComponent:filename]
+                                    error:error];
+        if (!attributes) {
+            return NO;
+        }
+        [files addObject:@{@"name": filename, @"bytes": @(attributes.fileSize)}];
+    }
+    
+    NSDictionary *manifest = @{@"formatVersion": @2,
+                               @"createdAt": [[NSDate date] description],
+                               @"encrypted": @(encrypted),
+                               @"files": files};
+    
+    return [self streamToPath:[path stringByAppendingPathComponent:@"manifest.json"]
+                       format:WGExportFormatJSON
+                     password:nil
+                      session:nil
+                        error:error
+                         body:^BOOL(WGStreamWriter *stream) {
+        NSData *data = [NSJSONSerialization dataWithJSONObject:manifest
+                                                       options:NSJSONWritingPrettyPrinted
+                                                         error:nil];
+        return data && WGStreamWriterWrite(stream, data.bytes, data.length);
+    }];
+}
+
+#pragma mark - Binary Snapshots
+
+- (BOOL)exportSnapshotToPath:(NSString *)path error:(NSError **)error {
+    WGSnapshotWriter writer;
+    WGSnapshotWriterInit(&writer, [[NSDate date] timeIntervalSince1970]);
+    
+    WGRSSISample samples[WG_RSSI_HISTORY_CAPACITY];
+    double sampleTimes[WG_RSSI_HISTORY_CAPACITY];
+    int8_t sampleRSSI[WG_RSSI_HISTORY_CAPACITY];
+    
+    for (WGNetworkInfo *info in self.wifiScanner.discoveredNetworks) {
+        NSUInteger count = [info getRSSISamples:samples maxCount:WG_RSSI_HISTORY_CAPACITY];
+        for (NSUInteger i = 0; i < count; i++) {
+            sampleTimes[i] = samples[i].timestamp;
+            sampleRSSI[i] = samples[i].rssi;
+        }
+        
+        WGSnapshotNetwork network = {
+            .bssid = info.bssidValue,
+            .lastSeen = info.lastSeen.timeIntervalSince1970,
+            .ssid = info.ssid.UTF8String,
+            .channel = (uint16_t)info.channel,
+            .channelWidth = (uint16_t)info.channelWidth,
+            .rssi = (int8_t)MAX(INT8_MIN, MIN(INT8_MAX, info.rssi)),
+            .security = WGSnapshotSecurityFromString(info.securityType),
+            .flags = info.isHidden ? WGSnapshotNetworkFlagHidden : 0
+        };
+        WGSnapshotWriterAddNetwork(&writer, &network, sampleTimes, sampleRSSI, count);
+    }
+    
+    for (WGARPEntry *entry in self.arpDetector.currentARPTable) {
+        WGSnapshotARPEntry record = {
+            .mac = WGMACFromString(entry.macAddress),
+            .ip = WGIPv4FromString(entry.ipAddress),
+            .flags = (entry.isComplete ? WGARPRecordFlagComplete : 0) |
+                     (entry.isPermanent ? WGARPRecordFlagPermanent : 0),
+            .firstSeen = entry.firstSeen.timeIntervalSince1970,
+            .lastSeen = entry.lastSeen.timeIntervalSince1970,
+            .interface = entry.interface.UTF8String
+        };
+        WGSnapshotWriterAddARPEntry(&writer, &record);
+    }
+    
+    for (WGARPAnomaly *anomaly in self.arpDetector.detectedAnomalies) {
+        WGSnapshotAnomaly record = {
+            .previousMAC = WGMACFromString(anomaly.previousMAC),
+            .currentMAC = WGMACFromString(anomaly.currentMAC),
+            .ip = WGIPv4FromString(anomaly.ipAddress),
+            .type = (uint8_t)anomaly.type,
+            .severity = (uint8_t)anomaly.severity,
+            .detectedAt = anomaly.detectedAt.timeIntervalSince1970,
+            .details = anomaly.details.UTF8String
+        };
+        WGSnapshotWriterAddAnomaly(&writer, &record);
+    }
+    
+    NSString *temporaryPath = nil;
+    int fd = [WGEncryption openStreamingOutput:path temporaryPath:&temporaryPath error:error];
+    if (fd < 0) {
+        WGSnapshotWriterFree(&writer);
         return NO;
     }
     
-    // Export anomalies
-    NSString *anomaliesPath = [path stringByAppendingPathComponent:
-                               [NSString stringWithFormat:@"anomalies.%@", ext]];
-    if (![self exportAnomaliesLoPath:anomaliesPath format:format password:password error:error]) {
+    WGSnapshotError snapshotError = WGSnapshotWriterWriteFD(&writer, fd);
+    if (snapshotError != WGSnapshotErrorNone && error) {
+        *error = WGSnapshotNSError(snapshotError);
+    }
+    WGSnapshotWriterFree(&writer);
+    
+    return [WGEncryption finishStreamingOutput:fd
+                                 temporaryPath:temporaryPath
+                                        toPath:path
+                                       success:snapshotError == WGSnapshotErrorNone
+                                         error:error];
+}
+
+- (BOOL)convertSnapshotAtPath:(NSString *)snapshotPath
+                  toDirectory:(NSString *)directory
+                       format:(WGExportFormat)format
+                     password:(NSString *)password
+                        error:(NSError **)error {
+    
+    if (![[NSFileManager defaultManager] createDirectoryAtPath:directory
+                                   withIntermediateDirectories:YES
+                                                    attributes:nil
+                                                         error:error]) {
         return NO;
     }
     
-    // Export audit log
-    NSString *auditPath = [path stringByAppendingPathComponent:
-                           [NSString stringWithFormat:@"audit_log.%@", ext]];
-    if (![self exportAuditLogToPath:auditPath format:format password:password error:error]) {
+    WGSnapshot snapshot;
+    WGSnapshotError snapshotError = WGSnapshotOpen(&snapshot, snapshotPath.fileSystemRepresentation);
+    if (snapshotError != WGSnapshotErrorNone) {
+        if (error) {
+            *error = WGSnapshotNSError(snapshotError);
+        }
         return NO;
     }
     
-    // Log export
-    [self.auditLogger logExport:path];
+    // Rebuild the model objects so the files match live exports exactly
+    NSMutableArray *networks = [NSMutableArray arrayWithCapacity:snapshot.networks.count];
+    WGRSSISample samples[WG_RSSI_HISTORY_CAPACITY];
+    for (size_t i = 0; i < snapshot.networks.count; i++) {
+        @autoreleasepool {
+            WGNetworkInfo *info = [[WGNetworkInfo alloc] init];
+            const WGSnapshotNetworks *columns = &snapshot.networks;
+            uint8_t security = columns->security[i];
+            
+            info.ssid = columns->ssid[i] ? WGSnapshotNSString(&snapshot, columns->ssid[i]) : nil;
+            info.bssid = WGSnapshotStringFromMAC(columns->bssid[i]);
+            info.channel = columns->channel[i];
+            info.channelWidth = columns->channelWidth[i];
+            info.rssi = columns->rssi[i];
+            info.securityType = security <= WGSnapshotSecurityWPA3 ? kWGSecurityNames[security] : @"Unknown";
+            info.isHidden = (columns->flags[i] & WGSnapshotNetworkFlagHidden) != 0;
+            info.lastSeen = [NSDate dateWithTimeIntervalSince1970:columns->lastSeen[i]];
+            
+            const double *times;
+            const int8_t *rssi;
+            size_t count = MIN(WGSnapshotNetworkSamples(&snapshot, i, &times, &rssi), WG_RSSI_HISTORY_CAPACITY);
+            for (size_t k = 0; k < count; k++) {
+                samples[k] = (WGRSSISample){ .timestamp = times[k], .rssi = rssi[k] };
+            }
+            [info setRSSISamples:samples count:count];
+            
+            [networks addObject:info];
+        }
+    }
+    
+    NSMutableArray *entries = [NSMutableArray arrayWithCapacity:snapshot.arp.count];
+    for (size_t i = 0; i < snapshot.arp.count; i++) {
+        @autoreleasepool {
+            WGARPEntry *entry = [[WGARPEntry alloc] init];
+            entry.ipAddress = WGStringFromIPv4(snapshot.arp.ip[i]);
+            entry.macAddress = WGSnapshotStringFromMAC(snapshot.arp.mac[i]);
+            entry.interface = WGSnapshotNSString(&snapshot, snapshot.arp.interface[i]);
+            entry.isComplete = (snapshot.arp.flags[i] & WGARPRecordFlagComplete) != 0;
+            entry.isPermanent = (snapshot.arp.flags[i] & WGARPRecordFlagPermanent) != 0;
+            entry.firstSeen = [NSDate dateWithTimeIntervalSince1970:snapshot.arp.firstSeen[i]];
+            entry.lastSeen = [NSDate dateWithTimeIntervalSince1970:snapshot.arp.lastSeen[i]];
+            entry.macHistory = [NSMutableArray array];
+            [entries addObject:[entry toDictionary]];
+        }
+    }
+    
+    NSMutableArray *anomalies = [NSMutableArray arrayWithCapacity:snapshot.anomalies.count];
+    for (size_t i = 0; i < snapshot.anomalies.count; i++) {
+        @autoreleasepool {
+            WGARPAnomaly *anomaly = [[WGARPAnomaly alloc] init];
+            anomaly.type = snapshot.anomalies.type[i];
+            anomaly.ipAddress = WGStringFromIPv4(snapshot.anomalies.ip[i]);
+            anomaly.previousMAC = WGSnapshotStringFromMAC(snapshot.anomalies.previousMAC[i]);
+            anomaly.currentMAC = WGSnapshotStringFromMAC(snapshot.anomalies.currentMAC[i]);
+            anomaly.details = WGSnapshotNSString(&snapshot, snapshot.anomalies.details[i]);
+            anomaly.severity = snapshot.anomalies.severity[i];
+            anomaly.detectedAt = [NSDate dateWithTimeIntervalSince1970:snapshot.anomalies.detectedAt[i]];
+            [anomalies addObject:[anomaly toDictionary]];
+        }
+    }
+    
+    WGSnapshotClose(&snapshot);
+    
+    BOOL csv = (format == WGExportFormatCSV || format == WGExportFormatEncryptedCSV);
+    BOOL encrypted = (format == WGExportFormatEncryptedCSV || format == WGExportFormatEncryptedJSON) &&
+                     password.length > 0;
+    NSString *ext = [NSString stringWithFormat:@"%@%@", csv ? @"csv" : @"json", encrypted ? @".enc" : @""];
+    WGExportSession *session = nil;
+    if (encrypted && !(session = [[WGExportSession alloc] initWithPassword:password error:error])) {
+        return NO;
+    }
+    NSString *exportedAt = [[NSDate date] description];
+    
+    NSArray<WGExportBody> *bodies = @[
+        ^BOOL(WGStreamWriter *stream) {
+            return csv ? [self writeNetworksCSV:networks toStream:stream]
+                       : [self writeJSONHeader:@[@[@"exportType", @"WiFiNetworks"],
+                                                 @[@"exportedAt", exportedAt],
+                                                 @[@"networkCount", @(networks.count)]]
+                                      itemsKey:@"networks" items:networks toStream:stream];
+        },
+        ^BOOL(WGStreamWriter *stream) {
+            return csv ? [self writeARPTableCSV:entries toStream:stream]
+                       : [self writeJSONHeader:@[@[@"exportType", @"ARPTable"],
+                                                 @[@"exportedAt", exportedAt],
+                                                 @[@"entryCount", @(entries.count)]]
+                                      itemsKey:@"entries" items:entries toStream:stream];
+        },
+        ^BOOL(WGStreamWriter *stream) {
+            return csv ? [self writeAnomaliesCSV:anomalies toStream:stream]
+                       : [self writeJSONHeader:@[@[@"exportType", @"ARPAnomalies"],
+                                                 @[@"exportedAt", exportedAt],
+                                                 @[@"anomalyCount", @(anomalies.count)]]
+                                      itemsKey:@"anomalies" items:anomalies toStream:stream];
+        }
+    ];
+    NSArray<NSString *> *names = @[@"networks", @"arp_table", @"anomalies"];
+    
+    for (NSUInteger i = 0; i < names.count; i++) {
+        NSString *filePath = [directory stringByAppendingPathComponent:
+                              [NSString stringWithFormat:@"%@.%@", names[i], ext]];
+        if (![self streamToPath:filePath format:format password:password session:session
+                          error:error body:bodies[i]]) {
+            return NO;
+        }
+    }
     
     return YES;
 }
 
 #pragma mark - Utility Methods
 
-- (BOOL)writeContent:(NSString *)content 
-              toPath:(NSString *)path 
-           encrypted:(BOOL)encrypted
+- (BOOL)streamToPath:(NSString *)path
+              format:(WGExportFormat)format
             password:(NSString *)password
-               error:(NSError **)error {
+             session:(WGExportSession *)session
+               error:(NSError **)error
+                body:(WGExportBody)body {
     
-    NSData *data = [content dataUsingEncoding:NSUTF8StringEncoding];
+    BOOL encrypted = (format == WGExportFormatEncryptedCSV || format == WGExportFormatEncryptedJSON) &&
+                     password.length > 0;
     
-    if (encrypted && password.length > 0) {
-        data = [WGEncryption encryptData:data withPassword:password error:error];
-        if (!data) {
-            return NO;
+    NSString *temporaryPath = nil;
+    int fd = [WGEncryption openStreamingOutput:path temporaryPath:&temporaryPath error:error];
+    if (fd < 0) {
+        return NO;
+    }
+    
+    WGStreamWriter stream;
+    BOOL opened;
+    if (session) {
+        opened = [session openStream:&stream fileDescriptor:fd];
+    } else {
+        NSData *passwordData = encrypted ? [password dataUsingEncoding:NSUTF8StringEncoding] : nil;
+        opened = WGStreamWriterOpen(&stream, fd, passwordData ? passwordData.bytes : NULL, passwordData.length);
+    }
+    // Serialization time is the body's, less the chunks it flushed
+    uint64_t start = WGMetricsNow();
+    uint64_t flushedNs = stream.encryptNs + stream.writeNs;
+    BOOL ok = opened && body(&stream);
+    uint64_t serializeNs = WGMetricsNow() - start - (stream.encryptNs + stream.writeNs - flushedNs);
+    ok = ok && WGStreamWriterFinish(&stream);
+    
+    if (ok) {
+        WGMetricsRecord(WGMetricStageExportSerialize, serializeNs);
+        if (stream.encrypted) {
+            WGMetricsRecord(WGMetricStageExportEncrypt, stream.encryptNs);
         }
+        WGMetricsRecord(WGMetricStageExportWrite, stream.writeNs);
+        WGMetricsAdd(WGMetricCounterExportBytes, stream.bytesOut);
+    }
+    if (!ok && error) {
+        *error = [WGEncryption errorForStreamError:stream.error sysError:stream.sysError];
     }
+    WGStreamWriterFree(&stream);
     
-    return [data writeToFile:path options:NSDataWritingAtomic error:error];
+    return [WGEncryption finishStreamingOutput:fd temporaryPath:temporaryPath toPath:path success:ok error:error];
 }
 
 - (NSString *)escapeCSV:(NSString *)value {
@@ -0,0 +1,28 @@
+/*
+ * WGExportSession.h - Export Key Session
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * Stretches the export password once (PBKDF2, 100000 rounds) and opens
+ * every file of a multi-file export under that master key; each file gets
+ * its own HKDF subkey and IV. Safe to share between concurrent writers.
+ */
+
+#import <Foundation/Foundation.h>
+#import "WGCryptoStream.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface WGExportSession : NSObject
+
+@property (nonatomic, readonly) BOOL encrypted;
+
+// A nil or empty password makes a plaintext session
+- (nullable instancetype)initWithPassword:(nullable NSString *)password error:(NSError **)error;
+- (instancetype)init NS_UNAVAILABLE;
+
+// Opens stream on fd; on failure stream->error is set and it must still be freed
+- (BOOL)openStream:(WGStreamWriter *)stream fileDescriptor:(int)fd;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,40 @@
+/*
+ * WGExportSession.m - Export Key Session Implementation
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ */
+
+#import "WGExportSession.h"
+#import "WGEncryption.h"
+
+@implementation WGExportSession {
+    WGStreamMasterKey _masterKey;
+}
+
+- (instancetype)initWithPassword:(NSString *)password error:(NSError **)error {
+    self = [super init];
+    if (self) {
+        _encrypted = password.length > 0;
+        if (_encrypted) {
+            NSData *passwordData = [password dataUsingEncoding:NSUTF8StringEncoding];
+            if (!WGStreamMasterKeyDerive(&_masterKey, passwordData.bytes, passwordData.length)) {
+                if (error) {
+                    *error = [WGEncryption errorForStreamError:WGStreamErrorCrypto sysError:0];
+                }
+                return nil;
+            }
+        }
+    }
+    return self;
+}
+
+- (void)dealloc {
+    WGStreamMasterKeyWipe(&_masterKey);
+}
+
+- (BOOL)openStream:(WGStreamWriter *)stream fileDescriptor:(int)fd {
+    // The key is only read after init, so no locking is needed
+    return _encrypted ? WGStreamWriterOpenWithMasterKey(stream, fd, &_masterKey)
+                      : WGStreamWriterOpen(stream, fd, NULL, 0);
+}
+
+@end
@@ -0,0 +1,214 @@
+/*
+ * WGExportText.c - CSV / JSON Row Serialization Implementation
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ */
+
+#include "WGExportText.h"
+
+#include <math.h>
+#include <string.h>
+#include <time.h>
+
+#pragma mark - Time
+
+void WGExportTimeCacheInit(WGExportTimeCache *cache) {
+    memset(cache, 0, sizeof(*cache));
+    cache->localSecond = INT64_MIN;
+    cache->utcSecond = INT64_MIN;
+    cache->utcDayStart = 0;
+}
+
+static const char *WGExportLocalTime(WGExportTimeCache *cache, double timestamp) {
+    int64_t second = (int64_t)floor(timestamp);
+    if (second != cache->localSecond) {
+        time_t t = (time_t)second;
+        struct tm tm;
+        localtime_r(&t, &tm);
+        strftime(cache->local, sizeof(cache->local), "%Y-%m-%d %H:%M:%S", &tm);
+        cache->localSecond = second;
+    }
+    return cache->local;
+}
+
+// RSSI series step by seconds, so within one day only the time is rewritten
+static const char *WGExportUTCTime(WGExportTimeCache *cache, double timestamp) {
+    int64_t second = (int64_t)floor(timestamp);
+    if (second == cache->utcSecond) {
+        return cache->utc;
+    }
+
+    int64_t ofDay = second - cache->utcDayStart;
+    if (cache->utcSecond != INT64_MIN && ofDay >= 0 && ofDay < 86400) {
+        int fields[3] = { (int)ofDay / 3600, (int)ofDay / 60 % 60, (int)ofDay % 60 };
+        for (int i = 0; i < 3; i++) {
+            cache->utc[11 + 3 * i] = (char)('0' + fields[i] / 10);
+            cache->utc[12 + 3 * i] = (char)('0' + fields[i] % 10);
+        }
+    } else {
+        time_t t = (time_t)second;
+        struct tm tm;
+        gmtime_r(&t, &tm);
+        strftime(cache->utc, sizeof(cache->utc), "%Y-%m-%d %H:%M:%S +0000", &tm);
+        cache->utcDayStart = second - (tm.tm_hour * 3600 + tm.tm_min * 60 + tm.tm_sec);
+    }
+    cache->utcSecond = second;
+    return cache->utc;
+}
+
+#pragma mark - Primitives
+
+static inline bool WGExportPut(WGStreamWriter *stream, const char *string) {
+    return WGStreamWriterWrite(stream, string, strlen(string));
+}
+
+static bool WGExportPutLong(WGStreamWriter *stream, long value) {
+    char digits[24];
+    char *end = digits + sizeof(digits);
+    char *p = end;
+    unsigned long magnitude = value < 0 ? 0ul - (unsigned long)value : (unsigned long)value;
+    do {
+        *--p = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+    if (value < 0) {
+        *--p = '-';
+    }
+    return WGStreamWriterWrite(stream, p, (size_t)(end - p));
+}
+
+bool WGExportWriteCSVField(WGStreamWriter *stream, const char *value) {
+    if (!value) {
+        return true;
+    }
+    if (!strpbrk(value, ",\"\n")) {
+        return WGExportPut(stream, value);
+    }
+
+    // Quoted; copy runs between quotes and double each quote
+    if (!WGStreamWriterWrite(stream, "\"", 1)) {
+        return false;
+    }
+    const char *run = value;
+    for (const char *quote; (quote = strchr(run, '"')); run = quote + 1) {
+        if (!WGStreamWriterWrite(stream, run, (size_t)(quote - run)) ||
+            !WGStreamWriterWrite(stream, "\"\"", 2)) {
+            return false;
+        }
+    }
+    return WGExportPut(stream, run) && WGStreamWriterWrite(stream, "\"", 1);
+}
+
+bool WGExportWriteJSONString(WGStreamWriter *stream, const char *value) {
+    static const char hex[] = "0123456789abcdef";
+
+    if (!WGStreamWriterWrite(stream, "\"", 1)) {
+        return false;
+    }
+    const char *run = value;
+    const char *p = value;
+    for (; *p; p++) {
+        unsigned char c = (unsigned char)*p;
+        if (c >= 0x20 && c != '"' && c != '\\' && c != '/') {
+            continue;
+        }
+
+        char escape[6] = { '\\', 0 };
+        size_t length = 2;
+        switch (c) {
+            case '"':  escape[1] = '"';  break;
+            case '\\': escape[1] = '\\'; break;
+            case '/':  escape[1] = '/';  break;
+            case '\b': escape[1] = 'b';  break;
+            case '\f': escape[1] = 'f';  break;
+            case '\n': escape[1] = 'n';  break;
+            case '\r': escape[1] = 'r';  break;
+            case '\t': escape[1] = 't';  break;
+            default:
+                memcpy(escape, "\\u00", 4);
+                escape[4] = hex[c >> 4];
+                escape[5] = hex[c & 0x0f];
+                length = 6;
+                break;
+        }
+        if (!WGStreamWriterWrite(stream, run, (size_t)(p - run)) ||
+            !WGStreamWriterWrite(stream, escape, length)) {
+            return false;
+        }
+        run = p + 1;
+    }
+    return WGStreamWriterWrite(stream, run, (size_t)(p - run)) &&
+           WGStreamWriterWrite(stream, "\"", 1);
+}
+
+#pragma mark - Networks
+
+bool WGExportWriteNetworkCSV(WGStreamWriter *stream, const WGExportNetwork *network, WGExportTimeCache *cache) {
+    return WGExportWriteCSVField(stream, network->ssid ? network->ssid : "<Hidden>") &&
+           WGStreamWriterWrite(stream, ",", 1) &&
+           WGExportPut(stream, network->bssid ? network->bssid : "Unknown") &&
+           WGStreamWriterWrite(stream, ",", 1) &&
+           WGExportPutLong(stream, network->channel) &&
+           WGStreamWriterWrite(stream, ",", 1) &&
+           WGExportPutLong(stream, network->rssi) &&
+           WGStreamWriterWrite(stream, ",", 1) &&
+           WGExportPutLong(stream, network->channelWidth) &&
+           WGStreamWriterWrite(stream, ",", 1) &&
+           WGExportPut(stream, network->security ? network->security : "Unknown") &&
+           WGExportPut(stream, network->hidden ? ",Yes," : ",No,") &&
+           WGExportPut(stream, WGExportLocalTime(cache, network->lastSeen)) &&
+           WGStreamWriterWrite(stream, ",", 1) &&
+           WGExportWriteCSVField(stream, network->vendor ? network->vendor : "") &&
+           WGStreamWriterWrite(stream, "\n", 1);
+}
+
+bool WGExportWriteNetworkJSON(WGStreamWriter *stream, const WGExportNetwork *network, WGExportTimeCache *cache) {
+    bool ok = WGExportPut(stream, "{\"ssid\":") &&
+              WGExportWriteJSONString(stream, network->ssid ? network->ssid : "<Hidden>") &&
+              WGExportPut(stream, ",\"bssid\":") &&
+              WGExportWriteJSONString(stream, network->bssid ? network->bssid : "Unknown") &&
+              WGExportPut(stream, ",\"channel\":") &&
+              WGExportPutLong(stream, network->channel) &&
+              WGExportPut(stream, ",\"rssi\":") &&
+              WGExportPutLong(stream, network->rssi) &&
+              WGExportPut(stream, ",\"channelWidth\":") &&
+              WGExportPutLong(stream, network->channelWidth) &&
+              WGExportPut(stream, ",\"band\":") &&
+              WGExportPutLong(stream, network->band) &&
+              WGExportPut(stream, ",\"securityType\":") &&
+              WGExportWriteJSONString(stream, network->security ? network->security : "Unknown") &&
+              WGExportPut(stream, ",\"vendor\":") &&
+              WGExportWriteJSONString(stream, network->vendor ? network->vendor : "") &&
+              WGExportPut(stream, network->hidden ? ",\"isHidden\":true" : ",\"isHidden\":false") &&
+              WGExportPut(stream, ",\"lastSeen\":\"") &&
+              WGExportPut(stream, WGExportLocalTime(cache, network->lastSeen)) &&
+              WGExportPut(stream, "\",\"rssiHistory\":[");
+
+    // Series are assembled per element and written in one call each
+    for (size_t i = 0; ok && i < network->sampleCount; i++) {
+        char element[8];
+        char *end = element + sizeof(element);
+        char *p = end;
+        int rssi = network->samples[i].rssi;
+        unsigned magnitude = rssi < 0 ? 0u - (unsigned)rssi : (unsigned)rssi;
+        do {
+            *--p = (char)('0' + magnitude % 10);
+            magnitude /= 10;
+        } while (magnitude > 0);
+        if (rssi < 0) {
+            *--p = '-';
+        }
+        if (i > 0) {
+            *--p = ',';
+        }
+        ok = WGStreamWriterWrite(stream, p, (size_t)(end - p));
+    }
+    ok = ok && WGExportPut(stream, "],\"rssiTimestamps\":[");
+    for (size_t i = 0; ok && i < network->sampleCount; i++) {
+        char element[2 + sizeof(cache->utc)] = ",\"";
+        memcpy(element + 2, WGExportUTCTime(cache, network->samples[i].timestamp), sizeof(cache->utc) - 1);
+        element[sizeof(element) - 1] = '"';
+        ok = i == 0 ? WGStreamWriterWrite(stream, element + 1, sizeof(element) - 1)
+                    : WGStreamWriterWrite(stream, element, sizeof(element));
+    }
+    return ok && WGExportPut(stream, "]}");
+}
@@ -0,0 +1,68 @@
+/*
+ * WGExportText.h - CSV / JSON Row Serialization
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * Writes network rows for WGDataExporter straight into a WGStreamWriter:
+ * escaping is done in place on the UTF-8 bytes and timestamps come from a
+ * per-second cache, so a row costs no allocation and no date formatter.
+ * Output matches the Foundation serializers it replaces (CSV quoting of
+ * escapeCSV:, NSJSONSerialization escaping, NSDate descriptions).
+ */
+
+#ifndef WG_EXPORT_TEXT_H
+#define WG_EXPORT_TEXT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "WGCryptoStream.h"
+#include "WGScanIngest.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WG_EXPORT_NETWORKS_CSV_HEADER "SSID,BSSID,Channel,RSSI,Channel Width,Security Type,Hidden,Last Seen,Vendor\n"
+
+// One network as exported; strings are NUL-terminated UTF-8
+typedef struct {
+    const char *ssid;           // NULL for hidden ("<Hidden>")
+    const char *bssid;          // NULL reads "Unknown"
+    const char *security;       // NULL reads "Unknown"
+    const char *vendor;         // NULL or "" if unknown
+    long channel;
+    long rssi;
+    long channelWidth;
+    int band;                   // WGChannelBand
+    bool hidden;
+    double lastSeen;            // Seconds since 1970
+    const WGRSSISample *samples;
+    size_t sampleCount;
+} WGExportNetwork;
+
+// Formatted seconds, refreshed only when the second changes
+typedef struct {
+    int64_t localSecond;
+    char local[20];             // "yyyy-MM-dd HH:mm:ss", local time
+    int64_t utcSecond;
+    int64_t utcDayStart;        // First second of utc's day
+    char utc[26];               // "yyyy-MM-dd HH:mm:ss +0000" (NSDate description)
+} WGExportTimeCache;
+
+void WGExportTimeCacheInit(WGExportTimeCache *cache);
+
+// Escaping. CSV quotes fields holding ',', '"' or '\n' and doubles quotes;
+// JSON escapes like NSJSONSerialization (including "\/").
+bool WGExportWriteCSVField(WGStreamWriter *stream, const char *value);
+bool WGExportWriteJSONString(WGStreamWriter *stream, const char *value);
+
+// Rows - CSV ends with '\n'; JSON is one compact object with no separator
+bool WGExportWriteNetworkCSV(WGStreamWriter *stream, const WGExportNetwork *network, WGExportTimeCache *cache);
+bool WGExportWriteNetworkJSON(WGStreamWriter *stream, const WGExportNetwork *network, WGExportTimeCache *cache);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WG_EXPORT_TEXT_H */
@@ -0,0 +1,827 @@
+/*
+ * WGLogStore.c - Segmented Audit Log Store Implementation
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ */
+
+#include "WGLogStore.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define WG_LOG_SEGMENT_MAGIC    "WGLS"
+#define WG_LOG_INDEX_MAGIC      "WGLI"
+#define WG_LOG_SEGMENT_HEADER   16      // magic, u32 version, u64 base time
+#define WG_LOG_INDEX_HEADER     48      // magic, u32 version, bytes, records, first, last, count
+#define WG_LOG_RECORD_HEADER    8       // u32 payload length, u32 checksum
+#define WG_LOG_READ_CHUNK       (64 * 1024)
+#define WG_LOG_PATH_MAX         1024
+
+#pragma mark - Encoding
+
+static void WGLogPut32(uint8_t *p, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        p[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static void WGLogPut64(uint8_t *p, uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+        p[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static uint32_t WGLogGet32(const uint8_t *p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static uint64_t WGLogGet64(const uint8_t *p) {
+    return (uint64_t)WGLogGet32(p) | (uint64_t)WGLogGet32(p + 4) << 32;
+}
+
+static size_t WGLogPutVarint(uint8_t *p, uint64_t value) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        p[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    p[n++] = (uint8_t)value;
+    return n;
+}
+
+// Returns false when the varint runs past end
+static bool WGLogGetVarint(const uint8_t **p, const uint8_t *end, uint64_t *value) {
+    uint64_t result = 0;
+    for (int shift = 0; shift < 64 && *p < end; shift += 7) {
+        uint8_t byte = *(*p)++;
+        result |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint32_t WGLogChecksum(const uint8_t *data, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// Longest prefix of string that fits in room without splitting a UTF-8
+// sequence
+static size_t WGLogFitUTF8(const char *string, size_t length, size_t room) {
+    if (length <= room) {
+        return length;
+    }
+    while (room > 0 && ((uint8_t)string[room] & 0xC0) == 0x80) {
+        room--;
+    }
+    return room;
+}
+
+// Encodes header + payload into out; returns the total length
+static size_t WGLogRecordEncode(const WGLogRecord *record, uint64_t baseTime, uint8_t *out) {
+    const char *type = record->eventType ? record->eventType : "";
+    const char *details = record->details ? record->details : "";
+    const char *session = record->sessionId ? record->sessionId : "";
+    size_t typeLength = record->eventType ? record->eventTypeLength : 0;
+    size_t sessionLength = record->sessionId ? record->sessionIdLength : 0;
+
+    // Everything but details is short; cap those two and give details the rest
+    size_t fixed = WG_LOG_RECORD_HEADER + 10 + 1 + 3 * 10;
+    typeLength = WGLogFitUTF8(type, typeLength, 256);
+    sessionLength = WGLogFitUTF8(session, sessionLength, 256);
+    size_t detailsLength = WGLogFitUTF8(details, record->details ? record->detailsLength : 0,
+                                        WG_LOG_STORE_MAX_RECORD - fixed - typeLength - sessionLength);
+
+    uint8_t *p = out + WG_LOG_RECORD_HEADER;
+    p += WGLogPutVarint(p, record->time - baseTime);
+    *p++ = (uint8_t)(record->severity < 0 ? 0 : record->severity > 255 ? 255 : record->severity);
+    p += WGLogPutVarint(p, typeLength);
+    memcpy(p, type, typeLength);
+    p += typeLength;
+    p += WGLogPutVarint(p, detailsLength);
+    memcpy(p, details, detailsLength);
+    p += detailsLength;
+    p += WGLogPutVarint(p, sessionLength);
+    memcpy(p, session, sessionLength);
+    p += sessionLength;
+
+    size_t payload = (size_t)(p - out) - WG_LOG_RECORD_HEADER;
+    WGLogPut32(out, (uint32_t)payload);
+    WGLogPut32(out + 4, WGLogChecksum(out + WG_LOG_RECORD_HEADER, payload));
+    return (size_t)(p - out);
+}
+
+static bool WGLogGetString(const uint8_t **p, const uint8_t *end, const char **string, size_t *length) {
+    uint64_t n;
+    if (!WGLogGetVarint(p, end, &n) || n > (uint64_t)(end - *p)) {
+        return false;
+    }
+    *string = (const char *)*p;
+    *length = (size_t)n;
+    *p += n;
+    return true;
+}
+
+static bool WGLogRecordDecode(const uint8_t *payload, size_t length, uint64_t baseTime, WGLogRecord *record) {
+    const uint8_t *p = payload;
+    const uint8_t *end = payload + length;
+    uint64_t offset;
+    if (!WGLogGetVarint(&p, end, &offset) || p == end) {
+        return false;
+    }
+    record->time = baseTime + offset;
+    record->severity = *p++;
+    return WGLogGetString(&p, end, &record->eventType, &record->eventTypeLength) &&
+           WGLogGetString(&p, end, &record->details, &record->detailsLength) &&
+           WGLogGetString(&p, end, &record->sessionId, &record->sessionIdLength) &&
+           p == end;
+}
+
+#pragma mark - Files
+
+static void WGLogSegmentPath(const WGLogStore *store, uint64_t id, const char *extension,
+                             char path[WG_LOG_PATH_MAX]) {
+    snprintf(path, WG_LOG_PATH_MAX, "%s/%016" PRIx64 ".%s", store->directory, id, extension);
+}
+
+static bool WGLogWriteFully(int fd, const uint8_t *data, size_t length) {
+    while (length > 0) {
+        ssize_t n = write(fd, data, length);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        length -= (size_t)n;
+    }
+    return true;
+}
+
+static bool WGLogReadFully(int fd, uint8_t *data, size_t length, uint64_t offset) {
+    while (length > 0) {
+        ssize_t n = pread(fd, data, length, (off_t)offset);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        length -= (size_t)n;
+        offset += (uint64_t)n;
+    }
+    return true;
+}
+
+#pragma mark - Segments
+
+static WGLogSegment *WGLogStoreActive(WGLogStore *store) {
+    return store->writing ? &store->segments[store->segmentCount - 1] : NULL;
+}
+
+static bool WGLogSegmentAddIndex(WGLogSegment *segment, uint64_t time, uint64_t offset) {
+    if (segment->indexCount == segment->indexCapacity) {
+        size_t capacity = segment->indexCapacity ? segment->indexCapacity * 2 : 16;
+        WGLogIndexEntry *index = realloc(segment->index, capacity * sizeof(WGLogIndexEntry));
+        if (!index) {
+            return false;
+        }
+        segment->index = index;
+        segment->indexCapacity = capacity;
+    }
+    segment->index[segment->indexCount++] = (WGLogIndexEntry){ time, offset };
+    return true;
+}
+
+// Records a record at offset in the segment's metadata and sparse index.
+// A failed index entry only makes seeks into this stretch scan further.
+static void WGLogSegmentNoteRecord(const WGLogStore *store, WGLogSegment *segment, uint64_t time,
+                                   uint64_t offset) {
+    if (segment->records == 0) {
+        segment->firstTime = time;
+    }
+    segment->lastTime = time;
+    segment->records++;
+
+    size_t count = segment->indexCount;
+    if (count == 0 || offset >= segment->index[count - 1].offset + store->config.indexInterval) {
+        WGLogSegmentAddIndex(segment, time, offset);
+    }
+}
+
+static WGLogSegment *WGLogStoreAddSegment(WGLogStore *store, uint64_t id) {
+    if (store->segmentCount == store->segmentCapacity) {
+        size_t capacity = store->segmentCapacity ? store->segmentCapacity * 2 : 16;
+        WGLogSegment *segments = realloc(store->segments, capacity * sizeof(WGLogSegment));
+        if (!segments) {
+            return NULL;
+        }
+        store->segments = segments;
+        store->segmentCapacity = capacity;
+    }
+    WGLogSegment *segment = &store->segments[store->segmentCount++];
+    *segment = (WGLogSegment){ .id = id, .bytes = WG_LOG_SEGMENT_HEADER };
+    if (id >= store->nextId) {
+        store->nextId = id + 1;
+    }
+    return segment;
+}
+
+// Index files are rebuildable, so they are written without fsync
+static void WGLogSegmentWriteIndex(const WGLogStore *store, const WGLogSegment *segment) {
+    size_t length = WG_LOG_INDEX_HEADER + segment->indexCount * 16;
+    uint8_t *data = malloc(length);
+    if (!data) {
+        return;
+    }
+    memcpy(data, WG_LOG_INDEX_MAGIC, 4);
+    WGLogPut32(data + 4, WG_LOG_STORE_VERSION);
+    WGLogPut64(data + 8, segment->bytes);
+    WGLogPut64(data + 16, segment->records);
+    WGLogPut64(data + 24, segment->firstTime);
+    WGLogPut64(data + 32, segment->lastTime);
+    WGLogPut64(data + 40, segment->indexCount);
+    for (size_t i = 0; i < segment->indexCount; i++) {
+        WGLogPut64(data + WG_LOG_INDEX_HEADER + i * 16, segment->index[i].time);
+        WGLogPut64(data + WG_LOG_INDEX_HEADER + i * 16 + 8, segment->index[i].offset);
+    }
+
+    char path[WG_LOG_PATH_MAX];
+    char temporary[WG_LOG_PATH_MAX];
+    WGLogSegmentPath(store, segment->id, "wgi", path);
+    WGLogSegmentPath(store, segment->id, "wgi.tmp", temporary);
+    int fd = open(temporary, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd >= 0) {
+        bool written = WGLogWriteFully(fd, data, length);
+        close(fd);
+        if (!written || rename(temporary, path) < 0) {
+            unlink(temporary);
+        }
+    }
+    free(data);
+}
+
+// Loads a sealed segment's index file if it matches the segment's length
+static bool WGLogSegmentReadIndex(const WGLogStore *store, WGLogSegment *segment) {
+    char path[WG_LOG_PATH_MAX];
+    WGLogSegmentPath(store, segment->id, "wgi", path);
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    uint8_t header[WG_LOG_INDEX_HEADER];
+    bool loaded = false;
+    if (WGLogReadFully(fd, header, sizeof(header), 0) && memcmp(header, WG_LOG_INDEX_MAGIC, 4) == 0 &&
+        WGLogGet32(header + 4) == WG_LOG_STORE_VERSION && WGLogGet64(header + 8) == segment->bytes) {
+        uint64_t count = WGLogGet64(header + 40);
+        uint8_t *entries = count <= segment->bytes / 16 + 1 ? malloc(count * 16 + 1) : NULL;
+        if (entries && WGLogReadFully(fd, entries, (size_t)count * 16, WG_LOG_INDEX_HEADER)) {
+            segment->records = WGLogGet64(header + 16);
+            segment->firstTime = WGLogGet64(header + 24);
+            segment->lastTime = WGLogGet64(header + 32);
+            loaded = true;
+            for (size_t i = 0; i < count && loaded; i++) {
+                loaded = WGLogSegmentAddIndex(segment, WGLogGet64(entries + i * 16),
+                                              WGLogGet64(entries + i * 16 + 8));
+            }
+        }
+        free(entries);
+    }
+    close(fd);
+    if (!loaded) {
+        segment->indexCount = 0;
+    }
+    return loaded;
+}
+
+#pragma mark - Reading
+
+static void WGLogStoreCloseRead(WGLogStore *store) {
+    if (store->readFd >= 0) {
+        close(store->readFd);
+    }
+    store->readFd = -1;
+    store->readSegment = 0;
+    store->readLength = 0;
+}
+
+// Returns length bytes of the segment at offset through the read window,
+// or NULL if the file is shorter
+static const uint8_t *WGLogStoreFetch(WGLogStore *store, uint64_t id, uint64_t offset, size_t length) {
+    if (store->readSegment != id || store->readFd < 0) {
+        WGLogStoreCloseRead(store);
+        char path[WG_LOG_PATH_MAX];
+        WGLogSegmentPath(store, id, "wgl", path);
+        store->readFd = open(path, O_RDONLY | O_CLOEXEC);
+        if (store->readFd < 0) {
+            return NULL;
+        }
+        store->readSegment = id;
+    }
+    if (offset >= store->readStart && offset + length <= store->readStart + store->readLength) {
+        return store->readBuffer + (offset - store->readStart);
+    }
+
+    size_t capacity = length > WG_LOG_READ_CHUNK ? length : WG_LOG_READ_CHUNK;
+    if (store->readCapacity < capacity) {
+        uint8_t *buffer = realloc(store->readBuffer, capacity);
+        if (!buffer) {
+            return NULL;
+        }
+        store->readBuffer = buffer;
+        store->readCapacity = capacity;
+    }
+
+    // Active segments grow, so a short read is retried on the next fetch
+    store->readStart = offset;
+    store->readLength = 0;
+    while (store->readLength < store->readCapacity) {
+        ssize_t n = pread(store->readFd, store->readBuffer + store->readLength,
+                          store->readCapacity - store->readLength, (off_t)(offset + store->readLength));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        store->readLength += (size_t)n;
+    }
+    return store->readLength >= length ? store->readBuffer : NULL;
+}
+
+// Decodes the record at offset if it lies within limit and checks out;
+// returns the offset after it, or 0
+static uint64_t WGLogStoreReadRecord(WGLogStore *store, uint64_t id, uint64_t baseTime, uint64_t offset,
+                                     uint64_t limit, WGLogRecord *record) {
+    if (offset + WG_LOG_RECORD_HEADER > limit) {
+        return 0;
+    }
+    const uint8_t *header = WGLogStoreFetch(store, id, offset, WG_LOG_RECORD_HEADER);
+    if (!header) {
+        return 0;
+    }
+    uint32_t length = WGLogGet32(header);
+    uint32_t checksum = WGLogGet32(header + 4);
+    uint64_t end = offset + WG_LOG_RECORD_HEADER + length;
+    if (length > WG_LOG_STORE_MAX_RECORD || end > limit) {
+        return 0;
+    }
+
+    const uint8_t *data = WGLogStoreFetch(store, id, offset, WG_LOG_RECORD_HEADER + length);
+    if (!data) {
+        return 0;
+    }
+    const uint8_t *payload = data + WG_LOG_RECORD_HEADER;
+    if (WGLogChecksum(payload, length) != checksum || !WGLogRecordDecode(payload, length, baseTime, record)) {
+        return 0;
+    }
+    return end;
+}
+
+// Base time from the segment header (records store offsets from it)
+static bool WGLogStoreReadBase(WGLogStore *store, uint64_t id, uint64_t *baseTime) {
+    const uint8_t *header = WGLogStoreFetch(store, id, 0, WG_LOG_SEGMENT_HEADER);
+    if (!header || memcmp(header, WG_LOG_SEGMENT_MAGIC, 4) != 0 ||
+        WGLogGet32(header + 4) != WG_LOG_STORE_VERSION) {
+        return false;
+    }
+    *baseTime = WGLogGet64(header + 8);
+    return true;
+}
+
+#pragma mark - Recovery
+
+// Rebuilds a segment's metadata and index by scanning it, truncating a
+// torn or corrupt tail; false if the file is not a usable segment
+static bool WGLogSegmentScan(WGLogStore *store, WGLogSegment *segment, uint64_t fileLength) {
+    uint64_t baseTime;
+    if (!WGLogStoreReadBase(store, segment->id, &baseTime)) {
+        return false;
+    }
+
+    segment->records = 0;
+    segment->indexCount = 0;
+    uint64_t offset = WG_LOG_SEGMENT_HEADER;
+    WGLogRecord record;
+    for (uint64_t next; (next = WGLogStoreReadRecord(store, segment->id, baseTime, offset, fileLength,
+                                                     &record)) != 0; offset = next) {
+        WGLogSegmentNoteRecord(store, segment, record.time, offset);
+    }
+    segment->bytes = offset;
+
+    if (offset < fileLength) {
+        char path[WG_LOG_PATH_MAX];
+        WGLogSegmentPath(store, segment->id, "wgl", path);
+        WGLogStoreCloseRead(store);
+        if (truncate(path, (off_t)offset) < 0) {
+            return false;
+        }
+    }
+    WGLogSegmentWriteIndex(store, segment);
+    return true;
+}
+
+static int WGLogCompareSegments(const void *a, const void *b) {
+    uint64_t x = ((const WGLogSegment *)a)->id;
+    uint64_t y = ((const WGLogSegment *)b)->id;
+    return (x > y) - (x < y);
+}
+
+// "<16 hex>.wgl"
+static bool WGLogParseSegmentName(const char *name, uint64_t *id) {
+    if (strlen(name) != 20 || strcmp(name + 16, ".wgl") != 0) {
+        return false;
+    }
+    uint64_t value = 0;
+    for (int i = 0; i < 16; i++) {
+        char c = name[i];
+        int digit = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+        if (digit < 0) {
+            return false;
+        }
+        value = value << 4 | (uint64_t)digit;
+    }
+    *id = value;
+    return value != 0;
+}
+
+static void WGLogStoreUnlinkSegment(const WGLogStore *store, uint64_t id) {
+    char path[WG_LOG_PATH_MAX];
+    WGLogSegmentPath(store, id, "wgl", path);
+    unlink(path);
+    WGLogSegmentPath(store, id, "wgi", path);
+    unlink(path);
+}
+
+static bool WGLogStoreLoad(WGLogStore *store) {
+    DIR *dir = opendir(store->directory);
+    if (!dir) {
+        return false;
+    }
+    for (struct dirent *entry; (entry = readdir(dir)) != NULL;) {
+        uint64_t id;
+        if (WGLogParseSegmentName(entry->d_name, &id) && !WGLogStoreAddSegment(store, id)) {
+            closedir(dir);
+            return false;
+        }
+    }
+    closedir(dir);
+    if (store->segmentCount == 0) {
+        return true;
+    }
+    qsort(store->segments, store->segmentCount, sizeof(WGLogSegment), WGLogCompareSegments);
+
+    // Keep segments that load; unusable files are left alone but their ids
+    // are still never reused
+    size_t kept = 0;
+    for (size_t i = 0; i < store->segmentCount; i++) {
+        WGLogSegment segment = store->segments[i];
+        char path[WG_LOG_PATH_MAX];
+        struct stat info;
+        WGLogSegmentPath(store, segment.id, "wgl", path);
+        bool usable = stat(path, &info) == 0 && info.st_size >= WG_LOG_SEGMENT_HEADER;
+        if (usable) {
+            segment.bytes = (uint64_t)info.st_size;
+            usable = WGLogSegmentReadIndex(store, &segment) ||
+                     WGLogSegmentScan(store, &segment, segment.bytes);
+        }
+        if (usable && segment.records == 0) {
+            WGLogStoreUnlinkSegment(store, segment.id);     // Crashed before its first commit
+            usable = false;
+        }
+        if (!usable) {
+            free(segment.index);
+            continue;
+        }
+        store->lastTime = segment.lastTime > store->lastTime ? segment.lastTime : store->lastTime;
+        store->totalBytes += segment.bytes;
+        store->segments[kept++] = segment;
+    }
+    store->segmentCount = kept;
+    WGLogStoreCloseRead(store);
+    return true;
+}
+
+#pragma mark - Lifecycle
+
+WGLogStoreConfig WGLogStoreConfigDefault(void) {
+    WGLogStoreConfig config = {
+        .maxSegmentBytes = 4 * 1024 * 1024,
+        .maxSegmentAge = 24ull * 3600 * 1000000,
+        .retainBytes = 64 * 1024 * 1024,
+        .retainAge = 90ull * 24 * 3600 * 1000000,
+        .indexInterval = 4096
+    };
+    return config;
+}
+
+bool WGLogStoreOpen(WGLogStore *store, const char *directory, WGLogStoreConfig config,
+                    WGLogCommitPolicy policy) {
+    memset(store, 0, sizeof(*store));
+    store->readFd = -1;
+    store->nextId = 1;
+    store->config = config;
+    store->policy = policy;
+    if (store->config.indexInterval == 0) {
+        store->config.indexInterval = 4096;
+    }
+    store->stats.startNs = WGLogMonotonicNs();
+    store->directory = strdup(directory);
+    store->record = malloc(WG_LOG_STORE_MAX_RECORD);
+    if (!store->directory || !store->record || !WGLogStoreLoad(store)) {
+        WGLogStoreClose(store);
+        return false;
+    }
+    return true;
+}
+
+// Commits and closes the active segment and writes its index
+static void WGLogStoreSeal(WGLogStore *store) {
+    WGLogSegment *segment = WGLogStoreActive(store);
+    if (!segment) {
+        return;
+    }
+    WGLogWriterClose(&store->writer);
+    store->stats = store->writer.stats;
+    store->writing = false;
+
+    // A partial write leaves the file shorter than recorded; trust the file
+    struct stat info;
+    char path[WG_LOG_PATH_MAX];
+    WGLogSegmentPath(store, segment->id, "wgl", path);
+    if (stat(path, &info) == 0 && (uint64_t)info.st_size != segment->bytes) {
+        store->totalBytes -= segment->bytes;
+        WGLogSegmentScan(store, segment, (uint64_t)info.st_size);
+        store->totalBytes += segment->bytes;
+    } else {
+        WGLogSegmentWriteIndex(store, segment);
+    }
+}
+
+void WGLogStoreClose(WGLogStore *store) {
+    WGLogStoreSeal(store);
+    WGLogStoreCloseRead(store);
+    for (size_t i = 0; i < store->segmentCount; i++) {
+        free(store->segments[i].index);
+    }
+    free(store->segments);
+    free(store->readBuffer);
+    free(store->record);
+    free(store->directory);
+    store->segments = NULL;
+    store->readBuffer = NULL;
+    store->record = NULL;
+    store->directory = NULL;
+    store->segmentCount = store->segmentCapacity = store->readCapacity = 0;
+}
+
+WGLogWriterStats WGLogStoreStats(const WGLogStore *store) {
+    return store->writing ? store->writer.stats : store->stats;
+}
+
+#pragma mark - Writing
+
+static bool WGLogStoreStartSegment(WGLogStore *store, uint64_t baseTime) {
+    uint64_t id = store->nextId;
+    char path[WG_LOG_PATH_MAX];
+    WGLogSegmentPath(store, id, "wgl", path);
+    int fd = open(path, O_WRONLY | O_CREAT | O_EXCL | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        store->nextId++;    // Skip an id someone else holds
+        return false;
+    }
+
+    uint8_t header[WG_LOG_SEGMENT_HEADER];
+    memcpy(header, WG_LOG_SEGMENT_MAGIC, 4);
+    WGLogPut32(header + 4, WG_LOG_STORE_VERSION);
+    WGLogPut64(header + 8, baseTime);
+    if (!WGLogWriteFully(fd, header, sizeof(header)) || !WGLogStoreAddSegment(store, id)) {
+        close(fd);
+        unlink(path);
+        return false;
+    }
+    if (!WGLogWriterOpen(&store->writer, fd, 64 * 1024, store->policy)) {
+        WGLogWriterClose(&store->writer);
+        unlink(path);
+        store->segmentCount--;
+        return false;
+    }
+    store->writer.stats = store->stats;
+    store->totalBytes += WG_LOG_SEGMENT_HEADER;
+    store->writing = true;
+    return true;
+}
+
+bool WGLogStoreAppend(WGLogStore *store, const WGLogRecord *record) {
+    WGLogRecord stamped = *record;
+    if (stamped.time < store->lastTime) {
+        stamped.time = store->lastTime;
+    }
+
+    WGLogSegment *active = WGLogStoreActive(store);
+    if (active && (active->bytes >= store->config.maxSegmentBytes ||
+                   (store->config.maxSegmentAge && stamped.time - active->firstTime >= store->config.maxSegmentAge))) {
+        WGLogStoreSeal(store);
+        WGLogStoreEnforceRetention(store, stamped.time);
+        active = NULL;
+    }
+    if (!active) {
+        if (!WGLogStoreStartSegment(store, stamped.time)) {
+            store->stats.errors++;
+            return false;
+        }
+        active = WGLogStoreActive(store);
+    }
+
+    // Base time is the segment's first record, so offsets stay small
+    uint64_t baseTime = active->records ? active->firstTime : stamped.time;
+    size_t length = WGLogRecordEncode(&stamped, baseTime, store->record);
+    store->writer.policy = store->policy;
+    bool commitNow = WGLogWriterAppendRecord(&store->writer, store->record, length, stamped.severity);
+
+    WGLogSegmentNoteRecord(store, active, stamped.time, active->bytes);
+    active->bytes += length;
+    store->totalBytes += length;
+    store->lastTime = stamped.time;
+    return commitNow;
+}
+
+bool WGLogStoreCommit(WGLogStore *store) {
+    return !store->writing || WGLogWriterCommit(&store->writer);
+}
+
+#pragma mark - Retention
+
+static void WGLogStoreDropOldest(WGLogStore *store) {
+    WGLogSegment *segment = &store->segments[0];
+    if (store->readSegment == segment->id) {
+        WGLogStoreCloseRead(store);
+    }
+    WGLogStoreUnlinkSegment(store, segment->id);
+    store->totalBytes -= segment->bytes;
+    free(segment->index);
+    memmove(store->segments, store->segments + 1, (store->segmentCount - 1) * sizeof(WGLogSegment));
+    store->segmentCount--;
+}
+
+static size_t WGLogStoreSealedCount(const WGLogStore *store) {
+    return store->segmentCount - (store->writing ? 1 : 0);
+}
+
+size_t WGLogStoreDropBefore(WGLogStore *store, uint64_t time) {
+    size_t dropped = 0;
+    while (WGLogStoreSealedCount(store) > 0 && store->segments[0].lastTime < time) {
+        WGLogStoreDropOldest(store);
+        dropped++;
+    }
+    return dropped;
+}
+
+size_t WGLogStoreEnforceRetention(WGLogStore *store, uint64_t now) {
+    size_t dropped = 0;
+    if (store->config.retainAge && now > store->config.retainAge) {
+        dropped = WGLogStoreDropBefore(store, now - store->config.retainAge);
+    }
+    while (store->config.retainBytes && store->totalBytes > store->config.retainBytes &&
+           WGLogStoreSealedCount(store) > 0) {
+        WGLogStoreDropOldest(store);
+        dropped++;
+    }
+    return dropped;
+}
+
+size_t WGLogStoreDropAll(WGLogStore *store) {
+    WGLogStoreSeal(store);
+    size_t dropped = store->segmentCount;
+    while (store->segmentCount > 0) {
+        WGLogStoreDropOldest(store);
+    }
+    return dropped;
+}
+
+#pragma mark - Queries
+
+// First segment whose id is >= id, or segmentCount
+static size_t WGLogStoreSegmentFrom(const WGLogStore *store, uint64_t id) {
+    size_t low = 0;
+    size_t high = store->segmentCount;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (store->segments[mid].id < id) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+void WGLogStoreSeek(const WGLogStore *store, uint64_t time, WGLogStorePosition *position) {
+    // First segment that reaches time; times never decrease across segments
+    size_t low = 0;
+    size_t high = store->segmentCount;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (store->segments[mid].lastTime < time) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (low == store->segmentCount) {
+        // Past everything: the end of the newest segment (or the next one)
+        *position = store->segmentCount
+            ? (WGLogStorePosition){ store->segments[low - 1].id, store->segments[low - 1].bytes }
+            : (WGLogStorePosition){ store->nextId, WG_LOG_SEGMENT_HEADER };
+        return;
+    }
+
+    // Last sparse entry stamped before time; the scan starts there
+    const WGLogSegment *segment = &store->segments[low];
+    size_t begin = 0;
+    size_t end = segment->indexCount;
+    while (begin < end) {
+        size_t mid = begin + (end - begin) / 2;
+        if (segment->index[mid].time < time) {
+            begin = mid + 1;
+        } else {
+            end = mid;
+        }
+    }
+    position->segment = segment->id;
+    position->offset = begin > 0 ? segment->index[begin - 1].offset : WG_LOG_SEGMENT_HEADER;
+}
+
+size_t WGLogStoreRead(WGLogStore *store, WGLogStorePosition *position, uint64_t since, uint64_t until,
+                      size_t max, WGLogStoreVisitor visitor, void *context, bool *finished) {
+    *finished = false;
+    if (store->writing) {
+        WGLogWriterFlush(&store->writer);
+    }
+
+    size_t visited = 0;
+    uint64_t baseId = 0;
+    uint64_t baseTime = 0;
+    while (visited < max) {
+        size_t slot = WGLogStoreSegmentFrom(store, position->segment);
+        if (slot == store->segmentCount) {
+            *finished = true;
+            break;
+        }
+        const WGLogSegment *segment = &store->segments[slot];
+        if (segment->id != position->segment || position->offset < WG_LOG_SEGMENT_HEADER) {
+            *position = (WGLogStorePosition){ segment->id, WG_LOG_SEGMENT_HEADER };
+        }
+
+        // Only what has reached the file; a drained writer buffer is empty
+        uint64_t limit = segment->bytes;
+        if (store->writing && slot == store->segmentCount - 1) {
+            limit -= store->writer.length;
+        }
+
+        WGLogRecord record;
+        uint64_t next = 0;
+        if (position->offset < limit && (baseId == segment->id || WGLogStoreReadBase(store, segment->id, &baseTime))) {
+            baseId = segment->id;
+            next = WGLogStoreReadRecord(store, segment->id, baseTime, position->offset, limit, &record);
+        }
+        if (next == 0) {
+            // End of this segment (or damage): move on, or stop at the newest
+            if (slot == store->segmentCount - 1) {
+                *finished = true;
+                break;
+            }
+            *position = (WGLogStorePosition){ store->segments[slot + 1].id, WG_LOG_SEGMENT_HEADER };
+            continue;
+        }
+
+        if (until && record.time >= until) {
+            *finished = true;
+            break;
+        }
+        position->offset = next;
+        if (record.time < since) {
+            continue;
+        }
+        visited++;
+        if (!visitor(context, &record)) {
+            break;
+        }
+    }
+    return visited;
+}
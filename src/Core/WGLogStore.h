@@ -0,0 +1,158 @@
+/*
+ * WGLogStore.h - Segmented Audit Log Store
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * Append-only audit history on disk, split into segment files that rotate
+ * by size or age. Retention unlinks whole segments (oldest first), so disk
+ * use stays bounded without rewriting anything.
+ *
+ * Layout of a directory:
+ *
+ *   <id>.wgl   header (magic "WGLS", version, first record time), then
+ *              records: u32 length | u32 FNV-1a of payload | payload
+ *              payload: varint time offset (µs), u8 severity and three
+ *              varint-length strings (event type, details, session)
+ *   <id>.wgi   sparse index written when the segment is sealed: one
+ *              (time, offset) pair every indexInterval bytes
+ *
+ * Ids are 16 hex digits, ascending with age, and record times are kept
+ * non-decreasing across the whole store, so a time seek is a binary search
+ * over segments, then over one sparse index, then a short scan. A missing
+ * or stale index is rebuilt on open, and a torn tail left by a crash is
+ * truncated. Writes go through WGLogWriter, keeping its group commit.
+ *
+ * Not thread-safe - WGAuditLogger drives it from its serial log queue.
+ */
+
+#ifndef WG_LOG_STORE_H
+#define WG_LOG_STORE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "WGLogWriter.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WG_LOG_STORE_VERSION    1
+#define WG_LOG_STORE_MAX_RECORD (16 * 1024)     // Encoded; details are truncated to fit
+
+typedef struct {
+    uint64_t maxSegmentBytes;   // Rotate once the active segment reaches this
+    uint64_t maxSegmentAge;     // µs after its first record, 0 = no limit
+    uint64_t retainBytes;       // Drop oldest segments beyond this total, 0 = no limit
+    uint64_t retainAge;         // Drop segments whose last record is older, 0 = no limit
+    uint32_t indexInterval;     // Bytes between sparse index entries
+} WGLogStoreConfig;
+
+typedef struct {
+    uint64_t time;              // µs since 1970
+    int severity;               // Stored as 0-255
+    const char *eventType;      // UTF-8, not NUL-terminated when read back
+    size_t eventTypeLength;
+    const char *details;
+    size_t detailsLength;
+    const char *sessionId;
+    size_t sessionIdLength;
+} WGLogRecord;
+
+typedef struct {
+    uint64_t time;
+    uint64_t offset;
+} WGLogIndexEntry;
+
+typedef struct {
+    uint64_t id;
+    uint64_t firstTime;
+    uint64_t lastTime;
+    uint64_t bytes;             // File length, including anything still buffered
+    uint64_t records;
+    WGLogIndexEntry *index;     // Sparse, ascending
+    size_t indexCount;
+    size_t indexCapacity;
+} WGLogSegment;
+
+// Where a reader stands: a segment id and a byte offset within it. Ids
+// survive rotation and retention, so a position stays valid between reads.
+typedef struct {
+    uint64_t segment;
+    uint64_t offset;
+} WGLogStorePosition;
+
+typedef struct {
+    char *directory;
+    WGLogStoreConfig config;
+    WGLogCommitPolicy policy;
+    WGLogSegment *segments;     // Oldest first; the last one is active when writing
+    size_t segmentCount;
+    size_t segmentCapacity;
+    uint64_t nextId;
+    uint64_t totalBytes;
+    uint64_t lastTime;
+    bool writing;               // segments[segmentCount - 1] is open in writer
+    WGLogWriter writer;
+    WGLogWriterStats stats;     // Carried across rotations
+    uint8_t *record;            // Encode buffer, WG_LOG_STORE_MAX_RECORD
+
+    // Read window over one segment
+    int readFd;
+    uint64_t readSegment;
+    uint8_t *readBuffer;
+    size_t readCapacity;
+    uint64_t readStart;
+    size_t readLength;
+} WGLogStore;
+
+// Defaults: 4 MiB / 1 day segments, keep 64 MiB and 90 days, index every 4 KiB
+WGLogStoreConfig WGLogStoreConfigDefault(void);
+
+// Lifecycle. Open loads (and repairs) the segments already in directory,
+// which must exist; new records always start a new segment. Close commits
+// and seals the active segment.
+bool WGLogStoreOpen(WGLogStore *store, const char *directory, WGLogStoreConfig config,
+                    WGLogCommitPolicy policy);
+void WGLogStoreClose(WGLogStore *store);
+
+// Appends one record, rotating (and applying retention) first when the
+// active segment is full or too old. Returns true when the commit policy
+// wants a commit now, like WGLogWriterAppend.
+bool WGLogStoreAppend(WGLogStore *store, const WGLogRecord *record);
+bool WGLogStoreCommit(WGLogStore *store);
+
+static inline bool WGLogStoreHasPending(const WGLogStore *store) {
+    return store->writing && WGLogWriterHasPending(&store->writer);
+}
+
+WGLogWriterStats WGLogStoreStats(const WGLogStore *store);
+
+// Retention - each unlinks whole sealed segments and returns how many.
+// DropBefore removes segments whose last record is older than time;
+// EnforceRetention applies retainBytes / retainAge as of now. DropAll seals
+// the active segment first and empties the store; the next append starts a
+// new segment.
+size_t WGLogStoreDropBefore(WGLogStore *store, uint64_t time);
+size_t WGLogStoreEnforceRetention(WGLogStore *store, uint64_t now);
+size_t WGLogStoreDropAll(WGLogStore *store);
+
+// Positions *position at or shortly before the first record stamped at or
+// after time
+void WGLogStoreSeek(const WGLogStore *store, uint64_t time, WGLogStorePosition *position);
+
+// Return false to stop; the record's strings are only valid during the call
+typedef bool (*WGLogStoreVisitor)(void *context, const WGLogRecord *record);
+
+// Visits up to max records stamped in [since, until) from *position on,
+// crossing segments, and advances *position past them. *finished is set
+// when the end of the store (or until) was reached rather than max.
+// Buffered records are flushed (not synced) first so reads see them.
+size_t WGLogStoreRead(WGLogStore *store, WGLogStorePosition *position, uint64_t since, uint64_t until,
+                      size_t max, WGLogStoreVisitor visitor, void *context, bool *finished);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WG_LOG_STORE_H */
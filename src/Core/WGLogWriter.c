@@ -0,0 +1,203 @@
+/*
+ * WGLogWriter.c - Buffered Audit Log Writer Implementation
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ */
+
+#include "WGLogWriter.h"
+
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#pragma mark - Formatting
+
+void WGLogFormatTimestamp(WGLogTimestampCache *cache, double timestamp, char out[WG_LOG_TIMESTAMP_STRLEN]) {
+    double whole = floor(timestamp);
+    int64_t second = (int64_t)whole;
+    int millis = (int)((timestamp - whole) * 1000.0);
+    if (millis > 999) {
+        millis = 999;
+    }
+
+    if (cache->second != second || cache->prefix[0] == '\0') {
+        time_t t = (time_t)second;
+        struct tm tm;
+        localtime_r(&t, &tm);
+        strftime(cache->prefix, sizeof(cache->prefix), "%Y-%m-%d %H:%M:%S", &tm);
+        cache->second = second;
+    }
+
+    memcpy(out, cache->prefix, 19);
+    out[19] = '.';
+    out[20] = (char)('0' + millis / 100);
+    out[21] = (char)('0' + (millis / 10) % 10);
+    out[22] = (char)('0' + millis % 10);
+    out[23] = '\0';
+}
+
+uint64_t WGLogMonotonicNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+#pragma mark - Lifecycle
+
+WGLogCommitPolicy WGLogCommitPolicyDefault(void) {
+    WGLogCommitPolicy policy = {
+        .maxPendingEntries = 64,
+        .maxDelayMs = 500,
+        .immediateSeverity = 9
+    };
+    return policy;
+}
+
+bool WGLogWriterOpen(WGLogWriter *writer, int fd, size_t capacity, WGLogCommitPolicy policy) {
+    memset(writer, 0, sizeof(*writer));
+    writer->fd = fd;
+    writer->policy = policy;
+    writer->capacity = capacity ? capacity : 64 * 1024;
+    writer->buffer = malloc(writer->capacity);
+    writer->stats.startNs = WGLogMonotonicNs();
+    if (!writer->buffer) {
+        writer->capacity = 0;
+        return false;
+    }
+    return true;
+}
+
+void WGLogWriterClose(WGLogWriter *writer) {
+    if (writer->fd >= 0) {
+        WGLogWriterCommit(writer);
+        close(writer->fd);
+    }
+    free(writer->buffer);
+    writer->buffer = NULL;
+    writer->fd = -1;
+    writer->length = writer->capacity = 0;
+}
+
+#pragma mark - Writing
+
+// Returns the number of bytes written before any error
+static size_t WGLogWriteAll(WGLogWriter *writer, const uint8_t *data, size_t length) {
+    size_t written = 0;
+    while (written < length) {
+        ssize_t n = write(writer->fd, data + written, length - written);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            writer->stats.errors++;
+            break;
+        }
+        writer->stats.writes++;
+        writer->stats.bytes += (uint64_t)n;
+        written += (size_t)n;
+    }
+    return written;
+}
+
+// Moves buffered bytes to the file without syncing; a partial write keeps
+// the unwritten tail buffered
+static bool WGLogWriterDrain(WGLogWriter *writer) {
+    if (writer->length == 0) {
+        return true;
+    }
+    if (writer->fd < 0) {
+        return false;
+    }
+    size_t written = WGLogWriteAll(writer, writer->buffer, writer->length);
+    if (written < writer->length) {
+        memmove(writer->buffer, writer->buffer + written, writer->length - written);
+        writer->length -= written;
+        return false;
+    }
+    writer->length = 0;
+    return true;
+}
+
+static bool WGLogWriterPut(WGLogWriter *writer, const char *data, size_t length) {
+    if (writer->length + length > writer->capacity) {
+        if (!WGLogWriterDrain(writer)) {
+            return false;
+        }
+        if (length > writer->capacity) {
+            return WGLogWriteAll(writer, (const uint8_t *)data, length) == length;
+        }
+    }
+    memcpy(writer->buffer + writer->length, data, length);
+    writer->length += length;
+    return true;
+}
+
+// Writes "field" with embedded quotes doubled
+static bool WGLogWriterPutQuoted(WGLogWriter *writer, const char *field) {
+    if (!WGLogWriterPut(writer, "\"", 1)) {
+        return false;
+    }
+    const char *start = field ? field : "";
+    for (const char *quote; (quote = strchr(start, '"')) != NULL; start = quote + 1) {
+        if (!WGLogWriterPut(writer, start, (size_t)(quote - start) + 1) ||
+            !WGLogWriterPut(writer, "\"", 1)) {
+            return false;
+        }
+    }
+    return WGLogWriterPut(writer, start, strlen(start)) && WGLogWriterPut(writer, "\"", 1);
+}
+
+// Counts a buffered entry; true when the policy wants a commit now
+static bool WGLogWriterEntryAdded(WGLogWriter *writer, int severity) {
+    writer->stats.events++;
+    writer->pendingEntries++;
+
+    return severity >= writer->policy.immediateSeverity ||
+           writer->pendingEntries >= writer->policy.maxPendingEntries;
+}
+
+bool WGLogWriterAppend(WGLogWriter *writer, double timestamp, const char *eventType,
+                       const char *details, const char *sessionId, int severity) {
+    char stamp[WG_LOG_TIMESTAMP_STRLEN];
+    WGLogFormatTimestamp(&writer->timestamps, timestamp, stamp);
+
+    bool ok = WGLogWriterPutQuoted(writer, stamp) && WGLogWriterPut(writer, ",", 1) &&
+              WGLogWriterPutQuoted(writer, eventType) && WGLogWriterPut(writer, ",", 1) &&
+              WGLogWriterPutQuoted(writer, details) && WGLogWriterPut(writer, ",", 1) &&
+              WGLogWriterPutQuoted(writer, sessionId) && WGLogWriterPut(writer, "\n", 1);
+    if (!ok) {
+        return true;    // Let the caller retry through a commit
+    }
+
+    return WGLogWriterEntryAdded(writer, severity);
+}
+
+bool WGLogWriterAppendRecord(WGLogWriter *writer, const void *record, size_t length, int severity) {
+    if (!WGLogWriterPut(writer, record, length)) {
+        return true;
+    }
+    return WGLogWriterEntryAdded(writer, severity);
+}
+
+bool WGLogWriterFlush(WGLogWriter *writer) {
+    return WGLogWriterDrain(writer);
+}
+
+bool WGLogWriterCommit(WGLogWriter *writer) {
+    if (!WGLogWriterDrain(writer)) {
+        return false;
+    }
+    if (writer->pendingEntries == 0) {
+        return true;
+    }
+    if (fsync(writer->fd) < 0) {
+        writer->stats.errors++;
+        return false;
+    }
+    writer->stats.fsyncs++;
+    writer->pendingEntries = 0;
+    return true;
+}
@@ -0,0 +1,94 @@
+/*
+ * WGLogWriter.h - Buffered Audit Log Writer
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * Appends CSV audit lines (or pre-encoded records, for WGLogStore) to a
+ * preallocated buffer and group-commits them (one write + one fsync)
+ * according to a policy: after N entries, after a delay, or immediately
+ * for high-severity events. Timestamps are formatted with a per-second
+ * cache instead of a date formatter per line.
+ *
+ * Not thread-safe - WGAuditLogger drives it from its serial log queue.
+ */
+
+#ifndef WG_LOG_WRITER_H
+#define WG_LOG_WRITER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WG_LOG_TIMESTAMP_STRLEN 24  // "yyyy-MM-dd HH:mm:ss.SSS" + NUL
+
+typedef struct {
+    uint32_t maxPendingEntries;     // Commit once this many entries are buffered
+    uint32_t maxDelayMs;            // Commit this long after the first buffered entry
+    int immediateSeverity;          // Commit at once for events at or above this
+} WGLogCommitPolicy;
+
+typedef struct {
+    uint64_t events;
+    uint64_t bytes;
+    uint64_t writes;
+    uint64_t fsyncs;
+    uint64_t errors;
+    uint64_t startNs;               // Monotonic time the writer was opened
+} WGLogWriterStats;
+
+// Timestamp formatting (local time), cached per wall-clock second
+typedef struct {
+    int64_t second;
+    char prefix[20];                // "yyyy-MM-dd HH:mm:ss"
+} WGLogTimestampCache;
+
+typedef struct {
+    int fd;
+    uint8_t *buffer;
+    size_t length;
+    size_t capacity;
+    uint32_t pendingEntries;        // Entries appended since the last commit
+    WGLogCommitPolicy policy;
+    WGLogWriterStats stats;
+    WGLogTimestampCache timestamps;
+} WGLogWriter;
+
+// Defaults: 64 entries, 500 ms, severity 9
+WGLogCommitPolicy WGLogCommitPolicyDefault(void);
+
+// Lifecycle. The writer takes ownership of fd and closes it in Close,
+// after committing anything still buffered.
+bool WGLogWriterOpen(WGLogWriter *writer, int fd, size_t capacity, WGLogCommitPolicy policy);
+void WGLogWriterClose(WGLogWriter *writer);
+
+// Appends one quoted CSV line. Returns true when the policy wants a commit
+// now (entry count or severity); callers arm a maxDelayMs timer otherwise.
+bool WGLogWriterAppend(WGLogWriter *writer, double timestamp, const char *eventType,
+                       const char *details, const char *sessionId, int severity);
+
+// Appends one already-encoded record under the same policy
+bool WGLogWriterAppendRecord(WGLogWriter *writer, const void *record, size_t length, int severity);
+
+// Writes the buffer without syncing, so readers of the file see it
+bool WGLogWriterFlush(WGLogWriter *writer);
+
+// Writes the buffer and fsyncs. Returns false on I/O error (data stays
+// buffered for the next attempt).
+bool WGLogWriterCommit(WGLogWriter *writer);
+
+static inline bool WGLogWriterHasPending(const WGLogWriter *writer) {
+    return writer->pendingEntries > 0;
+}
+
+// Formatting / clock
+void WGLogFormatTimestamp(WGLogTimestampCache *cache, double timestamp, char out[WG_LOG_TIMESTAMP_STRLEN]);
+uint64_t WGLogMonotonicNs(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WG_LOG_WRITER_H */
@@ -0,0 +1,22 @@
+/*
+ * WGMobileWiFiScanSource.h - MobileWiFi Scan Source
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * PASSIVE SCANNING ONLY - No active attacks implemented
+ * Polled source backed by the private MobileWiFi.framework (dlopen'd)
+ */
+
+#import <Foundation/Foundation.h>
+#import "WGScanSource.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class WGAuditLogger;
+
+@interface WGMobileWiFiScanSource : NSObject <WGScanSource>
+
+- (instancetype)initWithAuditLogger:(nullable WGAuditLogger *)logger;
+
+@end
+
+NS_ASSUME_NONNULL_END
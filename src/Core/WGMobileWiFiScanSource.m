@@ -0,0 +1,427 @@
+/*
+ * WGMobileWiFiScanSource.m - MobileWiFi Scan Source Implementation
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ * 
+ * PASSIVE SCANNING ONLY - No active attacks implemented
+ * Uses MobileWiFi.framework private APIs for scanning
+ */
+
+#import "WGMobileWiFiScanSource.h"
+#import "WGAuditLogger.h"
+#import "WGAddress.h"
+#import "WGMetrics.h"
+#import <dlfcn.h>
+
+// MobileWiFi.framework Private API Declarations
+// RISK: These APIs are undocumented and may change between iOS versions
+// Compatibility: Tested on iOS 16.0-16.2
+typedef struct __WiFiManager *WiFiManagerRef;
+typedef struct __WiFiNetwork *WiFiNetworkRef;
+typedef struct __WiFiDevice *WiFiDeviceRef;
+
+// Function pointer types
+typedef WiFiManagerRef (*WiFiManagerClientCreate_t)(CFAllocatorRef, int);
+typedef CFArrayRef (*WiFiManagerClientCopyDevices_t)(WiFiManagerRef);
+typedef CFArrayRef (*WiFiDeviceClientCopyCurrentNetwork_t)(WiFiDeviceRef);
+typedef int (*WiFiDeviceClientGetPower_t)(WiFiDeviceRef);
+typedef void (*WiFiDeviceClientScanAsync_t)(WiFiDeviceRef, CFDictionaryRef, void (^)(CFArrayRef, int), int);
+typedef CFStringRef (*WiFiNetworkGetSSID_t)(WiFiNetworkRef);
+typedef CFStringRef (*WiFiNetworkGetBSSID_t)(WiFiNetworkRef);
+typedef CFNumberRef (*WiFiNetworkGetRSSI_t)(WiFiNetworkRef);
+typedef CFNumberRef (*WiFiNetworkGetChannel_t)(WiFiNetworkRef);
+typedef Boolean (*WiFiNetworkIsHidden_t)(WiFiNetworkRef);
+typedef CFDictionaryRef (*WiFiNetworkCopyRecord_t)(WiFiNetworkRef);
+
+// Function pointers (loaded dynamically)
+static WiFiManagerClientCreate_t WiFiManagerClientCreate = NULL;
+static WiFiManagerClientCopyDevices_t WiFiManagerClientCopyDevices = NULL;
+static WiFiDeviceClientCopyCurrentNetwork_t WiFiDeviceClientCopyCurrentNetwork = NULL;
+static WiFiDeviceClientGetPower_t WiFiDeviceClientGetPower = NULL;
+static WiFiDeviceClientScanAsync_t WiFiDeviceClientScanAsync = NULL;
+static WiFiNetworkGetSSID_t WiFiNetworkGetSSID = NULL;
+static WiFiNetworkGetBSSID_t WiFiNetworkGetBSSID = NULL;
+static WiFiNetworkGetRSSI_t WiFiNetworkGetRSSI = NULL;
+static WiFiNetworkGetChannel_t WiFiNetworkGetChannel = NULL;
+static WiFiNetworkIsHidden_t WiFiNetworkIsHidden = NULL;
+static WiFiNetworkCopyRecord_t WiFiNetworkCopyRecord = NULL;
+
+// Load MobileWiFi functions dynamically
+static BOOL gMobileWiFiLoaded = NO;
+static NSString *gLoadError = nil;
+
+static void LoadMobileWiFiFunctions(void) {
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        // Try loading MobileWiFi.framework
+        void *handle = dlopen("/System/Library/PrivateFrameworks/MobileWiFi.framework/MobileWiFi", RTLD_LAZY);
+        if (!handle) {
+            gLoadError = [NSString stringWithFormat:@"dlopen failed: %s", dlerror()];
+            NSLog(@"[WiFiGuard] %@", gLoadError);
+            gMobileWiFiLoaded = NO;
+            return;
+        }
+        
+        WiFiManagerClientCreate = (WiFiManagerClientCreate_t)dlsym(handle, "WiFiManagerClientCreate");
+        WiFiManagerClientCopyDevices = (WiFiManagerClientCopyDevices_t)dlsym(handle, "WiFiManagerClientCopyDevices");
+        WiFiDeviceClientCopyCurrentNetwork = (WiFiDeviceClientCopyCurrentNetwork_t)dlsym(handle, "WiFiDeviceClientCopyCurrentNetwork");
+        WiFiDeviceClientGetPower = (WiFiDeviceClientGetPower_t)dlsym(handle, "WiFiDeviceClientGetPower");
+        WiFiDeviceClientScanAsync = (WiFiDeviceClientScanAsync_t)dlsym(handle, "WiFiDeviceClientScanAsync");
+        WiFiNetworkGetSSID = (WiFiNetworkGetSSID_t)dlsym(handle, "WiFiNetworkGetSSID");
+        WiFiNetworkGetBSSID = (WiFiNetworkGetBSSID_t)dlsym(handle, "WiFiNetworkGetBSSID");
+        WiFiNetworkGetRSSI = (WiFiNetworkGetRSSI_t)dlsym(handle, "WiFiNetworkGetRSSI");
+        WiFiNetworkGetChannel = (WiFiNetworkGetChannel_t)dlsym(handle, "WiFiNetworkGetChannel");
+        WiFiNetworkIsHidden = (WiFiNetworkIsHidden_t)dlsym(handle, "WiFiNetworkIsHidden");
+        WiFiNetworkCopyRecord = (WiFiNetworkCopyRecord_t)dlsym(handle, "WiFiNetworkCopyRecord");
+        
+        // Log which functions loaded
+        NSLog(@"[WiFiGuard] WiFiManagerClientCreate: %@", WiFiManagerClientCreate ? @"✓" : @"✗");
+        NSLog(@"[WiFiGuard] WiFiManagerClientCopyDevices: %@", WiFiManagerClientCopyDevices ? @"✓" : @"✗");
+        NSLog(@"[WiFiGuard] WiFiDeviceClientScanAsync: %@", WiFiDeviceClientScanAsync ? @"✓" : @"✗");
+        NSLog(@"[WiFiGuard] WiFiDeviceClientGetPower: %@", WiFiDeviceClientGetPower ? @"✓" : @"✗");
+        
+        // Verify critical functions loaded
+        gMobileWiFiLoaded = (WiFiManagerClientCreate != NULL && 
+                            WiFiManagerClientCopyDevices != NULL);
+        
+        if (!gMobileWiFiLoaded) {
+            gLoadError = @"Critical functions not found";
+            NSLog(@"[WiFiGuard] Some MobileWiFi functions failed to load");
+        } else {
+            gLoadError = nil;
+            NSLog(@"[WiFiGuard] MobileWiFi.framework loaded successfully");
+        }
+    });
+}
+
+static BOOL IsMobileWiFiAvailable(void) {
+    LoadMobileWiFiFunctions();
+    return gMobileWiFiLoaded;
+}
+
+@interface WGMobileWiFiScanSource ()
+
+@property (nonatomic, strong) WGAuditLogger *auditLogger;
+@property (nonatomic, assign) WiFiManagerRef wifiManager;
+@property (nonatomic, assign) WiFiDeviceRef wifiDevice;
+
+@end
+
+@implementation WGMobileWiFiScanSource
+
+@synthesize resultHandler = _resultHandler;
+@synthesize errorHandler = _errorHandler;
+
+#pragma mark - Initialization
+
+- (instancetype)initWithAuditLogger:(WGAuditLogger *)logger {
+    self = [super init];
+    if (self) {
+        // Load MobileWiFi functions
+        LoadMobileWiFiFunctions();
+        
+        _auditLogger = logger;
+        [self initializeWiFiManager];
+    }
+    return self;
+}
+
+- (void)initializeWiFiManager {
+    if (!IsMobileWiFiAvailable()) {
+        NSLog(@"[WiFiGuard] MobileWiFi.framework not available - WiFi scanning disabled");
+        [self.auditLogger logEvent:@"SCANNER_INIT_ERROR" 
+                           details:@"MobileWiFi.framework not available"];
+        return;
+    }
+    
+    @try {
+        if (WiFiManagerClientCreate) {
+            _wifiManager = WiFiManagerClientCreate(kCFAllocatorDefault, 0);
+        }
+        
+        if (_wifiManager && WiFiManagerClientCopyDevices) {
+            CFArrayRef devices = WiFiManagerClientCopyDevices(_wifiManager);
+            if (devices && CFArrayGetCount(devices) > 0) {
+                _wifiDevice = (WiFiDeviceRef)CFArrayGetValueAtIndex(devices, 0);
+            }
+            if (devices) CFRelease(devices);
+        }
+        
+        if (_wifiDevice) {
+            NSLog(@"[WiFiGuard] WiFi manager initialized successfully");
+        } else {
+            NSLog(@"[WiFiGuard] WiFi manager created but no device found");
+        }
+    } @catch (NSException *exception) {
+        NSLog(@"[WiFiGuard] Error initializing WiFi manager: %@", exception);
+        [self.auditLogger logEvent:@"SCANNER_INIT_ERROR" 
+                           details:[NSString stringWithFormat:@"Exception: %@", exception]];
+    }
+}
+
+- (void)dealloc {
+    if (_wifiManager) {
+        CFRelease(_wifiManager);
+        _wifiManager = NULL;
+    }
+}
+
+#pragma mark - WGScanSource
+
+- (NSString *)name {
+    return @"MobileWiFi";
+}
+
+- (BOOL)isContinuous {
+    return NO;
+}
+
+- (BOOL)prepare:(NSError **)error {
+    if (!IsMobileWiFiAvailable()) {
+        if (error) {
+            *error = [NSError errorWithDomain:@"WGWiFiScannerError" 
+                                         code:0 
+                                     userInfo:@{NSLocalizedDescriptionKey: @"MobileWiFi.framework not available. Requires jailbroken device."}];
+        }
+        return NO;
+    }
+    
+    if (!self.wifiDevice) {
+        if (error) {
+            *error = [NSError errorWithDomain:@"WGWiFiScannerError" 
+                                         code:1 
+                                     userInfo:@{NSLocalizedDescriptionKey: @"WiFi device not available"}];
+        }
+        return NO;
+    }
+    
+    // Note: WiFiDeviceClientGetPower may not work correctly on iOS 16+
+    // We'll try scanning anyway and let the scan callback handle errors
+    WGVerboseLog(@"[WiFiGuard] Starting scan (WiFi power check skipped for iOS 16+ compatibility)");
+    return YES;
+}
+
+- (void)stop {
+    // Scans are one-shot; a callback still in flight is simply delivered
+}
+
+- (void)requestScan {
+    if (!self.wifiDevice) {
+        NSLog(@"[WiFiGuard] Cannot scan: no WiFi device");
+        return;
+    }
+    
+    // Check if async scan function is available
+    if (!WiFiDeviceClientScanAsync) {
+        NSLog(@"[WiFiGuard] WiFiDeviceClientScanAsync not available");
+        return;
+    }
+    
+    WGVerboseLog(@"[WiFiGuard] Initiating WiFi scan...");
+    
+    @try {
+        // Perform passive scan - NO active probing
+        NSDictionary *options = @{
+            @"SCAN_MERGE": @YES,           // Merge results
+            @"SCAN_TYPE": @"PASSIVE"       // Passive scan only
+        };
+        
+        WiFiDeviceClientScanAsync(self.wifiDevice, 
+                                  (__bridge CFDictionaryRef)options, 
+                                  ^(CFArrayRef results, int error) {
+            if (error != 0) {
+                NSLog(@"[WiFiGuard] Scan callback error: %d", error);
+                WGScanSourceErrorHandler errorHandler = self.errorHandler;
+                if (errorHandler) {
+                    errorHandler([NSError errorWithDomain:@"WGWiFiScannerError" 
+                                                     code:error 
+                                                 userInfo:@{NSLocalizedDescriptionKey: [NSString stringWithFormat:@"Scan failed with code %d", error]}]);
+                }
+                return;
+            }
+            
+            WGVerboseLog(@"[WiFiGuard] Scan completed, processing results...");
+            uint64_t start = WGMetricsNow();
+            [self processScanResults:results];
+            WGMetricsEnd(WGMetricStageScanCallback, start);
+        }, 0);
+        
+    } @catch (NSException *exception) {
+        NSLog(@"[WiFiGuard] Scan exception: %@", exception);
+    }
+}
+
+- (void)processScanResults:(CFArrayRef)results {
+    if (!results) {
+        NSLog(@"[WiFiGuard] processScanResults: results is NULL");
+        return;
+    }
+    
+    CFIndex count = CFArrayGetCount(results);
+    WGVerboseLog(@"[WiFiGuard] Processing %ld scan results", (long)count);
+    if (count == 0) {
+        return;
+    }
+    
+    // Runs on the MobileWiFi callback thread: decode to POD records and hand
+    // them over; the scanner queues them for its ingest worker
+    WGScanRecord *records = calloc((size_t)count, sizeof(WGScanRecord));
+    if (!records) {
+        return;
+    }
+    size_t parsed = 0;
+    double now = [[NSDate date] timeIntervalSince1970];
+    uint64_t start = WGMetricsNow();
+    for (CFIndex i = 0; i < count; i++) {
+        WiFiNetworkRef network = (WiFiNetworkRef)CFArrayGetValueAtIndex(results, i);
+        if ([self parseNetwork:network intoRecord:&records[parsed]]) {
+            records[parsed].lastSeen = now;
+            parsed++;
+        }
+    }
+    WGMetricsEnd(WGMetricStageScanParse, start);
+    
+    WGScanSourceResultHandler resultHandler = self.resultHandler;
+    if (resultHandler && parsed > 0) {
+        resultHandler(records, parsed);
+    }
+    free(records);
+}
+
+- (BOOL)parseNetwork:(WiFiNetworkRef)network intoRecord:(WGScanRecord *)record {
+    if (!network) return NO;
+    
+    memset(record, 0, sizeof(*record));
+    record->channelWidth = 20;
+    strlcpy(record->security, "Unknown", sizeof(record->security));
+    
+    // Get BSSID
+    if (WiFiNetworkGetBSSID) {
+        CFStringRef bssidRef = WiFiNetworkGetBSSID(network);
+        if (bssidRef) {
+            record->bssid = WGMACFromString((__bridge NSString *)bssidRef);
+        }
+    }
+    if (!record->bssid) {
+        return NO;
+    }
+    
+    // Get SSID (truncated to the 32-byte 802.11 limit)
+    if (WiFiNetworkGetSSID) {
+        CFStringRef ssidRef = WiFiNetworkGetSSID(network);
+        if (ssidRef) {
+            NSData *ssid = [(__bridge NSString *)ssidRef dataUsingEncoding:NSUTF8StringEncoding];
+            record->ssidLength = (uint8_t)MIN(ssid.length, (NSUInteger)WG_SCAN_SSID_MAX);
+            memcpy(record->ssid, ssid.bytes, record->ssidLength);
+        }
+    }
+    
+    // Get RSSI
+    if (WiFiNetworkGetRSSI) {
+        CFNumberRef rssiRef = WiFiNetworkGetRSSI(network);
+        if (rssiRef) {
+            int rssi = 0;
+            CFNumberGetValue(rssiRef, kCFNumberIntType, &rssi);
+            record->rssi = (int16_t)MAX(INT16_MIN, MIN(INT16_MAX, rssi));
+        }
+    }
+    
+    // Get Channel
+    if (WiFiNetworkGetChannel) {
+        CFNumberRef channelRef = WiFiNetworkGetChannel(network);
+        if (channelRef) {
+            int channel = 0;
+            CFNumberGetValue(channelRef, kCFNumberIntType, &channel);
+            record->channel = (uint16_t)MAX(0, MIN(UINT16_MAX, channel));
+        }
+    }
+    record->band = (uint8_t)WGChannelBandForChannel(record->channel);
+    
+    // Check if hidden
+    if (WiFiNetworkIsHidden && WiFiNetworkIsHidden(network)) {
+        record->flags |= WGScanRecordFlagHidden;
+    }
+    
+    // Get security type from network record
+    if (WiFiNetworkCopyRecord) {
+        CFDictionaryRef networkRecord = WiFiNetworkCopyRecord(network);
+        if (networkRecord) {
+            strlcpy(record->security, [self parseSecurityType:networkRecord].UTF8String, sizeof(record->security));
+            record->channelWidth = (uint16_t)MAX(0, MIN(UINT16_MAX, [self parseChannelWidth:networkRecord]));
+            record->band = (uint8_t)[self parseBand:networkRecord fallback:(WGChannelBand)record->band];
+            CFRelease(networkRecord);
+        }
+    }
+    
+    return YES;
+}
+
+- (NSString *)parseSecurityType:(CFDictionaryRef)record {
+    // Parse security mode from network record
+    CFStringRef securityMode = CFDictionaryGetValue(record, CFSTR("WEP"));
+    if (securityMode && CFBooleanGetValue((CFBooleanRef)securityMode)) {
+        return @"WEP";
+    }
+    
+    CFDictionaryRef wpaMode = CFDictionaryGetValue(record, CFSTR("WPA"));
+    if (wpaMode) {
+        // Check for WPA3
+        CFBooleanRef wpa3 = CFDictionaryGetValue(record, CFSTR("WPA3"));
+        if (wpa3 && CFBooleanGetValue(wpa3)) {
+            return @"WPA3";
+        }
+        return @"WPA2";
+    }
+    
+    return @"Open";
+}
+
+- (NSInteger)parseChannelWidth:(CFDictionaryRef)record {
+    CFNumberRef widthRef = CFDictionaryGetValue(record, CFSTR("CHANNEL_WIDTH"));
+    if (widthRef) {
+        int width = 20;
+        CFNumberGetValue(widthRef, kCFNumberIntType, &width);
+        return width;
+    }
+    return 20;
+}
+
+- (WGChannelBand)parseBand:(CFDictionaryRef)record fallback:(WGChannelBand)band {
+    // Apple80211 channel flags; 6 GHz shares channel numbers with 2.4 GHz
+    CFNumberRef flagsRef = CFDictionaryGetValue(record, CFSTR("CHANNEL_FLAGS"));
+    if (!flagsRef) {
+        return band;
+    }
+    int flags = 0;
+    CFNumberGetValue(flagsRef, kCFNumberIntType, &flags);
+    if (flags & 0x2000) {
+        return WGChannelBand6GHz;
+    } else if (flags & 0x10) {
+        return WGChannelBand5GHz;
+    } else if (flags & 0x8) {
+        return WGChannelBand2GHz;
+    }
+    return band;
+}
+
+#pragma mark - Diagnostics
+
+- (NSString *)diagnosticStatus {
+    // Force load attempt
+    LoadMobileWiFiFunctions();
+    
+    if (!gMobileWiFiLoaded) {
+        if (gLoadError) {
+            return [NSString stringWithFormat:@"❌ %@", gLoadError];
+        }
+        return @"❌ MobileWiFi not loaded";
+    }
+    if (!self.wifiManager) {
+        return @"❌ No WiFi Manager";
+    }
+    if (!self.wifiDevice) {
+        return @"❌ No WiFi Device";
+    }
+    return nil;
+}
+
+@end
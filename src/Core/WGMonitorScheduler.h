@@ -0,0 +1,47 @@
+/*
+ * WGMonitorScheduler.h - Shared Adaptive Monitoring Scheduler
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * Runs the periodic monitoring tasks (Wi-Fi scans, ARP checks) from one
+ * dispatch timer on a background queue instead of one NSTimer each. The
+ * timer is re-armed for the earliest due task with leeway, so wake-ups
+ * coalesce with other system work. WGSchedulePolicy decides the intervals.
+ */
+
+#import <Foundation/Foundation.h>
+#import "WGSchedulePolicy.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Runs on the task's queue; reports what the run found
+typedef WGScheduleActivity (^WGScheduledBlock)(void);
+
+@interface WGMonitorScheduler : NSObject
+
++ (instancetype)sharedScheduler;
+
+// Returns a task identifier, or -1 when every slot is taken. The task
+// starts stopped; block never runs twice at once.
+- (NSInteger)addTaskWithConfig:(WGScheduleConfig)config
+                         queue:(dispatch_queue_t)queue
+                         block:(WGScheduledBlock)block;
+- (void)removeTask:(NSInteger)task;
+- (void)updateTask:(NSInteger)task config:(WGScheduleConfig)config;
+
+// Start runs the task one base interval from now, then adaptively
+- (void)startTask:(NSInteger)task;
+- (void)stopTask:(NSInteger)task;
+
+// Activity seen outside a run (asynchronous results, notifications)
+- (void)noteActivity:(WGScheduleActivity)activity forTask:(NSInteger)task;
+
+// Counters since the task was last started
+- (WGScheduleStats)statisticsForTask:(NSInteger)task;
+- (NSTimeInterval)currentIntervalForTask:(NSInteger)task;
+
+// runs, dutyCycle, intervalSec, escalations, budgetLimited
+- (NSDictionary<NSString *, NSNumber *> *)reportForTask:(NSInteger)task;
+
+@end
+
+NS_ASSUME_NONNULL_END
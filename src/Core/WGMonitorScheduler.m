@@ -0,0 +1,206 @@
+/*
+ * WGMonitorScheduler.m - Shared Adaptive Monitoring Scheduler Implementation
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ */
+
+#import "WGMonitorScheduler.h"
+#import "WGMetrics.h"
+
+@interface WGMonitorScheduler () {
+    WGSchedulePolicy _policy;                           // Touched only on _queue
+    WGScheduledBlock _blocks[WG_SCHEDULE_MAX_TASKS];
+    dispatch_queue_t _queues[WG_SCHEDULE_MAX_TASKS];
+    uint64_t _generations[WG_SCHEDULE_MAX_TASKS];       // Bumped when a slot is removed
+    BOOL _inFlight[WG_SCHEDULE_MAX_TASKS];
+    dispatch_queue_t _queue;
+    dispatch_source_t _timer;
+}
+
+@end
+
+@implementation WGMonitorScheduler
+
+#pragma mark - Singleton
+
++ (instancetype)sharedScheduler {
+    static WGMonitorScheduler *sharedScheduler = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedScheduler = [[self alloc] init];
+    });
+    return sharedScheduler;
+}
+
+#pragma mark - Initialization
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        WGSchedulePolicyInit(&_policy, NULL, NULL);
+        _queue = dispatch_queue_create("com.wifiguard.scheduler",
+                                       dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL,
+                                                                               QOS_CLASS_UTILITY, 0));
+        _timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, _queue);
+        dispatch_source_set_timer(_timer, DISPATCH_TIME_FOREVER, DISPATCH_TIME_FOREVER, 0);
+
+        __weak typeof(self) weakSelf = self;
+        dispatch_source_set_event_handler(_timer, ^{
+            [weakSelf fireDueTasks];
+        });
+        dispatch_resume(_timer);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    dispatch_source_cancel(_timer);
+}
+
+#pragma mark - Tasks
+
+- (NSInteger)addTaskWithConfig:(WGScheduleConfig)config
+                         queue:(dispatch_queue_t)queue
+                         block:(WGScheduledBlock)block {
+    __block NSInteger task = -1;
+    dispatch_sync(_queue, ^{
+        int index = WGSchedulePolicyAddTask(&self->_policy, &config);
+        if (index >= 0) {
+            self->_blocks[index] = [block copy];
+            self->_queues[index] = queue;
+            task = index;
+        }
+    });
+    if (task < 0) {
+        NSLog(@"[WiFiGuard] Monitor scheduler full (%d tasks)", WG_SCHEDULE_MAX_TASKS);
+    }
+    return task;
+}
+
+- (void)removeTask:(NSInteger)task {
+    dispatch_async(_queue, ^{
+        if (task < 0 || task >= WG_SCHEDULE_MAX_TASKS) {
+            return;
+        }
+        WGSchedulePolicyRemoveTask(&self->_policy, (int)task);
+        self->_blocks[task] = nil;
+        self->_queues[task] = nil;
+        self->_generations[task]++;
+        self->_inFlight[task] = NO;
+        [self rearmTimer];
+    });
+}
+
+- (void)updateTask:(NSInteger)task config:(WGScheduleConfig)config {
+    dispatch_async(_queue, ^{
+        WGSchedulePolicyConfigure(&self->_policy, (int)task, &config);
+        [self rearmTimer];
+    });
+}
+
+- (void)startTask:(NSInteger)task {
+    dispatch_async(_queue, ^{
+        WGSchedulePolicyStart(&self->_policy, (int)task);
+        if (task >= 0 && task < WG_SCHEDULE_MAX_TASKS && self->_inFlight[task]) {
+            // A run from before a stop is still going; its result schedules the next
+            WGSchedulePolicyBeginRun(&self->_policy, (int)task);
+        }
+        [self rearmTimer];
+    });
+}
+
+- (void)stopTask:(NSInteger)task {
+    dispatch_async(_queue, ^{
+        WGSchedulePolicyStop(&self->_policy, (int)task);
+        [self rearmTimer];
+    });
+}
+
+- (void)noteActivity:(WGScheduleActivity)activity forTask:(NSInteger)task {
+    if (activity == WGScheduleActivityQuiet) {
+        return;
+    }
+    dispatch_async(_queue, ^{
+        WGSchedulePolicyNoteActivity(&self->_policy, (int)task, activity);
+        [self rearmTimer];
+    });
+}
+
+#pragma mark - Timer
+
+- (void)fireDueTasks {
+    uint64_t now = _policy.clock(_policy.clockContext);
+    int task = -1;
+    while (WGSchedulePolicyNextDue(&_policy, &task) <= now && task >= 0) {
+        [self runTask:task];
+    }
+    [self rearmTimer];
+}
+
+- (void)runTask:(int)task {
+    WGSchedulePolicyBeginRun(&_policy, task);
+    _inFlight[task] = YES;
+
+    WGScheduledBlock block = _blocks[task];
+    uint64_t generation = _generations[task];
+    dispatch_async(_queues[task], ^{
+        uint64_t start = WGMetricsNow();
+        WGScheduleActivity activity = block();
+        uint64_t duration = WGMetricsNow() - start;
+
+        dispatch_async(self->_queue, ^{
+            if (self->_generations[task] != generation) {
+                return;
+            }
+            self->_inFlight[task] = NO;
+            WGSchedulePolicyRecordRun(&self->_policy, task, duration, activity);
+            [self rearmTimer];
+        });
+    });
+}
+
+// One timer for every task, armed for the earliest with that task's leeway
+- (void)rearmTimer {
+    int task = -1;
+    uint64_t due = WGSchedulePolicyNextDue(&_policy, &task);
+    if (due == WG_SCHEDULE_NEVER) {
+        dispatch_source_set_timer(_timer, DISPATCH_TIME_FOREVER, DISPATCH_TIME_FOREVER, 0);
+        return;
+    }
+    uint64_t now = _policy.clock(_policy.clockContext);
+    int64_t delay = due > now ? (int64_t)MIN(due - now, (uint64_t)INT64_MAX) : 0;
+    dispatch_source_set_timer(_timer, dispatch_time(DISPATCH_TIME_NOW, delay), DISPATCH_TIME_FOREVER,
+                              WGSchedulePolicyLeeway(&_policy, task));
+}
+
+#pragma mark - Statistics
+
+- (WGScheduleStats)statisticsForTask:(NSInteger)task {
+    __block WGScheduleStats stats = {0};
+    dispatch_sync(_queue, ^{
+        if (task >= 0 && (size_t)task < self->_policy.count && self->_policy.tasks[task].used) {
+            stats = self->_policy.tasks[task].stats;
+        }
+    });
+    return stats;
+}
+
+- (NSTimeInterval)currentIntervalForTask:(NSInteger)task {
+    __block uint64_t interval = WG_SCHEDULE_NEVER;
+    dispatch_sync(_queue, ^{
+        interval = WGSchedulePolicyEffectiveInterval(&self->_policy, (int)task);
+    });
+    return interval == WG_SCHEDULE_NEVER ? 0 : interval / 1e9;
+}
+
+- (NSDictionary<NSString *, NSNumber *> *)reportForTask:(NSInteger)task {
+    WGScheduleStats stats = [self statisticsForTask:task];
+    return @{
+        @"runs": @(stats.runs),
+        @"dutyCycle": @(WGScheduleStatsDutyCycle(&stats)),
+        @"intervalSec": @([self currentIntervalForTask:task]),
+        @"escalations": @(stats.escalations),
+        @"budgetLimited": @(stats.budgetLimited)
+    };
+}
+
+@end
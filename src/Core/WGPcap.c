@@ -0,0 +1,159 @@
+/*
+ * WGPcap.c - Memory-Mapped pcap Reader Implementation
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * PASSIVE ANALYSIS ONLY - Reads existing capture files
+ */
+
+#include "WGPcap.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define WG_PCAP_MAGIC_USEC 0xa1b2c3d4u
+#define WG_PCAP_MAGIC_NSEC 0xa1b23c4du
+#define WG_PCAP_HEADER_SIZE 24
+#define WG_PCAP_RECORD_SIZE 16
+
+static inline uint32_t WGPcapRead32(const uint8_t *p, bool swapped) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return swapped ? __builtin_bswap32(value) : value;
+}
+
+#pragma mark - Lifecycle
+
+WGPcapError WGPcapLoad(WGPcapReader *reader, const void *data, size_t length) {
+    memset(reader, 0, sizeof(*reader));
+    if (!data || length < WG_PCAP_HEADER_SIZE) {
+        return WGPcapErrorFormat;
+    }
+
+    const uint8_t *header = data;
+    uint32_t magic;
+    memcpy(&magic, header, sizeof(magic));
+    if (magic == WG_PCAP_MAGIC_USEC || magic == WG_PCAP_MAGIC_NSEC) {
+        reader->swapped = false;
+    } else if (__builtin_bswap32(magic) == WG_PCAP_MAGIC_USEC ||
+               __builtin_bswap32(magic) == WG_PCAP_MAGIC_NSEC) {
+        reader->swapped = true;
+        magic = __builtin_bswap32(magic);
+    } else {
+        return WGPcapErrorFormat;
+    }
+    reader->nanosecond = magic == WG_PCAP_MAGIC_NSEC;
+    reader->snapLength = WGPcapRead32(header + 16, reader->swapped);
+
+    // Upper bits may declare an FCS length, in 16-bit words
+    uint32_t linkType = WGPcapRead32(header + 20, reader->swapped);
+    reader->linkType = linkType & 0x03ffffffu;
+    if (linkType & 0x04000000u) {
+        reader->fcsLength = (uint8_t)(2 * (linkType >> 28));
+    }
+    if (reader->linkType != WGPcapLinkRadiotap && reader->linkType != WGPcapLinkIEEE80211) {
+        return WGPcapErrorLinkType;
+    }
+
+    reader->base = data;
+    reader->length = length;
+    reader->offset = WG_PCAP_HEADER_SIZE;
+    return WGPcapErrorNone;
+}
+
+WGPcapError WGPcapOpen(WGPcapReader *reader, const char *path) {
+    memset(reader, 0, sizeof(*reader));
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return WGPcapErrorIO;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        close(fd);
+        return WGPcapErrorIO;
+    }
+    if (st.st_size < WG_PCAP_HEADER_SIZE) {
+        close(fd);
+        return WGPcapErrorFormat;
+    }
+
+    void *base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    int mapError = errno;
+    close(fd);
+    if (base == MAP_FAILED) {
+        errno = mapError;
+        return WGPcapErrorIO;
+    }
+    // Replays read front to back exactly once
+    madvise(base, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+    WGPcapError error = WGPcapLoad(reader, base, (size_t)st.st_size);
+    if (error != WGPcapErrorNone) {
+        munmap(base, (size_t)st.st_size);
+        memset(reader, 0, sizeof(*reader));
+        return error;
+    }
+    reader->mapped = true;
+    return WGPcapErrorNone;
+}
+
+void WGPcapClose(WGPcapReader *reader) {
+    if (reader->mapped) {
+        munmap((void *)reader->base, reader->length);
+    }
+    memset(reader, 0, sizeof(*reader));
+}
+
+void WGPcapRewind(WGPcapReader *reader) {
+    reader->offset = WG_PCAP_HEADER_SIZE;
+    reader->packetCount = 0;
+}
+
+#pragma mark - Records
+
+bool WGPcapNext(WGPcapReader *reader, WGPcapPacket *packet) {
+    if (!reader->base || reader->length - reader->offset < WG_PCAP_RECORD_SIZE) {
+        return false;
+    }
+
+    const uint8_t *record = reader->base + reader->offset;
+    uint32_t seconds = WGPcapRead32(record, reader->swapped);
+    uint32_t fraction = WGPcapRead32(record + 4, reader->swapped);
+    uint32_t captured = WGPcapRead32(record + 8, reader->swapped);
+    uint32_t original = WGPcapRead32(record + 12, reader->swapped);
+
+    size_t remaining = reader->length - reader->offset - WG_PCAP_RECORD_SIZE;
+    if (captured > remaining) {
+        // A capture cut off mid-write; treat as end of file
+        reader->offset = reader->length;
+        return false;
+    }
+
+    packet->data = record + WG_PCAP_RECORD_SIZE;
+    packet->length = captured;
+    packet->originalLength = original;
+    packet->timestamp = seconds + fraction / (reader->nanosecond ? 1e9 : 1e6);
+
+    reader->offset += WG_PCAP_RECORD_SIZE + captured;
+    reader->packetCount++;
+    return true;
+}
+
+const char *WGPcapErrorString(WGPcapError error) {
+    switch (error) {
+        case WGPcapErrorNone:
+            return "No error";
+        case WGPcapErrorIO:
+            return "Could not read capture file";
+        case WGPcapErrorFormat:
+            return "Not a pcap capture (pcapng is not supported)";
+        case WGPcapErrorLinkType:
+            return "Capture is not 802.11 (radiotap or raw)";
+    }
+    return "Unknown error";
+}
@@ -0,0 +1,71 @@
+/*
+ * WGPcap.h - Memory-Mapped pcap Reader
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * Walks a classic libpcap capture (either byte order, micro- or nanosecond
+ * timestamps) in place. Packets are returned as pointers into the mapping,
+ * so nothing is copied per frame; they stay valid until WGPcapClose.
+ *
+ * Only 802.11 link types are accepted: radiotap (127) and raw 802.11
+ * (105). pcapng is not supported - convert with `editcap -F pcap`.
+ */
+
+#ifndef WG_PCAP_H
+#define WG_PCAP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    WGPcapErrorNone = 0,
+    WGPcapErrorIO,          // open/mmap failed (see errno)
+    WGPcapErrorFormat,      // Bad magic or truncated file header
+    WGPcapErrorLinkType     // Not an 802.11 capture
+} WGPcapError;
+
+enum {
+    WGPcapLinkIEEE80211 = 105,
+    WGPcapLinkRadiotap = 127
+};
+
+typedef struct {
+    const uint8_t *data;        // Into the mapping
+    uint32_t length;            // Captured bytes
+    uint32_t originalLength;    // On the wire
+    double timestamp;           // Seconds since 1970
+} WGPcapPacket;
+
+typedef struct {
+    const uint8_t *base;
+    size_t length;
+    size_t offset;              // Next record header
+    bool mapped;                // Unmapped by WGPcapClose
+    bool swapped;               // Written on an opposite-endian host
+    bool nanosecond;
+    uint32_t linkType;
+    uint32_t snapLength;
+    uint8_t fcsLength;          // Trailing FCS bytes declared by the link type
+    uint64_t packetCount;       // Returned so far
+} WGPcapReader;
+
+// Open maps a file read-only; Load reads a caller-owned buffer in place
+WGPcapError WGPcapOpen(WGPcapReader *reader, const char *path);
+WGPcapError WGPcapLoad(WGPcapReader *reader, const void *data, size_t length);
+void WGPcapClose(WGPcapReader *reader);
+void WGPcapRewind(WGPcapReader *reader);
+
+// Next packet; false at end of file or at a truncated trailing record
+bool WGPcapNext(WGPcapReader *reader, WGPcapPacket *packet);
+
+const char *WGPcapErrorString(WGPcapError error);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WG_PCAP_H */
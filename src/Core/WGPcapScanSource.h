@@ -0,0 +1,29 @@
+/*
+ * WGPcapScanSource.h - Capture Replay Scan Source
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * PASSIVE ANALYSIS ONLY - Replays existing 802.11 captures
+ * Continuous source: streams every beacon / probe response of a pcap file
+ * through the scanner as fast as its ingest worker accepts them.
+ */
+
+#import <Foundation/Foundation.h>
+#import "WGScanSource.h"
+#import "WGBeacon.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface WGPcapScanSource : NSObject <WGScanSource>
+
+@property (nonatomic, readonly) NSString *path;
+@property (nonatomic, assign) BOOL rebaseTimestamps;    // Default YES: the first frame is replayed as "now"
+@property (nonatomic, assign) NSUInteger batchSize;     // Default WG_BEACON_REPLAY_BATCH
+@property (atomic, readonly, getter=isReplaying) BOOL replaying;
+@property (atomic, readonly) WGBeaconReplayStats lastStats; // Of the last finished replay
+
+- (instancetype)initWithPath:(NSString *)path;
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
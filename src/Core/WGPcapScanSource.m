@@ -0,0 +1,146 @@
+/*
+ * WGPcapScanSource.m - Capture Replay Scan Source Implementation
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * PASSIVE ANALYSIS ONLY - Replays existing 802.11 captures
+ */
+
+#import "WGPcapScanSource.h"
+
+static NSError *WGPcapScanSourceError(WGPcapError pcapError, NSString *path) {
+    NSString *description = [NSString stringWithFormat:@"%@: %s",
+                             path.lastPathComponent, WGPcapErrorString(pcapError)];
+    return [NSError errorWithDomain:@"WGPcapError"
+                               code:pcapError
+                           userInfo:@{NSLocalizedDescriptionKey: description}];
+}
+
+// Replay sink: context is the source's result handler
+static bool WGPcapScanSourceSink(void *context, const WGScanRecord *records, size_t count) {
+    WGScanSourceResultHandler resultHandler = (__bridge WGScanSourceResultHandler)context;
+    resultHandler(records, count);
+    return true;
+}
+
+@interface WGPcapScanSource () {
+    bool _cancel;   // Polled by the replay between batches
+}
+
+@property (nonatomic, strong) dispatch_queue_t replayQueue;
+@property (atomic, assign) BOOL replaying;
+@property (atomic, assign) WGBeaconReplayStats lastStats;
+
+@end
+
+@implementation WGPcapScanSource
+
+@synthesize resultHandler = _resultHandler;
+@synthesize errorHandler = _errorHandler;
+
+- (instancetype)initWithPath:(NSString *)path {
+    self = [super init];
+    if (self) {
+        _path = [path copy];
+        _rebaseTimestamps = YES;
+        _batchSize = WG_BEACON_REPLAY_BATCH;
+        _replayQueue = dispatch_queue_create("com.wifiguard.pcapreplay", DISPATCH_QUEUE_SERIAL);
+    }
+    return self;
+}
+
+#pragma mark - WGScanSource
+
+- (NSString *)name {
+    return [NSString stringWithFormat:@"Capture (%@)", self.path.lastPathComponent];
+}
+
+- (BOOL)isContinuous {
+    return YES;
+}
+
+- (BOOL)prepare:(NSError **)error {
+    WGPcapReader reader;
+    WGPcapError pcapError = WGPcapOpen(&reader, self.path.fileSystemRepresentation);
+    if (pcapError != WGPcapErrorNone) {
+        if (error) {
+            *error = WGPcapScanSourceError(pcapError, self.path);
+        }
+        return NO;
+    }
+    WGPcapClose(&reader);
+    return YES;
+}
+
+- (void)requestScan {
+    if (self.replaying) {
+        return;
+    }
+    WGScanSourceResultHandler resultHandler = self.resultHandler;
+    if (!resultHandler) {
+        return;
+    }
+    self.replaying = YES;
+    __atomic_store_n(&_cancel, false, __ATOMIC_RELAXED);
+
+    NSString *path = self.path;
+    BOOL rebase = self.rebaseTimestamps;
+    size_t batchSize = self.batchSize;
+    dispatch_async(self.replayQueue, ^{
+        [self replayPath:path rebase:rebase batchSize:batchSize resultHandler:resultHandler];
+        self.replaying = NO;
+    });
+}
+
+- (void)stop {
+    __atomic_store_n(&_cancel, true, __ATOMIC_RELAXED);
+}
+
+- (NSString *)diagnosticStatus {
+    if (![[NSFileManager defaultManager] isReadableFileAtPath:self.path]) {
+        return [NSString stringWithFormat:@"❌ Cannot read %@", self.path.lastPathComponent];
+    }
+    return nil;
+}
+
+#pragma mark - Replay
+
+- (void)replayPath:(NSString *)path
+            rebase:(BOOL)rebase
+         batchSize:(size_t)batchSize
+     resultHandler:(WGScanSourceResultHandler)resultHandler {
+    WGPcapReader reader;
+    WGPcapError pcapError = WGPcapOpen(&reader, path.fileSystemRepresentation);
+    if (pcapError != WGPcapErrorNone) {
+        WGScanSourceErrorHandler errorHandler = self.errorHandler;
+        if (errorHandler) {
+            errorHandler(WGPcapScanSourceError(pcapError, path));
+        }
+        return;
+    }
+
+    // Peek at the first packet so rebased timestamps start at "now"
+    WGBeaconReplayOptions options = {
+        .batchSize = batchSize,
+        .cancel = &_cancel
+    };
+    WGPcapPacket first;
+    if (rebase && WGPcapNext(&reader, &first)) {
+        options.timeShift = [[NSDate date] timeIntervalSince1970] - first.timestamp;
+        WGPcapRewind(&reader);
+    }
+
+    NSTimeInterval start = [NSProcessInfo processInfo].systemUptime;
+    WGBeaconReplayStats stats;
+    bool completed = WGBeaconReplay(&reader, &options, WGPcapScanSourceSink,
+                                    (__bridge void *)resultHandler, &stats);
+    NSTimeInterval elapsed = [NSProcessInfo processInfo].systemUptime - start;
+    WGPcapClose(&reader);
+
+    self.lastStats = stats;
+    NSLog(@"[WiFiGuard] Replay of %@ %@: %llu packets, %llu beacons, %llu skipped in %.2fs",
+          path.lastPathComponent, completed ? @"finished" : @"stopped",
+          (unsigned long long)stats.packets, (unsigned long long)stats.beacons,
+          (unsigned long long)stats.skipped, elapsed);
+}
+
+@end
@@ -0,0 +1,334 @@
+/*
+ * WGRateWindow.c - Sliding-Window Change Rate Engine Implementation
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * DETECTION ONLY - NO ACTIVE ATTACKS OR COUNTERMEASURES
+ */
+
+#include "WGRateWindow.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define WG_RATE_NO_HOST UINT32_MAX
+
+uint64_t WGRateClockMonotonicMs(void *context) {
+    (void)context;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+}
+
+#pragma mark - Wheel
+
+static bool WGRateWheelInit(WGRateWheel *wheel, uint32_t bucketCount, uint32_t limit) {
+    memset(wheel, 0, sizeof(*wheel));
+    wheel->buckets = calloc(bucketCount, sizeof(WGRateBucket));
+    if (!wheel->buckets || !WGHashMapInit(&wheel->index, 64)) {
+        free(wheel->buckets);
+        wheel->buckets = NULL;
+        return false;
+    }
+    wheel->bucketCount = bucketCount;
+    wheel->limit = limit;
+    wheel->freeHost = WG_RATE_NO_HOST;
+    return true;
+}
+
+static void WGRateWheelFree(WGRateWheel *wheel) {
+    if (wheel->buckets) {
+        for (uint32_t i = 0; i < wheel->bucketCount; i++) {
+            free(wheel->buckets[i].entries);
+        }
+    }
+    free(wheel->buckets);
+    free(wheel->hosts);
+    WGHashMapFree(&wheel->index);
+    memset(wheel, 0, sizeof(*wheel));
+}
+
+static void WGRateWheelClear(WGRateWheel *wheel) {
+    for (uint32_t i = 0; i < wheel->bucketCount; i++) {
+        wheel->buckets[i].count = 0;
+    }
+    WGHashMapClear(&wheel->index);
+    wheel->hostCount = 0;
+    wheel->liveHosts = 0;
+    wheel->freeHost = WG_RATE_NO_HOST;
+    wheel->total = 0;
+    wheel->started = false;
+}
+
+static void WGRateWheelExpireBucket(WGRateWheel *wheel, WGRateBucket *bucket) {
+    for (uint32_t i = 0; i < bucket->count; i++) {
+        const WGRateEntry *entry = &bucket->entries[i];
+        WGRateHost *host = &wheel->hosts[entry->host];
+        host->total -= entry->count;
+        wheel->total -= entry->count;
+
+        if (host->total == 0) {
+            // Every entry of this host has expired; recycle the slot
+            WGHashMapRemove(&wheel->index, host->key);
+            host->lastEntry = wheel->freeHost;
+            wheel->freeHost = entry->host;
+            wheel->liveHosts--;
+        } else if (host->reported && host->total <= wheel->limit) {
+            host->reported = false;
+        }
+    }
+    bucket->count = 0;
+}
+
+static void WGRateWheelAdvance(WGRateWheel *wheel, uint64_t epoch) {
+    if (!wheel->started) {
+        wheel->epoch = epoch;
+        wheel->started = true;
+        return;
+    }
+    if (epoch <= wheel->epoch) {
+        return;
+    }
+
+    // Buckets between the old and new epoch fell out of the window
+    uint64_t steps = epoch - wheel->epoch;
+    if (steps > wheel->bucketCount) {
+        steps = wheel->bucketCount;
+    }
+    for (uint64_t s = 1; s <= steps; s++) {
+        uint64_t expired = epoch - steps + s;
+        WGRateWheelExpireBucket(wheel, &wheel->buckets[expired % wheel->bucketCount]);
+    }
+    wheel->epoch = epoch;
+}
+
+static uint32_t WGRateWheelAllocHost(WGRateWheel *wheel) {
+    if (wheel->freeHost != WG_RATE_NO_HOST) {
+        uint32_t slot = wheel->freeHost;
+        wheel->freeHost = wheel->hosts[slot].lastEntry;
+        return slot;
+    }
+    if (wheel->hostCount == wheel->hostCapacity) {
+        uint32_t newCapacity = wheel->hostCapacity ? wheel->hostCapacity * 2 : 64;
+        WGRateHost *grown = realloc(wheel->hosts, newCapacity * sizeof(WGRateHost));
+        if (!grown) {
+            return WG_RATE_NO_HOST;
+        }
+        wheel->hosts = grown;
+        wheel->hostCapacity = newCapacity;
+    }
+    return wheel->hostCount++;
+}
+
+// Adds one change for key in the current epoch; returns its host or NULL
+static WGRateHost *WGRateWheelAdd(WGRateWheel *wheel, uint64_t key) {
+    uint64_t *slotValue = WGHashMapFind(&wheel->index, key);
+    uint32_t slot;
+    if (slotValue) {
+        slot = (uint32_t)*slotValue;
+    } else {
+        slot = WGRateWheelAllocHost(wheel);
+        if (slot == WG_RATE_NO_HOST || !WGHashMapPut(&wheel->index, key, slot)) {
+            if (slot != WG_RATE_NO_HOST) {
+                wheel->hosts[slot].lastEntry = wheel->freeHost;
+                wheel->freeHost = slot;
+            }
+            return NULL;
+        }
+        WGRateHost *host = &wheel->hosts[slot];
+        memset(host, 0, sizeof(*host));
+        host->key = key;
+        host->lastEpoch = UINT64_MAX;
+        wheel->liveHosts++;
+    }
+
+    WGRateHost *host = &wheel->hosts[slot];
+    WGRateBucket *bucket = &wheel->buckets[wheel->epoch % wheel->bucketCount];
+    if (host->lastEpoch == wheel->epoch) {
+        bucket->entries[host->lastEntry].count++;
+    } else {
+        if (bucket->count == bucket->capacity) {
+            uint32_t newCapacity = bucket->capacity ? bucket->capacity * 2 : 16;
+            WGRateEntry *grown = realloc(bucket->entries, newCapacity * sizeof(WGRateEntry));
+            if (!grown) {
+                if (host->total == 0) {
+                    WGHashMapRemove(&wheel->index, key);
+                    host->lastEntry = wheel->freeHost;
+                    wheel->freeHost = slot;
+                    wheel->liveHosts--;
+                }
+                return NULL;
+            }
+            bucket->entries = grown;
+            bucket->capacity = newCapacity;
+        }
+        host->lastEpoch = wheel->epoch;
+        host->lastEntry = bucket->count;
+        bucket->entries[bucket->count++] = (WGRateEntry){ .host = slot, .count = 1 };
+    }
+    host->total++;
+    wheel->total++;
+    return host;
+}
+
+static uint32_t WGRateWheelCount(const WGRateWheel *wheel, uint64_t key) {
+    const uint64_t *slot = WGHashMapFind(&wheel->index, key);
+    return slot ? wheel->hosts[*slot].total : 0;
+}
+
+#pragma mark - Lifecycle
+
+bool WGRateWindowInit(WGRateWindow *window, WGRateClockFn clock, void *clockContext) {
+    memset(window, 0, sizeof(*window));
+    window->clock = clock ? clock : WGRateClockMonotonicMs;
+    window->clockContext = clockContext;
+    return WGRateWindowConfigure(window, 60000, 60, 5, 5, 10);
+}
+
+void WGRateWindowFree(WGRateWindow *window) {
+    WGRateWheelFree(&window->ips);
+    WGRateWheelFree(&window->macs);
+    free(window->offenders);
+    window->offenders = NULL;
+    window->offenderCount = window->offenderCapacity = 0;
+}
+
+void WGRateWindowReset(WGRateWindow *window) {
+    WGRateWheelClear(&window->ips);
+    WGRateWheelClear(&window->macs);
+    window->totalReported = false;
+    window->offenderCount = 0;
+}
+
+bool WGRateWindowConfigure(WGRateWindow *window, uint32_t windowMs, uint32_t bucketCount,
+                           uint32_t ipLimit, uint32_t macLimit, uint32_t totalLimit) {
+    if (windowMs == 0) {
+        windowMs = 1;
+    }
+    if (bucketCount == 0) {
+        bucketCount = 1;
+    }
+    if (bucketCount > windowMs) {
+        bucketCount = windowMs;
+    }
+
+    WGRateWheelFree(&window->ips);
+    WGRateWheelFree(&window->macs);
+    window->windowMs = windowMs;
+    window->bucketMs = windowMs / bucketCount;
+    window->ipLimit = ipLimit;
+    window->macLimit = macLimit;
+    window->totalLimit = totalLimit;
+    window->totalReported = false;
+    window->offenderCount = 0;
+
+    if (!WGRateWheelInit(&window->ips, bucketCount, ipLimit) ||
+        !WGRateWheelInit(&window->macs, bucketCount, macLimit)) {
+        WGRateWheelFree(&window->ips);
+        WGRateWheelFree(&window->macs);
+        return false;
+    }
+    return true;
+}
+
+#pragma mark - Recording
+
+static bool WGRateWindowAddOffender(WGRateWindow *window, WGRateKeyKind kind, uint64_t key, uint32_t count) {
+    if (window->offenderCount == window->offenderCapacity) {
+        size_t newCapacity = window->offenderCapacity ? window->offenderCapacity * 2 : 8;
+        WGRateOffender *grown = realloc(window->offenders, newCapacity * sizeof(WGRateOffender));
+        if (!grown) {
+            return false;
+        }
+        window->offenders = grown;
+        window->offenderCapacity = newCapacity;
+    }
+    window->offenders[window->offenderCount++] = (WGRateOffender){
+        .kind = (uint8_t)kind, .key = key, .count = count
+    };
+    return true;
+}
+
+void WGRateWindowAdvance(WGRateWindow *window) {
+    uint64_t epoch = window->clock(window->clockContext) / window->bucketMs;
+    WGRateWheelAdvance(&window->ips, epoch);
+    WGRateWheelAdvance(&window->macs, epoch);
+    if (window->totalReported && window->ips.total <= window->totalLimit) {
+        window->totalReported = false;
+    }
+}
+
+bool WGRateWindowRecord(WGRateWindow *window, uint32_t ip, uint64_t mac) {
+    WGRateWindowAdvance(window);
+
+    WGRateHost *host = WGRateWheelAdd(&window->ips, ip);
+    if (!host) {
+        return false;
+    }
+    if (window->ipLimit && !host->reported && host->total > window->ipLimit) {
+        host->reported = true;
+        if (!WGRateWindowAddOffender(window, WGRateKeyIP, ip, host->total)) {
+            return false;
+        }
+    }
+
+    host = WGRateWheelAdd(&window->macs, mac);
+    if (!host) {
+        return false;
+    }
+    if (window->macLimit && !host->reported && host->total > window->macLimit) {
+        host->reported = true;
+        if (!WGRateWindowAddOffender(window, WGRateKeyMAC, mac, host->total)) {
+            return false;
+        }
+    }
+
+    uint64_t total = window->ips.total;
+    if (window->totalLimit && !window->totalReported && total > window->totalLimit) {
+        window->totalReported = true;
+        return WGRateWindowAddOffender(window, WGRateKeyTotal, 0,
+                                       total > UINT32_MAX ? UINT32_MAX : (uint32_t)total);
+    }
+    return true;
+}
+
+#pragma mark - Queries
+
+uint32_t WGRateWindowCount(WGRateWindow *window, WGRateKeyKind kind, uint64_t key) {
+    WGRateWindowAdvance(window);
+    switch (kind) {
+        case WGRateKeyIP:
+            return WGRateWheelCount(&window->ips, key);
+        case WGRateKeyMAC:
+            return WGRateWheelCount(&window->macs, key);
+        case WGRateKeyTotal:
+            return window->ips.total > UINT32_MAX ? UINT32_MAX : (uint32_t)window->ips.total;
+    }
+    return 0;
+}
+
+size_t WGRateWindowTopKeys(const WGRateWindow *window, WGRateKeyKind kind,
+                           WGRateOffender *out, size_t max) {
+    if (kind == WGRateKeyTotal || max == 0) {
+        return 0;
+    }
+    const WGRateWheel *wheel = kind == WGRateKeyIP ? &window->ips : &window->macs;
+
+    // Insertion into a small sorted array; max is a handful of hosts
+    size_t found = 0;
+    size_t cursor = 0;
+    uint64_t key, slot;
+    while (WGHashMapNext(&wheel->index, &cursor, &key, &slot)) {
+        uint32_t count = wheel->hosts[slot].total;
+        if (found == max && count <= out[max - 1].count) {
+            continue;
+        }
+        size_t pos = found < max ? found++ : max - 1;
+        while (pos > 0 && out[pos - 1].count < count) {
+            out[pos] = out[pos - 1];
+            pos--;
+        }
+        out[pos] = (WGRateOffender){ .kind = (uint8_t)kind, .key = key, .count = count };
+    }
+    return found;
+}
@@ -0,0 +1,137 @@
+/*
+ * WGRateWindow.h - Sliding-Window Change Rate Engine
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * Counts ARP MAC changes per IP, per MAC and in total over a sliding window.
+ * Each counter lives in a time wheel of bucketCount buckets; a bucket holds
+ * one (host, count) entry per host that changed during it, so recording is
+ * a hash lookup plus an increment and expiring a bucket touches only the
+ * hosts that were active in it.
+ *
+ * Time comes from an injectable millisecond clock, which keeps the engine
+ * deterministic under synthetic event streams (simulation, bench, Linux).
+ */
+
+#ifndef WG_RATE_WINDOW_H
+#define WG_RATE_WINDOW_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "WGHashMap.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Returns monotonic milliseconds; must never go backwards
+typedef uint64_t (*WGRateClockFn)(void *context);
+
+uint64_t WGRateClockMonotonicMs(void *context);
+
+typedef enum {
+    WGRateKeyIP = 0,
+    WGRateKeyMAC,
+    WGRateKeyTotal      // Every change, key is 0
+} WGRateKeyKind;
+
+// A counter that went over its limit (reported once until it drops back)
+typedef struct {
+    uint8_t kind;       // WGRateKeyKind
+    uint64_t key;       // Packed IPv4 or MAC
+    uint32_t count;     // Changes in the window when reported
+} WGRateOffender;
+
+typedef struct {
+    uint32_t host;      // Index into WGRateWheel.hosts
+    uint32_t count;
+} WGRateEntry;
+
+typedef struct {
+    WGRateEntry *entries;
+    uint32_t count;
+    uint32_t capacity;
+} WGRateBucket;
+
+typedef struct {
+    uint64_t key;
+    uint64_t lastEpoch;     // Bucket epoch of the last change
+    uint32_t lastEntry;     // Entry index in that bucket (free list link when unused)
+    uint32_t total;         // Changes in the window
+    bool reported;
+} WGRateHost;
+
+// Keyed counter over bucketCount buckets
+typedef struct {
+    WGRateBucket *buckets;
+    uint32_t bucketCount;
+    uint32_t limit;         // 0 disables reporting
+    uint64_t epoch;         // Newest bucket epoch
+    bool started;
+    WGHashMap index;        // key -> host slot
+    WGRateHost *hosts;
+    uint32_t hostCount;     // Slots handed out (live + free)
+    uint32_t hostCapacity;
+    uint32_t freeHost;      // Head of the free slot list, UINT32_MAX if none
+    uint32_t liveHosts;
+    uint64_t total;         // Changes in the window over all keys
+} WGRateWheel;
+
+typedef struct {
+    // Configuration - set through WGRateWindowConfigure
+    uint32_t windowMs;
+    uint32_t bucketMs;
+    uint32_t ipLimit;       // Changes one IP may see per window
+    uint32_t macLimit;      // IPs one MAC may take over per window
+    uint32_t totalLimit;    // Changes the whole table may see per window
+
+    // State
+    WGRateClockFn clock;
+    void *clockContext;
+    WGRateWheel ips;
+    WGRateWheel macs;
+    bool totalReported;
+
+    // Offenders since the last WGRateWindowClearOffenders
+    WGRateOffender *offenders;
+    size_t offenderCount;
+    size_t offenderCapacity;
+} WGRateWindow;
+
+// Lifecycle - clock may be NULL for WGRateClockMonotonicMs. Defaults to a
+// 60 s window of 1 s buckets, 10 total / 5 per-IP / 5 per-MAC changes.
+bool WGRateWindowInit(WGRateWindow *window, WGRateClockFn clock, void *clockContext);
+void WGRateWindowFree(WGRateWindow *window);
+void WGRateWindowReset(WGRateWindow *window);
+
+// Changes the window length and limits; clears all counters. bucketCount
+// is clamped to [1, windowMs]. Returns false on allocation failure.
+bool WGRateWindowConfigure(WGRateWindow *window, uint32_t windowMs, uint32_t bucketCount,
+                           uint32_t ipLimit, uint32_t macLimit, uint32_t totalLimit);
+
+// Records one MAC change (ip now answers with mac) at the clock's current
+// time. Counters that exceed their limit are appended to offenders.
+bool WGRateWindowRecord(WGRateWindow *window, uint32_t ip, uint64_t mac);
+
+// Expires buckets older than the window; re-arms counters that dropped
+// back to their limit. Record and Count do this implicitly.
+void WGRateWindowAdvance(WGRateWindow *window);
+
+// Changes in the window for a key (key ignored for WGRateKeyTotal)
+uint32_t WGRateWindowCount(WGRateWindow *window, WGRateKeyKind kind, uint64_t key);
+
+// Up to max keys with the most changes in the window, busiest first.
+// Scans every live key; meant for building alert details.
+size_t WGRateWindowTopKeys(const WGRateWindow *window, WGRateKeyKind kind,
+                           WGRateOffender *out, size_t max);
+
+static inline void WGRateWindowClearOffenders(WGRateWindow *window) {
+    window->offenderCount = 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WG_RATE_WINDOW_H */
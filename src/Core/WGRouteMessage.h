@@ -0,0 +1,157 @@
+/*
+ * WGRouteMessage.h - Routing Message Wire Format (internal)
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * Darwin PF_ROUTE and Linux rtnetlink layouts, declared with fixed-width
+ * types so both decoders build on either platform. Shared by WGARPTable
+ * (sysctl dumps) and WGARPWatch (live notifications).
+ */
+
+#ifndef WG_ROUTE_MESSAGE_H
+#define WG_ROUTE_MESSAGE_H
+
+#include "WGARPTable.h"
+
+#include <stdint.h>
+
+// Darwin constants (fixed values, independent of the build host)
+#define WG_AF_INET          2
+#define WG_AF_LINK          18
+#define WG_RTM_VERSION      5
+#define WG_RTM_ADD          0x1
+#define WG_RTM_DELETE       0x2
+#define WG_RTM_CHANGE       0x3
+#define WG_RTM_GET          0x4
+#define WG_RTM_RESOLVE      0xb
+#define WG_RTF_UP           0x1
+#define WG_RTF_GATEWAY      0x2
+#define WG_RTF_HOST         0x4
+#define WG_RTF_LLINFO       0x400
+#define WG_RTF_STATIC       0x800
+#define WG_RTA_DST          0x1
+#define WG_RTA_GATEWAY      0x2
+#define WG_RTAX_MAX         8
+
+// Socket addresses in route messages are padded to 32-bit boundaries
+#define WG_RT_ROUNDUP(a) ((a) > 0 ? (1 + (((a) - 1) | (sizeof(uint32_t) - 1))) : sizeof(uint32_t))
+
+// struct rt_msghdr (92 bytes)
+typedef struct {
+    uint16_t rtm_msglen;
+    uint8_t  rtm_version;
+    uint8_t  rtm_type;
+    uint16_t rtm_index;
+    int32_t  rtm_flags;
+    int32_t  rtm_addrs;
+    int32_t  rtm_pid;
+    int32_t  rtm_seq;
+    int32_t  rtm_errno;
+    int32_t  rtm_use;
+    uint32_t rtm_inits;
+    uint32_t rtm_rmx[14];   // struct rt_metrics
+} wg_rt_msghdr;
+
+// struct sockaddr_inarp (16 bytes; sockaddr_in shares the first 8)
+typedef struct {
+    uint8_t  sin_len;
+    uint8_t  sin_family;
+    uint16_t sin_port;
+    uint8_t  sin_addr[4];
+    uint8_t  sin_srcaddr[4];
+    uint16_t sin_tos;
+    uint16_t sin_other;
+} wg_sockaddr_inarp;
+
+// struct sockaddr_dl (20 bytes, sdl_data may extend past 12)
+typedef struct {
+    uint8_t  sdl_len;
+    uint8_t  sdl_family;
+    uint16_t sdl_index;
+    uint8_t  sdl_type;
+    uint8_t  sdl_nlen;
+    uint8_t  sdl_alen;
+    uint8_t  sdl_slen;
+    uint8_t  sdl_data[12];
+} wg_sockaddr_dl;
+
+#define WG_SDL_DATA_OFFSET  8
+#define WG_IFT_ETHER        0x6
+
+// Linux rtnetlink constants
+#define WG_NLMSG_ERROR      2
+#define WG_NLMSG_DONE       3
+#define WG_RTM_NEWROUTE     24
+#define WG_RTM_DELROUTE     25
+#define WG_RTM_NEWNEIGH     28
+#define WG_RTM_DELNEIGH     29
+#define WG_RTMGRP_NEIGH     0x4
+#define WG_RTMGRP_IPV4_ROUTE 0x40
+#define WG_NDA_DST          1
+#define WG_NDA_LLADDR       2
+#define WG_RTA_OIF          4
+#define WG_RTA_GATEWAY_NL   5
+#define WG_RT_TABLE_MAIN    254
+#define WG_NUD_INCOMPLETE   0x01
+#define WG_NUD_FAILED       0x20
+#define WG_NUD_NOARP        0x40
+#define WG_NUD_PERMANENT    0x80
+#define WG_NL_ALIGN(len)    (((len) + 3) & ~(size_t)3)
+
+// struct nlmsghdr (16 bytes)
+typedef struct {
+    uint32_t nlmsg_len;
+    uint16_t nlmsg_type;
+    uint16_t nlmsg_flags;
+    uint32_t nlmsg_seq;
+    uint32_t nlmsg_pid;
+} wg_nlmsghdr;
+
+// struct ndmsg (12 bytes)
+typedef struct {
+    uint8_t  ndm_family;
+    uint8_t  ndm_pad1;
+    uint16_t ndm_pad2;
+    int32_t  ndm_ifindex;
+    uint16_t ndm_state;
+    uint8_t  ndm_flags;
+    uint8_t  ndm_type;
+} wg_ndmsg;
+
+// struct rtmsg (12 bytes)
+typedef struct {
+    uint8_t  rtm_family;
+    uint8_t  rtm_dst_len;
+    uint8_t  rtm_src_len;
+    uint8_t  rtm_tos;
+    uint8_t  rtm_table;
+    uint8_t  rtm_protocol;
+    uint8_t  rtm_scope;
+    uint8_t  rtm_type;
+    uint32_t rtm_flags;
+} wg_rtmsg;
+
+// struct rtattr (4 bytes)
+typedef struct {
+    uint16_t rta_len;
+    uint16_t rta_type;
+} wg_rtattr;
+
+static inline uint64_t WGRouteReadMAC(const uint8_t *mac) {
+    return ((uint64_t)mac[0] << 40) | ((uint64_t)mac[1] << 32) |
+           ((uint64_t)mac[2] << 24) | ((uint64_t)mac[3] << 16) |
+           ((uint64_t)mac[4] << 8)  |  (uint64_t)mac[5];
+}
+
+static inline uint32_t WGRouteReadIPv4(const uint8_t *addr) {
+    return ((uint32_t)addr[0] << 24) | ((uint32_t)addr[1] << 16) |
+           ((uint32_t)addr[2] << 8)  |  (uint32_t)addr[3];
+}
+
+// Writes one Darwin ARP route message of the given rtm_type; returns its size
+size_t WGRouteEncodeARPMessage(const WGARPRecord *record, uint8_t type, void *buf);
+
+// Writes one Darwin default route via gateway->ip on gateway->ifindex
+size_t WGRouteGatewayMessageSize(void);
+size_t WGRouteEncodeGatewayMessage(const WGARPRecord *gateway, uint8_t type, void *buf);
+
+#endif /* WG_ROUTE_MESSAGE_H */
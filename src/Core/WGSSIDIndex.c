@@ -0,0 +1,245 @@
+/*
+ * WGSSIDIndex.c - SSID -> BSSID Index Implementation
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ */
+
+#include "WGSSIDIndex.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define WG_SSID_INDEX_MIN_CAPACITY 64
+
+static uint64_t WGSSIDHash(const char *ssid, size_t length) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (uint8_t)ssid[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash == WG_HASH_MAP_EMPTY ? hash - 1 : hash;
+}
+
+static inline uint64_t WGSSIDSeenKey(size_t slot, WGMACAddress bssid) {
+    return (uint64_t)slot << 48 | (bssid & 0xFFFFFFFFFFFFULL);
+}
+
+WGSecurityRank WGSecurityRankFromName(const char *security) {
+    static const char * const names[WGSecurityRankCount] = { "Open", "WEP", "WPA", "WPA2", "WPA3" };
+    for (int rank = 0; rank < WGSecurityRankCount; rank++) {
+        if (strcmp(security, names[rank]) == 0) {
+            return (WGSecurityRank)rank;
+        }
+    }
+    return WGSecurityRankUnknown;
+}
+
+WGSecurityRank WGSSIDGroupKnownSecurity(const WGSSIDGroup *group) {
+    for (int rank = WGSecurityRankCount - 1; rank >= 0; rank--) {
+        if (group->securityMask & (1u << rank)) {
+            return (WGSecurityRank)rank;
+        }
+    }
+    return WGSecurityRankUnknown;
+}
+
+#pragma mark - Lifecycle
+
+bool WGSSIDIndexInit(WGSSIDIndex *index) {
+    memset(index, 0, sizeof(*index));
+    index->settleTime = 60;
+    if (!WGHashMapInit(&index->bySSID, 256)) {
+        return false;
+    }
+    if (!WGPostingsInit(&index->current, 256)) {
+        WGHashMapFree(&index->bySSID);
+        return false;
+    }
+    if (!WGHashMapInit(&index->seen, 1024)) {
+        WGPostingsFree(&index->current);
+        WGHashMapFree(&index->bySSID);
+        return false;
+    }
+    return true;
+}
+
+void WGSSIDIndexFree(WGSSIDIndex *index) {
+    free(index->groups);
+    index->groups = NULL;
+    index->groupCount = index->groupCapacity = 0;
+    WGHashMapFree(&index->bySSID);
+    WGPostingsFree(&index->current);
+    WGHashMapFree(&index->seen);
+}
+
+void WGSSIDIndexClear(WGSSIDIndex *index) {
+    index->groupCount = 0;
+    WGHashMapClear(&index->bySSID);
+    WGPostingsClear(&index->current);
+    WGHashMapClear(&index->seen);
+}
+
+#pragma mark - Groups
+
+// Slot of the group for an SSID, or -1. A 64-bit hash collision between
+// two SSIDs leaves the second one unindexed rather than merged.
+static long WGSSIDIndexSlot(const WGSSIDIndex *index, const char *ssid, size_t length, uint64_t hash) {
+    const uint64_t *slot = WGHashMapFind(&index->bySSID, hash);
+    if (!slot) {
+        return -1;
+    }
+    const WGSSIDGroup *group = &index->groups[*slot];
+    if (group->ssidLength != length || memcmp(group->ssid, ssid, length) != 0) {
+        return -1;
+    }
+    return (long)*slot;
+}
+
+static long WGSSIDIndexCreate(WGSSIDIndex *index, const WGSSIDMember *member, uint64_t hash) {
+    if (index->groupCount >= WG_SSID_INDEX_MAX_GROUPS || WGHashMapFind(&index->bySSID, hash)) {
+        return -1;
+    }
+    if (index->groupCount == index->groupCapacity) {
+        size_t capacity = index->groupCapacity ? index->groupCapacity * 2 : WG_SSID_INDEX_MIN_CAPACITY;
+        WGSSIDGroup *groups = realloc(index->groups, capacity * sizeof(WGSSIDGroup));
+        if (!groups) {
+            return -1;
+        }
+        index->groups = groups;
+        index->groupCapacity = capacity;
+    }
+    if (!WGHashMapPut(&index->bySSID, hash, index->groupCount)) {
+        return -1;
+    }
+
+    WGSSIDGroup *group = &index->groups[index->groupCount];
+    memset(group, 0, sizeof(*group));
+    group->hash = hash;
+    group->ssidLength = (uint8_t)member->ssidLength;
+    memcpy(group->ssid, member->ssid, member->ssidLength);
+    group->firstSeen = member->timestamp;
+    return (long)index->groupCount++;
+}
+
+const WGSSIDGroup *WGSSIDIndexFind(const WGSSIDIndex *index, const char *ssid, size_t ssidLength) {
+    if (ssidLength == 0 || ssidLength > WG_SSID_INDEX_SSID_MAX) {
+        return NULL;
+    }
+    long slot = WGSSIDIndexSlot(index, ssid, ssidLength, WGSSIDHash(ssid, ssidLength));
+    return slot >= 0 ? &index->groups[slot] : NULL;
+}
+
+size_t WGSSIDIndexMembers(const WGSSIDIndex *index, const WGSSIDGroup *group, const uint64_t **bssids) {
+    return WGPostingsGet(&index->current, (uint64_t)(group - index->groups), bssids);
+}
+
+static bool WGSSIDGroupHasVendor(const WGSSIDGroup *group, uint32_t vendor) {
+    for (uint8_t i = 0; i < group->vendorCount; i++) {
+        if (group->vendors[i] == vendor) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void WGSSIDGroupLearn(WGSSIDGroup *group, const WGSSIDMember *member, int channelSlot, uint32_t vendor) {
+    if (member->security != WGSecurityRankUnknown) {
+        group->securityMask |= (uint8_t)(1u << member->security);
+    }
+    if (channelSlot >= 0) {
+        group->channels[channelSlot / 64] |= 1ULL << (channelSlot % 64);
+    }
+    if (!WGSSIDGroupHasVendor(group, vendor) && group->vendorCount < WG_SSID_INDEX_MAX_VENDORS) {
+        group->vendors[group->vendorCount++] = vendor;
+    }
+}
+
+#pragma mark - Updates
+
+bool WGSSIDIndexAdd(WGSSIDIndex *index, const WGSSIDMember *member, WGSSIDAlert *alert) {
+    if (member->ssidLength == 0 || member->ssidLength > WG_SSID_INDEX_SSID_MAX) {
+        return false;
+    }
+    uint64_t hash = WGSSIDHash(member->ssid, member->ssidLength);
+    long slot = WGSSIDIndexSlot(index, member->ssid, member->ssidLength, hash);
+    if (slot < 0 && (slot = WGSSIDIndexCreate(index, member, hash)) < 0) {
+        return false;
+    }
+    if (!WGPostingsAdd(&index->current, (uint64_t)slot, member->bssid)) {
+        return false;
+    }
+
+    WGSSIDGroup *group = &index->groups[slot];
+    if (member->security != WGSecurityRankUnknown) {
+        group->securityCounts[member->security]++;
+    }
+
+    bool inserted = false;
+    uint64_t *seen = WGHashMapInsert(&index->seen, WGSSIDSeenKey((size_t)slot, member->bssid), &inserted);
+    if (seen) {
+        *seen = 1;
+    }
+    int channelSlot = WGChannelSlotIndex(member->band, member->channel);
+    uint32_t vendor = WGSSIDIndexVendorKey(member);
+
+    // Still learning what this SSID normally looks like
+    if (member->timestamp - group->firstSeen < index->settleTime) {
+        WGSSIDGroupLearn(group, member, channelSlot, vendor);
+        return false;
+    }
+
+    bool newChannel = channelSlot >= 0 && !(group->channels[channelSlot / 64] & (1ULL << (channelSlot % 64)));
+    bool newVendor = group->vendorCount < WG_SSID_INDEX_MAX_VENDORS && !WGSSIDGroupHasVendor(group, vendor);
+    WGSecurityRank known = WGSSIDGroupKnownSecurity(group);
+
+    WGSSIDAlertType type = WGSSIDAlertNone;
+    if (member->security != WGSecurityRankUnknown && known != WGSecurityRankUnknown &&
+        member->security < known && (inserted || newChannel)) {
+        type = WGSSIDAlertDowngrade;
+    } else if (inserted && newVendor) {
+        type = WGSSIDAlertEvilTwin;
+    }
+    if (type == WGSSIDAlertNone) {
+        WGSSIDGroupLearn(group, member, channelSlot, vendor);
+        return false;
+    }
+
+    const uint64_t *members;
+    *alert = (WGSSIDAlert){
+        .type = type,
+        .bssid = member->bssid,
+        .timestamp = member->timestamp,
+        .band = member->band,
+        .channel = member->channel,
+        .security = (int8_t)member->security,
+        .knownSecurity = (int8_t)known,
+        .newBSSID = inserted,
+        .newChannel = newChannel,
+        .newVendor = newVendor,
+        .vendor = member->vendor,
+        .bssidCount = (uint32_t)WGSSIDIndexMembers(index, group, &members),
+        .ssidLength = group->ssidLength
+    };
+    memcpy(alert->ssid, group->ssid, group->ssidLength + 1);
+    return true;
+}
+
+void WGSSIDIndexRemove(WGSSIDIndex *index, const WGSSIDMember *member) {
+    if (member->ssidLength == 0 || member->ssidLength > WG_SSID_INDEX_SSID_MAX) {
+        return;
+    }
+    long slot = WGSSIDIndexSlot(index, member->ssid, member->ssidLength,
+                                WGSSIDHash(member->ssid, member->ssidLength));
+    if (slot < 0 || !WGPostingsRemove(&index->current, (uint64_t)slot, member->bssid)) {
+        return;
+    }
+    WGSSIDGroup *group = &index->groups[slot];
+    if (member->security != WGSecurityRankUnknown && group->securityCounts[member->security] > 0) {
+        group->securityCounts[member->security]--;
+    }
+}
+
+bool WGSSIDIndexMove(WGSSIDIndex *index, const WGSSIDMember *from, const WGSSIDMember *to,
+                     WGSSIDAlert *alert) {
+    WGSSIDIndexRemove(index, from);
+    return WGSSIDIndexAdd(index, to, alert);
+}
@@ -0,0 +1,166 @@
+/*
+ * WGSSIDIndex.h - SSID -> BSSID Index
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * Secondary index over the scan table, keyed by SSID. Each SSID is a group
+ * holding the BSSIDs currently advertising it (a posting list) and what
+ * has been learned about it: security ranks, channels, vendor OUIs and
+ * every BSSID ever seen with it. The ingest worker adds a network when it
+ * appears, removes it when it expires, and moves it only when its SSID,
+ * security or channel changed, so each update is a few hash lookups and
+ * bit tests - never a pass over the table.
+ *
+ * A group learns silently for settleTime after its first sighting. After
+ * that, a network joining or changing is checked against what was learned:
+ *
+ *   downgrade   weaker security than the SSID is known for (WPA3/WPA2 ->
+ *               Open/WEP...), from a BSSID or channel not seen with it
+ *   evil twin   a BSSID never seen with the SSID, from a vendor never
+ *               seen with it
+ *
+ * A vendor is the organisation the OUI database (WGOUI) resolves the BSSID
+ * to, so an enterprise network built from one maker's many OUIs is one
+ * vendor; BSSIDs the database does not know fall back to their raw OUI.
+ *
+ * The channel, vendor and security of a network that raised an alert are
+ * not learned, so the next one like it stands out too. Groups outlive
+ * their networks (an SSID that went quiet is still known) until Clear.
+ * Hidden networks are not indexed.
+ *
+ * Not thread-safe - WGScanIngest drives it under its state lock.
+ */
+
+#ifndef WG_SSID_INDEX_H
+#define WG_SSID_INDEX_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "WGAddress.h"
+#include "WGChannelAggregate.h"
+#include "WGHashMap.h"
+#include "WGOUI.h"
+#include "WGRecordIndex.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WG_SSID_INDEX_SSID_MAX 32
+#define WG_SSID_INDEX_MAX_VENDORS 8         // Vendors learned per SSID; beyond, vendors are not checked
+#define WG_SSID_INDEX_VENDOR_KEY 0x80000000u // Marks a vendor key that is a WGVendorID, not an OUI
+#define WG_SSID_INDEX_MAX_GROUPS 0xFFFE     // SSIDs beyond this are not indexed
+
+// Security ranks, weakest first; unknown security is never compared
+typedef enum {
+    WGSecurityRankUnknown = -1,
+    WGSecurityRankOpen = 0,
+    WGSecurityRankWEP,
+    WGSecurityRankWPA,
+    WGSecurityRankWPA2,
+    WGSecurityRankWPA3,
+    WGSecurityRankCount
+} WGSecurityRank;
+
+typedef enum {
+    WGSSIDAlertNone = 0,
+    WGSSIDAlertEvilTwin,
+    WGSSIDAlertDowngrade
+} WGSSIDAlertType;
+
+// One network as the index sees it
+typedef struct {
+    WGMACAddress bssid;
+    const char *ssid;
+    size_t ssidLength;              // 0 = hidden, not indexed
+    WGSecurityRank security;
+    WGChannelBand band;
+    uint16_t channel;
+    WGVendorID vendor;              // WG_OUI_UNKNOWN if not in the database
+    double timestamp;               // Seconds since 1970
+} WGSSIDMember;
+
+typedef struct {
+    WGSSIDAlertType type;
+    WGMACAddress bssid;
+    double timestamp;
+    WGChannelBand band;
+    uint16_t channel;
+    int8_t security;                // WGSecurityRank of the network
+    int8_t knownSecurity;           // Strongest rank learned for the SSID
+    bool newBSSID;                  // Never seen with this SSID before
+    bool newChannel;
+    bool newVendor;
+    WGVendorID vendor;              // Of bssid, WG_OUI_UNKNOWN if not in the database
+    uint32_t bssidCount;            // BSSIDs advertising the SSID, this one included
+    uint8_t ssidLength;
+    char ssid[WG_SSID_INDEX_SSID_MAX + 1];
+} WGSSIDAlert;
+
+typedef struct {
+    uint64_t hash;                  // FNV-1a of the SSID
+    uint8_t ssidLength;
+    char ssid[WG_SSID_INDEX_SSID_MAX + 1];
+    double firstSeen;
+    uint8_t securityMask;           // 1 << rank for every rank learned
+    uint8_t vendorCount;
+    uint32_t vendors[WG_SSID_INDEX_MAX_VENDORS];             // Vendor keys learned
+    uint64_t channels[(WG_CHANNEL_SLOT_COUNT + 63) / 64];   // Learned channel slots
+    uint32_t securityCounts[WGSecurityRankCount];           // Current BSSIDs per rank
+} WGSSIDGroup;
+
+typedef struct {
+    double settleTime;              // Seconds an SSID is learned silently, default 60
+    WGSSIDGroup *groups;
+    size_t groupCount;
+    size_t groupCapacity;
+    WGHashMap bySSID;               // hash -> group slot
+    WGPostings current;             // group slot -> BSSIDs advertising it now
+    WGHashMap seen;                 // group slot << 48 | bssid, every pairing ever seen
+} WGSSIDIndex;
+
+// "WPA3", "Open"... as scan records name them
+WGSecurityRank WGSecurityRankFromName(const char *security);
+
+// Vendor part of a BSSID. Locally administered BSSIDs (the extra virtual
+// APs of one radio) fold back onto the vendor's OUI.
+static inline uint32_t WGSSIDIndexOUI(WGMACAddress bssid) {
+    return (uint32_t)(bssid >> 24) & ~0x020000u;
+}
+
+// What a group learns about a member's maker: its vendor ID when known,
+// else its OUI
+static inline uint32_t WGSSIDIndexVendorKey(const WGSSIDMember *member) {
+    return member->vendor != WG_OUI_UNKNOWN ? WG_SSID_INDEX_VENDOR_KEY | member->vendor
+                                            : WGSSIDIndexOUI(member->bssid);
+}
+
+// Lifecycle
+bool WGSSIDIndexInit(WGSSIDIndex *index);
+void WGSSIDIndexFree(WGSSIDIndex *index);
+void WGSSIDIndexClear(WGSSIDIndex *index);
+
+// Add returns true and fills alert when the network stands out; false
+// otherwise (including allocation failure, where it is simply not
+// indexed). Move is Remove(from) then Add(to), for a network whose SSID,
+// security or channel changed.
+bool WGSSIDIndexAdd(WGSSIDIndex *index, const WGSSIDMember *member, WGSSIDAlert *alert);
+void WGSSIDIndexRemove(WGSSIDIndex *index, const WGSSIDMember *member);
+bool WGSSIDIndexMove(WGSSIDIndex *index, const WGSSIDMember *from, const WGSSIDMember *to,
+                     WGSSIDAlert *alert);
+
+// The group for an SSID, NULL if never seen
+const WGSSIDGroup *WGSSIDIndexFind(const WGSSIDIndex *index, const char *ssid, size_t ssidLength);
+
+// BSSIDs advertising group now, ascending; valid until the next mutation
+size_t WGSSIDIndexMembers(const WGSSIDIndex *index, const WGSSIDGroup *group, const uint64_t **bssids);
+
+// Strongest rank learned for group, WGSecurityRankUnknown if none
+WGSecurityRank WGSSIDGroupKnownSecurity(const WGSSIDGroup *group);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WG_SSID_INDEX_H */
@@ -0,0 +1,714 @@
+/*
+ * WGScanIngest.c - Scan Ingestion Pipeline Implementation
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * PASSIVE SCANNING ONLY - No active attacks implemented
+ */
+
+#include "WGScanIngest.h"
+#include "WGMetrics.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef enum {
+    WGScanChangeInserted = 1,
+    WGScanChangeUpdated,
+    WGScanChangeRemoved
+} WGScanChange;
+
+typedef enum {
+    WGScanCommandResults = 0,
+    WGScanCommandExpire,
+    WGScanCommandClear,
+    WGScanCommandClearHistory
+} WGScanCommandKind;
+
+struct WGScanCommand {
+    WGScanCommand *next;
+    WGScanCommandKind kind;
+    double olderThan;
+    size_t count;
+    WGScanRecord results[];
+};
+
+#pragma mark - Pending Diff
+
+// Folds a change into the pending diff so each BSSID keeps one net change
+static bool WGScanIngestMark(WGScanIngest *ingest, WGMACAddress bssid, WGScanChange change) {
+    bool inserted = false;
+    uint64_t *pending = WGHashMapInsert(&ingest->pending, bssid, &inserted);
+    if (!pending) {
+        return false;
+    }
+    if (inserted) {
+        *pending = change;
+        return true;
+    }
+
+    switch ((WGScanChange)*pending) {
+        case WGScanChangeInserted:
+            if (change == WGScanChangeRemoved) {
+                WGHashMapRemove(&ingest->pending, bssid);   // Never delivered
+            }
+            break;
+        case WGScanChangeUpdated:
+            *pending = change == WGScanChangeRemoved ? WGScanChangeRemoved : WGScanChangeUpdated;
+            break;
+        case WGScanChangeRemoved:
+            if (change != WGScanChangeRemoved) {
+                *pending = WGScanChangeUpdated;             // Consumer still holds it
+            }
+            break;
+    }
+    return true;
+}
+
+#pragma mark - SSID Index
+
+static WGSSIDMember WGScanIngestMember(const WGScanRecord *record) {
+    return (WGSSIDMember){
+        .bssid = record->bssid,
+        .ssid = record->ssid,
+        .ssidLength = record->ssidLength,
+        .security = WGSecurityRankFromName(record->security),
+        .band = (WGChannelBand)record->band,
+        .channel = record->channel,
+        .vendor = record->vendor,
+        .timestamp = record->lastSeen
+    };
+}
+
+// Only these fields place a network in the SSID index
+static bool WGScanIngestMemberChanged(const WGScanRecord *from, const WGScanRecord *to) {
+    return from->ssidLength != to->ssidLength || memcmp(from->ssid, to->ssid, to->ssidLength) != 0 ||
+           strcmp(from->security, to->security) != 0 ||
+           from->channel != to->channel || from->band != to->band;
+}
+
+static void WGScanIngestIndexSSID(WGScanIngest *ingest, const WGScanRecord *from, const WGScanRecord *to) {
+    WGSSIDMember member = WGScanIngestMember(to);
+    WGSSIDAlert alert;
+    bool alerted;
+    if (from) {
+        WGSSIDMember previous = WGScanIngestMember(from);
+        alerted = WGSSIDIndexMove(&ingest->ssids, &previous, &member, &alert);
+    } else {
+        alerted = WGSSIDIndexAdd(&ingest->ssids, &member, &alert);
+    }
+    if (alerted) {
+        WGRingPush(&ingest->alerts, &alert, NULL);
+        WGMetricsAdd(WGMetricCounterScanAlerts, 1);
+    }
+}
+
+#pragma mark - Table
+
+static bool WGScanIngestReserve(WGScanIngest *ingest, size_t needed) {
+    if (needed <= ingest->capacity) {
+        return true;
+    }
+    size_t newCapacity = ingest->capacity ? ingest->capacity * 2 : 64;
+    while (newCapacity < needed) {
+        newCapacity *= 2;
+    }
+
+    WGScanRecord *records = realloc(ingest->records, newCapacity * sizeof(WGScanRecord));
+    if (!records) {
+        return false;
+    }
+    ingest->records = records;
+    WGRing *histories = realloc(ingest->histories, newCapacity * sizeof(WGRing));
+    if (!histories) {
+        return false;
+    }
+    ingest->histories = histories;
+    WGChannelPlacement *placements = realloc(ingest->placements, newCapacity * sizeof(WGChannelPlacement));
+    if (!placements) {
+        return false;
+    }
+    ingest->placements = placements;
+    if (!WGSignalStatsReserve(&ingest->signals, newCapacity)) {
+        return false;
+    }
+    ingest->capacity = newCapacity;
+    return true;
+}
+
+static void WGScanIngestRemoveAt(WGScanIngest *ingest, size_t i) {
+    WGMACAddress bssid = ingest->records[i].bssid;
+    WGSSIDMember member = WGScanIngestMember(&ingest->records[i]);
+    WGSSIDIndexRemove(&ingest->ssids, &member);
+    WGChannelAggregateRemove(&ingest->channels, &ingest->placements[i]);
+    WGRingFree(&ingest->histories[i]);
+    WGSignalStatsRemoveAt(&ingest->signals, i);
+    WGHashMapRemove(&ingest->index, bssid);
+    WGScanIngestMark(ingest, bssid, WGScanChangeRemoved);
+
+    size_t last = --ingest->count;
+    if (i != last) {
+        ingest->records[i] = ingest->records[last];
+        ingest->histories[i] = ingest->histories[last];
+        ingest->placements[i] = ingest->placements[last];
+        WGHashMapPut(&ingest->index, ingest->records[i].bssid, i);
+    }
+}
+
+static bool WGScanIngestApplyResult(WGScanIngest *ingest, const WGScanRecord *result) {
+    bool inserted = false;
+    uint64_t *slot = WGHashMapInsert(&ingest->index, result->bssid, &inserted);
+    if (!slot) {
+        return false;
+    }
+
+    size_t i;
+    if (inserted) {
+        if (!WGScanIngestReserve(ingest, ingest->count + 1)) {
+            WGHashMapRemove(&ingest->index, result->bssid);
+            return false;
+        }
+        i = ingest->count;
+        if (!WGRingInit(&ingest->histories[i], sizeof(WGRSSISample), WG_SCAN_HISTORY_CAPACITY)) {
+            WGHashMapRemove(&ingest->index, result->bssid);
+            return false;
+        }
+        *slot = i;
+        ingest->count++;
+        memset(&ingest->placements[i], 0, sizeof(WGChannelPlacement));
+        ingest->records[i] = *result;
+        ingest->records[i].sampleSeq = 0;
+        ingest->records[i].vendor = ingest->vendors ? WGOUILookup(ingest->vendors, result->bssid) : WG_OUI_UNKNOWN;
+        WGSignalStatsAdd(&ingest->signals, result->rssi);
+        WGScanIngestIndexSSID(ingest, NULL, &ingest->records[i]);
+    } else {
+        i = (size_t)*slot;
+        uint64_t sampleSeq = ingest->records[i].sampleSeq;
+        WGVendorID vendor = ingest->records[i].vendor;
+        if (WGScanIngestMemberChanged(&ingest->records[i], result)) {
+            WGScanRecord previous = ingest->records[i];
+            ingest->records[i] = *result;
+            ingest->records[i].vendor = vendor;
+            WGScanIngestIndexSSID(ingest, &previous, &ingest->records[i]);
+        } else {
+            ingest->records[i] = *result;
+        }
+        ingest->records[i].sampleSeq = sampleSeq;
+        ingest->records[i].vendor = vendor;
+        WGSignalStatsObserve(&ingest->signals, i, result->rssi);
+    }
+
+    WGScanRecord *record = &ingest->records[i];
+    WGRSSISample sample = {
+        .timestamp = record->lastSeen,
+        .rssi = (int8_t)(record->rssi < INT8_MIN ? INT8_MIN : (record->rssi > INT8_MAX ? INT8_MAX : record->rssi))
+    };
+    WGRingPush(&ingest->histories[i], &sample, NULL);
+    record->sampleSeq++;
+
+    WGChannelPlacement placement = WGChannelPlacementMake((WGChannelBand)record->band, record->channel,
+                                                          record->channelWidth, record->rssi);
+    WGChannelAggregateMove(&ingest->channels, &ingest->placements[i], &placement);
+    ingest->placements[i] = placement;
+
+    return WGScanIngestMark(ingest, record->bssid, inserted ? WGScanChangeInserted : WGScanChangeUpdated);
+}
+
+// One pass over every slot; steps are rare, so they are only looked for
+// when the kernel flagged some
+static void WGScanIngestFoldSignals(WGScanIngest *ingest) {
+    uint64_t start = WGMetricsNow();
+    WGSignalStats *signals = &ingest->signals;
+    size_t flagged = WGSignalStatsUpdate(signals);
+    WGMetricsAdd(WGMetricCounterScanSteps, flagged);
+
+    for (size_t i = 0; i < ingest->count && flagged > 0; i++) {
+        if (!WGSignalStatsIsStep(signals, i)) {
+            continue;
+        }
+        WGSignalStep step = {
+            .bssid = ingest->records[i].bssid,
+            .timestamp = ingest->records[i].lastSeen,
+            .rssi = ingest->records[i].rssi,
+            .baseline = signals->baseline[i],
+            .zScore = WGSignalStatsZScore(signals, i)
+        };
+        WGRingPush(&ingest->steps, &step, NULL);
+        flagged--;
+    }
+    WGMetricsEnd(WGMetricStageScanSignals, start);
+}
+
+static void WGScanIngestApply(WGScanIngest *ingest, const WGScanCommand *command) {
+    pthread_mutex_lock(&ingest->stateLock);
+    bool wasEmpty = WGHashMapCount(&ingest->pending) == 0;
+    uint64_t version = ingest->version;
+
+    switch (command->kind) {
+        case WGScanCommandResults: {
+            uint64_t start = WGMetricsNow();
+            for (size_t i = 0; i < command->count; i++) {
+                if (command->results[i].bssid != 0 &&
+                    !WGScanIngestApplyResult(ingest, &command->results[i])) {
+                    WGMetricsAdd(WGMetricCounterScanDropped, 1);
+                }
+            }
+            ingest->version += command->count > 0;
+            WGMetricsEnd(WGMetricStageScanMerge, start);
+            if (command->count > 0) {
+                WGScanIngestFoldSignals(ingest);
+            }
+            WGMetricsAdd(WGMetricCounterScanResults, command->count);
+            break;
+        }
+
+        case WGScanCommandExpire:
+            for (size_t i = ingest->count; i-- > 0;) {
+                if (ingest->records[i].lastSeen < command->olderThan) {
+                    WGScanIngestRemoveAt(ingest, i);
+                    ingest->version = version + 1;
+                }
+            }
+            break;
+
+        case WGScanCommandClear:
+            while (ingest->count > 0) {
+                WGScanIngestRemoveAt(ingest, ingest->count - 1);
+            }
+            WGChannelAggregateInit(&ingest->channels);
+            WGSSIDIndexClear(&ingest->ssids);
+            WGRingClear(&ingest->alerts);
+            ingest->version++;
+            break;
+
+        case WGScanCommandClearHistory:
+            for (size_t i = 0; i < ingest->count; i++) {
+                WGRingClear(&ingest->histories[i]);
+                WGSignalStatsRestart(&ingest->signals, i, ingest->records[i].rssi);
+            }
+            WGRingClear(&ingest->steps);
+            break;
+    }
+
+    bool notify = wasEmpty && WGHashMapCount(&ingest->pending) > 0;
+    pthread_mutex_unlock(&ingest->stateLock);
+
+    if (notify && ingest->notify) {
+        ingest->notify(ingest->notifyContext);
+    }
+}
+
+#pragma mark - Worker
+
+static void *WGScanIngestWorker(void *arg) {
+    WGScanIngest *ingest = arg;
+
+    pthread_mutex_lock(&ingest->queueLock);
+    for (;;) {
+        while (!ingest->head && !ingest->stopping) {
+            pthread_cond_wait(&ingest->queueReady, &ingest->queueLock);
+        }
+        if (!ingest->head) {
+            break;      // Stopping with nothing left to apply
+        }
+
+        WGScanCommand *command = ingest->head;
+        ingest->head = command->next;
+        if (!ingest->head) {
+            ingest->tail = NULL;
+        }
+        ingest->busy = true;
+        pthread_mutex_unlock(&ingest->queueLock);
+
+        WGScanIngestApply(ingest, command);
+        free(command);
+
+        pthread_mutex_lock(&ingest->queueLock);
+        ingest->busy = false;
+        ingest->queued--;
+        pthread_cond_broadcast(&ingest->queueSpace);
+    }
+    pthread_mutex_unlock(&ingest->queueLock);
+    return NULL;
+}
+
+static bool WGScanIngestEnqueue(WGScanIngest *ingest, WGScanCommand *command) {
+    pthread_mutex_lock(&ingest->queueLock);
+    while (ingest->running && ingest->queued >= ingest->maxQueued) {
+        pthread_cond_wait(&ingest->queueSpace, &ingest->queueLock);
+    }
+    command->next = NULL;
+    if (ingest->tail) {
+        ingest->tail->next = command;
+    } else {
+        ingest->head = command;
+    }
+    ingest->tail = command;
+    ingest->queued++;
+    pthread_cond_signal(&ingest->queueReady);
+    pthread_mutex_unlock(&ingest->queueLock);
+    return true;
+}
+
+static bool WGScanIngestPost(WGScanIngest *ingest, WGScanCommandKind kind, double olderThan) {
+    WGScanCommand *command = calloc(1, sizeof(WGScanCommand));
+    if (!command) {
+        return false;
+    }
+    command->kind = kind;
+    command->olderThan = olderThan;
+    return WGScanIngestEnqueue(ingest, command);
+}
+
+#pragma mark - Lifecycle
+
+bool WGScanIngestInit(WGScanIngest *ingest, void (*notify)(void *context), void *context) {
+    memset(ingest, 0, sizeof(*ingest));
+    ingest->maxQueued = 64;
+    ingest->notify = notify;
+    ingest->notifyContext = context;
+    WGChannelAggregateInit(&ingest->channels);
+    WGSignalStatsInit(&ingest->signals, WGSignalParamsDefault());
+
+    if (!WGRingInit(&ingest->steps, sizeof(WGSignalStep), WG_SCAN_STEP_CAPACITY)) {
+        return false;
+    }
+    if (!WGRingInit(&ingest->alerts, sizeof(WGSSIDAlert), WG_SCAN_ALERT_CAPACITY)) {
+        WGRingFree(&ingest->steps);
+        return false;
+    }
+    if (!WGSSIDIndexInit(&ingest->ssids)) {
+        WGRingFree(&ingest->alerts);
+        WGRingFree(&ingest->steps);
+        return false;
+    }
+    if (!WGHashMapInit(&ingest->index, 256)) {
+        WGSSIDIndexFree(&ingest->ssids);
+        WGRingFree(&ingest->alerts);
+        WGRingFree(&ingest->steps);
+        return false;
+    }
+    if (!WGHashMapInit(&ingest->pending, 256)) {
+        WGHashMapFree(&ingest->index);
+        WGSSIDIndexFree(&ingest->ssids);
+        WGRingFree(&ingest->alerts);
+        WGRingFree(&ingest->steps);
+        return false;
+    }
+    pthread_mutex_init(&ingest->queueLock, NULL);
+    pthread_mutex_init(&ingest->stateLock, NULL);
+    pthread_cond_init(&ingest->queueReady, NULL);
+    pthread_cond_init(&ingest->queueSpace, NULL);
+    return true;
+}
+
+bool WGScanIngestStart(WGScanIngest *ingest) {
+    pthread_mutex_lock(&ingest->queueLock);
+    if (ingest->running) {
+        pthread_mutex_unlock(&ingest->queueLock);
+        return true;
+    }
+    ingest->stopping = false;
+    ingest->running = pthread_create(&ingest->thread, NULL, WGScanIngestWorker, ingest) == 0;
+    bool running = ingest->running;
+    pthread_mutex_unlock(&ingest->queueLock);
+    return running;
+}
+
+void WGScanIngestStop(WGScanIngest *ingest) {
+    pthread_mutex_lock(&ingest->queueLock);
+    if (!ingest->running) {
+        pthread_mutex_unlock(&ingest->queueLock);
+        return;
+    }
+    ingest->stopping = true;
+    pthread_cond_signal(&ingest->queueReady);
+    pthread_mutex_unlock(&ingest->queueLock);
+
+    pthread_join(ingest->thread, NULL);
+
+    pthread_mutex_lock(&ingest->queueLock);
+    ingest->running = false;
+    pthread_cond_broadcast(&ingest->queueSpace);
+    pthread_mutex_unlock(&ingest->queueLock);
+}
+
+void WGScanIngestFree(WGScanIngest *ingest) {
+    WGScanIngestStop(ingest);
+
+    while (ingest->head) {
+        WGScanCommand *next = ingest->head->next;
+        free(ingest->head);
+        ingest->head = next;
+    }
+    for (size_t i = 0; i < ingest->count; i++) {
+        WGRingFree(&ingest->histories[i]);
+    }
+    free(ingest->records);
+    free(ingest->histories);
+    free(ingest->placements);
+    WGSignalStatsFree(&ingest->signals);
+    WGRingFree(&ingest->steps);
+    WGSSIDIndexFree(&ingest->ssids);
+    WGRingFree(&ingest->alerts);
+    WGHashMapFree(&ingest->index);
+    WGHashMapFree(&ingest->pending);
+    if (ingest->published) {
+        WGScanSnapshotRelease(ingest->published);
+    }
+    pthread_mutex_destroy(&ingest->queueLock);
+    pthread_mutex_destroy(&ingest->stateLock);
+    pthread_cond_destroy(&ingest->queueReady);
+    pthread_cond_destroy(&ingest->queueSpace);
+    memset(ingest, 0, sizeof(*ingest));
+}
+
+#pragma mark - Commands
+
+bool WGScanIngestSubmit(WGScanIngest *ingest, const WGScanRecord *results, size_t count) {
+    WGScanCommand *command = malloc(sizeof(WGScanCommand) + count * sizeof(WGScanRecord));
+    if (!command) {
+        return false;
+    }
+    command->kind = WGScanCommandResults;
+    command->olderThan = 0;
+    command->count = count;
+    if (count > 0) {
+        memcpy(command->results, results, count * sizeof(WGScanRecord));
+    }
+    return WGScanIngestEnqueue(ingest, command);
+}
+
+bool WGScanIngestExpire(WGScanIngest *ingest, double olderThan) {
+    return WGScanIngestPost(ingest, WGScanCommandExpire, olderThan);
+}
+
+bool WGScanIngestClear(WGScanIngest *ingest) {
+    return WGScanIngestPost(ingest, WGScanCommandClear, 0);
+}
+
+bool WGScanIngestClearHistory(WGScanIngest *ingest) {
+    return WGScanIngestPost(ingest, WGScanCommandClearHistory, 0);
+}
+
+void WGScanIngestWaitIdle(WGScanIngest *ingest) {
+    pthread_mutex_lock(&ingest->queueLock);
+    while (ingest->running && (ingest->head || ingest->busy)) {
+        pthread_cond_wait(&ingest->queueSpace, &ingest->queueLock);
+    }
+    pthread_mutex_unlock(&ingest->queueLock);
+}
+
+#pragma mark - Snapshots
+
+static int WGScanRecordCompare(const void *a, const void *b) {
+    WGMACAddress x = ((const WGScanRecord *)a)->bssid;
+    WGMACAddress y = ((const WGScanRecord *)b)->bssid;
+    return (x > y) - (x < y);
+}
+
+// Caller holds stateLock
+static WGScanSnapshot *WGScanIngestPublish(WGScanIngest *ingest) {
+    if (ingest->published && ingest->published->version == ingest->version) {
+        return WGScanSnapshotRetain(ingest->published);
+    }
+
+    WGScanSnapshot *snapshot = malloc(sizeof(WGScanSnapshot));
+    if (!snapshot) {
+        return NULL;
+    }
+    snapshot->records = malloc((ingest->count ? ingest->count : 1) * sizeof(WGScanRecord));
+    if (!snapshot->records) {
+        free(snapshot);
+        return NULL;
+    }
+    snapshot->version = ingest->version;
+    snapshot->count = ingest->count;
+    snapshot->refs = 1;
+    if (ingest->count > 0) {
+        memcpy(snapshot->records, ingest->records, ingest->count * sizeof(WGScanRecord));
+    }
+    const WGSignalStats *signals = &ingest->signals;
+    for (size_t i = 0; i < ingest->count; i++) {
+        snapshot->records[i].smoothedRSSI = signals->kalman[i];
+        snapshot->records[i].rssiVariance = signals->variance[i];
+        snapshot->records[i].stepScore = WGSignalStatsZScore(signals, i);
+    }
+    qsort(snapshot->records, snapshot->count, sizeof(WGScanRecord), WGScanRecordCompare);
+    snapshot->channels = ingest->channels;
+
+    if (ingest->published) {
+        WGScanSnapshotRelease(ingest->published);
+    }
+    ingest->published = snapshot;
+    return WGScanSnapshotRetain(snapshot);
+}
+
+static bool WGScanDiffReserve(WGScanDiff *diff, size_t needed) {
+    if (needed <= diff->capacity) {
+        return true;
+    }
+    WGMACAddress *lists[3] = { diff->inserted, diff->updated, diff->removed };
+    for (int i = 0; i < 3; i++) {
+        WGMACAddress *grown = realloc(lists[i], needed * sizeof(WGMACAddress));
+        if (!grown) {
+            diff->inserted = lists[0];
+            diff->updated = lists[1];
+            diff->removed = lists[2];
+            return false;
+        }
+        lists[i] = grown;
+    }
+    diff->inserted = lists[0];
+    diff->updated = lists[1];
+    diff->removed = lists[2];
+    diff->capacity = needed;
+    return true;
+}
+
+WGScanSnapshot *WGScanIngestTake(WGScanIngest *ingest, WGScanDiff *diff) {
+    pthread_mutex_lock(&ingest->stateLock);
+    WGScanSnapshot *snapshot = WGScanIngestPublish(ingest);
+
+    if (diff) {
+        diff->insertedCount = diff->updatedCount = diff->removedCount = 0;
+        // On allocation failure the changes stay pending for the next take
+        if (snapshot && WGScanDiffReserve(diff, WGHashMapCount(&ingest->pending))) {
+            size_t cursor = 0;
+            uint64_t bssid, change;
+            while (WGHashMapNext(&ingest->pending, &cursor, &bssid, &change)) {
+                switch ((WGScanChange)change) {
+                    case WGScanChangeInserted:
+                        diff->inserted[diff->insertedCount++] = bssid;
+                        break;
+                    case WGScanChangeUpdated:
+                        diff->updated[diff->updatedCount++] = bssid;
+                        break;
+                    case WGScanChangeRemoved:
+                        diff->removed[diff->removedCount++] = bssid;
+                        break;
+                }
+            }
+            WGHashMapClear(&ingest->pending);
+        }
+    }
+
+    pthread_mutex_unlock(&ingest->stateLock);
+    return snapshot;
+}
+
+WGScanSnapshot *WGScanIngestSnapshot(WGScanIngest *ingest) {
+    return WGScanIngestTake(ingest, NULL);
+}
+
+size_t WGScanIngestTakeSteps(WGScanIngest *ingest, WGSignalStep *out, size_t max) {
+    pthread_mutex_lock(&ingest->stateLock);
+    size_t copied = WGRingCopyOut(&ingest->steps, out, max);
+    WGRingDropOldest(&ingest->steps, copied);
+    pthread_mutex_unlock(&ingest->stateLock);
+    return copied;
+}
+
+void WGScanIngestSetSignalParams(WGScanIngest *ingest, WGSignalParams params) {
+    pthread_mutex_lock(&ingest->stateLock);
+    ingest->signals.params = params;
+    pthread_mutex_unlock(&ingest->stateLock);
+}
+
+void WGScanIngestSetVendors(WGScanIngest *ingest, const WGOUIDatabase *vendors) {
+    pthread_mutex_lock(&ingest->stateLock);
+    ingest->vendors = vendors;
+    pthread_mutex_unlock(&ingest->stateLock);
+}
+
+size_t WGScanIngestTakeAlerts(WGScanIngest *ingest, WGSSIDAlert *out, size_t max) {
+    pthread_mutex_lock(&ingest->stateLock);
+    size_t copied = WGRingCopyOut(&ingest->alerts, out, max);
+    WGRingDropOldest(&ingest->alerts, copied);
+    pthread_mutex_unlock(&ingest->stateLock);
+    return copied;
+}
+
+size_t WGScanIngestSSIDMembers(WGScanIngest *ingest, const char *ssid, size_t ssidLength,
+                               WGMACAddress *out, size_t max) {
+    size_t count = 0;
+    pthread_mutex_lock(&ingest->stateLock);
+    const WGSSIDGroup *group = WGSSIDIndexFind(&ingest->ssids, ssid, ssidLength);
+    if (group) {
+        const uint64_t *bssids;
+        count = WGSSIDIndexMembers(&ingest->ssids, group, &bssids);
+        if (count > 0) {
+            memcpy(out, bssids, (count < max ? count : max) * sizeof(WGMACAddress));
+        }
+    }
+    pthread_mutex_unlock(&ingest->stateLock);
+    return count;
+}
+
+size_t WGScanIngestCopySamples(WGScanIngest *ingest, WGMACAddress bssid, uint64_t afterSeq,
+                               WGRSSISample *out, size_t max, uint64_t *latestSeq) {
+    size_t copied = 0;
+    pthread_mutex_lock(&ingest->stateLock);
+
+    const uint64_t *slot = WGHashMapFind(&ingest->index, bssid);
+    if (!slot) {
+        *latestSeq = afterSeq;
+    } else {
+        const WGRing *history = &ingest->histories[*slot];
+        uint64_t newest = ingest->records[*slot].sampleSeq;
+        size_t held = WGRingCount(history);
+
+        // The ring holds sequence numbers newest-held+1 ... newest
+        uint64_t unseen = newest > afterSeq ? newest - afterSeq : 0;
+        size_t fresh = unseen < held ? (size_t)unseen : held;
+        size_t take = fresh < max ? fresh : max;
+        for (size_t i = held - take; i < held; i++) {
+            out[copied++] = *(const WGRSSISample *)WGRingAt(history, i);
+        }
+        *latestSeq = newest;
+    }
+
+    pthread_mutex_unlock(&ingest->stateLock);
+    return copied;
+}
+
+WGScanSnapshot *WGScanSnapshotRetain(WGScanSnapshot *snapshot) {
+    __atomic_add_fetch(&snapshot->refs, 1, __ATOMIC_RELAXED);
+    return snapshot;
+}
+
+void WGScanSnapshotRelease(WGScanSnapshot *snapshot) {
+    if (snapshot && __atomic_sub_fetch(&snapshot->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+        free(snapshot->records);
+        free(snapshot);
+    }
+}
+
+const WGScanRecord *WGScanSnapshotFind(const WGScanSnapshot *snapshot, WGMACAddress bssid) {
+    size_t lo = 0, hi = snapshot->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        WGMACAddress key = snapshot->records[mid].bssid;
+        if (key == bssid) {
+            return &snapshot->records[mid];
+        }
+        if (key < bssid) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return NULL;
+}
+
+#pragma mark - Diffs
+
+void WGScanDiffInit(WGScanDiff *diff) {
+    memset(diff, 0, sizeof(*diff));
+}
+
+void WGScanDiffFree(WGScanDiff *diff) {
+    free(diff->inserted);
+    free(diff->updated);
+    free(diff->removed);
+    memset(diff, 0, sizeof(*diff));
+}
@@ -0,0 +1,205 @@
+/*
+ * WGScanIngest.h - Scan Ingestion Pipeline
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * Owns the scanner's network table on a dedicated worker thread. Scan
+ * callbacks submit batches of POD results and return immediately; the
+ * worker merges them into the table, RSSI histories and channel aggregate,
+ * then folds the batch into per-BSSID signal statistics (WGSignalStats) in
+ * one vectorized pass, queueing any RSSI steps it flags. New BSSIDs are
+ * tagged with their vendor from the OUI database (WGOUI), once, on insert.
+ * An SSID index (WGSSIDIndex) follows every insert, move and removal,
+ * queueing evil-twin and security-downgrade alerts as networks appear or
+ * change.
+ *
+ * Readers never touch the table. They take an immutable, reference-counted
+ * snapshot stamped with the table version (rebuilt lazily, only when the
+ * version moved since the last one), together with the coalesced diff of
+ * BSSIDs inserted/updated/removed since the previous take. The worker calls
+ * a notify hook when the diff goes from empty to non-empty, so a consumer
+ * can rate-limit delivery to display refresh.
+ *
+ * Portable pthreads C so the pipeline runs on Linux under synthetic load.
+ */
+
+#ifndef WG_SCAN_INGEST_H
+#define WG_SCAN_INGEST_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "WGAddress.h"
+#include "WGChannelAggregate.h"
+#include "WGHashMap.h"
+#include "WGOUI.h"
+#include "WGRing.h"
+#include "WGSignalStats.h"
+#include "WGSSIDIndex.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WG_SCAN_HISTORY_CAPACITY 100
+#define WG_SCAN_SSID_MAX 32
+#define WG_SCAN_STEP_CAPACITY 64     // Flagged steps held until taken
+#define WG_SCAN_ALERT_CAPACITY 64    // SSID alerts held until taken
+
+// Compact RSSI history sample
+typedef struct {
+    double timestamp;   // Seconds since 1970
+    int8_t rssi;        // dBm
+} WGRSSISample;
+
+enum {
+    WGScanRecordFlagHidden = 1 << 0
+};
+
+// One network as seen by the last scan that reported it
+typedef struct {
+    WGMACAddress bssid;
+    double lastSeen;            // Seconds since 1970
+    int16_t rssi;
+    uint16_t channel;
+    uint16_t channelWidth;      // MHz
+    uint8_t band;               // WGChannelBand
+    uint8_t flags;              // WGScanRecordFlag*
+    uint8_t ssidLength;         // 0 for hidden
+    char ssid[WG_SCAN_SSID_MAX + 1];
+    char security[8];           // "WPA2", "Open", ...
+    uint64_t sampleSeq;         // RSSI samples recorded so far
+    WGVendorID vendor;          // From the OUI database, filled in by the ingest
+
+    // Signal statistics, filled in by the ingest (ignored on submit)
+    float smoothedRSSI;         // Kalman estimate, dBm
+    float rssiVariance;         // Exponentially weighted, dB²
+    float stepScore;            // z-score of its sample in the latest batch, 0 if absent
+} WGScanRecord;
+
+// A sample that jumped away from its BSSID's steady signal
+typedef struct {
+    WGMACAddress bssid;
+    double timestamp;           // Of the sample, seconds since 1970
+    int16_t rssi;               // The sample
+    float baseline;             // EWMA it jumped from, dBm
+    float zScore;
+} WGSignalStep;
+
+// Immutable table view; release with WGScanSnapshotRelease
+typedef struct {
+    uint64_t version;
+    size_t count;
+    WGScanRecord *records;      // Sorted by bssid
+    WGChannelAggregate channels;
+    int refs;                   // Atomic
+} WGScanSnapshot;
+
+// BSSIDs changed since the previous take (each appears in one list)
+typedef struct {
+    WGMACAddress *inserted;
+    size_t insertedCount;
+    WGMACAddress *updated;
+    size_t updatedCount;
+    WGMACAddress *removed;
+    size_t removedCount;
+    size_t capacity;            // Of each list
+} WGScanDiff;
+
+typedef struct WGScanCommand WGScanCommand;
+
+typedef struct {
+    // Worker
+    pthread_t thread;
+    pthread_mutex_t queueLock;
+    pthread_cond_t queueReady;      // Work available / stopping
+    pthread_cond_t queueSpace;      // Below maxQueued / drained
+    WGScanCommand *head;
+    WGScanCommand *tail;
+    size_t queued;
+    size_t maxQueued;               // Submitters block beyond this many batches
+    bool busy;                      // Worker is applying a command
+    bool stopping;
+    bool running;
+
+    // State, guarded by stateLock (held briefly by the worker per batch)
+    pthread_mutex_t stateLock;
+    WGScanRecord *records;
+    WGRing *histories;              // Parallel to records
+    size_t count;
+    size_t capacity;
+    WGHashMap index;                // bssid -> record index
+    WGChannelAggregate channels;
+    WGChannelPlacement *placements; // Parallel to records
+    WGSignalStats signals;          // Slots parallel to records
+    WGRing steps;                   // WGSignalStep, oldest dropped when full
+    WGSSIDIndex ssids;
+    WGRing alerts;                  // WGSSIDAlert, oldest dropped when full
+    const WGOUIDatabase *vendors;   // NULL = every vendor unknown
+    uint64_t version;
+    WGHashMap pending;              // bssid -> WGScanChange
+    WGScanSnapshot *published;      // Cached snapshot of version published->version
+
+    // Notify hook, called on the worker when pending becomes non-empty
+    void (*notify)(void *context);
+    void *notifyContext;
+} WGScanIngest;
+
+// Lifecycle - Start spawns the worker; Stop drains queued work and joins
+bool WGScanIngestInit(WGScanIngest *ingest, void (*notify)(void *context), void *context);
+bool WGScanIngestStart(WGScanIngest *ingest);
+void WGScanIngestStop(WGScanIngest *ingest);
+void WGScanIngestFree(WGScanIngest *ingest);
+
+// Commands (thread-safe, applied in submission order). Submit copies the
+// batch; it blocks only while maxQueued batches are already waiting.
+bool WGScanIngestSubmit(WGScanIngest *ingest, const WGScanRecord *results, size_t count);
+bool WGScanIngestExpire(WGScanIngest *ingest, double olderThan);   // Removes networks last seen before
+bool WGScanIngestClear(WGScanIngest *ingest);
+bool WGScanIngestClearHistory(WGScanIngest *ingest);
+void WGScanIngestWaitIdle(WGScanIngest *ingest);                   // Blocks until the queue is empty
+
+// Readers (thread-safe). Take returns the current snapshot and moves the
+// pending diff into diff (if non-NULL); the two are consistent.
+WGScanSnapshot *WGScanIngestTake(WGScanIngest *ingest, WGScanDiff *diff);
+WGScanSnapshot *WGScanIngestSnapshot(WGScanIngest *ingest);
+
+// Moves up to max flagged RSSI steps into out, oldest first; returns how
+// many. SetSignalParams takes effect from the next batch.
+size_t WGScanIngestTakeSteps(WGScanIngest *ingest, WGSignalStep *out, size_t max);
+void WGScanIngestSetSignalParams(WGScanIngest *ingest, WGSignalParams params);
+
+// SSID index: alerts move out like steps; Members copies up to max BSSIDs
+// advertising ssid now, ascending, and returns how many there are in all
+size_t WGScanIngestTakeAlerts(WGScanIngest *ingest, WGSSIDAlert *out, size_t max);
+size_t WGScanIngestSSIDMembers(WGScanIngest *ingest, const char *ssid, size_t ssidLength,
+                               WGMACAddress *out, size_t max);
+
+// Vendor tagging for BSSIDs inserted from now on; the database must stay
+// open while the ingest uses it
+void WGScanIngestSetVendors(WGScanIngest *ingest, const WGOUIDatabase *vendors);
+
+// RSSI samples with sequence numbers after afterSeq, oldest first. Stores
+// the newest sequence number in latestSeq; returns the number copied.
+size_t WGScanIngestCopySamples(WGScanIngest *ingest, WGMACAddress bssid, uint64_t afterSeq,
+                               WGRSSISample *out, size_t max, uint64_t *latestSeq);
+
+// Snapshots
+WGScanSnapshot *WGScanSnapshotRetain(WGScanSnapshot *snapshot);
+void WGScanSnapshotRelease(WGScanSnapshot *snapshot);
+const WGScanRecord *WGScanSnapshotFind(const WGScanSnapshot *snapshot, WGMACAddress bssid);
+
+// Diffs
+void WGScanDiffInit(WGScanDiff *diff);
+void WGScanDiffFree(WGScanDiff *diff);
+
+static inline bool WGScanDiffIsEmpty(const WGScanDiff *diff) {
+    return diff->insertedCount == 0 && diff->updatedCount == 0 && diff->removedCount == 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WG_SCAN_INGEST_H */
@@ -0,0 +1,42 @@
+/*
+ * WGScanSource.h - Scan Result Source
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * Where WGWiFiScanner gets its scan results from. A source decodes whatever
+ * it reads (MobileWiFi networks, captured beacons) into POD WGScanRecords
+ * and hands them to the result handler; the scanner submits them straight
+ * to its ingest worker.
+ *
+ * Polled sources (MobileWiFi) produce one batch per requestScan and the
+ * scanner drives them from its interval timer. Continuous sources (pcap
+ * replay) start streaming on the first requestScan and run until stopped.
+ */
+
+#import <Foundation/Foundation.h>
+#import "WGScanIngest.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Both handlers may be called on any thread
+typedef void (^WGScanSourceResultHandler)(const WGScanRecord *records, size_t count);
+typedef void (^WGScanSourceErrorHandler)(NSError *error);
+
+@protocol WGScanSource <NSObject>
+
+@property (nonatomic, readonly) NSString *name;
+@property (nonatomic, readonly, getter=isContinuous) BOOL continuous;
+@property (nonatomic, copy, nullable) WGScanSourceResultHandler resultHandler;
+@property (nonatomic, copy, nullable) WGScanSourceErrorHandler errorHandler;
+
+// Checks the source can scan; called by startScanning before any request
+- (BOOL)prepare:(NSError **)error;
+
+- (void)requestScan;
+- (void)stop;
+
+// Problem description ("❌ ...") if the source cannot scan, otherwise nil
+- (nullable NSString *)diagnosticStatus;
+
+@end
+
+NS_ASSUME_NONNULL_END
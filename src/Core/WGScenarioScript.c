@@ -0,0 +1,1017 @@
+/*
+ * WGScenarioScript.c - Declarative Simulation Scenarios Implementation
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * SIMULATION ONLY - synthetic tables, no network access.
+ */
+
+#include "WGScenarioScript.h"
+#include "WGAddress.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define WG_SCENARIO_TOKEN_MAX       64
+#define WG_SCENARIO_DEFAULT_TICK    1000
+#define WG_SCENARIO_DEFAULT_CHECK   3000
+#define WG_SCENARIO_RANDOM_MASK     0xFFFFFFFFFFULL     // Low 40 bits of a random MAC
+
+typedef struct {
+    const char *start;
+    size_t length;
+} WGScenarioToken;
+
+typedef struct {
+    WGScenarioScript *script;
+    const char *cursor;         // Within the current line
+    const char *lineEnd;
+    uint64_t random;
+} WGScenarioParser;
+
+static const char * const kWGScenarioRoleNames[] = {
+    [WGScenarioRoleClient]   = "client",
+    [WGScenarioRoleGateway]  = "gateway",
+    [WGScenarioRoleVictim]   = "victim",
+    [WGScenarioRoleAttacker] = "attacker",
+};
+
+static const char * const kWGScenarioTableNames[WGScenarioTableCount] = {
+    [WGScenarioTableVictim]  = "victim",
+    [WGScenarioTableGateway] = "gateway",
+};
+
+static const char * const kWGScenarioFindingNames[] = {
+    [WG_SCENARIO_FINDING_RATE]      = "rate",
+    [WGARPFindingMACChange]         = "mac_change",
+    [WGARPFindingGatewayEntryChange] = "gateway_entry_change",
+    [WGARPFindingDuplicateMAC]      = "duplicate_mac",
+    [WGARPFindingGatewayMACChange]  = "gateway_mac_change",
+    [WGARPFindingBSSIDMismatch]     = "bssid_mismatch",
+};
+
+#define WG_SCENARIO_COUNT(array) (sizeof(array) / sizeof((array)[0]))
+
+const char *WGScenarioRoleName(WGScenarioRole role) {
+    return (unsigned)role < WG_SCENARIO_COUNT(kWGScenarioRoleNames) ? kWGScenarioRoleNames[role] : "unknown";
+}
+
+const char *WGScenarioFindingName(uint8_t finding) {
+    return finding < WG_SCENARIO_COUNT(kWGScenarioFindingNames) ? kWGScenarioFindingNames[finding] : "unknown";
+}
+
+const char *WGScenarioErrorString(WGScenarioError error) {
+    switch (error) {
+        case WGScenarioErrorNone:
+            return "No error";
+        case WGScenarioErrorIO:
+            return "Could not read scenario file";
+        case WGScenarioErrorSyntax:
+            return "Syntax error";
+        case WGScenarioErrorHost:
+            return "Unknown or duplicate host";
+        case WGScenarioErrorLimit:
+            return "Too many hosts or events";
+        case WGScenarioErrorMemory:
+            return "Out of memory";
+    }
+    return "Unknown error";
+}
+
+static bool WGScenarioGrow(void **items, size_t *capacity, size_t needed, size_t size) {
+    if (needed <= *capacity) {
+        return true;
+    }
+    size_t newCapacity = *capacity ? *capacity : 16;
+    while (newCapacity < needed) {
+        newCapacity *= 2;
+    }
+    void *grown = realloc(*items, newCapacity * size);
+    if (!grown) {
+        return false;
+    }
+    *items = grown;
+    *capacity = newCapacity;
+    return true;
+}
+
+// xorshift64*, so random MACs are reproducible from the script seed
+static uint64_t WGScenarioRandom(WGScenarioParser *parser) {
+    uint64_t x = parser->random;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    parser->random = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+static WGScenarioError WGScenarioFail(WGScenarioParser *parser, WGScenarioError error,
+                                      const WGScenarioToken *token) {
+    WGScenarioScript *script = parser->script;
+    if (token && token->length > 0) {
+        int length = (int)(token->length < sizeof(script->errorDetail) - 1 ? token->length
+                                                                            : sizeof(script->errorDetail) - 1);
+        snprintf(script->errorDetail, sizeof(script->errorDetail), "%.*s", length, token->start);
+    } else {
+        snprintf(script->errorDetail, sizeof(script->errorDetail), "(end of line)");
+    }
+    return error;
+}
+
+#pragma mark - Strings
+
+static bool WGScenarioAppend(WGScenarioScript *script, const char *text, size_t length, uint32_t *offset) {
+    if (script->stringLength + length + 1 > UINT32_MAX ||
+        !WGScenarioGrow((void **)&script->strings, &script->stringCapacity,
+                        script->stringLength + length + 1, 1)) {
+        return false;
+    }
+    *offset = (uint32_t)script->stringLength;
+    memcpy(script->strings + script->stringLength, text, length);
+    script->strings[script->stringLength + length] = '\0';
+    script->stringLength += length + 1;
+    return true;
+}
+
+// Note text with {n} replaced by the 1-based repetition
+static bool WGScenarioAppendText(WGScenarioScript *script, const WGScenarioToken *text,
+                                 uint32_t repetition, uint32_t *offset) {
+    char buffer[512];
+    size_t length = 0;
+    for (size_t i = 0; i < text->length && length < sizeof(buffer) - 12; i++) {
+        if (i + 3 <= text->length && memcmp(text->start + i, "{n}", 3) == 0) {
+            length += (size_t)snprintf(buffer + length, sizeof(buffer) - length, "%u", repetition + 1);
+            i += 2;
+        } else {
+            buffer[length++] = text->start[i];
+        }
+    }
+    return WGScenarioAppend(script, buffer, length, offset);
+}
+
+#pragma mark - Tokens
+
+static inline bool WGScenarioIsSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+// Next whitespace-separated token; false at end of line or at a # comment
+static bool WGScenarioNextToken(WGScenarioParser *parser, WGScenarioToken *token) {
+    const char *p = parser->cursor;
+    while (p < parser->lineEnd && WGScenarioIsSpace(*p)) {
+        p++;
+    }
+    if (p >= parser->lineEnd || *p == '#') {
+        parser->cursor = parser->lineEnd;
+        token->start = p;
+        token->length = 0;
+        return false;
+    }
+    const char *start = p;
+    while (p < parser->lineEnd && !WGScenarioIsSpace(*p)) {
+        p++;
+    }
+    token->start = start;
+    token->length = (size_t)(p - start);
+    parser->cursor = p;
+    return true;
+}
+
+// Remainder of the line, trimmed (text may contain #)
+static bool WGScenarioRest(WGScenarioParser *parser, WGScenarioToken *token) {
+    const char *start = parser->cursor;
+    const char *end = parser->lineEnd;
+    while (start < end && WGScenarioIsSpace(*start)) {
+        start++;
+    }
+    while (end > start && WGScenarioIsSpace(end[-1])) {
+        end--;
+    }
+    token->start = start;
+    token->length = (size_t)(end - start);
+    parser->cursor = parser->lineEnd;
+    return token->length > 0;
+}
+
+static inline bool WGScenarioTokenIs(const WGScenarioToken *token, const char *literal) {
+    size_t length = strlen(literal);
+    return token->length == length && memcmp(token->start, literal, length) == 0;
+}
+
+// Copies a short token for the NUL-terminated parsers
+static bool WGScenarioTokenCopy(const WGScenarioToken *token, char buffer[WG_SCENARIO_TOKEN_MAX]) {
+    if (token->length == 0 || token->length >= WG_SCENARIO_TOKEN_MAX) {
+        return false;
+    }
+    memcpy(buffer, token->start, token->length);
+    buffer[token->length] = '\0';
+    return true;
+}
+
+static bool WGScenarioParseDouble(const WGScenarioToken *token, double *value) {
+    char buffer[WG_SCENARIO_TOKEN_MAX];
+    char *end = NULL;
+    if (!WGScenarioTokenCopy(token, buffer)) {
+        return false;
+    }
+    *value = strtod(buffer, &end);
+    return end != buffer && *end == '\0' && *value >= 0;
+}
+
+static bool WGScenarioParseUInt(const WGScenarioToken *token, uint64_t *value) {
+    char buffer[WG_SCENARIO_TOKEN_MAX];
+    char *end = NULL;
+    if (!WGScenarioTokenCopy(token, buffer) || buffer[0] == '-') {
+        return false;
+    }
+    errno = 0;
+    *value = strtoull(buffer, &end, 0);
+    return errno == 0 && end != buffer && *end == '\0';
+}
+
+// 250ms, 3s, 1.5s, 2m; a bare number is milliseconds
+static bool WGScenarioParseTime(const WGScenarioToken *token, uint64_t *ms) {
+    char buffer[WG_SCENARIO_TOKEN_MAX];
+    char *end = NULL;
+    if (!WGScenarioTokenCopy(token, buffer) || buffer[0] == '-') {
+        return false;
+    }
+    double value = strtod(buffer, &end);
+    if (end == buffer) {
+        return false;
+    }
+    double scale;
+    if (*end == '\0' || strcmp(end, "ms") == 0) {
+        scale = 1;
+    } else if (strcmp(end, "s") == 0) {
+        scale = 1000;
+    } else if (strcmp(end, "m") == 0) {
+        scale = 60000;
+    } else {
+        return false;
+    }
+    value *= scale;
+    if (!(value >= 0) || value > (double)(UINT64_MAX / 2)) {
+        return false;
+    }
+    *ms = (uint64_t)(value + 0.5);
+    return true;
+}
+
+static bool WGScenarioParseName(const WGScenarioToken *token, const char * const *names, size_t count,
+                                uint8_t *value) {
+    for (size_t i = 0; i < count; i++) {
+        if (names[i] && WGScenarioTokenIs(token, names[i])) {
+            *value = (uint8_t)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool WGScenarioValidName(const char *name, size_t length) {
+    if (length == 0 || length >= WG_SCENARIO_TOKEN_MAX - 12) {
+        return false;
+    }
+    for (size_t i = 0; i < length; i++) {
+        char c = name[i];
+        bool alpha = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+        bool digit = (c >= '0' && c <= '9') || c == '.' || c == '-';
+        if (!alpha && !(i > 0 && digit)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#pragma mark - Hosts
+
+static uint64_t WGScenarioHashName(const char *name, size_t length) {
+    // FNV-1a
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (uint8_t)name[i];
+        hash *= 0x100000001B3ULL;
+    }
+    return hash == WG_HASH_MAP_EMPTY ? 0 : hash;
+}
+
+static inline uint64_t WGScenarioNextKey(uint64_t key) {
+    return key + 1 == WG_HASH_MAP_EMPTY ? 0 : key + 1;
+}
+
+// Host index, or UINT32_MAX; *freeKey gets the key an insert would use
+static uint32_t WGScenarioFindHost(const WGScenarioScript *script, const char *name, size_t length,
+                                   uint64_t *freeKey) {
+    uint64_t key = WGScenarioHashName(name, length);
+    for (;;) {
+        uint64_t *slot = WGHashMapFind(&script->hostIndex, key);
+        if (!slot) {
+            if (freeKey) {
+                *freeKey = key;
+            }
+            return UINT32_MAX;
+        }
+        const char *candidate = WGScenarioString(script, script->hosts[*slot].name);
+        if (strncmp(candidate, name, length) == 0 && candidate[length] == '\0') {
+            return (uint32_t)*slot;
+        }
+        key = WGScenarioNextKey(key);
+    }
+}
+
+static WGScenarioError WGScenarioAddHost(WGScenarioParser *parser, const char *name, size_t length,
+                                         uint8_t role, uint32_t ip, uint64_t mac) {
+    WGScenarioScript *script = parser->script;
+    WGScenarioToken token = { name, length };
+    uint64_t key = 0;
+    if (WGScenarioFindHost(script, name, length, &key) != UINT32_MAX) {
+        return WGScenarioFail(parser, WGScenarioErrorHost, &token);
+    }
+    if (script->hostCount >= WG_SCENARIO_MAX_HOSTS) {
+        return WGScenarioFail(parser, WGScenarioErrorLimit, &token);
+    }
+
+    uint32_t offset = 0;
+    if (!WGScenarioGrow((void **)&script->hosts, &script->hostCapacity, script->hostCount + 1,
+                        sizeof(*script->hosts)) ||
+        !WGScenarioAppend(script, name, length, &offset) ||
+        !WGHashMapPut(&script->hostIndex, key, script->hostCount)) {
+        return WGScenarioErrorMemory;
+    }
+    script->hosts[script->hostCount++] = (WGScenarioHost){ .name = offset, .role = role, .ip = ip, .mac = mac };
+    return WGScenarioErrorNone;
+}
+
+// A host name, or prefix* for every host of a `hosts` group
+static WGScenarioError WGScenarioResolveHosts(WGScenarioParser *parser, const WGScenarioToken *token,
+                                              uint32_t *first, uint32_t *count) {
+    WGScenarioScript *script = parser->script;
+    if (token->length > 1 && token->start[token->length - 1] == '*') {
+        size_t length = token->length - 1;
+        for (size_t i = 0; i < script->groupCount; i++) {
+            const char *prefix = WGScenarioString(script, script->groups[i].prefix);
+            if (strncmp(prefix, token->start, length) == 0 && prefix[length] == '\0') {
+                *first = script->groups[i].first;
+                *count = script->groups[i].count;
+                return WGScenarioErrorNone;
+            }
+        }
+        return WGScenarioFail(parser, WGScenarioErrorHost, token);
+    }
+
+    *first = WGScenarioFindHost(script, token->start, token->length, NULL);
+    *count = 1;
+    return *first == UINT32_MAX ? WGScenarioFail(parser, WGScenarioErrorHost, token) : WGScenarioErrorNone;
+}
+
+#pragma mark - Header Directives
+
+static WGScenarioError WGScenarioParseHost(WGScenarioParser *parser, bool group) {
+    WGScenarioToken name, countToken, roleToken, ipToken, macToken;
+    uint64_t count = 1;
+    uint8_t role = 0;
+    char ipText[WG_SCENARIO_TOKEN_MAX], macText[WG_SCENARIO_TOKEN_MAX];
+    uint32_t ip = 0;
+    uint64_t mac = 0;
+
+    if (!WGScenarioNextToken(parser, &name) || !WGScenarioValidName(name.start, name.length)) {
+        return WGScenarioFail(parser, WGScenarioErrorSyntax, &name);
+    }
+    if (group && (!WGScenarioNextToken(parser, &countToken) || !WGScenarioParseUInt(&countToken, &count) ||
+                  count == 0 || count > WG_SCENARIO_MAX_HOSTS)) {
+        return WGScenarioFail(parser, WGScenarioErrorSyntax, &countToken);
+    }
+    if (!WGScenarioNextToken(parser, &roleToken) ||
+        !WGScenarioParseName(&roleToken, kWGScenarioRoleNames, WG_SCENARIO_COUNT(kWGScenarioRoleNames), &role)) {
+        return WGScenarioFail(parser, WGScenarioErrorSyntax, &roleToken);
+    }
+    if (!WGScenarioNextToken(parser, &ipToken) || !WGScenarioTokenCopy(&ipToken, ipText) ||
+        !WGIPv4Parse(ipText, &ip)) {
+        return WGScenarioFail(parser, WGScenarioErrorSyntax, &ipToken);
+    }
+    if (!WGScenarioNextToken(parser, &macToken) || !WGScenarioTokenCopy(&macToken, macText) ||
+        !WGMACParse(macText, &mac)) {
+        return WGScenarioFail(parser, WGScenarioErrorSyntax, &macToken);
+    }
+
+    WGScenarioScript *script = parser->script;
+    if (!group) {
+        return WGScenarioAddHost(parser, name.start, name.length, role, ip, mac);
+    }
+
+    uint32_t prefix = 0;
+    if (!WGScenarioGrow((void **)&script->groups, &script->groupCapacity, script->groupCount + 1,
+                        sizeof(*script->groups)) ||
+        !WGScenarioAppend(script, name.start, name.length, &prefix)) {
+        return WGScenarioErrorMemory;
+    }
+    script->groups[script->groupCount++] = (WGScenarioGroup){
+        .prefix = prefix, .first = (uint32_t)script->hostCount, .count = (uint32_t)count
+    };
+    // prefix1 ... prefixN, consecutive addresses
+    char hostName[WG_SCENARIO_TOKEN_MAX];
+    for (uint64_t i = 0; i < count; i++) {
+        int length = snprintf(hostName, sizeof(hostName), "%.*s%llu", (int)name.length, name.start,
+                              (unsigned long long)(i + 1));
+        WGScenarioError error = WGScenarioAddHost(parser, hostName, (size_t)length, role,
+                                                  ip + (uint32_t)i, (mac + i) & 0xFFFFFFFFFFFFULL);
+        if (error != WGScenarioErrorNone) {
+            return error;
+        }
+    }
+    return WGScenarioErrorNone;
+}
+
+static WGScenarioError WGScenarioParseTable(WGScenarioParser *parser) {
+    WGScenarioScript *script = parser->script;
+    WGScenarioToken token;
+    uint8_t table = 0;
+    if (!WGScenarioNextToken(parser, &token) ||
+        !WGScenarioParseName(&token, kWGScenarioTableNames, WGScenarioTableCount, &table)) {
+        return WGScenarioFail(parser, WGScenarioErrorSyntax, &token);
+    }
+    while (WGScenarioNextToken(parser, &token)) {
+        uint32_t first = 0, count = 0;
+        WGScenarioError error = WGScenarioResolveHosts(parser, &token, &first, &count);
+        if (error != WGScenarioErrorNone) {
+            return error;
+        }
+        if (!WGScenarioGrow((void **)&script->entries, &script->entryCapacity, script->entryCount + count,
+                            sizeof(*script->entries))) {
+            return WGScenarioErrorMemory;
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            script->entries[script->entryCount++] = (WGScenarioEntry){ .host = first + i, .table = table };
+        }
+    }
+    return WGScenarioErrorNone;
+}
+
+static WGScenarioError WGScenarioParseText(WGScenarioParser *parser, uint32_t *offset) {
+    WGScenarioScript *script = parser->script;
+    WGScenarioToken text;
+    if (!WGScenarioRest(parser, &text)) {
+        return WGScenarioFail(parser, WGScenarioErrorSyntax, &text);
+    }
+    if (*offset == 0) {
+        return WGScenarioAppend(script, text.start, text.length, offset) ? WGScenarioErrorNone
+                                                                         : WGScenarioErrorMemory;
+    }
+
+    // Repeated description lines continue the paragraph
+    size_t previous = strlen(WGScenarioString(script, *offset));
+    size_t length = previous + 1 + text.length;
+    char *joined = malloc(length);
+    if (!joined) {
+        return WGScenarioErrorMemory;
+    }
+    memcpy(joined, WGScenarioString(script, *offset), previous);
+    joined[previous] = ' ';
+    memcpy(joined + previous + 1, text.start, text.length);
+    bool ok = WGScenarioAppend(script, joined, length, offset);
+    free(joined);
+    return ok ? WGScenarioErrorNone : WGScenarioErrorMemory;
+}
+
+static WGScenarioError WGScenarioParseSetting(WGScenarioParser *parser, uint64_t *value, bool time) {
+    WGScenarioToken token;
+    bool ok = WGScenarioNextToken(parser, &token) &&
+              (time ? WGScenarioParseTime(&token, value) : WGScenarioParseUInt(&token, value));
+    return ok ? WGScenarioErrorNone : WGScenarioFail(parser, WGScenarioErrorSyntax, &token);
+}
+
+static WGScenarioError WGScenarioParseChurn(WGScenarioParser *parser) {
+    WGScenarioScript *script = parser->script;
+    double *rates[] = { &script->joinsPerSecond, &script->leavesPerSecond, &script->releasesPerSecond };
+    for (size_t i = 0; i < 3; i++) {
+        WGScenarioToken token;
+        if (!WGScenarioNextToken(parser, &token) || !WGScenarioParseDouble(&token, rates[i])) {
+            return WGScenarioFail(parser, WGScenarioErrorSyntax, &token);
+        }
+    }
+    return WGScenarioErrorNone;
+}
+
+#pragma mark - Timeline
+
+static WGScenarioError WGScenarioParseTimeline(WGScenarioParser *parser, const WGScenarioToken *at) {
+    WGScenarioScript *script = parser->script;
+    WGScenarioToken token = { at->start + 1, at->length - 1 };
+    uint64_t timeMs = 0, periodMs = 0, repetitions = 1;
+    if (!WGScenarioParseTime(&token, &timeMs)) {
+        return WGScenarioFail(parser, WGScenarioErrorSyntax, at);
+    }
+
+    // [every <time> x <count>]
+    if (!WGScenarioNextToken(parser, &token)) {
+        return WGScenarioFail(parser, WGScenarioErrorSyntax, &token);
+    }
+    if (WGScenarioTokenIs(&token, "every")) {
+        WGScenarioToken times;
+        if (!WGScenarioNextToken(parser, &token) || !WGScenarioParseTime(&token, &periodMs) ||
+            !WGScenarioNextToken(parser, &times) || !WGScenarioTokenIs(&times, "x") ||
+            !WGScenarioNextToken(parser, &token) || !WGScenarioParseUInt(&token, &repetitions) ||
+            repetitions == 0 || repetitions > WG_SCENARIO_MAX_EVENTS) {
+            return WGScenarioFail(parser, WGScenarioErrorSyntax, &token);
+        }
+        if (!WGScenarioNextToken(parser, &token)) {
+            return WGScenarioFail(parser, WGScenarioErrorSyntax, &token);
+        }
+    }
+
+    WGScenarioEvent event = { .timeMs = timeMs };
+    WGScenarioToken typeToken = { 0 }, textToken = { 0 }, sourceToken = { 0 };
+    uint32_t first = 0, count = 1;
+    bool randomMAC = false;
+
+    if (WGScenarioTokenIs(&token, "note")) {
+        event.action = WGScenarioActionNote;
+        if (!WGScenarioNextToken(parser, &typeToken) || !WGScenarioAppend(script, typeToken.start,
+                                                                          typeToken.length, &event.type)) {
+            return WGScenarioFail(parser, WGScenarioErrorSyntax, &typeToken);
+        }
+        const char *mark = parser->cursor;
+        if (WGScenarioNextToken(parser, &token) && WGScenarioTokenIs(&token, "malicious")) {
+            event.flags |= WGScenarioEventMalicious;
+        } else {
+            parser->cursor = mark;
+        }
+        WGScenarioRest(parser, &textToken);
+    } else if (WGScenarioTokenIs(&token, "set") || WGScenarioTokenIs(&token, "remove") ||
+               WGScenarioTokenIs(&token, "expect")) {
+        bool set = WGScenarioTokenIs(&token, "set");
+        bool expect = WGScenarioTokenIs(&token, "expect");
+        event.action = set ? WGScenarioActionSet : expect ? WGScenarioActionExpect : WGScenarioActionRemove;
+
+        // set|remove <table> <host> ... / expect <finding> <host> ...
+        if (!WGScenarioNextToken(parser, &token) ||
+            !(expect ? WGScenarioParseName(&token, kWGScenarioFindingNames,
+                                           WG_SCENARIO_COUNT(kWGScenarioFindingNames), &event.finding)
+                     : WGScenarioParseName(&token, kWGScenarioTableNames, WGScenarioTableCount, &event.table))) {
+            return WGScenarioFail(parser, WGScenarioErrorSyntax, &token);
+        }
+        if (!WGScenarioNextToken(parser, &token)) {
+            return WGScenarioFail(parser, WGScenarioErrorSyntax, &token);
+        }
+        WGScenarioError error = WGScenarioResolveHosts(parser, &token, &first, &count);
+        if (error != WGScenarioErrorNone) {
+            return error;
+        }
+
+        if (set) {
+            // <host> | <mac> | random
+            char macText[WG_SCENARIO_TOKEN_MAX];
+            if (!WGScenarioNextToken(parser, &sourceToken)) {
+                return WGScenarioFail(parser, WGScenarioErrorSyntax, &sourceToken);
+            }
+            if (WGScenarioTokenIs(&sourceToken, "random")) {
+                randomMAC = true;
+            } else if (!(WGScenarioTokenCopy(&sourceToken, macText) && WGMACParse(macText, &event.value))) {
+                uint32_t source = WGScenarioFindHost(script, sourceToken.start, sourceToken.length, NULL);
+                if (source == UINT32_MAX) {
+                    return WGScenarioFail(parser, WGScenarioErrorHost, &sourceToken);
+                }
+                event.value = script->hosts[source].mac;
+            }
+        }
+        while (WGScenarioNextToken(parser, &token)) {
+            if (set && WGScenarioTokenIs(&token, "malicious")) {
+                event.flags |= WGScenarioEventMalicious;
+            } else if (expect && WGScenarioTokenIs(&token, "within") &&
+                       WGScenarioNextToken(parser, &token) && WGScenarioParseTime(&token, &event.value)) {
+                continue;
+            } else {
+                return WGScenarioFail(parser, WGScenarioErrorSyntax, &token);
+            }
+        }
+    } else if (WGScenarioTokenIs(&token, "end")) {
+        event.action = WGScenarioActionEnd;
+    } else {
+        return WGScenarioFail(parser, WGScenarioErrorSyntax, &token);
+    }
+    if (WGScenarioNextToken(parser, &token)) {
+        return WGScenarioFail(parser, WGScenarioErrorSyntax, &token);
+    }
+
+    // A repeated event walks a group one host per repetition; a single one
+    // covers the whole group at once
+    uint64_t members = repetitions > 1 ? 1 : count;
+    uint64_t total = repetitions * members;
+    if (script->eventCount + total > WG_SCENARIO_MAX_EVENTS ||
+        (repetitions > 1 && periodMs > (UINT64_MAX / 2 - timeMs) / (repetitions - 1))) {
+        return WGScenarioFail(parser, WGScenarioErrorLimit, at);
+    }
+    if (!WGScenarioGrow((void **)&script->events, &script->eventCapacity, script->eventCount + total,
+                        sizeof(*script->events))) {
+        return WGScenarioErrorMemory;
+    }
+
+    bool numbered = textToken.length >= 3 && memmem(textToken.start, textToken.length, "{n}", 3) != NULL;
+    if (event.action == WGScenarioActionNote && !numbered &&
+        !WGScenarioAppend(script, textToken.start, textToken.length, &event.text)) {
+        return WGScenarioErrorMemory;
+    }
+    for (uint64_t repetition = 0; repetition < repetitions; repetition++) {
+        if (numbered && !WGScenarioAppendText(script, &textToken, (uint32_t)repetition, &event.text)) {
+            return WGScenarioErrorMemory;
+        }
+        for (uint64_t member = 0; member < members; member++) {
+            WGScenarioEvent *expanded = &script->events[script->eventCount++];
+            *expanded = event;
+            expanded->timeMs = timeMs + repetition * periodMs;
+            expanded->host = first + (uint32_t)(repetitions > 1 ? repetition % count : member);
+            if (randomMAC) {
+                // Locally administered; 0e:... marks attacker MACs as in WGARPSimulation
+                uint64_t prefix = (event.flags & WGScenarioEventMalicious) ? 0x0EULL : 0x02ULL;
+                expanded->value = (prefix << 40) | (WGScenarioRandom(parser) & WG_SCENARIO_RANDOM_MASK);
+            }
+        }
+    }
+    if (event.action == WGScenarioActionExpect) {
+        script->expectCount += total;
+    }
+    return WGScenarioErrorNone;
+}
+
+// Stable merge sort by time, so same-millisecond events keep their order
+static bool WGScenarioSortEvents(WGScenarioScript *script) {
+    size_t count = script->eventCount;
+    bool sorted = true;
+    for (size_t i = 1; i < count && sorted; i++) {
+        sorted = script->events[i - 1].timeMs <= script->events[i].timeMs;
+    }
+    if (sorted) {
+        return true;
+    }
+
+    WGScenarioEvent *scratch = malloc(count * sizeof(*scratch));
+    if (!scratch) {
+        return false;
+    }
+    WGScenarioEvent *source = script->events;
+    WGScenarioEvent *target = scratch;
+    for (size_t width = 1; width < count; width *= 2) {
+        for (size_t left = 0; left < count; left += 2 * width) {
+            size_t middle = left + width < count ? left + width : count;
+            size_t right = left + 2 * width < count ? left + 2 * width : count;
+            size_t i = left, j = middle, k = left;
+            while (i < middle && j < right) {
+                target[k++] = source[j].timeMs < source[i].timeMs ? source[j++] : source[i++];
+            }
+            while (i < middle) {
+                target[k++] = source[i++];
+            }
+            while (j < right) {
+                target[k++] = source[j++];
+            }
+        }
+        WGScenarioEvent *swap = source;
+        source = target;
+        target = swap;
+    }
+    if (source != script->events) {
+        memcpy(script->events, source, count * sizeof(*source));
+    }
+    free(scratch);
+    return true;
+}
+
+#pragma mark - Loading
+
+static WGScenarioError WGScenarioParseLine(WGScenarioParser *parser) {
+    WGScenarioScript *script = parser->script;
+    WGScenarioToken directive;
+    if (!WGScenarioNextToken(parser, &directive)) {
+        return WGScenarioErrorNone;
+    }
+    if (directive.start[0] == '@' && directive.length > 1) {
+        return WGScenarioParseTimeline(parser, &directive);
+    }
+    if (WGScenarioTokenIs(&directive, "host")) {
+        return WGScenarioParseHost(parser, false);
+    }
+    if (WGScenarioTokenIs(&directive, "hosts")) {
+        return WGScenarioParseHost(parser, true);
+    }
+    if (WGScenarioTokenIs(&directive, "table")) {
+        return WGScenarioParseTable(parser);
+    }
+    if (WGScenarioTokenIs(&directive, "scenario")) {
+        return WGScenarioParseText(parser, &script->name);
+    }
+    if (WGScenarioTokenIs(&directive, "description")) {
+        return WGScenarioParseText(parser, &script->description);
+    }
+    if (WGScenarioTokenIs(&directive, "tick")) {
+        return WGScenarioParseSetting(parser, &script->tickMs, true);
+    }
+    if (WGScenarioTokenIs(&directive, "check")) {
+        return WGScenarioParseSetting(parser, &script->checkMs, true);
+    }
+    if (WGScenarioTokenIs(&directive, "duration")) {
+        return WGScenarioParseSetting(parser, &script->durationMs, true);
+    }
+    if (WGScenarioTokenIs(&directive, "seed")) {
+        WGScenarioError error = WGScenarioParseSetting(parser, &script->seed, false);
+        parser->random = script->seed ? script->seed : parser->random;
+        return error;
+    }
+    if (WGScenarioTokenIs(&directive, "churn")) {
+        return WGScenarioParseChurn(parser);
+    }
+    return WGScenarioFail(parser, WGScenarioErrorSyntax, &directive);
+}
+
+WGScenarioError WGScenarioScriptLoad(WGScenarioScript *script, const char *text, size_t length) {
+    memset(script, 0, sizeof(*script));
+    script->tickMs = WG_SCENARIO_DEFAULT_TICK;
+    script->checkMs = WG_SCENARIO_DEFAULT_CHECK;
+    script->seed = 0x9E3779B97F4A7C15ULL;
+
+    uint32_t empty = 0;
+    if (!WGHashMapInit(&script->hostIndex, 16) || !WGScenarioAppend(script, "", 0, &empty)) {
+        WGScenarioScriptFree(script);
+        return WGScenarioErrorMemory;
+    }
+
+    WGScenarioParser parser = { .script = script, .random = script->seed };
+    const char *end = text + length;
+    size_t line = 0;
+    for (const char *p = text; p < end; ) {
+        const char *newline = memchr(p, '\n', (size_t)(end - p));
+        const char *lineEnd = newline ? newline : end;
+        parser.cursor = p;
+        parser.lineEnd = lineEnd;
+        line++;
+
+        WGScenarioError error = WGScenarioParseLine(&parser);
+        if (error != WGScenarioErrorNone) {
+            char detail[sizeof(script->errorDetail)];
+            memcpy(detail, script->errorDetail, sizeof(detail));
+            WGScenarioScriptFree(script);
+            script->errorLine = line;
+            memcpy(script->errorDetail, detail, sizeof(detail));
+            return error;
+        }
+        p = lineEnd + 1;
+    }
+
+    if (!WGScenarioSortEvents(script)) {
+        WGScenarioScriptFree(script);
+        return WGScenarioErrorMemory;
+    }
+
+    script->tickMs = script->tickMs ? script->tickMs : 1;
+    script->checkMs = script->checkMs ? script->checkMs : 1;
+    uint64_t lastMs = script->eventCount ? script->events[script->eventCount - 1].timeMs : 0;
+    if (script->durationMs == 0) {
+        // Room for the checks that should catch the last event
+        script->durationMs = lastMs + 2 * script->checkMs;
+    }
+    return WGScenarioErrorNone;
+}
+
+WGScenarioError WGScenarioScriptOpen(WGScenarioScript *script, const char *path) {
+    memset(script, 0, sizeof(*script));
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return WGScenarioErrorIO;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        close(fd);
+        return WGScenarioErrorIO;
+    }
+    if (st.st_size == 0) {
+        close(fd);
+        return WGScenarioScriptLoad(script, "", 0);
+    }
+
+    void *base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    int mapError = errno;
+    close(fd);
+    if (base == MAP_FAILED) {
+        errno = mapError;
+        return WGScenarioErrorIO;
+    }
+    // Compiled in one forward pass
+    madvise(base, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+    WGScenarioError error = WGScenarioScriptLoad(script, base, (size_t)st.st_size);
+    munmap(base, (size_t)st.st_size);
+    return error;
+}
+
+void WGScenarioScriptFree(WGScenarioScript *script) {
+    WGHashMapFree(&script->hostIndex);
+    free(script->hosts);
+    free(script->groups);
+    free(script->entries);
+    free(script->events);
+    free(script->strings);
+    memset(script, 0, sizeof(*script));
+}
+
+#pragma mark - Headless Playback
+
+typedef struct {
+    const WGScenarioScript *script;
+    const WGScenarioEvent **expectations;   // Timeline order
+    uint64_t *armedMs;
+    uint64_t *latencies;
+    uint32_t *pending;                      // Armed, not yet met or expired
+    size_t pendingCount;
+} WGScenarioRun;
+
+static bool WGScenarioMatches(const WGScenarioScript *script, const WGARPAnalyzer *analyzer,
+                              const WGScenarioEvent *expect, const WGARPFinding *finding,
+                              const WGRateOffender *offender) {
+    const WGScenarioHost *host = &script->hosts[expect->host];
+    if (offender) {
+        if (expect->finding != WG_SCENARIO_FINDING_RATE) {
+            return false;
+        }
+        switch (offender->kind) {
+            case WGRateKeyIP:
+                return offender->key == host->ip;
+            case WGRateKeyMAC:
+                return offender->key == host->mac;
+            default:
+                return true;
+        }
+    }
+
+    if (finding->kind != expect->finding) {
+        return false;
+    }
+    if (finding->kind == WGARPFindingDuplicateMAC) {
+        if (finding->currentMAC == host->mac) {
+            return true;
+        }
+        for (uint32_t i = 0; i < finding->ipCount; i++) {
+            if (analyzer->duplicateIPs[finding->ipOffset + i] == host->ip) {
+                return true;
+            }
+        }
+        return false;
+    }
+    return finding->ip == host->ip;
+}
+
+static void WGScenarioRunFinding(void *context, const WGARPSimulation *sim, const WGARPFinding *finding,
+                                 const WGRateOffender *offender, bool isTrue) {
+    (void)isTrue;
+    WGScenarioRun *run = context;
+    for (size_t i = 0; i < run->pendingCount; ) {
+        uint32_t index = run->pending[i];
+        const WGScenarioEvent *expect = run->expectations[index];
+        bool expired = expect->value && sim->nowMs > run->armedMs[index] + expect->value;
+        if (!expired && !WGScenarioMatches(run->script, &sim->analyzer, expect, finding, offender)) {
+            i++;
+            continue;
+        }
+        if (!expired) {
+            run->latencies[index] = sim->nowMs - run->armedMs[index];
+        }
+        run->pending[i] = run->pending[--run->pendingCount];
+    }
+}
+
+bool WGScenarioScriptRun(const WGScenarioScript *script, WGScenarioRunResult *result, uint64_t *latencies) {
+    memset(result, 0, sizeof(*result));
+    result->maxLatencyMs = WG_ARP_SIM_NEVER;
+
+    // Simulator slots: first gateway, first attacker, then everyone else
+    size_t slotCount = WG_ARP_SIM_CLIENTS + script->hostCount;
+    uint32_t *slots = malloc((script->hostCount ? script->hostCount : 1) * sizeof(*slots));
+    uint32_t *ips = calloc(slotCount, sizeof(*ips));
+    uint64_t *macs = calloc(slotCount, sizeof(*macs));
+    uint8_t *present = calloc(slotCount, 1);
+    WGScenarioRun run = {
+        .script = script,
+        .expectations = malloc((script->expectCount ? script->expectCount : 1) * sizeof(*run.expectations)),
+        .armedMs = malloc((script->expectCount ? script->expectCount : 1) * sizeof(uint64_t)),
+        .latencies = malloc((script->expectCount ? script->expectCount : 1) * sizeof(uint64_t)),
+        .pending = malloc((script->expectCount ? script->expectCount : 1) * sizeof(uint32_t))
+    };
+    bool ok = slots && ips && macs && present && run.expectations && run.armedMs && run.latencies && run.pending;
+
+    uint32_t nextSlot = WG_ARP_SIM_CLIENTS;
+    bool hasGateway = false, hasAttacker = false;
+    for (size_t host = 0; ok && host < script->hostCount; host++) {
+        const WGScenarioHost *entry = &script->hosts[host];
+        uint32_t slot;
+        if (entry->role == WGScenarioRoleGateway && !hasGateway) {
+            slot = WG_ARP_SIM_GATEWAY;
+            hasGateway = true;
+        } else if (entry->role == WGScenarioRoleAttacker && !hasAttacker) {
+            slot = WG_ARP_SIM_ATTACKER;
+            hasAttacker = true;
+        } else {
+            slot = nextSlot++;
+        }
+        slots[host] = slot;
+        ips[slot] = entry->ip;
+        macs[slot] = entry->mac;
+    }
+    for (size_t i = 0; ok && i < script->entryCount; i++) {
+        if (script->entries[i].table == WGScenarioTableVictim) {
+            present[slots[script->entries[i].host]] = 1;
+        }
+    }
+    for (size_t i = 0, expect = 0; ok && i < script->eventCount; i++) {
+        if (script->events[i].action == WGScenarioActionExpect) {
+            run.expectations[expect] = &script->events[i];
+            run.armedMs[expect] = WG_ARP_SIM_NEVER;
+            run.latencies[expect] = WG_ARP_SIM_NEVER;
+            expect++;
+        }
+    }
+
+    WGARPSimulation sim = { 0 };
+    WGARPSimScenario scenario = {
+        .name = WGScenarioString(script, script->name),
+        .clientCount = nextSlot - WG_ARP_SIM_CLIENTS,
+        .durationMs = script->durationMs,
+        .checkIntervalMs = (uint32_t)(script->checkMs < UINT32_MAX ? script->checkMs : UINT32_MAX),
+        .joinsPerSecond = script->joinsPerSecond,
+        .leavesPerSecond = script->leavesPerSecond,
+        .releasesPerSecond = script->releasesPerSecond,
+        .attack = WGARPSimAttackNone,
+        .seed = script->seed,
+        .hostIPs = ips,
+        .hostMACs = macs,
+        .hostPresent = present,
+        .onFinding = WGScenarioRunFinding,
+        .findingContext = &run
+    };
+    ok = ok && WGARPSimInit(&sim, &scenario);
+    for (size_t host = 0; ok && host < script->hostCount; host++) {
+        if (script->hosts[host].role == WGScenarioRoleAttacker) {
+            ok = WGARPSimMarkAttackerMAC(&sim, script->hosts[host].mac);
+        }
+    }
+
+    // Events land at their own times, each batch before the check that sees it
+    size_t cursor = 0;
+    uint32_t armed = 0;
+    bool done = false;
+    while (ok) {
+        const WGScenarioEvent *batch = NULL;
+        size_t count = WGScenarioScriptAdvance(script, &cursor, sim.nextCheckMs, &batch);
+        for (size_t i = 0; i < count; i++) {
+            const WGScenarioEvent *event = &batch[i];
+            sim.nowMs = event->timeMs > sim.nowMs ? event->timeMs : sim.nowMs;
+            if (event->action == WGScenarioActionExpect) {
+                run.armedMs[armed] = event->timeMs;
+                run.pending[run.pendingCount++] = armed++;
+            } else if (event->table != WGScenarioTableVictim) {
+                continue;   // The gateway's cache is not visible from here
+            } else if (event->action == WGScenarioActionSet) {
+                WGARPSimSetMAC(&sim, slots[event->host], event->value, event->flags & WGScenarioEventMalicious);
+            } else if (event->action == WGScenarioActionRemove) {
+                WGARPSimRemove(&sim, slots[event->host]);
+            }
+        }
+        if (!WGARPSimStep(&sim, &done)) {
+            break;
+        }
+    }
+    ok = ok && done;
+
+    if (ok) {
+        result->sim = sim.result;
+        result->expectations = (uint32_t)script->expectCount;
+        for (size_t i = 0; i < script->expectCount; i++) {
+            uint64_t latency = run.latencies[i];
+            if (latency == WG_ARP_SIM_NEVER) {
+                continue;
+            }
+            result->met++;
+            if (result->maxLatencyMs == WG_ARP_SIM_NEVER || latency > result->maxLatencyMs) {
+                result->maxLatencyMs = latency;
+            }
+        }
+        if (latencies) {
+            memcpy(latencies, run.latencies, script->expectCount * sizeof(*latencies));
+        }
+    }
+
+    WGARPSimFree(&sim);
+    free(slots);
+    free(ips);
+    free(macs);
+    free(present);
+    free(run.expectations);
+    free(run.armedMs);
+    free(run.latencies);
+    free(run.pending);
+    return ok;
+}
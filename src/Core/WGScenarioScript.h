@@ -0,0 +1,204 @@
+/*
+ * WGScenarioScript.h - Declarative Simulation Scenarios
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * SIMULATION ONLY - scripts describe synthetic hosts and tables; nothing
+ * is sent or read from a network.
+ *
+ * A scenario is a small line-oriented text file (.wgscn) naming hosts,
+ * the initial ARP tables, timed table mutations, narration events and the
+ * detections the analyzer is expected to raise:
+ *
+ *     scenario Basic ARP Spoofing
+ *     host gateway gateway 192.168.1.1 AA:BB:CC:DD:EE:01
+ *     host attacker attacker 192.168.1.50 AA:BB:CC:DD:EE:05
+ *     hosts client 500 client 192.168.2.1 02:00:00:00:10:00
+ *     table victim gateway attacker client*
+ *     @3s note SPOOFED_ARP malicious Attacker claims 192.168.1.1
+ *     @4s set victim gateway attacker malicious
+ *     @4s expect gateway_mac_change gateway within 6s
+ *     @10s every 500ms x 200 set victim client* random
+ *     @2m end
+ *
+ * Loading compiles the text once: host names are interned into a flat
+ * array (events carry indexes), repetitions and host groups are expanded,
+ * random MACs are drawn from the script seed, and the timeline is sorted
+ * by time into one array of fixed-size events. Playback is then a cursor
+ * moving forward over that array (WGScenarioScriptAdvance), with no
+ * allocation or lookup per step. The grammar is in README.md.
+ *
+ * WGScenarioScriptRun plays a script headless through WGARPSimulation:
+ * the "victim" table is the cache WiFiGuard reads, so its mutations reach
+ * the real parser, analyzer and rate window; expectations are matched
+ * against the findings.
+ */
+
+#ifndef WG_SCENARIO_SCRIPT_H
+#define WG_SCENARIO_SCRIPT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "WGARPSimulation.h"
+#include "WGHashMap.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WG_SCENARIO_MAX_EVENTS  (1u << 22)  // After expansion
+#define WG_SCENARIO_MAX_HOSTS   (1u << 20)
+
+typedef enum {
+    WGScenarioErrorNone = 0,
+    WGScenarioErrorIO,          // open/read failed (see errno)
+    WGScenarioErrorSyntax,      // Unknown directive or malformed argument
+    WGScenarioErrorHost,        // Unknown host, or a name declared twice
+    WGScenarioErrorLimit,       // Too many hosts or events
+    WGScenarioErrorMemory
+} WGScenarioError;
+
+typedef enum {
+    WGScenarioRoleClient = 0,
+    WGScenarioRoleGateway,
+    WGScenarioRoleVictim,
+    WGScenarioRoleAttacker
+} WGScenarioRole;
+
+typedef enum {
+    WGScenarioTableVictim = 0,  // The monitored device's cache
+    WGScenarioTableGateway,
+    WGScenarioTableCount
+} WGScenarioTable;
+
+typedef enum {
+    WGScenarioActionNote = 0,   // Narration only
+    WGScenarioActionSet,        // table[host's IP] = value
+    WGScenarioActionRemove,     // table entry for host ages out
+    WGScenarioActionExpect,     // finding about host from now on
+    WGScenarioActionEnd         // Interactive playback completes
+} WGScenarioAction;
+
+enum {
+    WGScenarioEventMalicious = 1 << 0
+};
+
+// Expectation kinds are WGARPFindingKind values, or this for the rate window
+#define WG_SCENARIO_FINDING_RATE 0
+
+typedef struct {
+    uint32_t name;              // String offset
+    uint8_t role;               // WGScenarioRole
+    uint32_t ip;
+    uint64_t mac;
+} WGScenarioHost;
+
+typedef struct {
+    uint64_t timeMs;
+    uint64_t value;             // Set: MAC; Expect: window in ms (0 = until the end)
+    uint32_t host;              // Set, Remove, Expect: index into hosts
+    uint32_t type;              // Note: event type (string offset)
+    uint32_t text;              // Note: description (string offset)
+    uint8_t action;             // WGScenarioAction
+    uint8_t table;              // Set, Remove: WGScenarioTable
+    uint8_t flags;              // WGScenarioEventMalicious
+    uint8_t finding;            // Expect: WGARPFindingKind or WG_SCENARIO_FINDING_RATE
+} WGScenarioEvent;
+
+// Initial table contents: host's IP -> host's MAC
+typedef struct {
+    uint32_t host;
+    uint8_t table;
+} WGScenarioEntry;
+
+// A `hosts` line, for prefix* references
+typedef struct {
+    uint32_t prefix;            // String offset
+    uint32_t first;
+    uint32_t count;
+} WGScenarioGroup;
+
+typedef struct {
+    uint32_t name;              // String offsets ("" when not given)
+    uint32_t description;
+    uint64_t tickMs;            // Interactive: virtual time per timer tick
+    uint64_t checkMs;           // Headless: ARP check interval
+    uint64_t durationMs;        // Headless run length (resolved at load)
+    uint64_t seed;
+    double joinsPerSecond;      // Headless background churn over client hosts
+    double leavesPerSecond;
+    double releasesPerSecond;
+
+    WGScenarioHost *hosts;
+    size_t hostCount;
+    size_t hostCapacity;
+    WGHashMap hostIndex;        // Name hash -> host (probing on collision)
+    WGScenarioGroup *groups;
+    size_t groupCount;
+    size_t groupCapacity;
+    WGScenarioEntry *entries;
+    size_t entryCount;
+    size_t entryCapacity;
+
+    // Timeline, sorted by time; declaration order within a millisecond
+    WGScenarioEvent *events;
+    size_t eventCount;
+    size_t eventCapacity;
+    size_t expectCount;
+
+    char *strings;              // NUL-terminated, offset 0 is ""
+    size_t stringLength;
+    size_t stringCapacity;
+
+    // First error, for messages
+    size_t errorLine;
+    char errorDetail[64];
+} WGScenarioScript;
+
+// Open reads a file; Load compiles caller-owned text (need not be
+// NUL-terminated). On error the script is empty but still needs Free.
+WGScenarioError WGScenarioScriptOpen(WGScenarioScript *script, const char *path);
+WGScenarioError WGScenarioScriptLoad(WGScenarioScript *script, const char *text, size_t length);
+void WGScenarioScriptFree(WGScenarioScript *script);
+
+const char *WGScenarioErrorString(WGScenarioError error);
+const char *WGScenarioRoleName(WGScenarioRole role);
+const char *WGScenarioFindingName(uint8_t finding);
+
+static inline const char *WGScenarioString(const WGScenarioScript *script, uint32_t offset) {
+    return script->strings + offset;
+}
+
+// Playback - the events due by untilMs, from *cursor on. Returns how many
+// (a slice of script->events) and moves the cursor past them.
+static inline size_t WGScenarioScriptAdvance(const WGScenarioScript *script, size_t *cursor,
+                                             uint64_t untilMs, const WGScenarioEvent **batch) {
+    size_t begin = *cursor;
+    size_t end = begin;
+    while (end < script->eventCount && script->events[end].timeMs <= untilMs) {
+        end++;
+    }
+    *batch = script->events + begin;
+    *cursor = end;
+    return end - begin;
+}
+
+typedef struct {
+    WGARPSimResult sim;
+    uint32_t expectations;
+    uint32_t met;
+    uint64_t maxLatencyMs;      // Over met expectations, WG_ARP_SIM_NEVER if none
+} WGScenarioRunResult;
+
+// Headless playback through WGARPSimulation. latencies (optional,
+// expectCount entries in timeline order) receives each expectation's
+// latency or WG_ARP_SIM_NEVER if it was missed. False only on allocation
+// failure.
+bool WGScenarioScriptRun(const WGScenarioScript *script, WGScenarioRunResult *result, uint64_t *latencies);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WG_SCENARIO_SCRIPT_H */
@@ -0,0 +1,285 @@
+/*
+ * WGSchedulePolicy.c - Adaptive Monitoring Schedule Implementation
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ */
+
+#include "WGSchedulePolicy.h"
+#include "WGMetrics.h"
+
+#include <string.h>
+
+#define WG_SCHEDULE_NS_PER_SECOND 1000000000ull
+#define WG_SCHEDULE_MAX_LEEWAY    WG_SCHEDULE_NS_PER_SECOND
+
+uint64_t WGScheduleClockMonotonicNs(void *context) {
+    (void)context;
+    return WGMetricsNow();
+}
+
+static inline uint64_t WGScheduleMax(uint64_t a, uint64_t b) {
+    return a > b ? a : b;
+}
+
+static inline uint64_t WGScheduleMin(uint64_t a, uint64_t b) {
+    return a < b ? a : b;
+}
+
+static inline WGScheduleTask *WGScheduleTaskAt(WGSchedulePolicy *policy, int task) {
+    if (task < 0 || (size_t)task >= policy->count || !policy->tasks[task].used) {
+        return NULL;
+    }
+    return &policy->tasks[task];
+}
+
+static uint64_t WGScheduleBudgetFloor(const WGScheduleTask *task);
+
+#pragma mark - Configuration
+
+WGScheduleConfig WGScheduleConfigDefault(uint64_t baseNs) {
+    WGScheduleConfig config = {
+        .baseNs = baseNs,
+        .fastNs = WGScheduleMax(baseNs / 3, WG_SCHEDULE_NS_PER_SECOND),
+        .maxNs = baseNs * 8,
+        .quietRunsPerStep = 3,
+        .escalationNs = 60 * WG_SCHEDULE_NS_PER_SECOND,
+        .cpuBudget = 0,
+        .maxWakeupsPerMinute = 0
+    };
+    return config;
+}
+
+// Keeps fast <= base <= max with every interval at least 1 ns
+static WGScheduleConfig WGScheduleConfigSanitize(const WGScheduleConfig *config) {
+    WGScheduleConfig result = *config;
+    result.baseNs = WGScheduleMax(result.baseNs, 1);
+    result.fastNs = WGScheduleMin(WGScheduleMax(result.fastNs, 1), result.baseNs);
+    result.maxNs = WGScheduleMax(result.maxNs, result.baseNs);
+    result.quietRunsPerStep = result.quietRunsPerStep ? result.quietRunsPerStep : 1;
+    if (!(result.cpuBudget > 0 && result.cpuBudget <= 1)) {
+        result.cpuBudget = 0;
+    }
+    return result;
+}
+
+void WGSchedulePolicyInit(WGSchedulePolicy *policy, WGScheduleClockFn clock, void *clockContext) {
+    memset(policy, 0, sizeof(*policy));
+    policy->clock = clock ? clock : WGScheduleClockMonotonicNs;
+    policy->clockContext = clockContext;
+}
+
+int WGSchedulePolicyAddTask(WGSchedulePolicy *policy, const WGScheduleConfig *config) {
+    size_t index = 0;
+    while (index < policy->count && policy->tasks[index].used) {
+        index++;
+    }
+    if (index >= WG_SCHEDULE_MAX_TASKS) {
+        return -1;
+    }
+    if (index == policy->count) {
+        policy->count++;
+    }
+
+    WGScheduleTask *task = &policy->tasks[index];
+    memset(task, 0, sizeof(*task));
+    task->used = true;
+    task->config = WGScheduleConfigSanitize(config);
+    task->intervalNs = task->config.baseNs;
+    task->nextDueNs = WG_SCHEDULE_NEVER;
+    return (int)index;
+}
+
+void WGSchedulePolicyRemoveTask(WGSchedulePolicy *policy, int index) {
+    WGScheduleTask *task = WGScheduleTaskAt(policy, index);
+    if (task) {
+        memset(task, 0, sizeof(*task));
+        task->nextDueNs = WG_SCHEDULE_NEVER;
+    }
+}
+
+void WGSchedulePolicyConfigure(WGSchedulePolicy *policy, int index, const WGScheduleConfig *config) {
+    WGScheduleTask *task = WGScheduleTaskAt(policy, index);
+    if (!task) {
+        return;
+    }
+    task->config = WGScheduleConfigSanitize(config);
+    task->intervalNs = WGScheduleMin(WGScheduleMax(task->intervalNs, task->config.baseNs),
+                                     task->config.maxNs);
+    if (task->active && !task->running) {
+        // Apply at once rather than after a possibly long old interval
+        task->nextDueNs = WGScheduleMin(task->nextDueNs,
+                                        task->lastRunNs + WGSchedulePolicyEffectiveInterval(policy, index));
+    }
+}
+
+#pragma mark - Lifecycle
+
+void WGSchedulePolicyStart(WGSchedulePolicy *policy, int index) {
+    WGScheduleTask *task = WGScheduleTaskAt(policy, index);
+    if (!task) {
+        return;
+    }
+    uint64_t now = policy->clock(policy->clockContext);
+    task->active = true;
+    task->running = false;
+    task->intervalNs = task->config.baseNs;
+    task->quietRuns = 0;
+    task->escalatedUntilNs = 0;
+    task->averageRunNs = 0;
+    task->startedNs = now;
+    task->lastRunNs = now;
+    task->nextDueNs = now + WGScheduleMax(task->intervalNs, WGScheduleBudgetFloor(task));
+    memset(&task->stats, 0, sizeof(task->stats));
+}
+
+void WGSchedulePolicyStop(WGSchedulePolicy *policy, int index) {
+    WGScheduleTask *task = WGScheduleTaskAt(policy, index);
+    if (task) {
+        task->active = false;
+        task->running = false;
+        task->nextDueNs = WG_SCHEDULE_NEVER;
+    }
+}
+
+uint64_t WGSchedulePolicyNextDue(const WGSchedulePolicy *policy, int *task) {
+    uint64_t due = WG_SCHEDULE_NEVER;
+    int which = -1;
+    for (size_t i = 0; i < policy->count; i++) {
+        if (policy->tasks[i].used && policy->tasks[i].active && policy->tasks[i].nextDueNs < due) {
+            due = policy->tasks[i].nextDueNs;
+            which = (int)i;
+        }
+    }
+    if (task) {
+        *task = which;
+    }
+    return due;
+}
+
+#pragma mark - Adaptation
+
+// Budget floor: the interval at which the average run stays within the
+// CPU share, and the one that keeps wake-ups under the per-minute cap
+static uint64_t WGScheduleBudgetFloor(const WGScheduleTask *task) {
+    uint64_t floor = 0;
+    if (task->config.cpuBudget > 0) {
+        floor = (uint64_t)((double)task->averageRunNs / task->config.cpuBudget);
+    }
+    if (task->config.maxWakeupsPerMinute > 0) {
+        floor = WGScheduleMax(floor, 60 * WG_SCHEDULE_NS_PER_SECOND / task->config.maxWakeupsPerMinute);
+    }
+    return floor;
+}
+
+static uint64_t WGScheduleTaskInterval(const WGScheduleTask *task, uint64_t now) {
+    uint64_t interval = now < task->escalatedUntilNs ? task->config.fastNs : task->intervalNs;
+    return WGScheduleMax(interval, WGScheduleBudgetFloor(task));
+}
+
+// Fast polling for every active task; ones waiting on a longer interval
+// are pulled in to run one fast interval after their last run
+static void WGScheduleEscalate(WGSchedulePolicy *policy, uint64_t now) {
+    for (size_t i = 0; i < policy->count; i++) {
+        WGScheduleTask *task = &policy->tasks[i];
+        if (!task->used || !task->active) {
+            continue;
+        }
+        task->quietRuns = 0;
+        task->intervalNs = task->config.baseNs;
+        if (now >= task->escalatedUntilNs) {
+            task->stats.escalations++;
+        }
+        task->escalatedUntilNs = now + task->config.escalationNs;
+        if (!task->running) {
+            uint64_t due = WGScheduleMax(task->lastRunNs + WGScheduleTaskInterval(task, now), now);
+            task->nextDueNs = WGScheduleMin(task->nextDueNs, due);
+        }
+    }
+}
+
+static void WGScheduleApplyActivity(WGSchedulePolicy *policy, WGScheduleTask *task,
+                                    WGScheduleActivity activity, uint64_t now) {
+    switch (activity) {
+        case WGScheduleActivityQuiet:
+            if (++task->quietRuns >= task->config.quietRunsPerStep) {
+                task->quietRuns = 0;
+                task->intervalNs = WGScheduleMin(task->intervalNs * 2, task->config.maxNs);
+            }
+            break;
+
+        case WGScheduleActivityChanged:
+            task->quietRuns = 0;
+            task->intervalNs = task->config.baseNs;
+            break;
+
+        case WGScheduleActivityAlert:
+            WGScheduleEscalate(policy, now);
+            break;
+    }
+}
+
+void WGSchedulePolicyBeginRun(WGSchedulePolicy *policy, int index) {
+    WGScheduleTask *task = WGScheduleTaskAt(policy, index);
+    if (task && task->active) {
+        task->running = true;
+        task->nextDueNs = WG_SCHEDULE_NEVER;
+    }
+}
+
+void WGSchedulePolicyRecordRun(WGSchedulePolicy *policy, int index, uint64_t durationNs,
+                               WGScheduleActivity activity) {
+    WGScheduleTask *task = WGScheduleTaskAt(policy, index);
+    if (!task || !task->active) {
+        return;
+    }
+    uint64_t now = policy->clock(policy->clockContext);
+
+    task->running = false;
+    task->averageRunNs = task->stats.runs == 0 ? durationNs
+                                               : (task->averageRunNs * 3 + durationNs) / 4;
+    task->stats.runs++;
+    task->stats.busyNs += durationNs;
+    task->stats.activeNs = now - task->startedNs;
+
+    WGScheduleApplyActivity(policy, task, activity, now);
+
+    uint64_t adaptive = now < task->escalatedUntilNs ? task->config.fastNs : task->intervalNs;
+    uint64_t interval = WGSchedulePolicyEffectiveInterval(policy, index);
+    if (interval > adaptive) {
+        task->stats.budgetLimited++;
+    }
+    task->lastRunNs = now;
+    task->nextDueNs = now + interval;
+}
+
+void WGSchedulePolicyNoteActivity(WGSchedulePolicy *policy, int index, WGScheduleActivity activity) {
+    WGScheduleTask *task = WGScheduleTaskAt(policy, index);
+    if (!task || !task->active || activity == WGScheduleActivityQuiet) {
+        return;
+    }
+    uint64_t now = policy->clock(policy->clockContext);
+    WGScheduleApplyActivity(policy, task, activity, now);
+
+    if (!task->running) {
+        uint64_t due = WGScheduleMax(task->lastRunNs + WGScheduleTaskInterval(task, now), now);
+        task->nextDueNs = WGScheduleMin(task->nextDueNs, due);
+    }
+}
+
+#pragma mark - Queries
+
+uint64_t WGSchedulePolicyEffectiveInterval(const WGSchedulePolicy *policy, int index) {
+    const WGScheduleTask *task = WGScheduleTaskAt((WGSchedulePolicy *)policy, index);
+    if (!task) {
+        return WG_SCHEDULE_NEVER;
+    }
+    return WGScheduleTaskInterval(task, policy->clock(policy->clockContext));
+}
+
+uint64_t WGSchedulePolicyLeeway(const WGSchedulePolicy *policy, int index) {
+    uint64_t interval = WGSchedulePolicyEffectiveInterval(policy, index);
+    return interval == WG_SCHEDULE_NEVER ? 0 : WGScheduleMin(interval / 10, WG_SCHEDULE_MAX_LEEWAY);
+}
+
+double WGScheduleStatsDutyCycle(const WGScheduleStats *stats) {
+    return stats->activeNs > 0 ? (double)stats->busyNs / (double)stats->activeNs : 0;
+}
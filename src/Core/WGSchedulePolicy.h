@@ -0,0 +1,132 @@
+/*
+ * WGSchedulePolicy.h - Adaptive Monitoring Schedule
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * Decides when each periodic monitoring task (Wi-Fi scan, ARP check) runs
+ * next. A task starts at its base interval, doubles towards its ceiling
+ * while runs keep finding nothing new, drops back to base on any change
+ * and escalates to its fast interval for a while after an alert.
+ *
+ * An alert on any task escalates every active task, since they watch the
+ * same network. Budgets are hard floors on the interval: the CPU budget
+ * keeps the average run cost below a fraction of one core, the energy
+ * budget caps wake-ups per minute. Escalation cannot break either.
+ *
+ * The policy does no I/O and reads time only through an injectable
+ * nanosecond clock, so schedules can be replayed deterministically.
+ * WGMonitorScheduler drives it from a dispatch timer.
+ */
+
+#ifndef WG_SCHEDULE_POLICY_H
+#define WG_SCHEDULE_POLICY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WG_SCHEDULE_MAX_TASKS 8
+#define WG_SCHEDULE_NEVER     UINT64_MAX
+
+// Returns monotonic nanoseconds; must never go backwards
+typedef uint64_t (*WGScheduleClockFn)(void *context);
+
+// WGMetricsNow(), which shares its time base with dispatch timers
+uint64_t WGScheduleClockMonotonicNs(void *context);
+
+typedef enum {
+    WGScheduleActivityQuiet = 0,    // Nothing new (same BSSIDs, no ARP diff)
+    WGScheduleActivityChanged,      // New networks, ARP table diff
+    WGScheduleActivityAlert         // Anomaly or gateway MAC change
+} WGScheduleActivity;
+
+typedef struct {
+    uint64_t baseNs;                // Interval after any change
+    uint64_t fastNs;                // Interval while escalated
+    uint64_t maxNs;                 // Back-off ceiling while stable
+    uint32_t quietRunsPerStep;      // Quiet runs before each doubling
+    uint64_t escalationNs;          // How long an alert keeps fastNs
+    double cpuBudget;               // Max average run cost / interval; 0 = none
+    uint32_t maxWakeupsPerMinute;   // 0 = none
+} WGScheduleConfig;
+
+typedef struct {
+    uint64_t runs;
+    uint64_t busyNs;                // Sum of run durations
+    uint64_t activeNs;              // Time since the task was started
+    uint64_t escalations;
+    uint64_t budgetLimited;         // Runs whose interval a budget raised
+} WGScheduleStats;
+
+typedef struct {
+    WGScheduleConfig config;
+    bool used;
+    bool active;
+    bool running;                   // Between BeginRun and RecordRun
+    uint64_t intervalNs;            // Adaptive interval before budgets
+    uint64_t lastRunNs;
+    uint64_t nextDueNs;             // WG_SCHEDULE_NEVER when stopped or running
+    uint64_t escalatedUntilNs;
+    uint64_t startedNs;
+    uint64_t averageRunNs;          // EWMA of run durations (1/4 weight)
+    uint32_t quietRuns;
+    WGScheduleStats stats;
+} WGScheduleTask;
+
+typedef struct {
+    WGScheduleTask tasks[WG_SCHEDULE_MAX_TASKS];
+    size_t count;                   // Slots ever used (high-water mark)
+    WGScheduleClockFn clock;
+    void *clockContext;
+} WGSchedulePolicy;
+
+// Defaults: fast = base / 3 (at least 1 s), max = base * 8, 3 quiet runs
+// per doubling, 60 s escalation, no budgets
+WGScheduleConfig WGScheduleConfigDefault(uint64_t baseNs);
+
+// clock may be NULL for WGScheduleClockMonotonicNs
+void WGSchedulePolicyInit(WGSchedulePolicy *policy, WGScheduleClockFn clock, void *clockContext);
+
+// Returns the task index, or -1 when full. Tasks start stopped; removed
+// slots are reused.
+int WGSchedulePolicyAddTask(WGSchedulePolicy *policy, const WGScheduleConfig *config);
+void WGSchedulePolicyRemoveTask(WGSchedulePolicy *policy, int task);
+void WGSchedulePolicyConfigure(WGSchedulePolicy *policy, int task, const WGScheduleConfig *config);
+
+// Start resets the task to its base interval with fresh stats; the first
+// run is one base interval away (callers do their initial pass themselves)
+void WGSchedulePolicyStart(WGSchedulePolicy *policy, int task);
+void WGSchedulePolicyStop(WGSchedulePolicy *policy, int task);
+
+// Earliest due time over active tasks (WG_SCHEDULE_NEVER if none) and, if
+// task is non-NULL, which task it belongs to
+uint64_t WGSchedulePolicyNextDue(const WGSchedulePolicy *policy, int *task);
+
+// The task was dispatched; it is not due again until RecordRun
+void WGSchedulePolicyBeginRun(WGSchedulePolicy *policy, int task);
+
+// A run that took durationNs just finished; schedules the next one
+void WGSchedulePolicyRecordRun(WGSchedulePolicy *policy, int task, uint64_t durationNs,
+                               WGScheduleActivity activity);
+
+// Activity seen between runs (asynchronous scan results, kernel ARP
+// notifications). May pull the next run earlier, never later.
+void WGSchedulePolicyNoteActivity(WGSchedulePolicy *policy, int task, WGScheduleActivity activity);
+
+// Interval the next run was scheduled with, budgets applied
+uint64_t WGSchedulePolicyEffectiveInterval(const WGSchedulePolicy *policy, int task);
+
+// Timer slack the scheduler may allow: a tenth of the interval, up to 1 s
+uint64_t WGSchedulePolicyLeeway(const WGSchedulePolicy *policy, int task);
+
+// Fraction of the active time spent running (0-1)
+double WGScheduleStatsDutyCycle(const WGScheduleStats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WG_SCHEDULE_POLICY_H */
@@ -0,0 +1,247 @@
+/*
+ * WGSignalStats.c - Per-BSSID RSSI Statistics Implementation
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ */
+
+#include "WGSignalStats.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define WG_SIGNAL_KALMAN_PRIOR 100.0f      // dB², Kalman P of a freshly seeded slot
+
+#if defined(__GNUC__) || defined(__clang__)
+#define WG_SIGNAL_VECTOR 1
+typedef float WGSignalLane __attribute__((vector_size(WG_SIGNAL_LANES * sizeof(float))));
+typedef int32_t WGSignalMask __attribute__((vector_size(WG_SIGNAL_LANES * sizeof(int32_t))));
+#endif
+
+WGSignalParams WGSignalParamsDefault(void) {
+    return (WGSignalParams){
+        .alpha = 0.2f,
+        .varianceFloor = 1.0f,
+        .processNoise = 0.5f,
+        .measurementNoise = 4.0f,
+        .stepThreshold = 4.0f,
+        .minSamples = 8.0f
+    };
+}
+
+#pragma mark - Lifecycle
+
+// Every per-slot array, in one place for growth and moves
+#define WG_SIGNAL_ARRAY_COUNT 9
+
+static void WGSignalStatsArrays(WGSignalStats *stats, float **arrays[WG_SIGNAL_ARRAY_COUNT]) {
+    arrays[0] = &stats->input;
+    arrays[1] = &stats->weight;
+    arrays[2] = &stats->ewma;
+    arrays[3] = &stats->variance;
+    arrays[4] = &stats->kalman;
+    arrays[5] = &stats->kalmanError;
+    arrays[6] = &stats->samples;
+    arrays[7] = &stats->baseline;
+    arrays[8] = &stats->score;
+}
+
+void WGSignalStatsInit(WGSignalStats *stats, WGSignalParams params) {
+    memset(stats, 0, sizeof(*stats));
+    stats->params = params;
+}
+
+void WGSignalStatsFree(WGSignalStats *stats) {
+    float **arrays[WG_SIGNAL_ARRAY_COUNT];
+    WGSignalStatsArrays(stats, arrays);
+    for (size_t i = 0; i < WG_SIGNAL_ARRAY_COUNT; i++) {
+        free(*arrays[i]);
+        *arrays[i] = NULL;
+    }
+    stats->count = stats->capacity = 0;
+}
+
+bool WGSignalStatsReserve(WGSignalStats *stats, size_t needed) {
+    if (needed <= stats->capacity) {
+        return true;
+    }
+    size_t capacity = stats->capacity ? stats->capacity * 2 : 64;
+    while (capacity < needed) {
+        capacity *= 2;
+    }
+    capacity = (capacity + WG_SIGNAL_LANES - 1) / WG_SIGNAL_LANES * WG_SIGNAL_LANES;
+
+    // New space is zeroed, so padding lanes are unobserved and finite
+    float **arrays[WG_SIGNAL_ARRAY_COUNT];
+    WGSignalStatsArrays(stats, arrays);
+    for (size_t i = 0; i < WG_SIGNAL_ARRAY_COUNT; i++) {
+        float *grown = realloc(*arrays[i], capacity * sizeof(float));
+        if (!grown) {
+            return false;
+        }
+        memset(grown + stats->capacity, 0, (capacity - stats->capacity) * sizeof(float));
+        *arrays[i] = grown;
+    }
+    stats->capacity = capacity;
+    return true;
+}
+
+#pragma mark - Slots
+
+void WGSignalStatsRestart(WGSignalStats *stats, size_t slot, float rssi) {
+    stats->input[slot] = rssi;
+    stats->weight[slot] = 0;
+    stats->ewma[slot] = rssi;
+    stats->variance[slot] = 0;
+    stats->kalman[slot] = rssi;
+    stats->kalmanError[slot] = WG_SIGNAL_KALMAN_PRIOR;
+    stats->samples[slot] = 1;
+    stats->baseline[slot] = rssi;
+    stats->score[slot] = 0;
+}
+
+void WGSignalStatsAdd(WGSignalStats *stats, float rssi) {
+    WGSignalStatsRestart(stats, stats->count++, rssi);
+}
+
+void WGSignalStatsRemoveAt(WGSignalStats *stats, size_t slot) {
+    float **arrays[WG_SIGNAL_ARRAY_COUNT];
+    WGSignalStatsArrays(stats, arrays);
+    size_t last = --stats->count;
+    for (size_t i = 0; i < WG_SIGNAL_ARRAY_COUNT; i++) {
+        float *array = *arrays[i];
+        array[slot] = array[last];
+        array[last] = 0;        // Back to a clean padding lane
+    }
+}
+
+#pragma mark - Update
+
+// Per observed slot, with n samples so far and weight a = alpha, raised
+// towards 1/(n+1) while n is small so early estimates are plain means:
+//
+//   d        = x - ewma
+//   score    = d² / (variance + varianceFloor)
+//   ewma     = ewma + a d
+//   variance = (1 - a) (variance + a d²)
+//   P        = P + q;  K = P / (P + r);  kalman += K (x - kalman);  P -= K P
+//
+// Every update is scaled by the slot's weight, so unobserved slots keep
+// their state and score 0.
+
+size_t WGSignalStatsUpdateScalar(WGSignalStats *stats) {
+    const WGSignalParams *params = &stats->params;
+    float threshold = params->stepThreshold > 0 ? params->stepThreshold * params->stepThreshold : INFINITY;
+    size_t steps = 0;
+
+    for (size_t i = 0; i < stats->count; i++) {
+        if (stats->weight[i] == 0) {
+            stats->baseline[i] = stats->ewma[i];
+            stats->score[i] = 0;
+            continue;
+        }
+        float x = stats->input[i];
+        float n = stats->samples[i];
+        float a = params->alpha + (1 - params->alpha) / (n + 1);
+        float d = x - stats->ewma[i];
+        float score = d * d / (stats->variance[i] + params->varianceFloor);
+
+        stats->baseline[i] = stats->ewma[i];
+        stats->score[i] = score;
+        stats->ewma[i] += a * d;
+        stats->variance[i] = (1 - a) * (stats->variance[i] + a * d * d);
+
+        float p = stats->kalmanError[i] + params->processNoise;
+        float k = p / (p + params->measurementNoise);
+        stats->kalman[i] += k * (x - stats->kalman[i]);
+        stats->kalmanError[i] = p - k * p;
+        stats->samples[i] = n + 1;
+        stats->weight[i] = 0;
+
+        steps += score >= threshold && n + 1 > params->minSamples;
+    }
+    return steps;
+}
+
+#ifdef WG_SIGNAL_VECTOR
+
+static inline WGSignalLane WGSignalSplat(float value) {
+    return (WGSignalLane){ value, value, value, value };
+}
+
+static inline WGSignalLane WGSignalLoad(const float *p) {
+    WGSignalLane lane;
+    memcpy(&lane, p, sizeof(lane));
+    return lane;
+}
+
+static inline void WGSignalStore(float *p, WGSignalLane lane) {
+    memcpy(p, &lane, sizeof(lane));
+}
+
+size_t WGSignalStatsUpdateVector(WGSignalStats *stats) {
+    const WGSignalParams *params = &stats->params;
+    const WGSignalLane alpha = WGSignalSplat(params->alpha);
+    const WGSignalLane varianceFloor = WGSignalSplat(params->varianceFloor);
+    const WGSignalLane q = WGSignalSplat(params->processNoise);
+    const WGSignalLane r = WGSignalSplat(params->measurementNoise);
+    const WGSignalLane minSamples = WGSignalSplat(params->minSamples);
+    const WGSignalLane threshold = WGSignalSplat(params->stepThreshold > 0 ?
+                                                 params->stepThreshold * params->stepThreshold : INFINITY);
+    const WGSignalLane one = WGSignalSplat(1);
+    const WGSignalLane zero = WGSignalSplat(0);
+    WGSignalMask flagged = { 0, 0, 0, 0 };
+
+    // Padding lanes past count have weight 0, so whole lanes are safe
+    size_t end = (stats->count + WG_SIGNAL_LANES - 1) / WG_SIGNAL_LANES * WG_SIGNAL_LANES;
+    for (size_t i = 0; i < end; i += WG_SIGNAL_LANES) {
+        WGSignalLane w = WGSignalLoad(stats->weight + i);
+        WGSignalLane x = WGSignalLoad(stats->input + i);
+        WGSignalLane n = WGSignalLoad(stats->samples + i);
+        WGSignalLane ewma = WGSignalLoad(stats->ewma + i);
+        WGSignalLane variance = WGSignalLoad(stats->variance + i);
+
+        WGSignalLane a = alpha + (one - alpha) / (n + one);
+        WGSignalLane d = x - ewma;
+        WGSignalLane dd = d * d;
+        WGSignalLane score = w * (dd / (variance + varianceFloor));
+
+        WGSignalStore(stats->baseline + i, ewma);
+        WGSignalStore(stats->score + i, score);
+        WGSignalStore(stats->ewma + i, ewma + w * a * d);
+        WGSignalStore(stats->variance + i, variance + w * ((one - a) * (variance + a * dd) - variance));
+
+        WGSignalLane kalman = WGSignalLoad(stats->kalman + i);
+        WGSignalLane p = WGSignalLoad(stats->kalmanError + i) + w * q;
+        WGSignalLane k = w * (p / (p + r));
+        WGSignalStore(stats->kalman + i, kalman + k * (x - kalman));
+        WGSignalStore(stats->kalmanError + i, p - k * p);
+
+        n += w;
+        WGSignalStore(stats->samples + i, n);
+        WGSignalStore(stats->weight + i, zero);
+
+        flagged -= (score >= threshold) & (n > minSamples);
+    }
+
+    size_t steps = 0;
+    for (int lane = 0; lane < WG_SIGNAL_LANES; lane++) {
+        steps += (size_t)flagged[lane];
+    }
+    return steps;
+}
+
+size_t WGSignalStatsUpdate(WGSignalStats *stats) {
+    return WGSignalStatsUpdateVector(stats);
+}
+
+#else
+
+size_t WGSignalStatsUpdateVector(WGSignalStats *stats) {
+    return WGSignalStatsUpdateScalar(stats);
+}
+
+size_t WGSignalStatsUpdate(WGSignalStats *stats) {
+    return WGSignalStatsUpdateScalar(stats);
+}
+
+#endif
@@ -0,0 +1,105 @@
+/*
+ * WGSignalStats.h - Per-BSSID RSSI Statistics
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * Running signal statistics for every network in the scan table, kept as
+ * a structure of arrays indexed by table slot so one scan updates them all
+ * in a single pass. Per slot: an EWMA of RSSI with its exponentially
+ * weighted variance, a scalar Kalman estimate (random-walk model) for
+ * display, and a step score - the squared z-score of the newest sample
+ * against the EWMA and variance it arrived to. A large step on an AP that
+ * has been steady is what an impostor taking over its BSSID looks like.
+ *
+ * A scan writes its observations with WGSignalStatsObserve, then
+ * WGSignalStatsUpdate folds them in. Slots not observed this scan pass
+ * through unchanged (their weight is 0), so the kernel has no branches:
+ * it runs over SIMD lanes using compiler vector types (SSE on x86, NEON on
+ * arm64), with a scalar reference kept for comparison and for compilers
+ * without them. Arrays are padded to whole lanes.
+ *
+ * Not thread-safe - WGScanIngest drives it under its state lock.
+ */
+
+#ifndef WG_SIGNAL_STATS_H
+#define WG_SIGNAL_STATS_H
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WG_SIGNAL_LANES 4
+
+typedef struct {
+    float alpha;            // EWMA weight of a new sample once warmed up
+    float varianceFloor;    // dB², keeps a perfectly steady AP's score finite
+    float processNoise;     // Kalman q, dB² per scan
+    float measurementNoise; // Kalman r, dB²
+    float stepThreshold;    // z-score that flags a step, 0 = never
+    float minSamples;       // Samples folded in before steps are flagged
+} WGSignalParams;
+
+typedef struct {
+    WGSignalParams params;
+    size_t count;
+    size_t capacity;        // Whole lanes
+
+    // Scan inputs
+    float *input;           // RSSI observed this scan
+    float *weight;          // 1 if observed this scan, else 0
+
+    // State and outputs
+    float *ewma;
+    float *variance;        // Exponentially weighted, dB²
+    float *kalman;          // Smoothed RSSI
+    float *kalmanError;     // Kalman P, dB²
+    float *samples;         // Folded in so far
+    float *baseline;        // EWMA before the newest sample
+    float *score;           // Squared z-score of the newest sample, 0 if unobserved
+} WGSignalStats;
+
+// Defaults: alpha 0.2, 1 dB² floor, q 0.5 / r 4 dB², steps at 4 sigma after 8 samples
+WGSignalParams WGSignalParamsDefault(void);
+
+// Lifecycle
+void WGSignalStatsInit(WGSignalStats *stats, WGSignalParams params);
+void WGSignalStatsFree(WGSignalStats *stats);
+bool WGSignalStatsReserve(WGSignalStats *stats, size_t needed);
+
+// Table slots, mirroring the owner's swap-remove. Add seeds a new slot at
+// count with its first sample (Reserve first).
+void WGSignalStatsAdd(WGSignalStats *stats, float rssi);
+void WGSignalStatsRemoveAt(WGSignalStats *stats, size_t slot);
+void WGSignalStatsRestart(WGSignalStats *stats, size_t slot, float rssi);
+
+static inline void WGSignalStatsObserve(WGSignalStats *stats, size_t slot, float rssi) {
+    stats->input[slot] = rssi;
+    stats->weight[slot] = 1;
+}
+
+// Folds this scan's observations into every slot and clears them; returns
+// the number of slots whose step score crossed the threshold. Update uses
+// the vector kernel when available.
+size_t WGSignalStatsUpdate(WGSignalStats *stats);
+size_t WGSignalStatsUpdateScalar(WGSignalStats *stats);
+size_t WGSignalStatsUpdateVector(WGSignalStats *stats);
+
+// Whether the last update flagged slot as a step
+static inline bool WGSignalStatsIsStep(const WGSignalStats *stats, size_t slot) {
+    float threshold = stats->params.stepThreshold;
+    return threshold > 0 && stats->samples[slot] > stats->params.minSamples &&
+           stats->score[slot] >= threshold * threshold;
+}
+
+static inline float WGSignalStatsZScore(const WGSignalStats *stats, size_t slot) {
+    return sqrtf(stats->score[slot]);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WG_SIGNAL_STATS_H */
@@ -13,6 +13,9 @@
  * 
  * The simulation uses pre-defined scenarios and artificial data to
  * demonstrate what ARP spoofing looks like for educational purposes.
+ * Scenarios are .wgscn scripts (WGScenarioScript): the built-in ones ship
+ * in the bundle's Scenarios folder, and scripts dropped into
+ * Documents/Scenarios can be played without rebuilding.
  */
 
 #import <Foundation/Foundation.h>
@@ -77,6 +80,7 @@ typedef NS_ENUM(NSInteger, WGSimulationScenario) {
 - (void)simulationDidStart:(WGSimulationScenario)scenario;
 - (void)simulationDidStop;
 - (void)simulationDidGenerateEvent:(WGSimulationEvent *)event;
+- (void)simulationDidGenerateEvents:(NSArray<WGSimulationEvent *> *)events; // One call per tick, preferred over the above
 - (void)simulationStateDidUpdate:(WGSimulationState *)state;
 - (void)simulationDidComplete:(WGSimulationScenario)scenario withSummary:(NSDictionary *)summary;
 @end
@@ -92,8 +96,9 @@ typedef NS_ENUM(NSInteger, WGSimulationScenario) {
 // Initialization
 - (instancetype)initWithAuditLogger:(WGAuditLogger *)logger;
 
-// Simulation Control
-- (BOOL)startSimulation:(WGSimulationScenario)scenario;
+// Simulation Control - each timer tick plays the script events due by then
+- (BOOL)startSimulation:(WGSimulationScenario)scenario;  // NO if its script is missing from the bundle
+- (BOOL)startScriptedSimulationAtPath:(NSString *)path error:(NSError **)error;
 - (void)stopSimulation;
 - (void)pauseSimulation;
 - (void)resumeSimulation;
@@ -103,6 +108,8 @@ typedef NS_ENUM(NSInteger, WGSimulationScenario) {
 + (NSString *)scenarioName:(WGSimulationScenario)scenario;
 + (NSString *)scenarioDescription:(WGSimulationScenario)scenario;
 + (NSArray<NSNumber *> *)availableScenarios;
++ (nullable NSString *)scriptPathForScenario:(WGSimulationScenario)scenario;
++ (NSArray<NSString *> *)scenarioScriptPaths; // Bundled, then Documents/Scenarios
 
 // Data Access
 - (NSArray<WGSimulationEvent *> *)eventLog;
@@ -112,6 +119,16 @@ typedef NS_ENUM(NSInteger, WGSimulationScenario) {
 // Export
 - (NSDictionary *)exportSimulationResults;
 
+// Headless runs (SIMULATION ONLY) - the scenario with hostCount synthetic
+// clients and background churn, played at full speed on a virtual clock
+// through the real ARP analysis (WGARPSimulation). Returns detection
+// latency, true/false positives and throughput; runs on the calling thread.
+- (nullable NSDictionary *)runHeadlessScenario:(WGSimulationScenario)scenario hostCount:(NSUInteger)hostCount;
+- (NSArray<NSDictionary *> *)runHeadlessBatchWithHostCount:(NSUInteger)hostCount; // Churn baseline + every scenario
+
+// Headless run of a script, also reporting its expected detections met
+- (nullable NSDictionary *)runHeadlessScriptAtPath:(NSString *)path error:(NSError **)error;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -22,6 +22,25 @@
 
 #import "WGSimulationEngine.h"
 #import "WGAuditLogger.h"
+#import "WGARPSimulation.h"
+#import "WGScenarioScript.h"
+#import "WGAddress.h"
+#import "WGMetrics.h"
+
+static NSError *WGScenarioNSError(WGScenarioError scenarioError, const WGScenarioScript *script, NSString *path) {
+    if (scenarioError == WGScenarioErrorIO) {
+        return [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:nil];
+    }
+    NSString *description = [NSString stringWithFormat:@"%@:%zu: %s: %s", path.lastPathComponent,
+                             script->errorLine, WGScenarioErrorString(scenarioError), script->errorDetail];
+    return [NSError errorWithDomain:@"WGScenarioError"
+                               code:scenarioError
+                           userInfo:@{NSLocalizedDescriptionKey: description}];
+}
+
+static NSString *WGScenarioNSString(const WGScenarioScript *script, uint32_t offset) {
+    return [NSString stringWithUTF8String:WGScenarioString(script, offset)] ?: @"";
+}
 
 #pragma mark - WGSimulatedHost Implementation
 
@@ -83,15 +102,20 @@
 
 #pragma mark - WGSimulationEngine Implementation
 
-@interface WGSimulationEngine ()
+@interface WGSimulationEngine () {
+    WGScenarioScript _script;   // Scenario being played, kept until the next start
+    size_t _cursor;             // Next event in _script.events
+    uint64_t _virtualMs;
+}
 
 @property (nonatomic, strong) WGAuditLogger *auditLogger;
 @property (nonatomic, strong) WGSimulationState *currentState;
 @property (nonatomic, assign) BOOL isRunning;
 @property (nonatomic, assign) BOOL isPaused;
 @property (nonatomic, strong) NSTimer *simulationTimer;
-@property (nonatomic, assign) NSInteger currentStep;
 @property (nonatomic, assign) WGSimulationScenario currentScenario;
+@property (nonatomic, copy) NSString *scenarioTitle;
+@property (nonatomic, copy) NSString *scenarioDetails;
 
 @end
 
@@ -106,7 +130,8 @@
         _currentState = [[WGSimulationState alloc] init];
         _isRunning = NO;
         _isPaused = NO;
-        _currentStep = 0;
+        _scenarioTitle = [WGSimulationEngine scenarioName:WGSimulationScenarioNone];
+        _scenarioDetails = [WGSimulationEngine scenarioDescription:WGSimulationScenarioNone];
         
         [_auditLogger logEvent:@"SIMULATION_ENGINE_INIT" 
                        details:@"Educational simulation engine initialized (NO REAL ATTACKS)"];
@@ -116,6 +141,7 @@
 
 - (void)dealloc {
     [self stopSimulation];
+    WGScenarioScriptFree(&_script);
 }
 
 #pragma mark - Scenario Information
@@ -169,25 +195,96 @@
     ];
 }
 
++ (NSString *)scriptPathForScenario:(WGSimulationScenario)scenario {
+    NSString *name;
+    switch (scenario) {
+        case WGSimulationScenarioBasicARPSpoof:
+            name = @"basic_arp_spoof";
+            break;
+        case WGSimulationScenarioMITMAttack:
+            name = @"mitm_attack";
+            break;
+        case WGSimulationScenarioDuplicateMAC:
+            name = @"duplicate_mac";
+            break;
+        case WGSimulationScenarioRapidChanges:
+            name = @"rapid_changes";
+            break;
+        case WGSimulationScenarioGratuitousARP:
+            name = @"gratuitous_arp";
+            break;
+        default:
+            return nil;
+    }
+    return [[NSBundle mainBundle] pathForResource:name ofType:@"wgscn" inDirectory:@"Scenarios"];
+}
+
++ (NSArray<NSString *> *)scenarioScriptPaths {
+    NSMutableArray<NSString *> *paths = [[[NSBundle mainBundle] pathsForResourcesOfType:@"wgscn"
+                                                                            inDirectory:@"Scenarios"] mutableCopy];
+    NSString *documents = NSSearchPathForDirectoriesInDomains(NSDocumentDirectory, NSUserDomainMask, YES).firstObject;
+    NSString *userDirectory = [documents stringByAppendingPathComponent:@"Scenarios"];
+    for (NSString *file in [[NSFileManager defaultManager] contentsOfDirectoryAtPath:userDirectory error:nil]) {
+        if ([file.pathExtension isEqualToString:@"wgscn"]) {
+            [paths addObject:[userDirectory stringByAppendingPathComponent:file]];
+        }
+    }
+    return paths;
+}
+
 #pragma mark - Simulation Control
 
 - (BOOL)startSimulation:(WGSimulationScenario)scenario {
+    NSString *path = [WGSimulationEngine scriptPathForScenario:scenario];
+    NSError *error = nil;
+    if (!path || ![self startScriptAtPath:path scenario:scenario error:&error]) {
+        NSLog(@"[WiFiGuard] Cannot load scenario %@: %@", [WGSimulationEngine scenarioName:scenario],
+              error.localizedDescription ?: @"missing from bundle");
+        return NO;
+    }
+    return YES;
+}
+
+- (BOOL)startScriptedSimulationAtPath:(NSString *)path error:(NSError **)error {
+    return [self startScriptAtPath:path scenario:WGSimulationScenarioNone error:error];
+}
+
+- (BOOL)startScriptAtPath:(NSString *)path scenario:(WGSimulationScenario)scenario error:(NSError **)error {
+    WGScenarioScript script;
+    WGScenarioError scriptError = WGScenarioScriptOpen(&script, path.fileSystemRepresentation);
+    if (scriptError != WGScenarioErrorNone) {
+        if (error) {
+            *error = WGScenarioNSError(scriptError, &script, path);
+        }
+        WGScenarioScriptFree(&script);
+        return NO;
+    }
+    
     if (self.isRunning) {
         [self stopSimulation];
     }
+    WGScenarioScriptFree(&_script);
+    _script = script;
+    _cursor = 0;
+    _virtualMs = 0;
+    
+    NSString *name = WGScenarioNSString(&_script, _script.name);
+    NSString *details = WGScenarioNSString(&_script, _script.description);
+    self.currentScenario = scenario;
+    self.scenarioTitle = scenario != WGSimulationScenarioNone ? [WGSimulationEngine scenarioName:scenario]
+                       : name.length > 0 ? name : path.lastPathComponent.stringByDeletingPathExtension;
+    self.scenarioDetails = details.length > 0 ? details : [WGSimulationEngine scenarioDescription:scenario];
     
     // Log simulation start
     [self.auditLogger logEvent:@"SIMULATION_STARTED" 
                        details:[NSString stringWithFormat:@"Scenario: %@ (EDUCATIONAL ONLY - NO REAL ATTACKS)",
-                               [WGSimulationEngine scenarioName:scenario]]];
+                               self.scenarioTitle]];
     
-    self.currentScenario = scenario;
-    self.currentStep = 0;
     self.isRunning = YES;
     self.isPaused = NO;
     
     // Initialize simulation state
-    [self initializeScenario:scenario];
+    [self initializeScriptState];
     
     // Start simulation timer (1 second intervals for visualization)
     self.simulationTimer = [NSTimer scheduledTimerWithTimeInterval:1.0
@@ -242,56 +339,32 @@
 
 #pragma mark - Scenario Initialization
 
-- (void)initializeScenario:(WGSimulationScenario)scenario {
+- (NSMutableDictionary<NSString *, NSString *> *)stateTable:(uint8_t)table {
+    return table == WGScenarioTableGateway ? self.currentState.gatewayARPTable : self.currentState.victimARPTable;
+}
+
+- (void)initializeScriptState {
     // Create fresh state
     self.currentState = [[WGSimulationState alloc] init];
-    self.currentState.activeScenario = scenario;
-    
-    // Create simulated network hosts (all synthetic data)
-    NSMutableArray *hosts = [NSMutableArray array];
-    
-    // Gateway (router)
-    WGSimulatedHost *gateway = [WGSimulatedHost hostWithName:@"Gateway Router"
-                                                          ip:@"192.168.1.1"
-                                                         mac:@"AA:BB:CC:DD:EE:01"
-                                                        role:@"gateway"];
-    [hosts addObject:gateway];
-    
-    // Victim host
-    WGSimulatedHost *victim = [WGSimulatedHost hostWithName:@"Victim PC"
-                                                         ip:@"192.168.1.100"
-                                                        mac:@"AA:BB:CC:DD:EE:10"
-                                                       role:@"victim"];
-    [hosts addObject:victim];
-    
-    // Attacker (simulated)
-    WGSimulatedHost *attacker = [WGSimulatedHost hostWithName:@"Attacker Machine"
-                                                           ip:@"192.168.1.50"
-                                                          mac:@"AA:BB:CC:DD:EE:05"
-                                                         role:@"attacker"];
-    [hosts addObject:attacker];
-    
-    // Additional clients
-    WGSimulatedHost *client1 = [WGSimulatedHost hostWithName:@"Client Device 1"
-                                                          ip:@"192.168.1.101"
-                                                         mac:@"AA:BB:CC:DD:EE:11"
-                                                        role:@"client"];
-    [hosts addObject:client1];
-    
-    WGSimulatedHost *client2 = [WGSimulatedHost hostWithName:@"Client Device 2"
-                                                          ip:@"192.168.1.102"
-                                                         mac:@"AA:BB:CC:DD:EE:12"
-                                                        role:@"client"];
-    [hosts addObject:client2];
+    self.currentState.activeScenario = self.currentScenario;
     
+    // Simulated network hosts (all synthetic data, from the script)
+    NSMutableArray<WGSimulatedHost *> *hosts = [NSMutableArray arrayWithCapacity:_script.hostCount];
+    for (size_t i = 0; i < _script.hostCount; i++) {
+        const WGScenarioHost *host = &_script.hosts[i];
+        [hosts addObject:[WGSimulatedHost hostWithName:WGScenarioNSString(&_script, host->name)
+                                                    ip:WGStringFromIPv4(host->ip)
+                                                   mac:WGStringFromMAC(host->mac)
+                                                  role:@(WGScenarioRoleName(host->role))]];
+    }
     self.currentState.hosts = hosts;
     
-    // Initialize clean ARP tables
-    self.currentState.victimARPTable[@"192.168.1.1"] = @"AA:BB:CC:DD:EE:01";   // Gateway
-    self.currentState.victimARPTable[@"192.168.1.50"] = @"AA:BB:CC:DD:EE:05";  // Attacker
-    
-    self.currentState.gatewayARPTable[@"192.168.1.100"] = @"AA:BB:CC:DD:EE:10"; // Victim
-    self.currentState.gatewayARPTable[@"192.168.1.50"] = @"AA:BB:CC:DD:EE:05";  // Attacker
+    // Initial ARP tables
+    for (size_t i = 0; i < _script.entryCount; i++) {
+        const WGScenarioEntry *entry = &_script.entries[i];
+        WGSimulatedHost *host = hosts[entry->host];
+        [self stateTable:entry->table][host.ipAddress] = host.macAddress;
+    }
     
     // Log initial state
     WGSimulationEvent *initEvent = [WGSimulationEvent eventWithType:@"INIT"
@@ -301,325 +374,82 @@
 
 #pragma mark - Simulation Execution
 
+// Plays every script event due by the new virtual time: a forward scan of
+// the compiled timeline, delivered to the delegate as one batch
 - (void)simulationTick {
-    self.currentState.elapsedTime += 1.0;
-    self.currentStep++;
+    _virtualMs += _script.tickMs;
+    self.currentState.elapsedTime = _virtualMs / 1000.0;
     
-    switch (self.currentScenario) {
-        case WGSimulationScenarioBasicARPSpoof:
-            [self executeBasicARPSpoofStep];
-            break;
-        case WGSimulationScenarioMITMAttack:
-            [self executeMITMAttackStep];
-            break;
-        case WGSimulationScenarioDuplicateMAC:
-            [self executeDuplicateMACStep];
-            break;
-        case WGSimulationScenarioRapidChanges:
-            [self executeRapidChangesStep];
-            break;
-        case WGSimulationScenarioGratuitousARP:
-            [self executeGratuitousARPStep];
-            break;
-        default:
-            break;
-    }
+    const WGScenarioEvent *batch = NULL;
+    size_t count = WGScenarioScriptAdvance(&_script, &_cursor, _virtualMs, &batch);
+    NSMutableArray<WGSimulationEvent *> *events = [NSMutableArray array];
+    BOOL ended = _cursor >= _script.eventCount;
     
-    // Notify delegate of state update
-    if ([self.delegate respondsToSelector:@selector(simulationStateDidUpdate:)]) {
-        dispatch_async(dispatch_get_main_queue(), ^{
-            [self.delegate simulationStateDidUpdate:self.currentState];
-        });
-    }
-}
-
-#pragma mark - Scenario Execution: Basic ARP Spoof
-
-- (void)executeBasicARPSpoofStep {
-    switch (self.currentStep) {
-        case 1: {
-            // Normal network traffic
-            WGSimulationEvent *event = [WGSimulationEvent eventWithType:@"NORMAL_TRAFFIC"
-                description:@"📶 Normal network traffic: Victim communicates with gateway"];
-            [self.currentState.eventLog addObject:event];
-            [self notifyEvent:event];
-            break;
-        }
-        case 2: {
-            // Attacker prepares
-            WGSimulationEvent *event = [WGSimulationEvent eventWithType:@"ATTACK_PREP"
-                description:@"🔍 Attacker scans network and identifies gateway (192.168.1.1)"];
-            event.sourceIP = @"192.168.1.50";
-            event.sourceMAC = @"AA:BB:CC:DD:EE:05";
-            [self.currentState.eventLog addObject:event];
-            [self notifyEvent:event];
-            break;
-        }
-        case 3: {
-            // Attacker sends spoofed ARP reply
-            WGSimulationEvent *event = [WGSimulationEvent eventWithType:@"SPOOFED_ARP"
-                description:@"⚠️ Attacker sends spoofed ARP reply: 'I am 192.168.1.1' with attacker's MAC"];
-            event.sourceIP = @"192.168.1.50";
-            event.sourceMAC = @"AA:BB:CC:DD:EE:05";
-            event.targetIP = @"192.168.1.100";
-            event.isMalicious = YES;
+    for (size_t i = 0; i < count; i++) {
+        const WGScenarioEvent *scriptEvent = &batch[i];
+        BOOL malicious = (scriptEvent->flags & WGScenarioEventMalicious) != 0;
+        if (malicious) {
             self.currentState.attackInProgress = YES;
-            [self.currentState.eventLog addObject:event];
-            [self notifyEvent:event];
-            break;
-        }
-        case 4: {
-            // Victim's ARP table poisoned
-            self.currentState.victimARPTable[@"192.168.1.1"] = @"AA:BB:CC:DD:EE:05"; // Changed!
-            
-            WGSimulationEvent *event = [WGSimulationEvent eventWithType:@"ARP_POISONED"
-                description:@"🚨 VICTIM'S ARP TABLE POISONED: Gateway MAC now points to attacker!"];
-            event.isMalicious = YES;
-            event.targetIP = @"192.168.1.1";
-            event.targetMAC = @"AA:BB:CC:DD:EE:05";
-            [self.currentState.eventLog addObject:event];
-            [self notifyEvent:event];
-            break;
-        }
-        case 5: {
-            // Traffic interception
-            WGSimulationEvent *event = [WGSimulationEvent eventWithType:@"TRAFFIC_INTERCEPTED"
-                description:@"📨 Victim's traffic to gateway now goes to attacker"];
-            event.isMalicious = YES;
-            [self.currentState.eventLog addObject:event];
-            [self notifyEvent:event];
-            break;
         }
-        case 6: {
-            // Detection event
-            WGSimulationEvent *event = [WGSimulationEvent eventWithType:@"DETECTED"
-                description:@"✅ WiFiGuard DETECTED: Gateway MAC changed from AA:BB:CC:DD:EE:01 to AA:BB:CC:DD:EE:05"];
-            [self.currentState.eventLog addObject:event];
-            [self notifyEvent:event];
-            break;
-        }
-        case 7: {
-            // Simulation complete
-            [self completeSimulation];
-            break;
-        }
-    }
-}
-
-#pragma mark - Scenario Execution: MITM Attack
-
-- (void)executeMITMAttackStep {
-    switch (self.currentStep) {
-        case 1: {
-            WGSimulationEvent *event = [WGSimulationEvent eventWithType:@"NORMAL_STATE"
-                description:@"📶 Initial state: Victim and Gateway have correct ARP entries"];
-            [self.currentState.eventLog addObject:event];
-            [self notifyEvent:event];
-            break;
-        }
-        case 2: {
-            WGSimulationEvent *event = [WGSimulationEvent eventWithType:@"MITM_START"
-                description:@"🔍 Attacker initiates MITM: Will poison both victim AND gateway"];
-            event.sourceIP = @"192.168.1.50";
-            event.isMalicious = YES;
-            [self.currentState.eventLog addObject:event];
-            [self notifyEvent:event];
-            break;
-        }
-        case 3: {
-            // Poison victim
-            self.currentState.victimARPTable[@"192.168.1.1"] = @"AA:BB:CC:DD:EE:05";
-            
-            WGSimulationEvent *event = [WGSimulationEvent eventWithType:@"VICTIM_POISONED"
-                description:@"⚠️ Victim poisoned: Gateway points to attacker MAC"];
-            event.isMalicious = YES;
-            self.currentState.attackInProgress = YES;
-            [self.currentState.eventLog addObject:event];
-            [self notifyEvent:event];
-            break;
-        }
-        case 4: {
-            // Poison gateway
-            self.currentState.gatewayARPTable[@"192.168.1.100"] = @"AA:BB:CC:DD:EE:05";
-            
-            WGSimulationEvent *event = [WGSimulationEvent eventWithType:@"GATEWAY_POISONED"
-                description:@"⚠️ Gateway poisoned: Victim IP points to attacker MAC"];
-            event.isMalicious = YES;
-            [self.currentState.eventLog addObject:event];
-            [self notifyEvent:event];
-            break;
-        }
-        case 5: {
-            WGSimulationEvent *event = [WGSimulationEvent eventWithType:@"MITM_ACTIVE"
-                description:@"🚨 FULL MITM ACTIVE: All traffic between victim and gateway flows through attacker"];
-            event.isMalicious = YES;
-            [self.currentState.eventLog addObject:event];
-            [self notifyEvent:event];
-            break;
-        }
-        case 6: {
-            WGSimulationEvent *event = [WGSimulationEvent eventWithType:@"DATA_INTERCEPTED"
-                description:@"📧 Attacker can read/modify: HTTP traffic, DNS queries, unencrypted data"];
-            event.isMalicious = YES;
-            [self.currentState.eventLog addObject:event];
-            [self notifyEvent:event];
-            break;
-        }
-        case 7: {
-            WGSimulationEvent *event = [WGSimulationEvent eventWithType:@"DETECTED"
-                description:@"✅ WiFiGuard DETECTED multiple anomalies: Gateway MAC change + Duplicate MAC for multiple IPs"];
-            [self.currentState.eventLog addObject:event];
-            [self notifyEvent:event];
-            break;
-        }
-        case 8: {
-            [self completeSimulation];
-            break;
-        }
-    }
-}
-
-#pragma mark - Scenario Execution: Duplicate MAC
-
-- (void)executeDuplicateMACStep {
-    switch (self.currentStep) {
-        case 1: {
-            WGSimulationEvent *event = [WGSimulationEvent eventWithType:@"NORMAL_STATE"
-                description:@"📶 Normal state: Each IP has unique MAC address"];
-            [self.currentState.eventLog addObject:event];
-            [self notifyEvent:event];
-            break;
-        }
-        case 2: {
-            // Attacker claims gateway IP
-            self.currentState.victimARPTable[@"192.168.1.1"] = @"AA:BB:CC:DD:EE:05";
-            
-            WGSimulationEvent *event = [WGSimulationEvent eventWithType:@"FIRST_SPOOF"
-                description:@"⚠️ Attacker spoofs gateway IP (192.168.1.1) with own MAC"];
-            event.isMalicious = YES;
-            self.currentState.attackInProgress = YES;
-            [self.currentState.eventLog addObject:event];
-            [self notifyEvent:event];
-            break;
-        }
-        case 3: {
-            // Attacker claims another IP
-            self.currentState.victimARPTable[@"192.168.1.101"] = @"AA:BB:CC:DD:EE:05";
-            
-            WGSimulationEvent *event = [WGSimulationEvent eventWithType:@"SECOND_SPOOF"
-                description:@"⚠️ Attacker also spoofs client IP (192.168.1.101) with same MAC"];
-            event.isMalicious = YES;
-            [self.currentState.eventLog addObject:event];
-            [self notifyEvent:event];
-            break;
-        }
-        case 4: {
-            WGSimulationEvent *event = [WGSimulationEvent eventWithType:@"DUPLICATE_DETECTED"
-                description:@"🚨 ANOMALY: Same MAC (AA:BB:CC:DD:EE:05) now appears for multiple IPs!"];
-            event.isMalicious = YES;
-            [self.currentState.eventLog addObject:event];
-            [self notifyEvent:event];
-            break;
-        }
-        case 5: {
-            WGSimulationEvent *event = [WGSimulationEvent eventWithType:@"DETECTED"
-                description:@"✅ WiFiGuard DETECTED: Duplicate MAC anomaly - possible ARP spoofing"];
-            [self.currentState.eventLog addObject:event];
-            [self notifyEvent:event];
-            break;
-        }
-        case 6: {
-            [self completeSimulation];
-            break;
+        
+        switch (scriptEvent->action) {
+            case WGScenarioActionNote: {
+                WGSimulationEvent *event = [WGSimulationEvent eventWithType:WGScenarioNSString(&_script, scriptEvent->type)
+                                                                description:WGScenarioNSString(&_script, scriptEvent->text)];
+                event.isMalicious = malicious;
+                [self.currentState.eventLog addObject:event];
+                [events addObject:event];
+                break;
+            }
+            case WGScenarioActionSet: {
+                uint32_t ip = _script.hosts[scriptEvent->host].ip;
+                [self stateTable:scriptEvent->table][WGStringFromIPv4(ip)] = WGStringFromMAC(scriptEvent->value);
+                break;
+            }
+            case WGScenarioActionRemove: {
+                uint32_t ip = _script.hosts[scriptEvent->host].ip;
+                [[self stateTable:scriptEvent->table] removeObjectForKey:WGStringFromIPv4(ip)];
+                break;
+            }
+            case WGScenarioActionEnd:
+                ended = YES;
+                break;
+            default:
+                break;  // Expectations are checked by headless runs
         }
     }
-}
-
-#pragma mark - Scenario Execution: Rapid Changes
-
-- (void)executeRapidChangesStep {
-    if (self.currentStep <= 10) {
-        // Simulate rapid MAC changes
-        NSString *randomMAC = [NSString stringWithFormat:@"XX:XX:XX:%02X:%02X:%02X",
-                              arc4random_uniform(256), arc4random_uniform(256), arc4random_uniform(256)];
-        self.currentState.victimARPTable[@"192.168.1.1"] = randomMAC;
-        self.currentState.attackInProgress = YES;
-        
-        WGSimulationEvent *event = [WGSimulationEvent eventWithType:@"RAPID_CHANGE"
-            description:[NSString stringWithFormat:@"⚠️ ARP change #%ld: Gateway MAC → %@", 
-                        (long)self.currentStep, randomMAC]];
-        event.isMalicious = YES;
-        [self.currentState.eventLog addObject:event];
-        [self notifyEvent:event];
-    } else if (self.currentStep == 11) {
-        WGSimulationEvent *event = [WGSimulationEvent eventWithType:@"DETECTED"
-            description:@"✅ WiFiGuard DETECTED: Rapid ARP table changes - possible ARP flood attack"];
-        [self.currentState.eventLog addObject:event];
-        [self notifyEvent:event];
-    } else if (self.currentStep == 12) {
+    
+    [self deliverEvents:events];
+    if (ended) {
         [self completeSimulation];
     }
 }
 
-#pragma mark - Scenario Execution: Gratuitous ARP
-
-- (void)executeGratuitousARPStep {
-    switch (self.currentStep) {
-        case 1: {
-            WGSimulationEvent *event = [WGSimulationEvent eventWithType:@"INFO"
-                description:@"ℹ️ Gratuitous ARP: Unsolicited ARP reply used to update network caches"];
-            [self.currentState.eventLog addObject:event];
-            [self notifyEvent:event];
-            break;
-        }
-        case 2: {
-            WGSimulationEvent *event = [WGSimulationEvent eventWithType:@"LEGITIMATE_GARP"
-                description:@"📶 Legitimate use: Device announces its presence after IP change"];
-            [self.currentState.eventLog addObject:event];
-            [self notifyEvent:event];
-            break;
-        }
-        case 3: {
-            WGSimulationEvent *event = [WGSimulationEvent eventWithType:@"MALICIOUS_GARP"
-                description:@"⚠️ Attacker sends gratuitous ARP: 'I am the gateway'"];
-            event.isMalicious = YES;
-            self.currentState.attackInProgress = YES;
-            [self.currentState.eventLog addObject:event];
-            [self notifyEvent:event];
-            break;
-        }
-        case 4: {
-            self.currentState.victimARPTable[@"192.168.1.1"] = @"AA:BB:CC:DD:EE:05";
-            
-            WGSimulationEvent *event = [WGSimulationEvent eventWithType:@"CACHE_UPDATED"
-                description:@"🚨 All devices accepting gratuitous ARP update their caches"];
-            event.isMalicious = YES;
-            [self.currentState.eventLog addObject:event];
-            [self notifyEvent:event];
-            break;
-        }
-        case 5: {
-            WGSimulationEvent *event = [WGSimulationEvent eventWithType:@"DETECTED"
-                description:@"✅ WiFiGuard DETECTED: Unexpected gateway MAC change via gratuitous ARP"];
-            [self.currentState.eventLog addObject:event];
-            [self notifyEvent:event];
-            break;
-        }
-        case 6: {
-            [self completeSimulation];
-            break;
-        }
-    }
-}
-
 #pragma mark - Helpers
 
-- (void)notifyEvent:(WGSimulationEvent *)event {
-    if ([self.delegate respondsToSelector:@selector(simulationDidGenerateEvent:)]) {
-        dispatch_async(dispatch_get_main_queue(), ^{
-            [self.delegate simulationDidGenerateEvent:event];
-        });
+// One main-queue hop per tick, however many events the tick produced
+- (void)deliverEvents:(NSArray<WGSimulationEvent *> *)events {
+    id<WGSimulationEngineDelegate> delegate = self.delegate;
+    WGSimulationState *state = self.currentState;
+    BOOL batched = [delegate respondsToSelector:@selector(simulationDidGenerateEvents:)];
+    BOOL single = [delegate respondsToSelector:@selector(simulationDidGenerateEvent:)];
+    BOOL update = [delegate respondsToSelector:@selector(simulationStateDidUpdate:)];
+    if (!update && (events.count == 0 || !(batched || single))) {
+        return;
     }
+    
+    dispatch_async(dispatch_get_main_queue(), ^{
+        if (events.count > 0 && batched) {
+            [delegate simulationDidGenerateEvents:events];
+        } else if (single) {
+            for (WGSimulationEvent *event in events) {
+                [delegate simulationDidGenerateEvent:event];
+            }
+        }
+        if (update) {
+            [delegate simulationStateDidUpdate:state];
+        }
+    });
 }
 
 - (void)completeSimulation {
@@ -629,7 +459,7 @@
     self.currentState.attackInProgress = NO;
     
     NSDictionary *summary = @{
-        @"scenario": [WGSimulationEngine scenarioName:self.currentScenario],
+        @"scenario": self.scenarioTitle,
         @"duration": @(self.currentState.elapsedTime),
         @"eventCount": @(self.currentState.eventLog.count),
         @"finalVictimARP": [self.currentState.victimARPTable copy],
@@ -679,8 +509,8 @@
     }
     
     return @{
-        @"scenario": [WGSimulationEngine scenarioName:self.currentScenario],
-        @"scenarioDescription": [WGSimulationEngine scenarioDescription:self.currentScenario],
+        @"scenario": self.scenarioTitle,
+        @"scenarioDescription": self.scenarioDetails,
         @"duration": @(self.currentState.elapsedTime),
         @"events": events,
         @"finalState": @{
@@ -691,4 +521,133 @@
     };
 }
 
+#pragma mark - Headless Runs
+
+static WGARPSimAttack WGSimulationAttackForScenario(WGSimulationScenario scenario) {
+    switch (scenario) {
+        case WGSimulationScenarioBasicARPSpoof:
+            return WGARPSimAttackGatewaySpoof;
+        case WGSimulationScenarioMITMAttack:
+            return WGARPSimAttackMITM;
+        case WGSimulationScenarioDuplicateMAC:
+            return WGARPSimAttackDuplicateMAC;
+        case WGSimulationScenarioRapidChanges:
+            return WGARPSimAttackRapidChanges;
+        case WGSimulationScenarioGratuitousARP:
+            return WGARPSimAttackGratuitousARP;
+        default:
+            return WGARPSimAttackNone;
+    }
+}
+
+- (NSDictionary *)runHeadlessScenario:(WGSimulationScenario)scenario hostCount:(NSUInteger)hostCount {
+    WGARPSimScenario config;
+    WGARPSimScenarioPreset(&config, WGSimulationAttackForScenario(scenario),
+                           (uint32_t)MIN(hostCount, (NSUInteger)UINT32_MAX - WG_ARP_SIM_CLIENTS));
+    
+    WGARPSimResult result;
+    uint64_t start = WGMetricsNow();
+    if (!WGARPSimRun(&config, &result)) {
+        NSLog(@"[WiFiGuard] Headless simulation failed (out of memory)");
+        return nil;
+    }
+    double wallSeconds = (WGMetricsNow() - start) / 1e9;
+    
+    uint64_t latency = WGARPSimDetectionLatencyMs(&result);
+    NSMutableDictionary *summary = [@{
+        @"scenario": [WGSimulationEngine scenarioName:scenario],
+        @"hosts": @(config.clientCount),
+        @"virtualDuration": @(config.durationMs / 1000.0),
+        @"checks": @(result.checks),
+        @"records": @(result.records),
+        @"findings": @(result.findings),
+        @"truePositives": @(result.truePositives),
+        @"falsePositives": @(result.falsePositives),
+        @"detected": @(latency != WG_ARP_SIM_NEVER),
+        @"wallTime": @(wallSeconds),
+        @"checksPerSecond": @(wallSeconds > 0 ? result.checks / wallSeconds : 0),
+        @"recordsPerSecond": @(wallSeconds > 0 ? result.records / wallSeconds : 0),
+        @"educational": @"This was a SIMULATION only. No real attacks were performed."
+    } mutableCopy];
+    if (latency != WG_ARP_SIM_NEVER) {
+        summary[@"detectionLatency"] = @(latency / 1000.0);
+    }
+    
+    [self.auditLogger logEvent:@"SIMULATION_HEADLESS_RUN"
+                       details:[NSString stringWithFormat:@"Scenario: %@, hosts: %u, FP: %llu (SIMULATION ONLY)",
+                               summary[@"scenario"], config.clientCount,
+                               (unsigned long long)result.falsePositives]];
+    return summary;
+}
+
+- (NSDictionary *)runHeadlessScriptAtPath:(NSString *)path error:(NSError **)error {
+    WGScenarioScript script;
+    WGScenarioError scriptError = WGScenarioScriptOpen(&script, path.fileSystemRepresentation);
+    if (scriptError != WGScenarioErrorNone) {
+        if (error) {
+            *error = WGScenarioNSError(scriptError, &script, path);
+        }
+        WGScenarioScriptFree(&script);
+        return nil;
+    }
+    
+    WGScenarioRunResult run;
+    uint64_t start = WGMetricsNow();
+    BOOL ok = WGScenarioScriptRun(&script, &run, NULL);
+    double wallSeconds = (WGMetricsNow() - start) / 1e9;
+    NSString *name = WGScenarioNSString(&script, script.name);
+    NSUInteger hostCount = script.hostCount;
+    double virtualDuration = script.durationMs / 1000.0;
+    WGScenarioScriptFree(&script);
+    if (!ok) {
+        if (error) {
+            *error = [NSError errorWithDomain:NSPOSIXErrorDomain code:ENOMEM userInfo:nil];
+        }
+        return nil;
+    }
+    
+    const WGARPSimResult *result = &run.sim;
+    uint64_t latency = WGARPSimDetectionLatencyMs(result);
+    NSMutableDictionary *summary = [@{
+        @"scenario": name.length > 0 ? name : path.lastPathComponent.stringByDeletingPathExtension,
+        @"hosts": @(hostCount),
+        @"virtualDuration": @(virtualDuration),
+        @"checks": @(result->checks),
+        @"records": @(result->records),
+        @"findings": @(result->findings),
+        @"truePositives": @(result->truePositives),
+        @"falsePositives": @(result->falsePositives),
+        @"detected": @(latency != WG_ARP_SIM_NEVER),
+        @"expectations": @(run.expectations),
+        @"expectationsMet": @(run.met),
+        @"wallTime": @(wallSeconds),
+        @"checksPerSecond": @(wallSeconds > 0 ? result->checks / wallSeconds : 0),
+        @"educational": @"This was a SIMULATION only. No real attacks were performed."
+    } mutableCopy];
+    if (latency != WG_ARP_SIM_NEVER) {
+        summary[@"detectionLatency"] = @(latency / 1000.0);
+    }
+    if (run.maxLatencyMs != WG_ARP_SIM_NEVER) {
+        summary[@"maxExpectationLatency"] = @(run.maxLatencyMs / 1000.0);
+    }
+    
+    [self.auditLogger logEvent:@"SIMULATION_HEADLESS_RUN"
+                       details:[NSString stringWithFormat:@"Script: %@, expectations met: %u/%u (SIMULATION ONLY)",
+                               summary[@"scenario"], run.met, run.expectations]];
+    return summary;
+}
+
+- (NSArray<NSDictionary *> *)runHeadlessBatchWithHostCount:(NSUInteger)hostCount {
+    NSMutableArray<NSDictionary *> *results = [NSMutableArray array];
+    NSArray<NSNumber *> *scenarios = [@[@(WGSimulationScenarioNone)]
+                                      arrayByAddingObjectsFromArray:[WGSimulationEngine availableScenarios]];
+    for (NSNumber *scenario in scenarios) {
+        NSDictionary *summary = [self runHeadlessScenario:scenario.integerValue hostCount:hostCount];
+        if (summary) {
+            [results addObject:summary];
+        }
+    }
+    return results;
+}
+
 @end
@@ -0,0 +1,451 @@
+/*
+ * WGSnapshot.c - Binary Columnar Snapshot Format Implementation
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ */
+
+#include "WGSnapshot.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// On-disk header (24 bytes)
+typedef struct {
+    char magic[8];
+    uint16_t version;
+    uint16_t columnCount;
+    uint32_t reserved;
+    double createdAt;
+} WGSnapshotHeader;
+
+// Directory entry (24 bytes)
+typedef struct {
+    uint32_t column;            // WGSnapshotColumn
+    uint32_t elementSize;
+    uint64_t count;
+    uint64_t offset;
+} WGSnapshotDirectoryEntry;
+
+// Element size of each column, in WGSnapshotColumn order
+static const uint32_t kWGSnapshotElementSize[WGSnapshotColumnCount] = {
+    [WGSnapshotColumnNetworkBSSID]       = sizeof(uint64_t),
+    [WGSnapshotColumnNetworkLastSeen]    = sizeof(double),
+    [WGSnapshotColumnNetworkSSID]        = sizeof(uint32_t),
+    [WGSnapshotColumnNetworkChannel]     = sizeof(uint16_t),
+    [WGSnapshotColumnNetworkWidth]       = sizeof(uint16_t),
+    [WGSnapshotColumnNetworkRSSI]        = sizeof(int8_t),
+    [WGSnapshotColumnNetworkSecurity]    = sizeof(uint8_t),
+    [WGSnapshotColumnNetworkFlags]       = sizeof(uint8_t),
+    [WGSnapshotColumnNetworkSampleStart] = sizeof(uint32_t),
+    [WGSnapshotColumnNetworkSampleCount] = sizeof(uint16_t),
+    [WGSnapshotColumnSampleTime]         = sizeof(double),
+    [WGSnapshotColumnSampleRSSI]         = sizeof(int8_t),
+    [WGSnapshotColumnARPMAC]             = sizeof(uint64_t),
+    [WGSnapshotColumnARPIP]              = sizeof(uint32_t),
+    [WGSnapshotColumnARPFlags]           = sizeof(uint16_t),
+    [WGSnapshotColumnARPFirstSeen]       = sizeof(double),
+    [WGSnapshotColumnARPLastSeen]        = sizeof(double),
+    [WGSnapshotColumnARPInterface]       = sizeof(uint32_t),
+    [WGSnapshotColumnAnomalyPreviousMAC] = sizeof(uint64_t),
+    [WGSnapshotColumnAnomalyCurrentMAC]  = sizeof(uint64_t),
+    [WGSnapshotColumnAnomalyIP]          = sizeof(uint32_t),
+    [WGSnapshotColumnAnomalyType]        = sizeof(uint8_t),
+    [WGSnapshotColumnAnomalySeverity]    = sizeof(uint8_t),
+    [WGSnapshotColumnAnomalyDetectedAt]  = sizeof(double),
+    [WGSnapshotColumnAnomalyDetails]     = sizeof(uint32_t),
+    [WGSnapshotColumnStrings]            = sizeof(char),
+};
+
+static size_t WGSnapshotAlign(size_t value) {
+    return (value + 7) & ~(size_t)7;
+}
+
+#pragma mark - Writer
+
+static bool WGSnapshotBufferAppend(WGSnapshotWriter *writer, WGSnapshotColumn column,
+                                   const void *data, size_t length) {
+    WGSnapshotBuffer *buffer = &writer->columns[column];
+    if (writer->failed) {
+        return false;
+    }
+
+    if (buffer->length + length > buffer->capacity) {
+        size_t capacity = buffer->capacity ? buffer->capacity : 256;
+        while (capacity < buffer->length + length) {
+            capacity *= 2;
+        }
+        uint8_t *grown = realloc(buffer->data, capacity);
+        if (!grown) {
+            writer->failed = true;
+            return false;
+        }
+        buffer->data = grown;
+        buffer->capacity = capacity;
+    }
+
+    memcpy(buffer->data + buffer->length, data, length);
+    buffer->length += length;
+    return true;
+}
+
+#define WG_SNAPSHOT_APPEND(writer, column, value) \
+    WGSnapshotBufferAppend((writer), (column), &(value), sizeof(value))
+
+static uint64_t WGSnapshotHashString(const char *string) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (const uint8_t *p = (const uint8_t *)string; *p; p++) {
+        hash = (hash ^ *p) * 0x100000001b3ULL;
+    }
+    return hash == WG_HASH_MAP_EMPTY ? hash - 1 : hash;
+}
+
+// Interns a string into the pool and returns its offset (0 for NULL/"")
+static uint32_t WGSnapshotInternString(WGSnapshotWriter *writer, const char *string) {
+    if (!string || !*string) {
+        return 0;
+    }
+
+    WGSnapshotBuffer *pool = &writer->columns[WGSnapshotColumnStrings];
+    uint64_t hash = WGSnapshotHashString(string);
+    uint64_t *existing = WGHashMapFind(&writer->stringOffsets, hash);
+    if (existing && strcmp((const char *)pool->data + *existing, string) == 0) {
+        return (uint32_t)*existing;
+    }
+
+    uint32_t offset = (uint32_t)pool->length;
+    if (!WGSnapshotBufferAppend(writer, WGSnapshotColumnStrings, string, strlen(string) + 1)) {
+        return 0;
+    }
+    // On a hash collision the first string keeps the slot
+    if (!existing && !WGHashMapPut(&writer->stringOffsets, hash, offset)) {
+        writer->failed = true;
+    }
+    return offset;
+}
+
+void WGSnapshotWriterInit(WGSnapshotWriter *writer, double createdAt) {
+    memset(writer, 0, sizeof(*writer));
+    writer->createdAt = createdAt;
+    writer->failed = !WGHashMapInit(&writer->stringOffsets, 64);
+
+    // Offset 0 is the empty string
+    char empty = '\0';
+    WGSnapshotBufferAppend(writer, WGSnapshotColumnStrings, &empty, 1);
+}
+
+void WGSnapshotWriterFree(WGSnapshotWriter *writer) {
+    for (int i = 0; i < WGSnapshotColumnCount; i++) {
+        free(writer->columns[i].data);
+    }
+    WGHashMapFree(&writer->stringOffsets);
+    memset(writer, 0, sizeof(*writer));
+}
+
+bool WGSnapshotWriterAddNetwork(WGSnapshotWriter *writer, const WGSnapshotNetwork *network,
+                                const double *sampleTimes, const int8_t *sampleRSSI, size_t sampleCount) {
+    if (sampleCount > UINT16_MAX) {
+        sampleCount = UINT16_MAX;
+    }
+
+    uint32_t ssid = WGSnapshotInternString(writer, network->ssid);
+    uint32_t sampleStart = (uint32_t)writer->sampleCount;
+    uint16_t samples = (uint16_t)sampleCount;
+
+    WG_SNAPSHOT_APPEND(writer, WGSnapshotColumnNetworkBSSID, network->bssid);
+    WG_SNAPSHOT_APPEND(writer, WGSnapshotColumnNetworkLastSeen, network->lastSeen);
+    WG_SNAPSHOT_APPEND(writer, WGSnapshotColumnNetworkSSID, ssid);
+    WG_SNAPSHOT_APPEND(writer, WGSnapshotColumnNetworkChannel, network->channel);
+    WG_SNAPSHOT_APPEND(writer, WGSnapshotColumnNetworkWidth, network->channelWidth);
+    WG_SNAPSHOT_APPEND(writer, WGSnapshotColumnNetworkRSSI, network->rssi);
+    WG_SNAPSHOT_APPEND(writer, WGSnapshotColumnNetworkSecurity, network->security);
+    WG_SNAPSHOT_APPEND(writer, WGSnapshotColumnNetworkFlags, network->flags);
+    WG_SNAPSHOT_APPEND(writer, WGSnapshotColumnNetworkSampleStart, sampleStart);
+    WG_SNAPSHOT_APPEND(writer, WGSnapshotColumnNetworkSampleCount, samples);
+
+    if (sampleCount > 0) {
+        WGSnapshotBufferAppend(writer, WGSnapshotColumnSampleTime, sampleTimes, sampleCount * sizeof(double));
+        WGSnapshotBufferAppend(writer, WGSnapshotColumnSampleRSSI, sampleRSSI, sampleCount);
+    }
+
+    if (writer->failed) {
+        return false;
+    }
+    writer->networkCount++;
+    writer->sampleCount += sampleCount;
+    return true;
+}
+
+bool WGSnapshotWriterAddARPEntry(WGSnapshotWriter *writer, const WGSnapshotARPEntry *entry) {
+    uint32_t interface = WGSnapshotInternString(writer, entry->interface);
+
+    WG_SNAPSHOT_APPEND(writer, WGSnapshotColumnARPMAC, entry->mac);
+    WG_SNAPSHOT_APPEND(writer, WGSnapshotColumnARPIP, entry->ip);
+    WG_SNAPSHOT_APPEND(writer, WGSnapshotColumnARPFlags, entry->flags);
+    WG_SNAPSHOT_APPEND(writer, WGSnapshotColumnARPFirstSeen, entry->firstSeen);
+    WG_SNAPSHOT_APPEND(writer, WGSnapshotColumnARPLastSeen, entry->lastSeen);
+    WG_SNAPSHOT_APPEND(writer, WGSnapshotColumnARPInterface, interface);
+
+    if (writer->failed) {
+        return false;
+    }
+    writer->arpCount++;
+    return true;
+}
+
+bool WGSnapshotWriterAddAnomaly(WGSnapshotWriter *writer, const WGSnapshotAnomaly *anomaly) {
+    uint32_t details = WGSnapshotInternString(writer, anomaly->details);
+
+    WG_SNAPSHOT_APPEND(writer, WGSnapshotColumnAnomalyPreviousMAC, anomaly->previousMAC);
+    WG_SNAPSHOT_APPEND(writer, WGSnapshotColumnAnomalyCurrentMAC, anomaly->currentMAC);
+    WG_SNAPSHOT_APPEND(writer, WGSnapshotColumnAnomalyIP, anomaly->ip);
+    WG_SNAPSHOT_APPEND(writer, WGSnapshotColumnAnomalyType, anomaly->type);
+    WG_SNAPSHOT_APPEND(writer, WGSnapshotColumnAnomalySeverity, anomaly->severity);
+    WG_SNAPSHOT_APPEND(writer, WGSnapshotColumnAnomalyDetectedAt, anomaly->detectedAt);
+    WG_SNAPSHOT_APPEND(writer, WGSnapshotColumnAnomalyDetails, details);
+
+    if (writer->failed) {
+        return false;
+    }
+    writer->anomalyCount++;
+    return true;
+}
+
+static bool WGSnapshotWriteFully(int fd, const void *data, size_t length) {
+    const uint8_t *bytes = data;
+    while (length > 0) {
+        ssize_t n = write(fd, bytes, length);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        bytes += n;
+        length -= (size_t)n;
+    }
+    return true;
+}
+
+WGSnapshotError WGSnapshotWriterWriteFD(const WGSnapshotWriter *writer, int fd) {
+    if (writer->failed) {
+        return WGSnapshotErrorMemory;
+    }
+
+    WGSnapshotHeader header = {0};
+    memcpy(header.magic, WG_SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = WG_SNAPSHOT_VERSION;
+    header.columnCount = WGSnapshotColumnCount;
+    header.createdAt = writer->createdAt;
+
+    WGSnapshotDirectoryEntry directory[WGSnapshotColumnCount];
+    size_t offset = WGSnapshotAlign(sizeof(header) + sizeof(directory));
+    for (int i = 0; i < WGSnapshotColumnCount; i++) {
+        directory[i].column = (uint32_t)i;
+        directory[i].elementSize = kWGSnapshotElementSize[i];
+        directory[i].count = writer->columns[i].length / kWGSnapshotElementSize[i];
+        directory[i].offset = offset;
+        offset = WGSnapshotAlign(offset + writer->columns[i].length);
+    }
+
+    static const uint8_t padding[8] = {0};
+    size_t position = sizeof(header) + sizeof(directory);
+    if (!WGSnapshotWriteFully(fd, &header, sizeof(header)) ||
+        !WGSnapshotWriteFully(fd, directory, sizeof(directory))) {
+        return WGSnapshotErrorIO;
+    }
+
+    for (int i = 0; i < WGSnapshotColumnCount; i++) {
+        if (!WGSnapshotWriteFully(fd, padding, directory[i].offset - position) ||
+            !WGSnapshotWriteFully(fd, writer->columns[i].data, writer->columns[i].length)) {
+            return WGSnapshotErrorIO;
+        }
+        position = directory[i].offset + writer->columns[i].length;
+    }
+    return WGSnapshotErrorNone;
+}
+
+#pragma mark - Reader
+
+// Resolves every known column to a pointer into data; unknown ids are skipped
+static WGSnapshotError WGSnapshotResolve(WGSnapshot *snapshot, const void *columns[WGSnapshotColumnCount],
+                                         size_t counts[WGSnapshotColumnCount]) {
+    WGSnapshotHeader header;
+    if (snapshot->length < sizeof(header)) {
+        return WGSnapshotErrorFormat;
+    }
+    memcpy(&header, snapshot->base, sizeof(header));
+    if (memcmp(header.magic, WG_SNAPSHOT_MAGIC, sizeof(header.magic)) != 0) {
+        return WGSnapshotErrorFormat;
+    }
+    if (header.version > WG_SNAPSHOT_VERSION) {
+        return WGSnapshotErrorVersion;
+    }
+
+    size_t directoryEnd = sizeof(header) + (size_t)header.columnCount * sizeof(WGSnapshotDirectoryEntry);
+    if (directoryEnd > snapshot->length) {
+        return WGSnapshotErrorFormat;
+    }
+
+    for (uint16_t i = 0; i < header.columnCount; i++) {
+        WGSnapshotDirectoryEntry entry;
+        memcpy(&entry, snapshot->base + sizeof(header) + i * sizeof(entry), sizeof(entry));
+        if (entry.column >= WGSnapshotColumnCount) {
+            continue;
+        }
+        if (entry.elementSize != kWGSnapshotElementSize[entry.column] ||
+            entry.offset % 8 != 0 || entry.offset < directoryEnd || entry.offset > snapshot->length ||
+            entry.count > (snapshot->length - entry.offset) / entry.elementSize) {
+            return WGSnapshotErrorFormat;
+        }
+        columns[entry.column] = snapshot->base + entry.offset;
+        counts[entry.column] = (size_t)entry.count;
+    }
+
+    snapshot->version = header.version;
+    snapshot->createdAt = header.createdAt;
+    return WGSnapshotErrorNone;
+}
+
+// Row count of a table: its columns must agree, and all must be present
+static bool WGSnapshotTableCount(const void *columns[], const size_t counts[],
+                                 WGSnapshotColumn first, WGSnapshotColumn last, size_t *count) {
+    *count = counts[first];
+    for (int c = first; c <= (int)last; c++) {
+        if ((*count > 0 && !columns[c]) || counts[c] != *count) {
+            return false;
+        }
+    }
+    return true;
+}
+
+WGSnapshotError WGSnapshotLoad(WGSnapshot *snapshot, const void *data, size_t length) {
+    memset(snapshot, 0, sizeof(*snapshot));
+    snapshot->base = data;
+    snapshot->length = length;
+
+    const void *columns[WGSnapshotColumnCount] = {0};
+    size_t counts[WGSnapshotColumnCount] = {0};
+    WGSnapshotError error = WGSnapshotResolve(snapshot, columns, counts);
+    if (error != WGSnapshotErrorNone) {
+        return error;
+    }
+
+    WGSnapshotNetworks *networks = &snapshot->networks;
+    WGSnapshotSamples *samples = &snapshot->samples;
+    WGSnapshotARPEntries *arp = &snapshot->arp;
+    WGSnapshotAnomalies *anomalies = &snapshot->anomalies;
+    if (!WGSnapshotTableCount(columns, counts, WGSnapshotColumnNetworkBSSID,
+                              WGSnapshotColumnNetworkSampleCount, &networks->count) ||
+        !WGSnapshotTableCount(columns, counts, WGSnapshotColumnSampleTime,
+                              WGSnapshotColumnSampleRSSI, &samples->count) ||
+        !WGSnapshotTableCount(columns, counts, WGSnapshotColumnARPMAC,
+                              WGSnapshotColumnARPInterface, &arp->count) ||
+        !WGSnapshotTableCount(columns, counts, WGSnapshotColumnAnomalyPreviousMAC,
+                              WGSnapshotColumnAnomalyDetails, &anomalies->count)) {
+        return WGSnapshotErrorFormat;
+    }
+
+    // The pool must be NUL-terminated so any in-range offset is a C string
+    snapshot->strings = columns[WGSnapshotColumnStrings];
+    snapshot->stringsLength = counts[WGSnapshotColumnStrings];
+    if (snapshot->stringsLength == 0 || snapshot->strings[snapshot->stringsLength - 1] != '\0') {
+        return WGSnapshotErrorFormat;
+    }
+
+    networks->bssid = columns[WGSnapshotColumnNetworkBSSID];
+    networks->lastSeen = columns[WGSnapshotColumnNetworkLastSeen];
+    networks->ssid = columns[WGSnapshotColumnNetworkSSID];
+    networks->channel = columns[WGSnapshotColumnNetworkChannel];
+    networks->channelWidth = columns[WGSnapshotColumnNetworkWidth];
+    networks->rssi = columns[WGSnapshotColumnNetworkRSSI];
+    networks->security = columns[WGSnapshotColumnNetworkSecurity];
+    networks->flags = columns[WGSnapshotColumnNetworkFlags];
+    networks->sampleStart = columns[WGSnapshotColumnNetworkSampleStart];
+    networks->sampleCount = columns[WGSnapshotColumnNetworkSampleCount];
+
+    samples->time = columns[WGSnapshotColumnSampleTime];
+    samples->rssi = columns[WGSnapshotColumnSampleRSSI];
+
+    arp->mac = columns[WGSnapshotColumnARPMAC];
+    arp->ip = columns[WGSnapshotColumnARPIP];
+    arp->flags = columns[WGSnapshotColumnARPFlags];
+    arp->firstSeen = columns[WGSnapshotColumnARPFirstSeen];
+    arp->lastSeen = columns[WGSnapshotColumnARPLastSeen];
+    arp->interface = columns[WGSnapshotColumnARPInterface];
+
+    anomalies->previousMAC = columns[WGSnapshotColumnAnomalyPreviousMAC];
+    anomalies->currentMAC = columns[WGSnapshotColumnAnomalyCurrentMAC];
+    anomalies->ip = columns[WGSnapshotColumnAnomalyIP];
+    anomalies->type = columns[WGSnapshotColumnAnomalyType];
+    anomalies->severity = columns[WGSnapshotColumnAnomalySeverity];
+    anomalies->detectedAt = columns[WGSnapshotColumnAnomalyDetectedAt];
+    anomalies->details = columns[WGSnapshotColumnAnomalyDetails];
+    return WGSnapshotErrorNone;
+}
+
+WGSnapshotError WGSnapshotOpen(WGSnapshot *snapshot, const char *path) {
+    memset(snapshot, 0, sizeof(*snapshot));
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return WGSnapshotErrorIO;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        close(fd);
+        return WGSnapshotErrorIO;
+    }
+    if (st.st_size == 0) {
+        close(fd);
+        return WGSnapshotErrorFormat;
+    }
+
+    void *base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    int mapError = errno;
+    close(fd);
+    if (base == MAP_FAILED) {
+        errno = mapError;
+        return WGSnapshotErrorIO;
+    }
+
+    WGSnapshotError error = WGSnapshotLoad(snapshot, base, (size_t)st.st_size);
+    if (error != WGSnapshotErrorNone) {
+        munmap(base, (size_t)st.st_size);
+        memset(snapshot, 0, sizeof(*snapshot));
+        return error;
+    }
+    snapshot->mapped = true;
+    return WGSnapshotErrorNone;
+}
+
+void WGSnapshotClose(WGSnapshot *snapshot) {
+    if (snapshot->mapped) {
+        munmap((void *)snapshot->base, snapshot->length);
+    }
+    memset(snapshot, 0, sizeof(*snapshot));
+}
+
+const char *WGSnapshotString(const WGSnapshot *snapshot, uint32_t offset) {
+    return offset < snapshot->stringsLength ? snapshot->strings + offset : "";
+}
+
+size_t WGSnapshotNetworkSamples(const WGSnapshot *snapshot, size_t i,
+                                const double **times, const int8_t **rssi) {
+    size_t start = snapshot->networks.sampleStart[i];
+    size_t count = snapshot->networks.sampleCount[i];
+    if (start > snapshot->samples.count) {
+        start = snapshot->samples.count;
+    }
+    if (count > snapshot->samples.count - start) {
+        count = snapshot->samples.count - start;
+    }
+
+    *times = snapshot->samples.time + start;
+    *rssi = snapshot->samples.rssi + start;
+    return count;
+}
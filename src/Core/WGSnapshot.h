@@ -0,0 +1,228 @@
+/*
+ * WGSnapshot.h - Binary Columnar Snapshot Format
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * Versioned, little-endian capture of scan results, ARP entries and
+ * anomalies. Each field is stored as its own column (a packed array), so
+ * a reader mmaps the file, checks the directory and then indexes straight
+ * into the mapping - nothing is parsed or copied per record.
+ *
+ * Layout (all offsets from file start, every column 8-byte aligned):
+ *
+ *   header     magic "WGSNAPv1", version, columnCount, createdAt
+ *   directory  columnCount x { id, elementSize, count, offset }
+ *   columns    raw arrays in host (little-endian) order
+ *
+ * Strings (SSIDs, interface names, details) live in one NUL-separated
+ * pool column and are referenced by uint32 offset; offset 0 is "".
+ * Readers skip column ids they do not know, so columns can be added
+ * without bumping the version.
+ */
+
+#ifndef WG_SNAPSHOT_H
+#define WG_SNAPSHOT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "WGHashMap.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "WGSnapshot maps columns in place and requires a little-endian host"
+#endif
+
+#define WG_SNAPSHOT_MAGIC   "WGSNAPv1"
+#define WG_SNAPSHOT_VERSION 1
+
+typedef enum {
+    WGSnapshotErrorNone = 0,
+    WGSnapshotErrorIO,          // open/mmap/write failed (see errno)
+    WGSnapshotErrorFormat,      // Bad magic, truncated or inconsistent directory
+    WGSnapshotErrorVersion,     // Written by a newer, incompatible version
+    WGSnapshotErrorMemory
+} WGSnapshotError;
+
+typedef enum {
+    WGSnapshotSecurityUnknown = 0,
+    WGSnapshotSecurityOpen,
+    WGSnapshotSecurityWEP,
+    WGSnapshotSecurityWPA,
+    WGSnapshotSecurityWPA2,
+    WGSnapshotSecurityWPA3
+} WGSnapshotSecurity;
+
+enum {
+    WGSnapshotNetworkFlagHidden = 1 << 0
+};
+
+// Row-form inputs for the writer
+typedef struct {
+    uint64_t bssid;             // Packed MAC, first octet in bits 40-47
+    double lastSeen;            // Seconds since 1970
+    const char *ssid;           // UTF-8, NULL for hidden
+    uint16_t channel;
+    uint16_t channelWidth;      // MHz
+    int8_t rssi;                // dBm
+    uint8_t security;           // WGSnapshotSecurity
+    uint8_t flags;              // WGSnapshotNetworkFlag*
+} WGSnapshotNetwork;
+
+typedef struct {
+    uint64_t mac;
+    uint32_t ip;                // Host byte order
+    uint16_t flags;             // WGARPRecordFlag*
+    double firstSeen;
+    double lastSeen;
+    const char *interface;
+} WGSnapshotARPEntry;
+
+typedef struct {
+    uint64_t previousMAC;
+    uint64_t currentMAC;
+    uint32_t ip;
+    uint8_t type;               // WGARPAnomalyType
+    uint8_t severity;           // 1-10
+    double detectedAt;
+    const char *details;
+} WGSnapshotAnomaly;
+
+// Growable column used by the writer
+typedef struct {
+    uint8_t *data;
+    size_t length;
+    size_t capacity;
+} WGSnapshotBuffer;
+
+typedef enum {
+    // Networks
+    WGSnapshotColumnNetworkBSSID = 0,
+    WGSnapshotColumnNetworkLastSeen,
+    WGSnapshotColumnNetworkSSID,
+    WGSnapshotColumnNetworkChannel,
+    WGSnapshotColumnNetworkWidth,
+    WGSnapshotColumnNetworkRSSI,
+    WGSnapshotColumnNetworkSecurity,
+    WGSnapshotColumnNetworkFlags,
+    WGSnapshotColumnNetworkSampleStart,
+    WGSnapshotColumnNetworkSampleCount,
+    // RSSI series, indexed by the two columns above
+    WGSnapshotColumnSampleTime,
+    WGSnapshotColumnSampleRSSI,
+    // ARP entries
+    WGSnapshotColumnARPMAC,
+    WGSnapshotColumnARPIP,
+    WGSnapshotColumnARPFlags,
+    WGSnapshotColumnARPFirstSeen,
+    WGSnapshotColumnARPLastSeen,
+    WGSnapshotColumnARPInterface,
+    // Anomalies
+    WGSnapshotColumnAnomalyPreviousMAC,
+    WGSnapshotColumnAnomalyCurrentMAC,
+    WGSnapshotColumnAnomalyIP,
+    WGSnapshotColumnAnomalyType,
+    WGSnapshotColumnAnomalySeverity,
+    WGSnapshotColumnAnomalyDetectedAt,
+    WGSnapshotColumnAnomalyDetails,
+    // Shared
+    WGSnapshotColumnStrings,
+    WGSnapshotColumnCount
+} WGSnapshotColumn;
+
+typedef struct {
+    WGSnapshotBuffer columns[WGSnapshotColumnCount];
+    WGHashMap stringOffsets;    // FNV-1a hash -> pool offset, for interning
+    size_t networkCount;
+    size_t sampleCount;
+    size_t arpCount;
+    size_t anomalyCount;
+    double createdAt;
+    bool failed;                // Sticky allocation failure
+} WGSnapshotWriter;
+
+// Read-side views - every pointer aims into the mapping
+typedef struct {
+    size_t count;
+    const uint64_t *bssid;
+    const double *lastSeen;
+    const uint32_t *ssid;       // String offsets
+    const uint16_t *channel;
+    const uint16_t *channelWidth;
+    const int8_t *rssi;
+    const uint8_t *security;
+    const uint8_t *flags;
+    const uint32_t *sampleStart;
+    const uint16_t *sampleCount;
+} WGSnapshotNetworks;
+
+typedef struct {
+    size_t count;
+    const double *time;
+    const int8_t *rssi;
+} WGSnapshotSamples;
+
+typedef struct {
+    size_t count;
+    const uint64_t *mac;
+    const uint32_t *ip;
+    const uint16_t *flags;
+    const double *firstSeen;
+    const double *lastSeen;
+    const uint32_t *interface;  // String offsets
+} WGSnapshotARPEntries;
+
+typedef struct {
+    size_t count;
+    const uint64_t *previousMAC;
+    const uint64_t *currentMAC;
+    const uint32_t *ip;
+    const uint8_t *type;
+    const uint8_t *severity;
+    const double *detectedAt;
+    const uint32_t *details;    // String offsets
+} WGSnapshotAnomalies;
+
+typedef struct {
+    const uint8_t *base;
+    size_t length;
+    bool mapped;                // Unmapped by WGSnapshotClose
+    uint32_t version;
+    double createdAt;
+    WGSnapshotNetworks networks;
+    WGSnapshotSamples samples;
+    WGSnapshotARPEntries arp;
+    WGSnapshotAnomalies anomalies;
+    const char *strings;
+    size_t stringsLength;
+} WGSnapshot;
+
+// Writer - rows are appended column by column; WriteFD emits the file
+void WGSnapshotWriterInit(WGSnapshotWriter *writer, double createdAt);
+void WGSnapshotWriterFree(WGSnapshotWriter *writer);
+bool WGSnapshotWriterAddNetwork(WGSnapshotWriter *writer, const WGSnapshotNetwork *network,
+                                const double *sampleTimes, const int8_t *sampleRSSI, size_t sampleCount);
+bool WGSnapshotWriterAddARPEntry(WGSnapshotWriter *writer, const WGSnapshotARPEntry *entry);
+bool WGSnapshotWriterAddAnomaly(WGSnapshotWriter *writer, const WGSnapshotAnomaly *anomaly);
+WGSnapshotError WGSnapshotWriterWriteFD(const WGSnapshotWriter *writer, int fd);
+
+// Reader - Open maps a file read-only; Load validates a caller-owned buffer
+WGSnapshotError WGSnapshotOpen(WGSnapshot *snapshot, const char *path);
+WGSnapshotError WGSnapshotLoad(WGSnapshot *snapshot, const void *data, size_t length);
+void WGSnapshotClose(WGSnapshot *snapshot);
+
+// String pool lookup; out-of-range offsets read as ""
+const char *WGSnapshotString(const WGSnapshot *snapshot, uint32_t offset);
+
+// RSSI series of network i (clamped to the sample columns); returns count
+size_t WGSnapshotNetworkSamples(const WGSnapshot *snapshot, size_t i,
+                                const double **times, const int8_t **rssi);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WG_SNAPSHOT_H */
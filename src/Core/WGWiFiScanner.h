@@ -6,24 +6,44 @@
  */
 
 #import <Foundation/Foundation.h>
+#import "WGAddress.h"
+#import "WGChannelAggregate.h"
+#import "WGScanIngest.h"
+#import "WGScanSource.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
 @class WGAuditLogger;
 
+#define WG_RSSI_HISTORY_CAPACITY WG_SCAN_HISTORY_CAPACITY
+
 // Wi-Fi Network Information Structure
 @interface WGNetworkInfo : NSObject
 
 @property (nonatomic, copy) NSString *ssid;
 @property (nonatomic, copy) NSString *bssid;
+@property (nonatomic, readonly) WGMACAddress bssidValue; // Packed bssid, 0 if malformed
+@property (nonatomic, readonly) WGVendorID vendorID;    // From the OUI database, WG_OUI_UNKNOWN if not in it
+@property (nonatomic, readonly, nullable) NSString *vendor; // Registered name of vendorID
 @property (nonatomic, assign) NSInteger channel;
 @property (nonatomic, assign) NSInteger rssi;
 @property (nonatomic, assign) NSInteger channelWidth; // 20, 40, 80, 160 MHz
+@property (nonatomic, assign) WGChannelBand band; // From the scan record, else inferred from channel
 @property (nonatomic, copy) NSString *securityType; // WPA2, WPA3, WEP, Open
 @property (nonatomic, assign) BOOL isHidden;
 @property (nonatomic, strong) NSDate *lastSeen;
-@property (nonatomic, strong) NSMutableArray<NSNumber *> *rssiHistory;
-@property (nonatomic, strong) NSMutableArray<NSDate *> *rssiTimestamps;
+@property (nonatomic, readonly) NSArray<NSNumber *> *rssiHistory;   // Copy-on-read view
+@property (nonatomic, readonly) NSArray<NSDate *> *rssiTimestamps;  // Copy-on-read view
+@property (nonatomic, readonly) NSUInteger rssiSampleCount;
+@property (nonatomic, readonly) CGFloat smoothedRSSI;   // Kalman estimate from the scan ingest, dBm
+@property (nonatomic, readonly) CGFloat rssiVariance;   // Exponentially weighted, dB²
+@property (nonatomic, readonly) CGFloat stepScore;      // z-score of the latest sample against the smoothed signal
+
+// RSSI history (last WG_RSSI_HISTORY_CAPACITY samples, oldest first)
+- (void)addRSSISample:(NSInteger)rssi;
+- (NSUInteger)getRSSISamples:(WGRSSISample *)samples maxCount:(NSUInteger)maxCount;
+- (void)clearRSSIHistory;
+- (void)setRSSISamples:(const WGRSSISample *)samples count:(NSUInteger)count; // Restores saved history
 
 - (NSDictionary *)toDictionary;
 + (instancetype)networkFromDictionary:(NSDictionary *)dict;
@@ -34,18 +54,62 @@ NS_ASSUME_NONNULL_BEGIN
 @interface WGChannelStats : NSObject
 
 @property (nonatomic, assign) NSInteger channel;
-@property (nonatomic, assign) NSInteger networkCount;
+@property (nonatomic, assign) WGChannelBand band;
+@property (nonatomic, assign) NSInteger networkCount;  // Primary channel here
+@property (nonatomic, assign) NSInteger overlapCount;  // Wider networks on neighbouring channels
 @property (nonatomic, assign) CGFloat averageRSSI;
 @property (nonatomic, assign) NSInteger congestionLevel; // 0-100
 
 @end
 
-// Scan Result Delegate
+// Networks changed since the previous delivery (BSSID strings)
+@interface WGNetworkChanges : NSObject
+
+@property (nonatomic, readonly) NSArray<NSString *> *inserted;
+@property (nonatomic, readonly) NSArray<NSString *> *updated;
+@property (nonatomic, readonly) NSArray<NSString *> *removed;
+@property (nonatomic, readonly) uint64_t version;   // Scanner table version they bring you to
+
+@end
+
+// Wi-Fi Anomaly Types
+typedef NS_ENUM(NSInteger, WGNetworkAnomalyType) {
+    WGNetworkAnomalyTypeNone = 0,
+    WGNetworkAnomalyTypeSignalStep,     // RSSI jumped away from a steady BSSID (possible impostor AP)
+    WGNetworkAnomalyTypeEvilTwin,       // Known SSID from a new BSSID of a vendor never seen with it
+    WGNetworkAnomalyTypeSecurityDowngrade // Known SSID with weaker security from a new BSSID or channel
+};
+
+// Wi-Fi Anomaly Alert
+@interface WGNetworkAnomaly : NSObject
+
+@property (nonatomic, assign) WGNetworkAnomalyType type;
+@property (nonatomic, copy) NSString *bssid;
+@property (nonatomic, copy, nullable) NSString *ssid;
+@property (nonatomic, assign) NSInteger channel;
+@property (nonatomic, copy, nullable) NSString *securityType;       // As advertised by bssid
+@property (nonatomic, copy, nullable) NSString *knownSecurityType;  // Strongest the SSID is known for
+@property (nonatomic, copy, nullable) NSString *vendor;             // Of bssid, from the OUI database
+@property (nonatomic, assign) NSInteger previousRSSI;   // Smoothed signal before the step
+@property (nonatomic, assign) NSInteger currentRSSI;
+@property (nonatomic, assign) CGFloat score;            // z-score
+@property (nonatomic, copy) NSString *details;
+@property (nonatomic, assign) NSInteger severity; // 1-10
+@property (nonatomic, strong) NSDate *detectedAt;
+
+- (NSDictionary *)toDictionary;
+- (NSString *)localizedDescription;
+
+@end
+
+// Scan Result Delegate - called on the main thread, at most once per display refresh
 @protocol WGWiFiScannerDelegate <NSObject>
 @optional
-- (void)wifiScanner:(id)scanner didFindNetworks:(NSArray<WGNetworkInfo *> *)networks;
+- (void)wifiScanner:(id)scanner didChangeNetworks:(WGNetworkChanges *)changes;
+- (void)wifiScanner:(id)scanner didFindNetworks:(NSArray<WGNetworkInfo *> *)networks; // Only if didChangeNetworks: is not implemented
 - (void)wifiScanner:(id)scanner didUpdateNetwork:(WGNetworkInfo *)network;
 - (void)wifiScanner:(id)scanner didEncounterError:(NSError *)error;
+- (void)wifiScanner:(id)scanner didDetectAnomaly:(WGNetworkAnomaly *)anomaly;
 - (void)wifiScannerDidStartScanning:(id)scanner;
 - (void)wifiScannerDidStopScanning:(id)scanner;
 @end
@@ -55,15 +119,22 @@ NS_ASSUME_NONNULL_BEGIN
 
 @property (nonatomic, weak, nullable) id<WGWiFiScannerDelegate> delegate;
 @property (nonatomic, readonly) BOOL isScanning;
-@property (nonatomic, readonly) NSArray<WGNetworkInfo *> *discoveredNetworks;
+@property (nonatomic, readonly) NSArray<WGNetworkInfo *> *discoveredNetworks; // Main thread: live objects; elsewhere: snapshot copies
 @property (nonatomic, readonly) NSArray<WGChannelStats *> *channelStatistics;
-@property (nonatomic, assign) NSTimeInterval scanInterval; // Default 5 seconds
+@property (nonatomic, assign) NSTimeInterval scanInterval; // Default 5 seconds - base interval, after any new network
+@property (nonatomic, assign) BOOL adaptiveScheduling;     // Default YES - back off while no new BSSIDs appear
+@property (nonatomic, assign) double cpuBudget;            // Default 0.01 - max share of one core spent requesting scans
+@property (nonatomic, assign) NSUInteger maxScansPerMinute; // Default 20 - radio wake-up cap, 0 disables
+@property (nonatomic, strong) id<WGScanSource> scanSource; // Default MobileWiFi; replacing it restarts a running scan
+@property (nonatomic, assign) double signalStepThreshold;  // Default 4 - RSSI z-score flagged as a step, 0 disables
+@property (nonatomic, readonly) NSArray<WGNetworkAnomaly *> *detectedAnomalies; // Most recent last, bounded
 
 // Singleton
 + (instancetype)sharedInstance;
 
 // Initialization
 - (instancetype)initWithAuditLogger:(WGAuditLogger *)logger;
+- (instancetype)initWithAuditLogger:(WGAuditLogger *)logger scanSource:(id<WGScanSource>)source;
 
 // Scanning Control
 - (BOOL)startScanning;
@@ -75,9 +146,16 @@ NS_ASSUME_NONNULL_BEGIN
 - (NSArray<WGNetworkInfo *> *)networksOnChannel:(NSInteger)channel;
 - (NSArray<WGNetworkInfo *> *)networksWithSecurityType:(NSString *)type;
 - (NSArray<WGNetworkInfo *> *)hiddenNetworks;
+- (NSArray<WGNetworkInfo *> *)networksWithSSID:(NSString *)ssid; // From the ingest's SSID index
+// Combined filters (channel 0 = any), served from per-channel, per-security
+// and hidden posting lists maintained as scans are delivered
+- (NSArray<WGNetworkInfo *> *)networksMatchingChannel:(NSInteger)channel
+                                         securityType:(nullable NSString *)type
+                                           hiddenOnly:(BOOL)hiddenOnly;
 
 // Statistics
-- (WGChannelStats *)statsForChannel:(NSInteger)channel;
+- (nullable WGChannelStats *)statsForChannel:(NSInteger)channel; // Band inferred from channel
+- (nullable WGChannelStats *)statsForChannel:(NSInteger)channel band:(WGChannelBand)band;
 
 // Diagnostics
 - (NSString *)diagnosticStatus;
@@ -87,10 +165,17 @@ NS_ASSUME_NONNULL_BEGIN
 
 // Cache Management
 - (void)clearCache;
+- (void)clearAnomalyHistory;
 - (void)clearRSSIHistory;
 
 // Export
 - (NSArray<NSDictionary *> *)exportData;
+- (NSArray<WGNetworkInfo *> *)exportNetworks; // Detached snapshot copies on any thread, RSSI descending
+
+// Metrics - scan.* stage latencies (callback, parse, merge, deliver,
+// channels) and counters; see WGMetricsReport(). "schedule" holds the scan
+// task's runs, duty cycle and current interval.
+- (NSDictionary<NSString *, NSDictionary *> *)metricsSnapshot;
 
 @end
 
@@ -3,109 +3,38 @@
  * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
  * 
  * PASSIVE SCANNING ONLY - No active attacks implemented
- * Uses MobileWiFi.framework private APIs for scanning
+ * Scan results come from a WGScanSource (MobileWiFi by default)
  */
 
 #import "WGWiFiScanner.h"
 #import "WGAuditLogger.h"
+#import "WGMobileWiFiScanSource.h"
 #import "WGNetworkUtils.h"
-#import <dlfcn.h>
-
-// MobileWiFi.framework Private API Declarations
-// RISK: These APIs are undocumented and may change between iOS versions
-// Compatibility: Tested on iOS 16.0-16.2
-typedef struct __WiFiManager *WiFiManagerRef;
-typedef struct __WiFiNetwork *WiFiNetworkRef;
-typedef struct __WiFiDevice *WiFiDeviceRef;
-
-// Function pointer types
-typedef WiFiManagerRef (*WiFiManagerClientCreate_t)(CFAllocatorRef, int);
-typedef CFArrayRef (*WiFiManagerClientCopyDevices_t)(WiFiManagerRef);
-typedef CFArrayRef (*WiFiDeviceClientCopyCurrentNetwork_t)(WiFiDeviceRef);
-typedef int (*WiFiDeviceClientGetPower_t)(WiFiDeviceRef);
-typedef void (*WiFiDeviceClientScanAsync_t)(WiFiDeviceRef, CFDictionaryRef, void (^)(CFArrayRef, int), int);
-typedef CFStringRef (*WiFiNetworkGetSSID_t)(WiFiNetworkRef);
-typedef CFStringRef (*WiFiNetworkGetBSSID_t)(WiFiNetworkRef);
-typedef CFNumberRef (*WiFiNetworkGetRSSI_t)(WiFiNetworkRef);
-typedef CFNumberRef (*WiFiNetworkGetChannel_t)(WiFiNetworkRef);
-typedef Boolean (*WiFiNetworkIsHidden_t)(WiFiNetworkRef);
-typedef CFDictionaryRef (*WiFiNetworkCopyRecord_t)(WiFiNetworkRef);
-
-// Function pointers (loaded dynamically)
-static WiFiManagerClientCreate_t WiFiManagerClientCreate = NULL;
-static WiFiManagerClientCopyDevices_t WiFiManagerClientCopyDevices = NULL;
-static WiFiDeviceClientCopyCurrentNetwork_t WiFiDeviceClientCopyCurrentNetwork = NULL;
-static WiFiDeviceClientGetPower_t WiFiDeviceClientGetPower = NULL;
-static WiFiDeviceClientScanAsync_t WiFiDeviceClientScanAsync = NULL;
-static WiFiNetworkGetSSID_t WiFiNetworkGetSSID = NULL;
-static WiFiNetworkGetBSSID_t WiFiNetworkGetBSSID = NULL;
-static WiFiNetworkGetRSSI_t WiFiNetworkGetRSSI = NULL;
-static WiFiNetworkGetChannel_t WiFiNetworkGetChannel = NULL;
-static WiFiNetworkIsHidden_t WiFiNetworkIsHidden = NULL;
-static WiFiNetworkCopyRecord_t WiFiNetworkCopyRecord = NULL;
-
-// Load MobileWiFi functions dynamically
-static BOOL gMobileWiFiLoaded = NO;
-static NSString *gLoadError = nil;
-
-static void LoadMobileWiFiFunctions(void) {
-    static dispatch_once_t onceToken;
-    dispatch_once(&onceToken, ^{
-        // Try loading MobileWiFi.framework
-        void *handle = dlopen("/System/Library/PrivateFrameworks/MobileWiFi.framework/MobileWiFi", RTLD_LAZY);
-        if (!handle) {
-            gLoadError = [NSString stringWithFormat:@"dlopen failed: %s", dlerror()];
-            NSLog(@"[WiFiGuard] %@", gLoadError);
-            gMobileWiFiLoaded = NO;
-            return;
-        }
-        
-        WiFiManagerClientCreate = (WiFiManagerClientCreate_t)dlsym(handle, "WiFiManagerClientCreate");
-        WiFiManagerClientCopyDevices = (WiFiManagerClientCopyDevices_t)dlsym(handle, "WiFiManagerClientCopyDevices");
-        WiFiDeviceClientCopyCurrentNetwork = (WiFiDeviceClientCopyCurrentNetwork_t)dlsym(handle, "WiFiDeviceClientCopyCurrentNetwork");
-        WiFiDeviceClientGetPower = (WiFiDeviceClientGetPower_t)dlsym(handle, "WiFiDeviceClientGetPower");
-        WiFiDeviceClientScanAsync = (WiFiDeviceClientScanAsync_t)dlsym(handle, "WiFiDeviceClientScanAsync");
-        WiFiNetworkGetSSID = (WiFiNetworkGetSSID_t)dlsym(handle, "WiFiNetworkGetSSID");
-        WiFiNetworkGetBSSID = (WiFiNetworkGetBSSID_t)dlsym(handle, "WiFiNetworkGetBSSID");
-        WiFiNetworkGetRSSI = (WiFiNetworkGetRSSI_t)dlsym(handle, "WiFiNetworkGetRSSI");
-        WiFiNetworkGetChannel = (WiFiNetworkGetChannel_t)dlsym(handle, "WiFiNetworkGetChannel");
-        WiFiNetworkIsHidden = (WiFiNetworkIsHidden_t)dlsym(handle, "WiFiNetworkIsHidden");
-        WiFiNetworkCopyRecord = (WiFiNetworkCopyRecord_t)dlsym(handle, "WiFiNetworkCopyRecord");
-        
-        // Log which functions loaded
-        NSLog(@"[WiFiGuard] WiFiManagerClientCreate: %@", WiFiManagerClientCreate ? @"✓" : @"✗");
-        NSLog(@"[WiFiGuard] WiFiManagerClientCopyDevices: %@", WiFiManagerClientCopyDevices ? @"✓" : @"✗");
-        NSLog(@"[WiFiGuard] WiFiDeviceClientScanAsync: %@", WiFiDeviceClientScanAsync ? @"✓" : @"✗");
-        NSLog(@"[WiFiGuard] WiFiDeviceClientGetPower: %@", WiFiDeviceClientGetPower ? @"✓" : @"✗");
-        
-        // Verify critical functions loaded
-        gMobileWiFiLoaded = (WiFiManagerClientCreate != NULL && 
-                            WiFiManagerClientCopyDevices != NULL);
-        
-        if (!gMobileWiFiLoaded) {
-            gLoadError = @"Critical functions not found";
-            NSLog(@"[WiFiGuard] Some MobileWiFi functions failed to load");
-        } else {
-            gLoadError = nil;
-            NSLog(@"[WiFiGuard] MobileWiFi.framework loaded successfully");
-        }
-    });
-}
-
-static BOOL IsMobileWiFiAvailable(void) {
-    LoadMobileWiFiFunctions();
-    return gMobileWiFiLoaded;
-}
+#import "WGRing.h"
+#import "WGAddressMap.h"
+#import "WGRecordIndex.h"
+#import "WGMetricsReport.h"
+#import "WGMonitorScheduler.h"
 
 #pragma mark - WGNetworkInfo Implementation
 
-@implementation WGNetworkInfo
+@interface WGNetworkInfo ()
+@property (nonatomic, assign) uint64_t sampleSeq;   // Last ingest sample mirrored into the history
+@property (nonatomic, assign) CGFloat smoothedRSSI;
+@property (nonatomic, assign) CGFloat rssiVariance;
+@property (nonatomic, assign) CGFloat stepScore;
+- (void)applyRecord:(const WGScanRecord *)record;
+- (void)appendRSSISamples:(const WGRSSISample *)samples count:(NSUInteger)count;
+@end
+
+@implementation WGNetworkInfo {
+    WGRing _rssiSamples;    // WGRSSISample
+}
 
 - (instancetype)init {
     self = [super init];
     if (self) {
-        _rssiHistory = [NSMutableArray array];
-        _rssiTimestamps = [NSMutableArray array];
+        WGRingInit(&_rssiSamples, sizeof(WGRSSISample), WG_RSSI_HISTORY_CAPACITY);
         _lastSeen = [NSDate date];
         _channelWidth = 20;
         _securityType = @"Unknown";
@@ -113,18 +42,93 @@ static BOOL IsMobileWiFiAvailable(void) {
     return self;
 }
 
+- (void)dealloc {
+    WGRingFree(&_rssiSamples);
+}
+
+- (void)setBssid:(NSString *)bssid {
+    _bssid = [bssid copy];
+    _bssidValue = WGMACFromString(bssid);
+    _vendorID = [WGNetworkUtils vendorIDForMAC:_bssidValue];
+}
+
+- (NSString *)vendor {
+    return [WGNetworkUtils vendorNameForID:self.vendorID];
+}
+
+- (void)setChannel:(NSInteger)channel {
+    _channel = channel;
+    _band = WGChannelBandForChannel(channel);
+}
+
 - (void)addRSSISample:(NSInteger)rssi {
-    [self.rssiHistory addObject:@(rssi)];
-    [self.rssiTimestamps addObject:[NSDate date]];
-    
-    // Keep only last 100 samples
-    if (self.rssiHistory.count > 100) {
-        [self.rssiHistory removeObjectAtIndex:0];
-        [self.rssiTimestamps removeObjectAtIndex:0];
-    }
+    NSDate *now = [NSDate date];
+    WGRSSISample sample = {
+        .timestamp = now.timeIntervalSince1970,
+        .rssi = (int8_t)MAX(INT8_MIN, MIN(INT8_MAX, rssi))
+    };
+    WGRingPush(&_rssiSamples, &sample, NULL);
     
     self.rssi = rssi;
-    self.lastSeen = [NSDate date];
+    self.lastSeen = now;
+}
+
+- (NSUInteger)rssiSampleCount {
+    return WGRingCount(&_rssiSamples);
+}
+
+- (NSUInteger)getRSSISamples:(WGRSSISample *)samples maxCount:(NSUInteger)maxCount {
+    return WGRingCopyOut(&_rssiSamples, samples, maxCount);
+}
+
+- (void)clearRSSIHistory {
+    WGRingClear(&_rssiSamples);
+}
+
+- (void)setRSSISamples:(const WGRSSISample *)samples count:(NSUInteger)count {
+    WGRingClear(&_rssiSamples);
+    [self appendRSSISamples:samples count:count];
+}
+
+- (void)appendRSSISamples:(const WGRSSISample *)samples count:(NSUInteger)count {
+    for (NSUInteger i = 0; i < count; i++) {
+        WGRingPush(&_rssiSamples, &samples[i], NULL);
+    }
+}
+
+- (void)applyRecord:(const WGScanRecord *)record {
+    self.ssid = record->ssidLength ?
+        [[NSString alloc] initWithBytes:record->ssid length:record->ssidLength encoding:NSUTF8StringEncoding] : nil;
+    if (self.bssidValue != record->bssid) {
+        self.bssid = WGStringFromMAC(record->bssid);
+    }
+    self.channel = record->channel;
+    self.band = (WGChannelBand)record->band;
+    self.rssi = record->rssi;
+    self.channelWidth = record->channelWidth;
+    self.securityType = [NSString stringWithUTF8String:record->security] ?: @"Unknown";
+    self.isHidden = (record->flags & WGScanRecordFlagHidden) != 0;
+    self.lastSeen = [NSDate dateWithTimeIntervalSince1970:record->lastSeen];
+    self.smoothedRSSI = record->smoothedRSSI;
+    self.rssiVariance = record->rssiVariance;
+    self.stepScore = record->stepScore;
+}
+
+- (NSArray<NSNumber *> *)rssiHistory {
+    NSMutableArray<NSNumber *> *history = [NSMutableArray arrayWithCapacity:_rssiSamples.count];
+    for (size_t i = 0; i < _rssiSamples.count; i++) {
+        [history addObject:@(((const WGRSSISample *)WGRingAt(&_rssiSamples, i))->rssi)];
+    }
+    return history;
+}
+
+- (NSArray<NSDate *> *)rssiTimestamps {
+    NSMutableArray<NSDate *> *timestamps = [NSMutableArray arrayWithCapacity:_rssiSamples.count];
+    for (size_t i = 0; i < _rssiSamples.count; i++) {
+        double timestamp = ((const WGRSSISample *)WGRingAt(&_rssiSamples, i))->timestamp;
+        [timestamps addObject:[NSDate dateWithTimeIntervalSince1970:timestamp]];
+    }
+    return timestamps;
 }
 
 - (NSDictionary *)toDictionary {
@@ -137,10 +141,12 @@ static BOOL IsMobileWiFiAvailable(void) {
         @"channel": @(self.channel),
         @"rssi": @(self.rssi),
         @"channelWidth": @(self.channelWidth),
+        @"band": @(self.band),
         @"securityType": self.securityType ?: @"Unknown",
+        @"vendor": self.vendor ?: @"",
         @"isHidden": @(self.isHidden),
         @"lastSeen": [formatter stringFromDate:self.lastSeen],
-        @"rssiHistory": [self.rssiHistory copy],
+        @"rssiHistory": self.rssiHistory,
         @"rssiTimestamps": [self.rssiTimestamps valueForKey:@"description"]
     };
 }
@@ -152,6 +158,9 @@ static BOOL IsMobileWiFiAvailable(void) {
     network.channel = [dict[@"channel"] integerValue];
     network.rssi = [dict[@"rssi"] integerValue];
     network.channelWidth = [dict[@"channelWidth"] integerValue];
+    if (dict[@"band"]) {
+        network.band = (WGChannelBand)[dict[@"band"] integerValue];
+    }
     network.securityType = dict[@"securityType"];
     network.isHidden = [dict[@"isHidden"] boolValue];
     return network;
@@ -182,17 +191,137 @@ static BOOL IsMobileWiFiAvailable(void) {
 
 @end
 
+#pragma mark - WGNetworkChanges Implementation
+
+@implementation WGNetworkChanges
+
+- (instancetype)initWithInserted:(NSArray<NSString *> *)inserted
+                         updated:(NSArray<NSString *> *)updated
+                         removed:(NSArray<NSString *> *)removed
+                         version:(uint64_t)version {
+    self = [super init];
+    if (self) {
+        _inserted = [inserted copy];
+        _updated = [updated copy];
+        _removed = [removed copy];
+        _version = version;
+    }
+    return self;
+}
+
+@end
+
+#pragma mark - WGNetworkAnomaly Implementation
+
+@implementation WGNetworkAnomaly
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _detectedAt = [NSDate date];
+        _severity = 5;
+    }
+    return self;
+}
+
+- (NSString *)typeString {
+    switch (self.type) {
+        case WGNetworkAnomalyTypeSignalStep:
+            return @"SIGNAL_STEP";
+        case WGNetworkAnomalyTypeEvilTwin:
+            return @"EVIL_TWIN";
+        case WGNetworkAnomalyTypeSecurityDowngrade:
+            return @"SECURITY_DOWNGRADE";
+        default:
+            return @"NONE";
+    }
+}
+
+- (NSDictionary *)toDictionary {
+    NSDateFormatter *formatter = [[NSDateFormatter alloc] init];
+    formatter.dateFormat = @"yyyy-MM-dd HH:mm:ss";
+    
+    return @{
+        @"type": @(self.type),
+        @"typeName": [self typeString],
+        @"bssid": self.bssid ?: @"",
+        @"ssid": self.ssid ?: @"",
+        @"channel": @(self.channel),
+        @"securityType": self.securityType ?: @"",
+        @"knownSecurityType": self.knownSecurityType ?: @"",
+        @"vendor": self.vendor ?: @"",
+        @"previousRSSI": @(self.previousRSSI),
+        @"currentRSSI": @(self.currentRSSI),
+        @"score": @(self.score),
+        @"details": self.details ?: @"",
+        @"severity": @(self.severity),
+        @"detectedAt": [formatter stringFromDate:self.detectedAt]
+    };
+}
+
+- (NSString *)localizedDescription {
+    switch (self.type) {
+        case WGNetworkAnomalyTypeSignalStep:
+            return [NSString stringWithFormat:@"⚠️ Signal of %@ (%@) jumped from %ld to %ld dBm (%.1fσ) - possible impostor AP",
+                    self.ssid ?: @"<Hidden>", self.bssid, (long)self.previousRSSI, (long)self.currentRSSI, self.score];
+        case WGNetworkAnomalyTypeEvilTwin:
+            if (self.vendor) {
+                return [NSString stringWithFormat:@"⚠️ Possible evil twin of %@: new BSSID %@ (Ch:%ld) from %@, a vendor never seen with it",
+                        self.ssid, self.bssid, (long)self.channel, self.vendor];
+            }
+            return [NSString stringWithFormat:@"⚠️ Possible evil twin of %@: new BSSID %@ (Ch:%ld) from an unfamiliar vendor",
+                    self.ssid, self.bssid, (long)self.channel];
+        case WGNetworkAnomalyTypeSecurityDowngrade:
+            return [NSString stringWithFormat:@"🚨 %@ seen as %@ (known as %@) from %@ on Ch:%ld - possible rogue AP!",
+                    self.ssid, self.securityType, self.knownSecurityType, self.bssid, (long)self.channel];
+        default:
+            return @"Unknown anomaly detected";
+    }
+}
+
+@end
+
 #pragma mark - WGWiFiScanner Implementation
 
-@interface WGWiFiScanner ()
+// Coalesced delivery at most this often (display refresh)
+static const NSTimeInterval kWGDeliveryInterval = 1.0 / 60.0;
+
+// Wi-Fi anomalies kept in detectedAnomalies
+static const NSUInteger kWGAnomalyHistoryLimit = 100;
+
+// Key dimensions of the network filter postings
+typedef NS_ENUM(uint8_t, WGNetworkKey) {
+    WGNetworkKeyChannel = 0,
+    WGNetworkKeySecurity,       // Security name packed into the key (<= 7 bytes)
+    WGNetworkKeyHidden
+};
+
+// Packs a security name ("WPA2", "Open"...) into a key value; false if it
+// is too long to be one a scan record can carry
+static bool WGNetworkSecurityKey(const char *security, uint64_t *key) {
+    uint64_t value = 0;
+    size_t length = security ? strlen(security) : 0;
+    if (length > 7) {
+        return false;
+    }
+    memcpy(&value, security, length);
+    *key = WGRecordKey(WGNetworkKeySecurity, value);
+    return true;
+}
+
+@interface WGWiFiScanner () {
+    WGScanIngest _ingest;   // Owns the network table on its worker thread
+    WGScanDiff _diff;       // Reused by each main-thread delivery
+    WGPostings _filters;    // Channel / security / hidden -> BSSIDs in networkCache (main thread)
+}
 
 @property (nonatomic, strong) WGAuditLogger *auditLogger;
-@property (nonatomic, strong) NSMutableDictionary<NSString *, WGNetworkInfo *> *networkCache;
-@property (nonatomic, strong) NSMutableDictionary<NSNumber *, WGChannelStats *> *channelStatsCache;
-@property (nonatomic, strong) NSTimer *scanTimer;
+@property (nonatomic, strong) WGAddressMap<WGNetworkInfo *> *networkCache; // Packed BSSID -> network (main thread)
+@property (nonatomic, strong) NSMutableArray<WGNetworkAnomaly *> *anomalies; // Oldest first (main thread)
+@property (nonatomic, assign) BOOL deliveryScheduled;
+@property (nonatomic, assign) NSTimeInterval lastDelivery;  // System uptime
+@property (nonatomic, assign) NSInteger scheduleTask; // WGMonitorScheduler task, -1 until first start
 @property (nonatomic, assign) BOOL isScanning;
-@property (nonatomic, assign) WiFiManagerRef wifiManager;
-@property (nonatomic, assign) WiFiDeviceRef wifiDevice;
 
 @end
 
@@ -200,6 +329,14 @@ static BOOL IsMobileWiFiAvailable(void) {
 
 static WGWiFiScanner *_sharedInstance = nil;
 
+// Worker thread: the pending diff just became non-empty
+static void WGWiFiScannerIngestNotify(void *context) {
+    __weak WGWiFiScanner *scanner = (__bridge WGWiFiScanner *)context;
+    dispatch_async(dispatch_get_main_queue(), ^{
+        [scanner scheduleDelivery];
+    });
+}
+
 #pragma mark - Singleton
 
 + (instancetype)sharedInstance {
@@ -213,62 +350,80 @@ static WGWiFiScanner *_sharedInstance = nil;
 #pragma mark - Initialization
 
 - (instancetype)initWithAuditLogger:(WGAuditLogger *)logger {
+    return [self initWithAuditLogger:logger
+                          scanSource:[[WGMobileWiFiScanSource alloc] initWithAuditLogger:logger]];
+}
+
+- (instancetype)initWithAuditLogger:(WGAuditLogger *)logger scanSource:(id<WGScanSource>)source {
     self = [super init];
     if (self) {
-        // Load MobileWiFi functions
-        LoadMobileWiFiFunctions();
-        
         _auditLogger = logger;
-        _networkCache = [NSMutableDictionary dictionary];
-        _channelStatsCache = [NSMutableDictionary dictionary];
+        _networkCache = [[WGAddressMap alloc] init];
+        WGScanDiffInit(&_diff);
+        WGPostingsInit(&_filters, 64);
+        WGScanIngestInit(&_ingest, WGWiFiScannerIngestNotify, (__bridge void *)self);
+        WGScanIngestSetVendors(&_ingest, [WGNetworkUtils vendorDatabase]);
+        WGScanIngestStart(&_ingest);
         _scanInterval = 5.0;
+        _adaptiveScheduling = YES;
+        _cpuBudget = 0.01;
+        _maxScansPerMinute = 20;
+        _signalStepThreshold = WGSignalParamsDefault().stepThreshold;
+        _anomalies = [NSMutableArray array];
+        _scheduleTask = -1;
         _isScanning = NO;
+        self.scanSource = source;
         
-        [self initializeWiFiManager];
-        
-        [_auditLogger logEvent:@"SCANNER_INIT" details:@"WiFi scanner initialized"];
+        [_auditLogger logEvent:@"SCANNER_INIT"
+                       details:[NSString stringWithFormat:@"WiFi scanner initialized (source: %@)", source.name]];
     }
     return self;
 }
 
-- (void)initializeWiFiManager {
-    if (!IsMobileWiFiAvailable()) {
-        NSLog(@"[WiFiGuard] MobileWiFi.framework not available - WiFi scanning disabled");
-        [self.auditLogger logEvent:@"SCANNER_INIT_ERROR" 
-                           details:@"MobileWiFi.framework not available"];
+- (void)dealloc {
+    [self stopScanning];
+    if (_scheduleTask >= 0) {
+        [[WGMonitorScheduler sharedScheduler] removeTask:_scheduleTask];
+    }
+    _scanSource.resultHandler = nil;
+    _scanSource.errorHandler = nil;
+    WGScanIngestFree(&_ingest);
+    WGScanDiffFree(&_diff);
+    WGPostingsFree(&_filters);
+}
+
+#pragma mark - Scan Source
+
+- (void)setScanSource:(id<WGScanSource>)scanSource {
+    if (scanSource == _scanSource) {
         return;
     }
+    BOOL wasScanning = self.isScanning;
+    [self stopScanning];
+    _scanSource.resultHandler = nil;
+    _scanSource.errorHandler = nil;
+    _scanSource = scanSource;
     
-    @try {
-        if (WiFiManagerClientCreate) {
-            _wifiManager = WiFiManagerClientCreate(kCFAllocatorDefault, 0);
+    // Results go straight to the ingest worker from the source's thread
+    __weak WGWiFiScanner *weakSelf = self;
+    scanSource.resultHandler = ^(const WGScanRecord *records, size_t count) {
+        WGWiFiScanner *scanner = weakSelf;
+        if (scanner && !WGScanIngestSubmit(&scanner->_ingest, records, count)) {
+            WGMetricsAdd(WGMetricCounterScanDropped, count);
+            NSLog(@"[WiFiGuard] Dropped %zu scan results (out of memory)", count);
         }
-        
-        if (_wifiManager && WiFiManagerClientCopyDevices) {
-            CFArrayRef devices = WiFiManagerClientCopyDevices(_wifiManager);
-            if (devices && CFArrayGetCount(devices) > 0) {
-                _wifiDevice = (WiFiDeviceRef)CFArrayGetValueAtIndex(devices, 0);
+    };
+    scanSource.errorHandler = ^(NSError *error) {
+        dispatch_async(dispatch_get_main_queue(), ^{
+            WGWiFiScanner *scanner = weakSelf;
+            if ([scanner.delegate respondsToSelector:@selector(wifiScanner:didEncounterError:)]) {
+                [scanner.delegate wifiScanner:scanner didEncounterError:error];
             }
-            if (devices) CFRelease(devices);
-        }
-        
-        if (_wifiDevice) {
-            NSLog(@"[WiFiGuard] WiFi manager initialized successfully");
-        } else {
-            NSLog(@"[WiFiGuard] WiFi manager created but no device found");
-        }
-    } @catch (NSException *exception) {
-        NSLog(@"[WiFiGuard] Error initializing WiFi manager: %@", exception);
-        [self.auditLogger logEvent:@"SCANNER_INIT_ERROR" 
-                           details:[NSString stringWithFormat:@"Exception: %@", exception]];
-    }
-}
-
-- (void)dealloc {
-    [self stopScanning];
-    if (_wifiManager) {
-        CFRelease(_wifiManager);
-        _wifiManager = NULL;
+        });
+    };
+    
+    if (wasScanning) {
+        [self startScanning];
     }
 }
 
@@ -279,50 +434,33 @@ static WGWiFiScanner *_sharedInstance = nil;
         return YES;
     }
     
-    if (!IsMobileWiFiAvailable()) {
-        NSError *error = [NSError errorWithDomain:@"WGWiFiScannerError" 
-                                             code:0 
-                                         userInfo:@{NSLocalizedDescriptionKey: @"MobileWiFi.framework not available. Requires jailbroken device."}];
-        if ([self.delegate respondsToSelector:@selector(wifiScanner:didEncounterError:)]) {
-            [self.delegate wifiScanner:self didEncounterError:error];
-        }
-        return NO;
-    }
-    
-    if (!self.wifiDevice) {
-        NSError *error = [NSError errorWithDomain:@"WGWiFiScannerError" 
-                                             code:1 
-                                         userInfo:@{NSLocalizedDescriptionKey: @"WiFi device not available"}];
+    NSError *error = nil;
+    if (![self.scanSource prepare:&error]) {
         if ([self.delegate respondsToSelector:@selector(wifiScanner:didEncounterError:)]) {
             [self.delegate wifiScanner:self didEncounterError:error];
         }
         return NO;
     }
     
-    // Note: WiFiDeviceClientGetPower may not work correctly on iOS 16+
-    // We'll try scanning anyway and let the scan callback handle errors
-    NSLog(@"[WiFiGuard] Starting scan (WiFi power check skipped for iOS 16+ compatibility)");
-    
     self.isScanning = YES;
     
     [self.auditLogger logEvent:@"SCAN_STARTED" 
-                       details:[NSString stringWithFormat:@"Interval: %.1fs", self.scanInterval]];
+                       details:[NSString stringWithFormat:@"Source: %@, interval: %.1fs",
+                               self.scanSource.name, self.scanInterval]];
     
-    // Perform initial scan
+    // Perform initial scan (continuous sources stream from here on)
     [self performSingleScan];
     
     // Start periodic scanning
-    self.scanTimer = [NSTimer scheduledTimerWithTimeInterval:self.scanInterval
-                                                      target:self
-                                                    selector:@selector(performSingleScan)
-                                                    userInfo:nil
-                                                     repeats:YES];
+    if (!self.scanSource.continuous) {
+        [self startScheduledScans];
+    }
     
     if ([self.delegate respondsToSelector:@selector(wifiScannerDidStartScanning:)]) {
         [self.delegate wifiScannerDidStartScanning:self];
     }
     
-    NSLog(@"[WiFiGuard] Passive scanning started (interval: %.1fs)", self.scanInterval);
+    NSLog(@"[WiFiGuard] Passive scanning started (source: %@, interval: %.1fs)", self.scanSource.name, self.scanInterval);
     
     return YES;
 }
@@ -332,8 +470,8 @@ static WGWiFiScanner *_sharedInstance = nil;
         return;
     }
     
-    [self.scanTimer invalidate];
-    self.scanTimer = nil;
+    [[WGMonitorScheduler sharedScheduler] stopTask:self.scheduleTask];
+    [self.scanSource stop];
     self.isScanning = NO;
     
     [self.auditLogger logEvent:@"SCAN_STOPPED" 
@@ -348,304 +486,590 @@ static WGWiFiScanner *_sharedInstance = nil;
 }
 
 - (void)performSingleScan {
-    if (!self.wifiDevice) {
-        NSLog(@"[WiFiGuard] Cannot scan: no WiFi device");
-        return;
+    [self.scanSource requestScan];
+}
+
+#pragma mark - Adaptive Scheduling
+
+- (WGScheduleConfig)scheduleConfig {
+    WGScheduleConfig config = WGScheduleConfigDefault((uint64_t)(MAX(self.scanInterval, 0.1) * NSEC_PER_SEC));
+    if (!self.adaptiveScheduling) {
+        config.fastNs = config.baseNs;
+        config.maxNs = config.baseNs;
     }
-    
-    // Check if async scan function is available
-    if (!WiFiDeviceClientScanAsync) {
-        NSLog(@"[WiFiGuard] WiFiDeviceClientScanAsync not available");
-        return;
+    config.cpuBudget = self.cpuBudget;
+    config.maxWakeupsPerMinute = (uint32_t)MIN(self.maxScansPerMinute, (NSUInteger)UINT32_MAX);
+    return config;
+}
+
+- (void)startScheduledScans {
+    WGMonitorScheduler *scheduler = [WGMonitorScheduler sharedScheduler];
+    if (self.scheduleTask < 0) {
+        // Results arrive asynchronously; deliverChanges reports what they held
+        __weak typeof(self) weakSelf = self;
+        self.scheduleTask = [scheduler addTaskWithConfig:[self scheduleConfig]
+                                                   queue:dispatch_get_main_queue()
+                                                   block:^WGScheduleActivity{
+            [weakSelf performSingleScan];
+            return WGScheduleActivityQuiet;
+        }];
+    } else {
+        [scheduler updateTask:self.scheduleTask config:[self scheduleConfig]];
     }
-    
-    NSLog(@"[WiFiGuard] Initiating WiFi scan...");
-    
-    @try {
-        // Perform passive scan - NO active probing
-        NSDictionary *options = @{
-            @"SCAN_MERGE": @YES,           // Merge results
-            @"SCAN_TYPE": @"PASSIVE"       // Passive scan only
-        };
-        
-        WiFiDeviceClientScanAsync(self.wifiDevice, 
-                                  (__bridge CFDictionaryRef)options, 
-                                  ^(CFArrayRef results, int error) {
-            if (error != 0) {
-                NSLog(@"[WiFiGuard] Scan callback error: %d", error);
-                dispatch_async(dispatch_get_main_queue(), ^{
-                    NSError *scanError = [NSError errorWithDomain:@"WGWiFiScannerError" 
-                                                             code:error 
-                                                         userInfo:@{NSLocalizedDescriptionKey: [NSString stringWithFormat:@"Scan failed with code %d", error]}];
-                    if ([self.delegate respondsToSelector:@selector(wifiScanner:didEncounterError:)]) {
-                        [self.delegate wifiScanner:self didEncounterError:scanError];
-                    }
-                });
-                return;
-            }
-            
-            NSLog(@"[WiFiGuard] Scan completed, processing results...");
-            [self processScanResults:results];
-        }, 0);
-        
-    } @catch (NSException *exception) {
-        NSLog(@"[WiFiGuard] Scan exception: %@", exception);
+    [scheduler startTask:self.scheduleTask];
+}
+
+- (void)updateSchedule {
+    if (self.scheduleTask >= 0) {
+        [[WGMonitorScheduler sharedScheduler] updateTask:self.scheduleTask config:[self scheduleConfig]];
     }
 }
 
-- (void)processScanResults:(CFArrayRef)results {
-    if (!results) {
-        NSLog(@"[WiFiGuard] processScanResults: results is NULL");
+- (void)setScanInterval:(NSTimeInterval)scanInterval {
+    _scanInterval = scanInterval;
+    [self updateSchedule];
+}
+
+- (void)setAdaptiveScheduling:(BOOL)adaptiveScheduling {
+    _adaptiveScheduling = adaptiveScheduling;
+    [self updateSchedule];
+}
+
+- (void)setCpuBudget:(double)cpuBudget {
+    _cpuBudget = cpuBudget;
+    [self updateSchedule];
+}
+
+- (void)setMaxScansPerMinute:(NSUInteger)maxScansPerMinute {
+    _maxScansPerMinute = maxScansPerMinute;
+    [self updateSchedule];
+}
+
+#pragma mark - Delivery
+
+- (void)scheduleDelivery {
+    if (self.deliveryScheduled) {
         return;
     }
+    self.deliveryScheduled = YES;
     
-    CFIndex count = CFArrayGetCount(results);
-    NSLog(@"[WiFiGuard] Processing %ld scan results", (long)count);
-    
-    NSMutableArray<WGNetworkInfo *> *updatedNetworks = [NSMutableArray array];
-    
-    for (CFIndex i = 0; i < count; i++) {
-        WiFiNetworkRef network = (WiFiNetworkRef)CFArrayGetValueAtIndex(results, i);
-        
-        WGNetworkInfo *info = [self parseNetworkInfo:network];
-        if (info && info.bssid) {
-            // Update or add to cache
-            WGNetworkInfo *existing = self.networkCache[info.bssid];
-            if (existing) {
-                [existing addRSSISample:info.rssi];
-                existing.channel = info.channel;
-                existing.securityType = info.securityType;
-                existing.channelWidth = info.channelWidth;
-                [updatedNetworks addObject:existing];
-            } else {
-                [info addRSSISample:info.rssi];
-                self.networkCache[info.bssid] = info;
-                [updatedNetworks addObject:info];
-                NSLog(@"[WiFiGuard] New network: %@ (%@) Ch:%ld RSSI:%ld", 
-                      info.ssid ?: @"<Hidden>", info.bssid, (long)info.channel, (long)info.rssi);
-            }
-        }
-    }
-    
-    // Update channel statistics
-    [self updateChannelStatistics];
-    
-    // Notify delegate on main thread
-    dispatch_async(dispatch_get_main_queue(), ^{
-        if ([self.delegate respondsToSelector:@selector(wifiScanner:didFindNetworks:)]) {
-            [self.delegate wifiScanner:self didFindNetworks:[self.networkCache.allValues copy]];
-        }
+    // Coalesce everything the worker applies within one refresh interval
+    NSTimeInterval wait = self.lastDelivery + kWGDeliveryInterval - [NSProcessInfo processInfo].systemUptime;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(MAX(wait, 0) * NSEC_PER_SEC)),
+                   dispatch_get_main_queue(), ^{
+        [self deliverChanges];
     });
 }
 
-- (WGNetworkInfo *)parseNetworkInfo:(WiFiNetworkRef)network {
-    if (!network) return nil;
-    
-    WGNetworkInfo *info = [[WGNetworkInfo alloc] init];
+- (void)deliverChanges {
+    self.deliveryScheduled = NO;
+    self.lastDelivery = [NSProcessInfo processInfo].systemUptime;
     
-    // Get SSID
-    if (WiFiNetworkGetSSID) {
-        CFStringRef ssidRef = WiFiNetworkGetSSID(network);
-        if (ssidRef) {
-            info.ssid = (__bridge NSString *)ssidRef;
-        }
+    WGScanSnapshot *snapshot = WGScanIngestTake(&_ingest, &_diff);
+    if (!snapshot) {
+        return;
     }
+    if (WGScanDiffIsEmpty(&_diff)) {
+        WGScanSnapshotRelease(snapshot);
+        return;
+    }
+    uint64_t start = WGMetricsNow();
     
-    // Get BSSID
-    if (WiFiNetworkGetBSSID) {
-        CFStringRef bssidRef = WiFiNetworkGetBSSID(network);
-        if (bssidRef) {
-            info.bssid = (__bridge NSString *)bssidRef;
+    // Mirror the diff into the main-thread objects
+    NSMutableArray<NSString *> *inserted = [NSMutableArray arrayWithCapacity:_diff.insertedCount];
+    NSMutableArray<NSString *> *updated = [NSMutableArray arrayWithCapacity:_diff.updatedCount];
+    NSMutableArray<NSString *> *removed = [NSMutableArray arrayWithCapacity:_diff.removedCount];
+    
+    for (size_t i = 0; i < _diff.removedCount; i++) {
+        WGNetworkInfo *network = [self.networkCache objectForKey:_diff.removed[i]];
+        if (network) {
+            [removed addObject:network.bssid];
+            [self unindexNetwork:network];
+            [self.networkCache removeObjectForKey:_diff.removed[i]];
         }
     }
-    
-    // Get RSSI
-    if (WiFiNetworkGetRSSI) {
-        CFNumberRef rssiRef = WiFiNetworkGetRSSI(network);
-        if (rssiRef) {
-            int rssi = 0;
-            CFNumberGetValue(rssiRef, kCFNumberIntType, &rssi);
-            info.rssi = rssi;
+    for (size_t i = 0; i < _diff.insertedCount; i++) {
+        const WGScanRecord *record = WGScanSnapshotFind(snapshot, _diff.inserted[i]);
+        if (record) {
+            WGNetworkInfo *network = [self networkFromRecord:record];
+            [self.networkCache setObject:network forKey:record->bssid];
+            [self indexNetwork:network];
+            [inserted addObject:network.bssid];
+            WGVerboseLog(@"[WiFiGuard] New network: %@ (%@) Ch:%ld RSSI:%ld",
+                  network.ssid ?: @"<Hidden>", network.bssid, (long)network.channel, (long)network.rssi);
         }
     }
-    
-    // Get Channel
-    if (WiFiNetworkGetChannel) {
-        CFNumberRef channelRef = WiFiNetworkGetChannel(network);
-        if (channelRef) {
-            int channel = 0;
-            CFNumberGetValue(channelRef, kCFNumberIntType, &channel);
-            info.channel = channel;
+    for (size_t i = 0; i < _diff.updatedCount; i++) {
+        const WGScanRecord *record = WGScanSnapshotFind(snapshot, _diff.updated[i]);
+        WGNetworkInfo *network = [self.networkCache objectForKey:_diff.updated[i]];
+        if (!record) {
+            continue;
+        }
+        if (network) {
+            // Re-filed only when channel, security or visibility moved
+            uint64_t before[3], after[3];
+            NSUInteger beforeCount = [self filterKeys:before forNetwork:network];
+            [network applyRecord:record];
+            NSUInteger afterCount = [self filterKeys:after forNetwork:network];
+            if (beforeCount != afterCount || memcmp(before, after, afterCount * sizeof(uint64_t)) != 0) {
+                for (NSUInteger k = 0; k < beforeCount; k++) {
+                    WGPostingsRemove(&_filters, before[k], network.bssidValue);
+                }
+                [self indexNetwork:network];
+            }
+            [self syncSamplesForNetwork:network];
+            [updated addObject:network.bssid];
+        } else {
+            network = [self networkFromRecord:record];
+            [self.networkCache setObject:network forKey:record->bssid];
+            [self indexNetwork:network];
+            [inserted addObject:network.bssid];
         }
     }
     
-    // Check if hidden
-    if (WiFiNetworkIsHidden) {
-        info.isHidden = WiFiNetworkIsHidden(network);
-    }
+    WGNetworkChanges *changes = [[WGNetworkChanges alloc] initWithInserted:inserted
+                                                                   updated:updated
+                                                                   removed:removed
+                                                                   version:snapshot->version];
+    WGScanSnapshotRelease(snapshot);
+    WGMetricsEnd(WGMetricStageScanDeliver, start);
     
-    // Get security type from network record
-    if (WiFiNetworkCopyRecord) {
-        CFDictionaryRef record = WiFiNetworkCopyRecord(network);
-        if (record) {
-            info.securityType = [self parseSecurityType:record];
-            info.channelWidth = [self parseChannelWidth:record];
-            CFRelease(record);
-        }
+    // Steps and SSID alerts ride on inserts and updates, so they arrive
+    // with a non-empty diff
+    [self deliverSignalSteps];
+    [self deliverSSIDAlerts];
+    
+    // New BSSIDs end a stable stretch; RSSI updates alone do not
+    if (inserted.count > 0) {
+        [[WGMonitorScheduler sharedScheduler] noteActivity:WGScheduleActivityChanged
+                                                   forTask:self.scheduleTask];
     }
     
-    return info;
+    if ([self.delegate respondsToSelector:@selector(wifiScanner:didChangeNetworks:)]) {
+        [self.delegate wifiScanner:self didChangeNetworks:changes];
+    } else if ([self.delegate respondsToSelector:@selector(wifiScanner:didFindNetworks:)]) {
+        [self.delegate wifiScanner:self didFindNetworks:self.networkCache.allObjects];
+    }
 }
 
-- (NSString *)parseSecurityType:(CFDictionaryRef)record {
-    // Parse security mode from network record
-    CFStringRef securityMode = CFDictionaryGetValue(record, CFSTR("WEP"));
-    if (securityMode && CFBooleanGetValue((CFBooleanRef)securityMode)) {
-        return @"WEP";
+#pragma mark - Anomalies
+
+- (void)setSignalStepThreshold:(double)signalStepThreshold {
+    _signalStepThreshold = MAX(0, signalStepThreshold);
+    WGSignalParams params = WGSignalParamsDefault();
+    params.stepThreshold = (float)_signalStepThreshold;
+    WGScanIngestSetSignalParams(&_ingest, params);
+}
+
+- (void)deliverSignalSteps {
+    WGSignalStep steps[16];
+    size_t count;
+    while ((count = WGScanIngestTakeSteps(&_ingest, steps, 16)) > 0) {
+        for (size_t i = 0; i < count; i++) {
+            [self recordSignalStep:&steps[i]];
+        }
     }
+}
+
+- (void)recordSignalStep:(const WGSignalStep *)step {
+    WGNetworkInfo *network = [self.networkCache objectForKey:step->bssid];
+    WGNetworkAnomaly *anomaly = [[WGNetworkAnomaly alloc] init];
+    anomaly.type = WGNetworkAnomalyTypeSignalStep;
+    anomaly.bssid = network.bssid ?: WGStringFromMAC(step->bssid);
+    anomaly.ssid = network.ssid;
+    anomaly.previousRSSI = lroundf(step->baseline);
+    anomaly.currentRSSI = step->rssi;
+    anomaly.channel = network.channel;
+    anomaly.securityType = network.securityType;
+    anomaly.vendor = network.vendor;
+    anomaly.score = step->zScore;
+    anomaly.detectedAt = [NSDate dateWithTimeIntervalSince1970:step->timestamp];
+    // A stronger signal is what a closer impostor looks like; a drop is
+    // as often someone walking away
+    anomaly.severity = step->rssi > step->baseline ? 7 : 5;
+    anomaly.details = [NSString stringWithFormat:@"RSSI %ld dBm against a smoothed %.1f dBm, z = %.1f",
+                       (long)step->rssi, step->baseline, step->zScore];
     
-    CFDictionaryRef wpaMode = CFDictionaryGetValue(record, CFSTR("WPA"));
-    if (wpaMode) {
-        // Check for WPA3
-        CFBooleanRef wpa3 = CFDictionaryGetValue(record, CFSTR("WPA3"));
-        if (wpa3 && CFBooleanGetValue(wpa3)) {
-            return @"WPA3";
+    [self recordAnomaly:anomaly];
+}
+
+- (void)deliverSSIDAlerts {
+    WGSSIDAlert alerts[16];
+    size_t count;
+    while ((count = WGScanIngestTakeAlerts(&_ingest, alerts, 16)) > 0) {
+        for (size_t i = 0; i < count; i++) {
+            [self recordSSIDAlert:&alerts[i]];
         }
-        return @"WPA2";
     }
+}
+
+static NSString *WGSecurityRankName(int8_t rank) {
+    static NSString * const names[WGSecurityRankCount] = { @"Open", @"WEP", @"WPA", @"WPA2", @"WPA3" };
+    return rank >= 0 && rank < WGSecurityRankCount ? names[rank] : @"Unknown";
+}
+
+- (void)recordSSIDAlert:(const WGSSIDAlert *)alert {
+    WGNetworkAnomaly *anomaly = [[WGNetworkAnomaly alloc] init];
+    anomaly.type = alert->type == WGSSIDAlertDowngrade ? WGNetworkAnomalyTypeSecurityDowngrade
+                                                       : WGNetworkAnomalyTypeEvilTwin;
+    anomaly.bssid = WGStringFromMAC(alert->bssid);
+    anomaly.ssid = [[NSString alloc] initWithBytes:alert->ssid length:alert->ssidLength encoding:NSUTF8StringEncoding];
+    anomaly.channel = alert->channel;
+    anomaly.securityType = WGSecurityRankName(alert->security);
+    anomaly.knownSecurityType = WGSecurityRankName(alert->knownSecurity);
+    anomaly.vendor = [WGNetworkUtils vendorNameForID:alert->vendor];
+    anomaly.currentRSSI = [self.networkCache objectForKey:alert->bssid].rssi;
+    anomaly.detectedAt = [NSDate dateWithTimeIntervalSince1970:alert->timestamp];
+    // Dropping to Open or WEP exposes traffic outright
+    if (anomaly.type == WGNetworkAnomalyTypeSecurityDowngrade) {
+        anomaly.severity = alert->security <= WGSecurityRankWEP ? 9 : 7;
+    } else {
+        anomaly.severity = 6;
+    }
+    anomaly.details = [NSString stringWithFormat:@"%u BSSIDs advertise this SSID;%@%@%@",
+                       alert->bssidCount,
+                       alert->newBSSID ? @" new BSSID" : @"",
+                       alert->newChannel ? @" new channel" : @"",
+                       alert->newVendor ? @" new vendor" : @""];
+    [self recordAnomaly:anomaly];
+}
+
+- (void)recordAnomaly:(WGNetworkAnomaly *)anomaly {
+    [self.anomalies addObject:anomaly];
+    if (self.anomalies.count > kWGAnomalyHistoryLimit) {
+        [self.anomalies removeObjectsInRange:NSMakeRange(0, self.anomalies.count - kWGAnomalyHistoryLimit)];
+    }
+    [[WGMonitorScheduler sharedScheduler] noteActivity:WGScheduleActivityAlert forTask:self.scheduleTask];
+    [self.auditLogger logEvent:@"WIFI_ANOMALY_DETECTED"
+                       details:[anomaly localizedDescription]
+                      severity:anomaly.severity];
     
-    return @"Open";
+    if ([self.delegate respondsToSelector:@selector(wifiScanner:didDetectAnomaly:)]) {
+        [self.delegate wifiScanner:self didDetectAnomaly:anomaly];
+    }
+    WGVerboseLog(@"[WiFiGuard] %@", [anomaly localizedDescription]);
 }
 
-- (NSInteger)parseChannelWidth:(CFDictionaryRef)record {
-    CFNumberRef widthRef = CFDictionaryGetValue(record, CFSTR("CHANNEL_WIDTH"));
-    if (widthRef) {
-        int width = 20;
-        CFNumberGetValue(widthRef, kCFNumberIntType, &width);
-        return width;
+- (NSArray<WGNetworkAnomaly *> *)detectedAnomalies {
+    return [self.anomalies copy];
+}
+
+- (void)clearAnomalyHistory {
+    [self.anomalies removeAllObjects];
+    [self.auditLogger logEvent:@"WIFI_ANOMALY_HISTORY_CLEARED" details:@"All Wi-Fi anomalies cleared"];
+}
+
+#pragma mark - Filter Index
+
+- (NSUInteger)filterKeys:(uint64_t *)keys forNetwork:(WGNetworkInfo *)network {
+    NSUInteger count = 0;
+    keys[count++] = WGRecordKey(WGNetworkKeyChannel, (uint64_t)network.channel);
+    if (WGNetworkSecurityKey(network.securityType.UTF8String, &keys[count])) {
+        count++;
     }
-    return 20;
+    if (network.isHidden) {
+        keys[count++] = WGRecordKey(WGNetworkKeyHidden, 0);
+    }
+    return count;
 }
 
-#pragma mark - Channel Statistics
+- (void)indexNetwork:(WGNetworkInfo *)network {
+    uint64_t keys[3];
+    NSUInteger count = [self filterKeys:keys forNetwork:network];
+    for (NSUInteger k = 0; k < count; k++) {
+        WGPostingsAdd(&_filters, keys[k], network.bssidValue);
+    }
+}
 
-- (void)updateChannelStatistics {
-    [self.channelStatsCache removeAllObjects];
-    
-    // Group networks by channel
-    NSMutableDictionary<NSNumber *, NSMutableArray *> *networksByChannel = [NSMutableDictionary dictionary];
-    
-    for (WGNetworkInfo *network in self.networkCache.allValues) {
-        NSNumber *channelKey = @(network.channel);
-        if (!networksByChannel[channelKey]) {
-            networksByChannel[channelKey] = [NSMutableArray array];
-        }
-        [networksByChannel[channelKey] addObject:network];
+- (void)unindexNetwork:(WGNetworkInfo *)network {
+    uint64_t keys[3];
+    NSUInteger count = [self filterKeys:keys forNetwork:network];
+    for (NSUInteger k = 0; k < count; k++) {
+        WGPostingsRemove(&_filters, keys[k], network.bssidValue);
     }
+}
+
+- (WGNetworkInfo *)networkFromRecord:(const WGScanRecord *)record {
+    WGNetworkInfo *network = [[WGNetworkInfo alloc] init];
+    [network applyRecord:record];
+    [self syncSamplesForNetwork:network];
+    return network;
+}
+
+- (void)syncSamplesForNetwork:(WGNetworkInfo *)network {
+    WGRSSISample samples[WG_RSSI_HISTORY_CAPACITY];
+    uint64_t latest = network.sampleSeq;
+    size_t count = WGScanIngestCopySamples(&_ingest, network.bssidValue, network.sampleSeq,
+                                           samples, WG_RSSI_HISTORY_CAPACITY, &latest);
+    [network appendRSSISamples:samples count:count];
+    network.sampleSeq = latest;
+}
+
+#pragma mark - Channel Statistics
+
+- (WGChannelStats *)statsForSlot:(int)slot inAggregate:(const WGChannelAggregate *)channels {
+    const WGChannelSlot *aggregate = &channels->slots[slot];
+    WGChannelBand band;
+    uint16_t channel;
+    WGChannelSlotChannel(slot, &band, &channel);
     
-    // Calculate statistics for each channel
-    for (NSNumber *channel in networksByChannel) {
-        NSArray *networks = networksByChannel[channel];
-        WGChannelStats *stats = [[WGChannelStats alloc] initWithChannel:channel.integerValue];
-        stats.networkCount = networks.count;
-        
-        // Calculate average RSSI
-        CGFloat totalRSSI = 0;
-        for (WGNetworkInfo *network in networks) {
-            totalRSSI += network.rssi;
-        }
-        stats.averageRSSI = totalRSSI / networks.count;
-        
-        // Calculate congestion level (0-100)
-        // Based on number of networks and average RSSI
-        NSInteger congestion = MIN(100, networks.count * 15);
-        if (stats.averageRSSI > -50) {
-            congestion += 20; // Strong signals indicate close/overlapping networks
-        }
-        stats.congestionLevel = MIN(100, congestion);
-        
-        self.channelStatsCache[channel] = stats;
-    }
+    WGChannelStats *stats = [[WGChannelStats alloc] initWithChannel:channel];
+    stats.band = band;
+    stats.networkCount = aggregate->networkCount;
+    stats.overlapCount = aggregate->overlapCount;
+    stats.averageRSSI = WGChannelSlotAverageRSSI(aggregate);
+    stats.congestionLevel = WGChannelSlotCongestion(aggregate);
+    return stats;
 }
 
 #pragma mark - Data Access
 
+// Live objects on the main thread; other threads get copies built from the
+// ingest snapshot so they never race the delivery that mutates them
+- (NSArray<WGNetworkInfo *> *)currentNetworks {
+    if ([NSThread isMainThread]) {
+        return self.networkCache.allObjects;
+    }
+    return [self snapshotNetworks];
+}
+
+- (NSArray<WGNetworkInfo *> *)snapshotNetworks {
+    WGScanSnapshot *snapshot = WGScanIngestSnapshot(&_ingest);
+    if (!snapshot) {
+        return @[];
+    }
+    NSMutableArray<WGNetworkInfo *> *networks = [NSMutableArray arrayWithCapacity:snapshot->count];
+    for (size_t i = 0; i < snapshot->count; i++) {
+        [networks addObject:[self networkFromRecord:&snapshot->records[i]]];
+    }
+    WGScanSnapshotRelease(snapshot);
+    return networks;
+}
+
 - (NSArray<WGNetworkInfo *> *)discoveredNetworks {
-    return [self.networkCache.allValues sortedArrayUsingComparator:^NSComparisonResult(WGNetworkInfo *n1, WGNetworkInfo *n2) {
+    return [self sortedByRSSI:self.currentNetworks];
+}
+
+- (NSArray<WGNetworkInfo *> *)sortedByRSSI:(NSArray<WGNetworkInfo *> *)networks {
+    return [networks sortedArrayUsingComparator:^NSComparisonResult(WGNetworkInfo *n1, WGNetworkInfo *n2) {
         return [@(n2.rssi) compare:@(n1.rssi)]; // Sort by RSSI descending
     }];
 }
 
 - (NSArray<WGChannelStats *> *)channelStatistics {
-    return [self.channelStatsCache.allValues sortedArrayUsingComparator:^NSComparisonResult(WGChannelStats *s1, WGChannelStats *s2) {
-        return [@(s1.channel) compare:@(s2.channel)];
-    }];
+    uint64_t start = WGMetricsNow();
+    WGScanSnapshot *snapshot = WGScanIngestSnapshot(&_ingest);
+    if (!snapshot) {
+        return @[];
+    }
+    
+    // Slots are already ordered by band, then channel
+    NSMutableArray<WGChannelStats *> *statistics = [NSMutableArray arrayWithCapacity:snapshot->channels.quiet.count];
+    for (int slot = 0; slot < WG_CHANNEL_SLOT_COUNT; slot++) {
+        if (WGChannelSlotOccupied(&snapshot->channels.slots[slot])) {
+            [statistics addObject:[self statsForSlot:slot inAggregate:&snapshot->channels]];
+        }
+    }
+    WGScanSnapshotRelease(snapshot);
+    WGMetricsEnd(WGMetricStageScanChannels, start);
+    return statistics;
 }
 
 - (WGNetworkInfo *)networkWithBSSID:(NSString *)bssid {
-    return self.networkCache[bssid];
+    WGMACAddress key = WGMACFromString(bssid);
+    if (!key) {
+        return nil;
+    }
+    if ([NSThread isMainThread]) {
+        return [self.networkCache objectForKey:key];
+    }
+    
+    WGScanSnapshot *snapshot = WGScanIngestSnapshot(&_ingest);
+    const WGScanRecord *record = snapshot ? WGScanSnapshotFind(snapshot, key) : NULL;
+    WGNetworkInfo *network = record ? [self networkFromRecord:record] : nil;
+    WGScanSnapshotRelease(snapshot);
+    return network;
 }
 
 - (NSArray<WGNetworkInfo *> *)networksOnChannel:(NSInteger)channel {
-    NSPredicate *predicate = [NSPredicate predicateWithFormat:@"channel == %ld", (long)channel];
-    return [self.networkCache.allValues filteredArrayUsingPredicate:predicate];
+    return [self networksMatchingChannel:channel securityType:nil hiddenOnly:NO];
 }
 
 - (NSArray<WGNetworkInfo *> *)networksWithSecurityType:(NSString *)type {
-    NSPredicate *predicate = [NSPredicate predicateWithFormat:@"securityType == %@", type];
-    return [self.networkCache.allValues filteredArrayUsingPredicate:predicate];
+    return [self networksMatchingChannel:0 securityType:type hiddenOnly:NO];
 }
 
 - (NSArray<WGNetworkInfo *> *)hiddenNetworks {
-    NSPredicate *predicate = [NSPredicate predicateWithFormat:@"isHidden == YES"];
-    return [self.networkCache.allValues filteredArrayUsingPredicate:predicate];
+    return [self networksMatchingChannel:0 securityType:nil hiddenOnly:YES];
+}
+
+- (NSArray<WGNetworkInfo *> *)networksWithSSID:(NSString *)ssid {
+    const char *bytes = ssid.UTF8String;
+    size_t length = bytes ? strlen(bytes) : 0;
+    if (length == 0 || length > WG_SCAN_SSID_MAX) {
+        return @[];
+    }
+    WGMACAddress bssids[256];
+    size_t count = MIN(WGScanIngestSSIDMembers(&_ingest, bytes, length, bssids, 256), 256);
+    
+    NSMutableArray<WGNetworkInfo *> *networks = [NSMutableArray arrayWithCapacity:count];
+    if ([NSThread isMainThread]) {
+        for (size_t i = 0; i < count; i++) {
+            WGNetworkInfo *network = [self.networkCache objectForKey:bssids[i]];
+            if (network) {
+                [networks addObject:network];
+            }
+        }
+        return networks;
+    }
+    WGScanSnapshot *snapshot = WGScanIngestSnapshot(&_ingest);
+    for (size_t i = 0; snapshot && i < count; i++) {
+        const WGScanRecord *record = WGScanSnapshotFind(snapshot, bssids[i]);
+        if (record) {
+            [networks addObject:[self networkFromRecord:record]];
+        }
+    }
+    WGScanSnapshotRelease(snapshot);
+    return networks;
+}
+
+- (NSArray<WGNetworkInfo *> *)networksMatchingChannel:(NSInteger)channel
+                                         securityType:(NSString *)type
+                                           hiddenOnly:(BOOL)hiddenOnly {
+    uint64_t keys[3];
+    NSUInteger keyCount = 0;
+    if (channel > 0) {
+        keys[keyCount++] = WGRecordKey(WGNetworkKeyChannel, (uint64_t)channel);
+    }
+    if (type) {
+        if (!WGNetworkSecurityKey(type.UTF8String, &keys[keyCount])) {
+            return @[];
+        }
+        keyCount++;
+    }
+    if (hiddenOnly) {
+        keys[keyCount++] = WGRecordKey(WGNetworkKeyHidden, 0);
+    }
+    if (keyCount == 0) {
+        return self.currentNetworks;
+    }
+    if (![NSThread isMainThread]) {
+        return [self snapshotNetworksMatchingChannel:channel securityType:type hiddenOnly:hiddenOnly];
+    }
+    
+    // Walk the shortest posting list, test the other filters on the object
+    const uint64_t *bssids = NULL;
+    size_t count = SIZE_MAX;
+    for (NSUInteger k = 0; k < keyCount; k++) {
+        const uint64_t *values;
+        size_t length = WGPostingsGet(&_filters, keys[k], &values);
+        if (length < count) {
+            bssids = values;
+            count = length;
+        }
+    }
+    NSMutableArray<WGNetworkInfo *> *networks = [NSMutableArray arrayWithCapacity:count];
+    for (size_t i = 0; i < count; i++) {
+        WGNetworkInfo *network = [self.networkCache objectForKey:bssids[i]];
+        if (network && (channel <= 0 || network.channel == channel) &&
+            (!type || [network.securityType isEqualToString:type]) &&
+            (!hiddenOnly || network.isHidden)) {
+            [networks addObject:network];
+        }
+    }
+    return networks;
+}
+
+// Off the main thread: filter the ingest snapshot's records, building
+// objects only for matches
+- (NSArray<WGNetworkInfo *> *)snapshotNetworksMatchingChannel:(NSInteger)channel
+                                                 securityType:(NSString *)type
+                                                   hiddenOnly:(BOOL)hiddenOnly {
+    WGScanSnapshot *snapshot = WGScanIngestSnapshot(&_ingest);
+    if (!snapshot) {
+        return @[];
+    }
+    const char *security = type.UTF8String;
+    NSMutableArray<WGNetworkInfo *> *networks = [NSMutableArray array];
+    for (size_t i = 0; i < snapshot->count; i++) {
+        const WGScanRecord *record = &snapshot->records[i];
+        if ((channel <= 0 || record->channel == channel) &&
+            (!security || strcmp(record->security, security) == 0) &&
+            (!hiddenOnly || (record->flags & WGScanRecordFlagHidden))) {
+            [networks addObject:[self networkFromRecord:record]];
+        }
+    }
+    WGScanSnapshotRelease(snapshot);
+    return networks;
 }
 
 #pragma mark - Statistics
 
 - (WGChannelStats *)statsForChannel:(NSInteger)channel {
-    return self.channelStatsCache[@(channel)];
+    return [self statsForChannel:channel band:WGChannelBandForChannel(channel)];
+}
+
+- (WGChannelStats *)statsForChannel:(NSInteger)channel band:(WGChannelBand)band {
+    int slot = WGChannelSlotIndex(band, channel);
+    WGScanSnapshot *snapshot = slot >= 0 ? WGScanIngestSnapshot(&_ingest) : NULL;
+    if (!snapshot) {
+        return nil;
+    }
+    WGChannelStats *stats = WGChannelSlotOccupied(&snapshot->channels.slots[slot]) ?
+        [self statsForSlot:slot inAggregate:&snapshot->channels] : nil;
+    WGScanSnapshotRelease(snapshot);
+    return stats;
 }
 
 - (NSInteger)mostCrowdedChannel {
-    WGChannelStats *maxStats = nil;
-    for (WGChannelStats *stats in self.channelStatsCache.allValues) {
-        if (!maxStats || stats.networkCount > maxStats.networkCount) {
-            maxStats = stats;
-        }
+    WGScanSnapshot *snapshot = WGScanIngestSnapshot(&_ingest);
+    int slot = snapshot ? WGChannelAggregateMostCrowded(&snapshot->channels) : -1;
+    WGScanSnapshotRelease(snapshot);
+    if (slot < 0) {
+        return 0;
     }
-    return maxStats ? maxStats.channel : 0;
+    WGChannelBand band;
+    uint16_t channel;
+    WGChannelSlotChannel(slot, &band, &channel);
+    return channel;
 }
 
 - (NSInteger)leastCrowdedChannel {
     // Consider 2.4GHz channels: 1, 6, 11 (non-overlapping)
-    NSArray *nonOverlappingChannels = @[@1, @6, @11];
+    static const NSInteger nonOverlappingChannels[] = {1, 6, 11};
     NSInteger bestChannel = 1;
     NSInteger lowestCount = NSIntegerMax;
     
-    for (NSNumber *channel in nonOverlappingChannels) {
-        WGChannelStats *stats = self.channelStatsCache[channel];
-        NSInteger count = stats ? stats.networkCount : 0;
+    WGScanSnapshot *snapshot = WGScanIngestSnapshot(&_ingest);
+    if (!snapshot) {
+        return bestChannel;
+    }
+    for (size_t i = 0; i < 3; i++) {
+        const WGChannelSlot *slot = &snapshot->channels.slots[WGChannelSlotIndex(WGChannelBand2GHz, nonOverlappingChannels[i])];
+        NSInteger count = slot->networkCount + slot->overlapCount;
         if (count < lowestCount) {
             lowestCount = count;
-            bestChannel = channel.integerValue;
+            bestChannel = nonOverlappingChannels[i];
         }
     }
+    WGScanSnapshotRelease(snapshot);
     
     return bestChannel;
 }
 
 - (NSArray<NSNumber *> *)recommendedChannels {
-    // Return channels sorted by least congestion
-    NSArray *sortedStats = [self.channelStatsCache.allValues 
-        sortedArrayUsingComparator:^NSComparisonResult(WGChannelStats *s1, WGChannelStats *s2) {
-            return [@(s1.congestionLevel) compare:@(s2.congestionLevel)];
-        }];
+    // Least congested first, read off the aggregate's heap
+    uint16_t slots[3];
+    WGScanSnapshot *snapshot = WGScanIngestSnapshot(&_ingest);
+    size_t count = snapshot ? WGChannelAggregateLeastCongested(&snapshot->channels, slots, 3) : 0;
+    WGScanSnapshotRelease(snapshot);
     
-    NSMutableArray *recommended = [NSMutableArray array];
-    for (WGChannelStats *stats in sortedStats) {
-        [recommended addObject:@(stats.channel)];
-        if (recommended.count >= 3) break;
+    NSMutableArray *recommended = [NSMutableArray arrayWithCapacity:count];
+    for (size_t i = 0; i < count; i++) {
+        WGChannelBand band;
+        uint16_t channel;
+        WGChannelSlotChannel(slots[i], &band, &channel);
+        [recommended addObject:@(channel)];
     }
     
     return recommended;
@@ -654,15 +1078,17 @@ static WGWiFiScanner *_sharedInstance = nil;
 #pragma mark - Cache Management
 
 - (void)clearCache {
-    [self.networkCache removeAllObjects];
-    [self.channelStatsCache removeAllObjects];
+    // Apply the clear before returning so callers see an empty cache
+    WGScanIngestClear(&_ingest);
+    WGScanIngestWaitIdle(&_ingest);
+    [self deliverChanges];
     [self.auditLogger logEvent:@"CACHE_CLEARED" details:@"Network cache cleared"];
 }
 
 - (void)clearRSSIHistory {
-    for (WGNetworkInfo *network in self.networkCache.allValues) {
-        [network.rssiHistory removeAllObjects];
-        [network.rssiTimestamps removeAllObjects];
+    WGScanIngestClearHistory(&_ingest);
+    for (WGNetworkInfo *network in self.networkCache) {
+        [network clearRSSIHistory];
     }
     [self.auditLogger logEvent:@"RSSI_HISTORY_CLEARED" details:@"RSSI history cleared"];
 }
@@ -676,23 +1102,25 @@ static WGWiFiScanner *_sharedInstance = nil;
     }
     return data;
 }
+
+- (NSArray<WGNetworkInfo *> *)exportNetworks {
+    return [self sortedByRSSI:[self snapshotNetworks]];
+}
+
+#pragma mark - Metrics
+
+- (NSDictionary<NSString *, NSDictionary *> *)metricsSnapshot {
+    NSMutableDictionary *snapshot = [WGMetricsReport(@"scan.") mutableCopy];
+    snapshot[@"schedule"] = [[WGMonitorScheduler sharedScheduler] reportForTask:self.scheduleTask];
+    return snapshot;
+}
+
 #pragma mark - Diagnostics
 
 - (NSString *)diagnosticStatus {
-    // Force load attempt
-    LoadMobileWiFiFunctions();
-    
-    if (!gMobileWiFiLoaded) {
-        if (gLoadError) {
-            return [NSString stringWithFormat:@"❌ %@", gLoadError];
-        }
-        return @"❌ MobileWiFi not loaded";
-    }
-    if (!self.wifiManager) {
-        return @"❌ No WiFi Manager";
-    }
-    if (!self.wifiDevice) {
-        return @"❌ No WiFi Device";
+    NSString *problem = [self.scanSource diagnosticStatus];
+    if (problem) {
+        return problem;
     }
     if (self.isScanning) {
         NSInteger count = self.networkCache.count;
@@ -466,9 +466,52 @@
 
 #pragma mark - WGWiFiScannerDelegate
 
-- (void)wifiScanner:(WGWiFiScanner *)scanner didFindNetworks:(NSArray<WGNetworkInfo *> *)networks {
-    self.networks = networks;
-    [self.networksTableView reloadData];
+- (void)wifiScanner:(WGWiFiScanner *)scanner didChangeNetworks:(WGNetworkChanges *)changes {
+    // Rows keep their position; only changed rows are touched. The objects
+    // are the scanner's live ones, so updated rows just need redrawing.
+    NSMutableArray<WGNetworkInfo *> *networks = [self.networks mutableCopy];
+    NSSet<NSString *> *removed = [NSSet setWithArray:changes.removed];
+    NSMutableIndexSet *removedRows = [NSMutableIndexSet indexSet];
+    NSMutableArray<NSIndexPath *> *deletions = [NSMutableArray arrayWithCapacity:removed.count];
+    [networks enumerateObjectsUsingBlock:^(WGNetworkInfo *network, NSUInteger row, BOOL *stop) {
+        if ([removed containsObject:network.bssid]) {
+            [removedRows addIndex:row];
+            [deletions addObject:[NSIndexPath indexPathForRow:row inSection:0]];
+        }
+    }];
+    [networks removeObjectsAtIndexes:removedRows];
+    
+    NSMutableArray<NSIndexPath *> *insertions = [NSMutableArray arrayWithCapacity:changes.inserted.count];
+    for (NSString *bssid in changes.inserted) {
+        WGNetworkInfo *network = [scanner networkWithBSSID:bssid];
+        if (network) {
+            [insertions addObject:[NSIndexPath indexPathForRow:networks.count inSection:0]];
+            [networks addObject:network];
+        }
+    }
+    
+    if (deletions.count > 0 || insertions.count > 0) {
+        [self.networksTableView performBatchUpdates:^{
+            self.networks = networks;
+            [self.networksTableView deleteRowsAtIndexPaths:deletions withRowAnimation:UITableViewRowAnimationFade];
+            [self.networksTableView insertRowsAtIndexPaths:insertions withRowAnimation:UITableViewRowAnimationFade];
+        } completion:nil];
+        [self.networksTableView headerViewForSection:0].textLabel.text =
+            [self tableView:self.networksTableView titleForHeaderInSection:0];
+    }
+    
+    if (changes.updated.count > 0) {
+        NSSet<NSString *> *updated = [NSSet setWithArray:changes.updated];
+        NSMutableArray<NSIndexPath *> *reloads = [NSMutableArray array];
+        for (NSIndexPath *indexPath in self.networksTableView.indexPathsForVisibleRows) {
+            if (indexPath.row < (NSInteger)self.networks.count &&
+                [updated containsObject:self.networks[indexPath.row].bssid]) {
+                [reloads addObject:indexPath];
+            }
+        }
+        [self.networksTableView reloadRowsAtIndexPaths:reloads withRowAnimation:UITableViewRowAnimationNone];
+    }
+    
     [self.channelView updateWithStatistics:scanner.channelStatistics];
 }
 
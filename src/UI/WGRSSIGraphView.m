@@ -4,16 +4,110 @@
  */
 
 #import "WGRSSIGraphView.h"
+#import "WGSeries.h"
 #import "WGWiFiScanner.h"
 
+static const CGFloat kWGGraphTop = 80;
+static const CGFloat kWGGraphLeft = 50;
+static const CGFloat kWGGraphRightInset = 20;
+static const CGFloat kWGGraphBottomInset = 30;
+
+#pragma mark - WGRSSITrack
+
+// One plotted network: its decimated series, a cached path of finished
+// buckets and a short tail for the open one. Paths are built in bucket
+// space (x = columns since originIndex), so time passing only moves the
+// layers sideways.
+@interface WGRSSITrack : NSObject {
+@public
+    WGSeries _series;
+}
+
+@property (nonatomic, weak) WGNetworkInfo *network;
+@property (nonatomic, strong) CAShapeLayer *pathLayer;
+@property (nonatomic, strong) CAShapeLayer *tailLayer;
+@property (nonatomic, assign) CGMutablePathRef path;
+@property (nonatomic, assign) int64_t originIndex;
+@property (nonatomic, assign) int64_t pathThrough;     // Last bucket in path, INT64_MIN when empty
+@property (nonatomic, assign) size_t trimmedSinceBuild;
+@property (nonatomic, assign) CGSize builtSize;
+
+@end
+
+@implementation WGRSSITrack
+
+- (instancetype)initWithNetwork:(WGNetworkInfo *)network window:(NSTimeInterval)window columns:(uint32_t)columns {
+    self = [super init];
+    if (self) {
+        _network = network;
+        WGSeriesInit(&_series, window, columns);
+        _pathThrough = INT64_MIN;
+        
+        _pathLayer = [CAShapeLayer layer];
+        _tailLayer = [CAShapeLayer layer];
+        for (CAShapeLayer *layer in @[_pathLayer, _tailLayer]) {
+            layer.fillColor = nil;
+            layer.lineWidth = 2.0;
+            layer.lineCap = kCALineCapRound;
+            layer.lineJoin = kCALineJoinRound;
+            layer.anchorPoint = CGPointZero;
+            layer.actions = @{ @"path": [NSNull null], @"transform": [NSNull null],
+                               @"bounds": [NSNull null], @"strokeColor": [NSNull null] };
+        }
+    }
+    return self;
+}
+
+- (void)dealloc {
+    WGSeriesFree(&_series);
+    if (_path) {
+        CGPathRelease(_path);
+    }
+}
+
+- (void)removeLayers {
+    [self.pathLayer removeFromSuperlayer];
+    [self.tailLayer removeFromSuperlayer];
+}
+
+@end
+
+#pragma mark - WGRSSIGraphView
+
 @interface WGRSSIGraphView ()
 
 @property (nonatomic, strong) NSArray<UIColor *> *lineColors;
 @property (nonatomic, strong) UILabel *titleLabel;
 @property (nonatomic, strong) UIScrollView *legendScrollView;
+@property (nonatomic, strong) CALayer *plotLayer;      // Graph area, clips the tracks
+@property (nonatomic, strong) NSMapTable<WGNetworkInfo *, WGRSSITrack *> *tracks;
 
 @end
 
+// Offset from the top of a graph of height; RSSI range -30 (best) to -100 (worst)
+static CGFloat WGGraphY(CGFloat rssi, CGFloat height) {
+    CGFloat normalized = (rssi - (-100)) / 70.0; // 0.0 to 1.0
+    normalized = MAX(0, MIN(1, normalized));
+    return height * (1.0 - normalized);
+}
+
+// Adds a bucket's values as a vertical run at its column's centre
+static void WGGraphAddBucket(CGMutablePathRef path, const WGSeriesBucket *bucket, int64_t originIndex,
+                             CGFloat columnWidth, CGFloat height, BOOL *started) {
+    float values[4];
+    size_t count = WGSeriesBucketValues(bucket, values);
+    CGFloat x = ((CGFloat)(bucket->index - originIndex) + 0.5) * columnWidth;
+    for (size_t i = 0; i < count; i++) {
+        CGFloat y = WGGraphY(values[i], height);
+        if (*started) {
+            CGPathAddLineToPoint(path, NULL, x, y);
+        } else {
+            CGPathMoveToPoint(path, NULL, x, y);
+            *started = YES;
+        }
+    }
+}
+
 @implementation WGRSSIGraphView
 
 - (instancetype)initWithFrame:(CGRect)frame {
@@ -40,6 +134,11 @@
     
     _trackedNetworks = [NSMutableArray array];
     _timeWindow = 60.0;
+    _tracks = [NSMapTable strongToStrongObjectsMapTable];
+    
+    _plotLayer = [CALayer layer];
+    _plotLayer.masksToBounds = YES;
+    [self.layer addSublayer:_plotLayer];
     
     _lineColors = @[
         [UIColor systemBlueColor],
@@ -80,10 +179,12 @@
     CGContextRef context = UIGraphicsGetCurrentContext();
     if (!context) return;
     
-    CGFloat graphTop = 80;
-    CGFloat graphBottom = rect.size.height - 30;
-    CGFloat graphLeft = 50;
-    CGFloat graphRight = rect.size.width - 20;
+    // Grid, labels and axes only; the lines live in plotLayer
+    CGRect bounds = self.bounds;
+    CGFloat graphTop = kWGGraphTop;
+    CGFloat graphBottom = bounds.size.height - kWGGraphBottomInset;
+    CGFloat graphLeft = kWGGraphLeft;
+    CGFloat graphRight = bounds.size.width - kWGGraphRightInset;
     CGFloat graphHeight = graphBottom - graphTop;
     CGFloat graphWidth = graphRight - graphLeft;
     
@@ -109,17 +210,6 @@
         [label drawAtPoint:CGPointMake(5, y - 6) withAttributes:attrs];
     }
     
-    // Draw data lines
-    for (NSUInteger i = 0; i < self.trackedNetworks.count; i++) {
-        WGNetworkInfo *network = self.trackedNetworks[i];
-        UIColor *color = self.lineColors[i % self.lineColors.count];
-        
-        [self drawLineForNetwork:network 
-                       withColor:color 
-                       inContext:context 
-                          inRect:CGRectMake(graphLeft, graphTop, graphWidth, graphHeight)];
-    }
-    
     // Draw axes
     CGContextSetStrokeColorWithColor(context, [UIColor labelColor].CGColor);
     CGContextSetLineWidth(context, 1.5);
@@ -137,47 +227,182 @@
     [[NSString stringWithFormat:@"-%.0fs", self.timeWindow] drawAtPoint:CGPointMake(graphLeft - 5, graphBottom + 5) withAttributes:timeAttrs];
 }
 
-- (void)drawLineForNetwork:(WGNetworkInfo *)network 
-                 withColor:(UIColor *)color 
-                 inContext:(CGContextRef)context 
-                    inRect:(CGRect)graphRect {
-    
-    if (network.rssiHistory.count < 2) return;
+- (CGFloat)yPositionForRSSI:(NSInteger)rssi inRect:(CGRect)rect {
+    return rect.origin.y + WGGraphY(rssi, rect.size.height);
+}
+
+#pragma mark - Plot
+
+- (CGRect)graphRect {
+    CGSize size = self.bounds.size;
+    return CGRectMake(kWGGraphLeft, kWGGraphTop,
+                      MAX(size.width - kWGGraphLeft - kWGGraphRightInset, 1),
+                      MAX(size.height - kWGGraphTop - kWGGraphBottomInset, 1));
+}
+
+// One bucket per point of graph width
+- (uint32_t)columns {
+    return (uint32_t)MAX(round([self graphRect].size.width), 1);
+}
+
+- (void)layoutSubviews {
+    [super layoutSubviews];
     
-    CGContextSetStrokeColorWithColor(context, color.CGColor);
-    CGContextSetLineWidth(context, 2.0);
-    CGContextSetLineCap(context, kCGLineCapRound);
-    CGContextSetLineJoin(context, kCGLineJoinRound);
+    CGRect graphRect = [self graphRect];
+    if (!CGRectEqualToRect(self.plotLayer.frame, graphRect)) {
+        [CATransaction begin];
+        [CATransaction setDisableActions:YES];
+        self.plotLayer.frame = graphRect;
+        [CATransaction commit];
+        [self setNeedsDisplay];
+        [self refreshTracksIngesting:@[]];
+    }
+}
+
+- (void)setTimeWindow:(NSTimeInterval)timeWindow {
+    _timeWindow = MAX(timeWindow, 1);
+    [self setNeedsDisplay];
+    [self refreshTracksIngesting:@[]];
+}
+
+// Matches tracks to trackedNetworks, pulls new samples from networks,
+// extends or rebuilds each cached path and slides every track to now
+- (void)refreshTracksIngesting:(NSArray<WGNetworkInfo *> *)networks {
+    CGRect graphRect = [self graphRect];
+    uint32_t columns = [self columns];
+    NSTimeInterval now = [[NSDate date] timeIntervalSince1970];
     
-    NSDate *now = [NSDate date];
-    BOOL started = NO;
+    [CATransaction begin];
+    [CATransaction setDisableActions:YES];
+    [self syncTracks];
     
-    for (NSUInteger i = 0; i < network.rssiHistory.count; i++) {
-        NSNumber *rssi = network.rssiHistory[i];
-        NSDate *timestamp = network.rssiTimestamps[i];
-        
-        NSTimeInterval age = [now timeIntervalSinceDate:timestamp];
-        if (age > self.timeWindow) continue;
+    for (NSUInteger i = 0; i < self.trackedNetworks.count; i++) {
+        WGNetworkInfo *network = self.trackedNetworks[i];
+        WGRSSITrack *track = [self.tracks objectForKey:network];
+        CGColorRef color = self.lineColors[i % self.lineColors.count].CGColor;
+        track.pathLayer.strokeColor = color;
+        track.tailLayer.strokeColor = color;
         
-        CGFloat x = graphRect.origin.x + graphRect.size.width * (1.0 - age / self.timeWindow);
-        CGFloat y = [self yPositionForRSSI:rssi.integerValue inRect:graphRect];
+        BOOL rebuild = !CGSizeEqualToSize(track.builtSize, graphRect.size);
+        if (track->_series.columns != columns || track->_series.window != self.timeWindow) {
+            WGSeriesSetResolution(&track->_series, self.timeWindow, columns);
+            rebuild = YES;
+        }
+        BOOL changed = [networks indexOfObjectIdenticalTo:network] != NSNotFound &&
+                       [self ingestSamplesFromNetwork:network intoTrack:track];
+        track.trimmedSinceBuild += WGSeriesTrim(&track->_series, now);
         
-        if (!started) {
-            CGContextMoveToPoint(context, x, y);
-            started = YES;
-        } else {
-            CGContextAddLineToPoint(context, x, y);
+        // Trimmed buckets stay in the path (clipped) until they outnumber the visible ones
+        if (rebuild || track.trimmedSinceBuild > columns) {
+            [self rebuildTrack:track size:graphRect.size];
+        } else if (changed) {
+            [self extendTrack:track force:NO];
+        }
+        [self positionTrack:track now:now];
+    }
+    [CATransaction commit];
+}
+
+- (void)syncTracks {
+    for (WGNetworkInfo *network in [[self.tracks keyEnumerator] allObjects]) {
+        if ([self.trackedNetworks indexOfObjectIdenticalTo:network] == NSNotFound) {
+            [[self.tracks objectForKey:network] removeLayers];
+            [self.tracks removeObjectForKey:network];
         }
     }
+    for (WGNetworkInfo *network in self.trackedNetworks) {
+        if (![self.tracks objectForKey:network]) {
+            WGRSSITrack *track = [[WGRSSITrack alloc] initWithNetwork:network
+                                                               window:self.timeWindow
+                                                              columns:[self columns]];
+            [self.plotLayer addSublayer:track.pathLayer];
+            [self.plotLayer addSublayer:track.tailLayer];
+            [self.tracks setObject:track forKey:network];
+            [self ingestSamplesFromNetwork:network intoTrack:track];
+        }
+    }
+}
+
+// Appends the samples newer than the series' newest; returns whether any were
+- (BOOL)ingestSamplesFromNetwork:(WGNetworkInfo *)network intoTrack:(WGRSSITrack *)track {
+    WGRSSISample samples[WG_RSSI_HISTORY_CAPACITY];
+    NSUInteger count = [network getRSSISamples:samples maxCount:WG_RSSI_HISTORY_CAPACITY];
+    BOOL empty = WGSeriesCount(&track->_series) == 0;
+    double last = WGSeriesLastTime(&track->_series);
     
-    CGContextStrokePath(context);
+    BOOL added = NO;
+    for (NSUInteger i = 0; i < count; i++) {
+        if (empty || samples[i].timestamp > last) {
+            added = WGSeriesAppend(&track->_series, samples[i].timestamp, samples[i].rssi) || added;
+        }
+    }
+    return added;
 }
 
-- (CGFloat)yPositionForRSSI:(NSInteger)rssi inRect:(CGRect)rect {
-    // RSSI range: -30 (best) to -100 (worst)
-    CGFloat normalized = (rssi - (-100)) / 70.0; // 0.0 to 1.0
-    normalized = MAX(0, MIN(1, normalized));
-    return rect.origin.y + rect.size.height * (1.0 - normalized);
+- (void)rebuildTrack:(WGRSSITrack *)track size:(CGSize)size {
+    if (track.path) {
+        CGPathRelease(track.path);
+    }
+    track.path = CGPathCreateMutable();
+    track.pathThrough = INT64_MIN;
+    track.trimmedSinceBuild = 0;
+    track.builtSize = size;
+    track.originIndex = WGSeriesBucketCount(&track->_series) ? WGSeriesBucketAt(&track->_series, 0)->index : 0;
+    
+    CGRect bounds = CGRectMake(0, 0, size.width, size.height);
+    track.pathLayer.bounds = bounds;
+    track.tailLayer.bounds = bounds;
+    [self extendTrack:track force:YES];
+}
+
+// Appends newly finished buckets to the cached path and redraws the tail
+// (the open bucket, joined to the path's last point)
+- (void)extendTrack:(WGRSSITrack *)track force:(BOOL)force {
+    const WGSeries *series = &track->_series;
+    size_t count = WGSeriesBucketCount(series);
+    CGFloat columnWidth = track.builtSize.width / series->columns;
+    CGFloat height = track.builtSize.height;
+    
+    size_t first = count > 0 ? count - 1 : 0;
+    while (first > 0 && WGSeriesBucketAt(series, first - 1)->index > track.pathThrough) {
+        first--;
+    }
+    BOOL started = !CGPathIsEmpty(track.path);
+    for (size_t i = first; i + 1 < count; i++) {
+        const WGSeriesBucket *bucket = WGSeriesBucketAt(series, i);
+        WGGraphAddBucket(track.path, bucket, track.originIndex, columnWidth, height, &started);
+        track.pathThrough = bucket->index;
+    }
+    if (force || first + 1 < count) {
+        CGPathRef path = CGPathCreateCopy(track.path);
+        track.pathLayer.path = path;
+        CGPathRelease(path);
+    }
+    
+    CGMutablePathRef tail = CGPathCreateMutable();
+    if (count > 0) {
+        BOOL tailStarted = NO;
+        if (started) {
+            CGPoint joint = CGPathGetCurrentPoint(track.path);
+            CGPathMoveToPoint(tail, NULL, joint.x, joint.y);
+            tailStarted = YES;
+        }
+        WGGraphAddBucket(tail, WGSeriesBucketAt(series, count - 1), track.originIndex, columnWidth, height,
+                         &tailStarted);
+    }
+    track.tailLayer.path = tail;
+    CGPathRelease(tail);
+}
+
+// Paths are in bucket space from originIndex; now sits at the right edge
+- (void)positionTrack:(WGRSSITrack *)track now:(NSTimeInterval)now {
+    const WGSeries *series = &track->_series;
+    CGFloat columnWidth = track.builtSize.width / series->columns;
+    CGFloat offset = track.builtSize.width +
+                     ((double)track.originIndex - WGSeriesBucketPosition(series, now)) * columnWidth;
+    CGAffineTransform transform = CGAffineTransformMakeTranslation(offset, 0);
+    track.pathLayer.affineTransform = transform;
+    track.tailLayer.affineTransform = transform;
 }
 
 #pragma mark - Public Methods
@@ -186,26 +411,27 @@
     if (![self.trackedNetworks containsObject:network]) {
         [self.trackedNetworks addObject:network];
         [self updateLegend];
-        [self setNeedsDisplay];
+        [self refreshTracksIngesting:@[network]];
     }
 }
 
 - (void)stopTrackingNetwork:(WGNetworkInfo *)network {
     [self.trackedNetworks removeObject:network];
     [self updateLegend];
-    [self setNeedsDisplay];
+    [self refreshTracksIngesting:@[]];
 }
 
+// Only this network's track changes; the view itself is not redrawn
 - (void)updateNetwork:(WGNetworkInfo *)network {
     if ([self.trackedNetworks containsObject:network]) {
-        [self setNeedsDisplay];
+        [self refreshTracksIngesting:@[network]];
     }
 }
 
 - (void)clearAll {
     [self.trackedNetworks removeAllObjects];
     [self updateLegend];
-    [self setNeedsDisplay];
+    [self refreshTracksIngesting:@[]];
 }
 
 - (void)updateLegend {
@@ -347,8 +347,9 @@ typedef NS_ENUM(NSInteger, WGSettingsSection) {
     [alert addAction:[UIAlertAction actionWithTitle:@"Start Simulation" 
                                               style:UIAlertActionStyleDefault 
                                             handler:^(UIAlertAction *action) {
-        [self.simulationEngine startSimulation:scenario];
-        [self showSimulationProgress];
+        if ([self.simulationEngine startSimulation:scenario]) {
+            [self showSimulationProgress];
+        }
     }]];
     
     [alert addAction:[UIAlertAction actionWithTitle:@"Cancel" style:UIAlertActionStyleCancel handler:nil]];
@@ -418,10 +419,14 @@ typedef NS_ENUM(NSInteger, WGSettingsSection) {
 }
 
 - (void)showAuditLog {
-    NSArray *entries = self.auditLogger.allEntries;
+    // Newest page only; the full history is in the export
+    WGAuditQuery *query = [[WGAuditQuery alloc] init];
+    query.newestFirst = YES;
+    query.limit = 200;
+    NSArray<WGAuditLogEntry *> *entries = [self.auditLogger entriesMatchingQuery:query].objects;
     
     NSMutableString *logText = [NSMutableString string];
-    for (WGAuditLogEntry *entry in [entries reverseObjectEnumerator]) {
+    for (WGAuditLogEntry *entry in entries) {
         [logText appendFormat:@"[%@] %@: %@\n", 
          entry.timestamp, entry.eventType, entry.details ?: @""];
     }
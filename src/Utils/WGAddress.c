@@ -0,0 +1,99 @@
+/*
+ * WGAddress.c - Packed MAC / IPv4 Address Values Implementation
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ */
+
+#include "WGAddress.h"
+
+#include <stddef.h>
+
+#pragma mark - Formatting
+
+void WGMACFormat(WGMACAddress mac, char out[WG_MAC_STRLEN]) {
+    static const char hex[] = "0123456789ABCDEF";
+    for (int b = 0; b < 6; b++) {
+        uint8_t octet = (uint8_t)(mac >> (40 - 8 * b));
+        out[b * 3] = hex[octet >> 4];
+        out[b * 3 + 1] = hex[octet & 0x0F];
+        out[b * 3 + 2] = (b < 5) ? ':' : '\0';
+    }
+}
+
+void WGIPv4Format(WGIPv4Address ip, char out[WG_IPV4_STRLEN]) {
+    char *p = out;
+    for (int b = 0; b < 4; b++) {
+        unsigned octet = (ip >> (24 - 8 * b)) & 0xFF;
+        if (octet >= 100) {
+            *p++ = (char)('0' + octet / 100);
+        }
+        if (octet >= 10) {
+            *p++ = (char)('0' + (octet / 10) % 10);
+        }
+        *p++ = (char)('0' + octet % 10);
+        if (b < 3) {
+            *p++ = '.';
+        }
+    }
+    *p = '\0';
+}
+
+#pragma mark - Parsing
+
+static int WGHexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+bool WGMACParse(const char *str, WGMACAddress *mac) {
+    if (!str) {
+        return false;
+    }
+
+    uint64_t value = 0;
+    for (int b = 0; b < 6; b++) {
+        // One or two digits per octet (Apple APIs drop leading zeros)
+        int octet = WGHexValue(*str++);
+        if (octet < 0) {
+            return false;
+        }
+        int lo = WGHexValue(*str);
+        if (lo >= 0) {
+            octet = octet << 4 | lo;
+            str++;
+        }
+        char separator = *str++;
+        if (b < 5 ? (separator != ':' && separator != '-') : separator != '\0') {
+            return false;
+        }
+        value = (value << 8) | (uint64_t)octet;
+    }
+
+    *mac = value;
+    return true;
+}
+
+bool WGIPv4Parse(const char *str, WGIPv4Address *ip) {
+    if (!str) {
+        return false;
+    }
+
+    uint32_t value = 0;
+    for (int b = 0; b < 4; b++) {
+        unsigned octet = 0;
+        int digits = 0;
+        while (*str >= '0' && *str <= '9' && digits < 3) {
+            octet = octet * 10 + (unsigned)(*str++ - '0');
+            digits++;
+        }
+        if (digits == 0 || octet > 255 || *str != (b < 3 ? '.' : '\0')) {
+            return false;
+        }
+        str++;
+        value = (value << 8) | octet;
+    }
+
+    *ip = value;
+    return true;
+}
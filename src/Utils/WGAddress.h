@@ -0,0 +1,72 @@
+/*
+ * WGAddress.h - Packed MAC / IPv4 Address Values
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * Fixed-width value types used as cache keys throughout the scanner and
+ * detector, with allocation-free parse/format routines. Strings are only
+ * produced at the UI/export boundary (the NSString helpers below).
+ */
+
+#ifndef WG_ADDRESS_H
+#define WG_ADDRESS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef uint64_t WGMACAddress;      // 48-bit MAC, first octet in bits 40-47
+typedef uint32_t WGIPv4Address;     // Host byte order
+
+#define WG_MAC_STRLEN   18  // "AA:BB:CC:DD:EE:FF" + NUL
+#define WG_IPV4_STRLEN  16  // "255.255.255.255" + NUL
+
+// Formatting - MACs are upper-case, colon-separated
+void WGMACFormat(WGMACAddress mac, char out[WG_MAC_STRLEN]);
+void WGIPv4Format(WGIPv4Address ip, char out[WG_IPV4_STRLEN]);
+
+// Parsing - MAC accepts ':' or '-' separators, either case, and one- or
+// two-digit octets; IPv4 accepts strict dotted quads only. Nothing is
+// written on failure.
+bool WGMACParse(const char *str, WGMACAddress *mac);
+bool WGIPv4Parse(const char *str, WGIPv4Address *ip);
+
+// Multicast (and broadcast) MACs have the I/G bit of the first octet set
+static inline bool WGMACIsMulticast(WGMACAddress mac) {
+    return ((mac >> 40) & 0x01) != 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#ifdef __OBJC__
+#import <Foundation/Foundation.h>
+
+static inline NSString *WGStringFromMAC(WGMACAddress mac) {
+    char buffer[WG_MAC_STRLEN];
+    WGMACFormat(mac, buffer);
+    return [NSString stringWithUTF8String:buffer];
+}
+
+static inline NSString *WGStringFromIPv4(WGIPv4Address ip) {
+    char buffer[WG_IPV4_STRLEN];
+    WGIPv4Format(ip, buffer);
+    return [NSString stringWithUTF8String:buffer];
+}
+
+// 0 when the string is nil or malformed
+static inline WGMACAddress WGMACFromString(NSString *mac) {
+    WGMACAddress value = 0;
+    return WGMACParse(mac.UTF8String, &value) ? value : 0;
+}
+
+static inline WGIPv4Address WGIPv4FromString(NSString *ip) {
+    WGIPv4Address value = 0;
+    return WGIPv4Parse(ip.UTF8String, &value) ? value : 0;
+}
+#endif
+
+#endif /* WG_ADDRESS_H */
@@ -0,0 +1,34 @@
+/*
+ * WGAddressMap.h - Object Map Keyed by Packed Addresses
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * Objects stored densely in an array, located through a WGHashMap from
+ * the packed key (WGMACAddress / WGIPv4Address) to the array slot, so
+ * lookups hash one integer instead of an NSString or NSNumber. Removal
+ * swaps the last object into the hole. Not thread-safe; owners confine
+ * access to one queue.
+ */
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface WGAddressMap<ObjectType> : NSObject <NSFastEnumeration>
+
+@property (nonatomic, readonly) NSUInteger count;
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity NS_DESIGNATED_INITIALIZER;
+- (instancetype)init;
+
+// Keys are any uint64_t except UINT64_MAX
+- (nullable ObjectType)objectForKey:(uint64_t)key;
+- (void)setObject:(ObjectType)object forKey:(uint64_t)key;
+- (void)removeObjectForKey:(uint64_t)key;
+- (void)removeAllObjects;
+
+// Copy-on-read; order is insertion order until the first removal
+- (NSArray<ObjectType> *)allObjects;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,100 @@
+/*
+ * WGAddressMap.m - Object Map Keyed by Packed Addresses Implementation
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ */
+
+#import "WGAddressMap.h"
+#import "WGHashMap.h"
+
+@implementation WGAddressMap {
+    WGHashMap _index;           // key -> slot in _objects
+    NSMutableArray *_objects;
+    NSMutableData *_keys;       // uint64_t per slot, for swap-removal
+}
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity {
+    self = [super init];
+    if (self) {
+        if (!WGHashMapInit(&_index, MAX(capacity, 16))) {
+            return nil;
+        }
+        _objects = [NSMutableArray arrayWithCapacity:capacity];
+        _keys = [NSMutableData dataWithCapacity:capacity * sizeof(uint64_t)];
+    }
+    return self;
+}
+
+- (instancetype)init {
+    return [self initWithCapacity:64];
+}
+
+- (void)dealloc {
+    WGHashMapFree(&_index);
+}
+
+- (NSUInteger)count {
+    return _objects.count;
+}
+
+#pragma mark - Access
+
+- (id)objectForKey:(uint64_t)key {
+    uint64_t *slot = WGHashMapFind(&_index, key);
+    return slot ? _objects[(NSUInteger)*slot] : nil;
+}
+
+- (void)setObject:(id)object forKey:(uint64_t)key {
+    bool inserted = false;
+    uint64_t *slot = WGHashMapInsert(&_index, key, &inserted);
+    if (!slot) {
+        return;
+    }
+    
+    if (inserted) {
+        *slot = _objects.count;
+        [_objects addObject:object];
+        [_keys appendBytes:&key length:sizeof(key)];
+    } else {
+        _objects[(NSUInteger)*slot] = object;
+    }
+}
+
+- (void)removeObjectForKey:(uint64_t)key {
+    uint64_t *slot = WGHashMapFind(&_index, key);
+    if (!slot) {
+        return;
+    }
+    
+    NSUInteger hole = (NSUInteger)*slot;
+    NSUInteger last = _objects.count - 1;
+    uint64_t *keys = _keys.mutableBytes;
+    WGHashMapRemove(&_index, key);
+    
+    if (hole != last) {
+        _objects[hole] = _objects[last];
+        keys[hole] = keys[last];
+        *WGHashMapFind(&_index, keys[hole]) = hole;
+    }
+    [_objects removeLastObject];
+    _keys.length = last * sizeof(uint64_t);
+}
+
+- (void)removeAllObjects {
+    WGHashMapClear(&_index);
+    [_objects removeAllObjects];
+    _keys.length = 0;
+}
+
+- (NSArray *)allObjects {
+    return [_objects copy];
+}
+
+#pragma mark - NSFastEnumeration
+
+- (NSUInteger)countByEnumeratingWithState:(NSFastEnumerationState *)state
+                                  objects:(id __unsafe_unretained _Nullable [_Nonnull])buffer
+                                    count:(NSUInteger)len {
+    return [_objects countByEnumeratingWithState:state objects:buffer count:len];
+}
+
+@end
@@ -0,0 +1,227 @@
+/*
+ * WGCrypto.c - Portable Crypto Primitives Implementation
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ */
+
+#include "WGCrypto.h"
+
+#include <string.h>
+
+#if defined(__APPLE__)
+#include <CommonCrypto/CommonCrypto.h>
+#include <Security/Security.h>
+#else
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/rand.h>
+#endif
+
+#pragma mark - Randomness / Key Derivation
+
+bool WGCryptoRandomBytes(void *buf, size_t len) {
+#if defined(__APPLE__)
+    return SecRandomCopyBytes(kSecRandomDefault, len, buf) == errSecSuccess;
+#else
+    return RAND_bytes(buf, (int)len) == 1;
+#endif
+}
+
+bool WGCryptoDeriveKey(const void *password, size_t passwordLength,
+                       const uint8_t *salt, size_t saltLength, uint32_t rounds,
+                       uint8_t *key, size_t keyLength) {
+#if defined(__APPLE__)
+    return CCKeyDerivationPBKDF(kCCPBKDF2, password, passwordLength, salt, saltLength,
+                                kCCPRFHmacAlgSHA256, rounds, key, keyLength) == kCCSuccess;
+#else
+    return PKCS5_PBKDF2_HMAC(password, (int)passwordLength, salt, (int)saltLength, (int)rounds,
+                             EVP_sha256(), (int)keyLength, key) == 1;
+#endif
+}
+
+void WGCryptoHMAC(const void *key, size_t keyLength, const void *data, size_t dataLength,
+                  uint8_t out[WG_CRYPTO_HASH_LENGTH]) {
+#if defined(__APPLE__)
+    CCHmac(kCCHmacAlgSHA256, key, keyLength, data, dataLength, out);
+#else
+    unsigned int outLength = WG_CRYPTO_HASH_LENGTH;
+    HMAC(EVP_sha256(), key, (int)keyLength, data, dataLength, out, &outLength);
+#endif
+}
+
+bool WGCryptoHKDF(const uint8_t *ikm, size_t ikmLength, const uint8_t *salt, size_t saltLength,
+                  const void *info, size_t infoLength, uint8_t *out, size_t outLength) {
+    if (infoLength > WG_CRYPTO_HKDF_INFO_MAX || outLength > 255 * WG_CRYPTO_HASH_LENGTH) {
+        return false;
+    }
+
+    // Extract
+    uint8_t prk[WG_CRYPTO_HASH_LENGTH];
+    WGCryptoHMAC(salt, saltLength, ikm, ikmLength, prk);
+
+    // Expand: T(i) = HMAC(PRK, T(i-1) || info || i)
+    uint8_t block[WG_CRYPTO_HASH_LENGTH + WG_CRYPTO_HKDF_INFO_MAX + 1];
+    uint8_t t[WG_CRYPTO_HASH_LENGTH];
+    size_t tLength = 0;
+    for (uint8_t counter = 1; outLength > 0; counter++) {
+        memcpy(block, t, tLength);
+        memcpy(block + tLength, info, infoLength);
+        block[tLength + infoLength] = counter;
+        WGCryptoHMAC(prk, sizeof(prk), block, tLength + infoLength + 1, t);
+        tLength = WG_CRYPTO_HASH_LENGTH;
+
+        size_t n = outLength < tLength ? outLength : tLength;
+        memcpy(out, t, n);
+        out += n;
+        outLength -= n;
+    }
+
+    WGCryptoWipe(prk, sizeof(prk));
+    WGCryptoWipe(t, sizeof(t));
+    WGCryptoWipe(block, sizeof(block));
+    return true;
+}
+
+void WGCryptoWipe(void *buf, size_t len) {
+    volatile uint8_t *p = buf;
+    while (len--) {
+        *p++ = 0;
+    }
+}
+
+#pragma mark - Cipher
+
+bool WGCipherInit(WGCipher *cipher, WGCipherMode mode, const uint8_t key[WG_CRYPTO_KEY_LENGTH],
+                  const uint8_t iv[WG_CRYPTO_IV_LENGTH]) {
+    cipher->context = NULL;
+    cipher->mode = mode;
+
+#if defined(__APPLE__)
+    CCCryptorRef cryptor = NULL;
+    CCCryptorStatus status = CCCryptorCreate(mode == WGCipherEncrypt ? kCCEncrypt : kCCDecrypt,
+                                             kCCAlgorithmAES128, kCCOptionPKCS7Padding,
+                                             key, WG_CRYPTO_KEY_LENGTH, iv, &cryptor);
+    if (status != kCCSuccess) {
+        return false;
+    }
+    cipher->context = cryptor;
+#else
+    EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
+    if (!ctx) {
+        return false;
+    }
+    if (EVP_CipherInit_ex(ctx, EVP_aes_256_cbc(), NULL, key, iv, mode == WGCipherEncrypt) != 1) {
+        EVP_CIPHER_CTX_free(ctx);
+        return false;
+    }
+    cipher->context = ctx;
+#endif
+    return true;
+}
+
+bool WGCipherUpdate(WGCipher *cipher, const void *in, size_t inLength,
+                    void *out, size_t outCapacity, size_t *outLength) {
+    *outLength = 0;
+    if (!cipher->context || outCapacity < inLength + WG_CRYPTO_BLOCK_SIZE) {
+        return false;
+    }
+#if defined(__APPLE__)
+    return CCCryptorUpdate(cipher->context, in, inLength, out, outCapacity, outLength) == kCCSuccess;
+#else
+    int written = 0;
+    if (EVP_CipherUpdate(cipher->context, out, &written, in, (int)inLength) != 1) {
+        return false;
+    }
+    *outLength = (size_t)written;
+    return true;
+#endif
+}
+
+bool WGCipherFinal(WGCipher *cipher, void *out, size_t outCapacity, size_t *outLength) {
+    *outLength = 0;
+    if (!cipher->context || outCapacity < WG_CRYPTO_BLOCK_SIZE) {
+        return false;
+    }
+#if defined(__APPLE__)
+    return CCCryptorFinal(cipher->context, out, outCapacity, outLength) == kCCSuccess;
+#else
+    int written = 0;
+    if (EVP_CipherFinal_ex(cipher->context, out, &written) != 1) {
+        return false;
+    }
+    *outLength = (size_t)written;
+    return true;
+#endif
+}
+
+void WGCipherFree(WGCipher *cipher) {
+    if (!cipher->context) {
+        return;
+    }
+#if defined(__APPLE__)
+    CCCryptorRelease(cipher->context);
+#else
+    EVP_CIPHER_CTX_free(cipher->context);
+#endif
+    cipher->context = NULL;
+}
+
+#pragma mark - One-Shot
+
+static bool WGCryptoApply(WGCipherMode mode, const uint8_t key[WG_CRYPTO_KEY_LENGTH],
+                          const uint8_t iv[WG_CRYPTO_IV_LENGTH], const void *in, size_t inLength,
+                          uint8_t *out, size_t outCapacity, size_t *outLength) {
+    WGCipher cipher;
+    size_t updated = 0;
+    size_t finished = 0;
+    bool ok = WGCipherInit(&cipher, mode, key, iv) &&
+              WGCipherUpdate(&cipher, in, inLength, out, outCapacity, &updated) &&
+              WGCipherFinal(&cipher, out + updated, outCapacity - updated, &finished);
+    WGCipherFree(&cipher);
+    *outLength = ok ? updated + finished : 0;
+    return ok;
+}
+
+bool WGCryptoSeal(const void *password, size_t passwordLength, const void *in, size_t inLength,
+                  void *out, size_t outCapacity, size_t *outLength) {
+    *outLength = 0;
+    if (outCapacity < WG_CRYPTO_SEALED_MAX(inLength)) {
+        return false;
+    }
+
+    uint8_t *salt = out;
+    uint8_t *iv = salt + WG_CRYPTO_SALT_LENGTH;
+    uint8_t *body = iv + WG_CRYPTO_IV_LENGTH;
+    uint8_t key[WG_CRYPTO_KEY_LENGTH];
+    size_t bodyLength = 0;
+    bool ok = WGCryptoRandomBytes(salt, WG_CRYPTO_SALT_LENGTH) &&
+              WGCryptoRandomBytes(iv, WG_CRYPTO_IV_LENGTH) &&
+              WGCryptoDeriveKey(password, passwordLength, salt, WG_CRYPTO_SALT_LENGTH,
+                                WG_CRYPTO_PBKDF_ROUNDS, key, sizeof(key)) &&
+              WGCryptoApply(WGCipherEncrypt, key, iv, in, inLength,
+                            body, outCapacity - (size_t)(body - salt), &bodyLength);
+    WGCryptoWipe(key, sizeof(key));
+
+    if (ok) {
+        *outLength = WG_CRYPTO_SALT_LENGTH + WG_CRYPTO_IV_LENGTH + bodyLength;
+    }
+    return ok;
+}
+
+bool WGCryptoOpen(const void *password, size_t passwordLength, const void *in, size_t inLength,
+                  void *out, size_t outCapacity, size_t *outLength) {
+    *outLength = 0;
+    size_t header = WG_CRYPTO_SALT_LENGTH + WG_CRYPTO_IV_LENGTH;
+    if (inLength < header || outCapacity < inLength) {
+        return false;
+    }
+
+    const uint8_t *salt = in;
+    const uint8_t *iv = salt + WG_CRYPTO_SALT_LENGTH;
+    uint8_t key[WG_CRYPTO_KEY_LENGTH];
+    bool ok = WGCryptoDeriveKey(password, passwordLength, salt, WG_CRYPTO_SALT_LENGTH,
+                                WG_CRYPTO_PBKDF_ROUNDS, key, sizeof(key)) &&
+              WGCryptoApply(WGCipherDecrypt, key, iv, salt + header, inLength - header,
+                            out, outCapacity, outLength);
+    WGCryptoWipe(key, sizeof(key));
+    return ok;
+}
@@ -0,0 +1,83 @@
+/*
+ * WGCrypto.h - Portable Crypto Primitives
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * AES-256-CBC (PKCS#7) as an incremental cipher, PBKDF2-HMAC-SHA256,
+ * HKDF-SHA256 and secure random bytes. CommonCrypto/Security on Apple
+ * platforms, OpenSSL libcrypto elsewhere, so encrypted exports can be
+ * produced and verified on a Linux host.
+ */
+
+#ifndef WG_CRYPTO_H
+#define WG_CRYPTO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WG_CRYPTO_SALT_LENGTH   32
+#define WG_CRYPTO_IV_LENGTH     16
+#define WG_CRYPTO_KEY_LENGTH    32      // AES-256
+#define WG_CRYPTO_BLOCK_SIZE    16
+#define WG_CRYPTO_PBKDF_ROUNDS  100000
+#define WG_CRYPTO_HASH_LENGTH   32      // SHA-256
+#define WG_CRYPTO_HKDF_INFO_MAX 128
+
+typedef enum {
+    WGCipherEncrypt = 0,
+    WGCipherDecrypt
+} WGCipherMode;
+
+// Incremental cipher; the backend context is opaque
+typedef struct {
+    void *context;
+    WGCipherMode mode;
+} WGCipher;
+
+// Randomness / key derivation
+bool WGCryptoRandomBytes(void *buf, size_t len);
+bool WGCryptoDeriveKey(const void *password, size_t passwordLength,
+                       const uint8_t *salt, size_t saltLength, uint32_t rounds,
+                       uint8_t *key, size_t keyLength);
+
+// HMAC-SHA256 and RFC 5869 HKDF-SHA256 (cheap per-file subkeys from a
+// stretched master key). info must be at most WG_CRYPTO_HKDF_INFO_MAX
+// bytes; outLength at most 255 * WG_CRYPTO_HASH_LENGTH.
+void WGCryptoHMAC(const void *key, size_t keyLength, const void *data, size_t dataLength,
+                  uint8_t out[WG_CRYPTO_HASH_LENGTH]);
+bool WGCryptoHKDF(const uint8_t *ikm, size_t ikmLength, const uint8_t *salt, size_t saltLength,
+                  const void *info, size_t infoLength, uint8_t *out, size_t outLength);
+
+// Cipher lifecycle. Update may emit up to inLen + WG_CRYPTO_BLOCK_SIZE
+// bytes; Final at most WG_CRYPTO_BLOCK_SIZE. Final fails on bad padding
+// when decrypting (wrong password or truncated data).
+bool WGCipherInit(WGCipher *cipher, WGCipherMode mode, const uint8_t key[WG_CRYPTO_KEY_LENGTH],
+                  const uint8_t iv[WG_CRYPTO_IV_LENGTH]);
+bool WGCipherUpdate(WGCipher *cipher, const void *in, size_t inLength,
+                    void *out, size_t outCapacity, size_t *outLength);
+bool WGCipherFinal(WGCipher *cipher, void *out, size_t outCapacity, size_t *outLength);
+void WGCipherFree(WGCipher *cipher);
+
+// One-shot password encryption in the WGEncryption in-memory format:
+// salt || iv || ciphertext, keyed by PBKDF2 at WG_CRYPTO_PBKDF_ROUNDS.
+// Sealing needs WG_CRYPTO_SEALED_MAX(inLength) output bytes, opening
+// inLength. Open fails on short input or bad padding.
+#define WG_CRYPTO_SEALED_MAX(n) (WG_CRYPTO_SALT_LENGTH + WG_CRYPTO_IV_LENGTH + (n) + WG_CRYPTO_BLOCK_SIZE)
+
+bool WGCryptoSeal(const void *password, size_t passwordLength, const void *in, size_t inLength,
+                  void *out, size_t outCapacity, size_t *outLength);
+bool WGCryptoOpen(const void *password, size_t passwordLength, const void *in, size_t inLength,
+                  void *out, size_t outCapacity, size_t *outLength);
+
+// Best-effort wipe of key material
+void WGCryptoWipe(void *buf, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WG_CRYPTO_H */
@@ -0,0 +1,378 @@
+/*
+ * WGCryptoStream.c - Chunked File Streams Implementation
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ */
+
+#include "WGCryptoStream.h"
+#include "WGMetrics.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define WG_STREAM_OUTPUT_SIZE (WG_STREAM_CHUNK_SIZE + WG_CRYPTO_BLOCK_SIZE)
+
+#pragma mark - I/O Helpers
+
+static bool WGWriteFully(int fd, const uint8_t *data, size_t length, int *sysError) {
+    while (length > 0) {
+        ssize_t n = write(fd, data, length);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            *sysError = errno;
+            return false;
+        }
+        data += n;
+        length -= (size_t)n;
+    }
+    return true;
+}
+
+// Fills buf unless EOF comes first; returns bytes read or -1
+static ssize_t WGReadFully(int fd, uint8_t *buf, size_t length) {
+    size_t total = 0;
+    while (total < length) {
+        ssize_t n = read(fd, buf + total, length - total);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        if (n == 0) {
+            break;
+        }
+        total += (size_t)n;
+    }
+    return (ssize_t)total;
+}
+
+static bool WGStreamFail(WGStreamWriter *writer, WGStreamError error) {
+    if (writer->error == WGStreamErrorNone) {
+        writer->error = error;
+    }
+    return false;
+}
+
+#pragma mark - Writer
+
+#define WG_STREAM_SUBKEY_INFO "WiFiGuard export file key"
+
+static bool WGStreamDeriveFileKey(const WGStreamMasterKey *master, const uint8_t *fileSalt,
+                                  uint8_t key[WG_CRYPTO_KEY_LENGTH]) {
+    return WGCryptoHKDF(master->key, sizeof(master->key), fileSalt, WG_CRYPTO_SALT_LENGTH,
+                        WG_STREAM_SUBKEY_INFO, strlen(WG_STREAM_SUBKEY_INFO), key, WG_CRYPTO_KEY_LENGTH);
+}
+
+bool WGStreamMasterKeyDerive(WGStreamMasterKey *master, const void *password, size_t passwordLength) {
+    master->valid = WGCryptoRandomBytes(master->salt, sizeof(master->salt)) &&
+                    WGCryptoDeriveKey(password, passwordLength, master->salt, sizeof(master->salt),
+                                      WG_CRYPTO_PBKDF_ROUNDS, master->key, sizeof(master->key));
+    return master->valid;
+}
+
+void WGStreamMasterKeyWipe(WGStreamMasterKey *master) {
+    WGCryptoWipe(master, sizeof(*master));
+}
+
+static bool WGStreamWriterSetup(WGStreamWriter *writer, int fd, bool encrypted) {
+    memset(writer, 0, sizeof(*writer));
+    writer->fd = fd;
+    writer->encrypted = encrypted;
+
+    writer->chunk = malloc(WG_STREAM_CHUNK_SIZE);
+    writer->output = encrypted ? malloc(WG_STREAM_OUTPUT_SIZE) : NULL;
+    if (!writer->chunk || (encrypted && !writer->output)) {
+        return WGStreamFail(writer, WGStreamErrorMemory);
+    }
+    return true;
+}
+
+// Starts the cipher and writes the plaintext header; wipes key
+static bool WGStreamWriterStart(WGStreamWriter *writer, uint8_t key[WG_CRYPTO_KEY_LENGTH],
+                                const uint8_t *iv, const uint8_t *header, size_t headerLength) {
+    bool ok = WGCipherInit(&writer->cipher, WGCipherEncrypt, key, iv);
+    WGCryptoWipe(key, WG_CRYPTO_KEY_LENGTH);
+    if (!ok) {
+        return WGStreamFail(writer, WGStreamErrorCrypto);
+    }
+
+    uint64_t start = WGMetricsNow();
+    if (!WGWriteFully(writer->fd, header, headerLength, &writer->sysError)) {
+        return WGStreamFail(writer, WGStreamErrorIO);
+    }
+    writer->writeNs += WGMetricsNow() - start;
+    writer->bytesOut += headerLength;
+    return true;
+}
+
+bool WGStreamWriterOpen(WGStreamWriter *writer, int fd, const void *password, size_t passwordLength) {
+    if (!WGStreamWriterSetup(writer, fd, password != NULL)) {
+        return false;
+    }
+    if (!writer->encrypted) {
+        return true;
+    }
+
+    uint8_t header[WG_STREAM_HEADER_LENGTH];
+    uint8_t key[WG_CRYPTO_KEY_LENGTH];
+    uint64_t start = WGMetricsNow();
+    if (!WGCryptoRandomBytes(header, sizeof(header)) ||
+        !WGCryptoDeriveKey(password, passwordLength, header, WG_CRYPTO_SALT_LENGTH,
+                           WG_CRYPTO_PBKDF_ROUNDS, key, sizeof(key))) {
+        return WGStreamFail(writer, WGStreamErrorCrypto);
+    }
+    writer->encryptNs += WGMetricsNow() - start;
+
+    return WGStreamWriterStart(writer, key, header + WG_CRYPTO_SALT_LENGTH, header, sizeof(header));
+}
+
+bool WGStreamWriterOpenWithMasterKey(WGStreamWriter *writer, int fd, const WGStreamMasterKey *master) {
+    if (!WGStreamWriterSetup(writer, fd, true)) {
+        return false;
+    }
+    if (!master->valid) {
+        return WGStreamFail(writer, WGStreamErrorCrypto);
+    }
+
+    // magic || masterSalt || fileSalt || iv
+    uint8_t header[WG_STREAM_SESSION_HEADER_LENGTH];
+    uint8_t *fileSalt = header + 4 + WG_CRYPTO_SALT_LENGTH;
+    uint8_t *iv = fileSalt + WG_CRYPTO_SALT_LENGTH;
+    uint8_t key[WG_CRYPTO_KEY_LENGTH];
+
+    memcpy(header, WG_STREAM_SESSION_MAGIC, 4);
+    memcpy(header + 4, master->salt, WG_CRYPTO_SALT_LENGTH);
+    uint64_t start = WGMetricsNow();
+    if (!WGCryptoRandomBytes(fileSalt, WG_CRYPTO_SALT_LENGTH + WG_CRYPTO_IV_LENGTH) ||
+        !WGStreamDeriveFileKey(master, fileSalt, key)) {
+        return WGStreamFail(writer, WGStreamErrorCrypto);
+    }
+    writer->encryptNs += WGMetricsNow() - start;
+
+    return WGStreamWriterStart(writer, key, iv, header, sizeof(header));
+}
+
+static bool WGStreamWriterFlushChunk(WGStreamWriter *writer) {
+    if (writer->chunkLength == 0) {
+        return true;
+    }
+
+    const uint8_t *data = writer->chunk;
+    size_t length = writer->chunkLength;
+    uint64_t start = WGMetricsNow();
+    if (writer->encrypted) {
+        if (!WGCipherUpdate(&writer->cipher, writer->chunk, writer->chunkLength,
+                            writer->output, WG_STREAM_OUTPUT_SIZE, &length)) {
+            return WGStreamFail(writer, WGStreamErrorCrypto);
+        }
+        data = writer->output;
+        uint64_t encrypted = WGMetricsNow();
+        writer->encryptNs += encrypted - start;
+        start = encrypted;
+    }
+
+    if (!WGWriteFully(writer->fd, data, length, &writer->sysError)) {
+        return WGStreamFail(writer, WGStreamErrorIO);
+    }
+    writer->writeNs += WGMetricsNow() - start;
+    writer->bytesOut += length;
+    writer->chunkLength = 0;
+    return true;
+}
+
+bool WGStreamWriterWrite(WGStreamWriter *writer, const void *data, size_t length) {
+    if (writer->error != WGStreamErrorNone) {
+        return false;
+    }
+
+    const uint8_t *bytes = data;
+    writer->bytesIn += length;
+    while (length > 0) {
+        size_t space = WG_STREAM_CHUNK_SIZE - writer->chunkLength;
+        size_t n = length < space ? length : space;
+        memcpy(writer->chunk + writer->chunkLength, bytes, n);
+        writer->chunkLength += n;
+        bytes += n;
+        length -= n;
+
+        if (writer->chunkLength == WG_STREAM_CHUNK_SIZE && !WGStreamWriterFlushChunk(writer)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool WGStreamWriterWriteString(WGStreamWriter *writer, const char *string) {
+    return WGStreamWriterWrite(writer, string, strlen(string));
+}
+
+bool WGStreamWriterFinish(WGStreamWriter *writer) {
+    if (writer->error != WGStreamErrorNone || !WGStreamWriterFlushChunk(writer)) {
+        return false;
+    }
+    if (!writer->encrypted) {
+        return true;
+    }
+
+    size_t length = 0;
+    uint64_t start = WGMetricsNow();
+    if (!WGCipherFinal(&writer->cipher, writer->output, WG_STREAM_OUTPUT_SIZE, &length)) {
+        return WGStreamFail(writer, WGStreamErrorCrypto);
+    }
+    uint64_t encrypted = WGMetricsNow();
+    writer->encryptNs += encrypted - start;
+    if (!WGWriteFully(writer->fd, writer->output, length, &writer->sysError)) {
+        return WGStreamFail(writer, WGStreamErrorIO);
+    }
+    writer->writeNs += WGMetricsNow() - encrypted;
+    writer->bytesOut += length;
+    return true;
+}
+
+void WGStreamWriterFree(WGStreamWriter *writer) {
+    WGCipherFree(&writer->cipher);
+    if (writer->chunk) {
+        WGCryptoWipe(writer->chunk, WG_STREAM_CHUNK_SIZE);
+    }
+    free(writer->chunk);
+    free(writer->output);
+    writer->chunk = NULL;
+    writer->output = NULL;
+}
+
+#pragma mark - Descriptor Transforms
+
+bool WGStreamEncryptFD(int inFD, int outFD, const void *password, size_t passwordLength,
+                       WGStreamError *error) {
+    WGStreamWriter writer;
+    bool ok = WGStreamWriterOpen(&writer, outFD, password, passwordLength);
+
+    while (ok) {
+        // Read straight into the chunk buffer; no intermediate copy
+        ssize_t n = WGReadFully(inFD, writer.chunk, WG_STREAM_CHUNK_SIZE);
+        if (n < 0) {
+            writer.sysError = errno;
+            ok = WGStreamFail(&writer, WGStreamErrorIO);
+            break;
+        }
+        writer.chunkLength = (size_t)n;
+        writer.bytesIn += (uint64_t)n;
+        if ((size_t)n < WG_STREAM_CHUNK_SIZE) {
+            break;
+        }
+        ok = WGStreamWriterFlushChunk(&writer);
+    }
+
+    ok = ok && WGStreamWriterFinish(&writer);
+    if (error) {
+        *error = writer.error;
+    }
+    WGStreamWriterFree(&writer);
+    return ok;
+}
+
+bool WGStreamDecryptFD(int inFD, int outFD, const void *password, size_t passwordLength,
+                       WGStreamMasterKey *cache, WGStreamError *error) {
+    WGStreamError result = WGStreamErrorNone;
+    WGCipher cipher = {0};
+    uint8_t *input = malloc(WG_STREAM_CHUNK_SIZE);
+    uint8_t *output = malloc(WG_STREAM_OUTPUT_SIZE);
+    uint8_t header[WG_STREAM_SESSION_HEADER_LENGTH];
+    uint8_t key[WG_CRYPTO_KEY_LENGTH];
+    const uint8_t *iv;
+    bool keyed;
+    int sysError = 0;
+
+    if (!input || !output) {
+        result = WGStreamErrorMemory;
+        goto done;
+    }
+
+    // Both layouts are at least WG_STREAM_HEADER_LENGTH bytes
+    ssize_t n = WGReadFully(inFD, header, WG_STREAM_HEADER_LENGTH);
+    if (n < 0) {
+        result = WGStreamErrorIO;
+        goto done;
+    }
+    if ((size_t)n < WG_STREAM_HEADER_LENGTH) {
+        result = WGStreamErrorFormat;
+        goto done;
+    }
+
+    if (memcmp(header, WG_STREAM_SESSION_MAGIC, 4) == 0) {
+        size_t rest = WG_STREAM_SESSION_HEADER_LENGTH - WG_STREAM_HEADER_LENGTH;
+        n = WGReadFully(inFD, header + WG_STREAM_HEADER_LENGTH, rest);
+        if (n < 0 || (size_t)n < rest) {
+            result = n < 0 ? WGStreamErrorIO : WGStreamErrorFormat;
+            goto done;
+        }
+
+        WGStreamMasterKey local = {0};
+        WGStreamMasterKey *master = cache ? cache : &local;
+        const uint8_t *masterSalt = header + 4;
+        if (!master->valid || memcmp(master->salt, masterSalt, WG_CRYPTO_SALT_LENGTH) != 0) {
+            memcpy(master->salt, masterSalt, WG_CRYPTO_SALT_LENGTH);
+            master->valid = WGCryptoDeriveKey(password, passwordLength, master->salt, WG_CRYPTO_SALT_LENGTH,
+                                              WG_CRYPTO_PBKDF_ROUNDS, master->key, sizeof(master->key));
+        }
+        keyed = master->valid && WGStreamDeriveFileKey(master, header + 4 + WG_CRYPTO_SALT_LENGTH, key);
+        iv = header + 4 + 2 * WG_CRYPTO_SALT_LENGTH;
+        WGStreamMasterKeyWipe(&local);
+    } else {
+        keyed = WGCryptoDeriveKey(password, passwordLength, header, WG_CRYPTO_SALT_LENGTH,
+                                  WG_CRYPTO_PBKDF_ROUNDS, key, sizeof(key));
+        iv = header + WG_CRYPTO_SALT_LENGTH;
+    }
+
+    keyed = keyed && WGCipherInit(&cipher, WGCipherDecrypt, key, iv);
+    WGCryptoWipe(key, sizeof(key));
+    if (!keyed) {
+        result = WGStreamErrorCrypto;
+        goto done;
+    }
+
+    for (;;) {
+        n = WGReadFully(inFD, input, WG_STREAM_CHUNK_SIZE);
+        if (n < 0) {
+            result = WGStreamErrorIO;
+            goto done;
+        }
+        if (n == 0) {
+            break;
+        }
+        size_t length = 0;
+        if (!WGCipherUpdate(&cipher, input, (size_t)n, output, WG_STREAM_OUTPUT_SIZE, &length)) {
+            result = WGStreamErrorCrypto;
+            goto done;
+        }
+        if (!WGWriteFully(outFD, output, length, &sysError)) {
+            result = WGStreamErrorIO;
+            goto done;
+        }
+    }
+
+    size_t length = 0;
+    if (!WGCipherFinal(&cipher, output, WG_STREAM_OUTPUT_SIZE, &length)) {
+        result = WGStreamErrorFormat;
+        goto done;
+    }
+    if (!WGWriteFully(outFD, output, length, &sysError)) {
+        result = WGStreamErrorIO;
+    }
+
+done:
+    WGCipherFree(&cipher);
+    if (output) {
+        WGCryptoWipe(output, WG_STREAM_OUTPUT_SIZE);
+    }
+    free(input);
+    free(output);
+    if (error) {
+        *error = result;
+    }
+    return result == WGStreamErrorNone;
+}
@@ -0,0 +1,87 @@
+/*
+ * WGCryptoStream.h - Chunked (Optionally Encrypted) File Streams
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * Serializers write into a bounded chunk buffer. Each full chunk goes
+ * through an incremental AES context and straight to a file descriptor,
+ * so memory use is fixed (two chunk buffers) whatever the export size.
+ *
+ * Encrypted layout is unchanged from WGEncryption's one-shot format:
+ * salt(32) || iv(16) || AES-256-CBC/PKCS#7 ciphertext, with the key
+ * derived by PBKDF2-HMAC-SHA256 (100000 rounds).
+ *
+ * Files written under a master key (one PBKDF2 per export session) use
+ * "WGX1" || masterSalt(32) || fileSalt(32) || iv(16) || ciphertext, with
+ * the file key = HKDF-SHA256(masterKey, fileSalt). Decryption detects the
+ * magic; a legacy salt starting with those bytes (2^-32) is not supported.
+ */
+
+#ifndef WG_CRYPTO_STREAM_H
+#define WG_CRYPTO_STREAM_H
+
+#include "WGCrypto.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WG_STREAM_CHUNK_SIZE    (64 * 1024)
+#define WG_STREAM_HEADER_LENGTH (WG_CRYPTO_SALT_LENGTH + WG_CRYPTO_IV_LENGTH)
+#define WG_STREAM_SESSION_MAGIC "WGX1"
+#define WG_STREAM_SESSION_HEADER_LENGTH (4 + 2 * WG_CRYPTO_SALT_LENGTH + WG_CRYPTO_IV_LENGTH)
+
+typedef enum {
+    WGStreamErrorNone = 0,
+    WGStreamErrorIO,            // read/write failed (see sysError)
+    WGStreamErrorCrypto,        // Cipher or key derivation failed
+    WGStreamErrorFormat,        // Truncated header or bad padding (wrong password)
+    WGStreamErrorMemory
+} WGStreamError;
+
+// Stretched password shared by the files of one export
+typedef struct {
+    uint8_t salt[WG_CRYPTO_SALT_LENGTH];
+    uint8_t key[WG_CRYPTO_KEY_LENGTH];
+    bool valid;
+} WGStreamMasterKey;
+
+typedef struct {
+    int fd;                     // Not owned
+    bool encrypted;
+    WGCipher cipher;
+    uint8_t *chunk;
+    size_t chunkLength;
+    uint8_t *output;            // Cipher output, chunk size + one block
+    uint64_t bytesIn;
+    uint64_t bytesOut;
+    uint64_t encryptNs;         // Key setup and cipher time so far
+    uint64_t writeNs;           // Time in write(2) so far
+    WGStreamError error;
+    int sysError;
+} WGStreamWriter;
+
+// Master keys - Derive runs PBKDF2 once with a fresh salt
+bool WGStreamMasterKeyDerive(WGStreamMasterKey *master, const void *password, size_t passwordLength);
+void WGStreamMasterKeyWipe(WGStreamMasterKey *master);
+
+// A NULL password writes plaintext through the same chunking
+bool WGStreamWriterOpen(WGStreamWriter *writer, int fd, const void *password, size_t passwordLength);
+bool WGStreamWriterOpenWithMasterKey(WGStreamWriter *writer, int fd, const WGStreamMasterKey *master);
+bool WGStreamWriterWrite(WGStreamWriter *writer, const void *data, size_t length);
+bool WGStreamWriterWriteString(WGStreamWriter *writer, const char *string);
+bool WGStreamWriterFinish(WGStreamWriter *writer);  // Flushes and pads; call once
+void WGStreamWriterFree(WGStreamWriter *writer);
+
+// Whole-descriptor transforms in constant memory. Decrypt accepts both
+// layouts; cache (optional) keeps the last master key so the files of one
+// session cost a single PBKDF2.
+bool WGStreamEncryptFD(int inFD, int outFD, const void *password, size_t passwordLength,
+                       WGStreamError *error);
+bool WGStreamDecryptFD(int inFD, int outFD, const void *password, size_t passwordLength,
+                       WGStreamMasterKey *cache, WGStreamError *error);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WG_CRYPTO_STREAM_H */
@@ -4,6 +4,7 @@
  */
 
 #import <Foundation/Foundation.h>
+#import "WGCryptoStream.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -18,7 +19,7 @@ NS_ASSUME_NONNULL_BEGIN
                     withPassword:(NSString *)password 
                            error:(NSError **)error;
 
-// File Encryption
+// File Encryption (streamed in fixed-size chunks)
 + (BOOL)encryptFile:(NSString *)inputPath 
            toOutput:(NSString *)outputPath 
        withPassword:(NSString *)password 
@@ -29,6 +30,20 @@ NS_ASSUME_NONNULL_BEGIN
        withPassword:(NSString *)password 
               error:(NSError **)error;
 
+// Streaming output - writes go to a temporary file beside path, which
+// finishStreamingOutput renames into place on success (removes otherwise)
++ (int)openStreamingOutput:(NSString *)path
+             temporaryPath:(NSString * _Nullable * _Nonnull)temporaryPath
+                     error:(NSError **)error;
+
++ (BOOL)finishStreamingOutput:(int)fd
+                temporaryPath:(NSString *)temporaryPath
+                       toPath:(NSString *)path
+                      success:(BOOL)success
+                        error:(NSError **)error;
+
++ (NSError *)errorForStreamError:(WGStreamError)streamError sysError:(int)sysError;
+
 // Key Derivation
 + (NSData *)deriveKeyFromPassword:(NSString *)password 
                              salt:(NSData *)salt;
@@ -4,13 +4,12 @@
  */
 
 #import "WGEncryption.h"
-#import <CommonCrypto/CommonCrypto.h>
-#import <Security/Security.h>
+#import <fcntl.h>
+#import <sys/stat.h>
 
-static const NSUInteger kSaltLength = 32;
-static const NSUInteger kIVLength = 16;
-static const NSUInteger kKeyLength = 32; // AES-256
-static const NSUInteger kPBKDFRounds = 100000;
+// Primitives come from WGCrypto (CommonCrypto/Security on Apple platforms)
+static const NSUInteger kSaltLength = WG_CRYPTO_SALT_LENGTH;
+static const NSUInteger kKeyLength = WG_CRYPTO_KEY_LENGTH; // AES-256
 
 @implementation WGEncryption
 
@@ -21,23 +20,20 @@ static const NSUInteger kPBKDFRounds = 100000;
     
     NSMutableData *derivedKey = [NSMutableData dataWithLength:kKeyLength];
     
-    CCKeyDerivationPBKDF(kCCPBKDF2,
-                         passwordData.bytes,
-                         passwordData.length,
-                         salt.bytes,
-                         salt.length,
-                         kCCPRFHmacAlgSHA256,
-                         kPBKDFRounds,
-                         derivedKey.mutableBytes,
-                         kKeyLength);
+    WGCryptoDeriveKey(passwordData.bytes,
+                      passwordData.length,
+                      salt.bytes,
+                      salt.length,
+                      WG_CRYPTO_PBKDF_ROUNDS,
+                      derivedKey.mutableBytes,
+                      kKeyLength);
     
     return derivedKey;
 }
 
 + (NSData *)generateRandomSalt {
     NSMutableData *salt = [NSMutableData dataWithLength:kSaltLength];
-    int result = SecRandomCopyBytes(kSecRandomDefault, kSaltLength, salt.mutableBytes);
-    if (result != 0) {
+    if (!WGCryptoRandomBytes(salt.mutableBytes, kSaltLength)) {
         NSLog(@"[WiFiGuard] Failed to generate random salt");
         return nil;
     }
@@ -46,6 +42,7 @@ static const NSUInteger kPBKDFRounds = 100000;
 
 #pragma mark - Encryption
 
+// Output layout: salt + iv + ciphertext (see WGCryptoSeal)
 + (NSData *)encryptData:(NSData *)data 
            withPassword:(NSString *)password 
                   error:(NSError **)error {
@@ -59,56 +56,20 @@ static const NSUInteger kPBKDFRounds = 100000;
         return nil;
     }
     
-    // Generate random salt and IV
-    NSData *salt = [self generateRandomSalt];
-    NSMutableData *iv = [NSMutableData dataWithLength:kIVLength];
-    int ivResult = SecRandomCopyBytes(kSecRandomDefault, kIVLength, iv.mutableBytes);
-    if (ivResult != 0) {
+    NSData *passwordData = [password dataUsingEncoding:NSUTF8StringEncoding];
+    NSMutableData *result = [NSMutableData dataWithLength:WG_CRYPTO_SEALED_MAX(data.length)];
+    size_t length = 0;
+    if (!WGCryptoSeal(passwordData.bytes, passwordData.length, data.bytes, data.length,
+                      result.mutableBytes, result.length, &length)) {
         if (error) {
             *error = [NSError errorWithDomain:@"WGEncryptionError" 
                                          code:2 
-                                     userInfo:@{NSLocalizedDescriptionKey: @"Failed to generate IV"}];
-        }
-        return nil;
-    }
-    
-    // Derive key from password
-    NSData *key = [self deriveKeyFromPassword:password salt:salt];
-    
-    // Prepare output buffer
-    size_t bufferSize = data.length + kCCBlockSizeAES128;
-    NSMutableData *cipherData = [NSMutableData dataWithLength:bufferSize];
-    
-    size_t numBytesEncrypted = 0;
-    CCCryptorStatus status = CCCrypt(kCCEncrypt,
-                                     kCCAlgorithmAES128,
-                                     kCCOptionPKCS7Padding,
-                                     key.bytes,
-                                     kKeyLength,
-                                     iv.bytes,
-                                     data.bytes,
-                                     data.length,
-                                     cipherData.mutableBytes,
-                                     bufferSize,
-                                     &numBytesEncrypted);
-    
-    if (status != kCCSuccess) {
-        if (error) {
-            *error = [NSError errorWithDomain:@"WGEncryptionError" 
-                                         code:status 
                                      userInfo:@{NSLocalizedDescriptionKey: @"Encryption failed"}];
         }
         return nil;
     }
     
-    cipherData.length = numBytesEncrypted;
-    
-    // Combine: salt + iv + ciphertext
-    NSMutableData *result = [NSMutableData dataWithCapacity:salt.length + iv.length + cipherData.length];
-    [result appendData:salt];
-    [result appendData:iv];
-    [result appendData:cipherData];
-    
+    result.length = length;
     return result;
 }
 
@@ -116,7 +77,7 @@ static const NSUInteger kPBKDFRounds = 100000;
            withPassword:(NSString *)password 
                   error:(NSError **)error {
     
-    if (!data || data.length < kSaltLength + kIVLength || !password) {
+    if (!data || data.length < WG_CRYPTO_SALT_LENGTH + WG_CRYPTO_IV_LENGTH || !password) {
         if (error) {
             *error = [NSError errorWithDomain:@"WGEncryptionError" 
                                          code:1 
@@ -125,42 +86,18 @@ static const NSUInteger kPBKDFRounds = 100000;
         return nil;
     }
     
-    // Extract salt, IV, and ciphertext
-    NSData *salt = [data subdataWithRange:NSMakeRange(0, kSaltLength)];
-    NSData *iv = [data subdataWithRange:NSMakeRange(kSaltLength, kIVLength)];
-    NSData *cipherData = [data subdataWithRange:NSMakeRange(kSaltLength + kIVLength, 
-                                                            data.length - kSaltLength - kIVLength)];
-    
-    // Derive key
-    NSData *key = [self deriveKeyFromPassword:password salt:salt];
-    
-    // Prepare output buffer
-    size_t bufferSize = cipherData.length + kCCBlockSizeAES128;
-    NSMutableData *plainData = [NSMutableData dataWithLength:bufferSize];
-    
-    size_t numBytesDecrypted = 0;
-    CCCryptorStatus status = CCCrypt(kCCDecrypt,
-                                     kCCAlgorithmAES128,
-                                     kCCOptionPKCS7Padding,
-                                     key.bytes,
-                                     kKeyLength,
-                                     iv.bytes,
-                                     cipherData.bytes,
-                                     cipherData.length,
-                                     plainData.mutableBytes,
-                                     bufferSize,
-                                     &numBytesDecrypted);
-    
-    if (status != kCCSuccess) {
+    NSData *passwordData = [password dataUsingEncoding:NSUTF8StringEncoding];
+    NSMutableData *plainData = [NSMutableData dataWithLength:data.length];
+    size_t length = 0;
+    if (!WGCryptoOpen(passwordData.bytes, passwordData.length, data.bytes, data.length,
+                      plainData.mutableBytes, plainData.length, &length)) {
         if (error) {
-            *error = [NSError errorWithDomain:@"WGEncryptionError" 
-                                         code:status 
-                                     userInfo:@{NSLocalizedDescriptionKey: @"Decryption failed"}];
+            *error = [self errorForStreamError:WGStreamErrorFormat sysError:0];
         }
         return nil;
     }
     
-    plainData.length = numBytesDecrypted;
+    plainData.length = length;
     return plainData;
 }
 
@@ -171,17 +108,7 @@ static const NSUInteger kPBKDFRounds = 100000;
        withPassword:(NSString *)password 
               error:(NSError **)error {
     
-    NSData *inputData = [NSData dataWithContentsOfFile:inputPath options:0 error:error];
-    if (!inputData) {
-        return NO;
-    }
-    
-    NSData *encryptedData = [self encryptData:inputData withPassword:password error:error];
-    if (!encryptedData) {
-        return NO;
-    }
-    
-    return [encryptedData writeToFile:outputPath options:NSDataWritingAtomic error:error];
+    return [self transformFile:inputPath toOutput:outputPath withPassword:password encrypt:YES error:error];
 }
 
 + (BOOL)decryptFile:(NSString *)inputPath 
@@ -189,17 +116,126 @@ static const NSUInteger kPBKDFRounds = 100000;
        withPassword:(NSString *)password 
               error:(NSError **)error {
     
-    NSData *inputData = [NSData dataWithContentsOfFile:inputPath options:0 error:error];
-    if (!inputData) {
+    return [self transformFile:inputPath toOutput:outputPath withPassword:password encrypt:NO error:error];
+}
+
++ (BOOL)transformFile:(NSString *)inputPath 
+             toOutput:(NSString *)outputPath 
+         withPassword:(NSString *)password 
+              encrypt:(BOOL)encrypt
+                error:(NSError **)error {
+    
+    if (!password || password.length == 0) {
+        if (error) {
+            *error = [NSError errorWithDomain:@"WGEncryptionError" 
+                                         code:1 
+                                     userInfo:@{NSLocalizedDescriptionKey: @"Invalid input"}];
+        }
+        return NO;
+    }
+    
+    int inFD = open(inputPath.fileSystemRepresentation, O_RDONLY | O_CLOEXEC);
+    if (inFD < 0) {
+        if (error) {
+            *error = [self errorForStreamError:WGStreamErrorIO sysError:errno];
+        }
         return NO;
     }
     
-    NSData *decryptedData = [self decryptData:inputData withPassword:password error:error];
-    if (!decryptedData) {
+    NSString *temporaryPath = nil;
+    int outFD = [self openStreamingOutput:outputPath temporaryPath:&temporaryPath error:error];
+    if (outFD < 0) {
+        close(inFD);
         return NO;
     }
     
-    return [decryptedData writeToFile:outputPath options:NSDataWritingAtomic error:error];
+    NSData *passwordData = [password dataUsingEncoding:NSUTF8StringEncoding];
+    WGStreamError streamError = WGStreamErrorNone;
+    BOOL ok = encrypt
+        ? WGStreamEncryptFD(inFD, outFD, passwordData.bytes, passwordData.length, &streamError)
+        : WGStreamDecryptFD(inFD, outFD, passwordData.bytes, passwordData.length, NULL, &streamError);
+    int sysError = errno;
+    close(inFD);
+    
+    if (!ok && error) {
+        *error = [self errorForStreamError:streamError sysError:sysError];
+    }
+    return [self finishStreamingOutput:outFD temporaryPath:temporaryPath toPath:outputPath success:ok error:error];
+}
+
+#pragma mark - Streaming Output
+
++ (int)openStreamingOutput:(NSString *)path
+             temporaryPath:(NSString **)temporaryPath
+                     error:(NSError **)error {
+    
+    NSString *template = [path stringByAppendingString:@".XXXXXX"];
+    char *buffer = strdup(template.fileSystemRepresentation);
+    int fd = buffer ? mkstemp(buffer) : -1;
+    
+    if (fd < 0) {
+        if (error) {
+            *error = [self errorForStreamError:WGStreamErrorIO sysError:errno];
+        }
+        free(buffer);
+        return -1;
+    }
+    
+    fchmod(fd, 0644);
+    *temporaryPath = [[NSFileManager defaultManager] stringWithFileSystemRepresentation:buffer
+                                                                                 length:strlen(buffer)];
+    free(buffer);
+    return fd;
+}
+
++ (BOOL)finishStreamingOutput:(int)fd
+                temporaryPath:(NSString *)temporaryPath
+                       toPath:(NSString *)path
+                      success:(BOOL)success
+                        error:(NSError **)error {
+    
+    if (success && fsync(fd) < 0) {
+        success = NO;
+        if (error) {
+            *error = [self errorForStreamError:WGStreamErrorIO sysError:errno];
+        }
+    }
+    close(fd);
+    
+    if (success && rename(temporaryPath.fileSystemRepresentation, path.fileSystemRepresentation) == 0) {
+        return YES;
+    }
+    
+    if (success && error) {
+        *error = [self errorForStreamError:WGStreamErrorIO sysError:errno];
+    }
+    unlink(temporaryPath.fileSystemRepresentation);
+    return NO;
+}
+
++ (NSError *)errorForStreamError:(WGStreamError)streamError sysError:(int)sysError {
+    if (streamError == WGStreamErrorIO && sysError != 0) {
+        return [NSError errorWithDomain:NSPOSIXErrorDomain code:sysError userInfo:nil];
+    }
+    
+    NSString *description;
+    switch (streamError) {
+        case WGStreamErrorFormat:
+            description = @"Decryption failed (wrong password or corrupted file)";
+            break;
+        case WGStreamErrorMemory:
+            description = @"Out of memory";
+            break;
+        case WGStreamErrorIO:
+            description = @"File I/O failed";
+            break;
+        default:
+            description = @"Encryption failed";
+            break;
+    }
+    return [NSError errorWithDomain:@"WGEncryptionError" 
+                               code:3 + streamError 
+                           userInfo:@{NSLocalizedDescriptionKey: description}];
 }
 
 #pragma mark - Utilities
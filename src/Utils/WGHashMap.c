@@ -0,0 +1,189 @@
+/*
+ * WGHashMap.c - Open-Addressing Integer Hash Map Implementation
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ */
+
+#include "WGHashMap.h"
+
+#include <stdlib.h>
+
+// Keep load factor at or below 1/2
+#define WG_HASH_MAP_MIN_CAPACITY 16
+
+static inline uint64_t WGHashMix(uint64_t key) {
+    // splitmix64 finalizer - spreads sequential IPs and OUI-clustered MACs
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ULL;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebULL;
+    key ^= key >> 31;
+    return key;
+}
+
+static bool WGHashMapAllocate(WGHashMap *map, size_t capacity) {
+    WGHashMapSlot *slots = malloc(capacity * sizeof(WGHashMapSlot));
+    if (!slots) {
+        return false;
+    }
+    for (size_t i = 0; i < capacity; i++) {
+        slots[i].key = WG_HASH_MAP_EMPTY;
+    }
+    map->slots = slots;
+    map->mask = capacity - 1;
+    map->count = 0;
+    return true;
+}
+
+bool WGHashMapInit(WGHashMap *map, size_t expectedCount) {
+    size_t capacity = WG_HASH_MAP_MIN_CAPACITY;
+    while (capacity < expectedCount * 2) {
+        capacity *= 2;
+    }
+    map->slots = NULL;
+    return WGHashMapAllocate(map, capacity);
+}
+
+void WGHashMapFree(WGHashMap *map) {
+    free(map->slots);
+    map->slots = NULL;
+    map->count = 0;
+    map->mask = 0;
+}
+
+void WGHashMapClear(WGHashMap *map) {
+    if (!map->slots) {
+        return;
+    }
+    for (size_t i = 0; i <= map->mask; i++) {
+        map->slots[i].key = WG_HASH_MAP_EMPTY;
+    }
+    map->count = 0;
+}
+
+static bool WGHashMapGrow(WGHashMap *map) {
+    WGHashMapSlot *old = map->slots;
+    size_t oldCapacity = old ? map->mask + 1 : 0;
+
+    if (!WGHashMapAllocate(map, oldCapacity ? oldCapacity * 2 : WG_HASH_MAP_MIN_CAPACITY)) {
+        map->slots = old;
+        return false;
+    }
+
+    for (size_t i = 0; i < oldCapacity; i++) {
+        if (old[i].key == WG_HASH_MAP_EMPTY) {
+            continue;
+        }
+        size_t index = WGHashMix(old[i].key) & map->mask;
+        while (map->slots[index].key != WG_HASH_MAP_EMPTY) {
+            index = (index + 1) & map->mask;
+        }
+        map->slots[index] = old[i];
+        map->count++;
+    }
+
+    free(old);
+    return true;
+}
+
+uint64_t *WGHashMapFind(const WGHashMap *map, uint64_t key) {
+    if (!map->slots || key == WG_HASH_MAP_EMPTY) {
+        return NULL;
+    }
+
+    size_t index = WGHashMix(key) & map->mask;
+    while (map->slots[index].key != WG_HASH_MAP_EMPTY) {
+        if (map->slots[index].key == key) {
+            return &map->slots[index].value;
+        }
+        index = (index + 1) & map->mask;
+    }
+    return NULL;
+}
+
+uint64_t *WGHashMapInsert(WGHashMap *map, uint64_t key, bool *inserted) {
+    if (key == WG_HASH_MAP_EMPTY) {
+        return NULL;
+    }
+
+    if (!map->slots || (map->count + 1) * 2 > map->mask + 1) {
+        if (!WGHashMapGrow(map)) {
+            return NULL;
+        }
+    }
+
+    size_t index = WGHashMix(key) & map->mask;
+    while (map->slots[index].key != WG_HASH_MAP_EMPTY) {
+        if (map->slots[index].key == key) {
+            if (inserted) {
+                *inserted = false;
+            }
+            return &map->slots[index].value;
+        }
+        index = (index + 1) & map->mask;
+    }
+
+    map->slots[index].key = key;
+    map->slots[index].value = 0;
+    map->count++;
+    if (inserted) {
+        *inserted = true;
+    }
+    return &map->slots[index].value;
+}
+
+bool WGHashMapPut(WGHashMap *map, uint64_t key, uint64_t value) {
+    uint64_t *slot = WGHashMapInsert(map, key, NULL);
+    if (!slot) {
+        return false;
+    }
+    *slot = value;
+    return true;
+}
+
+bool WGHashMapRemove(WGHashMap *map, uint64_t key) {
+    if (!map->slots || key == WG_HASH_MAP_EMPTY) {
+        return false;
+    }
+
+    size_t index = WGHashMix(key) & map->mask;
+    while (map->slots[index].key != key) {
+        if (map->slots[index].key == WG_HASH_MAP_EMPTY) {
+            return false;
+        }
+        index = (index + 1) & map->mask;
+    }
+
+    // Backward-shift the rest of the cluster so probes never see a hole
+    size_t hole = index;
+    size_t next = (hole + 1) & map->mask;
+    while (map->slots[next].key != WG_HASH_MAP_EMPTY) {
+        size_t home = WGHashMix(map->slots[next].key) & map->mask;
+        if (((next - home) & map->mask) >= ((next - hole) & map->mask)) {
+            map->slots[hole] = map->slots[next];
+            hole = next;
+        }
+        next = (next + 1) & map->mask;
+    }
+    map->slots[hole].key = WG_HASH_MAP_EMPTY;
+    map->count--;
+    return true;
+}
+
+bool WGHashMapNext(const WGHashMap *map, size_t *cursor, uint64_t *key, uint64_t *value) {
+    if (!map->slots) {
+        return false;
+    }
+    while (*cursor <= map->mask) {
+        const WGHashMapSlot *slot = &map->slots[(*cursor)++];
+        if (slot->key != WG_HASH_MAP_EMPTY) {
+            if (key) {
+                *key = slot->key;
+            }
+            if (value) {
+                *value = slot->value;
+            }
+            return true;
+        }
+    }
+    return false;
+}
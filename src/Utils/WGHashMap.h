@@ -0,0 +1,56 @@
+/*
+ * WGHashMap.h - Open-Addressing Integer Hash Map
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * Linear-probing map from uint64_t keys to uint64_t values with
+ * backward-shift deletion. Keys are packed MACs/IPv4 addresses, so
+ * UINT64_MAX is reserved as the empty-slot marker.
+ */
+
+#ifndef WG_HASH_MAP_H
+#define WG_HASH_MAP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WG_HASH_MAP_EMPTY UINT64_MAX
+
+typedef struct {
+    uint64_t key;
+    uint64_t value;
+} WGHashMapSlot;
+
+typedef struct {
+    WGHashMapSlot *slots;
+    size_t count;
+    size_t mask;    // capacity - 1 (capacity is a power of two)
+} WGHashMap;
+
+// Lifecycle
+bool WGHashMapInit(WGHashMap *map, size_t expectedCount);
+void WGHashMapFree(WGHashMap *map);
+void WGHashMapClear(WGHashMap *map);
+
+// Access - returned pointers are valid until the next insert
+uint64_t *WGHashMapFind(const WGHashMap *map, uint64_t key);
+uint64_t *WGHashMapInsert(WGHashMap *map, uint64_t key, bool *inserted);
+bool WGHashMapPut(WGHashMap *map, uint64_t key, uint64_t value);
+bool WGHashMapRemove(WGHashMap *map, uint64_t key);
+
+// Iteration - start with *cursor = 0
+bool WGHashMapNext(const WGHashMap *map, size_t *cursor, uint64_t *key, uint64_t *value);
+
+static inline size_t WGHashMapCount(const WGHashMap *map) {
+    return map->count;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WG_HASH_MAP_H */
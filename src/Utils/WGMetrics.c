@@ -0,0 +1,184 @@
+/*
+ * WGMetrics.c - Hot-Path Latency Histograms and Counters Implementation
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ */
+
+#include "WGMetrics.h"
+
+#include <stdatomic.h>
+#include <string.h>
+#include <time.h>
+
+// Bucket i < 8 holds the value i; above that each power of two 2^e is
+// split into 8 buckets of width 2^(e-3). Values from 2^40 ns go in the last.
+#define WG_METRICS_SUB_BITS  3
+#define WG_METRICS_SUB_COUNT (1u << WG_METRICS_SUB_BITS)
+#define WG_METRICS_MAX_SHIFT 40
+#define WG_METRICS_BUCKETS   ((WG_METRICS_MAX_SHIFT - WG_METRICS_SUB_BITS + 1) << WG_METRICS_SUB_BITS)
+
+// The count is the bucket sum, so recording costs two adds and a load
+typedef struct {
+    _Atomic uint64_t totalNs;
+    _Atomic uint64_t maxNs;
+    _Atomic uint64_t buckets[WG_METRICS_BUCKETS];
+} WGMetricHistogram;
+
+static WGMetricHistogram gWGMetricStages[WGMetricStageCount];
+static _Atomic uint64_t gWGMetricCounters[WGMetricCounterCount];
+
+static const char * const kWGMetricStageNames[WGMetricStageCount] = {
+    [WGMetricStageARPTick]         = "arp.tick",
+    [WGMetricStageARPRead]         = "arp.read",
+    [WGMetricStageARPParse]        = "arp.parse",
+    [WGMetricStageARPAnalyze]      = "arp.analyze",
+    [WGMetricStageARPEvents]       = "arp.events",
+    [WGMetricStageARPRecord]       = "arp.record",
+    [WGMetricStageScanCallback]    = "scan.callback",
+    [WGMetricStageScanParse]       = "scan.parse",
+    [WGMetricStageScanMerge]       = "scan.merge",
+    [WGMetricStageScanSignals]     = "scan.signals",
+    [WGMetricStageScanDeliver]     = "scan.deliver",
+    [WGMetricStageScanChannels]    = "scan.channels",
+    [WGMetricStageAuditAppend]     = "audit.append",
+    [WGMetricStageAuditFlush]      = "audit.flush",
+    [WGMetricStageExportSerialize] = "export.serialize",
+    [WGMetricStageExportEncrypt]   = "export.encrypt",
+    [WGMetricStageExportWrite]     = "export.write",
+};
+
+static const char * const kWGMetricCounterNames[WGMetricCounterCount] = {
+    [WGMetricCounterARPRecords]   = "arp.records",
+    [WGMetricCounterARPAnomalies] = "arp.anomalies",
+    [WGMetricCounterScanResults]  = "scan.results",
+    [WGMetricCounterScanDropped]  = "scan.dropped",
+    [WGMetricCounterScanSteps]    = "scan.steps",
+    [WGMetricCounterScanAlerts]   = "scan.alerts",
+    [WGMetricCounterAuditEntries] = "audit.entries",
+    [WGMetricCounterExportBytes]  = "export.bytes",
+};
+
+#pragma mark - Buckets
+
+static inline unsigned WGMetricBucket(uint64_t ns) {
+    if (ns < WG_METRICS_SUB_COUNT) {
+        return (unsigned)ns;
+    }
+    unsigned exponent = 63u - (unsigned)__builtin_clzll(ns);
+    if (exponent >= WG_METRICS_MAX_SHIFT) {
+        return WG_METRICS_BUCKETS - 1;
+    }
+    unsigned sub = (unsigned)(ns >> (exponent - WG_METRICS_SUB_BITS)) & (WG_METRICS_SUB_COUNT - 1);
+    return ((exponent - WG_METRICS_SUB_BITS + 1) << WG_METRICS_SUB_BITS) | sub;
+}
+
+static uint64_t WGMetricBucketMidpoint(unsigned bucket) {
+    if (bucket < WG_METRICS_SUB_COUNT) {
+        return bucket;
+    }
+    unsigned exponent = (bucket >> WG_METRICS_SUB_BITS) + WG_METRICS_SUB_BITS - 1;
+    uint64_t width = 1ull << (exponent - WG_METRICS_SUB_BITS);
+    uint64_t low = (uint64_t)(WG_METRICS_SUB_COUNT | (bucket & (WG_METRICS_SUB_COUNT - 1))) * width;
+    return low + width / 2;
+}
+
+#pragma mark - Recording
+
+uint64_t WGMetricsNow(void) {
+#ifdef __APPLE__
+    return clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+void WGMetricsRecord(WGMetricStage stage, uint64_t ns) {
+    if ((unsigned)stage >= WGMetricStageCount) {
+        return;
+    }
+    WGMetricHistogram *histogram = &gWGMetricStages[stage];
+    atomic_fetch_add_explicit(&histogram->buckets[WGMetricBucket(ns)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&histogram->totalNs, ns, memory_order_relaxed);
+
+    // The max rarely moves, so this is usually a single load
+    uint64_t max = atomic_load_explicit(&histogram->maxNs, memory_order_relaxed);
+    while (ns > max &&
+           !atomic_compare_exchange_weak_explicit(&histogram->maxNs, &max, ns,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+void WGMetricsAdd(WGMetricCounter counter, uint64_t delta) {
+    if ((unsigned)counter < WGMetricCounterCount) {
+        atomic_fetch_add_explicit(&gWGMetricCounters[counter], delta, memory_order_relaxed);
+    }
+}
+
+#pragma mark - Summaries
+
+void WGMetricsSummarize(WGMetricStage stage, WGMetricSummary *summary) {
+    memset(summary, 0, sizeof(*summary));
+    if ((unsigned)stage >= WGMetricStageCount) {
+        return;
+    }
+
+    // Ranks come from the copied buckets so they agree with each other even
+    // if writers move on meanwhile
+    WGMetricHistogram *histogram = &gWGMetricStages[stage];
+    uint64_t buckets[WG_METRICS_BUCKETS];
+    uint64_t count = 0;
+    for (unsigned i = 0; i < WG_METRICS_BUCKETS; i++) {
+        buckets[i] = atomic_load_explicit(&histogram->buckets[i], memory_order_relaxed);
+        count += buckets[i];
+    }
+    summary->count = count;
+    summary->totalNs = atomic_load_explicit(&histogram->totalNs, memory_order_relaxed);
+    summary->maxNs = atomic_load_explicit(&histogram->maxNs, memory_order_relaxed);
+    if (count == 0) {
+        return;
+    }
+
+    static const uint32_t kPerMille[3] = { 500, 900, 990 };
+    uint64_t *outputs[3] = { &summary->p50Ns, &summary->p90Ns, &summary->p99Ns };
+    uint64_t seen = 0;
+    unsigned next = 0;
+    for (unsigned i = 0; i < WG_METRICS_BUCKETS && next < 3; i++) {
+        seen += buckets[i];
+        while (next < 3 && seen * 1000 >= count * kPerMille[next]) {
+            uint64_t value = WGMetricBucketMidpoint(i);
+            *outputs[next++] = value < summary->maxNs ? value : summary->maxNs;
+        }
+    }
+}
+
+uint64_t WGMetricsCounterValue(WGMetricCounter counter) {
+    if ((unsigned)counter >= WGMetricCounterCount) {
+        return 0;
+    }
+    return atomic_load_explicit(&gWGMetricCounters[counter], memory_order_relaxed);
+}
+
+void WGMetricsReset(void) {
+    for (unsigned stage = 0; stage < WGMetricStageCount; stage++) {
+        WGMetricHistogram *histogram = &gWGMetricStages[stage];
+        for (unsigned i = 0; i < WG_METRICS_BUCKETS; i++) {
+            atomic_store_explicit(&histogram->buckets[i], 0, memory_order_relaxed);
+        }
+        atomic_store_explicit(&histogram->totalNs, 0, memory_order_relaxed);
+        atomic_store_explicit(&histogram->maxNs, 0, memory_order_relaxed);
+    }
+    for (unsigned counter = 0; counter < WGMetricCounterCount; counter++) {
+        atomic_store_explicit(&gWGMetricCounters[counter], 0, memory_order_relaxed);
+    }
+}
+
+#pragma mark - Names
+
+const char *WGMetricStageName(WGMetricStage stage) {
+    return (unsigned)stage < WGMetricStageCount ? kWGMetricStageNames[stage] : "unknown";
+}
+
+const char *WGMetricCounterName(WGMetricCounter counter) {
+    return (unsigned)counter < WGMetricCounterCount ? kWGMetricCounterNames[counter] : "unknown";
+}
@@ -0,0 +1,104 @@
+/*
+ * WGMetrics.h - Hot-Path Latency Histograms and Counters
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * A fixed, process-wide registry: one log-linear histogram per pipeline
+ * stage and one counter per event kind, all updated with relaxed atomics
+ * so any thread can record without locks. Buckets are exact below 8 ns
+ * and 8 per power of two above (12.5% resolution) up to ~18 minutes.
+ *
+ * Summaries read the buckets while writers keep going; a summary taken
+ * mid-update may be off by the samples in flight, never torn.
+ */
+
+#ifndef WG_METRICS_H
+#define WG_METRICS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Stage names are "<module>.<stage>"; summaries can be filtered by prefix
+typedef enum {
+    WGMetricStageARPTick = 0,       // One full check: read + parse + analyze
+    WGMetricStageARPRead,           // Kernel ARP dump
+    WGMetricStageARPParse,          // Dump -> WGARPTable
+    WGMetricStageARPAnalyze,        // Analyzer check and object cache diff
+    WGMetricStageARPEvents,         // One batch of routing socket notifications
+    WGMetricStageARPRecord,         // One anomaly: objects, audit, delegate
+    WGMetricStageScanCallback,      // Scan source callback, parse to submit
+    WGMetricStageScanParse,         // Scan results -> WGScanRecord
+    WGMetricStageScanMerge,         // One batch applied to the ingest table
+    WGMetricStageScanSignals,       // Signal statistics folded for one batch
+    WGMetricStageScanDeliver,       // Diff mirrored into the main-thread cache
+    WGMetricStageScanChannels,      // Channel statistics built for a caller
+    WGMetricStageAuditAppend,       // One event formatted into the log buffer
+    WGMetricStageAuditFlush,        // Group commit: write + fsync
+    WGMetricStageExportSerialize,   // One file's rows, excluding encrypt/write
+    WGMetricStageExportEncrypt,     // One file's key setup and cipher work
+    WGMetricStageExportWrite,       // One file's write(2) calls
+    WGMetricStageCount
+} WGMetricStage;
+
+typedef enum {
+    WGMetricCounterARPRecords = 0,  // Entries parsed from dumps
+    WGMetricCounterARPAnomalies,
+    WGMetricCounterScanResults,     // Records applied by the ingest worker
+    WGMetricCounterScanDropped,     // Records lost to allocation failures
+    WGMetricCounterScanSteps,       // RSSI steps flagged by the signal statistics
+    WGMetricCounterScanAlerts,      // Evil-twin / downgrade alerts from the SSID index
+    WGMetricCounterAuditEntries,
+    WGMetricCounterExportBytes,     // Bytes written to export files
+    WGMetricCounterCount
+} WGMetricCounter;
+
+typedef struct {
+    uint64_t count;
+    uint64_t totalNs;
+    uint64_t maxNs;
+    uint64_t p50Ns;                 // Bucket midpoints, capped at maxNs
+    uint64_t p90Ns;
+    uint64_t p99Ns;
+} WGMetricSummary;
+
+// Monotonic nanoseconds from the cheapest clock the platform offers
+uint64_t WGMetricsNow(void);
+
+void WGMetricsRecord(WGMetricStage stage, uint64_t ns);
+void WGMetricsAdd(WGMetricCounter counter, uint64_t delta);
+
+// Records the time since start (a WGMetricsNow() value)
+static inline void WGMetricsEnd(WGMetricStage stage, uint64_t start) {
+    WGMetricsRecord(stage, WGMetricsNow() - start);
+}
+
+void WGMetricsSummarize(WGMetricStage stage, WGMetricSummary *summary);
+uint64_t WGMetricsCounterValue(WGMetricCounter counter);
+void WGMetricsReset(void);
+
+const char *WGMetricStageName(WGMetricStage stage);
+const char *WGMetricCounterName(WGMetricCounter counter);
+
+#ifdef __cplusplus
+}
+#endif
+
+// Per-event NSLog lines (every scan, new network, anomaly) cost more than
+// the work they report. WGVerboseLog compiles away unless built with
+// WG_VERBOSE_LOG=1; lifecycle and error logs stay plain NSLog.
+#ifndef WG_VERBOSE_LOG
+#define WG_VERBOSE_LOG 0
+#endif
+
+#ifdef __OBJC__
+#if WG_VERBOSE_LOG
+#define WGVerboseLog(...) NSLog(__VA_ARGS__)
+#else
+#define WGVerboseLog(...) do { } while (0)
+#endif
+#endif
+
+#endif /* WG_METRICS_H */
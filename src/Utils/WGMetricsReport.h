@@ -0,0 +1,21 @@
+/*
+ * WGMetricsReport.h - Foundation View of the Metrics Registry
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * Summaries of WGMetrics stages and counters as property-list values, for
+ * the detector/scanner snapshot APIs and the metrics export.
+ */
+
+#import <Foundation/Foundation.h>
+#import "WGMetrics.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+// One stage: count, meanUs, p50Us, p90Us, p99Us, maxUs
+NSDictionary<NSString *, NSNumber *> *WGMetricsStageReport(WGMetricStage stage);
+
+// {"stages": {name: stage report}, "counters": {name: value}} for names
+// starting with prefix (e.g. @"arp."); nil reports everything
+NSDictionary<NSString *, NSDictionary *> *WGMetricsReport(NSString * _Nullable prefix);
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,43 @@
+/*
+ * WGMetricsReport.m - Foundation View of the Metrics Registry
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ */
+
+#import "WGMetricsReport.h"
+
+NSDictionary<NSString *, NSNumber *> *WGMetricsStageReport(WGMetricStage stage) {
+    WGMetricSummary summary;
+    WGMetricsSummarize(stage, &summary);
+    
+    return @{
+        @"count": @(summary.count),
+        @"meanUs": @(summary.count ? summary.totalNs / 1000.0 / summary.count : 0),
+        @"p50Us": @(summary.p50Ns / 1000.0),
+        @"p90Us": @(summary.p90Ns / 1000.0),
+        @"p99Us": @(summary.p99Ns / 1000.0),
+        @"maxUs": @(summary.maxNs / 1000.0)
+    };
+}
+
+NSDictionary<NSString *, NSDictionary *> *WGMetricsReport(NSString *prefix) {
+    const char *cPrefix = prefix.UTF8String ?: "";
+    size_t prefixLength = strlen(cPrefix);
+    
+    NSMutableDictionary *stages = [NSMutableDictionary dictionary];
+    for (int stage = 0; stage < WGMetricStageCount; stage++) {
+        const char *name = WGMetricStageName((WGMetricStage)stage);
+        if (strncmp(name, cPrefix, prefixLength) == 0) {
+            stages[@(name)] = WGMetricsStageReport((WGMetricStage)stage);
+        }
+    }
+    
+    NSMutableDictionary *counters = [NSMutableDictionary dictionary];
+    for (int counter = 0; counter < WGMetricCounterCount; counter++) {
+        const char *name = WGMetricCounterName((WGMetricCounter)counter);
+        if (strncmp(name, cPrefix, prefixLength) == 0) {
+            counters[@(name)] = @(WGMetricsCounterValue((WGMetricCounter)counter));
+        }
+    }
+    
+    return @{@"stages": stages, @"counters": counters};
+}
@@ -4,6 +4,8 @@
  */
 
 #import <Foundation/Foundation.h>
+#import "WGAddress.h"
+#import "WGOUI.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -12,6 +14,7 @@ NS_ASSUME_NONNULL_BEGIN
 // Device Network Info
 + (nullable NSString *)currentSSID;
 + (nullable NSString *)currentBSSID;
++ (nullable NSString *)currentWiFiInterface;    // BSD name of the associated interface
 + (nullable NSString *)localIPAddress;
 + (nullable NSString *)gatewayIPAddress;
 + (nullable NSString *)macAddressForIP:(NSString *)ip;
@@ -26,6 +29,12 @@ NS_ASSUME_NONNULL_BEGIN
 + (uint32_t)ipAddressToInt:(NSString *)ip;
 + (NSString *)intToIPAddress:(uint32_t)ipInt;
 
+// Vendors - the OUI database compiled into the bundle (oui.wgo), mapped
+// on first use; without it every vendor is unknown
++ (const WGOUIDatabase *)vendorDatabase;
++ (WGVendorID)vendorIDForMAC:(WGMACAddress)mac;
++ (nullable NSString *)vendorNameForID:(WGVendorID)vendor;   // nil for unknown
+
 // Channel Info
 + (NSInteger)frequencyToChannel:(NSInteger)frequencyMHz;
 + (NSInteger)channelToFrequency:(NSInteger)channel;
@@ -4,6 +4,7 @@
  */
 
 #import "WGNetworkUtils.h"
+#import "WGAddress.h"
 #import <SystemConfiguration/CaptiveNetwork.h>
 #import <ifaddrs.h>
 #import <arpa/inet.h>
@@ -58,6 +59,28 @@
     return bssid;
 }
 
++ (NSString *)currentWiFiInterface {
+    NSString *name = nil;
+    
+    CFArrayRef interfaces = CNCopySupportedInterfaces();
+    if (interfaces) {
+        CFIndex count = CFArrayGetCount(interfaces);
+        for (CFIndex i = 0; i < count; i++) {
+            CFStringRef interface = CFArrayGetValueAtIndex(interfaces, i);
+            CFDictionaryRef networkInfo = CNCopyCurrentNetworkInfo(interface);
+            
+            if (networkInfo) {
+                CFRelease(networkInfo);
+                name = [(__bridge NSString *)interface copy];
+                break;
+            }
+        }
+        CFRelease(interfaces);
+    }
+    
+    return name;
+}
+
 + (NSString *)localIPAddress {
     NSString *address = nil;
     struct ifaddrs *interfaces = NULL;
@@ -105,23 +128,13 @@
 #pragma mark - Validation
 
 + (BOOL)isValidIPAddress:(NSString *)ip {
-    if (!ip || ip.length == 0) return NO;
-    
-    struct sockaddr_in sa;
-    int result = inet_pton(AF_INET, [ip UTF8String], &(sa.sin_addr));
-    return result == 1;
+    WGIPv4Address value;
+    return WGIPv4Parse(ip.UTF8String, &value);
 }
 
 + (BOOL)isValidMACAddress:(NSString *)mac {
-    if (!mac || mac.length == 0) return NO;
-    
-    // Expected format: XX:XX:XX:XX:XX:XX
-    NSString *pattern = @"^([0-9A-Fa-f]{2}:){5}[0-9A-Fa-f]{2}$";
-    NSRegularExpression *regex = [NSRegularExpression regularExpressionWithPattern:pattern 
-                                                                           options:0 
-                                                                             error:nil];
-    NSRange range = [regex rangeOfFirstMatchInString:mac options:0 range:NSMakeRange(0, mac.length)];
-    return range.location != NSNotFound;
+    WGMACAddress value;
+    return WGMACParse(mac.UTF8String, &value);
 }
 
 + (BOOL)isPrivateIPAddress:(NSString *)ip {
@@ -149,19 +162,38 @@
 }
 
 + (uint32_t)ipAddressToInt:(NSString *)ip {
-    struct in_addr addr;
-    if (inet_pton(AF_INET, [ip UTF8String], &addr) == 1) {
-        return ntohl(addr.s_addr);
-    }
-    return 0;
+    return WGIPv4FromString(ip);
 }
 
 + (NSString *)intToIPAddress:(uint32_t)ipInt {
-    struct in_addr addr;
-    addr.s_addr = htonl(ipInt);
-    char buffer[INET_ADDRSTRLEN];
-    inet_ntop(AF_INET, &addr, buffer, sizeof(buffer));
-    return [NSString stringWithUTF8String:buffer];
+    return WGStringFromIPv4(ipInt);
+}
+
+#pragma mark - Vendors
+
++ (const WGOUIDatabase *)vendorDatabase {
+    static WGOUIDatabase database;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        NSString *path = [[NSBundle mainBundle] pathForResource:@"oui" ofType:@"wgo"];
+        WGOUIError error = path ? WGOUIOpen(&database, path.fileSystemRepresentation) : WGOUIErrorIO;
+        if (error != WGOUIErrorNone) {
+            NSLog(@"[WiFiGuard] Vendor database unavailable: %s", WGOUIErrorString(error));
+        }
+    });
+    return &database;
+}
+
++ (WGVendorID)vendorIDForMAC:(WGMACAddress)mac {
+    return WGOUILookup([self vendorDatabase], mac);
+}
+
++ (NSString *)vendorNameForID:(WGVendorID)vendor {
+    if (vendor == WG_OUI_UNKNOWN) {
+        return nil;
+    }
+    const char *name = WGOUIVendorName([self vendorDatabase], vendor);
+    return *name ? [NSString stringWithUTF8String:name] : nil;
 }
 
 #pragma mark - Channel Info
@@ -0,0 +1,653 @@
+/*
+ * WGOUI.c - Compiled OUI Vendor Database Implementation
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ */
+
+#include "WGOUI.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define WG_OUI_BUCKETS 65536        // Directory buckets, one per top-16-bit prefix
+#define WG_OUI_SMALL_ENTRY 16       // uint64 prefix, uint32 vendor, uint32 pad
+
+// On-disk header (56 bytes)
+typedef struct {
+    char magic[4];
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t largeCount;
+    uint32_t mediumCount;
+    uint32_t smallCount;
+    uint32_t vendorCount;
+    uint32_t stringLength;
+    uint32_t directoryOffset;
+    uint32_t largeOffset;
+    uint32_t mediumOffset;
+    uint32_t smallOffset;
+    uint32_t vendorOffset;
+    uint32_t stringOffset;
+    uint32_t reserved2;
+} WGOUIHeader;
+
+static const char kWGOUIMagic[4] = { 'W', 'G', 'O', 'U' };
+
+static size_t WGOUIAlign(size_t value) {
+    return (value + 7) & ~(size_t)7;
+}
+
+#pragma mark - Reader
+
+// A section must be aligned and lie inside the image
+static bool WGOUISection(const WGOUIDatabase *database, uint32_t offset, uint64_t size) {
+    return offset % 8 == 0 && offset <= database->length && size <= database->length - offset;
+}
+
+WGOUIError WGOUILoad(WGOUIDatabase *database, const void *data, size_t length) {
+    memset(database, 0, sizeof(*database));
+    if (length < sizeof(WGOUIHeader) || (uintptr_t)data % 8 != 0) {
+        return WGOUIErrorFormat;
+    }
+
+    WGOUIHeader header;
+    memcpy(&header, data, sizeof(header));
+    if (memcmp(header.magic, kWGOUIMagic, sizeof(kWGOUIMagic)) != 0 || header.version == 0) {
+        return WGOUIErrorFormat;
+    }
+    if (header.version > WG_OUI_VERSION) {
+        return WGOUIErrorVersion;
+    }
+
+    database->base = data;
+    database->length = length;
+    if (!WGOUISection(database, header.directoryOffset, (WG_OUI_BUCKETS + 1) * sizeof(uint32_t)) ||
+        !WGOUISection(database, header.largeOffset, (uint64_t)header.largeCount * 2 * sizeof(uint32_t)) ||
+        !WGOUISection(database, header.mediumOffset, (uint64_t)header.mediumCount * 2 * sizeof(uint32_t)) ||
+        !WGOUISection(database, header.smallOffset, (uint64_t)header.smallCount * WG_OUI_SMALL_ENTRY) ||
+        !WGOUISection(database, header.vendorOffset, (uint64_t)header.vendorCount * sizeof(uint32_t)) ||
+        !WGOUISection(database, header.stringOffset, header.stringLength)) {
+        memset(database, 0, sizeof(*database));
+        return WGOUIErrorFormat;
+    }
+
+    const uint8_t *base = data;
+    database->directory = (const uint32_t *)(base + header.directoryOffset);
+    database->large = (const uint32_t *)(base + header.largeOffset);
+    database->medium = (const uint32_t *)(base + header.mediumOffset);
+    database->small = base + header.smallOffset;
+    database->vendorNames = (const uint32_t *)(base + header.vendorOffset);
+    database->strings = (const char *)(base + header.stringOffset);
+    database->largeCount = header.largeCount;
+    database->mediumCount = header.mediumCount;
+    database->smallCount = header.smallCount;
+    database->vendorCount = header.vendorCount;
+    database->stringLength = header.stringLength;
+
+    // Buckets are clamped at lookup, so only the ends are checked here. The
+    // pool must be NUL-terminated so any in-range offset is a C string.
+    if (database->directory[0] != 0 || database->directory[WG_OUI_BUCKETS] != header.largeCount ||
+        header.vendorCount == 0 || header.stringLength == 0 ||
+        database->strings[header.stringLength - 1] != '\0') {
+        memset(database, 0, sizeof(*database));
+        return WGOUIErrorFormat;
+    }
+    return WGOUIErrorNone;
+}
+
+WGOUIError WGOUIOpen(WGOUIDatabase *database, const char *path) {
+    memset(database, 0, sizeof(*database));
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return WGOUIErrorIO;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        close(fd);
+        return WGOUIErrorIO;
+    }
+    if (st.st_size < (off_t)sizeof(WGOUIHeader)) {
+        close(fd);
+        return WGOUIErrorFormat;
+    }
+
+    void *base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    int mapError = errno;
+    close(fd);
+    if (base == MAP_FAILED) {
+        errno = mapError;
+        return WGOUIErrorIO;
+    }
+    // Lookups touch a few scattered lines each; don't read ahead
+    madvise(base, (size_t)st.st_size, MADV_RANDOM);
+
+    WGOUIError error = WGOUILoad(database, base, (size_t)st.st_size);
+    if (error != WGOUIErrorNone) {
+        munmap(base, (size_t)st.st_size);
+        memset(database, 0, sizeof(*database));
+        return error;
+    }
+    database->mapped = true;
+    return WGOUIErrorNone;
+}
+
+void WGOUIClose(WGOUIDatabase *database) {
+    if (database->mapped) {
+        munmap((void *)database->base, database->length);
+    }
+    memset(database, 0, sizeof(*database));
+}
+
+#pragma mark - Lookup
+
+static bool WGOUISearchMedium(const WGOUIDatabase *database, uint32_t prefix, WGVendorID *vendor) {
+    uint32_t low = 0;
+    uint32_t high = database->mediumCount;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        uint32_t key = database->medium[2 * mid];
+        if (key == prefix) {
+            *vendor = database->medium[2 * mid + 1];
+            return true;
+        }
+        if (key < prefix) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return false;
+}
+
+static bool WGOUISearchSmall(const WGOUIDatabase *database, uint64_t prefix, WGVendorID *vendor) {
+    uint32_t low = 0;
+    uint32_t high = database->smallCount;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        const uint8_t *entry = database->small + (size_t)mid * WG_OUI_SMALL_ENTRY;
+        uint64_t key = *(const uint64_t *)entry;
+        if (key == prefix) {
+            *vendor = *(const uint32_t *)(entry + 8);
+            return true;
+        }
+        if (key < prefix) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return false;
+}
+
+WGVendorID WGOUILookup(const WGOUIDatabase *database, WGMACAddress mac) {
+    // Multicast (I/G) and locally administered (U/L) bits
+    if (!database->base || ((mac >> 40) & 0x03) != 0) {
+        return WG_OUI_UNKNOWN;
+    }
+
+    uint32_t oui = (uint32_t)(mac >> 24) & 0xFFFFFF;
+    uint32_t bucket = oui >> 8;
+    uint32_t end = database->directory[bucket + 1];
+    if (end > database->largeCount) {
+        end = database->largeCount;
+    }
+    for (uint32_t i = database->directory[bucket]; i < end; i++) {
+        uint32_t key = database->large[2 * i];
+        if (key < oui) {
+            continue;
+        }
+        if (key > oui) {
+            break;
+        }
+        WGVendorID vendor = database->large[2 * i + 1];
+        if (!(vendor & WG_OUI_SUBDIVIDED)) {
+            return vendor;
+        }
+
+        // The block's own entry names the registration authority; prefer
+        // the organisation the slice was sold to
+        WGVendorID assigned;
+        if (WGOUISearchMedium(database, (uint32_t)((mac >> 20) & 0xFFFFFFF), &assigned) ||
+            WGOUISearchSmall(database, (mac >> 12) & 0xFFFFFFFFFULL, &assigned)) {
+            return assigned;
+        }
+        return vendor & ~WG_OUI_SUBDIVIDED;
+    }
+    return WG_OUI_UNKNOWN;
+}
+
+const char *WGOUIVendorName(const WGOUIDatabase *database, WGVendorID vendor) {
+    if (vendor >= database->vendorCount) {
+        return "";
+    }
+    uint32_t offset = database->vendorNames[vendor];
+    return offset < database->stringLength ? database->strings + offset : "";
+}
+
+const char *WGOUIErrorString(WGOUIError error) {
+    switch (error) {
+        case WGOUIErrorNone:
+            return "No error";
+        case WGOUIErrorIO:
+            return "Could not read vendor database";
+        case WGOUIErrorFormat:
+            return "Not a vendor database, or truncated";
+        case WGOUIErrorVersion:
+            return "Vendor database is from a newer version";
+        case WGOUIErrorMemory:
+            return "Out of memory";
+    }
+    return "Unknown error";
+}
+
+#pragma mark - Builder
+
+static uint64_t WGOUINameHash(const char *name, size_t length) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (uint8_t)name[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash == WG_HASH_MAP_EMPTY ? hash - 1 : hash;
+}
+
+bool WGOUIBuilderInit(WGOUIBuilder *builder) {
+    memset(builder, 0, sizeof(*builder));
+    if (!WGHashMapInit(&builder->byName, 4096)) {
+        return false;
+    }
+    if (!WGHashMapInit(&builder->byPrefix, 65536)) {
+        WGHashMapFree(&builder->byName);
+        return false;
+    }
+    // Vendor 0 is unknown, named ""
+    builder->strings = calloc(1, 4096);
+    builder->vendorNames = calloc(1, 256 * sizeof(uint32_t));
+    if (!builder->strings || !builder->vendorNames) {
+        WGOUIBuilderFree(builder);
+        return false;
+    }
+    builder->stringLength = 1;
+    builder->stringCapacity = 4096;
+    builder->vendorCount = 1;
+    builder->vendorCapacity = 256;
+    return true;
+}
+
+void WGOUIBuilderFree(WGOUIBuilder *builder) {
+    free(builder->assignments);
+    free(builder->strings);
+    free(builder->vendorNames);
+    WGHashMapFree(&builder->byName);
+    WGHashMapFree(&builder->byPrefix);
+    memset(builder, 0, sizeof(*builder));
+}
+
+// Vendor ID of name, adding it if new; 0 on allocation failure. A hash
+// collision between two names moves the second to the next free hash.
+static WGVendorID WGOUIBuilderIntern(WGOUIBuilder *builder, const char *name, size_t length) {
+    uint64_t hash = WGOUINameHash(name, length);
+    for (;;) {
+        const uint64_t *found = WGHashMapFind(&builder->byName, hash);
+        if (!found) {
+            break;
+        }
+        const char *existing = builder->strings + builder->vendorNames[*found];
+        if (strlen(existing) == length && memcmp(existing, name, length) == 0) {
+            return (WGVendorID)*found;
+        }
+        hash = hash + 1 == WG_HASH_MAP_EMPTY ? 0 : hash + 1;
+    }
+
+    if (builder->vendorCount >= WG_OUI_SUBDIVIDED - 1) {
+        return WG_OUI_UNKNOWN;
+    }
+    if (builder->vendorCount == builder->vendorCapacity) {
+        uint32_t capacity = builder->vendorCapacity * 2;
+        uint32_t *names = realloc(builder->vendorNames, capacity * sizeof(uint32_t));
+        if (!names) {
+            return WG_OUI_UNKNOWN;
+        }
+        builder->vendorNames = names;
+        builder->vendorCapacity = capacity;
+    }
+    if (builder->stringLength + length + 1 > builder->stringCapacity) {
+        size_t capacity = builder->stringCapacity * 2;
+        while (capacity < builder->stringLength + length + 1) {
+            capacity *= 2;
+        }
+        char *strings = realloc(builder->strings, capacity);
+        if (!strings) {
+            return WG_OUI_UNKNOWN;
+        }
+        builder->strings = strings;
+        builder->stringCapacity = capacity;
+    }
+    if (builder->stringLength + length + 1 > UINT32_MAX ||
+        !WGHashMapPut(&builder->byName, hash, builder->vendorCount)) {
+        return WG_OUI_UNKNOWN;
+    }
+
+    memcpy(builder->strings + builder->stringLength, name, length);
+    builder->strings[builder->stringLength + length] = '\0';
+    builder->vendorNames[builder->vendorCount] = (uint32_t)builder->stringLength;
+    builder->stringLength += length + 1;
+    return builder->vendorCount++;
+}
+
+static bool WGOUIBuilderAppend(WGOUIBuilder *builder, uint64_t prefix, WGOUIBlock bits, WGVendorID vendor) {
+    if (builder->count == builder->capacity) {
+        size_t capacity = builder->capacity ? builder->capacity * 2 : 4096;
+        WGOUIAssignment *assignments = realloc(builder->assignments, capacity * sizeof(WGOUIAssignment));
+        if (!assignments) {
+            return false;
+        }
+        builder->assignments = assignments;
+        builder->capacity = capacity;
+    }
+    if (!WGHashMapPut(&builder->byPrefix, (uint64_t)bits << 40 | prefix, 1)) {
+        return false;
+    }
+    builder->assignments[builder->count++] = (WGOUIAssignment){
+        .prefix = prefix,
+        .vendor = vendor,
+        .bits = (uint8_t)bits
+    };
+    return true;
+}
+
+bool WGOUIBuilderAdd(WGOUIBuilder *builder, uint64_t prefix, WGOUIBlock bits,
+                     const char *name, size_t nameLength) {
+    prefix &= (1ULL << bits) - 1;
+    if (WGHashMapFind(&builder->byPrefix, (uint64_t)bits << 40 | prefix)) {
+        return true;
+    }
+    WGVendorID vendor = WGOUIBuilderIntern(builder, name, nameLength);
+    return vendor != WG_OUI_UNKNOWN && WGOUIBuilderAppend(builder, prefix, bits, vendor);
+}
+
+static bool WGOUIIsSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+static int WGOUIHexValue(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    c = (char)(c | 0x20);
+    return c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+}
+
+// Hex digits at *p; returns how many were read
+static size_t WGOUIReadHex(const char **p, const char *end, uint64_t *value) {
+    size_t digits = 0;
+    *value = 0;
+    int nibble;
+    while (*p < end && digits < 16 && (nibble = WGOUIHexValue(**p)) >= 0) {
+        *value = *value << 4 | (uint64_t)nibble;
+        (*p)++;
+        digits++;
+    }
+    return digits;
+}
+
+// The block a "(hex)" line names, waiting for the "(base 16)" line after it
+typedef struct {
+    uint64_t prefix;
+    size_t digits;              // 0 = none
+} WGOUIPendingBlock;
+
+#define WG_OUI_MAX_GROUPS 6
+
+// Skips blanks, then the marker and blanks after it if they come next
+static bool WGOUISkipMarker(const char **p, const char *end, const char *marker, size_t markerLength) {
+    while (*p < end && WGOUIIsSpace(**p)) {
+        (*p)++;
+    }
+    if ((size_t)(end - *p) < markerLength || memcmp(*p, marker, markerLength) != 0) {
+        return false;
+    }
+    *p += markerLength;
+    while (*p < end && WGOUIIsSpace(**p)) {
+        (*p)++;
+    }
+    return true;
+}
+
+// One line of registry text. A "(hex)" line names the block; its
+// "(base 16)" line repeats an MA-L OUI, but for MA-M and MA-S only gives
+// the range within the OUI, so the prefix comes from the line before:
+//   28-6F-B9   (hex)		Nokia Shanghai Bell Co., Ltd.
+//   286FB9     (base 16)		Nokia Shanghai Bell Co., Ltd.
+//   1C-82-59-D   (hex)		ESTec Corporation
+//   D00000-DFFFFF     (base 16)		ESTec Corporation
+//   70-B3-D5-F2-F   (hex)		TELEPLATFORMS
+//   F2F000-F2FFFF     (base 16)		TELEPLATFORMS
+static int WGOUIBuilderParseLine(WGOUIBuilder *builder, WGOUIPendingBlock *pending,
+                                 const char *line, const char *end) {
+    static const char hexMarker[] = "(hex)";
+    static const char baseMarker[] = "(base 16)";
+
+    const char *p = line;
+    while (p < end && WGOUIIsSpace(*p)) {
+        p++;
+    }
+    uint64_t groups[WG_OUI_MAX_GROUPS];
+    size_t digits[WG_OUI_MAX_GROUPS];
+    size_t groupCount = 0;
+    while (groupCount < WG_OUI_MAX_GROUPS) {
+        digits[groupCount] = WGOUIReadHex(&p, end, &groups[groupCount]);
+        if (digits[groupCount] == 0) {
+            return 0;
+        }
+        groupCount++;
+        if (p >= end || *p != '-') {
+            break;
+        }
+        p++;
+    }
+
+    if (WGOUISkipMarker(&p, end, hexMarker, sizeof(hexMarker) - 1)) {
+        // Octets, and the odd nibble of an MA-M / MA-S prefix
+        uint64_t prefix = 0;
+        size_t total = 0;
+        for (size_t i = 0; i < groupCount; i++) {
+            if (digits[i] > 2) {
+                return 0;
+            }
+            prefix = prefix << (4 * digits[i]) | groups[i];
+            total += digits[i];
+        }
+        *pending = (WGOUIPendingBlock){ .prefix = prefix, .digits = total };
+        return 0;
+    }
+    if (!WGOUISkipMarker(&p, end, baseMarker, sizeof(baseMarker) - 1)) {
+        return 0;
+    }
+    WGOUIPendingBlock block = *pending;
+    *pending = (WGOUIPendingBlock){ 0 };
+
+    const char *nameEnd = end;
+    while (nameEnd > p && WGOUIIsSpace(nameEnd[-1])) {
+        nameEnd--;
+    }
+    if (nameEnd == p) {
+        return 0;
+    }
+
+    uint64_t prefix;
+    WGOUIBlock bits;
+    if (groupCount == 1 && digits[0] == 6) {
+        prefix = groups[0];
+        bits = WGOUIBlockLarge;
+    } else if (groupCount == 2 && digits[0] == 6 && digits[1] == 6 && groups[1] > groups[0]) {
+        // The range size says which registry it belongs to; its top digits
+        // must agree with the prefix the "(hex)" line gave
+        switch (groups[1] - groups[0] + 1) {
+            case 1ULL << 20:
+                bits = WGOUIBlockMedium;
+                break;
+            case 1ULL << 12:
+                bits = WGOUIBlockSmall;
+                break;
+            default:
+                return 0;
+        }
+        size_t rangeDigits = (size_t)(bits - WGOUIBlockLarge) / 4;
+        if (block.digits != 6 + rangeDigits ||
+            (block.prefix & ((1ULL << (bits - WGOUIBlockLarge)) - 1)) != groups[0] >> (48 - bits)) {
+            return 0;
+        }
+        prefix = block.prefix;
+    } else {
+        return 0;
+    }
+    return WGOUIBuilderAdd(builder, prefix, bits, p, (size_t)(nameEnd - p)) ? 1 : -1;
+}
+
+long WGOUIBuilderParse(WGOUIBuilder *builder, const char *text, size_t length) {
+    WGOUIPendingBlock pending = { 0 };
+    long added = 0;
+    const char *p = text;
+    const char *end = text + length;
+    while (p < end) {
+        const char *lineEnd = memchr(p, '\n', (size_t)(end - p));
+        if (!lineEnd) {
+            lineEnd = end;
+        }
+        int result = WGOUIBuilderParseLine(builder, &pending, p, lineEnd);
+        if (result < 0) {
+            return -1;
+        }
+        added += result;
+        p = lineEnd + 1;
+    }
+    return added;
+}
+
+static int WGOUICompareAssignments(const void *a, const void *b) {
+    const WGOUIAssignment *x = a;
+    const WGOUIAssignment *y = b;
+    if (x->bits != y->bits) {
+        return x->bits < y->bits ? -1 : 1;
+    }
+    return x->prefix < y->prefix ? -1 : x->prefix > y->prefix;
+}
+
+WGOUIError WGOUIBuilderFinish(WGOUIBuilder *builder, uint8_t **data, size_t *length) {
+    *data = NULL;
+    *length = 0;
+
+    // Subdivided blocks need an MA-L entry to route lookups, even where
+    // the registry text for it was not supplied
+    for (size_t i = 0, count = builder->count; i < count; i++) {
+        const WGOUIAssignment *assignment = &builder->assignments[i];
+        if (assignment->bits == WGOUIBlockLarge) {
+            continue;
+        }
+        uint64_t parent = assignment->prefix >> (assignment->bits - WGOUIBlockLarge);
+        if (!WGHashMapFind(&builder->byPrefix, (uint64_t)WGOUIBlockLarge << 40 | parent) &&
+            !WGOUIBuilderAppend(builder, parent, WGOUIBlockLarge, WG_OUI_UNKNOWN)) {
+            return WGOUIErrorMemory;
+        }
+    }
+    if (builder->count > 0) {
+        qsort(builder->assignments, builder->count, sizeof(WGOUIAssignment), WGOUICompareAssignments);
+    }
+
+    size_t counts[3] = {0};
+    for (size_t i = 0; i < builder->count; i++) {
+        uint8_t bits = builder->assignments[i].bits;
+        counts[bits == WGOUIBlockLarge ? 0 : (bits == WGOUIBlockMedium ? 1 : 2)]++;
+    }
+    const WGOUIAssignment *large = builder->assignments;
+    const WGOUIAssignment *medium = large + counts[0];
+    const WGOUIAssignment *small = medium + counts[1];
+
+    size_t directoryOffset = WGOUIAlign(sizeof(WGOUIHeader));
+    size_t largeOffset = WGOUIAlign(directoryOffset + (WG_OUI_BUCKETS + 1) * sizeof(uint32_t));
+    size_t mediumOffset = WGOUIAlign(largeOffset + counts[0] * 2 * sizeof(uint32_t));
+    size_t smallOffset = WGOUIAlign(mediumOffset + counts[1] * 2 * sizeof(uint32_t));
+    size_t vendorOffset = WGOUIAlign(smallOffset + counts[2] * WG_OUI_SMALL_ENTRY);
+    size_t stringOffset = WGOUIAlign(vendorOffset + builder->vendorCount * sizeof(uint32_t));
+    size_t total = WGOUIAlign(stringOffset + builder->stringLength);
+    if (total > UINT32_MAX) {
+        return WGOUIErrorFormat;
+    }
+
+    uint8_t *image = calloc(1, total);
+    if (!image) {
+        return WGOUIErrorMemory;
+    }
+
+    WGOUIHeader header = {
+        .version = WG_OUI_VERSION,
+        .largeCount = (uint32_t)counts[0],
+        .mediumCount = (uint32_t)counts[1],
+        .smallCount = (uint32_t)counts[2],
+        .vendorCount = builder->vendorCount,
+        .stringLength = (uint32_t)builder->stringLength,
+        .directoryOffset = (uint32_t)directoryOffset,
+        .largeOffset = (uint32_t)largeOffset,
+        .mediumOffset = (uint32_t)mediumOffset,
+        .smallOffset = (uint32_t)smallOffset,
+        .vendorOffset = (uint32_t)vendorOffset,
+        .stringOffset = (uint32_t)stringOffset
+    };
+    memcpy(header.magic, kWGOUIMagic, sizeof(kWGOUIMagic));
+    memcpy(image, &header, sizeof(header));
+
+    uint32_t *directory = (uint32_t *)(image + directoryOffset);
+    uint32_t *largeOut = (uint32_t *)(image + largeOffset);
+    size_t bucket = 0;
+    for (size_t i = 0; i < counts[0]; i++) {
+        uint32_t oui = (uint32_t)large[i].prefix;
+        while (bucket <= (oui >> 8)) {
+            directory[bucket++] = (uint32_t)i;
+        }
+        largeOut[2 * i] = oui;
+        largeOut[2 * i + 1] = large[i].vendor;
+    }
+    while (bucket <= WG_OUI_BUCKETS) {
+        directory[bucket++] = (uint32_t)counts[0];
+    }
+
+    // Every medium/small parent is in large; both lists are sorted, so one
+    // merge each flags the subdivided blocks
+    const WGOUIAssignment *children[2] = { medium, small };
+    for (int list = 0; list < 2; list++) {
+        for (size_t i = 0, j = 0; i < counts[list + 1]; i++) {
+            const WGOUIAssignment *assignment = &children[list][i];
+            uint32_t parent = (uint32_t)(assignment->prefix >> (assignment->bits - WGOUIBlockLarge));
+            while (j < counts[0] && largeOut[2 * j] < parent) {
+                j++;
+            }
+            if (j < counts[0] && largeOut[2 * j] == parent) {
+                largeOut[2 * j + 1] |= WG_OUI_SUBDIVIDED;
+            }
+        }
+    }
+
+    uint32_t *mediumOut = (uint32_t *)(image + mediumOffset);
+    for (size_t i = 0; i < counts[1]; i++) {
+        mediumOut[2 * i] = (uint32_t)medium[i].prefix;
+        mediumOut[2 * i + 1] = medium[i].vendor;
+    }
+    for (size_t i = 0; i < counts[2]; i++) {
+        uint8_t *entry = image + smallOffset + i * WG_OUI_SMALL_ENTRY;
+        memcpy(entry, &small[i].prefix, sizeof(uint64_t));
+        memcpy(entry + 8, &small[i].vendor, sizeof(uint32_t));
+    }
+    memcpy(image + vendorOffset, builder->vendorNames, builder->vendorCount * sizeof(uint32_t));
+    memcpy(image + stringOffset, builder->strings, builder->stringLength);
+
+    *data = image;
+    *length = total;
+    return WGOUIErrorNone;
+}
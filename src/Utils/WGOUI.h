@@ -0,0 +1,142 @@
+/*
+ * WGOUI.h - Compiled OUI Vendor Database
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * Maps a MAC address to the organisation the IEEE assigned its block to,
+ * covering all three registries: MA-L (24-bit OUI), MA-M (28-bit) and
+ * MA-S (36-bit). Vendors are small integer IDs so detectors compare and
+ * index them like any other key; names are only resolved for display.
+ *
+ * The registry text (oui.txt, mam.txt, oui36.txt) is compiled on the build
+ * host by the wgoui tool into a .wgo file that ships in the bundle. The
+ * file is read in place - open maps it and checks the header, nothing is
+ * parsed or allocated - so startup costs one mmap however large the
+ * registry. Layout (little-endian, sections 8-byte aligned):
+ *
+ *   header      magic "WGOU", version, section counts and offsets
+ *   directory   65537 uint32: first MA-L entry for each top-16-bit prefix
+ *   large       MA-L {uint32 oui, uint32 vendor}, sorted by oui
+ *   medium      MA-M {uint32 prefix28, uint32 vendor}, sorted
+ *   small       MA-S {uint64 prefix36, uint32 vendor, pad}, sorted
+ *   vendors     uint32 name offset per vendor ID (ID 0 = unknown, "")
+ *   strings     NUL-terminated UTF-8 names
+ *
+ * A lookup indexes the directory with the first two octets and scans the
+ * handful of MA-L entries in that bucket. Blocks the IEEE subdivided have
+ * WG_OUI_SUBDIVIDED set on their MA-L entry, and only those go on to a
+ * binary search of the MA-M / MA-S tables.
+ *
+ * An open database is immutable and may be read from any thread. The
+ * builder is not thread-safe.
+ */
+
+#ifndef WG_OUI_H
+#define WG_OUI_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "WGAddress.h"
+#include "WGHashMap.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WG_OUI_VERSION 1
+#define WG_OUI_UNKNOWN 0u                   // Vendor ID of unassigned or randomized addresses
+#define WG_OUI_SUBDIVIDED 0x80000000u       // MA-L entry has MA-M / MA-S assignments beneath it
+
+typedef uint32_t WGVendorID;
+
+typedef enum {
+    WGOUIErrorNone = 0,
+    WGOUIErrorIO,           // open/mmap failed (see errno)
+    WGOUIErrorFormat,       // Bad magic, truncated or inconsistent sections
+    WGOUIErrorVersion,      // Written by a newer, incompatible version
+    WGOUIErrorMemory
+} WGOUIError;
+
+typedef enum {
+    WGOUIBlockLarge = 24,   // MA-L, prefix bits
+    WGOUIBlockMedium = 28,  // MA-M
+    WGOUIBlockSmall = 36    // MA-S
+} WGOUIBlock;
+
+typedef struct {
+    const uint8_t *base;
+    size_t length;
+    bool mapped;                // Unmapped by WGOUIClose
+    const uint32_t *directory;
+    const uint32_t *large;      // Pairs
+    const uint32_t *medium;     // Pairs
+    const uint8_t *small;       // 16-byte entries
+    const uint32_t *vendorNames;
+    const char *strings;
+    uint32_t largeCount;
+    uint32_t mediumCount;
+    uint32_t smallCount;
+    uint32_t vendorCount;       // Including WG_OUI_UNKNOWN
+    uint32_t stringLength;
+} WGOUIDatabase;
+
+// Open maps a .wgo read-only; Load reads a caller-owned, 8-byte aligned
+// buffer in place. Both only validate the header, so they cost the same
+// for any registry.
+WGOUIError WGOUIOpen(WGOUIDatabase *database, const char *path);
+WGOUIError WGOUILoad(WGOUIDatabase *database, const void *data, size_t length);
+void WGOUIClose(WGOUIDatabase *database);
+
+// Vendor of mac, WG_OUI_UNKNOWN if unassigned or the database is closed.
+// Locally administered (randomized) and multicast addresses are never
+// assigned, so they always read unknown.
+WGVendorID WGOUILookup(const WGOUIDatabase *database, WGMACAddress mac);
+
+// Registered name, "" for unknown or out-of-range IDs
+const char *WGOUIVendorName(const WGOUIDatabase *database, WGVendorID vendor);
+
+const char *WGOUIErrorString(WGOUIError error);
+
+// Compiling (build host) - collects assignments and interns vendor names
+typedef struct {
+    uint64_t prefix;            // Right-aligned, bits long
+    uint32_t vendor;
+    uint8_t bits;               // WGOUIBlock
+} WGOUIAssignment;
+
+typedef struct {
+    WGOUIAssignment *assignments;
+    size_t count;
+    size_t capacity;
+    char *strings;              // Names, NUL-terminated, in vendor ID order
+    size_t stringLength;
+    size_t stringCapacity;
+    uint32_t *vendorNames;      // Offset into strings per vendor ID
+    uint32_t vendorCount;
+    uint32_t vendorCapacity;
+    WGHashMap byName;           // Name hash -> vendor ID
+    WGHashMap byPrefix;         // bits << 40 | prefix, assignments already added
+} WGOUIBuilder;
+
+bool WGOUIBuilderInit(WGOUIBuilder *builder);
+void WGOUIBuilderFree(WGOUIBuilder *builder);
+
+// Adds one block; the first assignment of a prefix wins
+bool WGOUIBuilderAdd(WGOUIBuilder *builder, uint64_t prefix, WGOUIBlock bits,
+                     const char *name, size_t nameLength);
+
+// Reads IEEE registry text (oui.txt, mam.txt or oui36.txt, any line
+// endings): each "(base 16)" line, with the prefix from the "(hex)" line
+// before it for MA-M and MA-S. Returns the number of assignments added, or
+// -1 on allocation failure. Call once per file.
+long WGOUIBuilderParse(WGOUIBuilder *builder, const char *text, size_t length);
+
+// Lays out a .wgo image in a malloc'd buffer the caller frees
+WGOUIError WGOUIBuilderFinish(WGOUIBuilder *builder, uint8_t **data, size_t *length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WG_OUI_H */
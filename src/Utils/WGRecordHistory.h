@@ -0,0 +1,67 @@
+/*
+ * WGRecordHistory.h - Indexed Object History
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * A WGRingBuffer of objects with a WGRecordIndex alongside, maintained on
+ * every add and eviction. Each object is added with its time and up to
+ * WG_RECORD_INDEX_MAX_KEYS packed keys (WGRecordKey); a query returns one
+ * page of matching objects and a cursor for the next, so readers never
+ * copy or scan the whole history. Not thread-safe; owners confine access
+ * to one queue.
+ */
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Filters shared by every history; owners subclass it for their keys
+@interface WGHistoryQuery : NSObject
+
+@property (nonatomic, strong, nullable) NSDate *since;  // Inclusive
+@property (nonatomic, strong, nullable) NSDate *until;  // Exclusive
+@property (nonatomic, assign) NSUInteger limit;         // Page size, 0 = no limit
+@property (nonatomic, assign) uint64_t cursor;          // nextCursor of the previous page, 0 = first page
+@property (nonatomic, assign) BOOL newestFirst;
+
+@end
+
+@interface WGHistoryPage<ObjectType> : NSObject
+
+@property (nonatomic, readonly) NSArray<ObjectType> *objects;
+@property (nonatomic, readonly) uint64_t nextCursor;    // 0 on the last page
+
+- (instancetype)initWithObjects:(NSArray<ObjectType> *)objects nextCursor:(uint64_t)nextCursor;
+
+@end
+
+// Walks every page of a query in order, fetching the next page (and
+// advancing query.cursor) when the current one runs out
+@interface WGHistoryPageEnumerator<ObjectType> : NSEnumerator<ObjectType>
+
+- (instancetype)initWithQuery:(WGHistoryQuery *)query
+                        fetch:(WGHistoryPage<ObjectType> *(^)(WGHistoryQuery *query))fetch;
+
+@end
+
+@interface WGRecordHistory<ObjectType> : NSObject
+
+@property (nonatomic, readonly) NSUInteger capacity;
+@property (nonatomic, readonly) NSUInteger count;
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+// Mutation - times are clamped to be non-decreasing
+- (void)addObject:(ObjectType)object time:(NSDate *)time keys:(const uint64_t *)keys count:(NSUInteger)keyCount;
+- (void)removeAllObjects;
+- (NSUInteger)removeObjectsBefore:(NSDate *)date;
+
+// Access
+- (NSArray<ObjectType> *)allObjects;
+- (WGHistoryPage<ObjectType> *)pageForQuery:(WGHistoryQuery *)query
+                                       keys:(nullable const uint64_t *)keys
+                                      count:(NSUInteger)keyCount;
+
+@end
+
+NS_ASSUME_NONNULL_END
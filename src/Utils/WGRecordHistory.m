@@ -0,0 +1,163 @@
+/*
+ * WGRecordHistory.m - Indexed Object History Implementation
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ */
+
+#import "WGRecordHistory.h"
+#import "WGRecordIndex.h"
+#import "WGRingBuffer.h"
+
+// Index stamps are microseconds since 1970
+static uint64_t WGRecordHistoryTime(NSDate *date) {
+    NSTimeInterval seconds = date.timeIntervalSince1970;
+    return seconds > 0 ? (uint64_t)(seconds * 1e6) : 0;
+}
+
+#pragma mark - WGHistoryQuery Implementation
+
+@implementation WGHistoryQuery
+@end
+
+#pragma mark - WGHistoryPage Implementation
+
+@implementation WGHistoryPage
+
+- (instancetype)initWithObjects:(NSArray *)objects nextCursor:(uint64_t)nextCursor {
+    self = [super init];
+    if (self) {
+        _objects = objects;
+        _nextCursor = nextCursor;
+    }
+    return self;
+}
+
+@end
+
+#pragma mark - WGHistoryPageEnumerator Implementation
+
+@implementation WGHistoryPageEnumerator {
+    WGHistoryQuery *_query;
+    WGHistoryPage *(^_fetch)(WGHistoryQuery *query);
+    WGHistoryPage *_page;
+    NSUInteger _index;
+}
+
+- (instancetype)initWithQuery:(WGHistoryQuery *)query fetch:(WGHistoryPage *(^)(WGHistoryQuery *query))fetch {
+    self = [super init];
+    if (self) {
+        _query = query;
+        _fetch = [fetch copy];
+    }
+    return self;
+}
+
+- (id)nextObject {
+    while (!_page || _index == _page.objects.count) {
+        if (_page && _page.nextCursor == 0) {
+            return nil;
+        }
+        if (_page) {
+            _query.cursor = _page.nextCursor;
+        }
+        _page = _fetch(_query);
+        _index = 0;
+        if (!_page) {
+            return nil;
+        }
+    }
+    return _page.objects[_index++];
+}
+
+@end
+
+#pragma mark - WGRecordHistory Implementation
+
+@implementation WGRecordHistory {
+    WGRingBuffer *_objects;     // Same capacity and order as _index
+    WGRecordIndex _index;
+}
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity {
+    self = [super init];
+    if (self) {
+        capacity = MAX(capacity, 1);
+        _objects = [[WGRingBuffer alloc] initWithCapacity:capacity];
+        if (!_objects || !WGRecordIndexInit(&_index, capacity)) {
+            return nil;
+        }
+    }
+    return self;
+}
+
+- (void)dealloc {
+    WGRecordIndexFree(&_index);
+}
+
+- (NSUInteger)capacity {
+    return _objects.capacity;
+}
+
+- (NSUInteger)count {
+    return _objects.count;
+}
+
+#pragma mark - Mutation
+
+- (void)addObject:(id)object time:(NSDate *)time keys:(const uint64_t *)keys count:(NSUInteger)keyCount {
+    uint64_t seq;
+    if (!WGRecordIndexAppend(&_index, WGRecordHistoryTime(time), keys, keyCount, &seq)) {
+        NSLog(@"[WiFiGuard] History index incomplete (out of memory)");
+    }
+    [_objects addObject:object];
+}
+
+- (void)removeAllObjects {
+    WGRecordIndexClear(&_index);
+    [_objects removeAllObjects];
+}
+
+- (NSUInteger)removeObjectsBefore:(NSDate *)date {
+    size_t dropped = WGRecordIndexDropBefore(&_index, WGRecordHistoryTime(date));
+    [_objects removeOldestObjects:dropped];
+    return dropped;
+}
+
+#pragma mark - Access
+
+- (NSArray *)allObjects {
+    return [_objects allObjects];
+}
+
+- (WGHistoryPage *)pageForQuery:(WGHistoryQuery *)query keys:(const uint64_t *)keys count:(NSUInteger)keyCount {
+    size_t max = WGRecordIndexCount(&_index);
+    if (query.limit > 0 && query.limit < max) {
+        max = query.limit;
+    }
+    if (max == 0) {
+        return [[WGHistoryPage alloc] initWithObjects:@[] nextCursor:0];
+    }
+
+    uint64_t *seqs = malloc(max * sizeof(uint64_t));
+    if (!seqs) {
+        return [[WGHistoryPage alloc] initWithObjects:@[] nextCursor:0];
+    }
+    WGRecordQuery recordQuery = {
+        .since = query.since ? WGRecordHistoryTime(query.since) : 0,
+        .until = query.until ? MAX(WGRecordHistoryTime(query.until), 1) : 0,
+        .keys = keys,
+        .keyCount = keys ? keyCount : 0,
+        .cursor = query.cursor,
+        .newestFirst = query.newestFirst
+    };
+    uint64_t next = 0;
+    size_t found = WGRecordIndexQuery(&_index, &recordQuery, seqs, max, &next);
+
+    NSMutableArray *objects = [NSMutableArray arrayWithCapacity:found];
+    for (size_t i = 0; i < found; i++) {
+        [objects addObject:[_objects objectAtIndex:WGRecordIndexPosition(&_index, seqs[i])]];
+    }
+    free(seqs);
+    return [[WGHistoryPage alloc] initWithObjects:objects nextCursor:next];
+}
+
+@end
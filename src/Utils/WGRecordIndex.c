@@ -0,0 +1,361 @@
+/*
+ * WGRecordIndex.c - Time-Ordered Record Index Implementation
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ */
+
+#include "WGRecordIndex.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define WG_POSTING_MIN_CAPACITY 8
+
+// First position in values[0, count) holding a value >= target
+static size_t WGLowerBound(const uint64_t *values, size_t count, uint64_t target) {
+    size_t low = 0;
+    size_t high = count;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (values[mid] < target) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+#pragma mark - Postings
+
+bool WGPostingsInit(WGPostings *postings, size_t expectedKeys) {
+    memset(postings, 0, sizeof(*postings));
+    return WGHashMapInit(&postings->index, expectedKeys);
+}
+
+void WGPostingsFree(WGPostings *postings) {
+    WGPostingsClear(postings);
+    WGHashMapFree(&postings->index);
+    free(postings->lists);
+    postings->lists = NULL;
+    postings->listCapacity = 0;
+}
+
+void WGPostingsClear(WGPostings *postings) {
+    for (size_t i = 0; i < postings->listCount; i++) {
+        free(postings->lists[i].values);
+    }
+    postings->listCount = 0;
+    postings->total = 0;
+    WGHashMapClear(&postings->index);
+}
+
+static WGPostingList *WGPostingsFind(const WGPostings *postings, uint64_t key) {
+    uint64_t *slot = WGHashMapFind(&postings->index, key);
+    return slot ? &postings->lists[*slot] : NULL;
+}
+
+// Swaps the last list into the released slot
+static void WGPostingsRelease(WGPostings *postings, size_t slot) {
+    WGPostingList *list = &postings->lists[slot];
+    postings->total -= list->count;
+    WGHashMapRemove(&postings->index, list->key);
+    free(list->values);
+
+    size_t last = --postings->listCount;
+    if (slot != last) {
+        *list = postings->lists[last];
+        *WGHashMapFind(&postings->index, list->key) = slot;
+    }
+}
+
+// Room for one more value at the end of the list
+static bool WGPostingListReserve(WGPostingList *list) {
+    if (list->head + list->count < list->capacity) {
+        return true;
+    }
+    if (list->head > 0 && list->head >= list->capacity / 2) {
+        memmove(list->values, list->values + list->head, list->count * sizeof(uint64_t));
+        list->head = 0;
+        return true;
+    }
+    uint32_t capacity = list->capacity ? list->capacity * 2 : WG_POSTING_MIN_CAPACITY;
+    if (capacity <= list->capacity) {
+        return false;
+    }
+    uint64_t *values = realloc(list->values, capacity * sizeof(uint64_t));
+    if (!values) {
+        return false;
+    }
+    list->values = values;
+    list->capacity = capacity;
+    return true;
+}
+
+bool WGPostingsAdd(WGPostings *postings, uint64_t key, uint64_t value) {
+    WGPostingList *list = WGPostingsFind(postings, key);
+    if (!list) {
+        if (postings->listCount == postings->listCapacity) {
+            size_t capacity = postings->listCapacity ? postings->listCapacity * 2 : WG_POSTING_MIN_CAPACITY;
+            WGPostingList *lists = realloc(postings->lists, capacity * sizeof(WGPostingList));
+            if (!lists) {
+                return false;
+            }
+            postings->lists = lists;
+            postings->listCapacity = capacity;
+        }
+        if (!WGHashMapPut(&postings->index, key, postings->listCount)) {
+            return false;
+        }
+        list = &postings->lists[postings->listCount++];
+        *list = (WGPostingList){ .key = key };
+    }
+
+    uint64_t *values = list->values + list->head;
+    size_t position = list->count;
+    if (position > 0 && values[position - 1] >= value) {
+        position = WGLowerBound(values, list->count, value);
+        if (values[position] == value) {
+            return true;
+        }
+    }
+    if (!WGPostingListReserve(list)) {
+        if (list->count == 0) {
+            WGPostingsRelease(postings, (size_t)(list - postings->lists));
+        }
+        return false;
+    }
+
+    values = list->values + list->head;
+    memmove(values + position + 1, values + position, (list->count - position) * sizeof(uint64_t));
+    values[position] = value;
+    list->count++;
+    postings->total++;
+    return true;
+}
+
+bool WGPostingsRemove(WGPostings *postings, uint64_t key, uint64_t value) {
+    WGPostingList *list = WGPostingsFind(postings, key);
+    if (!list) {
+        return false;
+    }
+    uint64_t *values = list->values + list->head;
+    size_t position = WGLowerBound(values, list->count, value);
+    if (position == list->count || values[position] != value) {
+        return false;
+    }
+
+    if (list->count == 1) {
+        WGPostingsRelease(postings, (size_t)(list - postings->lists));
+        return true;
+    }
+    if (position == 0) {
+        list->head++;
+    } else {
+        memmove(values + position, values + position + 1, (list->count - position - 1) * sizeof(uint64_t));
+    }
+    list->count--;
+    postings->total--;
+    return true;
+}
+
+size_t WGPostingsGet(const WGPostings *postings, uint64_t key, const uint64_t **values) {
+    const WGPostingList *list = WGPostingsFind(postings, key);
+    if (!list) {
+        *values = NULL;
+        return 0;
+    }
+    *values = list->values + list->head;
+    return list->count;
+}
+
+void WGPostingsTrimBelow(WGPostings *postings, uint64_t minimum) {
+    // Backwards, so releasing a slot only moves lists already visited
+    for (size_t slot = postings->listCount; slot-- > 0;) {
+        WGPostingList *list = &postings->lists[slot];
+        size_t stale = WGLowerBound(list->values + list->head, list->count, minimum);
+        if (stale == list->count) {
+            WGPostingsRelease(postings, slot);
+            continue;
+        }
+        list->head += (uint32_t)stale;
+        list->count -= (uint32_t)stale;
+        postings->total -= stale;
+    }
+}
+
+#pragma mark - Record Index
+
+bool WGRecordIndexInit(WGRecordIndex *index, size_t capacity) {
+    memset(index, 0, sizeof(*index));
+    index->firstSeq = 1;
+    index->nextSeq = 1;
+    if (!WGRingInit(&index->stamps, sizeof(WGRecordStamp), capacity)) {
+        return false;
+    }
+    return WGPostingsInit(&index->postings, 16);
+}
+
+void WGRecordIndexFree(WGRecordIndex *index) {
+    WGRingFree(&index->stamps);
+    WGPostingsFree(&index->postings);
+}
+
+void WGRecordIndexClear(WGRecordIndex *index) {
+    WGRingClear(&index->stamps);
+    WGPostingsClear(&index->postings);
+    index->firstSeq = index->nextSeq;
+    index->liveKeys = 0;
+}
+
+static void WGRecordIndexEvicted(WGRecordIndex *index, const WGRecordStamp *stamp) {
+    index->firstSeq++;
+    index->liveKeys -= stamp->keyCount;
+}
+
+// Stale postings are skipped by every query; reclaim them once they
+// outnumber live ones, so compaction is amortized O(1) per record
+static void WGRecordIndexCompact(WGRecordIndex *index) {
+    size_t stale = index->postings.total - index->liveKeys;
+    if (stale > index->liveKeys + WG_POSTING_MIN_CAPACITY) {
+        WGPostingsTrimBelow(&index->postings, index->firstSeq);
+    }
+}
+
+bool WGRecordIndexAppend(WGRecordIndex *index, uint64_t time, const uint64_t *keys, size_t keyCount,
+                         uint64_t *seq) {
+    if (time < index->lastTime) {
+        time = index->lastTime;
+    }
+    index->lastTime = time;
+
+    WGRecordStamp stamp = { .time = time };
+    WGRecordStamp evicted;
+    *seq = index->nextSeq++;
+
+    bool indexed = true;
+    for (size_t i = 0; i < keyCount && i < WG_RECORD_INDEX_MAX_KEYS; i++) {
+        // A key given twice (previous MAC == current MAC) is one posting
+        bool repeated = false;
+        for (size_t k = 0; k < i && !repeated; k++) {
+            repeated = keys[k] == keys[i];
+        }
+        if (repeated) {
+            continue;
+        }
+        if (WGPostingsAdd(&index->postings, keys[i], *seq)) {
+            stamp.keyCount++;
+        } else {
+            indexed = false;
+        }
+    }
+    indexed = indexed && keyCount <= WG_RECORD_INDEX_MAX_KEYS;
+
+    if (WGRingPush(&index->stamps, &stamp, &evicted)) {
+        WGRecordIndexEvicted(index, &evicted);
+    }
+    index->liveKeys += stamp.keyCount;
+    WGRecordIndexCompact(index);
+    return indexed;
+}
+
+size_t WGRecordIndexDropBefore(WGRecordIndex *index, uint64_t time) {
+    size_t dropped = 0;
+    while (WGRingCount(&index->stamps) > 0) {
+        const WGRecordStamp *stamp = WGRingAt(&index->stamps, 0);
+        if (stamp->time >= time) {
+            break;
+        }
+        WGRecordIndexEvicted(index, stamp);
+        WGRingDropOldest(&index->stamps, 1);
+        dropped++;
+    }
+    WGRecordIndexCompact(index);
+    return dropped;
+}
+
+#pragma mark - Query
+
+// Sequence number of the first live record stamped at or after time
+static uint64_t WGRecordIndexSeqAtTime(const WGRecordIndex *index, uint64_t time) {
+    size_t low = 0;
+    size_t high = WGRingCount(&index->stamps);
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (((const WGRecordStamp *)WGRingAt(&index->stamps, mid))->time < time) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return index->firstSeq + low;
+}
+
+static bool WGPostingContains(const uint64_t *values, size_t count, uint64_t value) {
+    size_t position = WGLowerBound(values, count, value);
+    return position < count && values[position] == value;
+}
+
+size_t WGRecordIndexQuery(const WGRecordIndex *index, const WGRecordQuery *query,
+                          uint64_t *seqs, size_t max, uint64_t *next) {
+    uint64_t cursor = query->cursor;    // next may alias query->cursor
+    *next = 0;
+    if (query->keyCount > WG_RECORD_INDEX_MAX_KEYS) {
+        return 0;
+    }
+
+    // Candidate range [low, high) of sequence numbers
+    uint64_t low = WGRecordIndexSeqAtTime(index, query->since);
+    uint64_t high = query->until ? WGRecordIndexSeqAtTime(index, query->until) : index->nextSeq;
+    if (cursor) {
+        if (query->newestFirst && cursor < high) {
+            high = cursor;
+        } else if (!query->newestFirst && cursor >= low) {
+            low = cursor + 1;
+        }
+    }
+    if (low >= high) {
+        return 0;
+    }
+
+    // Drive from the shortest posting list (or the range itself)
+    const uint64_t *lists[WG_RECORD_INDEX_MAX_KEYS];
+    size_t counts[WG_RECORD_INDEX_MAX_KEYS];
+    size_t driver = 0;
+    for (size_t i = 0; i < query->keyCount; i++) {
+        counts[i] = WGPostingsGet(&index->postings, query->keys[i], &lists[i]);
+        if (counts[i] == 0) {
+            return 0;
+        }
+        if (counts[i] < counts[driver]) {
+            driver = i;
+        }
+    }
+
+    size_t begin = 0;
+    size_t end = (size_t)(high - low);
+    if (query->keyCount > 0) {
+        begin = WGLowerBound(lists[driver], counts[driver], low);
+        end = WGLowerBound(lists[driver], counts[driver], high);
+    }
+
+    size_t found = 0;
+    for (size_t i = 0; i < end - begin; i++) {
+        size_t position = query->newestFirst ? end - 1 - i : begin + i;
+        uint64_t seq = query->keyCount > 0 ? lists[driver][position] : low + position;
+
+        bool matches = true;
+        for (size_t k = 0; k < query->keyCount && matches; k++) {
+            matches = k == driver || WGPostingContains(lists[k], counts[k], seq);
+        }
+        if (!matches) {
+            continue;
+        }
+        if (found == max) {
+            // One more match exists: the page ends at the last one returned
+            *next = found > 0 ? seqs[found - 1] : cursor;
+            break;
+        }
+        seqs[found++] = seq;
+    }
+    return found;
+}
@@ -0,0 +1,138 @@
+/*
+ * WGRecordIndex.h - Time-Ordered Record Index
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * Secondary indexes over a bounded, append-only history (audit entries,
+ * anomalies) whose objects live in a ring of the same capacity. Each
+ * record gets a sequence number and a time stamp; stamps are kept
+ * non-decreasing, so a time range is two binary searches. A record may
+ * carry a few keys (event type, MAC, IP...), each with a posting list of
+ * sequence numbers in ascending order: a filtered query walks the shortest
+ * matching list and checks the other keys by binary search, and a cursor
+ * (the last sequence number returned) resumes it for the next page.
+ *
+ * Eviction is implicit - sequence numbers below firstSeq are gone. Posting
+ * lists skip them during queries and are compacted in bulk once stale
+ * postings outnumber live ones.
+ *
+ * WGPostings, the key -> sorted values multimap underneath, is also used
+ * on its own (e.g. MAC -> IPv4 addresses).
+ */
+
+#ifndef WG_RECORD_INDEX_H
+#define WG_RECORD_INDEX_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "WGHashMap.h"
+#include "WGRing.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WG_RECORD_INDEX_MAX_KEYS 4
+
+// Postings
+
+typedef struct {
+    uint64_t key;
+    uint64_t *values;           // Ascending from head
+    uint32_t head;
+    uint32_t count;
+    uint32_t capacity;
+} WGPostingList;
+
+typedef struct {
+    WGHashMap index;            // key -> list slot
+    WGPostingList *lists;
+    size_t listCount;
+    size_t listCapacity;
+    size_t total;               // Values across all lists
+} WGPostings;
+
+// Lifecycle
+bool WGPostingsInit(WGPostings *postings, size_t expectedKeys);
+void WGPostingsFree(WGPostings *postings);
+void WGPostingsClear(WGPostings *postings);
+
+// Keys are any uint64_t except UINT64_MAX. Add keeps each list ascending
+// (appending a new maximum is O(1)) and ignores duplicates; false only on
+// allocation failure. Remove returns whether the value was there; a key
+// whose list empties is released.
+bool WGPostingsAdd(WGPostings *postings, uint64_t key, uint64_t value);
+bool WGPostingsRemove(WGPostings *postings, uint64_t key, uint64_t value);
+
+// The values for key, ascending; valid until the next mutation
+size_t WGPostingsGet(const WGPostings *postings, uint64_t key, const uint64_t **values);
+
+// Drops values below minimum from every list, releasing emptied keys
+void WGPostingsTrimBelow(WGPostings *postings, uint64_t minimum);
+
+// Record index
+
+typedef struct {
+    uint64_t time;              // Clamped to be non-decreasing
+    uint32_t keyCount;
+} WGRecordStamp;
+
+typedef struct {
+    WGRing stamps;              // WGRecordStamp per live record, oldest first
+    uint64_t firstSeq;          // Oldest live record (nextSeq when empty)
+    uint64_t nextSeq;           // Starts at 1, so 0 is never a record
+    uint64_t lastTime;
+    size_t liveKeys;            // Postings of live records
+    WGPostings postings;        // key -> sequence numbers
+} WGRecordIndex;
+
+// Composes a key from a caller-chosen dimension (type, MAC, ...) and a
+// value of up to 56 bits, so different dimensions never collide
+static inline uint64_t WGRecordKey(uint8_t dimension, uint64_t value) {
+    return ((uint64_t)(dimension & 0x7F) << 56) | (value & 0x00FFFFFFFFFFFFFFULL);
+}
+
+// Lifecycle - capacity must match the ring holding the objects
+bool WGRecordIndexInit(WGRecordIndex *index, size_t capacity);
+void WGRecordIndexFree(WGRecordIndex *index);
+void WGRecordIndexClear(WGRecordIndex *index);  // Sequence numbers keep growing
+
+// Appends a record, evicting the oldest when full (as the object ring
+// does). The record is always added and *seq set; false means some keys
+// could not be indexed (allocation failure).
+bool WGRecordIndexAppend(WGRecordIndex *index, uint64_t time, const uint64_t *keys, size_t keyCount,
+                         uint64_t *seq);
+
+// Evicts every record stamped before time; returns how many, which the
+// owner then drops from the front of its ring
+size_t WGRecordIndexDropBefore(WGRecordIndex *index, uint64_t time);
+
+static inline size_t WGRecordIndexCount(const WGRecordIndex *index) {
+    return WGRingCount(&index->stamps);
+}
+
+// Age-order position (0 = oldest) of a live sequence number
+static inline size_t WGRecordIndexPosition(const WGRecordIndex *index, uint64_t seq) {
+    return (size_t)(seq - index->firstSeq);
+}
+
+typedef struct {
+    uint64_t since;             // Stamp >= since
+    uint64_t until;             // Stamp < until, 0 = no bound
+    const uint64_t *keys;       // Records carrying every key
+    size_t keyCount;
+    uint64_t cursor;            // Resume after this sequence number, 0 = first page
+    bool newestFirst;
+} WGRecordQuery;
+
+// Writes up to max matching sequence numbers in query order. *next is the
+// cursor for the following page, or 0 when nothing more matches.
+size_t WGRecordIndexQuery(const WGRecordIndex *index, const WGRecordQuery *query,
+                          uint64_t *seqs, size_t max, uint64_t *next);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WG_RECORD_INDEX_H */
@@ -0,0 +1,117 @@
+/*
+ * WGRing.c - Fixed-Capacity Ring Buffer Implementation
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ */
+
+#include "WGRing.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#pragma mark - Lifecycle
+
+bool WGRingInit(WGRing *ring, size_t elemSize, size_t capacity) {
+    memset(ring, 0, sizeof(*ring));
+    if (elemSize == 0 || capacity == 0) {
+        return false;
+    }
+    ring->storage = malloc(elemSize * capacity);
+    if (!ring->storage) {
+        return false;
+    }
+    ring->elemSize = elemSize;
+    ring->capacity = capacity;
+    return true;
+}
+
+void WGRingFree(WGRing *ring) {
+    free(ring->storage);
+    memset(ring, 0, sizeof(*ring));
+}
+
+void WGRingClear(WGRing *ring) {
+    ring->head = 0;
+    ring->count = 0;
+}
+
+#pragma mark - Access
+
+bool WGRingPush(WGRing *ring, const void *elem, void *evicted) {
+    if (ring->capacity == 0) {
+        return false;
+    }
+
+    if (ring->count < ring->capacity) {
+        memcpy(WGRingAt(ring, ring->count), elem, ring->elemSize);
+        ring->count++;
+        return false;
+    }
+
+    // Full: the oldest slot becomes the newest
+    void *slot = ring->storage + ring->head * ring->elemSize;
+    if (evicted) {
+        memcpy(evicted, slot, ring->elemSize);
+    }
+    memcpy(slot, elem, ring->elemSize);
+    if (++ring->head == ring->capacity) {
+        ring->head = 0;
+    }
+    return true;
+}
+
+void WGRingSegments(const WGRing *ring, const void **first, size_t *firstCount,
+                    const void **second, size_t *secondCount) {
+    size_t tail = ring->capacity - ring->head;
+    *first = ring->storage + ring->head * ring->elemSize;
+    if (ring->count <= tail) {
+        *firstCount = ring->count;
+        *second = ring->storage;
+        *secondCount = 0;
+    } else {
+        *firstCount = tail;
+        *second = ring->storage;
+        *secondCount = ring->count - tail;
+    }
+}
+
+size_t WGRingCopyOut(const WGRing *ring, void *dst, size_t max) {
+    const void *first, *second;
+    size_t firstCount, secondCount;
+    WGRingSegments(ring, &first, &firstCount, &second, &secondCount);
+
+    if (firstCount > max) {
+        firstCount = max;
+    }
+    if (secondCount > max - firstCount) {
+        secondCount = max - firstCount;
+    }
+    memcpy(dst, first, firstCount * ring->elemSize);
+    memcpy((uint8_t *)dst + firstCount * ring->elemSize, second, secondCount * ring->elemSize);
+    return firstCount + secondCount;
+}
+
+void WGRingDropOldest(WGRing *ring, size_t count) {
+    if (count >= ring->count) {
+        WGRingClear(ring);
+        return;
+    }
+    ring->head = (ring->head + count) % ring->capacity;
+    ring->count -= count;
+}
+
+void WGRingFilter(WGRing *ring, bool (*keep)(const void *elem, void *ctx),
+                  void (*removed)(void *elem, void *ctx), void *ctx) {
+    size_t kept = 0;
+    for (size_t i = 0; i < ring->count; i++) {
+        void *elem = WGRingAt(ring, i);
+        if (keep(elem, ctx)) {
+            if (kept != i) {
+                memcpy(WGRingAt(ring, kept), elem, ring->elemSize);
+            }
+            kept++;
+        } else if (removed) {
+            removed(elem, ctx);
+        }
+    }
+    ring->count = kept;
+}
@@ -0,0 +1,70 @@
+/*
+ * WGRing.h - Fixed-Capacity Ring Buffer
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * Stores fixed-size POD elements in one allocation. Once full, each push
+ * overwrites the oldest element in O(1). Contents are exposed oldest-first
+ * as at most two contiguous segments, so snapshots are two memcpy calls.
+ */
+
+#ifndef WG_RING_H
+#define WG_RING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint8_t *storage;
+    size_t elemSize;
+    size_t capacity;
+    size_t head;        // Index of the oldest element
+    size_t count;
+} WGRing;
+
+// Lifecycle
+bool WGRingInit(WGRing *ring, size_t elemSize, size_t capacity);
+void WGRingFree(WGRing *ring);
+void WGRingClear(WGRing *ring);
+
+// Appends a copy of elem. When full, the oldest element is copied to
+// evicted (if non-NULL) before being overwritten; returns true in that case.
+bool WGRingPush(WGRing *ring, const void *elem, void *evicted);
+
+// Element i in age order (0 = oldest); i must be < count
+static inline void *WGRingAt(const WGRing *ring, size_t i) {
+    size_t index = ring->head + i;
+    if (index >= ring->capacity) {
+        index -= ring->capacity;
+    }
+    return ring->storage + index * ring->elemSize;
+}
+
+// Oldest-first contiguous views; second is empty unless the data wraps
+void WGRingSegments(const WGRing *ring, const void **first, size_t *firstCount,
+                    const void **second, size_t *secondCount);
+
+// Copies up to max elements, oldest first; returns the number copied
+size_t WGRingCopyOut(const WGRing *ring, void *dst, size_t max);
+
+// Discards the count oldest elements (at most all of them)
+void WGRingDropOldest(WGRing *ring, size_t count);
+
+// Keeps elements for which keep() returns true, preserving order. Removed
+// elements are passed to removed() (if non-NULL) before being dropped.
+void WGRingFilter(WGRing *ring, bool (*keep)(const void *elem, void *ctx),
+                  void (*removed)(void *elem, void *ctx), void *ctx);
+
+static inline size_t WGRingCount(const WGRing *ring) {
+    return ring->count;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WG_RING_H */
@@ -0,0 +1,35 @@
+/*
+ * WGRingBuffer.h - Fixed-Capacity Object Ring Buffer
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * Object wrapper over WGRing: appends are O(1) and evict the oldest object
+ * once full. Reads return immutable oldest-first snapshots. Not thread-safe;
+ * owners confine access to one queue.
+ */
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface WGRingBuffer<ObjectType> : NSObject
+
+@property (nonatomic, readonly) NSUInteger capacity;
+@property (nonatomic, readonly) NSUInteger count;
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+// Mutation
+- (void)addObject:(ObjectType)object;
+- (void)removeAllObjects;
+- (void)removeOldestObjects:(NSUInteger)count;
+- (void)keepObjectsPassingTest:(BOOL (NS_NOESCAPE ^)(ObjectType object))predicate;
+
+// Copy-on-read access (oldest first)
+- (NSArray<ObjectType> *)allObjects;
+- (nullable ObjectType)lastObject;
+- (ObjectType)objectAtIndex:(NSUInteger)index; // 0 = oldest; index < count
+
+@end
+
+NS_ASSUME_NONNULL_END
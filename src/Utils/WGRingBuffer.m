@@ -0,0 +1,111 @@
+/*
+ * WGRingBuffer.m - Fixed-Capacity Object Ring Buffer Implementation
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ */
+
+#import "WGRingBuffer.h"
+#import "WGRing.h"
+
+// Slots hold +1 references taken with CFBridgingRetain
+typedef const void *WGRingObjectRef;
+
+static bool WGRingBufferKeep(const void *elem, void *ctx) {
+    BOOL (^predicate)(id) = (__bridge BOOL (^)(id))ctx;
+    return predicate((__bridge id)*(const WGRingObjectRef *)elem);
+}
+
+static void WGRingBufferRelease(void *elem, void *ctx) {
+    (void)ctx;
+    CFRelease(*(WGRingObjectRef *)elem);
+}
+
+@implementation WGRingBuffer {
+    WGRing _ring;
+}
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity {
+    self = [super init];
+    if (self) {
+        if (!WGRingInit(&_ring, sizeof(WGRingObjectRef), MAX(capacity, 1))) {
+            return nil;
+        }
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [self removeAllObjects];
+    WGRingFree(&_ring);
+}
+
+- (NSUInteger)capacity {
+    return _ring.capacity;
+}
+
+- (NSUInteger)count {
+    return _ring.count;
+}
+
+#pragma mark - Mutation
+
+- (void)addObject:(id)object {
+    WGRingObjectRef ref = CFBridgingRetain(object);
+    WGRingObjectRef evicted = NULL;
+    if (WGRingPush(&_ring, &ref, &evicted)) {
+        CFRelease(evicted);
+    }
+}
+
+- (void)removeAllObjects {
+    for (size_t i = 0; i < _ring.count; i++) {
+        CFRelease(*(WGRingObjectRef *)WGRingAt(&_ring, i));
+    }
+    WGRingClear(&_ring);
+}
+
+- (void)removeOldestObjects:(NSUInteger)count {
+    count = MIN(count, _ring.count);
+    for (size_t i = 0; i < count; i++) {
+        CFRelease(*(WGRingObjectRef *)WGRingAt(&_ring, i));
+    }
+    WGRingDropOldest(&_ring, count);
+}
+
+- (void)keepObjectsPassingTest:(BOOL (NS_NOESCAPE ^)(id))predicate {
+    WGRingFilter(&_ring, WGRingBufferKeep, WGRingBufferRelease, (__bridge void *)predicate);
+}
+
+#pragma mark - Access
+
+- (NSArray *)allObjects {
+    const void *first, *second;
+    size_t firstCount, secondCount;
+    WGRingSegments(&_ring, &first, &firstCount, &second, &secondCount);
+    
+    if (secondCount == 0) {
+        return [NSArray arrayWithObjects:(__unsafe_unretained id *)first count:firstCount];
+    }
+    
+    // Wrapped: linearize the references, then build the array once
+    WGRingObjectRef *refs = malloc(_ring.count * sizeof(WGRingObjectRef));
+    if (!refs) {
+        return @[];
+    }
+    WGRingCopyOut(&_ring, refs, _ring.count);
+    NSArray *objects = [NSArray arrayWithObjects:(__unsafe_unretained id *)refs count:_ring.count];
+    free(refs);
+    return objects;
+}
+
+- (id)lastObject {
+    if (_ring.count == 0) {
+        return nil;
+    }
+    return (__bridge id)*(WGRingObjectRef *)WGRingAt(&_ring, _ring.count - 1);
+}
+
+- (id)objectAtIndex:(NSUInteger)index {
+    return (__bridge id)*(WGRingObjectRef *)WGRingAt(&_ring, index);
+}
+
+@end
@@ -4,7 +4,7 @@
  */
 
 #import "WGSecureStorage.h"
-#import <Security/Security.h>
+#import "WGCrypto.h"
 
 static NSString *const kWGPreferencesKey = @"com.wifiguard.preferences";
 static NSString *const kWGOwnerConfirmedKey = @"ownerConfirmed";
@@ -32,8 +32,7 @@ static NSString *const kWGOwnerConfirmDateKey = @"ownerConfirmDate";
                 NSFileHandle *handle = [NSFileHandle fileHandleForWritingAtPath:path];
                 if (handle) {
                     NSMutableData *randomData = [NSMutableData dataWithLength:(NSUInteger)fileSize];
-                    int result = SecRandomCopyBytes(kSecRandomDefault, randomData.length, randomData.mutableBytes);
-                    if (result == 0) {
+                    if (WGCryptoRandomBytes(randomData.mutableBytes, randomData.length)) {
                         [handle writeData:randomData];
                         [handle synchronizeFile];
                     }
@@ -0,0 +1,200 @@
+/*
+ * WGSeries.c - Decimated Time Series Implementation
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ */
+
+#include "WGSeries.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define WG_SERIES_MIN_CAPACITY 64
+
+#pragma mark - Storage
+
+// Room for one more sample at the end, sliding or growing both arrays
+static bool WGSeriesReserveSample(WGSeries *series) {
+    if (series->head + series->count < series->capacity) {
+        return true;
+    }
+    if (series->head > 0 && series->head >= series->capacity / 2) {
+        memmove(series->times, series->times + series->head, series->count * sizeof(double));
+        memmove(series->values, series->values + series->head, series->count * sizeof(float));
+        series->head = 0;
+        return true;
+    }
+    size_t capacity = series->capacity ? series->capacity * 2 : WG_SERIES_MIN_CAPACITY;
+    double *times = realloc(series->times, capacity * sizeof(double));
+    if (!times) {
+        return false;
+    }
+    series->times = times;
+    float *values = realloc(series->values, capacity * sizeof(float));
+    if (!values) {
+        return false;
+    }
+    series->values = values;
+    series->capacity = capacity;
+    return true;
+}
+
+static bool WGSeriesReserveBucket(WGSeries *series) {
+    if (series->bucketHead + series->bucketCount < series->bucketCapacity) {
+        return true;
+    }
+    if (series->bucketHead > 0 && series->bucketHead >= series->bucketCapacity / 2) {
+        memmove(series->buckets, series->buckets + series->bucketHead,
+                series->bucketCount * sizeof(WGSeriesBucket));
+        series->bucketHead = 0;
+        return true;
+    }
+    size_t capacity = series->bucketCapacity ? series->bucketCapacity * 2 : WG_SERIES_MIN_CAPACITY;
+    WGSeriesBucket *buckets = realloc(series->buckets, capacity * sizeof(WGSeriesBucket));
+    if (!buckets) {
+        return false;
+    }
+    series->buckets = buckets;
+    series->bucketCapacity = capacity;
+    return true;
+}
+
+#pragma mark - Lifecycle
+
+static void WGSeriesSetWindow(WGSeries *series, double window, uint32_t columns) {
+    series->window = window > 0 ? window : 1;
+    series->columns = columns ? columns : 1;
+    series->width = series->window / series->columns;
+}
+
+bool WGSeriesInit(WGSeries *series, double window, uint32_t columns) {
+    memset(series, 0, sizeof(*series));
+    WGSeriesSetWindow(series, window, columns);
+    return true;
+}
+
+void WGSeriesFree(WGSeries *series) {
+    free(series->times);
+    free(series->values);
+    free(series->buckets);
+    series->times = NULL;
+    series->values = NULL;
+    series->buckets = NULL;
+    series->head = series->count = series->capacity = 0;
+    series->bucketHead = series->bucketCount = series->bucketCapacity = 0;
+}
+
+void WGSeriesClear(WGSeries *series) {
+    series->head = series->count = 0;
+    series->bucketHead = series->bucketCount = 0;
+}
+
+#pragma mark - Buckets
+
+static bool WGSeriesAddToBucket(WGSeries *series, double time, float value) {
+    int64_t index = (int64_t)floor(time / series->width);
+    if (series->bucketCount > 0) {
+        WGSeriesBucket *bucket = &series->buckets[series->bucketHead + series->bucketCount - 1];
+        if (bucket->index == index) {
+            if (value < bucket->min) {
+                bucket->min = value;
+                bucket->minFirst = false;
+            }
+            if (value > bucket->max) {
+                bucket->max = value;
+                bucket->minFirst = true;
+            }
+            bucket->last = value;
+            bucket->count++;
+            return true;
+        }
+    }
+    if (!WGSeriesReserveBucket(series)) {
+        return false;
+    }
+    series->buckets[series->bucketHead + series->bucketCount++] = (WGSeriesBucket){
+        .index = index,
+        .first = value,
+        .last = value,
+        .min = value,
+        .max = value,
+        .count = 1,
+        .minFirst = true
+    };
+    return true;
+}
+
+bool WGSeriesSetResolution(WGSeries *series, double window, uint32_t columns) {
+    WGSeriesSetWindow(series, window, columns);
+    series->bucketHead = series->bucketCount = 0;
+    for (size_t i = 0; i < series->count; i++) {
+        if (!WGSeriesAddToBucket(series, series->times[series->head + i], series->values[series->head + i])) {
+            WGSeriesClear(series);
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t WGSeriesBucketValues(const WGSeriesBucket *bucket, float values[4]) {
+    float ordered[4] = {
+        bucket->first,
+        bucket->minFirst ? bucket->min : bucket->max,
+        bucket->minFirst ? bucket->max : bucket->min,
+        bucket->last
+    };
+    size_t count = 0;
+    for (size_t i = 0; i < 4; i++) {
+        if (count == 0 || values[count - 1] != ordered[i]) {
+            values[count++] = ordered[i];
+        }
+    }
+    return count;
+}
+
+#pragma mark - Samples
+
+bool WGSeriesAppend(WGSeries *series, double time, float value) {
+    if (series->count > 0 && time < WGSeriesLastTime(series)) {
+        return true;
+    }
+    if (!WGSeriesReserveSample(series)) {
+        return false;
+    }
+    size_t slot = series->head + series->count;
+    if (!WGSeriesAddToBucket(series, time, value)) {
+        return false;
+    }
+    series->times[slot] = time;
+    series->values[slot] = value;
+    series->count++;
+    return true;
+}
+
+size_t WGSeriesTrim(WGSeries *series, double now) {
+    // Whole buckets only, so the oldest visible bucket stays complete
+    int64_t firstIndex = (int64_t)floor((now - series->window) / series->width);
+    double firstTime = (double)firstIndex * series->width;
+
+    size_t samples = 0;
+    while (samples < series->count && series->times[series->head + samples] < firstTime) {
+        samples++;
+    }
+    series->head += samples;
+    series->count -= samples;
+
+    size_t dropped = 0;
+    while (dropped < series->bucketCount && series->buckets[series->bucketHead + dropped].index < firstIndex) {
+        dropped++;
+    }
+    series->bucketHead += dropped;
+    series->bucketCount -= dropped;
+
+    if (series->count == 0) {
+        series->head = 0;
+    }
+    if (series->bucketCount == 0) {
+        series->bucketHead = 0;
+    }
+    return dropped;
+}
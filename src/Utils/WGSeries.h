@@ -0,0 +1,104 @@
+/*
+ * WGSeries.h - Decimated Time Series
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * One plotted signal (e.g. a network's RSSI) over a sliding time window.
+ * Raw samples are kept as two packed arrays (times, values) and reduced
+ * to one min/max bucket per pixel column as they arrive. Buckets are
+ * aligned to absolute time (index = floor(time / width)), so the window
+ * sliding forward never changes a finished bucket: new samples update the
+ * newest bucket or open the next one, and trimming drops buckets from the
+ * front. A renderer can therefore keep a path of finished buckets, append
+ * to it, and redraw only the open bucket as a tail.
+ *
+ * Changing the window or column count rebuckets the raw samples once.
+ * Not thread-safe.
+ */
+
+#ifndef WG_SERIES_H
+#define WG_SERIES_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    int64_t index;              // floor(time / width)
+    float first;
+    float last;
+    float min;
+    float max;
+    uint32_t count;
+    bool minFirst;              // The minimum was reached before the maximum
+} WGSeriesBucket;
+
+typedef struct {
+    double window;              // Seconds kept behind the newest trim time
+    uint32_t columns;           // Buckets across the window
+    double width;               // Seconds per bucket
+
+    // Raw samples, oldest first from head
+    double *times;
+    float *values;
+    size_t head;
+    size_t count;
+    size_t capacity;
+
+    // Buckets, oldest first from bucketHead
+    WGSeriesBucket *buckets;
+    size_t bucketHead;
+    size_t bucketCount;
+    size_t bucketCapacity;
+} WGSeries;
+
+// Lifecycle. window > 0 seconds, columns >= 1.
+bool WGSeriesInit(WGSeries *series, double window, uint32_t columns);
+void WGSeriesFree(WGSeries *series);
+void WGSeriesClear(WGSeries *series);
+
+// Rebuckets the raw samples for a new window / column count; false on
+// allocation failure (the series is then empty)
+bool WGSeriesSetResolution(WGSeries *series, double window, uint32_t columns);
+
+// Adds a sample. Samples older than the newest one are ignored (returns
+// true); false only on allocation failure.
+bool WGSeriesAppend(WGSeries *series, double time, float value);
+
+// Drops samples and buckets wholly before now - window; returns the
+// number of buckets dropped
+size_t WGSeriesTrim(WGSeries *series, double now);
+
+static inline size_t WGSeriesCount(const WGSeries *series) {
+    return series->count;
+}
+
+static inline double WGSeriesLastTime(const WGSeries *series) {
+    return series->count ? series->times[series->head + series->count - 1] : 0;
+}
+
+static inline size_t WGSeriesBucketCount(const WGSeries *series) {
+    return series->bucketCount;
+}
+
+// Bucket i in age order (0 = oldest); the last one is still open
+static inline const WGSeriesBucket *WGSeriesBucketAt(const WGSeries *series, size_t i) {
+    return &series->buckets[series->bucketHead + i];
+}
+
+static inline double WGSeriesBucketPosition(const WGSeries *series, double time) {
+    return time / series->width;
+}
+
+// The bucket as up to four values in time order - first, the two
+// extremes, last - with repeats dropped; returns how many
+size_t WGSeriesBucketValues(const WGSeriesBucket *bucket, float values[4]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WG_SERIES_H */
@@ -0,0 +1,69 @@
+/*
+ * WGTest.h - Unit Test Support
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * Each tests/WGTest*.c is one ctest executable over the portable Core/ and
+ * Utils/ C modules. A test is a plain function of checks; WG_CHECK reports
+ * file:line and keeps going, and WGTestFinish turns the failure count into
+ * the exit status. Tests use synthetic input only - no network, no root.
+ */
+
+#ifndef WG_TEST_H
+#define WG_TEST_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static int gWGTestFailures;
+
+#define WG_CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        gWGTestFailures++; \
+    } \
+} while (0)
+
+#define WG_CHECK_EQ(actual, expected) do { \
+    long long wgActual = (long long)(actual), wgExpected = (long long)(expected); \
+    if (wgActual != wgExpected) { \
+        fprintf(stderr, "%s:%d: %s == %lld, expected %lld\n", \
+                __FILE__, __LINE__, #actual, wgActual, wgExpected); \
+        gWGTestFailures++; \
+    } \
+} while (0)
+
+// Stops the current test when a precondition (setup, allocation) fails
+#define WG_REQUIRE(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: requirement failed: %s\n", __FILE__, __LINE__, #cond); \
+        gWGTestFailures++; \
+        return; \
+    } \
+} while (0)
+
+static inline void WGTestRun(const char *name, void (*test)(void)) {
+    int before = gWGTestFailures;
+    test();
+    printf("%s %s\n", gWGTestFailures == before ? "ok  " : "FAIL", name);
+}
+
+#define WG_RUN(test) WGTestRun(#test, test)
+
+static inline int WGTestFinish(void) {
+    if (gWGTestFailures) {
+        fprintf(stderr, "%d check(s) failed\n", gWGTestFailures);
+    }
+    return gWGTestFailures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+// Deterministic generator for randomised cases (xorshift64*)
+static inline uint64_t WGTestRandom(uint64_t *state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545F4914F6CDD1DULL;
+}
+
+#endif /* WG_TEST_H */
@@ -0,0 +1,178 @@
+/*
+ * WGTestARPAnalyzer.c - ARP Anomaly Engine Replay Tests
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * Replays recorded sequences of full tables (through the dump encoder and
+ * decoder, as WGARPDetector reads them) and notification batches through
+ * one WGARPAnalyzer, comparing every step's findings with the expected
+ * ones in order.
+ */
+
+#include "WGTest.h"
+#include "WGARPAnalyzer.h"
+#include "WGARPTable.h"
+
+#define GW      0xC0A80101u             // 192.168.1.1
+#define HOST2   0xC0A80102u
+#define HOST3   0xC0A80103u
+#define HOST4   0xC0A80104u
+#define MAC_GW  0xAABBCC000001ULL
+#define MAC_H2  0xAABBCC000002ULL
+#define MAC_H3  0xAABBCC000003ULL
+#define MAC_ATT 0x0E0000000066ULL       // Attacker
+
+#define UPSERT(a, m)    { .kind = WGARPEventUpsert, \
+                          .record = { .ip = (a), .mac = (m), .ifindex = 4, .flags = WGARPRecordFlagComplete } }
+#define DELETE(a)       { .kind = WGARPEventDelete, .record = { .ip = (a) } }
+
+typedef struct {
+    uint8_t kind;           // WGARPFindingKind
+    uint8_t severity;
+    uint32_t ip;            // 0 for DuplicateMAC
+    uint64_t currentMAC;
+    uint32_t ipCount;       // DuplicateMAC
+} WGTestFinding;
+
+typedef struct {
+    const char *label;
+    bool events;            // Replayed with ApplyEvents, else as a full table
+    WGARPEvent input[6];    // Table records use UPSERT
+    size_t inputCount;
+    size_t changeCount;
+    WGTestFinding expect[4];
+    size_t expectCount;
+} WGTestStep;
+
+static const WGTestStep kWGTestSpoofSequence[] = {
+    { "baseline", false, { UPSERT(GW, MAC_GW), UPSERT(HOST2, MAC_H2), UPSERT(HOST3, MAC_H3) }, 3,
+      3, { { 0 } }, 0 },
+    { "quiet", false, { UPSERT(GW, MAC_GW), UPSERT(HOST2, MAC_H2), UPSERT(HOST3, MAC_H3) }, 3,
+      0, { { 0 } }, 0 },
+    { "gateway spoofed", false, { UPSERT(GW, MAC_ATT), UPSERT(HOST2, MAC_H2), UPSERT(HOST3, MAC_H3) }, 3,
+      1, { { WGARPFindingGatewayEntryChange, 10, GW, MAC_ATT, 0 },
+           { WGARPFindingGatewayMACChange, 10, GW, MAC_ATT, 0 } }, 2 },
+    { "attacker joins", false,
+      { UPSERT(GW, MAC_ATT), UPSERT(HOST2, MAC_H2), UPSERT(HOST3, MAC_H3), UPSERT(HOST4, MAC_ATT) }, 4,
+      1, { { WGARPFindingDuplicateMAC, 7, 0, MAC_ATT, 2 } }, 1 },
+    { "attacker leaves, host takeover", true, { DELETE(HOST4), UPSERT(HOST3, MAC_H2) }, 2,
+      2, { { WGARPFindingMACChange, 6, HOST3, MAC_H2, 0 },
+           { WGARPFindingDuplicateMAC, 7, 0, MAC_H2, 2 } }, 2 },
+    { "gateway restored", true, { UPSERT(GW, MAC_GW) }, 1,
+      1, { { WGARPFindingGatewayEntryChange, 10, GW, MAC_GW, 0 },
+           { WGARPFindingGatewayMACChange, 10, GW, MAC_GW, 0 } }, 2 },
+    { "repeated upsert", true, { UPSERT(GW, MAC_GW), UPSERT(HOST2, MAC_H2) }, 2,
+      0, { { 0 } }, 0 },
+    { "resync", false, { UPSERT(GW, MAC_GW), UPSERT(HOST2, MAC_H2), UPSERT(HOST3, MAC_H3) }, 3,
+      1, { { WGARPFindingMACChange, 6, HOST3, MAC_H3, 0 } }, 1 },
+};
+
+// Full tables go through the dump format, as WGARPSystemRead returns them
+static bool WGTestCheckTable(WGARPAnalyzer *analyzer, const WGTestStep *step, WGARPTable *table) {
+    WGARPRecord records[6];
+    for (size_t i = 0; i < step->inputCount; i++) {
+        records[i] = step->input[i].record;
+    }
+    uint8_t dump[6 * 256];
+    size_t length = WGARPDumpEncode(records, step->inputCount, dump, sizeof(dump));
+    return length <= sizeof(dump) &&
+           WGARPTableParseDump(table, dump, length) == (long)step->inputCount &&
+           WGARPAnalyzerCheck(analyzer, table);
+}
+
+static void WGTestReplay(const WGTestStep *steps, size_t count) {
+    WGARPAnalyzer analyzer;
+    WGARPTable table;
+    WG_REQUIRE(WGARPAnalyzerInit(&analyzer));
+    WGARPTableInit(&table);
+    analyzer.hasGateway = true;
+    analyzer.gatewayIP = GW;
+
+    for (size_t s = 0; s < count; s++) {
+        const WGTestStep *step = &steps[s];
+        bool ok = step->events ? WGARPAnalyzerApplyEvents(&analyzer, step->input, step->inputCount)
+                               : WGTestCheckTable(&analyzer, step, &table);
+        if (!ok) {
+            fprintf(stderr, "step '%s' failed\n", step->label);
+            gWGTestFailures++;
+            break;
+        }
+
+        int before = gWGTestFailures;
+        WG_CHECK_EQ(analyzer.changeCount, step->changeCount);
+        WG_CHECK_EQ(analyzer.findingCount, step->expectCount);
+        for (size_t i = 0; i < step->expectCount && i < analyzer.findingCount; i++) {
+            const WGARPFinding *finding = &analyzer.findings[i];
+            const WGTestFinding *expect = &step->expect[i];
+            WG_CHECK_EQ(finding->kind, expect->kind);
+            WG_CHECK_EQ(finding->severity, expect->severity);
+            WG_CHECK_EQ(finding->currentMAC, expect->currentMAC);
+            if (expect->kind == WGARPFindingDuplicateMAC) {
+                WG_CHECK_EQ(finding->ipCount, expect->ipCount);
+            } else {
+                WG_CHECK_EQ(finding->ip, expect->ip);
+            }
+        }
+        if (gWGTestFailures != before) {
+            fprintf(stderr, "  in step '%s'\n", step->label);
+        }
+    }
+
+    WGARPTableFree(&table);
+    WGARPAnalyzerFree(&analyzer);
+}
+
+static void testSpoofSequence(void) {
+    WGTestReplay(kWGTestSpoofSequence, sizeof(kWGTestSpoofSequence) / sizeof(kWGTestSpoofSequence[0]));
+}
+
+// The same sequence with checks switched off reports nothing but still
+// tracks the table
+static void testDisabledChecks(void) {
+    WGARPAnalyzer analyzer;
+    WGARPTable table;
+    WG_REQUIRE(WGARPAnalyzerInit(&analyzer));
+    WGARPTableInit(&table);
+    analyzer.hasGateway = true;
+    analyzer.gatewayIP = GW;
+    analyzer.alertOnMACChange = false;
+    analyzer.alertOnDuplicateMAC = false;
+    analyzer.alertOnGatewayChange = false;
+
+    size_t count = sizeof(kWGTestSpoofSequence) / sizeof(kWGTestSpoofSequence[0]);
+    for (size_t s = 0; s < count; s++) {
+        const WGTestStep *step = &kWGTestSpoofSequence[s];
+        WG_CHECK(step->events ? WGARPAnalyzerApplyEvents(&analyzer, step->input, step->inputCount)
+                              : WGTestCheckTable(&analyzer, step, &table));
+        WG_CHECK_EQ(analyzer.findingCount, 0);
+        WG_CHECK_EQ(analyzer.changeCount, step->changeCount);
+    }
+    WG_CHECK_EQ(analyzer.snapshot.count, 3);
+
+    WGARPTableFree(&table);
+    WGARPAnalyzerFree(&analyzer);
+}
+
+// A trusted gateway MAC is not a gateway change
+static void testTrustedGateway(void) {
+    WGARPAnalyzer analyzer;
+    WG_REQUIRE(WGARPAnalyzerInit(&analyzer));
+    analyzer.hasGateway = true;
+    analyzer.gatewayIP = GW;
+
+    WGARPEvent baseline[] = { UPSERT(GW, MAC_GW) };
+    WGARPEvent failover[] = { UPSERT(GW, MAC_H2) };
+    WG_CHECK(WGARPAnalyzerApplyEvents(&analyzer, baseline, 1));
+    WG_CHECK(WGARPAnalyzerSetTrustedMAC(&analyzer, GW, MAC_H2));
+    WG_CHECK(WGARPAnalyzerApplyEvents(&analyzer, failover, 1));
+    for (size_t i = 0; i < analyzer.findingCount; i++) {
+        WG_CHECK(analyzer.findings[i].kind != WGARPFindingGatewayMACChange);
+    }
+    WGARPAnalyzerFree(&analyzer);
+}
+
+int main(void) {
+    WG_RUN(testSpoofSequence);
+    WG_RUN(testDisabledChecks);
+    WG_RUN(testTrustedGateway);
+    return WGTestFinish();
+}
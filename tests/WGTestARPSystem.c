@@ -0,0 +1,129 @@
+/*
+ * WGTestARPSystem.c - Linux ARP Table Source Tests
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * Feeds recorded /proc/net/arp text through the Linux reader and decodes
+ * the re-encoded dump the way WGARPDetector does.
+ */
+
+#include "WGTest.h"
+#include "WGARPAnalyzer.h"
+#include "WGARPSystem.h"
+#include "WGARPTable.h"
+
+#include <net/if.h>
+#include <string.h>
+#include <unistd.h>
+
+// Writes text to a temporary file; the caller unlinks path
+static bool WGTestWriteFile(char *path, const char *text) {
+    strcpy(path, "/tmp/wgtest-XXXXXX");
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        return false;
+    }
+    size_t length = strlen(text);
+    bool ok = write(fd, text, length) == (ssize_t)length;
+    close(fd);
+    return ok;
+}
+
+static bool WGTestReadTable(const char *text, WGARPTable *table) {
+    char path[32];
+    WGARPDump dump;
+    WGARPDumpInit(&dump);
+    bool ok = WGTestWriteFile(path, text) &&
+              WGARPSystemReadFile(&dump, path) &&
+              WGARPTableParseDump(table, dump.data, dump.length) >= 0;
+    unlink(path);
+    WGARPDumpFree(&dump);
+    return ok;
+}
+
+static const char *kWGTestARPHeader =
+    "IP address       HW type     Flags       HW address            Mask     Device\n";
+
+static void testResolvedEntries(void) {
+    char text[512];
+    snprintf(text, sizeof(text), "%s"
+             "192.168.1.1      0x1         0x2         aa:bb:cc:00:00:01     *        lo\n"
+             "192.168.1.20     0x1         0x6         aa:bb:cc:00:00:14     *        lo\n",
+             kWGTestARPHeader);
+
+    WGARPTable table;
+    WGARPTableInit(&table);
+    WG_REQUIRE(WGTestReadTable(text, &table));
+    WG_CHECK_EQ(table.count, 2);
+    WG_CHECK_EQ(table.records[0].ip, 0xC0A80101u);
+    WG_CHECK_EQ(table.records[0].mac, 0xAABBCC000001ULL);
+    WG_CHECK_EQ(table.records[0].ifindex, if_nametoindex("lo"));
+    WG_CHECK_EQ(table.records[0].flags, WGARPRecordFlagComplete);
+    WG_CHECK_EQ(table.records[1].flags, WGARPRecordFlagComplete | WGARPRecordFlagPermanent);
+    WGARPTableFree(&table);
+}
+
+// Incomplete neighbours (no ATF_COM) carry 00:00:00:00:00:00 and must not
+// reach the analyzer as a shared MAC or as a MAC change once resolved
+static void testIncompleteEntriesSkipped(void) {
+    char text[768];
+    snprintf(text, sizeof(text), "%s"
+             "192.168.1.30     0x1         0x0         00:00:00:00:00:00     *        lo\n"
+             "192.168.1.31     0x1         0x0         00:00:00:00:00:00     *        lo\n"
+             "192.168.1.32     0x1         0x2         aa:bb:cc:00:00:20     *        lo\n",
+             kWGTestARPHeader);
+
+    WGARPTable table;
+    WGARPAnalyzer analyzer;
+    WGARPTableInit(&table);
+    WG_REQUIRE(WGARPAnalyzerInit(&analyzer));
+    WG_REQUIRE(WGTestReadTable(text, &table));
+    WG_CHECK_EQ(table.count, 1);
+    WG_CHECK_EQ(table.records[0].ip, 0xC0A80120u);
+    WG_CHECK(WGARPAnalyzerCheck(&analyzer, &table));
+    WG_CHECK_EQ(analyzer.findingCount, 0);
+
+    // 192.168.1.30 resolves: a new entry, not a change
+    table.count = 0;
+    snprintf(text, sizeof(text), "%s"
+             "192.168.1.30     0x1         0x2         aa:bb:cc:00:00:1e     *        lo\n"
+             "192.168.1.32     0x1         0x2         aa:bb:cc:00:00:20     *        lo\n",
+             kWGTestARPHeader);
+    WG_REQUIRE(WGTestReadTable(text, &table));
+    WG_CHECK(WGARPAnalyzerCheck(&analyzer, &table));
+    WG_CHECK_EQ(analyzer.findingCount, 0);
+    WG_CHECK_EQ(analyzer.macChangeCount, 0);
+    WG_CHECK_EQ(analyzer.changeCount, 1);
+
+    WGARPAnalyzerFree(&analyzer);
+    WGARPTableFree(&table);
+}
+
+static void testMalformedLines(void) {
+    char text[512];
+    snprintf(text, sizeof(text), "%s"
+             "not-an-ip        0x1         0x2         aa:bb:cc:00:00:01     *        lo\n"
+             "192.168.1.2      0x1         0x2         zz:zz                 *        lo\n"
+             "192.168.1.3\n",
+             kWGTestARPHeader);
+
+    WGARPTable table;
+    WGARPTableInit(&table);
+    WG_REQUIRE(WGTestReadTable(text, &table));
+    WG_CHECK_EQ(table.count, 0);
+    WGARPTableFree(&table);
+}
+
+static void testMissingFile(void) {
+    WGARPDump dump;
+    WGARPDumpInit(&dump);
+    WG_CHECK(!WGARPSystemReadFile(&dump, "/nonexistent/wgtest/arp"));
+    WGARPDumpFree(&dump);
+}
+
+int main(void) {
+    WG_RUN(testResolvedEntries);
+    WG_RUN(testIncompleteEntriesSkipped);
+    WG_RUN(testMalformedLines);
+    WG_RUN(testMissingFile);
+    return WGTestFinish();
+}
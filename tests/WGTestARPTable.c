@@ -0,0 +1,181 @@
+/*
+ * WGTestARPTable.c - Route Dump Decoder Tests
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * Hand-built Darwin NET_RT_FLAGS messages through WGARPTableParseDump:
+ * round trips, the shortest valid messages, short or foreign sockaddrs and
+ * truncated input. Run under ASan to catch out-of-bounds reads and writes.
+ */
+
+#include "WGTest.h"
+#include "WGARPTable.h"
+#include "WGRouteMessage.h"
+
+#include <string.h>
+
+// Header + sockaddr_inarp (sin_len bytes, rounded) + sockaddr_dl with a
+// MAC of alen bytes; returns the message size
+static size_t WGTestEncodeMessage(uint8_t *buf, uint8_t sinLen, uint8_t family, uint8_t alen,
+                                  uint32_t ip, uint64_t mac) {
+    size_t sinSize = WG_RT_ROUNDUP(sinLen);
+    size_t length = sizeof(wg_rt_msghdr) + sinSize + WG_SDL_DATA_OFFSET + alen;
+    // The decoder reads a whole inarp before looking at sin_len
+    if (length < sizeof(wg_rt_msghdr) + sizeof(wg_sockaddr_inarp)) {
+        length = sizeof(wg_rt_msghdr) + sizeof(wg_sockaddr_inarp);
+    }
+    memset(buf, 0, length);
+
+    wg_rt_msghdr rtm = { 0 };
+    rtm.rtm_msglen = (uint16_t)length;
+    rtm.rtm_version = WG_RTM_VERSION;
+    rtm.rtm_type = WG_RTM_GET;
+    rtm.rtm_index = 3;
+    rtm.rtm_flags = WG_RTF_UP | WG_RTF_HOST | WG_RTF_LLINFO;
+    rtm.rtm_addrs = WG_RTA_DST | WG_RTA_GATEWAY;
+    memcpy(buf, &rtm, sizeof(rtm));
+
+    uint8_t *sa = buf + sizeof(wg_rt_msghdr);
+    sa[0] = sinLen;
+    sa[1] = WG_AF_INET;
+    sa[4] = (uint8_t)(ip >> 24);
+    sa[5] = (uint8_t)(ip >> 16);
+    sa[6] = (uint8_t)(ip >> 8);
+    sa[7] = (uint8_t)ip;
+
+    uint8_t *dl = sa + sinSize;
+    dl[0] = (uint8_t)(WG_SDL_DATA_OFFSET + alen);
+    dl[1] = family;
+    dl[4] = WG_IFT_ETHER;
+    dl[6] = alen;
+    for (uint8_t i = 0; i < alen && i < 6; i++) {
+        dl[WG_SDL_DATA_OFFSET + i] = (uint8_t)(mac >> (8 * (5 - i)));
+    }
+    return length;
+}
+
+static void testRoundTrip(void) {
+    WGARPRecord records[3] = {
+        { .ip = 0xC0A80101u, .mac = 0xAABBCC000001ULL, .ifindex = 4, .flags = WGARPRecordFlagComplete },
+        { .ip = 0xC0A80102u, .mac = 0xAABBCC000002ULL, .ifindex = 4,
+          .flags = WGARPRecordFlagComplete | WGARPRecordFlagPermanent },
+        { .ip = 0x0A000001u, .mac = 0x020000000001ULL, .ifindex = 9, .flags = WGARPRecordFlagComplete },
+    };
+    size_t length = WGARPDumpEncode(records, 3, NULL, 0);
+    uint8_t *dump = malloc(length);
+    WG_REQUIRE(dump);
+    WG_CHECK_EQ(WGARPDumpEncode(records, 3, dump, length), length);
+
+    WGARPTable table;
+    WGARPTableInit(&table);
+    WG_CHECK_EQ(WGARPTableParseDump(&table, dump, length), 3);
+    for (size_t i = 0; i < 3 && i < table.count; i++) {
+        WG_CHECK_EQ(table.records[i].ip, records[i].ip);
+        WG_CHECK_EQ(table.records[i].mac, records[i].mac);
+        WG_CHECK_EQ(table.records[i].ifindex, records[i].ifindex);
+        WG_CHECK_EQ(table.records[i].flags, records[i].flags);
+    }
+    WGARPTableFree(&table);
+    free(dump);
+}
+
+// sin_len 0 rounds up to 4 bytes, giving 110-byte messages - shorter than
+// the estimate the table is sized from, so the table must grow
+static void testShortestMessages(void) {
+    enum { kCount = 1040 };
+    uint8_t *dump = malloc(kCount * 128);
+    WG_REQUIRE(dump);
+    size_t length = 0;
+    for (uint32_t i = 0; i < kCount; i++) {
+        length += WGTestEncodeMessage(dump + length, 0, WG_AF_LINK, 6, 0x0A000000u | i, 0x020000000000ULL | i);
+    }
+    WG_CHECK_EQ(length, kCount * 110);
+
+    WGARPTable table;
+    WGARPTableInit(&table);
+    WG_CHECK_EQ(WGARPTableParseDump(&table, dump, length), kCount);
+    WG_CHECK(table.capacity >= table.count);
+    // With sin_len 0 the sockaddr_dl overlaps the address, so only the MAC is checked
+    WG_CHECK_EQ(table.records[kCount - 1].mac, 0x020000000000ULL | (kCount - 1));
+    WGARPTableFree(&table);
+    free(dump);
+}
+
+// Incomplete (sdl_alen < 6) and non-link-layer entries carry no MAC
+static void testSkippedAddresses(void) {
+    uint8_t dump[512];
+    size_t length = 0;
+    length += WGTestEncodeMessage(dump + length, 16, WG_AF_LINK, 0, 0xC0A80101u, 0);
+    length += WGTestEncodeMessage(dump + length, 16, WG_AF_LINK, 4, 0xC0A80102u, 0xAABBCCDDULL);
+    length += WGTestEncodeMessage(dump + length, 16, WG_AF_INET, 6, 0xC0A80103u, 0xAABBCC000003ULL);
+    length += WGTestEncodeMessage(dump + length, 16, WG_AF_LINK, 6, 0xC0A80104u, 0xAABBCC000004ULL);
+
+    WGARPTable table;
+    WGARPTableInit(&table);
+    WG_CHECK_EQ(WGARPTableParseDump(&table, dump, length), 1);
+    WG_CHECK_EQ(table.records[0].ip, 0xC0A80104u);
+    WG_CHECK_EQ(table.records[0].ifindex, 3);
+    WGARPTableFree(&table);
+}
+
+// A message cut short stops the walk; a sockaddr_dl that would extend past
+// its message is ignored
+static void testTruncatedInput(void) {
+    uint8_t dump[512];
+    size_t first = WGTestEncodeMessage(dump, 16, WG_AF_LINK, 6, 0xC0A80101u, 0xAABBCC000001ULL);
+    size_t second = WGTestEncodeMessage(dump + first, 16, WG_AF_LINK, 6, 0xC0A80102u, 0xAABBCC000002ULL);
+
+    WGARPTable table;
+    WGARPTableInit(&table);
+    for (size_t cut = 1; cut < second; cut++) {
+        WG_CHECK_EQ(WGARPTableParseDump(&table, dump, first + second - cut), 1);
+    }
+    for (size_t cut = 1; cut < first; cut++) {
+        WG_CHECK_EQ(WGARPTableParseDump(&table, dump, first - cut), 0);
+    }
+
+    // rtm_msglen claims fewer bytes than the MAC needs
+    wg_rt_msghdr rtm;
+    memcpy(&rtm, dump, sizeof(rtm));
+    rtm.rtm_msglen = (uint16_t)(first - 2);
+    memcpy(dump, &rtm, sizeof(rtm));
+    WG_CHECK_EQ(WGARPTableParseDump(&table, dump, first - 2), 0);
+
+    // rtm_msglen shorter than a header stops the walk
+    rtm.rtm_msglen = 4;
+    memcpy(dump, &rtm, sizeof(rtm));
+    WG_CHECK_EQ(WGARPTableParseDump(&table, dump, first + second), 0);
+
+    WG_CHECK_EQ(WGARPTableParseDump(&table, NULL, 0), 0);
+    WGARPTableFree(&table);
+}
+
+static void testGatewayRoundTrip(void) {
+    WGARPRecord gateways[2] = {
+        { .ip = 0xC0A80101u, .ifindex = 4 },
+        { .ip = 0x0A000001u, .ifindex = 9 },
+    };
+    size_t length = WGARPGatewayDumpEncode(gateways, 2, NULL, 0);
+    uint8_t *dump = malloc(length);
+    WG_REQUIRE(dump);
+    WGARPGatewayDumpEncode(gateways, 2, dump, length);
+
+    WGARPTable table;
+    WGARPTableInit(&table);
+    WG_CHECK_EQ(WGARPTableParseGateways(&table, dump, length), 2);
+    WG_CHECK_EQ(table.records[0].ip, 0xC0A80101u);
+    WG_CHECK_EQ(table.records[1].ifindex, 9);
+
+    // A truncated final route is dropped
+    WG_CHECK_EQ(WGARPTableParseGateways(&table, dump, length - 1), 1);
+    WGARPTableFree(&table);
+    free(dump);
+}
+
+int main(void) {
+    WG_RUN(testRoundTrip);
+    WG_RUN(testShortestMessages);
+    WG_RUN(testSkippedAddresses);
+    WG_RUN(testTruncatedInput);
+    WG_RUN(testGatewayRoundTrip);
+    return WGTestFinish();
+}
@@ -0,0 +1,325 @@
+/*
+ * WGTestARPWatch.c - Kernel Notification Decoder Tests
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * Scripted rtnetlink and PF_ROUTE streams through the WGARPWatch decoders:
+ * neighbour updates, default route changes and removals, and truncated
+ * input, plus the split of an IP-sorted dump into per-interface shards.
+ * On Linux the live netlink socket is opened and drained as well.
+ */
+
+#include "WGTest.h"
+#include "WGARPShards.h"
+#include "WGARPWatch.h"
+#include "WGRouteMessage.h"
+
+#include <errno.h>
+#include <string.h>
+
+#define GW      0xC0A80101u             // 192.168.1.1
+#define HOST2   0xC0A80102u
+#define MAC_H2  0xAABBCC000002ULL
+
+#pragma mark - Netlink Encoding
+
+typedef struct {
+    uint8_t data[1024];
+    size_t length;
+    size_t start;           // Offset of the message being built
+} WGTestStream;
+
+static void WGTestBegin(WGTestStream *stream, uint16_t type, const void *body, size_t bodyLength) {
+    stream->start = stream->length;
+    wg_nlmsghdr nlh = { .nlmsg_type = type };
+    memcpy(stream->data + stream->length, &nlh, sizeof(nlh));
+    memcpy(stream->data + stream->length + sizeof(nlh), body, bodyLength);
+    stream->length += sizeof(nlh) + WG_NL_ALIGN(bodyLength);
+}
+
+static void WGTestAttr(WGTestStream *stream, uint16_t type, const void *value, size_t valueLength) {
+    wg_rtattr rta = { .rta_len = (uint16_t)(sizeof(rta) + valueLength), .rta_type = type };
+    memcpy(stream->data + stream->length, &rta, sizeof(rta));
+    memcpy(stream->data + stream->length + sizeof(rta), value, valueLength);
+    stream->length += WG_NL_ALIGN(rta.rta_len);
+}
+
+static void WGTestEnd(WGTestStream *stream) {
+    uint32_t length = (uint32_t)(stream->length - stream->start);
+    memcpy(stream->data + stream->start, &length, sizeof(length));
+}
+
+static void WGTestIPv4(uint8_t out[4], uint32_t ip) {
+    out[0] = (uint8_t)(ip >> 24);
+    out[1] = (uint8_t)(ip >> 16);
+    out[2] = (uint8_t)(ip >> 8);
+    out[3] = (uint8_t)ip;
+}
+
+static void WGTestNeighbour(WGTestStream *stream, uint16_t type, uint16_t state, uint32_t ip, uint64_t mac) {
+    wg_ndmsg ndm = { .ndm_family = WG_AF_INET, .ndm_ifindex = 4, .ndm_state = state };
+    uint8_t addr[4], lladdr[6];
+    WGTestIPv4(addr, ip);
+    for (int b = 0; b < 6; b++) {
+        lladdr[b] = (uint8_t)(mac >> (40 - 8 * b));
+    }
+    WGTestBegin(stream, type, &ndm, sizeof(ndm));
+    WGTestAttr(stream, WG_NDA_DST, addr, sizeof(addr));
+    if (mac) {
+        WGTestAttr(stream, WG_NDA_LLADDR, lladdr, sizeof(lladdr));
+    }
+    WGTestEnd(stream);
+}
+
+static void WGTestRoute(WGTestStream *stream, uint16_t type, uint8_t dstLength, uint8_t table,
+                        uint32_t gateway, uint32_t oif) {
+    wg_rtmsg rtm = { .rtm_family = WG_AF_INET, .rtm_dst_len = dstLength, .rtm_table = table };
+    uint8_t addr[4];
+    WGTestIPv4(addr, gateway);
+    WGTestBegin(stream, type, &rtm, sizeof(rtm));
+    WGTestAttr(stream, WG_RTA_OIF, &oif, sizeof(oif));
+    if (gateway) {
+        WGTestAttr(stream, WG_RTA_GATEWAY_NL, addr, sizeof(addr));
+    }
+    WGTestEnd(stream);
+}
+
+#pragma mark - Tests
+
+static void testNetlinkNeighbours(void) {
+    WGTestStream stream = { .length = 0 };
+    WGTestNeighbour(&stream, WG_RTM_NEWNEIGH, 0x02, HOST2, MAC_H2);
+    WGTestNeighbour(&stream, WG_RTM_NEWNEIGH, WG_NUD_INCOMPLETE, 0xC0A80103u, 0);
+    WGTestNeighbour(&stream, WG_RTM_NEWNEIGH, WG_NUD_FAILED, 0xC0A80104u, 0);
+    WGTestNeighbour(&stream, WG_RTM_DELNEIGH, 0x02, HOST2, MAC_H2);
+
+    WGARPEventBatch batch;
+    WGARPEventBatchInit(&batch);
+    WG_REQUIRE(WGARPDecodeNetlinkMessages(stream.data, stream.length, &batch) == 3);
+    WG_CHECK_EQ(batch.events[0].kind, WGARPEventUpsert);
+    WG_CHECK_EQ(batch.events[0].record.ip, HOST2);
+    WG_CHECK_EQ(batch.events[0].record.mac, MAC_H2);
+    WG_CHECK_EQ(batch.events[0].record.ifindex, 4);
+    WG_CHECK_EQ(batch.events[1].kind, WGARPEventDelete);
+    WG_CHECK_EQ(batch.events[1].record.ip, 0xC0A80104u);
+    WG_CHECK_EQ(batch.events[2].kind, WGARPEventDelete);
+    WG_CHECK_EQ(batch.events[2].record.ip, HOST2);
+    WGARPEventBatchFree(&batch);
+}
+
+// Only IPv4 default routes in the main table are gateway changes; a
+// deleted one is reported as gateway 0
+static void testNetlinkDefaultRoute(void) {
+    WGTestStream stream = { .length = 0 };
+    WGTestRoute(&stream, WG_RTM_NEWROUTE, 0, WG_RT_TABLE_MAIN, GW, 4);
+    WGTestRoute(&stream, WG_RTM_NEWROUTE, 24, WG_RT_TABLE_MAIN, GW, 4);
+    WGTestRoute(&stream, WG_RTM_NEWROUTE, 0, 255, GW, 4);
+    WGTestRoute(&stream, WG_RTM_DELROUTE, 24, WG_RT_TABLE_MAIN, 0, 4);
+    WGTestRoute(&stream, WG_RTM_DELROUTE, 0, WG_RT_TABLE_MAIN, GW, 4);
+
+    WGARPEventBatch batch;
+    WGARPEventBatchInit(&batch);
+    WG_REQUIRE(WGARPDecodeNetlinkMessages(stream.data, stream.length, &batch) == 2);
+    WG_CHECK_EQ(batch.events[0].kind, WGARPEventGatewayChange);
+    WG_CHECK_EQ(batch.events[0].record.ip, GW);
+    WG_CHECK_EQ(batch.events[0].record.ifindex, 4);
+    WG_CHECK_EQ(batch.events[1].kind, WGARPEventGatewayChange);
+    WG_CHECK_EQ(batch.events[1].record.ip, 0);
+    WG_CHECK_EQ(batch.events[1].record.ifindex, 4);
+    WGARPEventBatchFree(&batch);
+}
+
+static void testRouteSocketDefaultRoute(void) {
+    WGARPRecord gateway = { .ip = GW, .ifindex = 4 };
+    uint8_t stream[512];
+    size_t length = 0;
+    length += WGRouteEncodeGatewayMessage(&gateway, WG_RTM_ADD, stream + length);
+    length += WGRouteEncodeGatewayMessage(&gateway, WG_RTM_DELETE, stream + length);
+
+    // A delete that carries only the destination
+    size_t bare = WGRouteEncodeGatewayMessage(&gateway, WG_RTM_DELETE, stream + length);
+    wg_rt_msghdr rtm;
+    memcpy(&rtm, stream + length, sizeof(rtm));
+    rtm.rtm_addrs = WG_RTA_DST;
+    rtm.rtm_msglen = (uint16_t)(sizeof(rtm) + sizeof(wg_sockaddr_inarp));
+    memcpy(stream + length, &rtm, sizeof(rtm));
+    WG_CHECK(bare > rtm.rtm_msglen);
+    length += rtm.rtm_msglen;
+
+    WGARPEventBatch batch;
+    WGARPEventBatchInit(&batch);
+    WG_REQUIRE(WGARPDecodeRouteMessages(stream, length, &batch) == 3);
+    WG_CHECK_EQ(batch.events[0].kind, WGARPEventGatewayChange);
+    WG_CHECK_EQ(batch.events[0].record.ip, GW);
+    for (size_t i = 1; i < 3; i++) {
+        WG_CHECK_EQ(batch.events[i].kind, WGARPEventGatewayChange);
+        WG_CHECK_EQ(batch.events[i].record.ip, 0);
+        WG_CHECK_EQ(batch.events[i].record.ifindex, 4);
+    }
+    WGARPEventBatchFree(&batch);
+}
+
+static void testRouteSocketNeighbours(void) {
+    WGARPRecord record = { .ip = HOST2, .mac = MAC_H2, .ifindex = 4, .flags = WGARPRecordFlagComplete };
+    uint8_t stream[512];
+    size_t length = 0;
+    length += WGRouteEncodeARPMessage(&record, WG_RTM_ADD, stream + length);
+    length += WGRouteEncodeARPMessage(&record, WG_RTM_GET, stream + length);
+    length += WGRouteEncodeARPMessage(&record, WG_RTM_DELETE, stream + length);
+
+    WGARPEventBatch batch;
+    WGARPEventBatchInit(&batch);
+    WG_REQUIRE(WGARPDecodeRouteMessages(stream, length, &batch) == 2);
+    WG_CHECK_EQ(batch.events[0].kind, WGARPEventUpsert);
+    WG_CHECK_EQ(batch.events[0].record.mac, MAC_H2);
+    WG_CHECK_EQ(batch.events[1].kind, WGARPEventDelete);
+    WG_CHECK_EQ(batch.events[1].record.ip, HOST2);
+    WGARPEventBatchFree(&batch);
+}
+
+// Replays a scripted stream the way WGARPDetector handles a batch: gateway
+// changes go to the shard's analyzer, the rest is routed to the shards
+static void testScriptedGatewayRemoval(void) {
+    WGTestStream stream = { .length = 0 };
+    WGTestRoute(&stream, WG_RTM_NEWROUTE, 0, WG_RT_TABLE_MAIN, GW, 4);
+    WGTestNeighbour(&stream, WG_RTM_NEWNEIGH, 0x02, GW, 0xAABBCC000001ULL);
+    WGTestNeighbour(&stream, WG_RTM_NEWNEIGH, 0x02, HOST2, MAC_H2);
+    WGTestRoute(&stream, WG_RTM_DELROUTE, 0, WG_RT_TABLE_MAIN, GW, 4);
+
+    WGARPShardSet set;
+    WG_REQUIRE(WGARPShardSetInit(&set, NULL, NULL));
+    WGARPEventBatch batch;
+    WGARPEventBatchInit(&batch);
+
+    // One event at a time, to look at the gateway in between
+    bool expectGateway[] = { true, true, true, false };
+    size_t offset = 0;
+    for (size_t step = 0; step < 4 && offset < stream.length; step++) {
+        uint32_t length;
+        memcpy(&length, stream.data + offset, sizeof(length));
+        batch.count = 0;
+        WG_REQUIRE(WGARPDecodeNetlinkMessages(stream.data + offset, length, &batch) == 1);
+        offset += WG_NL_ALIGN(length);
+
+        const WGARPEvent *event = &batch.events[0];
+        if (event->kind == WGARPEventGatewayChange) {
+            WG_CHECK(WGARPShardSetGateway(&set, event->record.ifindex, event->record.ip));
+        }
+        WG_REQUIRE(WGARPShardSetRoute(&set, batch.events, batch.count));
+        WGARPShardSetCheckAll(&set, 1);
+
+        WGARPShard *shard = set.count ? set.shards[0] : NULL;
+        WG_REQUIRE(shard);
+        WG_CHECK_EQ(shard->analyzer.hasGateway, expectGateway[step]);
+        WG_CHECK_EQ(shard->analyzer.gatewayIP, expectGateway[step] ? GW : 0);
+    }
+    WG_CHECK_EQ(WGARPShardSetEntryCount(&set), 2);
+
+    // Deleting it again is not a change
+    WG_CHECK(!WGARPShardSetGateway(&set, 4, 0));
+
+    WGARPEventBatchFree(&batch);
+    WGARPShardSetFree(&set);
+}
+
+// A dump is sorted by IP, so two interfaces on overlapping subnets alternate
+// record by record. Each shard still gets all of its own, in IP order, and a
+// phone on both interfaces is not a duplicate MAC.
+static void testPartitionInterleaved(void) {
+    const uint64_t phone = 0xAABBCC000010ULL;
+    WGARPRecord records[6];
+    for (uint32_t i = 0; i < 6; i++) {
+        records[i] = (WGARPRecord){ .ip = GW + i, .mac = 0xAABBCC000001ULL + i,
+                                    .ifindex = (i % 2) ? 7 : 4, .flags = WGARPRecordFlagComplete };
+    }
+    records[2].mac = phone;
+    records[5].mac = phone;
+    uint8_t dump[6 * 256];
+    size_t length = WGARPDumpEncode(records, 6, dump, sizeof(dump));
+    WG_REQUIRE(length <= sizeof(dump));
+
+    WGARPTable table;
+    WGARPTableInit(&table);
+    WG_REQUIRE(WGARPTableParseDump(&table, dump, length) == 6);
+    WG_CHECK_EQ(table.records[0].ifindex, 4);
+    WG_CHECK_EQ(table.records[1].ifindex, 7);
+
+    WGARPShardSet set;
+    WG_REQUIRE(WGARPShardSetInit(&set, NULL, NULL));
+    WG_REQUIRE(WGARPShardSetPartition(&set, &table));
+    WG_REQUIRE(set.count == 2);
+    for (size_t s = 0; s < 2; s++) {
+        const WGARPShard *shard = set.shards[s];
+        WG_CHECK_EQ(shard->ifindex, s ? 7 : 4);
+        WG_REQUIRE(shard->table.count == 3);
+        for (size_t i = 0; i < 3; i++) {
+            WG_CHECK_EQ(shard->table.records[i].ifindex, shard->ifindex);
+            WG_CHECK_EQ(shard->table.records[i].ip, GW + s + 2 * i);
+        }
+    }
+    WGARPShardSetCheckAll(&set, 2);
+    WG_CHECK(WGARPShardSetMerge(&set));
+    WG_CHECK_EQ(set.changeCount, 6);
+    WG_CHECK_EQ(set.findingCount, 0);
+    WG_CHECK_EQ(WGARPShardSetEntryCount(&set), 6);
+
+    // Once interface 7 is gone from the dump its shard empties
+    length = WGARPDumpEncode((WGARPRecord[]){ records[0], records[2], records[4] }, 3, dump, sizeof(dump));
+    WG_REQUIRE(WGARPTableParseDump(&table, dump, length) == 3);
+    WG_REQUIRE(WGARPShardSetPartition(&set, &table));
+    WG_CHECK_EQ(set.shards[1]->table.count, 0);
+    WGARPShardSetCheckAll(&set, 2);
+    WG_CHECK(WGARPShardSetMerge(&set));
+    WG_CHECK_EQ(WGARPShardSetEntryCount(&set), 3);
+
+    WGARPShardSetFree(&set);
+    WGARPTableFree(&table);
+}
+
+// Every prefix of a valid stream decodes without reading past its end
+static void testTruncatedStreams(void) {
+    WGTestStream stream = { .length = 0 };
+    WGTestNeighbour(&stream, WG_RTM_NEWNEIGH, 0x02, HOST2, MAC_H2);
+    WGTestRoute(&stream, WG_RTM_DELROUTE, 0, WG_RT_TABLE_MAIN, GW, 4);
+
+    WGARPEventBatch batch;
+    WGARPEventBatchInit(&batch);
+    for (size_t cut = 0; cut <= stream.length; cut++) {
+        batch.count = 0;
+        long decoded = WGARPDecodeNetlinkMessages(stream.data, cut, &batch);
+        WG_CHECK(decoded >= 0 && decoded <= 2);
+        WG_CHECK_EQ(decoded == 2, cut == stream.length);
+    }
+    WGARPEventBatchFree(&batch);
+}
+
+#if defined(__linux__)
+// The live socket opens and drains without blocking; a sandbox without
+// rtnetlink is not a failure
+static void testLiveSocket(void) {
+    WGARPWatch watch;
+    if (!WGARPWatchOpen(&watch)) {
+        printf("  live socket unavailable (%s), skipped\n", strerror(errno));
+        return;
+    }
+    WGARPEventBatch batch;
+    WGARPEventBatchInit(&batch);
+    WG_CHECK(WGARPWatchRead(&watch, &batch) >= 0);
+    WGARPEventBatchFree(&batch);
+    WGARPWatchClose(&watch);
+    WG_CHECK_EQ(watch.fd, -1);
+}
+#endif
+
+int main(void) {
+    WG_RUN(testNetlinkNeighbours);
+    WG_RUN(testNetlinkDefaultRoute);
+    WG_RUN(testRouteSocketDefaultRoute);
+    WG_RUN(testRouteSocketNeighbours);
+    WG_RUN(testScriptedGatewayRemoval);
+    WG_RUN(testPartitionInterleaved);
+    WG_RUN(testTruncatedStreams);
+#if defined(__linux__)
+    WG_RUN(testLiveSocket);
+#endif
+    return WGTestFinish();
+}
@@ -0,0 +1,526 @@
+/*
+ * WGTestBeacon.c - pcap Reader and Beacon Parser Tests
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * Builds radiotap and raw 802.11 captures in memory (both byte orders,
+ * micro- and nanosecond timestamps) and replays them into a collecting
+ * sink and a WGScanIngest. Truncated and randomly corrupted packets are
+ * parsed from exact-size heap copies, so a build with -fsanitize=address
+ * catches any read past the end of a frame.
+ */
+
+#include "WGTest.h"
+#include "WGBeacon.h"
+#include "WGPcap.h"
+
+#include <string.h>
+
+#define BSSID_A 0x02000000000AULL
+#define BSSID_B 0x02000000000BULL
+#define BSSID_C 0x02000000000CULL
+#define BSSID_D 0x02000000000DULL
+
+#pragma mark - Frames
+
+typedef struct {
+    uint8_t bytes[512];
+    size_t length;
+} WGTestFrame;
+
+static void WGTestPut(WGTestFrame *frame, const void *data, size_t length) {
+    memcpy(frame->bytes + frame->length, data, length);
+    frame->length += length;
+}
+
+static void WGTestPutMAC(WGTestFrame *frame, WGMACAddress mac) {
+    for (int i = 0; i < 6; i++) {
+        frame->bytes[frame->length++] = (uint8_t)(mac >> (40 - 8 * i));
+    }
+}
+
+// Management header plus fixed fields; subtype 8 is a beacon, 5 a probe response
+static void WGTestFrameStart(WGTestFrame *frame, uint8_t control, WGMACAddress bssid, uint16_t capability) {
+    frame->length = 0;
+    const uint8_t head[] = { control, 0, 0, 0, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff };
+    WGTestPut(frame, head, sizeof(head));
+    WGTestPutMAC(frame, bssid);         // SA
+    WGTestPutMAC(frame, bssid);         // BSSID
+    const uint8_t fixed[] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 100, 0,
+                              (uint8_t)capability, (uint8_t)(capability >> 8) };
+    WGTestPut(frame, fixed, sizeof(fixed));
+}
+
+static void WGTestIE(WGTestFrame *frame, uint8_t id, const void *body, size_t length) {
+    const uint8_t header[] = { id, (uint8_t)length };
+    WGTestPut(frame, header, sizeof(header));
+    WGTestPut(frame, body, length);
+}
+
+static const uint8_t kWGTestRSNPSK[] = {
+    1, 0, 0x00, 0x0f, 0xac, 4, 1, 0, 0x00, 0x0f, 0xac, 4, 1, 0, 0x00, 0x0f, 0xac, 2, 0, 0
+};
+static const uint8_t kWGTestRSNSAE[] = {
+    1, 0, 0x00, 0x0f, 0xac, 4, 1, 0, 0x00, 0x0f, 0xac, 4,
+    2, 0, 0x00, 0x0f, 0xac, 2, 0x00, 0x0f, 0xac, 8, 0, 0
+};
+static const uint8_t kWGTestWPA[] = { 0x00, 0x50, 0xf2, 1, 1, 0 };
+static const uint8_t kWGTestHT40[] = { 36, 0x05, 0, 0, 0, 0 };         // Secondary above, any width
+static const uint8_t kWGTestVHT80[] = { 1, 42, 0, 0, 0 };
+static const uint8_t kWGTestHE6GHz[] = {
+    36, 0x00, 0x00, 0x02, 0, 0, 0,                                      // 6 GHz operation present
+    37, 0x02, 39, 0, 0                                                  // Primary 37, 80 MHz
+};
+
+// A: 2.4 GHz WPA2 beacon on channel 6
+static void WGTestFrameA(WGTestFrame *frame) {
+    WGTestFrameStart(frame, 0x80, BSSID_A, 0x0011);
+    WGTestIE(frame, 0, "alpha", 5);
+    WGTestIE(frame, 3, (const uint8_t[]){ 6 }, 1);
+    WGTestIE(frame, 48, kWGTestRSNPSK, sizeof(kWGTestRSNPSK));
+}
+
+// B: 5 GHz WPA probe response, 80 MHz, channel only in HT operation
+static void WGTestFrameB(WGTestFrame *frame) {
+    WGTestFrameStart(frame, 0x50, BSSID_B, 0x0011);
+    WGTestIE(frame, 0, "beta", 4);
+    WGTestIE(frame, 61, kWGTestHT40, sizeof(kWGTestHT40));
+    WGTestIE(frame, 192, kWGTestVHT80, sizeof(kWGTestVHT80));
+    WGTestIE(frame, 221, kWGTestWPA, sizeof(kWGTestWPA));
+}
+
+// D: hidden (all-NUL SSID) 6 GHz WPA3 beacon
+static void WGTestFrameD(WGTestFrame *frame) {
+    WGTestFrameStart(frame, 0x80, BSSID_D, 0x0011);
+    WGTestIE(frame, 0, (const uint8_t[]){ 0, 0, 0, 0 }, 4);
+    WGTestIE(frame, 48, kWGTestRSNSAE, sizeof(kWGTestRSNSAE));
+    WGTestIE(frame, 255, kWGTestHE6GHz, sizeof(kWGTestHE6GHz));
+}
+
+// Radiotap header: [TSFT], flags, channel, antenna signal, optionally with a
+// second (empty) present word
+static size_t WGTestRadiotap(uint8_t *out, bool tsft, bool extended, uint8_t flags,
+                             uint16_t frequency, int8_t signal) {
+    size_t n = extended ? 12 : 8;
+    memset(out, 0, 32);
+    uint32_t present = (1u << 1) | (1u << 3) | (1u << 5) | (tsft ? 1u : 0) | (extended ? 1u << 31 : 0);
+    for (int i = 0; i < 4; i++) {
+        out[4 + i] = (uint8_t)(present >> (8 * i));
+    }
+    if (tsft) {
+        n = (n + 7) & ~(size_t)7;
+        n += 8;
+    }
+    out[n++] = flags;
+    n = (n + 1) & ~(size_t)1;
+    out[n++] = (uint8_t)frequency;
+    out[n++] = (uint8_t)(frequency >> 8);
+    n += 2;                             // Channel flags
+    out[n++] = (uint8_t)signal;
+    out[2] = (uint8_t)n;
+    return n;
+}
+
+#pragma mark - Captures
+
+typedef struct {
+    uint8_t *data;
+    size_t length;
+    size_t capacity;
+    bool swapped;
+    bool nanosecond;
+} WGTestCapture;
+
+static bool WGTestCaptureRaw(WGTestCapture *capture, const void *data, size_t length) {
+    if (capture->length + length > capture->capacity) {
+        size_t capacity = (capture->capacity + length) * 2;
+        uint8_t *grown = realloc(capture->data, capacity);
+        if (!grown) {
+            return false;
+        }
+        capture->data = grown;
+        capture->capacity = capacity;
+    }
+    if (length > 0) {
+        memcpy(capture->data + capture->length, data, length);
+        capture->length += length;
+    }
+    return true;
+}
+
+static bool WGTestCapture32(WGTestCapture *capture, uint32_t value) {
+    if (capture->swapped) {
+        value = __builtin_bswap32(value);
+    }
+    return WGTestCaptureRaw(capture, &value, sizeof(value));
+}
+
+static bool WGTestCaptureStart(WGTestCapture *capture, uint32_t linkType) {
+    capture->length = 0;
+    return WGTestCapture32(capture, capture->nanosecond ? 0xa1b23c4du : 0xa1b2c3d4u) &&
+           WGTestCapture32(capture, 0x00040002) && WGTestCapture32(capture, 0) &&
+           WGTestCapture32(capture, 0) && WGTestCapture32(capture, 65535) &&
+           WGTestCapture32(capture, linkType);
+}
+
+// One record at seconds + milliseconds; the radiotap header may be NULL
+static bool WGTestCapturePacket(WGTestCapture *capture, uint32_t seconds, uint32_t milliseconds,
+                                const uint8_t *radiotap, size_t radiotapLength,
+                                const void *frame, size_t frameLength) {
+    uint32_t length = (uint32_t)(radiotapLength + frameLength);
+    return WGTestCapture32(capture, seconds) &&
+           WGTestCapture32(capture, milliseconds * (capture->nanosecond ? 1000000u : 1000u)) &&
+           WGTestCapture32(capture, length) && WGTestCapture32(capture, length) &&
+           WGTestCaptureRaw(capture, radiotap, radiotapLength) &&
+           WGTestCaptureRaw(capture, frame, frameLength);
+}
+
+// Beacons A, B, D and A again, around a data frame, a bad-FCS beacon, a
+// malformed radiotap header and a truncated trailing record
+static bool WGTestBuildCapture(WGTestCapture *capture) {
+    WGTestFrame frame;
+    uint8_t radiotap[32];
+    size_t length;
+    bool ok = WGTestCaptureStart(capture, WGPcapLinkRadiotap);
+
+    WGTestFrameA(&frame);
+    length = WGTestRadiotap(radiotap, false, false, 0, 2437, -40);
+    ok = ok && WGTestCapturePacket(capture, 1700000000, 0, radiotap, length, frame.bytes, frame.length);
+
+    WGTestFrameB(&frame);
+    length = WGTestRadiotap(radiotap, true, true, 0, 5180, -62);
+    ok = ok && WGTestCapturePacket(capture, 1700000000, 100, radiotap, length, frame.bytes, frame.length);
+
+    WGTestFrameStart(&frame, 0x08, BSSID_C, 0);                         // Data
+    length = WGTestRadiotap(radiotap, false, false, 0, 2412, -50);
+    ok = ok && WGTestCapturePacket(capture, 1700000000, 200, radiotap, length, frame.bytes, frame.length);
+
+    WGTestFrameA(&frame);
+    length = WGTestRadiotap(radiotap, false, false, 0x40, 2437, -40);    // Bad FCS
+    ok = ok && WGTestCapturePacket(capture, 1700000000, 300, radiotap, length, frame.bytes, frame.length);
+
+    WGTestFrameD(&frame);
+    length = WGTestRadiotap(radiotap, false, false, 0, 6135, -70);
+    ok = ok && WGTestCapturePacket(capture, 1700000000, 400, radiotap, length, frame.bytes, frame.length);
+
+    length = WGTestRadiotap(radiotap, false, false, 0, 2437, -40);
+    radiotap[2] = 200;                                                  // Longer than the packet
+    ok = ok && WGTestCapturePacket(capture, 1700000000, 500, radiotap, length, NULL, 0);
+
+    WGTestFrameA(&frame);
+    WGTestPut(&frame, "\xde\xad\xbe\xef", 4);
+    length = WGTestRadiotap(radiotap, false, false, 0x10, 2437, -45);    // FCS present
+    ok = ok && WGTestCapturePacket(capture, 1700000001, 250, radiotap, length, frame.bytes, frame.length);
+
+    // Record header claiming more bytes than the file holds
+    ok = ok && WGTestCapture32(capture, 1700000002) && WGTestCapture32(capture, 0) &&
+         WGTestCapture32(capture, 400) && WGTestCapture32(capture, 400) &&
+         WGTestCaptureRaw(capture, frame.bytes, 10);
+    return ok;
+}
+
+typedef struct {
+    WGScanRecord records[16];
+    size_t count;
+    size_t batches;
+    size_t refuseAfter;     // Batches accepted, 0 for all
+} WGTestSink;
+
+static bool WGTestCollect(void *context, const WGScanRecord *records, size_t count) {
+    WGTestSink *sink = context;
+    for (size_t i = 0; i < count && sink->count < 16; i++) {
+        sink->records[sink->count++] = records[i];
+    }
+    sink->batches++;
+    return sink->refuseAfter == 0 || sink->batches < sink->refuseAfter;
+}
+
+#pragma mark - Tests
+
+static void testFrequencies(void) {
+    static const struct { uint32_t frequency; uint8_t band; uint16_t channel; } cases[] = {
+        { 2412, WGChannelBand2GHz, 1 }, { 2472, WGChannelBand2GHz, 13 }, { 2484, WGChannelBand2GHz, 14 },
+        { 5180, WGChannelBand5GHz, 36 }, { 5825, WGChannelBand5GHz, 165 },
+        { 5935, WGChannelBand6GHz, 2 }, { 5955, WGChannelBand6GHz, 1 }, { 7115, WGChannelBand6GHz, 233 },
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        WGChannelBand band;
+        uint16_t channel;
+        WG_CHECK(WGBeaconChannelForFrequency(cases[i].frequency, &band, &channel));
+        WG_CHECK_EQ(band, cases[i].band);
+        WG_CHECK_EQ(channel, cases[i].channel);
+    }
+    WGChannelBand band;
+    uint16_t channel;
+    WG_CHECK(!WGBeaconChannelForFrequency(2400, &band, &channel));
+    WG_CHECK(!WGBeaconChannelForFrequency(4920, &band, &channel));
+}
+
+static void testRadiotap(void) {
+    uint8_t packet[64];
+    WGRadiotapInfo info;
+    size_t length = WGTestRadiotap(packet, true, true, 0x10, 5180, -61);
+    WG_CHECK_EQ(length, 31);
+    memset(packet + length, 0xAB, 10);
+    WG_REQUIRE(WGRadiotapParse(packet, length + 10, &info));
+    WG_CHECK_EQ(info.frequency, 5180);
+    WG_CHECK(info.hasSignal);
+    WG_CHECK_EQ(info.signal, -61);
+    WG_CHECK(info.frame == packet + length);
+    WG_CHECK_EQ(info.length, 6);        // FCS stripped
+    WG_CHECK(!info.badFCS);
+
+    // Every shorter header is rejected without reading past it
+    for (size_t cut = 0; cut < length; cut++) {
+        uint8_t *copy = malloc(cut ? cut : 1);
+        WG_REQUIRE(copy);
+        memcpy(copy, packet, cut);
+        if (cut >= 4) {
+            copy[2] = (uint8_t)cut;     // Header claims only what is there
+        }
+        WG_CHECK(!WGRadiotapParse(copy, cut, &info));
+        free(copy);
+    }
+
+    // A second present word that is itself cut off
+    uint8_t extended[] = { 0, 0, 8, 0, 0x00, 0x00, 0x00, 0x80 };
+    WG_CHECK(!WGRadiotapParse(extended, sizeof(extended), &info));
+    packet[0] = 1;                      // Unknown version
+    WG_CHECK(!WGRadiotapParse(packet, length, &info));
+}
+
+static void testFrames(void) {
+    WGTestFrame frame;
+    WGBeaconInfo info;
+
+    WGTestFrameA(&frame);
+    WG_REQUIRE(WGBeaconParseFrame(frame.bytes, frame.length, &info));
+    WG_CHECK_EQ(info.bssid, BSSID_A);
+    WG_CHECK(!info.probeResponse);
+    WG_CHECK(info.ssidLength == 5 && memcmp(info.ssid, "alpha", 5) == 0);
+    WG_CHECK_EQ(info.channel, 6);
+    WG_CHECK_EQ(info.channelWidth, 20);
+    WG_CHECK_EQ(info.band, WGChannelBand2GHz);
+    WG_CHECK_EQ(info.security, WGBeaconSecurityWPA2);
+
+    WGTestFrameB(&frame);
+    WG_REQUIRE(WGBeaconParseFrame(frame.bytes, frame.length, &info));
+    WG_CHECK(info.probeResponse);
+    WG_CHECK_EQ(info.channel, 36);
+    WG_CHECK_EQ(info.channelWidth, 80);
+    WG_CHECK_EQ(info.band, WGChannelBand5GHz);
+    WG_CHECK_EQ(info.security, WGBeaconSecurityWPA);
+
+    WGTestFrameD(&frame);
+    WG_REQUIRE(WGBeaconParseFrame(frame.bytes, frame.length, &info));
+    WG_CHECK(info.ssid == NULL);
+    WG_CHECK_EQ(info.ssidLength, 0);
+    WG_CHECK_EQ(info.channel, 37);
+    WG_CHECK_EQ(info.channelWidth, 80);
+    WG_CHECK_EQ(info.band, WGChannelBand6GHz);
+    WG_CHECK_EQ(info.security, WGBeaconSecurityWPA3);
+
+    // Privacy bit without RSN or WPA is WEP; no privacy is open
+    WGTestFrameStart(&frame, 0x80, BSSID_C, 0x0011);
+    WGTestIE(&frame, 0, "wep", 3);
+    WG_REQUIRE(WGBeaconParseFrame(frame.bytes, frame.length, &info));
+    WG_CHECK_EQ(info.security, WGBeaconSecurityWEP);
+    frame.bytes[34] = 0x01;
+    WG_REQUIRE(WGBeaconParseFrame(frame.bytes, frame.length, &info));
+    WG_CHECK_EQ(info.security, WGBeaconSecurityOpen);
+
+    // An element running past the frame ends the walk, the frame still parses
+    WGTestIE(&frame, 3, (const uint8_t[]){ 11 }, 1);
+    frame.bytes[frame.length - 1 - 1] = 9;
+    WG_REQUIRE(WGBeaconParseFrame(frame.bytes, frame.length, &info));
+    WG_CHECK_EQ(info.channel, 0);
+
+    // Not management, not a beacon, or too short
+    WGTestFrameStart(&frame, 0x08, BSSID_C, 0);
+    WG_CHECK(!WGBeaconParseFrame(frame.bytes, frame.length, &info));
+    WGTestFrameStart(&frame, 0x40, BSSID_C, 0);     // Probe request
+    WG_CHECK(!WGBeaconParseFrame(frame.bytes, frame.length, &info));
+    WG_CHECK(!WGBeaconParseFrame(frame.bytes, 35, &info));
+
+    // Every prefix of a full frame parses from an exact-size copy
+    WGTestFrameD(&frame);
+    for (size_t cut = 0; cut <= frame.length; cut++) {
+        uint8_t *copy = malloc(cut ? cut : 1);
+        WG_REQUIRE(copy);
+        memcpy(copy, frame.bytes, cut);
+        bool parsed = WGBeaconParseFrame(copy, cut, &info);
+        WG_CHECK(parsed == (cut >= 36));
+        free(copy);
+    }
+}
+
+static void WGTestReplayCapture(bool swapped, bool nanosecond) {
+    WGTestCapture capture = { .swapped = swapped, .nanosecond = nanosecond };
+    WG_REQUIRE(WGTestBuildCapture(&capture));
+    WGPcapReader reader;
+    WG_REQUIRE(WGPcapLoad(&reader, capture.data, capture.length) == WGPcapErrorNone);
+    WG_CHECK_EQ(reader.swapped, swapped);
+    WG_CHECK_EQ(reader.nanosecond, nanosecond);
+
+    WGTestSink sink = { .count = 0 };
+    WGBeaconReplayOptions options = { .batchSize = 3, .timeShift = 10.0 };
+    WGBeaconReplayStats stats;
+    WG_CHECK(WGBeaconReplay(&reader, &options, WGTestCollect, &sink, &stats));
+    WG_CHECK_EQ(stats.packets, 7);
+    WG_CHECK_EQ(stats.beacons, 4);
+    WG_CHECK_EQ(stats.skipped, 3);
+    WG_CHECK_EQ(stats.batches, 2);
+    WG_CHECK(stats.firstTimestamp == 1700000000.0);
+    WG_CHECK(stats.lastTimestamp > 1700000001.249 && stats.lastTimestamp < 1700000001.251);
+    WG_REQUIRE(sink.count == 4);
+
+    const WGScanRecord *a = &sink.records[0], *b = &sink.records[1], *d = &sink.records[2];
+    WG_CHECK_EQ(a->bssid, BSSID_A);
+    WG_CHECK(a->lastSeen == 1700000010.0);
+    WG_CHECK_EQ(a->rssi, -40);
+    WG_CHECK(strcmp(a->ssid, "alpha") == 0 && strcmp(a->security, "WPA2") == 0);
+    WG_CHECK_EQ(b->bssid, BSSID_B);
+    WG_CHECK_EQ(b->channel, 36);
+    WG_CHECK_EQ(b->channelWidth, 80);
+    WG_CHECK_EQ(b->rssi, -62);
+    WG_CHECK(strcmp(b->security, "WPA") == 0);
+    WG_CHECK_EQ(d->bssid, BSSID_D);
+    WG_CHECK_EQ(d->flags & WGScanRecordFlagHidden, WGScanRecordFlagHidden);
+    WG_CHECK_EQ(d->band, WGChannelBand6GHz);
+    WG_CHECK_EQ(d->channel, 37);
+    WG_CHECK(strcmp(d->security, "WPA3") == 0);
+    WG_CHECK_EQ(sink.records[3].rssi, -45);
+
+    // Through the scanner's table
+    WGScanIngest ingest;
+    WG_REQUIRE(WGScanIngestInit(&ingest, NULL, NULL));
+    WG_REQUIRE(WGScanIngestStart(&ingest));
+    WGPcapRewind(&reader);
+    WG_CHECK(WGBeaconReplay(&reader, NULL, WGBeaconIngestSink, &ingest, NULL));
+    WGScanIngestWaitIdle(&ingest);
+    WGScanSnapshot *snapshot = WGScanIngestSnapshot(&ingest);
+    WG_REQUIRE(snapshot);
+    WG_CHECK_EQ(snapshot->count, 3);
+    const WGScanRecord *record = WGScanSnapshotFind(snapshot, BSSID_A);
+    WG_CHECK(record && record->sampleSeq == 2 && record->rssi == -45);
+    WGScanSnapshotRelease(snapshot);
+    WGScanIngestFree(&ingest);
+
+    // A refusing sink and a raised cancel flag both stop after one batch
+    WGPcapRewind(&reader);
+    sink = (WGTestSink){ .refuseAfter = 1 };
+    options = (WGBeaconReplayOptions){ .batchSize = 1 };
+    WG_CHECK(!WGBeaconReplay(&reader, &options, WGTestCollect, &sink, &stats));
+    WG_CHECK_EQ(sink.batches, 1);
+    bool cancel = true;
+    WGPcapRewind(&reader);
+    sink = (WGTestSink){ .count = 0 };
+    options.cancel = &cancel;
+    WG_CHECK(!WGBeaconReplay(&reader, &options, WGTestCollect, &sink, &stats));
+    WG_CHECK_EQ(sink.batches, 1);
+
+    WGPcapClose(&reader);
+    free(capture.data);
+}
+
+static void testReplay(void) {
+    WGTestReplayCapture(false, false);
+    WGTestReplayCapture(true, true);
+}
+
+// Raw 802.11 with the FCS length declared in the link type
+static void testRawWithFCS(void) {
+    WGTestCapture capture = { .swapped = false };
+    WG_REQUIRE(WGTestCaptureStart(&capture, WGPcapLinkIEEE80211 | 0x04000000u | (2u << 28)));
+    WGTestFrame frame;
+    WGTestFrameA(&frame);
+    WGTestPut(&frame, "\x01\x02\x03\x04", 4);
+    WG_REQUIRE(WGTestCapturePacket(&capture, 1700000000, 0, NULL, 0, frame.bytes, frame.length));
+    WG_REQUIRE(WGTestCapturePacket(&capture, 1700000000, 1, NULL, 0, frame.bytes, 3));
+
+    WGPcapReader reader;
+    WG_REQUIRE(WGPcapLoad(&reader, capture.data, capture.length) == WGPcapErrorNone);
+    WG_CHECK_EQ(reader.fcsLength, 4);
+    WGPcapPacket packet;
+    WGBeaconInfo info;
+    WG_REQUIRE(WGPcapNext(&reader, &packet));
+    WG_CHECK(WGBeaconParsePacket(&reader, &packet, &info));
+    WG_CHECK_EQ(info.channel, 6);
+    WG_CHECK(!info.hasSignal);
+    WG_REQUIRE(WGPcapNext(&reader, &packet));
+    WG_CHECK(!WGBeaconParsePacket(&reader, &packet, &info));
+    WG_CHECK(!WGPcapNext(&reader, &packet));
+    WGPcapClose(&reader);
+    free(capture.data);
+}
+
+static void testPcapErrors(void) {
+    WGPcapReader reader;
+    uint8_t header[24] = { 0 };
+    WG_CHECK_EQ(WGPcapLoad(&reader, header, 10), WGPcapErrorFormat);
+    WG_CHECK_EQ(WGPcapLoad(&reader, header, sizeof(header)), WGPcapErrorFormat);
+
+    WGTestCapture capture = { .swapped = true };
+    WG_REQUIRE(WGTestCaptureStart(&capture, 1));                   // Ethernet
+    WG_CHECK_EQ(WGPcapLoad(&reader, capture.data, capture.length), WGPcapErrorLinkType);
+    free(capture.data);
+
+    WG_CHECK_EQ(WGPcapOpen(&reader, "/nonexistent/capture.pcap"), WGPcapErrorIO);
+    WGPcapPacket packet;
+    WG_CHECK(!WGPcapNext(&reader, &packet));
+}
+
+// Random corruption of every packet in the capture, each parsed from an
+// exact-size copy; whatever parses has its SSID inside the packet
+static void testCorruptPackets(void) {
+    WGTestCapture capture = { .swapped = false };
+    WG_REQUIRE(WGTestBuildCapture(&capture));
+    WGPcapReader reader;
+    WG_REQUIRE(WGPcapLoad(&reader, capture.data, capture.length) == WGPcapErrorNone);
+    WGPcapPacket packets[8];
+    size_t count = 0;
+    while (count < 8 && WGPcapNext(&reader, &packets[count])) {
+        count++;
+    }
+    WG_REQUIRE(count == 7);
+
+    uint64_t state = 0xBEAC0BEAC0ULL;
+    int before = gWGTestFailures;
+    for (int round = 0; round < 20000; round++) {
+        const WGPcapPacket *source = &packets[WGTestRandom(&state) % count];
+        uint32_t length = source->length;
+        if (WGTestRandom(&state) % 4 == 0) {
+            length = (uint32_t)(WGTestRandom(&state) % (length + 1));
+        }
+        uint8_t *copy = malloc(length ? length : 1);
+        WG_REQUIRE(copy);
+        memcpy(copy, source->data, length);
+        for (uint64_t flips = WGTestRandom(&state) % 5; flips > 0 && length > 0; flips--) {
+            copy[WGTestRandom(&state) % length] = (uint8_t)WGTestRandom(&state);
+        }
+
+        WGPcapPacket packet = { .data = copy, .length = length, .originalLength = length };
+        WGBeaconInfo info;
+        if (WGBeaconParsePacket(&reader, &packet, &info) && info.ssid) {
+            WG_CHECK(info.ssid >= copy && info.ssid + info.ssidLength <= copy + length);
+            WG_CHECK(info.ssidLength <= WG_SCAN_SSID_MAX);
+        }
+        free(copy);
+        if (gWGTestFailures != before) {
+            fprintf(stderr, "  in round %d\n", round);
+            break;
+        }
+    }
+    WGPcapClose(&reader);
+    free(capture.data);
+}
+
+int main(void) {
+    WG_RUN(testFrequencies);
+    WG_RUN(testRadiotap);
+    WG_RUN(testFrames);
+    WG_RUN(testReplay);
+    WG_RUN(testRawWithFCS);
+    WG_RUN(testPcapErrors);
+    WG_RUN(testCorruptPackets);
+    return WGTestFinish();
+}
@@ -0,0 +1,237 @@
+/*
+ * WGTestChannelAggregate.c - Incremental Channel Statistics Tests
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * Checks channel spans against hand-worked cases, then applies a random
+ * stream of adds, moves and removes to one WGChannelAggregate and after
+ * every step recounts each slot from the live placements, verifies both
+ * heaps, and compares the queries with a brute-force sort.
+ */
+
+#include "WGTest.h"
+#include "WGChannelAggregate.h"
+
+#include <string.h>
+
+typedef struct {
+    uint8_t band;
+    long channel;
+    long width;
+    uint16_t expect[16];
+    size_t expectCount;
+} WGTestSpan;
+
+static const WGTestSpan kWGTestSpans[] = {
+    { WGChannelBand2GHz, 6, 20, { 3, 4, 5, 6, 7, 8, 9 }, 7 },
+    { WGChannelBand2GHz, 6, 40, { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 }, 11 },
+    { WGChannelBand2GHz, 1, 80, { 1, 2, 3, 4, 5, 6 }, 6 },           // 2.4 GHz caps at 40
+    { WGChannelBand2GHz, 14, 20, { 11, 12, 13, 14 }, 4 },
+    { WGChannelBand5GHz, 36, 20, { 36 }, 1 },
+    { WGChannelBand5GHz, 44, 80, { 36, 40, 44, 48 }, 4 },
+    { WGChannelBand5GHz, 60, 160, { 36, 40, 44, 48, 52, 56, 60, 64 }, 8 },
+    { WGChannelBand5GHz, 157, 80, { 149, 153, 157, 161 }, 4 },
+    { WGChannelBand5GHz, 165, 40, { 165, 169 }, 2 },
+    { WGChannelBand5GHz, 38, 80, { 38 }, 1 },                        // Off the 20 MHz grid
+    { WGChannelBand6GHz, 37, 320, { 1, 5, 9, 13, 17, 21, 25, 29, 33, 37, 41, 45, 49, 53, 57, 61 }, 16 },
+    { WGChannelBand6GHz, 229, 40, { 225, 229 }, 2 },
+    { WGChannelBand6GHz, 233, 40, { 233 }, 1 },                      // Block runs past the band
+    { WGChannelBand5GHz, 0, 20, { 0 }, 0 },                          // Invalid
+};
+
+static void testSpans(void) {
+    for (size_t i = 0; i < sizeof(kWGTestSpans) / sizeof(kWGTestSpans[0]); i++) {
+        const WGTestSpan *t = &kWGTestSpans[i];
+        WGChannelPlacement placement = WGChannelPlacementMake((WGChannelBand)t->band, t->channel, t->width, -60);
+        uint16_t span[16];
+        size_t count = WGChannelSpan(&placement, span, 16);
+        WG_CHECK_EQ(count, t->expectCount);
+        if (count == t->expectCount && memcmp(span, t->expect, count * sizeof(uint16_t)) != 0) {
+            fprintf(stderr, "span of band %d channel %ld width %ld differs\n", t->band, t->channel, t->width);
+            gWGTestFailures++;
+        }
+    }
+}
+
+#pragma mark - Randomised
+
+#define WG_TEST_NETWORKS 200
+
+typedef struct {
+    WGChannelPlacement placement;
+    bool present;
+} WGTestNetwork;
+
+static WGChannelPlacement WGTestRandomPlacement(uint64_t *state) {
+    static const long kWidths[] = { 0, 20, 40, 80, 160, 320 };
+    WGChannelBand band = (WGChannelBand)(WGTestRandom(state) % 3);
+    long channel;
+    switch (WGTestRandom(state) % 8) {
+        case 0:
+            channel = (long)(WGTestRandom(state) % 260);   // Anything, invalid included
+            break;
+        default:
+            channel = band == WGChannelBand2GHz ? 1 + (long)(WGTestRandom(state) % 14) :
+                      band == WGChannelBand5GHz ? (WGTestRandom(state) % 2 ? 36 : 149) + 4 * (long)(WGTestRandom(state) % 8) :
+                                                  1 + 4 * (long)(WGTestRandom(state) % 59);
+            break;
+    }
+    long width = kWidths[WGTestRandom(state) % 6];
+    long rssi = -95 + (long)(WGTestRandom(state) % 70);
+    return WGChannelPlacementMake(band, channel, width, rssi);
+}
+
+static bool WGTestHeapBefore(const WGChannelAggregate *aggregate, bool quiet, uint16_t a, uint16_t b) {
+    const WGChannelSlot *sa = &aggregate->slots[a], *sb = &aggregate->slots[b];
+    if (quiet && WGChannelSlotCongestion(sa) != WGChannelSlotCongestion(sb)) {
+        return WGChannelSlotCongestion(sa) < WGChannelSlotCongestion(sb);
+    }
+    if (!quiet && sa->networkCount != sb->networkCount) {
+        return sa->networkCount > sb->networkCount;
+    }
+    return a < b;
+}
+
+// Membership, positions and order of one heap
+static bool WGTestCheckHeap(const WGChannelAggregate *aggregate, const WGChannelHeap *heap, int which) {
+    size_t occupied = 0;
+    for (int s = 0; s < WG_CHANNEL_SLOT_COUNT; s++) {
+        const WGChannelSlot *slot = &aggregate->slots[s];
+        if (WGChannelSlotOccupied(slot)) {
+            occupied++;
+            if (slot->heapPos[which] < 0 || heap->items[slot->heapPos[which]] != s) {
+                return false;
+            }
+        } else if (slot->heapPos[which] >= 0) {
+            return false;
+        }
+    }
+    if (heap->count != occupied) {
+        return false;
+    }
+    for (int pos = 1; pos < heap->count; pos++) {
+        if (WGTestHeapBefore(aggregate, which == 0, heap->items[pos], heap->items[(pos - 1) / 2])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Recounts every slot from the live placements and checks the queries
+static bool WGTestRecount(const WGChannelAggregate *aggregate, const WGTestNetwork *networks) {
+    static WGChannelSlot expect[WG_CHANNEL_SLOT_COUNT];
+    memset(expect, 0, sizeof(expect));
+    uint32_t total = 0;
+    for (size_t n = 0; n < WG_TEST_NETWORKS; n++) {
+        const WGChannelPlacement *p = &networks[n].placement;
+        if (!networks[n].present || !p->valid) {
+            continue;
+        }
+        int primary = WGChannelSlotIndex((WGChannelBand)p->band, p->channel);
+        expect[primary].networkCount++;
+        expect[primary].rssiSum += p->rssi;
+        total++;
+        uint16_t span[16];
+        size_t count = WGChannelSpan(p, span, 16);
+        for (size_t i = 0; i < count; i++) {
+            if (span[i] != p->channel) {
+                expect[WGChannelSlotIndex((WGChannelBand)p->band, span[i])].overlapCount++;
+            }
+        }
+    }
+
+    if (aggregate->networkCount != total) {
+        return false;
+    }
+    int crowded = -1;
+    uint16_t quiet[WG_CHANNEL_SLOT_COUNT];
+    size_t quietCount = 0;
+    for (int s = 0; s < WG_CHANNEL_SLOT_COUNT; s++) {
+        const WGChannelSlot *slot = &aggregate->slots[s];
+        if (slot->networkCount != expect[s].networkCount || slot->overlapCount != expect[s].overlapCount ||
+            slot->rssiSum != expect[s].rssiSum) {
+            fprintf(stderr, "slot %d: %u/%u/%lld, expected %u/%u/%lld\n", s,
+                    slot->networkCount, slot->overlapCount, (long long)slot->rssiSum,
+                    expect[s].networkCount, expect[s].overlapCount, (long long)expect[s].rssiSum);
+            return false;
+        }
+        if (slot->networkCount && (crowded < 0 || slot->networkCount > aggregate->slots[crowded].networkCount)) {
+            crowded = s;
+        }
+        if (WGChannelSlotOccupied(slot)) {
+            // Insertion sort by (congestion, slot)
+            size_t pos = quietCount++;
+            while (pos > 0 && WGTestHeapBefore(aggregate, true, (uint16_t)s, quiet[pos - 1])) {
+                quiet[pos] = quiet[pos - 1];
+                pos--;
+            }
+            quiet[pos] = (uint16_t)s;
+        }
+    }
+    if (!WGTestCheckHeap(aggregate, &aggregate->quiet, 0) || !WGTestCheckHeap(aggregate, &aggregate->busy, 1)) {
+        fprintf(stderr, "heap out of order or out of sync with the slots\n");
+        return false;
+    }
+    if (WGChannelAggregateMostCrowded(aggregate) != crowded) {
+        fprintf(stderr, "most crowded %d, expected %d\n", WGChannelAggregateMostCrowded(aggregate), crowded);
+        return false;
+    }
+    uint16_t least[8];
+    size_t leastCount = WGChannelAggregateLeastCongested(aggregate, least, 8);
+    size_t expectCount = quietCount < 8 ? quietCount : 8;
+    return leastCount == expectCount && memcmp(least, quiet, leastCount * sizeof(uint16_t)) == 0;
+}
+
+static void testRandomRecount(void) {
+    static WGChannelAggregate aggregate;
+    WGTestNetwork networks[WG_TEST_NETWORKS];
+    memset(networks, 0, sizeof(networks));
+    WGChannelAggregateInit(&aggregate);
+    WG_CHECK(WGTestRecount(&aggregate, networks));
+
+    uint64_t state = 0xC0FFEE1234567ULL;
+    for (int step = 0; step < 10000; step++) {
+        WGTestNetwork *network = &networks[WGTestRandom(&state) % WG_TEST_NETWORKS];
+        uint64_t roll = WGTestRandom(&state) % 10;
+        if (!network->present) {
+            network->placement = WGTestRandomPlacement(&state);
+            network->present = true;
+            WGChannelAggregateAdd(&aggregate, &network->placement);
+        } else if (roll < 2) {
+            WGChannelAggregateRemove(&aggregate, &network->placement);
+            network->present = false;
+        } else {
+            // Mostly RSSI-only moves, as between two scans
+            WGChannelPlacement to = network->placement;
+            if (roll < 7) {
+                to.rssi = (int16_t)(-95 + (int)(WGTestRandom(&state) % 70));
+            } else {
+                to = WGTestRandomPlacement(&state);
+            }
+            WGChannelAggregateMove(&aggregate, &network->placement, &to);
+            network->placement = to;
+        }
+        if (!WGTestRecount(&aggregate, networks)) {
+            fprintf(stderr, "  after step %d\n", step);
+            gWGTestFailures++;
+            return;
+        }
+    }
+
+    // Removing everything leaves an empty aggregate
+    for (size_t n = 0; n < WG_TEST_NETWORKS; n++) {
+        if (networks[n].present) {
+            WGChannelAggregateRemove(&aggregate, &networks[n].placement);
+            networks[n].present = false;
+        }
+    }
+    WG_CHECK(WGTestRecount(&aggregate, networks));
+    WG_CHECK_EQ(aggregate.quiet.count, 0);
+    WG_CHECK_EQ(aggregate.busy.count, 0);
+    WG_CHECK_EQ(WGChannelAggregateMostCrowded(&aggregate), -1);
+}
+
+int main(void) {
+    WG_RUN(testSpans);
+    WG_RUN(testRandomRecount);
+    return WGTestFinish();
+}
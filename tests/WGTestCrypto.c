@@ -0,0 +1,390 @@
+/*
+ * WGTestCrypto.c - Crypto Primitives and Encrypted Stream Tests
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * Round-trips data through the chunked stream writer and WGStreamDecryptFD
+ * at sizes around the chunk boundary, under both the password and the
+ * session (master key) headers, checks the streams interoperate with the
+ * one-shot WGCryptoSeal / WGCryptoOpen format, that a wrong password or a
+ * truncated file is refused, and runs the RFC 5869 vectors through HKDF.
+ */
+
+#include "WGTest.h"
+#include "WGCrypto.h"
+#include "WGCryptoStream.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static const char kWGTestPassword[] = "correct horse battery staple";
+
+static const size_t kWGTestSizes[] = {
+    0, 1, WG_STREAM_CHUNK_SIZE - 1, WG_STREAM_CHUNK_SIZE, WG_STREAM_CHUNK_SIZE + 1,
+    3 * WG_STREAM_CHUNK_SIZE + 17
+};
+#define WG_TEST_SIZE_COUNT (sizeof(kWGTestSizes) / sizeof(kWGTestSizes[0]))
+#define WG_TEST_MAX_SIZE (3 * WG_STREAM_CHUNK_SIZE + 17)
+
+// Anonymous temporary file, unlinked already
+static int WGTestTempFD(void) {
+    char path[] = "/tmp/wgtest-XXXXXX";
+    int fd = mkstemp(path);
+    if (fd >= 0) {
+        unlink(path);
+    }
+    return fd;
+}
+
+static bool WGTestWriteAll(int fd, const void *data, size_t length) {
+    return lseek(fd, 0, SEEK_SET) == 0 && ftruncate(fd, 0) == 0 &&
+           (length == 0 || write(fd, data, length) == (ssize_t)length) && lseek(fd, 0, SEEK_SET) == 0;
+}
+
+// Whole file into a malloc'd buffer
+static uint8_t *WGTestReadAll(int fd, size_t *length) {
+    off_t size = lseek(fd, 0, SEEK_END);
+    uint8_t *data = malloc(size > 0 ? (size_t)size : 1);
+    *length = 0;
+    if (!data || size < 0 || lseek(fd, 0, SEEK_SET) != 0 ||
+        (size > 0 && read(fd, data, (size_t)size) != (ssize_t)size)) {
+        free(data);
+        return NULL;
+    }
+    *length = (size_t)size;
+    return data;
+}
+
+static void WGTestFill(uint8_t *data, size_t length, uint64_t seed) {
+    for (size_t i = 0; i < length; i++) {
+        data[i] = (uint8_t)WGTestRandom(&seed);
+    }
+}
+
+// Writes data through a stream writer in uneven pieces, so writes straddle
+// chunk boundaries; NULL master with a NULL password writes plaintext
+static bool WGTestWriteStream(int fd, const uint8_t *data, size_t length,
+                              const char *password, const WGStreamMasterKey *master) {
+    WGStreamWriter writer;
+    if (lseek(fd, 0, SEEK_SET) != 0 || ftruncate(fd, 0) != 0) {
+        return false;
+    }
+    bool ok = master ? WGStreamWriterOpenWithMasterKey(&writer, fd, master)
+                     : WGStreamWriterOpen(&writer, fd, password, password ? strlen(password) : 0);
+    for (size_t offset = 0, piece = 1; ok && offset < length; piece = piece * 3 + 1) {
+        size_t n = piece % 40000;
+        n = n < length - offset ? n : length - offset;
+        ok = WGStreamWriterWrite(&writer, data + offset, n);
+        offset += n;
+    }
+    ok = ok && WGStreamWriterFinish(&writer) && writer.bytesIn == length;
+    WGStreamWriterFree(&writer);
+    return ok && lseek(fd, 0, SEEK_SET) == 0;
+}
+
+// Decrypts inFD and compares the plaintext with expect
+static bool WGTestDecryptMatches(int inFD, const char *password, WGStreamMasterKey *cache,
+                                 const uint8_t *expect, size_t expectLength) {
+    int outFD = WGTestTempFD();
+    WGStreamError error = WGStreamErrorNone;
+    bool ok = outFD >= 0 && lseek(inFD, 0, SEEK_SET) == 0 &&
+              WGStreamDecryptFD(inFD, outFD, password, strlen(password), cache, &error);
+    if (!ok) {
+        fprintf(stderr, "decrypt failed: error %d\n", error);
+    }
+    size_t length = 0;
+    uint8_t *plain = ok ? WGTestReadAll(outFD, &length) : NULL;
+    ok = plain && length == expectLength && (length == 0 || memcmp(plain, expect, length) == 0);
+    free(plain);
+    if (outFD >= 0) {
+        close(outFD);
+    }
+    return ok;
+}
+
+static WGStreamError WGTestDecryptError(int inFD, const char *password) {
+    int outFD = WGTestTempFD();
+    WGStreamError error = WGStreamErrorNone;
+    if (outFD < 0 || lseek(inFD, 0, SEEK_SET) != 0) {
+        return WGStreamErrorIO;
+    }
+    if (WGStreamDecryptFD(inFD, outFD, password, strlen(password), NULL, &error)) {
+        error = WGStreamErrorNone;
+    }
+    close(outFD);
+    return error;
+}
+
+#pragma mark - Round Trips
+
+static void testPasswordRoundTrip(void) {
+    uint8_t *data = malloc(WG_TEST_MAX_SIZE);
+    int fd = WGTestTempFD();
+    WG_REQUIRE(data && fd >= 0);
+    WGTestFill(data, WG_TEST_MAX_SIZE, 0xDA7A);
+
+    for (size_t i = 0; i < WG_TEST_SIZE_COUNT; i++) {
+        size_t size = kWGTestSizes[i];
+        WG_CHECK(WGTestWriteStream(fd, data, size, kWGTestPassword, NULL));
+
+        // salt || iv || whole blocks, at least one of padding
+        size_t length = 0;
+        uint8_t *file = WGTestReadAll(fd, &length);
+        WG_CHECK_EQ(length, WG_STREAM_HEADER_LENGTH + (size / WG_CRYPTO_BLOCK_SIZE + 1) * WG_CRYPTO_BLOCK_SIZE);
+        free(file);
+
+        if (!WGTestDecryptMatches(fd, kWGTestPassword, NULL, data, size)) {
+            fprintf(stderr, "  password round trip of %zu bytes\n", size);
+            gWGTestFailures++;
+        }
+    }
+
+    // Plaintext goes through the same chunking unchanged
+    WG_CHECK(WGTestWriteStream(fd, data, WG_TEST_MAX_SIZE, NULL, NULL));
+    size_t length = 0;
+    uint8_t *file = WGTestReadAll(fd, &length);
+    WG_CHECK(file && length == WG_TEST_MAX_SIZE && memcmp(file, data, length) == 0);
+    free(file);
+
+    // And whole-descriptor encryption reads it back in
+    int encrypted = WGTestTempFD();
+    WGStreamError error = WGStreamErrorNone;
+    WG_CHECK(encrypted >= 0 && lseek(fd, 0, SEEK_SET) == 0 &&
+             WGStreamEncryptFD(fd, encrypted, kWGTestPassword, strlen(kWGTestPassword), &error));
+    WG_CHECK(WGTestDecryptMatches(encrypted, kWGTestPassword, NULL, data, WG_TEST_MAX_SIZE));
+    if (encrypted >= 0) {
+        close(encrypted);
+    }
+    close(fd);
+    free(data);
+}
+
+static void testSessionRoundTrip(void) {
+    uint8_t *data = malloc(WG_TEST_MAX_SIZE);
+    int fd = WGTestTempFD();
+    WG_REQUIRE(data && fd >= 0);
+    WGTestFill(data, WG_TEST_MAX_SIZE, 0x5E55);
+    WGStreamMasterKey master;
+    WG_REQUIRE(WGStreamMasterKeyDerive(&master, kWGTestPassword, strlen(kWGTestPassword)));
+
+    WGStreamMasterKey cache = {0};
+    for (size_t i = 0; i < WG_TEST_SIZE_COUNT; i++) {
+        size_t size = kWGTestSizes[i];
+        WG_CHECK(WGTestWriteStream(fd, data, size, NULL, &master));
+
+        size_t length = 0;
+        uint8_t *file = WGTestReadAll(fd, &length);
+        WG_CHECK(file && length >= WG_STREAM_SESSION_HEADER_LENGTH &&
+                 memcmp(file, WG_STREAM_SESSION_MAGIC, 4) == 0 &&
+                 memcmp(file + 4, master.salt, WG_CRYPTO_SALT_LENGTH) == 0);
+        WG_CHECK_EQ(length, WG_STREAM_SESSION_HEADER_LENGTH +
+                            (size / WG_CRYPTO_BLOCK_SIZE + 1) * WG_CRYPTO_BLOCK_SIZE);
+        free(file);
+
+        // Without a cache, and through one the first file fills
+        if (!WGTestDecryptMatches(fd, kWGTestPassword, NULL, data, size) ||
+            !WGTestDecryptMatches(fd, kWGTestPassword, &cache, data, size)) {
+            fprintf(stderr, "  session round trip of %zu bytes\n", size);
+            gWGTestFailures++;
+        }
+    }
+    WG_CHECK(cache.valid);
+    WG_CHECK(memcmp(cache.salt, master.salt, WG_CRYPTO_SALT_LENGTH) == 0);
+    WG_CHECK(memcmp(cache.key, master.key, WG_CRYPTO_KEY_LENGTH) == 0);
+
+    // A cached key for the session's salt is used as is: no PBKDF2, so the
+    // password is not even consulted
+    WG_CHECK(WGTestDecryptMatches(fd, "not the password", &cache, data, kWGTestSizes[WG_TEST_SIZE_COUNT - 1]));
+
+    // A file from another session replaces the cached key
+    WGStreamMasterKey other;
+    WG_REQUIRE(WGStreamMasterKeyDerive(&other, kWGTestPassword, strlen(kWGTestPassword)));
+    WG_CHECK(WGTestWriteStream(fd, data, 1000, NULL, &other));
+    WG_CHECK(WGTestDecryptMatches(fd, kWGTestPassword, &cache, data, 1000));
+    WG_CHECK(memcmp(cache.salt, other.salt, WG_CRYPTO_SALT_LENGTH) == 0);
+
+    WGStreamMasterKeyWipe(&cache);
+    WGStreamMasterKeyWipe(&other);
+    WGStreamMasterKeyWipe(&master);
+    close(fd);
+    free(data);
+}
+
+// The stream's password layout is WGCryptoSeal's, both ways
+static void testSealInterop(void) {
+    enum { kLength = 100000 };
+    uint8_t *data = malloc(kLength);
+    uint8_t *sealed = malloc(WG_CRYPTO_SEALED_MAX(kLength));
+    uint8_t *opened = malloc(WG_CRYPTO_SEALED_MAX(kLength));
+    int fd = WGTestTempFD();
+    WG_REQUIRE(data && sealed && opened && fd >= 0);
+    WGTestFill(data, kLength, 0x5EA1);
+
+    size_t sealedLength = 0;
+    WG_CHECK(WGCryptoSeal(kWGTestPassword, strlen(kWGTestPassword), data, kLength,
+                          sealed, WG_CRYPTO_SEALED_MAX(kLength), &sealedLength));
+    WG_CHECK(WGTestWriteAll(fd, sealed, sealedLength));
+    WG_CHECK(WGTestDecryptMatches(fd, kWGTestPassword, NULL, data, kLength));
+
+    WG_CHECK(WGTestWriteStream(fd, data, kLength, kWGTestPassword, NULL));
+    size_t length = 0;
+    uint8_t *file = WGTestReadAll(fd, &length);
+    size_t openedLength = 0;
+    WG_CHECK(file && WGCryptoOpen(kWGTestPassword, strlen(kWGTestPassword), file, length,
+                                  opened, WG_CRYPTO_SEALED_MAX(kLength), &openedLength));
+    WG_CHECK(openedLength == kLength && memcmp(opened, data, kLength) == 0);
+
+    // Open refuses input shorter than a header and a block
+    WG_CHECK(!WGCryptoOpen(kWGTestPassword, strlen(kWGTestPassword), file, WG_STREAM_HEADER_LENGTH,
+                           opened, WG_CRYPTO_SEALED_MAX(kLength), &openedLength));
+    free(file);
+    close(fd);
+    free(opened);
+    free(sealed);
+    free(data);
+}
+
+#pragma mark - Failures
+
+// A password-layout file with a fixed salt and IV, so the outcome of
+// decrypting it under a wrong password is the same on every run
+static uint8_t *WGTestFixedFile(const uint8_t *plain, size_t plainLength, size_t *length) {
+    uint8_t salt[WG_CRYPTO_SALT_LENGTH];
+    uint8_t iv[WG_CRYPTO_IV_LENGTH];
+    uint8_t key[WG_CRYPTO_KEY_LENGTH];
+    for (size_t i = 0; i < sizeof(salt); i++) {
+        salt[i] = (uint8_t)(0x10 + i);
+    }
+    for (size_t i = 0; i < sizeof(iv); i++) {
+        iv[i] = (uint8_t)(0xA0 + i);
+    }
+    uint8_t *file = malloc(WG_CRYPTO_SEALED_MAX(plainLength));
+    if (!file || !WGCryptoDeriveKey(kWGTestPassword, strlen(kWGTestPassword), salt, sizeof(salt),
+                                    WG_CRYPTO_PBKDF_ROUNDS, key, sizeof(key))) {
+        free(file);
+        return NULL;
+    }
+    memcpy(file, salt, sizeof(salt));
+    memcpy(file + sizeof(salt), iv, sizeof(iv));
+
+    WGCipher cipher;
+    size_t out = 0, tail = 0;
+    uint8_t *body = file + WG_STREAM_HEADER_LENGTH;
+    size_t capacity = plainLength + WG_CRYPTO_BLOCK_SIZE;
+    bool ok = WGCipherInit(&cipher, WGCipherEncrypt, key, iv) &&
+              WGCipherUpdate(&cipher, plain, plainLength, body, capacity, &out) &&
+              WGCipherFinal(&cipher, body + out, capacity - out, &tail);
+    WGCipherFree(&cipher);
+    WGCryptoWipe(key, sizeof(key));
+    if (!ok) {
+        free(file);
+        return NULL;
+    }
+    *length = WG_STREAM_HEADER_LENGTH + out + tail;
+    return file;
+}
+
+static void testWrongPasswordAndTruncation(void) {
+    enum { kLength = 5000 };
+    uint8_t plain[kLength];
+    WGTestFill(plain, kLength, 0xBAD);
+    size_t length = 0;
+    uint8_t *file = WGTestFixedFile(plain, kLength, &length);
+    int fd = WGTestTempFD();
+    WG_REQUIRE(file && fd >= 0);
+
+    WG_CHECK(WGTestWriteAll(fd, file, length));
+    WG_CHECK(WGTestDecryptMatches(fd, kWGTestPassword, NULL, plain, kLength));
+    WG_CHECK_EQ(WGTestDecryptError(fd, "correct horse battery stapler"), WGStreamErrorFormat);
+    WG_CHECK_EQ(WGTestDecryptError(fd, ""), WGStreamErrorFormat);
+
+    // Cut inside the header, before the first block, and mid-block
+    const size_t cuts[] = { 0, 20, WG_STREAM_HEADER_LENGTH, WG_STREAM_HEADER_LENGTH + 7, length - 5 };
+    for (size_t i = 0; i < sizeof(cuts) / sizeof(cuts[0]); i++) {
+        size_t cut = cuts[i];
+        WG_CHECK(WGTestWriteAll(fd, file, cut));
+        WGStreamError error = WGTestDecryptError(fd, kWGTestPassword);
+        if (error != WGStreamErrorFormat && error != WGStreamErrorCrypto) {
+            fprintf(stderr, "file cut to %zu bytes: error %d\n", cut, error);
+            gWGTestFailures++;
+        }
+    }
+
+    // A session file cut inside its longer header
+    WGStreamMasterKey master;
+    WG_REQUIRE(WGStreamMasterKeyDerive(&master, kWGTestPassword, strlen(kWGTestPassword)));
+    WG_CHECK(WGTestWriteStream(fd, plain, kLength, NULL, &master));
+    free(file);
+    file = WGTestReadAll(fd, &length);
+    WG_REQUIRE(file);
+    WG_CHECK(WGTestWriteAll(fd, file, WG_STREAM_SESSION_HEADER_LENGTH - 1));
+    WG_CHECK_EQ(WGTestDecryptError(fd, kWGTestPassword), WGStreamErrorFormat);
+    WG_CHECK(WGTestWriteAll(fd, file, length - 5));
+    WGStreamError error = WGTestDecryptError(fd, kWGTestPassword);
+    WG_CHECK(error == WGStreamErrorFormat || error == WGStreamErrorCrypto);
+
+    WGStreamMasterKeyWipe(&master);
+    close(fd);
+    free(file);
+}
+
+#pragma mark - HKDF
+
+static size_t WGTestHex(const char *hex, uint8_t *out) {
+    size_t n = 0;
+    for (; hex[0] && hex[1]; hex += 2) {
+        unsigned value;
+        sscanf(hex, "%2x", &value);
+        out[n++] = (uint8_t)value;
+    }
+    return n;
+}
+
+// RFC 5869 appendix A, the SHA-256 cases
+static void testHKDF(void) {
+    uint8_t ikm[80], salt[80], info[80], expect[82], okm[82];
+    for (size_t i = 0; i < 80; i++) {
+        ikm[i] = (uint8_t)i;
+        salt[i] = (uint8_t)(0x60 + i);
+        info[i] = (uint8_t)(0xB0 + i);
+    }
+
+    // A.2: longer inputs and outputs
+    size_t n = WGTestHex("b11e398dc80327a1c8e7f78c596a49344f012eda2d4efad8a050cc4c19afa97c"
+                         "59045a99cac7827271cb41c65e590e09da3275600c2f09b8367793a9aca3db71"
+                         "cc30c58179ec3e87c14c01d5c1f3434f1d87", expect);
+    WG_CHECK(WGCryptoHKDF(ikm, 80, salt, 80, info, 80, okm, n));
+    WG_CHECK(memcmp(okm, expect, n) == 0);
+
+    // A.1: basic
+    memset(ikm, 0x0B, 22);
+    for (size_t i = 0; i < 13; i++) {
+        salt[i] = (uint8_t)i;
+    }
+    for (size_t i = 0; i < 10; i++) {
+        info[i] = (uint8_t)(0xF0 + i);
+    }
+    n = WGTestHex("3cb25f25faacd57a90434f64d0362f2a2d2d0a90cf1a5a4c5db02d56ecc4c5bf"
+                  "34007208d5b887185865", expect);
+    WG_CHECK(WGCryptoHKDF(ikm, 22, salt, 13, info, 10, okm, n));
+    WG_CHECK(memcmp(okm, expect, n) == 0);
+
+    // A.3: zero-length salt and info
+    n = WGTestHex("8da4e775a563c18f715f802a063c5a31b8a11f5c5ee1879ec3454e5f3c738d2d"
+                  "9d201395faa4b61a96c8", expect);
+    WG_CHECK(WGCryptoHKDF(ikm, 22, salt, 0, info, 0, okm, n));
+    WG_CHECK(memcmp(okm, expect, n) == 0);
+
+    // Limits
+    WG_CHECK(!WGCryptoHKDF(ikm, 22, salt, 13, info, WG_CRYPTO_HKDF_INFO_MAX + 1, okm, 32));
+    WG_CHECK(!WGCryptoHKDF(ikm, 22, salt, 13, info, 10, okm, 255 * WG_CRYPTO_HASH_LENGTH + 1));
+}
+
+int main(void) {
+    WG_RUN(testPasswordRoundTrip);
+    WG_RUN(testSessionRoundTrip);
+    WG_RUN(testSealInterop);
+    WG_RUN(testWrongPasswordAndTruncation);
+    WG_RUN(testHKDF);
+    return WGTestFinish();
+}
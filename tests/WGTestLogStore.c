@@ -0,0 +1,146 @@
+/*
+ * WGTestLogStore.c - Segmented Audit Log Store Tests
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * Appends across several segments in a temporary directory, then checks
+ * that pruning and clearing leave nothing behind for reads (and exports)
+ * to find, on disk or after a reopen.
+ */
+
+#include "WGTest.h"
+#include "WGLogStore.h"
+
+#include <dirent.h>
+#include <string.h>
+#include <unistd.h>
+
+static const char kWGTestDetails[] = "IP 192.168.1.1 changed MAC from 02:00:00:00:00:01 to 02:00:00:00:00:02";
+
+static bool WGTestAppend(WGLogStore *store, uint64_t time) {
+    WGLogRecord record = {
+        .time = time,
+        .eventType = "ARP_ANOMALY",
+        .eventTypeLength = 11,
+        .details = kWGTestDetails,
+        .detailsLength = sizeof(kWGTestDetails) - 1,
+        .sessionId = "session",
+        .sessionIdLength = 7
+    };
+    WGLogStoreAppend(store, &record);
+    return WGLogStoreCommit(store);
+}
+
+static bool WGTestCount(void *context, const WGLogRecord *record) {
+    (void)record;
+    (*(size_t *)context)++;
+    return true;
+}
+
+static size_t WGTestStoredRecords(WGLogStore *store) {
+    size_t count = 0;
+    bool finished;
+    WGLogStorePosition position;
+    WGLogStoreSeek(store, 0, &position);
+    WGLogStoreRead(store, &position, 0, 0, SIZE_MAX, WGTestCount, &count, &finished);
+    return count;
+}
+
+static size_t WGTestDirectoryFiles(const char *directory) {
+    size_t count = 0;
+    DIR *dir = opendir(directory);
+    if (!dir) {
+        return 0;
+    }
+    for (struct dirent *entry; (entry = readdir(dir)) != NULL;) {
+        count += entry->d_name[0] != '.';
+    }
+    closedir(dir);
+    return count;
+}
+
+static void WGTestRemoveDirectory(const char *directory) {
+    DIR *dir = opendir(directory);
+    if (!dir) {
+        return;
+    }
+    char path[512];
+    for (struct dirent *entry; (entry = readdir(dir)) != NULL;) {
+        if (entry->d_name[0] != '.') {
+            snprintf(path, sizeof(path), "%s/%s", directory, entry->d_name);
+            unlink(path);
+        }
+    }
+    closedir(dir);
+    rmdir(directory);
+}
+
+// Small segments, no retention: 200 records span several of them
+static bool WGTestOpen(WGLogStore *store, const char *directory) {
+    WGLogStoreConfig config = WGLogStoreConfigDefault();
+    config.maxSegmentBytes = 4096;
+    config.retainBytes = 0;
+    config.retainAge = 0;
+    return WGLogStoreOpen(store, directory, config, WGLogCommitPolicyDefault());
+}
+
+static void testDropAll(void) {
+    char directory[] = "/tmp/wgtest-store.XXXXXX";
+    WG_REQUIRE(mkdtemp(directory));
+    WGLogStore store;
+    WG_REQUIRE(WGTestOpen(&store, directory));
+
+    uint64_t time = 1700000000000000ull;
+    for (int i = 0; i < 200; i++) {
+        WG_CHECK(WGTestAppend(&store, time += 1000));
+    }
+    WG_CHECK(store.segmentCount > 2);
+    WG_CHECK_EQ(WGTestStoredRecords(&store), 200);
+
+    // The active segment, still open for writing, goes as well
+    size_t segments = store.segmentCount;
+    WG_CHECK_EQ(WGLogStoreDropAll(&store), segments);
+    WG_CHECK_EQ(store.segmentCount, 0);
+    WG_CHECK_EQ(store.totalBytes, 0);
+    WG_CHECK_EQ(WGTestStoredRecords(&store), 0);
+    WG_CHECK_EQ(WGTestDirectoryFiles(directory), 0);
+
+    // Appends after a clear start a new segment
+    WG_CHECK(WGTestAppend(&store, time += 1000));
+    WG_CHECK_EQ(store.segmentCount, 1);
+    WG_CHECK_EQ(WGTestStoredRecords(&store), 1);
+    WGLogStoreClose(&store);
+
+    WG_REQUIRE(WGTestOpen(&store, directory));
+    WG_CHECK_EQ(WGTestStoredRecords(&store), 1);
+    WGLogStoreClose(&store);
+    WGTestRemoveDirectory(directory);
+}
+
+// DropBefore keeps the active segment and everything at or after the cutoff
+static void testDropBefore(void) {
+    char directory[] = "/tmp/wgtest-store.XXXXXX";
+    WG_REQUIRE(mkdtemp(directory));
+    WGLogStore store;
+    WG_REQUIRE(WGTestOpen(&store, directory));
+
+    uint64_t start = 1700000000000000ull;
+    for (int i = 1; i <= 200; i++) {
+        WGTestAppend(&store, start + (uint64_t)i * 1000);
+    }
+    uint64_t cutoff = start + 100 * 1000;
+    size_t before = store.segmentCount;
+    size_t dropped = WGLogStoreDropBefore(&store, cutoff);
+    WG_CHECK(dropped > 0 && dropped < before);
+
+    size_t remaining = WGTestStoredRecords(&store);
+    WG_CHECK(remaining >= 101 && remaining < 200);
+    WG_CHECK(store.segments[0].lastTime >= cutoff);
+    WGLogStoreClose(&store);
+    WGTestRemoveDirectory(directory);
+}
+
+int main(void) {
+    WG_RUN(testDropAll);
+    WG_RUN(testDropBefore);
+    return WGTestFinish();
+}
@@ -0,0 +1,148 @@
+/*
+ * WGTestOUI.c - Compiled OUI Vendor Database Tests
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * Compiles excerpts of the three IEEE registries in the layout they are
+ * published in (CRLF line endings, header, address lines) and checks that
+ * MA-L, MA-M and MA-S addresses each resolve to the organisation that was
+ * assigned them, in whichever order the files are compiled.
+ */
+
+#include "WGTest.h"
+#include "WGOUI.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static const char kWGTestMAL[] =
+    "OUI/MA-L                                                    Organization                                 \r\n"
+    "company_id                                                  Organization                                 \r\n"
+    "                                                            Address                                      \r\n"
+    "\r\n"
+    "28-6F-B9   (hex)\t\tNokia Shanghai Bell Co., Ltd.\r\n"
+    "286FB9     (base 16)\t\tNokia Shanghai Bell Co., Ltd.\r\n"
+    "\t\t\t\tNo.388 Ning Qiao Road,Jin Qiao Pudong Shanghai\r\n"
+    "\t\t\t\tShanghai   Shanghai   201206\r\n"
+    "\t\t\t\tCN\r\n"
+    "\r\n"
+    "1C-82-59   (hex)\t\tIEEE Registration Authority\r\n"
+    "1C8259     (base 16)\t\tIEEE Registration Authority\r\n"
+    "\t\t\t\t445 Hoes Lane\r\n"
+    "\t\t\t\tPiscataway  NJ  08554\r\n"
+    "\t\t\t\tUS\r\n"
+    "\r\n"
+    "70-B3-D5   (hex)\t\tIEEE Registration Authority\r\n"
+    "70B3D5     (base 16)\t\tIEEE Registration Authority\r\n"
+    "\t\t\t\t445 Hoes Lane\r\n"
+    "\t\t\t\tPiscataway  NJ  08554\r\n"
+    "\t\t\t\tUS\r\n"
+    "\r\n";
+
+static const char kWGTestMAM[] =
+    "OUI/MA-M\t\t\t\t\t\tOrganization                                 \r\n"
+    "company_id\t\t\t\t\t\tOrganization                                 \r\n"
+    "\t\t\t\t\t\t\t\tAddress                                      \r\n"
+    "\r\n"
+    "1C-82-59-D   (hex)\t\tESTec Corporation\r\n"
+    "D00000-DFFFFF     (base 16)\t\tESTec Corporation\r\n"
+    "\t\t\t\tKR\r\n"
+    "\r\n";
+
+static const char kWGTestMAS[] =
+    "OUI/MA-S\t\t\t\t\t\tOrganization                                 \r\n"
+    "company_id\t\t\t\t\t\tOrganization                                 \r\n"
+    "\t\t\t\t\t\t\t\tAddress                                      \r\n"
+    "\r\n"
+    "70-B3-D5-F2-F   (hex)\t\tTELEPLATFORMS\r\n"
+    "F2F000-F2FFFF     (base 16)\t\tTELEPLATFORMS\r\n"
+    "\t\t\t\tRU\r\n"
+    "\r\n";
+
+static const char *WGTestVendor(const WGOUIDatabase *database, WGMACAddress mac) {
+    return WGOUIVendorName(database, WGOUILookup(database, mac));
+}
+
+static bool WGTestCompile(const char * const *texts, const long *expect, size_t count,
+                          uint8_t **image, size_t *length) {
+    WGOUIBuilder builder;
+    if (!WGOUIBuilderInit(&builder)) {
+        return false;
+    }
+    bool ok = true;
+    for (size_t i = 0; i < count; i++) {
+        long added = WGOUIBuilderParse(&builder, texts[i], strlen(texts[i]));
+        if (added != expect[i]) {
+            fprintf(stderr, "registry %zu: %ld assignments, expected %ld\n", i, added, expect[i]);
+            ok = false;
+        }
+    }
+    ok = ok && WGOUIBuilderFinish(&builder, image, length) == WGOUIErrorNone;
+    WGOUIBuilderFree(&builder);
+    return ok;
+}
+
+static void testRegistries(void) {
+    static const char * const orders[][3] = {
+        { kWGTestMAL, kWGTestMAM, kWGTestMAS },
+        { kWGTestMAS, kWGTestMAM, kWGTestMAL },
+    };
+    static const long expect[][3] = { { 3, 1, 1 }, { 1, 1, 3 } };
+
+    for (size_t order = 0; order < 2; order++) {
+        uint8_t *image = NULL;
+        size_t length = 0;
+        WGOUIDatabase database;
+        WG_REQUIRE(WGTestCompile(orders[order], expect[order], 3, &image, &length));
+        WG_REQUIRE(WGOUILoad(&database, image, length) == WGOUIErrorNone);
+        WG_CHECK_EQ(database.largeCount, 3);
+        WG_CHECK_EQ(database.mediumCount, 1);
+        WG_CHECK_EQ(database.smallCount, 1);
+
+        // MA-L
+        WG_CHECK(strcmp(WGTestVendor(&database, 0x286FB9123456ULL), "Nokia Shanghai Bell Co., Ltd.") == 0);
+
+        // MA-M: the D slice of 1C-82-59, the rest of the block is the authority's
+        WG_CHECK(strcmp(WGTestVendor(&database, 0x1C8259D00000ULL), "ESTec Corporation") == 0);
+        WG_CHECK(strcmp(WGTestVendor(&database, 0x1C8259DFFFFFULL), "ESTec Corporation") == 0);
+        WG_CHECK(strcmp(WGTestVendor(&database, 0x1C8259CFFFFFULL), "IEEE Registration Authority") == 0);
+        WG_CHECK(strcmp(WGTestVendor(&database, 0x1C8259E00000ULL), "IEEE Registration Authority") == 0);
+
+        // MA-S: 70-B3-D5-F2-F
+        WG_CHECK(strcmp(WGTestVendor(&database, 0x70B3D5F2F123ULL), "TELEPLATFORMS") == 0);
+        WG_CHECK(strcmp(WGTestVendor(&database, 0x70B3D5F2EFFFULL), "IEEE Registration Authority") == 0);
+        WG_CHECK(strcmp(WGTestVendor(&database, 0x70B3D5F30000ULL), "IEEE Registration Authority") == 0);
+
+        // Unassigned, locally administered and multicast
+        WG_CHECK_EQ(WGOUILookup(&database, 0x286FBA000001ULL), WG_OUI_UNKNOWN);
+        WG_CHECK_EQ(WGOUILookup(&database, 0x2A6FB9123456ULL), WG_OUI_UNKNOWN);
+        WG_CHECK_EQ(WGOUILookup(&database, 0x296FB9123456ULL), WG_OUI_UNKNOWN);
+        WGOUIClose(&database);
+        free(image);
+    }
+}
+
+// Without its "(hex)" line, or with one it disagrees with, a range names
+// no block and is skipped; so are ranges written as whole addresses
+static void testUnmatchedRanges(void) {
+    static const char text[] =
+        "D00000-DFFFFF     (base 16)\t\tNo Prefix Ltd.\r\n"
+        "\r\n"
+        "1C-82-59-D   (hex)\t\tWrong Slice Ltd.\r\n"
+        "E00000-EFFFFF     (base 16)\t\tWrong Slice Ltd.\r\n"
+        "\r\n"
+        "1C-82-59-D   (hex)\t\tWrong Size Ltd.\r\n"
+        "D00000-D00FFF     (base 16)\t\tWrong Size Ltd.\r\n"
+        "\r\n"
+        "1C8259D00000-1C8259DFFFFF     (base 16)\t\tWhole Address Ltd.\r\n";
+    WGOUIBuilder builder;
+    WG_REQUIRE(WGOUIBuilderInit(&builder));
+    WG_CHECK_EQ(WGOUIBuilderParse(&builder, text, sizeof(text) - 1), 0);
+    WG_CHECK_EQ(builder.count, 0);
+    WGOUIBuilderFree(&builder);
+}
+
+int main(void) {
+    WG_RUN(testRegistries);
+    WG_RUN(testUnmatchedRanges);
+    return WGTestFinish();
+}
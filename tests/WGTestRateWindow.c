@@ -0,0 +1,224 @@
+/*
+ * WGTestRateWindow.c - Sliding-Window Change Rate Engine Tests
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * Drives WGRateWindow from a fake millisecond clock: the exact bucket
+ * boundary where a change falls out of the window, limits reported once
+ * and re-armed, gaps longer than the window, and a randomised stream
+ * checked against a brute-force recount of every recorded change.
+ */
+
+#include "WGTest.h"
+#include "WGRateWindow.h"
+
+#define IP_A    0xC0A80102u
+#define IP_B    0xC0A80103u
+#define IP_C    0xC0A80104u
+#define MAC_A   0xAABBCC000001ULL
+#define MAC_B   0xAABBCC000002ULL
+
+typedef struct {
+    uint64_t now;
+} WGTestClock;
+
+static uint64_t WGTestClockNow(void *context) {
+    return ((WGTestClock *)context)->now;
+}
+
+// 1 s window of 100 ms buckets
+static bool WGTestOpen(WGRateWindow *window, WGTestClock *clock,
+                       uint32_t ipLimit, uint32_t macLimit, uint32_t totalLimit) {
+    return WGRateWindowInit(window, WGTestClockNow, clock) &&
+           WGRateWindowConfigure(window, 1000, 10, ipLimit, macLimit, totalLimit);
+}
+
+// A change counts until the clock reaches the start of the bucket one full
+// window after the bucket it was recorded in
+static void testExpiryBoundary(void) {
+    WGTestClock clock = { .now = 1050 };
+    WGRateWindow window;
+    WG_REQUIRE(WGTestOpen(&window, &clock, 0, 0, 0));
+
+    WG_CHECK(WGRateWindowRecord(&window, IP_A, MAC_A));
+    clock.now = 1099;
+    WG_CHECK(WGRateWindowRecord(&window, IP_A, MAC_A));
+    clock.now = 1100;
+    WG_CHECK(WGRateWindowRecord(&window, IP_A, MAC_A));
+    WG_CHECK_EQ(WGRateWindowCount(&window, WGRateKeyIP, IP_A), 3);
+
+    clock.now = 1999;
+    WG_CHECK_EQ(WGRateWindowCount(&window, WGRateKeyIP, IP_A), 3);
+    clock.now = 2000;
+    WG_CHECK_EQ(WGRateWindowCount(&window, WGRateKeyIP, IP_A), 1);
+    WG_CHECK_EQ(WGRateWindowCount(&window, WGRateKeyMAC, MAC_A), 1);
+    WG_CHECK_EQ(WGRateWindowCount(&window, WGRateKeyTotal, 0), 1);
+    clock.now = 2099;
+    WG_CHECK_EQ(WGRateWindowCount(&window, WGRateKeyIP, IP_A), 1);
+    clock.now = 2100;
+    WG_CHECK_EQ(WGRateWindowCount(&window, WGRateKeyIP, IP_A), 0);
+    WG_CHECK_EQ(WGRateWindowCount(&window, WGRateKeyTotal, 0), 0);
+
+    // Hosts whose last change expired give their slot back
+    WG_CHECK_EQ(window.ips.liveHosts, 0);
+    WG_CHECK_EQ(window.macs.liveHosts, 0);
+    WG_CHECK(WGRateWindowRecord(&window, IP_B, MAC_B));
+    WG_CHECK_EQ(window.ips.hostCount, 1);
+    WGRateWindowFree(&window);
+}
+
+// Going over a limit is reported once; it re-arms when enough of the window
+// expires to bring the count back to the limit
+static void testLimitRearm(void) {
+    WGTestClock clock = { .now = 1000 };
+    WGRateWindow window;
+    WG_REQUIRE(WGTestOpen(&window, &clock, 3, 0, 0));
+
+    WG_CHECK(WGRateWindowRecord(&window, IP_A, MAC_A));
+    WG_CHECK(WGRateWindowRecord(&window, IP_A, MAC_B));
+    clock.now = 1500;
+    WG_CHECK(WGRateWindowRecord(&window, IP_A, MAC_A));
+    WG_CHECK_EQ(window.offenderCount, 0);
+    WG_CHECK(WGRateWindowRecord(&window, IP_A, MAC_B));
+    WG_REQUIRE(window.offenderCount == 1);
+    WG_CHECK_EQ(window.offenders[0].kind, WGRateKeyIP);
+    WG_CHECK_EQ(window.offenders[0].key, IP_A);
+    WG_CHECK_EQ(window.offenders[0].count, 4);
+
+    WG_CHECK(WGRateWindowRecord(&window, IP_A, MAC_A));
+    WG_CHECK_EQ(window.offenderCount, 1);
+    WGRateWindowClearOffenders(&window);
+
+    // The two changes at 1000 expire: 3 left, back at the limit
+    clock.now = 2000;
+    WGRateWindowAdvance(&window);
+    WG_CHECK_EQ(WGRateWindowCount(&window, WGRateKeyIP, IP_A), 3);
+    WG_CHECK(WGRateWindowRecord(&window, IP_A, MAC_B));
+    WG_REQUIRE(window.offenderCount == 1);
+    WG_CHECK_EQ(window.offenders[0].count, 4);
+    WGRateWindowFree(&window);
+}
+
+// One MAC taking over several IPs, and the whole table changing too often
+static void testMACAndTotalLimits(void) {
+    WGTestClock clock = { .now = 0 };
+    WGRateWindow window;
+    WG_REQUIRE(WGTestOpen(&window, &clock, 0, 2, 4));
+
+    WG_CHECK(WGRateWindowRecord(&window, IP_A, MAC_A));
+    WG_CHECK(WGRateWindowRecord(&window, IP_B, MAC_A));
+    WG_CHECK_EQ(window.offenderCount, 0);
+    WG_CHECK(WGRateWindowRecord(&window, IP_C, MAC_A));
+    WG_REQUIRE(window.offenderCount == 1);
+    WG_CHECK_EQ(window.offenders[0].kind, WGRateKeyMAC);
+    WG_CHECK_EQ(window.offenders[0].key, MAC_A);
+    WG_CHECK_EQ(window.offenders[0].count, 3);
+
+    clock.now = 999;
+    WG_CHECK(WGRateWindowRecord(&window, IP_A, MAC_B));
+    WG_CHECK_EQ(window.offenderCount, 1);
+    WG_CHECK(WGRateWindowRecord(&window, IP_B, MAC_B));
+    WG_REQUIRE(window.offenderCount == 2);
+    WG_CHECK_EQ(window.offenders[1].kind, WGRateKeyTotal);
+    WG_CHECK_EQ(window.offenders[1].count, 5);
+
+    WGRateOffender top[2];
+    WG_CHECK_EQ(WGRateWindowTopKeys(&window, WGRateKeyMAC, top, 2), 2);
+    WG_CHECK_EQ(top[0].key, MAC_A);
+    WG_CHECK_EQ(top[0].count, 3);
+    WG_CHECK_EQ(top[1].key, MAC_B);
+    WG_CHECK_EQ(top[1].count, 2);
+
+    // The first three changes expire at 1000, the total re-arms
+    clock.now = 1000;
+    WG_CHECK_EQ(WGRateWindowCount(&window, WGRateKeyTotal, 0), 2);
+    WG_CHECK(!window.totalReported);
+    WGRateWindowFree(&window);
+}
+
+// A gap longer than the window empties it in one step
+static void testLongGap(void) {
+    WGTestClock clock = { .now = 5000 };
+    WGRateWindow window;
+    WG_REQUIRE(WGTestOpen(&window, &clock, 0, 0, 0));
+    for (int i = 0; i < 10; i++) {
+        clock.now += 100;
+        WG_CHECK(WGRateWindowRecord(&window, IP_A, MAC_A));
+    }
+    WG_CHECK_EQ(WGRateWindowCount(&window, WGRateKeyIP, IP_A), 10);
+
+    clock.now += 3600000;
+    WG_CHECK_EQ(WGRateWindowCount(&window, WGRateKeyIP, IP_A), 0);
+    WG_CHECK_EQ(window.ips.total, 0);
+    WG_CHECK(WGRateWindowRecord(&window, IP_A, MAC_A));
+    WG_CHECK_EQ(WGRateWindowCount(&window, WGRateKeyIP, IP_A), 1);
+    WGRateWindowFree(&window);
+}
+
+// Configure clamps the bucket count to the window length
+static void testConfigureClamp(void) {
+    WGTestClock clock = { .now = 0 };
+    WGRateWindow window;
+    WG_REQUIRE(WGRateWindowInit(&window, WGTestClockNow, &clock));
+    WG_CHECK(WGRateWindowConfigure(&window, 5, 100, 0, 0, 0));
+    WG_CHECK_EQ(window.ips.bucketCount, 5);
+    WG_CHECK_EQ(window.bucketMs, 1);
+    WG_CHECK(WGRateWindowConfigure(&window, 0, 0, 0, 0, 0));
+    WG_CHECK_EQ(window.windowMs, 1);
+    WG_CHECK_EQ(window.ips.bucketCount, 1);
+    WGRateWindowFree(&window);
+}
+
+// Random small steps over a few keys; every count matches a recount of the
+// recorded changes still inside the window
+static void testRandomRecount(void) {
+    enum { kChanges = 4000, kKeys = 5 };
+    static uint64_t times[kChanges];
+    static uint32_t ips[kChanges];
+    static uint64_t macs[kChanges];
+
+    WGTestClock clock = { .now = 0 };
+    WGRateWindow window;
+    WG_REQUIRE(WGTestOpen(&window, &clock, 0, 0, 0));
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    uint64_t bucketMs = window.bucketMs, buckets = window.ips.bucketCount;
+
+    for (size_t n = 0; n < kChanges; n++) {
+        clock.now += WGTestRandom(&state) % 60;
+        times[n] = clock.now;
+        ips[n] = IP_A + (uint32_t)(WGTestRandom(&state) % kKeys);
+        macs[n] = MAC_A + WGTestRandom(&state) % kKeys;
+        WG_REQUIRE(WGRateWindowRecord(&window, ips[n], macs[n]));
+
+        if (n % 37 != 0) {
+            continue;
+        }
+        uint32_t ipCount[kKeys] = { 0 }, macCount[kKeys] = { 0 }, total = 0;
+        for (size_t k = 0; k <= n; k++) {
+            if (clock.now / bucketMs - times[k] / bucketMs < buckets) {
+                ipCount[ips[k] - IP_A]++;
+                macCount[macs[k] - MAC_A]++;
+                total++;
+            }
+        }
+        for (uint32_t k = 0; k < kKeys; k++) {
+            WG_CHECK_EQ(WGRateWindowCount(&window, WGRateKeyIP, IP_A + k), ipCount[k]);
+            WG_CHECK_EQ(WGRateWindowCount(&window, WGRateKeyMAC, MAC_A + k), macCount[k]);
+        }
+        WG_CHECK_EQ(WGRateWindowCount(&window, WGRateKeyTotal, 0), total);
+        if (gWGTestFailures) {
+            fprintf(stderr, "  after change %zu at %llu ms\n", n, (unsigned long long)clock.now);
+            break;
+        }
+    }
+    WGRateWindowFree(&window);
+}
+
+int main(void) {
+    WG_RUN(testExpiryBoundary);
+    WG_RUN(testLimitRearm);
+    WG_RUN(testMACAndTotalLimits);
+    WG_RUN(testLongGap);
+    WG_RUN(testConfigureClamp);
+    WG_RUN(testRandomRecount);
+    return WGTestFinish();
+}
@@ -0,0 +1,439 @@
+/*
+ * WGTestSSIDIndex.c - SSID -> BSSID Index Tests
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * Checks the evil-twin and downgrade rules against hand-worked cases,
+ * recounts every posting list and security count after a random stream of
+ * adds, moves and removes, then feeds synthetic scan batches through
+ * WGScanIngest and checks the alerts and members it reports.
+ */
+
+#include "WGTest.h"
+#include "WGScanIngest.h"
+#include "WGSSIDIndex.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define OUI_CORP    0x001122ULL
+#define OUI_ROGUE   0x667788ULL
+#define BSSID(oui, nic) ((WGMACAddress)(oui) << 24 | (nic))
+
+static WGSSIDMember WGTestMember(const char *ssid, WGMACAddress bssid, WGSecurityRank security,
+                                 uint16_t channel, double timestamp) {
+    return (WGSSIDMember){
+        .bssid = bssid,
+        .ssid = ssid,
+        .ssidLength = strlen(ssid),
+        .security = security,
+        .band = WGChannelBandForChannel(channel),
+        .channel = channel,
+        .vendor = WG_OUI_UNKNOWN,
+        .timestamp = timestamp
+    };
+}
+
+static void testSecurityRank(void) {
+    WG_CHECK_EQ(WGSecurityRankFromName("Open"), WGSecurityRankOpen);
+    WG_CHECK_EQ(WGSecurityRankFromName("WEP"), WGSecurityRankWEP);
+    WG_CHECK_EQ(WGSecurityRankFromName("WPA"), WGSecurityRankWPA);
+    WG_CHECK_EQ(WGSecurityRankFromName("WPA2"), WGSecurityRankWPA2);
+    WG_CHECK_EQ(WGSecurityRankFromName("WPA3"), WGSecurityRankWPA3);
+    WG_CHECK_EQ(WGSecurityRankFromName(""), WGSecurityRankUnknown);
+    WG_CHECK_EQ(WGSecurityRankFromName("wpa2"), WGSecurityRankUnknown);
+
+    // Locally administered BSSIDs share their vendor's OUI
+    WG_CHECK_EQ(WGSSIDIndexOUI(BSSID(OUI_CORP, 1)), OUI_CORP);
+    WG_CHECK_EQ(WGSSIDIndexOUI(BSSID(OUI_CORP | 0x020000, 1)), OUI_CORP);
+}
+
+// Nothing is reported while an SSID settles; after, a new BSSID from a new
+// vendor is an evil twin, and stays one until it stops standing out
+static void testEvilTwin(void) {
+    WGSSIDIndex index;
+    WG_REQUIRE(WGSSIDIndexInit(&index));
+    WGSSIDAlert alert;
+
+    WGSSIDMember member = WGTestMember("corp", BSSID(OUI_CORP, 1), WGSecurityRankWPA2, 1, 1000);
+    WG_CHECK(!WGSSIDIndexAdd(&index, &member, &alert));
+    member = WGTestMember("corp", BSSID(OUI_ROGUE, 1), WGSecurityRankWPA2, 6, 1059);
+    WG_CHECK(!WGSSIDIndexAdd(&index, &member, &alert));     // Learned: still settling
+
+    // Known vendors, locally administered ones included
+    member = WGTestMember("corp", BSSID(OUI_CORP, 2), WGSecurityRankWPA2, 11, 1060);
+    WG_CHECK(!WGSSIDIndexAdd(&index, &member, &alert));
+    member = WGTestMember("corp", BSSID(OUI_CORP | 0x020000, 3), WGSecurityRankWPA2, 11, 1061);
+    WG_CHECK(!WGSSIDIndexAdd(&index, &member, &alert));
+    member = WGTestMember("corp", BSSID(OUI_ROGUE, 2), WGSecurityRankWPA2, 6, 1062);
+    WG_CHECK(!WGSSIDIndexAdd(&index, &member, &alert));
+
+    member = WGTestMember("corp", BSSID(0xABCDEF, 1), WGSecurityRankWPA2, 6, 1100);
+    WG_REQUIRE(WGSSIDIndexAdd(&index, &member, &alert));
+    WG_CHECK_EQ(alert.type, WGSSIDAlertEvilTwin);
+    WG_CHECK_EQ(alert.bssid, BSSID(0xABCDEF, 1));
+    WG_CHECK_EQ(alert.channel, 6);
+    WG_CHECK_EQ(alert.band, WGChannelBand2GHz);
+    WG_CHECK_EQ(alert.security, WGSecurityRankWPA2);
+    WG_CHECK_EQ(alert.knownSecurity, WGSecurityRankWPA2);
+    WG_CHECK(alert.newBSSID);
+    WG_CHECK(!alert.newChannel);
+    WG_CHECK(alert.newVendor);
+    WG_CHECK_EQ(alert.bssidCount, 6);
+    WG_CHECK_EQ(alert.ssidLength, 4);
+    WG_CHECK(strcmp(alert.ssid, "corp") == 0);
+
+    // Its vendor was not learned, so the next BSSID from it stands out too;
+    // one already seen with the SSID does not, even after leaving
+    member = WGTestMember("corp", BSSID(0xABCDEF, 2), WGSecurityRankWPA2, 6, 1101);
+    WG_CHECK(WGSSIDIndexAdd(&index, &member, &alert));
+    WG_CHECK_EQ(alert.type, WGSSIDAlertEvilTwin);
+    WGSSIDIndexRemove(&index, &member);
+    member.timestamp = 1200;
+    WG_CHECK(!WGSSIDIndexAdd(&index, &member, &alert));
+
+    // Another SSID learns on its own
+    member = WGTestMember("guest", BSSID(0xABCDEF, 3), WGSecurityRankOpen, 6, 1200);
+    WG_CHECK(!WGSSIDIndexAdd(&index, &member, &alert));
+    WG_CHECK_EQ(index.groupCount, 2);
+    WGSSIDIndexFree(&index);
+}
+
+// Weaker security than the SSID is known for, from a BSSID or channel not
+// seen with it
+static void testDowngrade(void) {
+    WGSSIDIndex index;
+    WG_REQUIRE(WGSSIDIndexInit(&index));
+    index.settleTime = 10;
+    WGSSIDAlert alert;
+
+    WGSSIDMember a = WGTestMember("corp", BSSID(OUI_CORP, 1), WGSecurityRankWPA3, 36, 0);
+    WG_CHECK(!WGSSIDIndexAdd(&index, &a, &alert));
+    WGSSIDMember b = WGTestMember("corp", BSSID(OUI_CORP, 2), WGSecurityRankWPA2, 6, 5);
+    WG_CHECK(!WGSSIDIndexAdd(&index, &b, &alert));
+    const WGSSIDGroup *group = WGSSIDIndexFind(&index, "corp", 4);
+    WG_REQUIRE(group);
+    WG_CHECK_EQ(WGSSIDGroupKnownSecurity(group), WGSecurityRankWPA3);
+    WG_CHECK_EQ(group->securityCounts[WGSecurityRankWPA3], 1);
+    WG_CHECK_EQ(group->securityCounts[WGSecurityRankWPA2], 1);
+
+    // A new BSSID from a known vendor, open
+    WGSSIDMember c = WGTestMember("corp", BSSID(OUI_CORP, 3), WGSecurityRankOpen, 36, 20);
+    WG_REQUIRE(WGSSIDIndexAdd(&index, &c, &alert));
+    WG_CHECK_EQ(alert.type, WGSSIDAlertDowngrade);
+    WG_CHECK_EQ(alert.security, WGSecurityRankOpen);
+    WG_CHECK_EQ(alert.knownSecurity, WGSecurityRankWPA3);
+    WG_CHECK(alert.newBSSID);
+    WG_CHECK(!alert.newChannel);
+    WG_CHECK(!alert.newVendor);
+    WG_CHECK_EQ(alert.bssidCount, 3);
+
+    // A known BSSID dropping to WPA on a known channel is left alone...
+    WGSSIDMember to = a;
+    to.security = WGSecurityRankWPA;
+    to.channel = 6;
+    to.band = WGChannelBand2GHz;
+    to.timestamp = 30;
+    WG_CHECK(!WGSSIDIndexMove(&index, &a, &to, &alert));
+    a = to;
+
+    // ...but not on a channel the SSID was never seen on
+    to.security = WGSecurityRankWEP;
+    to.channel = 149;
+    to.band = WGChannelBand5GHz;
+    to.timestamp = 40;
+    WG_REQUIRE(WGSSIDIndexMove(&index, &a, &to, &alert));
+    WG_CHECK_EQ(alert.type, WGSSIDAlertDowngrade);
+    WG_CHECK(!alert.newBSSID);
+    WG_CHECK(alert.newChannel);
+    WG_CHECK_EQ(alert.security, WGSecurityRankWEP);
+    a = to;
+
+    // Unknown security is never compared
+    WGSSIDMember d = WGTestMember("corp", BSSID(OUI_CORP, 4), WGSecurityRankUnknown, 165, 50);
+    WG_CHECK(!WGSSIDIndexAdd(&index, &d, &alert));
+
+    WG_CHECK_EQ(group->securityCounts[WGSecurityRankWPA3], 0);
+    WG_CHECK_EQ(group->securityCounts[WGSecurityRankWEP], 1);
+    WG_CHECK_EQ(group->securityCounts[WGSecurityRankOpen], 1);
+    WG_CHECK_EQ(WGSSIDGroupKnownSecurity(group), WGSecurityRankWPA3);
+    WGSSIDIndexFree(&index);
+}
+
+// Members stay sorted; groups outlive their networks until Clear; hidden
+// networks are not indexed
+static void testMembers(void) {
+    WGSSIDIndex index;
+    WG_REQUIRE(WGSSIDIndexInit(&index));
+    WGSSIDAlert alert;
+    static const uint64_t nics[] = { 5, 1, 9, 3 };
+    WGSSIDMember members[4];
+    for (size_t i = 0; i < 4; i++) {
+        members[i] = WGTestMember("corp", BSSID(OUI_CORP, nics[i]), WGSecurityRankWPA2, 6, 0);
+        WGSSIDIndexAdd(&index, &members[i], &alert);
+    }
+    const WGSSIDGroup *group = WGSSIDIndexFind(&index, "corp", 4);
+    WG_REQUIRE(group);
+    const uint64_t *bssids;
+    WG_REQUIRE(WGSSIDIndexMembers(&index, group, &bssids) == 4);
+    WG_CHECK_EQ(bssids[0], BSSID(OUI_CORP, 1));
+    WG_CHECK_EQ(bssids[1], BSSID(OUI_CORP, 3));
+    WG_CHECK_EQ(bssids[2], BSSID(OUI_CORP, 5));
+    WG_CHECK_EQ(bssids[3], BSSID(OUI_CORP, 9));
+
+    // Renamed networks move between groups
+    WGSSIDMember renamed = members[2];
+    renamed.ssid = "corp-5G";
+    renamed.ssidLength = 7;
+    WGSSIDIndexMove(&index, &members[2], &renamed, &alert);
+    WG_CHECK_EQ(WGSSIDIndexMembers(&index, group, &bssids), 3);
+    const WGSSIDGroup *other = WGSSIDIndexFind(&index, "corp-5G", 7);
+    WG_REQUIRE(other);
+    WG_REQUIRE(WGSSIDIndexMembers(&index, other, &bssids) == 1);
+    WG_CHECK_EQ(bssids[0], BSSID(OUI_CORP, 9));
+
+    // Removing what is not there changes nothing
+    WGSSIDIndexRemove(&index, &members[2]);
+    WG_CHECK_EQ(WGSSIDIndexMembers(&index, group, &bssids), 3);
+    WG_CHECK_EQ(group->securityCounts[WGSecurityRankWPA2], 3);
+
+    for (size_t i = 0; i < 4; i++) {
+        WGSSIDIndexRemove(&index, i == 2 ? &renamed : &members[i]);
+    }
+    WG_CHECK(WGSSIDIndexFind(&index, "corp", 4) == group);
+    WG_CHECK_EQ(WGSSIDIndexMembers(&index, group, &bssids), 0);
+    WG_CHECK_EQ(group->securityCounts[WGSecurityRankWPA2], 0);
+
+    WGSSIDMember hidden = WGTestMember("", BSSID(OUI_CORP, 7), WGSecurityRankOpen, 1, 0);
+    WG_CHECK(!WGSSIDIndexAdd(&index, &hidden, &alert));
+    WG_CHECK(!WGSSIDIndexFind(&index, "", 0));
+    WG_CHECK(!WGSSIDIndexFind(&index, "cor", 3));
+    WG_CHECK_EQ(index.groupCount, 2);
+
+    WGSSIDIndexClear(&index);
+    WG_CHECK_EQ(index.groupCount, 0);
+    WG_CHECK(!WGSSIDIndexFind(&index, "corp", 4));
+    WGSSIDIndexFree(&index);
+}
+
+#pragma mark - Randomised
+
+#define WG_TEST_NETWORKS 150
+#define WG_TEST_SSIDS 6
+
+static const char * const kWGTestSSIDs[WG_TEST_SSIDS] = { "", "corp", "corp-5G", "guest", "lab", "a" };
+
+typedef struct {
+    WGSSIDMember member;
+    bool present;
+} WGTestNetwork;
+
+static WGSSIDMember WGTestRandomMember(uint64_t *state, WGMACAddress bssid, double timestamp) {
+    static const uint16_t kChannels[] = { 1, 6, 11, 36, 44, 149 };
+    const char *ssid = kWGTestSSIDs[WGTestRandom(state) % WG_TEST_SSIDS];
+    WGSecurityRank security = (WGSecurityRank)((int)(WGTestRandom(state) % (WGSecurityRankCount + 1)) - 1);
+    return WGTestMember(ssid, bssid, security, kChannels[WGTestRandom(state) % 6], timestamp);
+}
+
+// Every group's members and security counts match the live networks
+static bool WGTestRecount(const WGSSIDIndex *index, const WGTestNetwork *networks) {
+    for (size_t s = 1; s < WG_TEST_SSIDS; s++) {
+        uint64_t expect[WG_TEST_NETWORKS];
+        uint32_t counts[WGSecurityRankCount] = { 0 };
+        size_t expectCount = 0;
+        for (size_t n = 0; n < WG_TEST_NETWORKS; n++) {
+            const WGSSIDMember *member = &networks[n].member;
+            if (!networks[n].present || strcmp(member->ssid, kWGTestSSIDs[s]) != 0) {
+                continue;
+            }
+            expect[expectCount++] = member->bssid;   // Networks are in BSSID order
+            if (member->security != WGSecurityRankUnknown) {
+                counts[member->security]++;
+            }
+        }
+
+        const WGSSIDGroup *group = WGSSIDIndexFind(index, kWGTestSSIDs[s], strlen(kWGTestSSIDs[s]));
+        if (!group) {
+            if (expectCount > 0) {
+                fprintf(stderr, "\"%s\" not indexed\n", kWGTestSSIDs[s]);
+                return false;
+            }
+            continue;
+        }
+        const uint64_t *bssids;
+        size_t count = WGSSIDIndexMembers(index, group, &bssids);
+        if (count != expectCount || (count && memcmp(bssids, expect, count * sizeof(uint64_t)) != 0) ||
+            memcmp(group->securityCounts, counts, sizeof(counts)) != 0) {
+            fprintf(stderr, "\"%s\": %zu members, expected %zu\n", kWGTestSSIDs[s], count, expectCount);
+            return false;
+        }
+    }
+    return !WGSSIDIndexFind(index, "", 0);
+}
+
+static void testRandomRecount(void) {
+    static WGTestNetwork networks[WG_TEST_NETWORKS];
+    memset(networks, 0, sizeof(networks));
+    WGSSIDIndex index;
+    WG_REQUIRE(WGSSIDIndexInit(&index));
+    WGSSIDAlert alert;
+    uint64_t state = 0x55D1D5EEDULL;
+    double now = 0;
+
+    for (int step = 0; step < 20000; step++) {
+        now += 0.05;
+        size_t n = WGTestRandom(&state) % WG_TEST_NETWORKS;
+        WGTestNetwork *network = &networks[n];
+        uint64_t roll = WGTestRandom(&state) % 10;
+        if (!network->present) {
+            network->member = WGTestRandomMember(&state, BSSID(OUI_CORP, n), now);
+            network->present = true;
+            WGSSIDIndexAdd(&index, &network->member, &alert);
+        } else if (roll < 3) {
+            WGSSIDIndexRemove(&index, &network->member);
+            network->present = false;
+        } else {
+            WGSSIDMember to = WGTestRandomMember(&state, network->member.bssid, now);
+            if (roll < 6) {
+                to.ssid = network->member.ssid;      // Security or channel only
+                to.ssidLength = network->member.ssidLength;
+            }
+            WGSSIDIndexMove(&index, &network->member, &to, &alert);
+            network->member = to;
+        }
+        if (!WGTestRecount(&index, networks)) {
+            fprintf(stderr, "  after step %d\n", step);
+            gWGTestFailures++;
+            break;
+        }
+    }
+
+    WGSSIDIndexClear(&index);
+    memset(networks, 0, sizeof(networks));
+    WG_CHECK(WGTestRecount(&index, networks));
+    WGSSIDIndexFree(&index);
+}
+
+#pragma mark - Scan Batches
+
+static WGScanRecord WGTestRecord(const char *ssid, WGMACAddress bssid, const char *security,
+                                 uint16_t channel, double lastSeen) {
+    WGScanRecord record;
+    memset(&record, 0, sizeof(record));
+    record.bssid = bssid;
+    record.lastSeen = lastSeen;
+    record.rssi = -60;
+    record.channel = channel;
+    record.channelWidth = 20;
+    record.band = WGChannelBandForChannel(channel);
+    record.ssidLength = (uint8_t)snprintf(record.ssid, sizeof(record.ssid), "%s", ssid);
+    snprintf(record.security, sizeof(record.security), "%s", security);
+    return record;
+}
+
+// A site settles over two scans, then a rogue AP and a downgraded AP show
+// up, networks expire, one is renamed, and Clear forgets everything
+static void testScanBatches(void) {
+    WGScanIngest ingest;
+    WG_REQUIRE(WGScanIngestInit(&ingest, NULL, NULL));
+    WG_REQUIRE(WGScanIngestStart(&ingest));
+    WGSSIDAlert alerts[WG_SCAN_ALERT_CAPACITY + 8];
+    WGMACAddress members[16];
+
+    for (int scan = 0; scan < 2; scan++) {
+        double now = 1000 + 30 * scan;
+        WGScanRecord batch[] = {
+            WGTestRecord("corp", BSSID(OUI_CORP, 1), "WPA2", 1, now),
+            WGTestRecord("corp", BSSID(OUI_CORP, 2), "WPA2", 6, now),
+            WGTestRecord("corp", BSSID(OUI_CORP, 3), "WPA2", 11, now),
+            WGTestRecord("cafe", BSSID(OUI_ROGUE, 1), "Open", 6, now),
+            WGTestRecord("", BSSID(OUI_ROGUE, 2), "WPA2", 6, now),
+        };
+        WG_CHECK(WGScanIngestSubmit(&ingest, batch, 5));
+    }
+    WGScanIngestWaitIdle(&ingest);
+    WG_CHECK_EQ(WGScanIngestTakeAlerts(&ingest, alerts, 8), 0);
+    WG_CHECK_EQ(WGScanIngestSSIDMembers(&ingest, "corp", 4, members, 16), 3);
+    WG_CHECK_EQ(WGScanIngestSSIDMembers(&ingest, "cafe", 4, members, 16), 1);
+    WG_CHECK_EQ(WGScanIngestSSIDMembers(&ingest, "", 0, members, 16), 0);
+
+    WGScanRecord batch[] = {
+        WGTestRecord("corp", BSSID(OUI_CORP, 1), "WPA2", 1, 1100),
+        WGTestRecord("corp", BSSID(OUI_ROGUE, 9), "WPA2", 6, 1100),    // Evil twin
+        WGTestRecord("corp", BSSID(OUI_CORP, 9), "Open", 6, 1100),     // Downgrade
+        WGTestRecord("cafe", BSSID(OUI_CORP, 4), "Open", 6, 1100),     // Evil twin
+    };
+    WG_CHECK(WGScanIngestSubmit(&ingest, batch, 4));
+    WGScanIngestWaitIdle(&ingest);
+    WG_REQUIRE(WGScanIngestTakeAlerts(&ingest, alerts, 8) == 3);
+    WG_CHECK_EQ(alerts[0].type, WGSSIDAlertEvilTwin);
+    WG_CHECK_EQ(alerts[0].bssid, BSSID(OUI_ROGUE, 9));
+    WG_CHECK_EQ(alerts[0].bssidCount, 4);
+    WG_CHECK(strcmp(alerts[0].ssid, "corp") == 0);
+    WG_CHECK_EQ(alerts[1].type, WGSSIDAlertDowngrade);
+    WG_CHECK_EQ(alerts[1].bssid, BSSID(OUI_CORP, 9));
+    WG_CHECK_EQ(alerts[1].security, WGSecurityRankOpen);
+    WG_CHECK_EQ(alerts[1].knownSecurity, WGSecurityRankWPA2);
+    WG_CHECK(!alerts[1].newVendor);
+    WG_CHECK_EQ(alerts[2].type, WGSSIDAlertEvilTwin);
+    WG_CHECK(strcmp(alerts[2].ssid, "cafe") == 0);
+    WG_CHECK_EQ(WGScanIngestTakeAlerts(&ingest, alerts, 8), 0);
+
+    // Seen again unchanged: nothing new stands out
+    WG_CHECK(WGScanIngestSubmit(&ingest, batch, 4));
+    WGScanIngestWaitIdle(&ingest);
+    WG_CHECK_EQ(WGScanIngestTakeAlerts(&ingest, alerts, 8), 0);
+
+    // The first two scans expire; members copy out ascending
+    WG_CHECK(WGScanIngestExpire(&ingest, 1050));
+    WGScanIngestWaitIdle(&ingest);
+    WG_REQUIRE(WGScanIngestSSIDMembers(&ingest, "corp", 4, members, 16) == 3);
+    WG_CHECK_EQ(members[0], BSSID(OUI_CORP, 1));
+    WG_CHECK_EQ(members[1], BSSID(OUI_CORP, 9));
+    WG_CHECK_EQ(members[2], BSSID(OUI_ROGUE, 9));
+    WG_CHECK_EQ(WGScanIngestSSIDMembers(&ingest, "corp", 4, members, 1), 3);
+    WG_CHECK_EQ(WGScanIngestSSIDMembers(&ingest, "cafe", 4, members, 16), 1);
+
+    // Renaming moves a network between SSIDs. Its vendor was not learned
+    // by cafe (the last one raised an alert), so it stands out there too
+    batch[0] = WGTestRecord("cafe", BSSID(OUI_CORP, 1), "Open", 1, 1110);
+    WG_CHECK(WGScanIngestSubmit(&ingest, batch, 1));
+    WGScanIngestWaitIdle(&ingest);
+    WG_CHECK_EQ(WGScanIngestSSIDMembers(&ingest, "corp", 4, members, 16), 2);
+    WG_CHECK_EQ(WGScanIngestSSIDMembers(&ingest, "cafe", 4, members, 16), 2);
+    WG_REQUIRE(WGScanIngestTakeAlerts(&ingest, alerts, 8) == 1);
+    WG_CHECK_EQ(alerts[0].type, WGSSIDAlertEvilTwin);
+    WG_CHECK_EQ(alerts[0].bssid, BSSID(OUI_CORP, 1));
+    WG_CHECK(strcmp(alerts[0].ssid, "cafe") == 0);
+
+    // More rogues than the alert ring holds: the oldest are dropped
+    WGScanRecord rogues[WG_SCAN_ALERT_CAPACITY + 8];
+    for (size_t i = 0; i < WG_SCAN_ALERT_CAPACITY + 8; i++) {
+        rogues[i] = WGTestRecord("corp", BSSID(0x100000 + i, 1), "WPA2", 6, 1120);
+    }
+    WG_CHECK(WGScanIngestSubmit(&ingest, rogues, WG_SCAN_ALERT_CAPACITY + 8));
+    WGScanIngestWaitIdle(&ingest);
+    WG_REQUIRE(WGScanIngestTakeAlerts(&ingest, alerts, WG_SCAN_ALERT_CAPACITY + 8) == WG_SCAN_ALERT_CAPACITY);
+    WG_CHECK_EQ(alerts[0].bssid, BSSID(0x100008, 1));
+    WG_CHECK_EQ(alerts[WG_SCAN_ALERT_CAPACITY - 1].bssid, BSSID(0x100000 + WG_SCAN_ALERT_CAPACITY + 7, 1));
+
+    // Cleared: pending alerts and what was learned are gone, so a new
+    // vendor is learned silently again
+    WG_CHECK(WGScanIngestSubmit(&ingest, rogues, 1));
+    WG_CHECK(WGScanIngestClear(&ingest));
+    WG_CHECK(WGScanIngestSubmit(&ingest, batch + 1, 1));
+    WGScanIngestWaitIdle(&ingest);
+    WG_CHECK_EQ(WGScanIngestTakeAlerts(&ingest, alerts, 8), 0);
+    WG_CHECK_EQ(WGScanIngestSSIDMembers(&ingest, "corp", 4, members, 16), 1);
+    WG_CHECK_EQ(WGScanIngestSSIDMembers(&ingest, "cafe", 4, members, 16), 0);
+    WGScanIngestFree(&ingest);
+}
+
+int main(void) {
+    WG_RUN(testSecurityRank);
+    WG_RUN(testEvilTwin);
+    WG_RUN(testDowngrade);
+    WG_RUN(testMembers);
+    WG_RUN(testRandomRecount);
+    WG_RUN(testScanBatches);
+    return WGTestFinish();
+}
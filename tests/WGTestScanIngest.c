@@ -0,0 +1,313 @@
+/*
+ * WGTestScanIngest.c - Scan Ingestion Pipeline Tests
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * Checks how the pending diff coalesces changes, then runs the worker
+ * against a synthetic source submitting about 10k results/s (with expire,
+ * clear and clear-history commands mixed in) while a consumer thread keeps
+ * a view built only from diffs and compares it with every snapshot it
+ * takes. Build with -fsanitize=thread to check the locking.
+ */
+
+#include "WGTest.h"
+#include "WGScanIngest.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define BSSID_A 0x0200000000A1ULL
+#define BSSID_B 0x0200000000B2ULL
+#define BSSID_C 0x0200000000C3ULL
+
+static WGScanRecord WGTestRecord(WGMACAddress bssid, double lastSeen, int16_t rssi, uint16_t channel) {
+    WGScanRecord record;
+    memset(&record, 0, sizeof(record));
+    record.bssid = bssid;
+    record.lastSeen = lastSeen;
+    record.rssi = rssi;
+    record.channel = channel;
+    record.channelWidth = 20;
+    record.band = WGChannelBandForChannel(channel);
+    record.ssidLength = (uint8_t)snprintf(record.ssid, sizeof(record.ssid), "net-%02x", (unsigned)(bssid & 0xFF));
+    strcpy(record.security, "WPA2");
+    return record;
+}
+
+static bool WGTestDiffHas(const WGMACAddress *list, size_t count, WGMACAddress bssid) {
+    for (size_t i = 0; i < count; i++) {
+        if (list[i] == bssid) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void WGTestCountNotify(void *context) {
+    __atomic_add_fetch((int *)context, 1, __ATOMIC_RELAXED);
+}
+
+// Each BSSID keeps one net change between takes
+static void testDiffCoalescing(void) {
+    int notified = 0;
+    WGScanIngest ingest;
+    WG_REQUIRE(WGScanIngestInit(&ingest, WGTestCountNotify, &notified));
+    WG_REQUIRE(WGScanIngestStart(&ingest));
+    WGScanDiff diff;
+    WGScanDiffInit(&diff);
+
+    WGScanRecord batch[] = { WGTestRecord(BSSID_A, 100, -50, 6), WGTestRecord(BSSID_B, 100, -60, 36) };
+    WG_CHECK(WGScanIngestSubmit(&ingest, batch, 2));
+    batch[0].rssi = -55;
+    WG_CHECK(WGScanIngestSubmit(&ingest, batch, 1));
+    WGScanIngestWaitIdle(&ingest);
+    WG_CHECK_EQ(notified, 1);
+
+    WGScanSnapshot *snapshot = WGScanIngestTake(&ingest, &diff);
+    WG_REQUIRE(snapshot);
+    WG_CHECK_EQ(diff.insertedCount, 2);
+    WG_CHECK_EQ(diff.updatedCount, 0);
+    WG_CHECK_EQ(snapshot->count, 2);
+    WG_CHECK_EQ(WGScanSnapshotFind(snapshot, BSSID_A)->rssi, -55);
+    WG_CHECK_EQ(WGScanSnapshotFind(snapshot, BSSID_A)->sampleSeq, 2);
+
+    // Nothing changed: the same snapshot comes back with an empty diff
+    WGScanSnapshot *again = WGScanIngestTake(&ingest, &diff);
+    WG_CHECK(again == snapshot);
+    WG_CHECK(WGScanDiffIsEmpty(&diff));
+    WGScanSnapshotRelease(again);
+    WGScanSnapshotRelease(snapshot);
+
+    // A updated, B expired, C inserted and expired before any take
+    batch[0] = WGTestRecord(BSSID_A, 200, -52, 6);
+    batch[1] = WGTestRecord(BSSID_C, 150, -70, 11);
+    WG_CHECK(WGScanIngestSubmit(&ingest, batch, 2));
+    WG_CHECK(WGScanIngestExpire(&ingest, 160));
+    WGScanIngestWaitIdle(&ingest);
+    snapshot = WGScanIngestTake(&ingest, &diff);
+    WG_REQUIRE(snapshot);
+    WG_CHECK_EQ(diff.insertedCount, 0);
+    WG_CHECK_EQ(diff.updatedCount, 1);
+    WG_CHECK(WGTestDiffHas(diff.updated, diff.updatedCount, BSSID_A));
+    WG_CHECK_EQ(diff.removedCount, 1);
+    WG_CHECK(WGTestDiffHas(diff.removed, diff.removedCount, BSSID_B));
+    WG_CHECK_EQ(snapshot->count, 1);
+    WGScanSnapshotRelease(snapshot);
+
+    // Cleared and seen again: the consumer still holds A, so it is updated
+    WG_CHECK(WGScanIngestClear(&ingest));
+    batch[0] = WGTestRecord(BSSID_A, 300, -58, 6);
+    WG_CHECK(WGScanIngestSubmit(&ingest, batch, 1));
+    WGScanIngestWaitIdle(&ingest);
+    snapshot = WGScanIngestTake(&ingest, &diff);
+    WG_REQUIRE(snapshot);
+    WG_CHECK_EQ(diff.insertedCount, 0);
+    WG_CHECK_EQ(diff.updatedCount, 1);
+    WG_CHECK_EQ(diff.removedCount, 0);
+    WG_CHECK_EQ(WGScanSnapshotFind(snapshot, BSSID_A)->sampleSeq, 1);
+    WG_CHECK_EQ(notified, 3);
+    WGScanSnapshotRelease(snapshot);
+
+    WGScanDiffFree(&diff);
+    WGScanIngestFree(&ingest);
+}
+
+#pragma mark - Synthetic Load
+
+#define WG_TEST_POPULATION 1500
+#define WG_TEST_BATCH 100            // Every 10 ms: 10k results/s
+#define WG_TEST_BATCHES 100
+
+typedef struct {
+    WGScanIngest *ingest;
+    bool done;                      // Atomic
+    int notified;                   // Atomic
+} WGTestLoad;
+
+static void WGTestSleepMs(long ms) {
+    struct timespec ts = { ms / 1000, (ms % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+}
+
+static void *WGTestSource(void *arg) {
+    WGTestLoad *load = arg;
+    WGScanRecord batch[WG_TEST_BATCH];
+    uint64_t state = 0x5EED5EED5EEDULL;
+    double now = 1700000000.0;
+
+    for (int b = 0; b < WG_TEST_BATCHES; b++) {
+        now += 0.01;
+        for (size_t i = 0; i < WG_TEST_BATCH; i++) {
+            WGMACAddress bssid = 0x020000000000ULL | (WGTestRandom(&state) % WG_TEST_POPULATION + 1);
+            uint16_t channel = (uint16_t)((bssid & 3) ? 1 + bssid % 11 : 36 + 4 * (bssid % 8));
+            if (WGTestRandom(&state) % 50 == 0) {
+                channel = (uint16_t)(1 + WGTestRandom(&state) % 11);    // Channel switch
+            }
+            batch[i] = WGTestRecord(bssid, now, (int16_t)(-90 + (int)(WGTestRandom(&state) % 60)), channel);
+        }
+        WGScanIngestSubmit(load->ingest, batch, WG_TEST_BATCH);
+
+        if (b % 20 == 19) {
+            WGScanIngestExpire(load->ingest, now - 0.15);
+        }
+        if (b % 45 == 44) {
+            WGScanIngestClear(load->ingest);
+        }
+        if (b % 30 == 29) {
+            WGScanIngestClearHistory(load->ingest);
+        }
+        WGTestSleepMs(10);
+    }
+    __atomic_store_n(&load->done, true, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+// The consumer's copy of the table, keyed by BSSID
+typedef struct {
+    WGScanRecord *records;
+    size_t count;
+    size_t capacity;
+    WGHashMap index;
+} WGTestView;
+
+// The fields a diff has to account for (signal statistics move with every
+// batch and are not part of it)
+static bool WGTestSameRecord(const WGScanRecord *a, const WGScanRecord *b) {
+    return a->bssid == b->bssid && a->lastSeen == b->lastSeen && a->rssi == b->rssi &&
+           a->channel == b->channel && a->channelWidth == b->channelWidth && a->band == b->band &&
+           a->flags == b->flags && a->ssidLength == b->ssidLength &&
+           memcmp(a->ssid, b->ssid, a->ssidLength) == 0 && strcmp(a->security, b->security) == 0 &&
+           a->sampleSeq == b->sampleSeq && a->vendor == b->vendor;
+}
+
+static bool WGTestViewPut(WGTestView *view, const WGScanRecord *record, bool insert) {
+    uint64_t *slot = WGHashMapFind(&view->index, record->bssid);
+    if (slot) {
+        if (insert) {
+            return false;       // Inserted twice
+        }
+        view->records[*slot] = *record;
+        return true;
+    }
+    if (!insert) {
+        return false;           // Updated before it was inserted
+    }
+    if (view->count == view->capacity) {
+        size_t capacity = view->capacity ? view->capacity * 2 : 256;
+        WGScanRecord *grown = realloc(view->records, capacity * sizeof(WGScanRecord));
+        if (!grown) {
+            return false;
+        }
+        view->records = grown;
+        view->capacity = capacity;
+    }
+    view->records[view->count] = *record;
+    return WGHashMapPut(&view->index, record->bssid, view->count++);
+}
+
+static bool WGTestViewRemove(WGTestView *view, WGMACAddress bssid) {
+    uint64_t *slot = WGHashMapFind(&view->index, bssid);
+    if (!slot) {
+        return false;
+    }
+    size_t i = (size_t)*slot;
+    WGHashMapRemove(&view->index, bssid);
+    if (i != --view->count) {
+        view->records[i] = view->records[view->count];
+        WGHashMapPut(&view->index, view->records[i].bssid, i);
+    }
+    return true;
+}
+
+// Applies a diff, then checks the view against the snapshot it came with
+static bool WGTestViewApply(WGTestView *view, const WGScanSnapshot *snapshot, const WGScanDiff *diff) {
+    for (size_t i = 0; i < diff->insertedCount; i++) {
+        const WGScanRecord *record = WGScanSnapshotFind(snapshot, diff->inserted[i]);
+        if (!record || !WGTestViewPut(view, record, true)) {
+            fprintf(stderr, "bad insert of %012llx\n", (unsigned long long)diff->inserted[i]);
+            return false;
+        }
+    }
+    for (size_t i = 0; i < diff->updatedCount; i++) {
+        const WGScanRecord *record = WGScanSnapshotFind(snapshot, diff->updated[i]);
+        if (!record || !WGTestViewPut(view, record, false)) {
+            fprintf(stderr, "bad update of %012llx\n", (unsigned long long)diff->updated[i]);
+            return false;
+        }
+    }
+    for (size_t i = 0; i < diff->removedCount; i++) {
+        if (WGScanSnapshotFind(snapshot, diff->removed[i]) || !WGTestViewRemove(view, diff->removed[i])) {
+            fprintf(stderr, "bad removal of %012llx\n", (unsigned long long)diff->removed[i]);
+            return false;
+        }
+    }
+
+    if (view->count != snapshot->count) {
+        fprintf(stderr, "view holds %zu networks, snapshot %zu\n", view->count, snapshot->count);
+        return false;
+    }
+    for (size_t i = 0; i < snapshot->count; i++) {
+        const uint64_t *slot = WGHashMapFind(&view->index, snapshot->records[i].bssid);
+        if (!slot || !WGTestSameRecord(&view->records[*slot], &snapshot->records[i])) {
+            fprintf(stderr, "view differs at %012llx\n", (unsigned long long)snapshot->records[i].bssid);
+            return false;
+        }
+    }
+    return true;
+}
+
+static void testSyntheticLoad(void) {
+    WGScanIngest ingest;
+    WGTestLoad load = { .ingest = &ingest };
+    WG_REQUIRE(WGScanIngestInit(&ingest, WGTestCountNotify, &load.notified));
+    WG_REQUIRE(WGScanIngestStart(&ingest));
+    WGTestView view = { 0 };
+    WG_REQUIRE(WGHashMapInit(&view.index, WG_TEST_POPULATION));
+    WGScanDiff diff;
+    WGScanDiffInit(&diff);
+
+    pthread_t source;
+    WG_REQUIRE(pthread_create(&source, NULL, WGTestSource, &load) == 0);
+
+    // Consume at display refresh until the source stops, then once more
+    // after the queue drains
+    size_t takes = 0, changes = 0;
+    uint64_t version = 0;
+    bool ok = true;
+    for (bool last = false; ok;) {
+        last = __atomic_load_n(&load.done, __ATOMIC_ACQUIRE);
+        if (last) {
+            WGScanIngestWaitIdle(&ingest);
+        }
+        WGScanSnapshot *snapshot = WGScanIngestTake(&ingest, &diff);
+        ok = snapshot && snapshot->version >= version && WGTestViewApply(&view, snapshot, &diff);
+        if (snapshot) {
+            version = snapshot->version;
+            WGScanSnapshotRelease(snapshot);
+        }
+        takes++;
+        changes += diff.insertedCount + diff.updatedCount + diff.removedCount;
+        if (last) {
+            break;
+        }
+        WGTestSleepMs(16);
+    }
+    pthread_join(source, NULL);
+
+    WG_CHECK(ok);
+    WG_CHECK(takes > 10);
+    WG_CHECK(changes > WG_TEST_POPULATION);
+    WG_CHECK(__atomic_load_n(&load.notified, __ATOMIC_RELAXED) > 0);
+
+    WGScanDiffFree(&diff);
+    WGHashMapFree(&view.index);
+    free(view.records);
+    WGScanIngestFree(&ingest);
+}
+
+int main(void) {
+    WG_RUN(testDiffCoalescing);
+    WG_RUN(testSyntheticLoad);
+    return WGTestFinish();
+}
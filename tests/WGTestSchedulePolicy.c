@@ -0,0 +1,271 @@
+/*
+ * WGTestSchedulePolicy.c - Adaptive Monitoring Schedule Tests
+ * WiFiGuard - iOS 16.1.2 (Dopamine Rootless)
+ *
+ * Runs WGSchedulePolicy on a fake nanosecond clock, always dispatching the
+ * earliest due task, and checks the exact schedule: back-off while quiet,
+ * reset on change, escalation of every task after an alert and its
+ * expiry, activity between runs, budget floors and task slots.
+ */
+
+#include "WGTest.h"
+#include "WGSchedulePolicy.h"
+
+#define S 1000000000ull
+
+typedef struct {
+    uint64_t now;
+} WGTestClock;
+
+static uint64_t WGTestClockNow(void *context) {
+    return ((WGTestClock *)context)->now;
+}
+
+// Moves the clock to the next due run, runs it and returns its task
+static int WGTestRunNext(WGSchedulePolicy *policy, WGTestClock *clock, uint64_t durationNs,
+                         WGScheduleActivity activity) {
+    int task;
+    uint64_t due = WGSchedulePolicyNextDue(policy, &task);
+    if (task < 0) {
+        return -1;
+    }
+    clock->now = due;
+    WGSchedulePolicyBeginRun(policy, task);
+    WG_CHECK_EQ(policy->tasks[task].nextDueNs, WG_SCHEDULE_NEVER);
+    clock->now += durationNs;
+    WGSchedulePolicyRecordRun(policy, task, durationNs, activity);
+    return task;
+}
+
+static void testBackoff(void) {
+    WGTestClock clock = { .now = 5 * S };
+    WGSchedulePolicy policy;
+    WGSchedulePolicyInit(&policy, WGTestClockNow, &clock);
+    WGScheduleConfig config = WGScheduleConfigDefault(10 * S);
+    WG_CHECK_EQ(config.fastNs, 10 * S / 3);
+    WG_CHECK_EQ(config.maxNs, 80 * S);
+    int task = WGSchedulePolicyAddTask(&policy, &config);
+    WG_REQUIRE(task == 0);
+    WG_CHECK_EQ(WGSchedulePolicyNextDue(&policy, NULL), WG_SCHEDULE_NEVER);
+
+    WGSchedulePolicyStart(&policy, task);
+    WG_CHECK_EQ(WGSchedulePolicyNextDue(&policy, NULL), 15 * S);
+
+    // Doubles after every third quiet run, up to the ceiling
+    static const uint64_t expect[] = { 10, 10, 20, 20, 20, 40, 40, 40, 80, 80, 80, 80 };
+    for (size_t i = 0; i < sizeof(expect) / sizeof(expect[0]); i++) {
+        WG_CHECK_EQ(WGTestRunNext(&policy, &clock, 0, WGScheduleActivityQuiet), task);
+        WG_CHECK_EQ(WGSchedulePolicyNextDue(&policy, NULL) - clock.now, expect[i] * S);
+    }
+    WG_CHECK_EQ(WGSchedulePolicyLeeway(&policy, task), 1 * S);
+
+    // Any change goes straight back to base
+    WGTestRunNext(&policy, &clock, 0, WGScheduleActivityChanged);
+    WG_CHECK_EQ(WGSchedulePolicyNextDue(&policy, NULL) - clock.now, 10 * S);
+    WG_CHECK_EQ(WGSchedulePolicyLeeway(&policy, task), 1 * S);
+    WG_CHECK_EQ(policy.tasks[task].stats.runs, 13);
+    WG_CHECK_EQ(policy.tasks[task].stats.escalations, 0);
+}
+
+// An alert on one task escalates every active task until escalationNs passes
+static void testEscalation(void) {
+    WGTestClock clock = { .now = 0 };
+    WGSchedulePolicy policy;
+    WGSchedulePolicyInit(&policy, WGTestClockNow, &clock);
+    WGScheduleConfig scanConfig = WGScheduleConfigDefault(30 * S);
+    WGScheduleConfig arpConfig = WGScheduleConfigDefault(10 * S);
+    int scan = WGSchedulePolicyAddTask(&policy, &scanConfig);
+    int arp = WGSchedulePolicyAddTask(&policy, &arpConfig);
+    WG_REQUIRE(scan == 0 && arp == 1);
+    WGSchedulePolicyStart(&policy, scan);
+    WGSchedulePolicyStart(&policy, arp);
+
+    WG_CHECK_EQ(WGTestRunNext(&policy, &clock, 0, WGScheduleActivityAlert), arp);
+    WG_CHECK_EQ(policy.tasks[arp].nextDueNs, 10 * S + 10 * S / 3);
+    // The scan was 30 s out; it is pulled in to one fast interval after its last run
+    int task;
+    WG_CHECK_EQ(WGSchedulePolicyNextDue(&policy, &task), 10 * S);
+    WG_CHECK_EQ(task, scan);
+    WG_CHECK_EQ(policy.tasks[scan].stats.escalations, 1);
+    WG_CHECK_EQ(policy.tasks[arp].stats.escalations, 1);
+
+    WG_CHECK_EQ(WGTestRunNext(&policy, &clock, 0, WGScheduleActivityQuiet), scan);
+    WG_CHECK_EQ(policy.tasks[scan].nextDueNs, 20 * S);
+
+    // A second alert while escalated extends it without counting again
+    WG_CHECK_EQ(WGTestRunNext(&policy, &clock, 0, WGScheduleActivityAlert), arp);
+    WG_CHECK_EQ(policy.tasks[arp].stats.escalations, 1);
+    WG_CHECK_EQ(policy.tasks[arp].escalatedUntilNs, clock.now + 60 * S);
+
+    // Quiet runs keep backing off underneath the fast interval; once the
+    // escalation passes, each task is back on its own interval
+    uint64_t until = policy.tasks[arp].escalatedUntilNs;
+    while (WGSchedulePolicyNextDue(&policy, NULL) < until) {
+        WGTestRunNext(&policy, &clock, 0, WGScheduleActivityQuiet);
+        WG_CHECK_EQ(WGSchedulePolicyEffectiveInterval(&policy, arp), 10 * S / 3);
+    }
+    WGTestRunNext(&policy, &clock, 0, WGScheduleActivityQuiet);
+    WG_CHECK(policy.tasks[arp].intervalNs > 10 * S);
+    WG_CHECK(policy.tasks[scan].intervalNs > 30 * S);
+    WG_CHECK_EQ(WGSchedulePolicyEffectiveInterval(&policy, arp), policy.tasks[arp].intervalNs);
+    WG_CHECK_EQ(WGSchedulePolicyEffectiveInterval(&policy, scan), policy.tasks[scan].intervalNs);
+
+    // Stopped tasks are not escalated
+    WGSchedulePolicyStop(&policy, scan);
+    WGSchedulePolicyNoteActivity(&policy, arp, WGScheduleActivityAlert);
+    WG_CHECK_EQ(policy.tasks[scan].stats.escalations, 1);
+    WG_CHECK_EQ(policy.tasks[arp].stats.escalations, 2);
+    WG_CHECK_EQ(WGSchedulePolicyNextDue(&policy, &task), policy.tasks[arp].nextDueNs);
+    WG_CHECK_EQ(task, arp);
+}
+
+// Activity between runs pulls the next run in, never pushes it out
+static void testNoteActivity(void) {
+    WGTestClock clock = { .now = 0 };
+    WGSchedulePolicy policy;
+    WGSchedulePolicyInit(&policy, WGTestClockNow, &clock);
+    WGScheduleConfig config = WGScheduleConfigDefault(10 * S);
+    int task = WGSchedulePolicyAddTask(&policy, &config);
+    WGSchedulePolicyStart(&policy, task);
+    for (int i = 0; i < 9; i++) {
+        WGTestRunNext(&policy, &clock, 0, WGScheduleActivityQuiet);
+    }
+    uint64_t last = clock.now;
+    WG_CHECK_EQ(policy.tasks[task].nextDueNs, last + 80 * S);
+
+    clock.now = last + 5 * S;
+    WGSchedulePolicyNoteActivity(&policy, task, WGScheduleActivityQuiet);
+    WG_CHECK_EQ(policy.tasks[task].nextDueNs, last + 80 * S);
+
+    // Past the base interval already: due now
+    clock.now = last + 25 * S;
+    WGSchedulePolicyNoteActivity(&policy, task, WGScheduleActivityChanged);
+    WG_CHECK_EQ(policy.tasks[task].nextDueNs, last + 25 * S);
+
+    // Due sooner than the activity would ask: unchanged
+    clock.now = last + 30 * S;
+    WGSchedulePolicyNoteActivity(&policy, task, WGScheduleActivityChanged);
+    WG_CHECK_EQ(policy.tasks[task].nextDueNs, last + 25 * S);
+
+    // Within the base interval of the last run: one base interval after it
+    for (int i = 0; i < 9; i++) {
+        WGTestRunNext(&policy, &clock, 0, WGScheduleActivityQuiet);
+    }
+    last = clock.now;
+    WG_CHECK_EQ(policy.tasks[task].nextDueNs, last + 80 * S);
+    clock.now = last + 5 * S;
+    WGSchedulePolicyNoteActivity(&policy, task, WGScheduleActivityChanged);
+    WG_CHECK_EQ(policy.tasks[task].nextDueNs, last + 10 * S);
+
+    // While running the task has no due time; RecordRun sets it
+    WGSchedulePolicyBeginRun(&policy, task);
+    WGSchedulePolicyNoteActivity(&policy, task, WGScheduleActivityChanged);
+    WG_CHECK_EQ(WGSchedulePolicyNextDue(&policy, NULL), WG_SCHEDULE_NEVER);
+    WGSchedulePolicyRecordRun(&policy, task, 0, WGScheduleActivityQuiet);
+    WG_CHECK_EQ(policy.tasks[task].nextDueNs, clock.now + 10 * S);
+}
+
+// Budgets are floors on the interval, escalation included
+static void testBudgets(void) {
+    WGTestClock clock = { .now = 0 };
+    WGSchedulePolicy policy;
+    WGSchedulePolicyInit(&policy, WGTestClockNow, &clock);
+    WGScheduleConfig config = WGScheduleConfigDefault(10 * S);
+    config.cpuBudget = 0.1;
+    int task = WGSchedulePolicyAddTask(&policy, &config);
+    WGSchedulePolicyStart(&policy, task);
+
+    // 2 s runs at 10% of a core need 20 s between them
+    WGTestRunNext(&policy, &clock, 2 * S, WGScheduleActivityChanged);
+    WG_CHECK_EQ(policy.tasks[task].nextDueNs, clock.now + 20 * S);
+    WG_CHECK_EQ(policy.tasks[task].stats.budgetLimited, 1);
+    WG_CHECK_EQ(policy.tasks[task].stats.busyNs, 2 * S);
+    WG_CHECK_EQ(policy.tasks[task].stats.activeNs, 12 * S);
+    WG_CHECK(WGScheduleStatsDutyCycle(&policy.tasks[task].stats) > 0.166 &&
+             WGScheduleStatsDutyCycle(&policy.tasks[task].stats) < 0.167);
+
+    // Cheaper runs bring the average, and the floor, down (1/4 weight)
+    WGTestRunNext(&policy, &clock, 0, WGScheduleActivityChanged);
+    WG_CHECK_EQ(policy.tasks[task].averageRunNs, 2 * S * 3 / 4);
+    WG_CHECK_EQ(policy.tasks[task].nextDueNs, clock.now + 15 * S);
+
+    // Two wake-ups a minute: 30 s even when escalated
+    config = WGScheduleConfigDefault(10 * S);
+    config.maxWakeupsPerMinute = 2;
+    WGSchedulePolicyConfigure(&policy, task, &config);
+    WGSchedulePolicyStart(&policy, task);
+    WG_CHECK_EQ(policy.tasks[task].nextDueNs, clock.now + 30 * S);
+    WGSchedulePolicyNoteActivity(&policy, task, WGScheduleActivityAlert);
+    WG_CHECK_EQ(WGSchedulePolicyEffectiveInterval(&policy, task), 30 * S);
+    WG_CHECK_EQ(policy.tasks[task].nextDueNs, clock.now + 30 * S);
+    WGTestRunNext(&policy, &clock, 0, WGScheduleActivityAlert);
+    WG_CHECK_EQ(policy.tasks[task].nextDueNs, clock.now + 30 * S);
+    WG_CHECK_EQ(policy.tasks[task].stats.budgetLimited, 1);
+}
+
+static void testConfigure(void) {
+    WGTestClock clock = { .now = 0 };
+    WGSchedulePolicy policy;
+    WGSchedulePolicyInit(&policy, WGTestClockNow, &clock);
+
+    // Out-of-order and zero settings are sanitised
+    WGScheduleConfig config = { .baseNs = 10 * S, .fastNs = 20 * S, .maxNs = 1, .cpuBudget = 2 };
+    int task = WGSchedulePolicyAddTask(&policy, &config);
+    WG_CHECK_EQ(policy.tasks[task].config.fastNs, 10 * S);
+    WG_CHECK_EQ(policy.tasks[task].config.maxNs, 10 * S);
+    WG_CHECK_EQ(policy.tasks[task].config.quietRunsPerStep, 1);
+    WG_CHECK(policy.tasks[task].config.cpuBudget == 0);
+
+    // A lower ceiling applies at once; a lower base leaves the backed-off
+    // interval alone
+    config = WGScheduleConfigDefault(60 * S);
+    WGSchedulePolicyConfigure(&policy, task, &config);
+    WGSchedulePolicyStart(&policy, task);
+    WG_CHECK_EQ(policy.tasks[task].nextDueNs, 60 * S);
+    clock.now = 5 * S;
+    config = WGScheduleConfigDefault(20 * S);
+    WGSchedulePolicyConfigure(&policy, task, &config);
+    WG_CHECK_EQ(policy.tasks[task].nextDueNs, 60 * S);
+    config.maxNs = 20 * S;
+    WGSchedulePolicyConfigure(&policy, task, &config);
+    WG_CHECK_EQ(policy.tasks[task].nextDueNs, 20 * S);
+    WG_CHECK_EQ(WGSchedulePolicyLeeway(&policy, task), 1 * S);
+    config.baseNs = config.maxNs = 5 * S;
+    WGSchedulePolicyConfigure(&policy, task, &config);
+    WG_CHECK_EQ(policy.tasks[task].nextDueNs, 5 * S);
+    WG_CHECK_EQ(WGSchedulePolicyLeeway(&policy, task), 5 * S / 10);
+}
+
+static void testTaskSlots(void) {
+    WGTestClock clock = { .now = 0 };
+    WGSchedulePolicy policy;
+    WGSchedulePolicyInit(&policy, WGTestClockNow, &clock);
+    WGScheduleConfig config = WGScheduleConfigDefault(10 * S);
+    for (int i = 0; i < WG_SCHEDULE_MAX_TASKS; i++) {
+        WG_CHECK_EQ(WGSchedulePolicyAddTask(&policy, &config), i);
+    }
+    WG_CHECK_EQ(WGSchedulePolicyAddTask(&policy, &config), -1);
+
+    WGSchedulePolicyStart(&policy, 3);
+    WGSchedulePolicyRemoveTask(&policy, 3);
+    WG_CHECK_EQ(WGSchedulePolicyNextDue(&policy, NULL), WG_SCHEDULE_NEVER);
+    WG_CHECK_EQ(WGSchedulePolicyEffectiveInterval(&policy, 3), WG_SCHEDULE_NEVER);
+    WG_CHECK_EQ(WGSchedulePolicyLeeway(&policy, 3), 0);
+    WGSchedulePolicyStart(&policy, 3);
+    WG_CHECK_EQ(WGSchedulePolicyNextDue(&policy, NULL), WG_SCHEDULE_NEVER);
+    WGSchedulePolicyStart(&policy, 42);
+    WGSchedulePolicyRecordRun(&policy, -1, 0, WGScheduleActivityAlert);
+
+    WG_CHECK_EQ(WGSchedulePolicyAddTask(&policy, &config), 3);
+    WG_CHECK_EQ(policy.count, WG_SCHEDULE_MAX_TASKS);
+}
+
+int main(void) {
+    WG_RUN(testBackoff);
+    WG_RUN(testEscalation);
+    WG_RUN(testNoteActivity);
+    WG_RUN(testBudgets);
+    WG_RUN(testConfigure);
+    WG_RUN(testTaskSlots);
+    return WGTestFinish();
+}